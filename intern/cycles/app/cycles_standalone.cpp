@@ -19,11 +19,14 @@
 #include "device/device.h"
 #include "render/buffers.h"
 #include "render/camera.h"
+#include "render/film.h"
 #include "render/integrator.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_args.h"
+#include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
 #include "util/util_logging.h"
@@ -52,6 +55,8 @@ struct Options {
   SessionParams session_params;
   bool quiet;
   bool show_help, interactive, pause;
+  bool profile_pass;
+  bool cpu_split_kernel;
   string output_path;
 } options;
 
@@ -112,6 +117,48 @@ static bool write_render(const uchar *pixels, int w, int h, int channels)
   return true;
 }
 
+static bool write_profile_pass()
+{
+  RenderBuffers *buffers = options.session->buffers;
+  if (buffers == NULL) {
+    return false;
+  }
+
+  /* Written next to the main output, "render.png" becomes "render_profile.exr". */
+  string filename = path_filename(options.output_path);
+  filename = filename.substr(0, filename.rfind('.')) + "_profile.exr";
+  string filepath = path_join(path_dirname(options.output_path), filename);
+
+  const int w = buffers->params.width;
+  const int h = buffers->params.height;
+  vector<float> pixels(w * h * 3);
+  if (!buffers->get_pass_rect("Profile", 1.0f, options.session_params.samples, 3, &pixels[0])) {
+    return false;
+  }
+
+  unique_ptr<ImageOutput> out = unique_ptr<ImageOutput>(ImageOutput::create(filepath));
+  if (!out) {
+    return false;
+  }
+
+  ImageSpec spec(w, h, 3, TypeDesc::FLOAT);
+  spec.channelnames = {"traversal_steps", "intersections", "shader_time"};
+  if (!out->open(filepath, spec)) {
+    return false;
+  }
+
+  /* conversion for different top/bottom convention */
+  out->write_image(TypeDesc::FLOAT,
+                   &pixels[0] + (h - 1) * w * 3,
+                   AutoStride,
+                   -w * 3 * (stride_t)sizeof(float),
+                   AutoStride);
+
+  out->close();
+
+  return true;
+}
+
 static BufferParams &session_buffer_params()
 {
   static BufferParams buffer_params;
@@ -120,6 +167,10 @@ static BufferParams &session_buffer_params()
   buffer_params.full_width = options.width;
   buffer_params.full_height = options.height;
 
+  if (options.profile_pass) {
+    Pass::add(PASS_PROFILE, buffer_params.passes, "Profile");
+  }
+
   return buffer_params;
 }
 
@@ -142,6 +193,11 @@ static void scene_init()
 
   /* Calculate Viewplane */
   options.scene->camera->compute_auto_viewplane();
+
+  if (options.profile_pass) {
+    options.scene->film->tag_passes_update(options.scene, session_buffer_params().passes);
+    options.scene->film->tag_update(options.scene);
+  }
 }
 
 static void session_init()
@@ -166,7 +222,19 @@ static void session_init()
 
 static void session_exit()
 {
+  if (options.session && options.profile_pass) {
+    if (options.output_path != "" && !write_profile_pass()) {
+      fprintf(stderr, "Failed to write profile pass\n");
+    }
+
+    RenderStats stats;
+    options.session->collect_statistics(&stats);
+    printf("\n%s\n", stats.full_report().c_str());
+  }
+
+  double total_time = 0.0, render_time = 0.0;
   if (options.session) {
+    options.session->progress.get_time(total_time, render_time);
     delete options.session;
     options.session = NULL;
   }
@@ -174,6 +242,15 @@ static void session_exit()
   if (options.session_params.background && !options.quiet) {
     session_print("Finished Rendering.");
     printf("\n");
+
+    /* Throughput, to compare kernels and devices on the same scene. */
+    if (render_time > 0.0) {
+      const double pixel_samples = (double)options.width * options.height *
+                                   options.session_params.samples;
+      printf("Render time: %.2fs, %.3f M samples/s\n",
+             render_time,
+             pixel_samples / render_time * 1e-6);
+    }
   }
 }
 
@@ -369,6 +446,8 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.profile_pass = false;
+  options.cpu_split_kernel = false;
 
   /* device names */
   string device_names = "";
@@ -431,6 +510,13 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--profile-pass",
+             &options.profile_pass,
+             "Render per-pixel traversal steps, intersection tests and shader time to "
+             "<output>_profile.exr and print per-object cost statistics (CPU mega kernel only)",
+             "--cpu-split-kernel",
+             &options.cpu_split_kernel,
+             "Use the wavefront split kernel with shader sorting on the CPU device",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -495,6 +581,11 @@ static void options_parse(int argc, const char **argv)
   /* Use progressive rendering */
   options.session_params.progressive = true;
 
+  /* Per-object ray cost statistics are gathered by the profiler. */
+  options.session_params.use_profiling = options.profile_pass;
+
+  DebugFlags().cpu.split_kernel = options.cpu_split_kernel;
+
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
   vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -529,6 +620,10 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
+  else if (options.profile_pass && options.cpu_split_kernel) {
+    fprintf(stderr, "Profile pass is not supported with the CPU split kernel\n");
+    exit(EXIT_FAILURE);
+  }
 
   /* For smoother Viewport */
   options.session_params.start_resolution = 64;
@@ -1346,6 +1346,13 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
         default=False,
         update=update_render_passes,
     )
+    pass_debug_profile: BoolProperty(
+        name="Debug Profile",
+        description="BVH traversal steps, intersection tests and shader evaluation time in "
+        "microseconds per sample and pixel (CPU only, not with the split kernel)",
+        default=False,
+        update=update_render_passes,
+    )
     use_pass_volume_direct: BoolProperty(
         name="Volume Direct",
         description="Deliver direct volumetric scattering pass",
@@ -19,11 +19,13 @@
 #include "render/hair.h"
 #include "render/mesh.h"
 #include "render/object.h"
+#include "render/shader.h"
 
 #include "blender/blender_sync.h"
 #include "blender/blender_util.h"
 
 #include "util/util_foreach.h"
+#include "util/util_md5.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -75,6 +77,8 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
 
   /* Test if we need to sync. */
   Geometry *geom = geometry_map.find(key);
+  Geometry *prev_geom = NULL;
+  GeometryKey original_key(b_key_id.original().ptr.data, use_particle_hair);
   bool sync = true;
   if (geom == NULL) {
     /* Add new geometry if it did not exist yet. */
@@ -84,13 +88,26 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     else {
       geom = new Mesh();
     }
-    geometry_map.add(key, geom);
+
+    /* With persistent data, geometry from the previous render is only
+     * replaced after sync if the new geometry turns out to be different. */
+    map<GeometryKey, Geometry *>::iterator it = prev_persistent_geometry.find(original_key);
+    if (it != prev_persistent_geometry.end() && it->second->type == geom_type) {
+      prev_geom = it->second;
+    }
+    else {
+      geometry_map.add(key, geom);
+    }
   }
   else {
     /* Test if we need to update existing geometry. */
     sync = geometry_map.update(geom, b_key_id);
   }
 
+  if (scene->params.persistent_data && prev_geom == NULL) {
+    persistent_geometry[original_key] = geom;
+  }
+
   if (!sync) {
     /* If transform was applied to geometry, need full update. */
     if (object_updated && geom->transform_applied) {
@@ -145,6 +162,68 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     sync_mesh(b_depsgraph, b_ob, mesh, used_shaders);
   }
 
+  if (scene->params.persistent_data) {
+    geom = sync_geometry_persistent(b_ob, key, original_key, geom, prev_geom);
+  }
+
+  return geom;
+}
+
+Geometry *BlenderSync::sync_geometry_persistent(BL::Object &b_ob,
+                                                const GeometryKey &key,
+                                                const GeometryKey &original_key,
+                                                Geometry *geom,
+                                                Geometry *prev_geom)
+{
+  /* Hash synchronized data along with the object transform that gets applied
+   * to it with a static BVH. Shaders are recreated for every render, so they
+   * are identified by name. */
+  MD5Hash md5;
+  geom->hash_content(md5);
+
+  foreach (Shader *shader, geom->used_shaders) {
+    md5.append(shader->name.string());
+  }
+
+  if (scene->params.bvh_type == SceneParams::BVH_STATIC) {
+    const Transform tfm = get_transform(b_ob.matrix_world());
+    md5.append((const uint8_t *)&tfm, sizeof(tfm));
+  }
+
+  geom->content_hash = md5.get_hex();
+
+  if (prev_geom == NULL) {
+    return geom;
+  }
+
+  prev_persistent_geometry.erase(original_key);
+
+  /* Motion blur, subdivision, true displacement and volumes depend on more than
+   * the synchronized data, always use the new geometry for those. */
+  bool reuse = (prev_geom->content_hash == geom->content_hash &&
+                scene->need_motion() == Scene::MOTION_NONE &&
+                !geom->has_true_displacement() && !geom->has_voxel_attributes());
+  if (reuse && geom->type == Geometry::MESH) {
+    Mesh *mesh = static_cast<Mesh *>(geom);
+    reuse = (mesh->subdivision_type == Mesh::SUBDIVISION_NONE);
+  }
+
+  if (reuse) {
+    /* Keep previous geometry with its normals and BVH, only pointing it to
+     * the new shaders. */
+    prev_geom->used_shaders = geom->used_shaders;
+    geometry_synced.erase(geom);
+    delete geom;
+
+    geom = prev_geom;
+    geometry_map.add_existing(key, geom);
+  }
+  else {
+    geometry_map.add(key, geom);
+  }
+
+  persistent_geometry[original_key] = geom;
+
   return geom;
 }
 
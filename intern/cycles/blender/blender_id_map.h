@@ -81,6 +81,15 @@ template<typename K, typename T> class id_map {
     used(data);
   }
 
+  /* Add data that is already in the scene, for example taken over from
+   * the synchronization of a previous render. */
+  void add_existing(const K &key, T *data)
+  {
+    assert(find(key) == NULL);
+    b_map[key] = data;
+    used(data);
+  }
+
   /* Update existing data. */
   bool update(T *data, const BL::ID &id)
   {
@@ -20,6 +20,8 @@
 #include "blender/blender_session.h"
 #include "blender/blender_util.h"
 
+#include "util/util_md5.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Packed Images */
@@ -163,6 +165,33 @@ bool BlenderImageLoader::equals(const ImageLoader &other) const
   return b_image == other_loader.b_image && frame == other_loader.frame;
 }
 
+bool BlenderImageLoader::hash_content(MD5Hash &md5)
+{
+  /* Images modified in memory, for example by painting, can change without any
+   * of the properties below changing. */
+  if (b_image.is_dirty()) {
+    return false;
+  }
+
+  md5.append(b_image.name());
+
+  const int data[] = {frame,
+                      b_image.source(),
+                      b_image.size()[0],
+                      b_image.size()[1],
+                      b_image.channels(),
+                      b_image.is_float(),
+                      (b_image.packed_file()) ? b_image.packed_file().size() : 0,
+                      b_image.generated_type(),
+                      b_image.use_generated_float()};
+  md5.append((const uint8_t *)data, sizeof(data));
+
+  const float4 generated_color = get_float4(b_image.generated_color());
+  md5.append((const uint8_t *)&generated_color, sizeof(generated_color));
+
+  return true;
+}
+
 /* Point Density */
 
 BlenderPointDensityLoader::BlenderPointDensityLoader(BL::Depsgraph b_depsgraph,
@@ -34,6 +34,7 @@ class BlenderImageLoader : public ImageLoader {
                    const bool associate_alpha) override;
   string name() const override;
   bool equals(const ImageLoader &other) const override;
+  bool hash_content(MD5Hash &md5) override;
 
   BL::Image b_image;
   int frame;
@@ -342,16 +342,15 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
       BL::Mesh::loop_triangles_iterator t;
       uchar4 *cdata = vcol_attr->data_uchar4();
 
+      /* Keep the sRGB encoded bytes, converting to linear in the kernel avoids
+       * banding in dark colors. */
+      vcol_attr->flags |= ATTR_COMPACT_SRGB;
+
       for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
         int3 li = get_int3(t->loops());
-        float4 c1 = get_float4(l->data[li[0]].color());
-        float4 c2 = get_float4(l->data[li[1]].color());
-        float4 c3 = get_float4(l->data[li[2]].color());
-
-        /* Compress/encode vertex color using the sRGB curve. */
-        cdata[0] = color_float4_to_uchar4(color_srgb_to_linear_v4(c1));
-        cdata[1] = color_float4_to_uchar4(color_srgb_to_linear_v4(c2));
-        cdata[2] = color_float4_to_uchar4(color_srgb_to_linear_v4(c3));
+        cdata[0] = color_float4_to_uchar4(get_float4(l->data[li[0]].color()));
+        cdata[1] = color_float4_to_uchar4(get_float4(l->data[li[1]].color()));
+        cdata[2] = color_float4_to_uchar4(get_float4(l->data[li[2]].color()));
         cdata += 3;
       }
     }
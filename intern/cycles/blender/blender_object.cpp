@@ -189,6 +189,55 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
   ObjectKey key(b_parent, persistent_id, b_ob_instance, use_particle_hair);
   Object *object;
 
+  /* Dupli texture coordinates. */
+  float3 dupli_generated = make_float3(0.0f, 0.0f, 0.0f);
+  float2 dupli_uv = make_float2(0.0f, 0.0f);
+  if (is_instance) {
+    dupli_generated = 0.5f * get_float3(b_instance.orco()) - make_float3(0.5f, 0.5f, 0.5f);
+    dupli_uv = get_float2(b_instance.uv());
+  }
+
+  /* Instances of an object that was already synced from an earlier instance are added to its
+   * object as additional instances, instead of creating an object for each. */
+  if (is_instance && !use_particle_hair) {
+    int prototype_id[OBJECT_PERSISTENT_ID_SIZE];
+    memset(prototype_id, 0xff, sizeof(prototype_id));
+    ObjectKey prototype_key(b_parent, prototype_id, b_ob_instance, false);
+
+    if (motion) {
+      map<ObjectKey, pair<Object *, int>>::iterator it = object_instance_keys.find(key);
+      if (it != object_instance_keys.end()) {
+        if (it->second.second == -1) {
+          /* The object itself, synced below. */
+          key = prototype_key;
+        }
+        else {
+          /* Set transform of the additional instance at matching motion time step. */
+          object = it->second.first;
+          int time_index = object->motion_step(motion_time);
+          if (time_index >= 0) {
+            object->instance_motion[it->second.second * object->motion.size() + time_index] = tfm;
+          }
+          return object;
+        }
+      }
+    }
+    else if (object_map.is_used(prototype_key)) {
+      object = object_map.find(prototype_key);
+      if (sync_object_instance(
+              b_parent, b_instance, key, object, tfm, dupli_generated, dupli_uv)) {
+        return object;
+      }
+    }
+    else {
+      /* First instance in this sync, the object is synced from it. */
+      if (scene->need_motion() != Scene::MOTION_NONE) {
+        object_instance_keys[key] = pair<Object *, int>(NULL, -1);
+      }
+      key = prototype_key;
+    }
+  }
+
   /* motion vector case */
   if (motion) {
     object = object_map.find(key);
@@ -300,15 +349,12 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     }
 
     /* dupli texture coordinates and random_id */
+    object->dupli_generated = dupli_generated;
+    object->dupli_uv = dupli_uv;
     if (is_instance) {
-      object->dupli_generated = 0.5f * get_float3(b_instance.orco()) -
-                                make_float3(0.5f, 0.5f, 0.5f);
-      object->dupli_uv = get_float2(b_instance.uv());
       object->random_id = b_instance.random_id();
     }
     else {
-      object->dupli_generated = make_float3(0.0f, 0.0f, 0.0f);
-      object->dupli_uv = make_float2(0.0f, 0.0f);
       object->random_id = hash_uint2(hash_string(object->name.c_str()), 0);
     }
 
@@ -323,6 +369,38 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
   return object;
 }
 
+/* Add an instance to the object that was synced from an earlier instance of the same object,
+ * returns false if the instance needs an object of its own. */
+
+bool BlenderSync::sync_object_instance(BL::Object &b_parent,
+                                       BL::DepsgraphObjectInstance &b_instance,
+                                       const ObjectKey &key,
+                                       Object *object,
+                                       const Transform &tfm,
+                                       float3 dupli_generated,
+                                       float2 dupli_uv)
+{
+  ObjectInstances &instances = object_instances[object];
+  const size_t instance = instances.tfm.size();
+
+  int particle_index;
+  if (!sync_dupli_particle_instance(b_parent, b_instance, object, instance, &particle_index)) {
+    return false;
+  }
+
+  instances.tfm.push_back_slow(tfm);
+  instances.random_id.push_back_slow(b_instance.random_id());
+  instances.dupli_generated.push_back_slow(dupli_generated);
+  instances.dupli_uv.push_back_slow(dupli_uv);
+  instances.particle_index.push_back_slow(particle_index);
+
+  if (scene->need_motion() != Scene::MOTION_NONE) {
+    object_instance_keys[key] = pair<Object *, int>(object, (int)instance);
+  }
+
+  return true;
+}
+
 /* Object Loop */
 
 void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
@@ -336,9 +414,12 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     /* prepare for sync */
     light_map.pre_sync();
     geometry_map.pre_sync();
+    persistent_geometry.clear();
     object_map.pre_sync();
     particle_system_map.pre_sync();
     motion_times.clear();
+    object_instances.clear();
+    object_instance_keys.clear();
   }
   else {
     geometry_motion_synced.clear();
@@ -401,12 +482,14 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
 
   if (!cancel && !motion) {
     sync_background_light(b_v3d, use_portal);
+    sync_object_instances();
 
     /* handle removed data and modified pointers */
     if (light_map.post_sync())
       scene->light_manager->tag_update(scene);
     if (geometry_map.post_sync())
       scene->geometry_manager->tag_update(scene);
+    prev_persistent_geometry.clear();
     if (object_map.post_sync())
       scene->object_manager->tag_update(scene);
     if (particle_system_map.post_sync())
@@ -417,6 +500,60 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     geometry_motion_synced.clear();
 }
 
+void BlenderSync::sync_object_instances()
+{
+  /* Only tag objects for update when their additional instances changed, objects that had
+   * instances in the previous sync lose them if none were found now. */
+  foreach (Object *object, scene->objects) {
+    map<Object *, ObjectInstances>::iterator it = object_instances.find(object);
+
+    if (it == object_instances.end() || it->second.tfm.size() == 0) {
+      if (object->num_instances()) {
+        object->instance_tfm.clear();
+        object->instance_random_id.clear();
+        object->instance_dupli_generated.clear();
+        object->instance_dupli_uv.clear();
+        object->instance_particle_index.clear();
+        object->instance_motion.clear();
+        object->tag_update(scene);
+      }
+      continue;
+    }
+
+    ObjectInstances &instances = it->second;
+    if (instances.tfm != object->instance_tfm ||
+        instances.random_id != object->instance_random_id ||
+        instances.dupli_generated != object->instance_dupli_generated ||
+        instances.dupli_uv != object->instance_dupli_uv ||
+        instances.particle_index != object->instance_particle_index) {
+      object->instance_tfm.steal_data(instances.tfm);
+      object->instance_random_id.steal_data(instances.random_id);
+      object->instance_dupli_generated.steal_data(instances.dupli_generated);
+      object->instance_dupli_uv.steal_data(instances.dupli_uv);
+      object->instance_particle_index.steal_data(instances.particle_index);
+      object->tag_update(scene);
+    }
+
+    /* Motion of the additional instances is filled in by the motion sync, with the same steps
+     * as the object. */
+    object->instance_motion.clear();
+    if (object->use_motion()) {
+      const size_t num_steps = object->motion.size();
+      object->instance_motion.resize(object->num_instances() * num_steps);
+      for (size_t i = 0; i < object->num_instances(); i++) {
+        for (size_t step = 0; step < num_steps; step++) {
+          object->instance_motion[i * num_steps + step] = (step == num_steps / 2) ?
+                                                              object->instance_tfm[i] :
+                                                              transform_empty();
+        }
+      }
+      object->tag_update(scene);
+    }
+  }
+
+  object_instances.clear();
+}
+
 void BlenderSync::sync_motion(BL::RenderSettings &b_render,
                               BL::Depsgraph &b_depsgraph,
                               BL::SpaceView3D &b_v3d,
@@ -506,6 +643,8 @@ void BlenderSync::sync_motion(BL::RenderSettings &b_render,
   /* tag camera for motion update */
   if (scene->camera->motion_modified(prevcam))
     scene->camera->tag_update();
+
+  object_instance_keys.clear();
 }
 
 CCL_NAMESPACE_END
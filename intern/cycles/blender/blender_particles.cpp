@@ -27,6 +27,26 @@ CCL_NAMESPACE_BEGIN
 
 /* Utilities */
 
+static void add_dupli_particle(BL::Scene &b_scene,
+                               BL::ParticleSystem &b_psys,
+                               int index,
+                               ParticleSystem *psys)
+{
+  BL::Particle b_pa = b_psys.particles[index];
+  Particle pa;
+
+  pa.index = index;
+  pa.age = b_scene.frame_current() - b_pa.birth_time();
+  pa.lifetime = b_pa.lifetime();
+  pa.location = get_float3(b_pa.location());
+  pa.rotation = get_float4(b_pa.rotation());
+  pa.size = b_pa.size();
+  pa.velocity = get_float3(b_pa.velocity());
+  pa.angular_velocity = get_float3(b_pa.angular_velocity());
+
+  psys->particles.push_back_slow(pa);
+}
+
 bool BlenderSync::sync_dupli_particle(BL::Object &b_ob,
                                       BL::DepsgraphObjectInstance &b_instance,
                                       Object *object)
@@ -66,19 +86,7 @@ bool BlenderSync::sync_dupli_particle(BL::Object &b_ob,
   }
 
   /* add particle */
-  BL::Particle b_pa = b_psys.particles[persistent_id[0]];
-  Particle pa;
-
-  pa.index = persistent_id[0];
-  pa.age = b_scene.frame_current() - b_pa.birth_time();
-  pa.lifetime = b_pa.lifetime();
-  pa.location = get_float3(b_pa.location());
-  pa.rotation = get_float4(b_pa.rotation());
-  pa.size = b_pa.size();
-  pa.velocity = get_float3(b_pa.velocity());
-  pa.angular_velocity = get_float3(b_pa.angular_velocity());
-
-  psys->particles.push_back_slow(pa);
+  add_dupli_particle(b_scene, b_psys, persistent_id[0], psys);
 
   if (object->particle_index != psys->particles.size() - 1)
     scene->object_manager->tag_update(scene);
@@ -89,4 +97,51 @@ bool BlenderSync::sync_dupli_particle(BL::Object &b_ob,
   return true;
 }
 
+bool BlenderSync::sync_dupli_particle_instance(BL::Object &b_ob,
+                                               BL::DepsgraphObjectInstance &b_instance,
+                                               Object *object,
+                                               size_t instance,
+                                               int *particle_index)
+{
+  /* Duplis from particles are hidden on missing motion, so they can only be an additional
+   * instance of an object that is from particles as well. */
+  BL::ParticleSystem b_psys = b_instance.particle_system();
+  if ((bool)b_psys != object->hide_on_missing_motion) {
+    return false;
+  }
+
+  *particle_index = 0;
+
+  if (!b_psys || !object->geometry->need_attribute(scene, ATTR_STD_PARTICLE)) {
+    return true;
+  }
+
+  /* Particle data comes from the particle system of the object. */
+  BL::Array<int, OBJECT_PERSISTENT_ID_SIZE> persistent_id = b_instance.persistent_id();
+  if (persistent_id[0] >= b_psys.particles.length() || !object->particle_system) {
+    return false;
+  }
+
+  ParticleSystemKey key(b_ob, persistent_id);
+  ParticleSystem *psys = particle_system_map.find(key);
+  if (psys != object->particle_system) {
+    return false;
+  }
+
+  bool need_update = particle_system_map.update(psys, b_ob, b_instance.object());
+
+  /* no update needed? the particle is where it was in the previous sync */
+  if (!need_update && !object->geometry->need_update && !scene->object_manager->need_update) {
+    if (instance < object->instance_particle_index.size()) {
+      *particle_index = object->instance_particle_index[instance];
+    }
+    return true;
+  }
+
+  add_dupli_particle(b_scene, b_psys, persistent_id[0], psys);
+  *particle_index = psys->particles.size() - 1;
+
+  return true;
+}
+
 CCL_NAMESPACE_END
@@ -230,8 +230,14 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   /* There is no single depsgraph to use for the entire render.
    * See note on create_session().
    */
-  /* sync object should be re-created */
+  /* sync object should be re-created, but geometry of the previous render can
+   * be reused if it did not change */
+  BlenderSync *prev_sync = sync;
   sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  if (prev_sync) {
+    sync->take_persistent_geometry(*prev_sync);
+    delete prev_sync;
+  }
 
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
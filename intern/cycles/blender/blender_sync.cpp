@@ -78,6 +78,14 @@ BlenderSync::~BlenderSync()
 {
 }
 
+void BlenderSync::take_persistent_geometry(BlenderSync &prev_sync)
+{
+  /* Geometry stays in the scene between renders with persistent data, the
+   * next sync compares it against the new data and only replaces it when
+   * the contents changed. */
+  prev_persistent_geometry.swap(prev_sync.persistent_geometry);
+}
+
 /* Sync */
 
 void BlenderSync::sync_recalc(BL::Depsgraph &b_depsgraph, BL::SpaceView3D &b_v3d)
@@ -493,6 +501,7 @@ PassType BlenderSync::get_pass_type(BL::RenderPass &b_pass)
   MAP_PASS("Debug Render Time", PASS_RENDER_TIME);
   MAP_PASS("AdaptiveAuxBuffer", PASS_ADAPTIVE_AUX_BUFFER);
   MAP_PASS("Debug Sample Count", PASS_SAMPLE_COUNT);
+  MAP_PASS("Debug Profile", PASS_PROFILE);
   if (string_startswith(name, cryptomatte_prefix)) {
     return PASS_CRYPTOMATTE;
   }
@@ -610,6 +619,10 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay,
     b_engine.add_pass("Debug Sample Count", 1, "X", b_view_layer.name().c_str());
     Pass::add(PASS_SAMPLE_COUNT, passes, "Debug Sample Count");
   }
+  if (get_boolean(crp, "pass_debug_profile")) {
+    b_engine.add_pass("Debug Profile", 3, "XYZ", b_view_layer.name().c_str());
+    Pass::add(PASS_PROFILE, passes, "Debug Profile");
+  }
   if (get_boolean(crp, "use_pass_volume_direct")) {
     b_engine.add_pass("VolumeDir", 3, "RGB", b_view_layer.name().c_str());
     Pass::add(PASS_VOLUME_DIRECT, passes, "VolumeDir");
@@ -28,6 +28,7 @@
 #include "render/scene.h"
 #include "render/session.h"
 
+#include "util/util_array.h"
 #include "util/util_map.h"
 #include "util/util_set.h"
 #include "util/util_transform.h"
@@ -81,6 +82,7 @@ class BlenderSync {
                    int height,
                    const char *viewname);
   void sync_view(BL::SpaceView3D &b_v3d, BL::RegionView3D &b_rv3d, int width, int height);
+  void take_persistent_geometry(BlenderSync &prev_sync);
   inline int get_layer_samples()
   {
     return view_layer.samples;
@@ -137,6 +139,14 @@ class BlenderSync {
                       bool show_lights,
                       BlenderObjectCulling &culling,
                       bool *use_portal);
+  bool sync_object_instance(BL::Object &b_parent,
+                            BL::DepsgraphObjectInstance &b_instance,
+                            const ObjectKey &key,
+                            Object *object,
+                            const Transform &tfm,
+                            float3 dupli_generated,
+                            float2 dupli_uv);
+  void sync_object_instances();
 
   /* Volume */
   void sync_volume(BL::Object &b_ob, Mesh *mesh, const vector<Shader *> &used_shaders);
@@ -173,6 +183,11 @@ class BlenderSync {
                           BL::Object &b_ob_instance,
                           bool object_updated,
                           bool use_particle_hair);
+  Geometry *sync_geometry_persistent(BL::Object &b_ob,
+                                     const GeometryKey &key,
+                                     const GeometryKey &original_key,
+                                     Geometry *geom,
+                                     Geometry *prev_geom);
   void sync_geometry_motion(BL::Depsgraph &b_depsgraph,
                             BL::Object &b_ob,
                             Object *object,
@@ -193,6 +208,11 @@ class BlenderSync {
   bool sync_dupli_particle(BL::Object &b_ob,
                            BL::DepsgraphObjectInstance &b_instance,
                            Object *object);
+  bool sync_dupli_particle_instance(BL::Object &b_ob,
+                                    BL::DepsgraphObjectInstance &b_instance,
+                                    Object *object,
+                                    size_t instance,
+                                    int *particle_index);
 
   /* Images. */
   void sync_images();
@@ -218,7 +238,22 @@ class BlenderSync {
   id_map<ParticleSystemKey, ParticleSystem> particle_system_map;
   set<Geometry *> geometry_synced;
   set<Geometry *> geometry_motion_synced;
+  /* Geometry by original datablock, for reuse by the next render with persistent data. */
+  map<GeometryKey, Geometry *> persistent_geometry;
+  map<GeometryKey, Geometry *> prev_persistent_geometry;
   set<float> motion_times;
+  /* Additional instances of objects found during object sync. */
+  struct ObjectInstances {
+    array<Transform> tfm;
+    array<uint> random_id;
+    array<float3> dupli_generated;
+    array<float2> dupli_uv;
+    array<int> particle_index;
+  };
+  map<Object *, ObjectInstances> object_instances;
+  /* Object and index of the additional instance, or -1 for the object itself, of the instances
+   * synced from a prototype. Used to find them again when syncing motion. */
+  map<ObjectKey, pair<Object *, int>> object_instance_keys;
   void *world_map;
   bool world_recalc;
   BlenderViewportParameters viewport_parameters;
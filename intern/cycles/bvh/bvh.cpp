@@ -212,11 +212,11 @@ void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
   for (int prim = start; prim < end; prim++) {
     int pidx = pack.prim_index[prim];
     int tob = pack.prim_object[prim];
-    Object *ob = objects[tob];
+    Object *ob = object_from_device_index(objects, tob);
 
     if (pidx == -1) {
       /* Object instance. */
-      bbox.grow(ob->bounds);
+      bbox.grow(ob->get_device_bounds(tob));
     }
     else {
       /* Primitives. */
@@ -363,8 +363,8 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   size_t nodes_offset = nodes_size;
   size_t nodes_leaf_offset = leaf_nodes_size;
 
-  /* clear array that gives the node indexes for instanced objects */
-  pack.object_node.clear();
+  /* clear map that gives the node indexes for instanced geometry */
+  pack.geometry_node.clear();
 
   /* reserve */
   size_t prim_index_size = pack.prim_index.size();
@@ -374,7 +374,6 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   size_t pack_prim_tri_verts_offset = prim_tri_verts_size;
   size_t pack_nodes_offset = nodes_size;
   size_t pack_leaf_nodes_offset = leaf_nodes_size;
-  size_t object_offset = 0;
 
   foreach (Geometry *geom, geometry) {
     BVH *bvh = geom->bvh;
@@ -395,7 +394,6 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   pack.prim_tri_index.resize(prim_index_size);
   pack.nodes.resize(nodes_size);
   pack.leaf_nodes.resize(leaf_nodes_size);
-  pack.object_node.resize(objects.size());
 
   if (params.num_motion_curve_steps > 0 || params.num_motion_triangle_steps > 0) {
     pack.prim_time.resize(prim_index_size);
@@ -411,8 +409,6 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   int4 *pack_leaf_nodes = (pack.leaf_nodes.size()) ? &pack.leaf_nodes[0] : NULL;
   float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
 
-  map<Geometry *, int> geometry_map;
-
   /* merge */
   foreach (Object *ob, objects) {
     Geometry *geom = ob->geometry;
@@ -421,17 +417,11 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
      * into a top-level BVH and no packing here is needed.
      */
     if (!geom->need_build_bvh(params.bvh_layout)) {
-      pack.object_node[object_offset++] = 0;
       continue;
     }
 
-    /* if mesh already added once, don't add it again, but used set
-     * node offset for this object */
-    map<Geometry *, int>::iterator it = geometry_map.find(geom);
-
-    if (geometry_map.find(geom) != geometry_map.end()) {
-      int noffset = it->second;
-      pack.object_node[object_offset++] = noffset;
+    /* if mesh already added once, don't add it again */
+    if (pack.geometry_node.find(geom) != pack.geometry_node.end()) {
       continue;
     }
 
@@ -443,11 +433,9 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 
     /* fill in node indexes for instances */
     if (bvh->pack.root_index == -1)
-      pack.object_node[object_offset++] = -noffset_leaf - 1;
+      pack.geometry_node[geom] = -noffset_leaf - 1;
     else
-      pack.object_node[object_offset++] = noffset;
-
-    geometry_map[geom] = pack.object_node[object_offset - 1];
+      pack.geometry_node[geom] = noffset;
 
     /* merge primitive, object and triangle indexes */
     if (bvh->pack.prim_index.size()) {
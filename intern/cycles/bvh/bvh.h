@@ -20,6 +20,7 @@
 
 #include "bvh/bvh_params.h"
 #include "util/util_array.h"
+#include "util/util_map.h"
 #include "util/util_types.h"
 #include "util/util_vector.h"
 
@@ -49,8 +50,9 @@ struct PackedBVH {
   array<int4> nodes;
   /* BVH leaf nodes storage. */
   array<int4> leaf_nodes;
-  /* object index to BVH node index mapping for instances */
-  array<int> object_node;
+  /* Root node of each instanced geometry BVH after merging, or with Embree
+   * the offset of its primitives. Stored in the instance records. */
+  map<Geometry *, int> geometry_node;
   /* Mapping from primitive index to index in triangle array. */
   array<uint> prim_tri_index;
   /* Continuous storage of triangle vertices. */
@@ -422,11 +422,11 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     for (int prim = c.x; prim < c.y; prim++) {
       int pidx = pack.prim_index[prim];
       int tob = pack.prim_object[prim];
-      Object *ob = objects[tob];
+      Object *ob = object_from_device_index(objects, tob);
 
       if (pidx == -1) {
         /* Object instance. */
-        bbox.grow(ob->bounds);
+        bbox.grow(ob->get_device_bounds(tob));
       }
       else {
         /* Primitives. */
@@ -70,6 +70,18 @@ class BVHObjectBinning : public BVHRange {
 
   enum { MAX_BINS = 32 };
   enum { LOG_BLOCK_SIZE = 2 };
+  /* Ranges with at least this many primitives are binned in parallel chunks. This happens for
+   * the upper levels of the top level BVH in scenes with many instances, which would otherwise
+   * be binned by a single thread. */
+  enum { PARALLEL_BINNING_SIZE = 65536 };
+
+  /* Bounds and number of primitives of every bin in every dimension. */
+  struct Bins {
+    BoundBox bounds[MAX_BINS][4];
+    int4 count[MAX_BINS];
+  };
+
+  void bin_primitives(const BVHReference *prims, int begin, int end, Bins *bins) const;
 
   /* computes the bin numbers for each dimension for a box. */
   __forceinline int4 get_bin(const BoundBox &box) const
@@ -317,9 +317,22 @@ void BVHBuild::add_reference_geometry(BoundBox &root, BoundBox &center, Geometry
 
 void BVHBuild::add_reference_object(BoundBox &root, BoundBox &center, Object *ob, int i)
 {
-  references.push_back(BVHReference(ob->bounds, -1, i, 0));
-  root.grow(ob->bounds);
-  center.grow(ob->bounds.center2());
+  if (ob->is_traceable()) {
+    references.push_back(BVHReference(ob->bounds, -1, i, 0));
+    root.grow(ob->bounds);
+    center.grow(ob->bounds.center2());
+  }
+
+  /* Additional instances of the object. */
+  for (size_t j = 0; j < ob->num_instances(); j++) {
+    const BoundBox bounds = ob->instance_bounds(j);
+    if (!bounds.valid() || bounds.size() == make_float3(0.0f, 0.0f, 0.0f)) {
+      continue;
+    }
+    references.push_back(BVHReference(bounds, -1, ob->get_instance_device_index(j), 0));
+    root.grow(bounds);
+    center.grow(bounds.center2());
+  }
 }
 
 static size_t count_curve_segments(Hair *hair)
@@ -353,14 +366,14 @@ void BVHBuild::add_references(BVHRange &root)
 
   foreach (Object *ob, objects) {
     if (params.top_level) {
-      if (!ob->is_traceable()) {
+      if (!ob->is_traceable() && ob->num_instances() == 0) {
         continue;
       }
       if (!ob->geometry->is_instanced()) {
         num_alloc_references += count_primitives(ob->geometry);
       }
       else
-        num_alloc_references++;
+        num_alloc_references += 1 + ob->num_instances();
     }
     else {
       num_alloc_references += count_primitives(ob->geometry);
@@ -375,7 +388,7 @@ void BVHBuild::add_references(BVHRange &root)
 
   foreach (Object *ob, objects) {
     if (params.top_level) {
-      if (!ob->is_traceable()) {
+      if (!ob->is_traceable() && ob->num_instances() == 0) {
         ++i;
         continue;
       }
@@ -814,7 +827,8 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
       prim_time[start] = make_float2(ref->time_from(), ref->time_to());
     }
 
-    const uint visibility = objects[ref->prim_object()]->visibility_for_tracing();
+    const uint visibility =
+        object_from_device_index(objects, ref->prim_object())->visibility_for_tracing();
     BVHNode *leaf_node = new LeafNode(ref->bounds(), visibility, start, start + 1);
     leaf_node->time_from = ref->time_from();
     leaf_node->time_to = ref->time_to();
@@ -238,7 +238,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
         uint tri_object = (isect->object == OBJECT_NONE) ?
                               kernel_tex_fetch(__prim_object, isect->prim) :
                               isect->object;
-        int object_flag = kernel_tex_fetch(__object_flag, tri_object);
+        int object_flag = kernel_tex_fetch(__instances, tri_object).flag;
         if ((object_flag & SD_OBJECT_HAS_VOLUME) == 0) {
           --ctx->num_hits;
         }
@@ -453,14 +453,14 @@ void BVHEmbree::build(Progress &progress, Stats *stats_)
 
   foreach (Object *ob, objects) {
     if (params.top_level) {
-      if (!ob->is_traceable()) {
+      if (!ob->is_traceable() && ob->num_instances() == 0) {
         continue;
       }
       if (!ob->geometry->is_instanced()) {
         prim_count += count_primitives(ob->geometry);
       }
       else {
-        ++prim_count;
+        prim_count += 1 + ob->num_instances();
       }
     }
     else {
@@ -475,11 +475,11 @@ void BVHEmbree::build(Progress &progress, Stats *stats_)
 
   int i = 0;
 
-  pack.object_node.clear();
+  pack.geometry_node.clear();
 
   foreach (Object *ob, objects) {
     if (params.top_level) {
-      if (!ob->is_traceable()) {
+      if (!ob->is_traceable() && ob->num_instances() == 0) {
         ++i;
         continue;
       }
@@ -487,7 +487,12 @@ void BVHEmbree::build(Progress &progress, Stats *stats_)
         add_object(ob, i);
       }
       else {
-        add_instance(ob, i);
+        if (ob->is_traceable()) {
+          add_instance(ob, i);
+        }
+        for (size_t j = 0; j < ob->num_instances(); ++j) {
+          add_instance(ob, ob->get_instance_device_index(j));
+        }
       }
     }
     else {
@@ -562,7 +567,12 @@ void BVHEmbree::add_instance(Object *ob, int i)
     instance_bvh->top_level = this;
   }
 
-  const size_t num_object_motion_steps = ob->use_motion() ? ob->motion.size() : 1;
+  /* The object or one of its additional instances. */
+  size_t num_object_motion_steps;
+  const Transform *motion = ob->get_device_motion(i, &num_object_motion_steps);
+  if (!motion) {
+    num_object_motion_steps = 1;
+  }
   const size_t num_motion_steps = min(num_object_motion_steps, RTC_MAX_TIME_STEP_COUNT);
   assert(num_object_motion_steps <= RTC_MAX_TIME_STEP_COUNT);
 
@@ -570,9 +580,9 @@ void BVHEmbree::add_instance(Object *ob, int i)
   rtcSetGeometryInstancedScene(geom_id, instance_bvh->scene);
   rtcSetGeometryTimeStepCount(geom_id, num_motion_steps);
 
-  if (ob->use_motion()) {
-    array<DecomposedTransform> decomp(ob->motion.size());
-    transform_motion_decompose(decomp.data(), ob->motion.data(), ob->motion.size());
+  if (motion) {
+    array<DecomposedTransform> decomp(num_object_motion_steps);
+    transform_motion_decompose(decomp.data(), motion, num_object_motion_steps);
     for (size_t step = 0; step < num_motion_steps; ++step) {
       RTCQuaternionDecomposition rtc_decomp;
       rtcInitQuaternionDecomposition(&rtc_decomp);
@@ -588,7 +598,8 @@ void BVHEmbree::add_instance(Object *ob, int i)
     }
   }
   else {
-    rtcSetGeometryTransform(geom_id, 0, RTC_FORMAT_FLOAT3X4_ROW_MAJOR, (const float *)&ob->tfm);
+    rtcSetGeometryTransform(
+        geom_id, 0, RTC_FORMAT_FLOAT3X4_ROW_MAJOR, (const float *)&ob->get_device_transform(i));
   }
 
   pack.prim_index.push_back_slow(-1);
@@ -875,32 +886,27 @@ void BVHEmbree::pack_nodes(const BVHNode *)
 
   size_t pack_prim_index_offset = prim_index_size;
   size_t pack_prim_tri_verts_offset = prim_tri_verts_size;
-  size_t object_offset = 0;
-
-  map<Geometry *, int> geometry_map;
 
+  /* Node indexes for instances, geometries are merged in the order of their first object. */
   foreach (Object *ob, objects) {
     Geometry *geom = ob->geometry;
     BVH *bvh = geom->bvh;
 
     if (geom->need_build_bvh(BVH_LAYOUT_EMBREE)) {
-      if (geometry_map.find(geom) == geometry_map.end()) {
+      if (pack.geometry_node.find(geom) == pack.geometry_node.end()) {
+        pack.geometry_node[geom] = prim_index_size;
         prim_index_size += bvh->pack.prim_index.size();
         prim_tri_verts_size += bvh->pack.prim_tri_verts.size();
-        geometry_map[geom] = 1;
       }
     }
   }
 
-  geometry_map.clear();
-
   pack.prim_index.resize(prim_index_size);
   pack.prim_type.resize(prim_index_size);
   pack.prim_object.resize(prim_index_size);
   pack.prim_visibility.clear();
   pack.prim_tri_verts.resize(prim_tri_verts_size);
   pack.prim_tri_index.resize(prim_index_size);
-  pack.object_node.resize(objects.size());
 
   int *pack_prim_index = (pack.prim_index.size()) ? &pack.prim_index[0] : NULL;
   int *pack_prim_type = (pack.prim_type.size()) ? &pack.prim_type[0] : NULL;
@@ -916,17 +922,11 @@ void BVHEmbree::pack_nodes(const BVHNode *)
      * into a top-level BVH and no packing here is needed.
      */
     if (!geom->need_build_bvh(BVH_LAYOUT_EMBREE)) {
-      pack.object_node[object_offset++] = prim_offset;
       continue;
     }
 
-    /* if geom already added once, don't add it again, but used set
-     * node offset for this object */
-    map<Geometry *, int>::iterator it = geometry_map.find(geom);
-
-    if (geometry_map.find(geom) != geometry_map.end()) {
-      int noffset = it->second;
-      pack.object_node[object_offset++] = noffset;
+    /* if geom already added once, don't add it again */
+    if ((size_t)pack.geometry_node[geom] != prim_offset) {
       continue;
     }
 
@@ -937,11 +937,6 @@ void BVHEmbree::pack_nodes(const BVHNode *)
 
     int geom_prim_offset = geom->prim_offset;
 
-    /* fill in node indexes for instances */
-    pack.object_node[object_offset++] = prim_offset;
-
-    geometry_map[geom] = pack.object_node[object_offset - 1];
-
     /* merge primitive, object and triangle indexes */
     if (bvh->pack.prim_index.size()) {
       size_t bvh_prim_index_size = bvh->pack.prim_index.size();
@@ -453,15 +453,19 @@ void BVHSpatialSplit::split_curve_reference(const BVHReference &ref,
                         right_bounds);
 }
 
-void BVHSpatialSplit::split_object_reference(
-    const Object *object, int dim, float pos, BoundBox &left_bounds, BoundBox &right_bounds)
+void BVHSpatialSplit::split_object_reference(const Object *object,
+                                             const Transform *tfm,
+                                             int dim,
+                                             float pos,
+                                             BoundBox &left_bounds,
+                                             BoundBox &right_bounds)
 {
   Geometry *geom = object->geometry;
 
   if (geom->type == Geometry::MESH) {
     Mesh *mesh = static_cast<Mesh *>(geom);
     for (int tri_idx = 0; tri_idx < mesh->num_triangles(); ++tri_idx) {
-      split_triangle_primitive(mesh, &object->tfm, tri_idx, dim, pos, left_bounds, right_bounds);
+      split_triangle_primitive(mesh, tfm, tri_idx, dim, pos, left_bounds, right_bounds);
     }
   }
   else if (geom->type == Geometry::HAIR) {
@@ -470,7 +474,7 @@ void BVHSpatialSplit::split_object_reference(
       Hair::Curve curve = hair->get_curve(curve_idx);
       for (int segment_idx = 0; segment_idx < curve.num_keys - 1; ++segment_idx) {
         split_curve_primitive(
-            hair, &object->tfm, curve_idx, segment_idx, dim, pos, left_bounds, right_bounds);
+            hair, tfm, curve_idx, segment_idx, dim, pos, left_bounds, right_bounds);
       }
     }
   }
@@ -488,7 +492,7 @@ void BVHSpatialSplit::split_reference(const BVHBuild &builder,
   BoundBox right_bounds = BoundBox::empty;
 
   /* loop over vertices/edges. */
-  const Object *ob = builder.objects[ref.prim_object()];
+  const Object *ob = object_from_device_index(builder.objects, ref.prim_object());
 
   if (ref.prim_type() & PRIMITIVE_ALL_TRIANGLE) {
     Mesh *mesh = static_cast<Mesh *>(ob->geometry);
@@ -499,7 +503,8 @@ void BVHSpatialSplit::split_reference(const BVHBuild &builder,
     split_curve_reference(ref, hair, dim, pos, left_bounds, right_bounds);
   }
   else {
-    split_object_reference(ob, dim, pos, left_bounds, right_bounds);
+    const Transform &tfm = ob->get_device_transform(ref.prim_object());
+    split_object_reference(ob, &tfm, dim, pos, left_bounds, right_bounds);
   }
 
   /* intersect with original bounds. */
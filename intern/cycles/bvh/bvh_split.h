@@ -141,8 +141,12 @@ class BVHSpatialSplit {
                              float pos,
                              BoundBox &left_bounds,
                              BoundBox &right_bounds);
-  void split_object_reference(
-      const Object *object, int dim, float pos, BoundBox &left_bounds, BoundBox &right_bounds);
+  void split_object_reference(const Object *object,
+                              const Transform *tfm,
+                              int dim,
+                              float pos,
+                              BoundBox &left_bounds,
+                              BoundBox &right_bounds);
 
   __forceinline BoundBox get_prim_bounds(const BVHReference &prim) const
   {
@@ -65,10 +65,11 @@ Transform BVHUnaligned::compute_aligned_space(const BVHRange &range,
 
 bool BVHUnaligned::compute_aligned_space(const BVHReference &ref, Transform *aligned_space) const
 {
-  const Object *object = objects_[ref.prim_object()];
   const int packed_type = ref.prim_type();
   const int type = (packed_type & PRIMITIVE_ALL);
+  /* No need to look up the object for other types, it could be an additional instance. */
   if (type & PRIMITIVE_CURVE) {
+    const Object *object = objects_[ref.prim_object()];
     const int curve_index = ref.prim_index();
     const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
     const Hair *hair = static_cast<const Hair *>(object->geometry);
@@ -90,10 +91,10 @@ BoundBox BVHUnaligned::compute_aligned_prim_boundbox(const BVHReference &prim,
                                                      const Transform &aligned_space) const
 {
   BoundBox bounds = BoundBox::empty;
-  const Object *object = objects_[prim.prim_object()];
   const int packed_type = prim.prim_type();
   const int type = (packed_type & PRIMITIVE_ALL);
   if (type & PRIMITIVE_CURVE) {
+    const Object *object = objects_[prim.prim_object()];
     const int curve_index = prim.prim_index();
     const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
     const Hair *hair = static_cast<const Hair *>(object->geometry);
@@ -145,6 +145,8 @@ class CUDADevice : public Device {
 
   void mem_copy_to(device_memory &mem);
 
+  void mem_copy_to_range(device_memory &mem, size_t offset, size_t size);
+
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem);
 
   void mem_zero(device_memory &mem);
@@ -955,6 +955,25 @@ void CUDADevice::mem_copy_to(device_memory &mem)
   }
 }
 
+void CUDADevice::mem_copy_to_range(device_memory &mem, size_t offset, size_t size)
+{
+  if (!mem.device_pointer || mem.type == MEM_TEXTURE || mem.type == MEM_PIXELS) {
+    mem_copy_to(mem);
+    return;
+  }
+
+  /* Mapped host memory is used by the device directly. */
+  if (cuda_mem_map[&mem].use_mapped_host && mem.host_pointer == mem.shared_pointer) {
+    return;
+  }
+
+  const CUDAContextScope scope(this);
+  const size_t elem_size = mem.memory_elements_size(1);
+  cuda_assert(cuMemcpyHtoD((CUdeviceptr)mem.device_pointer + offset * elem_size,
+                           (char *)mem.host_pointer + offset * elem_size,
+                           size * elem_size));
+}
+
 void CUDADevice::mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
 {
   if (mem.type == MEM_PIXELS && !background) {
@@ -463,6 +463,14 @@ class Device {
 
   virtual void mem_alloc(device_memory &mem) = 0;
   virtual void mem_copy_to(device_memory &mem) = 0;
+  /* Copy size elements starting at offset of memory already on the device. Devices
+   * without a faster path copy all of it. */
+  virtual void mem_copy_to_range(device_memory &mem, size_t offset, size_t size)
+  {
+    (void)offset;
+    (void)size;
+    mem_copy_to(mem);
+  }
   virtual void mem_copy_from(device_memory &mem, int y, int w, int h, int elem) = 0;
   virtual void mem_zero(device_memory &mem) = 0;
   virtual void mem_free(device_memory &mem) = 0;
@@ -299,6 +299,7 @@ class CPUDevice : public Device {
     if (use_split_kernel) {
       VLOG(1) << "Will be using split kernel.";
     }
+    info.use_split_kernel = use_split_kernel;
     need_texture_info = false;
 
 #define REGISTER_SPLIT_KERNEL(name) \
@@ -421,6 +422,15 @@ class CPUDevice : public Device {
     }
   }
 
+  void mem_copy_to_range(device_memory &mem, size_t /*offset*/, size_t /*size*/)
+  {
+    if (!mem.device_pointer) {
+      mem_copy_to(mem);
+    }
+
+    /* copy is no-op, host memory is used directly */
+  }
+
   void mem_copy_from(device_memory & /*mem*/, int /*y*/, int /*w*/, int /*h*/, int /*elem*/)
   {
     /* no-op */
@@ -1227,8 +1237,11 @@ class CPUSplitKernelFunction : public SplitKernelFunction {
  public:
   CPUDevice *device;
   void (*func)(KernelGlobals *kg, KernelData *data);
+  /* Work items are independent of each other and may run on multiple threads. */
+  bool use_parallel_batches;
 
-  CPUSplitKernelFunction(CPUDevice *device) : device(device), func(NULL)
+  CPUSplitKernelFunction(CPUDevice *device)
+      : device(device), func(NULL), use_parallel_batches(false)
   {
   }
   ~CPUSplitKernelFunction()
@@ -1246,6 +1259,10 @@ class CPUSplitKernelFunction : public SplitKernelFunction {
     KernelGlobals *kg = (KernelGlobals *)kernel_globals.device_pointer;
     kg->global_size = make_int2(dim.global_size[0], dim.global_size[1]);
 
+    if (use_parallel_batches && enqueue_parallel_batches(kg, (KernelData *)data.device_pointer)) {
+      return true;
+    }
+
     for (int y = 0; y < dim.global_size[1]; y++) {
       for (int x = 0; x < dim.global_size[0]; x++) {
         kg->global_id = make_int2(x, y);
@@ -1256,6 +1273,60 @@ class CPUSplitKernelFunction : public SplitKernelFunction {
 
     return true;
   }
+
+ protected:
+  /* Minimum number of work items per task, so the copy of the kernel globals and scheduling
+   * stay small compared to the shader evaluation. */
+  static const int min_batch_size = 256;
+
+  /* Run the work items of the shader sorted queue as contiguous batches in the task
+   * scheduler. Rays are sorted by shader, so every batch evaluates one or a few materials.
+   * The calling thread works on batches until all are done, idle render threads join in, for
+   * example at the end of a render when there are fewer tiles than threads left. */
+  bool enqueue_parallel_batches(KernelGlobals *kg, KernelData *data)
+  {
+#ifdef WITH_OSL
+    /* OSL shading contexts are per thread. */
+    if (kg->osl) {
+      return false;
+    }
+#endif
+    /* Profiler samples are only collected from the state of the render thread. */
+    if (kg->profiler.active) {
+      return false;
+    }
+
+    const int global_size = kg->global_size.x * kg->global_size.y;
+    const int num_items = min(global_size,
+                              kg->split_param_data.queue_index[QUEUE_SHADER_SORTED_RAYS]);
+    const int num_threads = max(TaskScheduler::num_threads(), 1);
+    const int batch_size = max(min_batch_size, (int)divide_up(num_items, num_threads * 4));
+    if (num_items <= batch_size) {
+      return false;
+    }
+
+    TaskPool pool;
+    for (int start = 0; start < num_items; start += batch_size) {
+      const int end = min(start + batch_size, num_items);
+      pool.push(function_bind(&CPUSplitKernelFunction::run_batch, this, kg, data, start, end));
+    }
+    pool.wait_work();
+
+    return true;
+  }
+
+  void run_batch(KernelGlobals *kg, KernelData *data, int start, int end)
+  {
+    /* Work item index is taken from the kernel globals, so every batch needs its own. */
+    KernelGlobals batch_kg = *kg;
+    const int width = batch_kg.global_size.x;
+
+    for (int i = start; i < end; i++) {
+      batch_kg.global_id = make_int2(i % width, i / width);
+
+      func(&batch_kg, data);
+    }
+  }
 };
 
 CPUSplitKernel::CPUSplitKernel(CPUDevice *device) : DeviceSplitKernel(device), device(device)
@@ -1316,6 +1387,10 @@ SplitKernelFunction *CPUSplitKernel::get_split_kernel_function(const string &ker
     return NULL;
   }
 
+  /* Shader evaluation of the sorted rays dominates render time with complex materials, and
+   * only writes to the state of its own ray and atomically to the render buffer. */
+  kernel->use_parallel_batches = (kernel_name == "shader_eval");
+
   return kernel;
 }
 
@@ -1324,11 +1399,19 @@ int2 CPUSplitKernel::split_kernel_local_size()
   return make_int2(1, 1);
 }
 
-int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
-                                              device_memory & /*data*/,
+int2 CPUSplitKernel::split_kernel_global_size(device_memory &kg,
+                                              device_memory &data,
                                               DeviceTask * /*task*/)
 {
-  return make_int2(1, 1);
+  /* Keep a large batch of path states per thread, so that rays can be sorted by
+   * shader and evaluated in material coherent batches. Every render thread has
+   * its own states, so the batch size is limited by memory usage. */
+  const int width = 64;
+  const uint64_t state_memory = 32 * 1024 * 1024;
+  const uint64_t state_size = std::max(state_buffer_size(kg, data, 1), (uint64_t)1);
+  const int height = clamp((int)(state_memory / (state_size * width)), 1, 64);
+
+  return make_int2(width, height);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
@@ -251,6 +251,7 @@ class device_memory {
   void device_alloc();
   void device_free();
   void device_copy_to();
+  void device_copy_to_range(size_t offset, size_t size);
   void device_copy_from(int y, int w, int h, int elem);
   void device_zero();
 
@@ -433,6 +434,13 @@ template<typename T> class device_vector : public device_memory {
     device_copy_to();
   }
 
+  /* Copy a range of elements, the vector must have been copied to the device before. */
+  void copy_to_device_range(size_t offset, size_t size)
+  {
+    assert(offset + size <= data_size);
+    device_copy_to_range(offset, size);
+  }
+
   void copy_from_device()
   {
     device_copy_from(0, data_width, data_height, sizeof(T));
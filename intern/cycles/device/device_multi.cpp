@@ -229,6 +229,30 @@ class MultiDevice : public Device {
     stats.mem_alloc(mem.device_size - existing_size);
   }
 
+  void mem_copy_to_range(device_memory &mem, size_t offset, size_t size)
+  {
+    device_ptr key = mem.device_pointer;
+    if (!key) {
+      mem_copy_to(mem);
+      return;
+    }
+
+    size_t existing_size = mem.device_size;
+
+    foreach (SubDevice &sub, devices) {
+      mem.device = sub.device;
+      mem.device_pointer = sub.ptr_map[key];
+      mem.device_size = existing_size;
+
+      sub.device->mem_copy_to_range(mem, offset, size);
+      sub.ptr_map[key] = mem.device_pointer;
+    }
+
+    mem.device = this;
+    mem.device_pointer = key;
+    stats.mem_alloc(mem.device_size - existing_size);
+  }
+
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
   {
     device_ptr key = mem.device_pointer;
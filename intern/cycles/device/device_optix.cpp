@@ -1103,6 +1103,79 @@ class OptiXDevice : public CUDADevice {
     return true;
   }
 
+  // Create a traversable moving the child along the motion transforms
+  bool build_optix_motion_transform(OptixTraversableHandle child,
+                                    const Transform *motion,
+                                    size_t num_steps,
+                                    OptixTraversableHandle &handle)
+  {
+    size_t motion_keys = max(num_steps, 2) - 2;
+    size_t motion_transform_size = sizeof(OptixSRTMotionTransform) +
+                                   motion_keys * sizeof(OptixSRTData);
+
+    const CUDAContextScope scope(cuContext);
+
+    CUdeviceptr motion_transform_gpu = 0;
+    check_result_cuda_ret(cuMemAlloc(&motion_transform_gpu, motion_transform_size));
+    as_mem.push_back(motion_transform_gpu);
+
+    // Allocate host side memory for motion transform and fill it with transform data
+    OptixSRTMotionTransform &motion_transform = *reinterpret_cast<OptixSRTMotionTransform *>(
+        new uint8_t[motion_transform_size]);
+    motion_transform.child = child;
+    motion_transform.motionOptions.numKeys = num_steps;
+    motion_transform.motionOptions.flags = OPTIX_MOTION_FLAG_NONE;
+    motion_transform.motionOptions.timeBegin = 0.0f;
+    motion_transform.motionOptions.timeEnd = 1.0f;
+
+    OptixSRTData *const srt_data = motion_transform.srtData;
+    array<DecomposedTransform> decomp(num_steps);
+    transform_motion_decompose(decomp.data(), motion, num_steps);
+
+    for (size_t i = 0; i < num_steps; ++i) {
+      // Scale
+      srt_data[i].sx = decomp[i].y.w;  // scale.x.x
+      srt_data[i].sy = decomp[i].z.w;  // scale.y.y
+      srt_data[i].sz = decomp[i].w.w;  // scale.z.z
+
+      // Shear
+      srt_data[i].a = decomp[i].z.x;  // scale.x.y
+      srt_data[i].b = decomp[i].z.y;  // scale.x.z
+      srt_data[i].c = decomp[i].w.x;  // scale.y.z
+      assert(decomp[i].z.z == 0.0f);  // scale.y.x
+      assert(decomp[i].w.y == 0.0f);  // scale.z.x
+      assert(decomp[i].w.z == 0.0f);  // scale.z.y
+
+      // Pivot point
+      srt_data[i].pvx = 0.0f;
+      srt_data[i].pvy = 0.0f;
+      srt_data[i].pvz = 0.0f;
+
+      // Rotation
+      srt_data[i].qx = decomp[i].x.x;
+      srt_data[i].qy = decomp[i].x.y;
+      srt_data[i].qz = decomp[i].x.z;
+      srt_data[i].qw = decomp[i].x.w;
+
+      // Translation
+      srt_data[i].tx = decomp[i].y.x;
+      srt_data[i].ty = decomp[i].y.y;
+      srt_data[i].tz = decomp[i].y.z;
+    }
+
+    // Upload motion transform to GPU
+    cuMemcpyHtoD(motion_transform_gpu, &motion_transform, motion_transform_size);
+    delete[] reinterpret_cast<uint8_t *>(&motion_transform);
+
+    // Get traversable handle to motion transform
+    optixConvertPointerToTraversableHandle(context,
+                                           motion_transform_gpu,
+                                           OPTIX_TRAVERSABLE_TYPE_SRT_MOTION_TRANSFORM,
+                                           &handle);
+
+    return true;
+  }
+
   bool build_optix_bvh(BVH *bvh) override
   {
     assert(bvh->params.top_level);
@@ -1277,17 +1350,18 @@ class OptiXDevice : public CUDADevice {
       }
     }
 
-    // Fill instance descriptions
+    // Fill instance descriptions, including the additional instances of objects
+    size_t max_num_instances = 0;
+    for (Object *ob : bvh->objects) {
+      max_num_instances += 1 + ob->num_instances();
+    }
+
     device_vector<OptixAabb> aabbs(this, "tlas_aabbs", MEM_READ_ONLY);
-    aabbs.alloc(bvh->objects.size());
+    aabbs.alloc(max_num_instances);
     device_vector<OptixInstance> instances(this, "tlas_instances", MEM_READ_ONLY);
-    instances.alloc(bvh->objects.size());
+    instances.alloc(max_num_instances);
 
     for (Object *ob : bvh->objects) {
-      // Skip non-traceable objects
-      if (!ob->is_traceable())
-        continue;
-
       // Create separate instance for triangle/curve meshes of an object
       auto handle_it = geometry.find(ob->geometry);
       if (handle_it == geometry.end()) {
@@ -1295,6 +1369,44 @@ class OptiXDevice : public CUDADevice {
       }
       OptixTraversableHandle handle = handle_it->second;
 
+      // Additional instances share the acceleration structure
+      for (size_t i = 0; i < ob->num_instances(); ++i) {
+        const BoundBox bounds = ob->instance_bounds(i);
+        if (!bounds.valid() || bounds.size() == make_float3(0.0f, 0.0f, 0.0f))
+          continue;
+
+        OptixAabb &aabb = aabbs[num_instances];
+        aabb.minX = bounds.min.x;
+        aabb.minY = bounds.min.y;
+        aabb.minZ = bounds.min.z;
+        aabb.maxX = bounds.max.x;
+        aabb.maxY = bounds.max.y;
+        aabb.maxZ = bounds.max.z;
+
+        OptixInstance &instance = instances[num_instances++];
+        memset(&instance, 0, sizeof(instance));
+        instance.instanceId = ob->get_instance_device_index(i);
+        instance.visibilityMask = (ob->geometry->has_volume ? 3 : 1);
+
+        size_t num_motion_steps;
+        const Transform *motion = ob->get_device_motion(instance.instanceId, &num_motion_steps);
+        if (motion_blur && motion) {
+          if (!build_optix_motion_transform(
+                  handle, motion, num_motion_steps, instance.traversableHandle)) {
+            return false;
+          }
+          instance.flags = OPTIX_INSTANCE_FLAG_DISABLE_TRANSFORM;
+        }
+        else {
+          memcpy(instance.transform, &ob->instance_tfm[i], sizeof(instance.transform));
+          instance.traversableHandle = handle;
+        }
+      }
+
+      // Skip non-traceable objects
+      if (!ob->is_traceable())
+        continue;
+
       OptixAabb &aabb = aabbs[num_instances];
       aabb.minX = ob->bounds.min.x;
       aabb.minY = ob->bounds.min.y;
@@ -1320,72 +1432,13 @@ class OptiXDevice : public CUDADevice {
 
       // Insert motion traversable if object has motion
       if (motion_blur && ob->use_motion()) {
-        size_t motion_keys = max(ob->motion.size(), 2) - 2;
-        size_t motion_transform_size = sizeof(OptixSRTMotionTransform) +
-                                       motion_keys * sizeof(OptixSRTData);
-
-        const CUDAContextScope scope(cuContext);
-
-        CUdeviceptr motion_transform_gpu = 0;
-        check_result_cuda_ret(cuMemAlloc(&motion_transform_gpu, motion_transform_size));
-        as_mem.push_back(motion_transform_gpu);
-
-        // Allocate host side memory for motion transform and fill it with transform data
-        OptixSRTMotionTransform &motion_transform = *reinterpret_cast<OptixSRTMotionTransform *>(
-            new uint8_t[motion_transform_size]);
-        motion_transform.child = handle;
-        motion_transform.motionOptions.numKeys = ob->motion.size();
-        motion_transform.motionOptions.flags = OPTIX_MOTION_FLAG_NONE;
-        motion_transform.motionOptions.timeBegin = 0.0f;
-        motion_transform.motionOptions.timeEnd = 1.0f;
-
-        OptixSRTData *const srt_data = motion_transform.srtData;
-        array<DecomposedTransform> decomp(ob->motion.size());
-        transform_motion_decompose(decomp.data(), ob->motion.data(), ob->motion.size());
-
-        for (size_t i = 0; i < ob->motion.size(); ++i) {
-          // Scale
-          srt_data[i].sx = decomp[i].y.w;  // scale.x.x
-          srt_data[i].sy = decomp[i].z.w;  // scale.y.y
-          srt_data[i].sz = decomp[i].w.w;  // scale.z.z
-
-          // Shear
-          srt_data[i].a = decomp[i].z.x;  // scale.x.y
-          srt_data[i].b = decomp[i].z.y;  // scale.x.z
-          srt_data[i].c = decomp[i].w.x;  // scale.y.z
-          assert(decomp[i].z.z == 0.0f);  // scale.y.x
-          assert(decomp[i].w.y == 0.0f);  // scale.z.x
-          assert(decomp[i].w.z == 0.0f);  // scale.z.y
-
-          // Pivot point
-          srt_data[i].pvx = 0.0f;
-          srt_data[i].pvy = 0.0f;
-          srt_data[i].pvz = 0.0f;
-
-          // Rotation
-          srt_data[i].qx = decomp[i].x.x;
-          srt_data[i].qy = decomp[i].x.y;
-          srt_data[i].qz = decomp[i].x.z;
-          srt_data[i].qw = decomp[i].x.w;
-
-          // Translation
-          srt_data[i].tx = decomp[i].y.x;
-          srt_data[i].ty = decomp[i].y.y;
-          srt_data[i].tz = decomp[i].y.z;
+        if (!build_optix_motion_transform(
+                handle, ob->motion.data(), ob->motion.size(), instance.traversableHandle)) {
+          return false;
         }
 
-        // Upload motion transform to GPU
-        cuMemcpyHtoD(motion_transform_gpu, &motion_transform, motion_transform_size);
-        delete[] reinterpret_cast<uint8_t *>(&motion_transform);
-
         // Disable instance transform if object uses motion transform already
         instance.flags = OPTIX_INSTANCE_FLAG_DISABLE_TRANSFORM;
-
-        // Get traversable handle to motion transform
-        optixConvertPointerToTraversableHandle(context,
-                                               motion_transform_gpu,
-                                               OPTIX_TRAVERSABLE_TYPE_SRT_MOTION_TRANSFORM,
-                                               &instance.traversableHandle);
       }
       else {
         instance.traversableHandle = handle;
@@ -105,7 +105,9 @@ bool DeviceSplitKernel::load_kernels(const DeviceRequestedFeatures &requested_fe
   LOAD_KERNEL(path_init);
   LOAD_KERNEL(scene_intersect);
   LOAD_KERNEL(lamp_emission);
-  if (requested_features.use_volume) {
+  /* CPU kernels are always compiled with volume support, where lamp emission leaves emptying
+   * the active queue to the volume kernel. */
+  if (requested_features.use_volume || device->info.type == DEVICE_CPU) {
     LOAD_KERNEL(do_volume);
   }
   LOAD_KERNEL(queue_enqueue);
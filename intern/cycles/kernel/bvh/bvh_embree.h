@@ -113,7 +113,7 @@ ccl_device_inline void kernel_embree_convert_hit(KernelGlobals *kg,
         rtcGetGeometry(kernel_data.bvh.scene, hit->instID[0]));
     isect->prim = hit->primID +
                   (intptr_t)rtcGetGeometryUserData(rtcGetGeometry(inst_scene, hit->geomID)) +
-                  kernel_tex_fetch(__object_node, hit->instID[0] / 2);
+                  kernel_tex_fetch(__instances, hit->instID[0] / 2).node;
     isect->object = hit->instID[0] / 2;
   }
   else {
@@ -138,7 +138,7 @@ ccl_device_inline void kernel_embree_convert_sss_hit(KernelGlobals *kg,
       rtcGetGeometry(kernel_data.bvh.scene, local_object_id * 2));
   isect->prim = hit->primID +
                 (intptr_t)rtcGetGeometryUserData(rtcGetGeometry(inst_scene, hit->geomID)) +
-                kernel_tex_fetch(__object_node, local_object_id);
+                kernel_tex_fetch(__instances, local_object_id).node;
   isect->object = local_object_id;
   isect->type = kernel_tex_fetch(__prim_type, isect->prim);
 }
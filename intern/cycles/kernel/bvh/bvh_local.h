@@ -63,7 +63,7 @@ ccl_device_inline
 
   /* traversal variables in registers */
   int stack_ptr = 0;
-  int node_addr = kernel_tex_fetch(__object_node, local_object);
+  int node_addr = kernel_tex_fetch(__instances, local_object).node;
 
   /* ray parameters in registers */
   float3 P = ray->P;
@@ -77,7 +77,7 @@ ccl_device_inline
   }
   kernel_assert((local_isect == NULL) == (max_hits == 0));
 
-  const int object_flag = kernel_tex_fetch(__object_flag, local_object);
+  const int object_flag = kernel_tex_fetch(__instances, local_object).flag;
   if (!(object_flag & SD_OBJECT_TRANSFORM_APPLIED)) {
 #if BVH_FEATURE(BVH_MOTION)
     Transform ob_itfm;
@@ -316,7 +316,7 @@ ccl_device_inline
           kernel_assert(stack_ptr < BVH_STACK_SIZE);
           traversal_stack[stack_ptr] = ENTRYPOINT_SENTINEL;
 
-          node_addr = kernel_tex_fetch(__object_node, object);
+          node_addr = kernel_tex_fetch(__instances, object).node;
         }
       }
 #endif /* FEATURE(BVH_INSTANCING) */
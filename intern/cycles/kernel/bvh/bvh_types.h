@@ -56,19 +56,23 @@ CCL_NAMESPACE_BEGIN
 #  define BVH_DEBUG_NEXT_NODE() \
     do { \
       ++isect->num_traversed_nodes; \
+      PROFILING_COST_TRAVERSAL_STEP(kg); \
     } while (0)
 #  define BVH_DEBUG_NEXT_INTERSECTION() \
     do { \
       ++isect->num_intersections; \
+      PROFILING_COST_INTERSECTION(kg); \
     } while (0)
 #  define BVH_DEBUG_NEXT_INSTANCE() \
     do { \
       ++isect->num_traversed_instances; \
     } while (0)
 #else /* __KERNEL_DEBUG__ */
+/* Outside of debug builds only the CPU profile pass counters are updated, and only
+ * when the pass is enabled or the profiler is running. */
 #  define BVH_DEBUG_INIT()
-#  define BVH_DEBUG_NEXT_NODE()
-#  define BVH_DEBUG_NEXT_INTERSECTION()
+#  define BVH_DEBUG_NEXT_NODE() PROFILING_COST_TRAVERSAL_STEP(kg)
+#  define BVH_DEBUG_NEXT_INTERSECTION() PROFILING_COST_INTERSECTION(kg)
 #  define BVH_DEBUG_NEXT_INSTANCE()
 #endif /* __KERNEL_DEBUG__ */
 
@@ -195,7 +195,7 @@ ccl_device_inline
                 uint tri_object = (object == OBJECT_NONE) ?
                                       kernel_tex_fetch(__prim_object, prim_addr) :
                                       object;
-                int object_flag = kernel_tex_fetch(__object_flag, tri_object);
+                int object_flag = kernel_tex_fetch(__instances, tri_object).flag;
                 if ((object_flag & SD_OBJECT_HAS_VOLUME) == 0) {
                   continue;
                 }
@@ -238,7 +238,7 @@ ccl_device_inline
                 uint tri_object = (object == OBJECT_NONE) ?
                                       kernel_tex_fetch(__prim_object, prim_addr) :
                                       object;
-                int object_flag = kernel_tex_fetch(__object_flag, tri_object);
+                int object_flag = kernel_tex_fetch(__instances, tri_object).flag;
                 if ((object_flag & SD_OBJECT_HAS_VOLUME) == 0) {
                   continue;
                 }
@@ -283,7 +283,7 @@ ccl_device_inline
         else {
           /* instance push */
           object = kernel_tex_fetch(__prim_object, -prim_addr - 1);
-          int object_flag = kernel_tex_fetch(__object_flag, object);
+          int object_flag = kernel_tex_fetch(__instances, object).flag;
           if (object_flag & SD_OBJECT_HAS_VOLUME) {
 #  if BVH_FEATURE(BVH_MOTION)
             isect_t = bvh_instance_motion_push(
@@ -312,7 +312,7 @@ ccl_device_inline
             kernel_assert(stack_ptr < BVH_STACK_SIZE);
             traversal_stack[stack_ptr] = ENTRYPOINT_SENTINEL;
 
-            node_addr = kernel_tex_fetch(__object_node, object);
+            node_addr = kernel_tex_fetch(__instances, object).node;
           }
           else {
             /* pop */
@@ -603,7 +603,7 @@ ccl_device bool BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
           kernel_assert(stack_ptr < BVH_OSTACK_SIZE);
           traversal_stack[stack_ptr].addr = ENTRYPOINT_SENTINEL;
 
-          node_addr = kernel_tex_fetch(__object_node, object);
+          node_addr = kernel_tex_fetch(__instances, object).node;
         }
       }
 #endif /* FEATURE(BVH_INSTANCING) */
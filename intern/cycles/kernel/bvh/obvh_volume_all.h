@@ -373,7 +373,7 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
                 uint tri_object = (object == OBJECT_NONE) ?
                                       kernel_tex_fetch(__prim_object, prim_addr) :
                                       object;
-                int object_flag = kernel_tex_fetch(__object_flag, tri_object);
+                int object_flag = kernel_tex_fetch(__instances, tri_object).flag;
                 if ((object_flag & SD_OBJECT_HAS_VOLUME) == 0) {
                   continue;
                 }
@@ -413,7 +413,7 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
                 uint tri_object = (object == OBJECT_NONE) ?
                                       kernel_tex_fetch(__prim_object, prim_addr) :
                                       object;
-                int object_flag = kernel_tex_fetch(__object_flag, tri_object);
+                int object_flag = kernel_tex_fetch(__instances, tri_object).flag;
                 if ((object_flag & SD_OBJECT_HAS_VOLUME) == 0) {
                   continue;
                 }
@@ -453,7 +453,7 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
         else {
           /* Instance push. */
           object = kernel_tex_fetch(__prim_object, -prim_addr - 1);
-          int object_flag = kernel_tex_fetch(__object_flag, object);
+          int object_flag = kernel_tex_fetch(__instances, object).flag;
           if (object_flag & SD_OBJECT_HAS_VOLUME) {
 #  if BVH_FEATURE(BVH_MOTION)
             isect_t = bvh_instance_motion_push(
@@ -483,7 +483,7 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
             kernel_assert(stack_ptr < BVH_OSTACK_SIZE);
             traversal_stack[stack_ptr].addr = ENTRYPOINT_SENTINEL;
 
-            node_addr = kernel_tex_fetch(__object_node, object);
+            node_addr = kernel_tex_fetch(__instances, object).node;
           }
           else {
             /* Pop. */
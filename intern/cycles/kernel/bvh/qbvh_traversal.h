@@ -373,7 +373,7 @@ ccl_device bool BVH_FUNCTION_FULL_NAME(QBVH)(KernelGlobals *kg,
           traversal_stack[stack_ptr].addr = ENTRYPOINT_SENTINEL;
           traversal_stack[stack_ptr].dist = -FLT_MAX;
 
-          node_addr = kernel_tex_fetch(__object_node, object);
+          node_addr = kernel_tex_fetch(__instances, object).node;
 
           BVH_DEBUG_NEXT_INSTANCE();
         }
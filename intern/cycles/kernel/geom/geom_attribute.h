@@ -48,7 +48,8 @@ ccl_device_inline AttributeDescriptor attribute_not_found()
 
 ccl_device_inline uint object_attribute_map_offset(KernelGlobals *kg, int object)
 {
-  return kernel_tex_fetch(__objects, object).attribute_map_offset;
+  const int kobject = kernel_tex_fetch(__instances, object).object;
+  return kernel_tex_fetch(__objects, kobject).attribute_map_offset;
 }
 
 ccl_device_inline AttributeDescriptor find_attribute(KernelGlobals *kg,
@@ -33,6 +33,19 @@ enum ObjectTransform {
 
 enum ObjectVectorTransform { OBJECT_PASS_MOTION_PRE = 0, OBJECT_PASS_MOTION_POST = 1 };
 
+/* Object data shared by all instances of an object. The kernel refers to objects by the index of
+ * their instance, which has to be mapped to the index of the object for these. */
+
+ccl_device_inline int object_instance_object(KernelGlobals *kg, int object)
+{
+  return kernel_tex_fetch(__instances, object).object;
+}
+
+ccl_device_inline uint object_flag(KernelGlobals *kg, int object)
+{
+  return kernel_tex_fetch(__instances, object).flag;
+}
+
 /* Object to world space transformation */
 
 ccl_device_inline Transform object_fetch_transform(KernelGlobals *kg,
@@ -40,10 +53,10 @@ ccl_device_inline Transform object_fetch_transform(KernelGlobals *kg,
                                                    enum ObjectTransform type)
 {
   if (type == OBJECT_INVERSE_TRANSFORM) {
-    return kernel_tex_fetch(__objects, object).itfm;
+    return kernel_tex_fetch(__instances, object).itfm;
   }
   else {
-    return kernel_tex_fetch(__objects, object).tfm;
+    return kernel_tex_fetch(__instances, object).tfm;
   }
 }
 
@@ -76,9 +89,10 @@ ccl_device_inline Transform object_fetch_transform_motion(KernelGlobals *kg,
                                                           int object,
                                                           float time)
 {
-  const uint motion_offset = kernel_tex_fetch(__objects, object).motion_offset;
-  const ccl_global DecomposedTransform *motion = &kernel_tex_fetch(__object_motion, motion_offset);
-  const uint num_steps = kernel_tex_fetch(__objects, object).numsteps * 2 + 1;
+  const ccl_global KernelInstance *kinstance = &kernel_tex_fetch(__instances, object);
+  const ccl_global DecomposedTransform *motion = &kernel_tex_fetch(__object_motion,
+                                                                  kinstance->motion_offset);
+  const uint num_steps = kernel_tex_fetch(__objects, kinstance->object).numsteps * 2 + 1;
 
   Transform tfm;
   transform_motion_array_interpolate(&tfm, motion, num_steps, time);
@@ -91,8 +105,7 @@ ccl_device_inline Transform object_fetch_transform_motion_test(KernelGlobals *kg
                                                                float time,
                                                                Transform *itfm)
 {
-  int object_flag = kernel_tex_fetch(__object_flag, object);
-  if (object_flag & SD_OBJECT_MOTION) {
+  if (object_flag(kg, object) & SD_OBJECT_MOTION) {
     /* if we do motion blur */
     Transform tfm = object_fetch_transform_motion(kg, object, time);
 
@@ -109,6 +122,22 @@ ccl_device_inline Transform object_fetch_transform_motion_test(KernelGlobals *kg
     return tfm;
   }
 }
+
+/* Inverse transformation used to move a ray into an instance, only reading the instance record
+ * when the object has no motion blur. */
+
+ccl_device_inline Transform object_fetch_inverse_transform_motion_test(KernelGlobals *kg,
+                                                                       int object,
+                                                                       float time)
+{
+  const ccl_global KernelInstance *kinstance = &kernel_tex_fetch(__instances, object);
+  if (kinstance->flag & SD_OBJECT_MOTION) {
+    return transform_quick_inverse(object_fetch_transform_motion(kg, object, time));
+  }
+  else {
+    return kinstance->itfm;
+  }
+}
 #endif
 
 /* Transform position from object to world space */
@@ -218,7 +247,7 @@ ccl_device_inline float3 object_location(KernelGlobals *kg, const ShaderData *sd
 
 ccl_device_inline float object_surface_area(KernelGlobals *kg, int object)
 {
-  return kernel_tex_fetch(__objects, object).surface_area;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).surface_area;
 }
 
 /* Color of the object */
@@ -228,7 +257,8 @@ ccl_device_inline float3 object_color(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
+  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects,
+                                                            object_instance_object(kg, object));
   return make_float3(kobject->color[0], kobject->color[1], kobject->color[2]);
 }
 
@@ -239,7 +269,7 @@ ccl_device_inline float object_pass_id(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).pass_id;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).pass_id;
 }
 
 /* Per lamp random number for shader variation */
@@ -259,7 +289,7 @@ ccl_device_inline float object_random_number(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).random_number;
+  return kernel_tex_fetch(__instances, object).random_number;
 }
 
 /* Particle ID from which this object was generated */
@@ -269,7 +299,7 @@ ccl_device_inline int object_particle_id(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).particle_index;
+  return kernel_tex_fetch(__instances, object).particle_index;
 }
 
 /* Generated texture coordinate on surface from where object was instanced */
@@ -279,9 +309,9 @@ ccl_device_inline float3 object_dupli_generated(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
+  const ccl_global KernelInstance *kinstance = &kernel_tex_fetch(__instances, object);
   return make_float3(
-      kobject->dupli_generated[0], kobject->dupli_generated[1], kobject->dupli_generated[2]);
+      kinstance->dupli_generated[0], kinstance->dupli_generated[1], kinstance->dupli_generated[2]);
 }
 
 /* UV texture coordinate on surface from where object was instanced */
@@ -291,8 +321,8 @@ ccl_device_inline float3 object_dupli_uv(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
-  return make_float3(kobject->dupli_uv[0], kobject->dupli_uv[1], 0.0f);
+  const ccl_global KernelInstance *kinstance = &kernel_tex_fetch(__instances, object);
+  return make_float3(kinstance->dupli_uv[0], kinstance->dupli_uv[1], 0.0f);
 }
 
 /* Information about mesh for motion blurred triangles and curves */
@@ -300,14 +330,17 @@ ccl_device_inline float3 object_dupli_uv(KernelGlobals *kg, int object)
 ccl_device_inline void object_motion_info(
     KernelGlobals *kg, int object, int *numsteps, int *numverts, int *numkeys)
 {
+  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects,
+                                                            object_instance_object(kg, object));
+
   if (numkeys) {
-    *numkeys = kernel_tex_fetch(__objects, object).numkeys;
+    *numkeys = kobject->numkeys;
   }
 
   if (numsteps)
-    *numsteps = kernel_tex_fetch(__objects, object).numsteps;
+    *numsteps = kobject->numsteps;
   if (numverts)
-    *numverts = kernel_tex_fetch(__objects, object).numverts;
+    *numverts = kobject->numverts;
 }
 
 /* Offset to an objects patch map */
@@ -317,7 +350,7 @@ ccl_device_inline uint object_patch_map_offset(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).patch_map_offset;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).patch_map_offset;
 }
 
 /* Volume step size */
@@ -328,7 +361,7 @@ ccl_device_inline float object_volume_density(KernelGlobals *kg, int object)
     return 1.0f;
   }
 
-  return kernel_tex_fetch(__objects, object).surface_area;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).surface_area;
 }
 
 ccl_device_inline float object_volume_step_size(KernelGlobals *kg, int object)
@@ -337,7 +370,7 @@ ccl_device_inline float object_volume_step_size(KernelGlobals *kg, int object)
     return kernel_data.background.volume_step_size;
   }
 
-  return kernel_tex_fetch(__object_volume_step, object);
+  return kernel_tex_fetch(__object_volume_step, object_instance_object(kg, object));
 }
 
 /* Pass ID for shader */
@@ -354,7 +387,7 @@ ccl_device_inline float object_cryptomatte_id(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_object;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).cryptomatte_object;
 }
 
 ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals *kg, int object)
@@ -362,7 +395,7 @@ ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals *kg, int objec
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_asset;
+  return kernel_tex_fetch(__objects, object_instance_object(kg, object)).cryptomatte_asset;
 }
 
 /* Particle data from which object was instanced */
@@ -536,7 +569,7 @@ ccl_device_inline float bvh_instance_motion_push(KernelGlobals *kg,
                                                  float t,
                                                  Transform *itfm)
 {
-  object_fetch_transform_motion_test(kg, object, ray->time, itfm);
+  *itfm = object_fetch_inverse_transform_motion_test(kg, object, ray->time);
 
   *P = transform_point(itfm, ray->P);
 
@@ -568,7 +601,7 @@ ccl_device_inline void qbvh_instance_motion_push(KernelGlobals *kg,
                                                  float *t1,
                                                  Transform *itfm)
 {
-  object_fetch_transform_motion_test(kg, object, ray->time, itfm);
+  *itfm = object_fetch_inverse_transform_motion_test(kg, object, ray->time);
 
   *P = transform_point(itfm, ray->P);
 
@@ -53,7 +53,7 @@ ccl_device_inline void triangle_point_normal(
   float t = 1.0f - u - v;
   *P = (u * v0 + v * v1 + t * v2);
   /* get object flags */
-  int object_flag = kernel_tex_fetch(__object_flag, object);
+  int object_flag = kernel_tex_fetch(__instances, object).flag;
   /* compute normal */
   if (object_flag & SD_OBJECT_NEGATIVE_SCALE_APPLIED) {
     *Ng = normalize(cross(v2 - v0, v1 - v0));
@@ -171,6 +171,39 @@ ccl_device float triangle_attribute_float(
   }
 }
 
+/* Fetch vertex or corner attribute values, decoding compact storage formats. */
+
+ccl_device_inline float2 triangle_attribute_fetch_float2(KernelGlobals *kg,
+                                                         const AttributeDescriptor desc,
+                                                         int index)
+{
+  if (desc.flags & ATTR_COMPACT_HALF) {
+    return half2_to_float2(kernel_tex_fetch(__attributes_uint, index));
+  }
+  return kernel_tex_fetch(__attributes_float2, index);
+}
+
+ccl_device_inline float3 triangle_attribute_fetch_float3(KernelGlobals *kg,
+                                                         const AttributeDescriptor desc,
+                                                         int index)
+{
+  if (desc.flags & ATTR_COMPACT_OCTAHEDRAL) {
+    return octahedral_to_float3(kernel_tex_fetch(__attributes_uint, index));
+  }
+  return float4_to_float3(kernel_tex_fetch(__attributes_float3, index));
+}
+
+ccl_device_inline float4 triangle_attribute_fetch_uchar4(KernelGlobals *kg,
+                                                         const AttributeDescriptor desc,
+                                                         int index)
+{
+  float4 value = color_uchar4_to_float4(kernel_tex_fetch(__attributes_uchar4, index));
+  if (desc.flags & ATTR_COMPACT_SRGB) {
+    value = color_srgb_to_linear_v4(value);
+  }
+  return value;
+}
+
 ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
                                             const ShaderData *sd,
                                             const AttributeDescriptor desc,
@@ -188,9 +221,9 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
     uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
 
-    float2 f0 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.x);
-    float2 f1 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.y);
-    float2 f2 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.z);
+    float2 f0 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.x);
+    float2 f1 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.y);
+    float2 f2 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.z);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -206,9 +239,9 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
     float2 f0, f1, f2;
 
     if (desc.element == ATTR_ELEMENT_CORNER) {
-      f0 = kernel_tex_fetch(__attributes_float2, tri + 0);
-      f1 = kernel_tex_fetch(__attributes_float2, tri + 1);
-      f2 = kernel_tex_fetch(__attributes_float2, tri + 2);
+      f0 = triangle_attribute_fetch_float2(kg, desc, tri + 0);
+      f1 = triangle_attribute_fetch_float2(kg, desc, tri + 1);
+      f2 = triangle_attribute_fetch_float2(kg, desc, tri + 2);
     }
 
 #ifdef __RAY_DIFFERENTIALS__
@@ -255,12 +288,9 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
     uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
 
-    float3 f0 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.x));
-    float3 f1 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.y));
-    float3 f2 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.z));
+    float3 f0 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.x);
+    float3 f1 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.y);
+    float3 f2 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.z);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -275,9 +305,9 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
     int tri = desc.offset + sd->prim * 3;
     float3 f0, f1, f2;
 
-    f0 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 0));
-    f1 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 1));
-    f2 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 2));
+    f0 = triangle_attribute_fetch_float3(kg, desc, tri + 0);
+    f1 = triangle_attribute_fetch_float3(kg, desc, tri + 1);
+    f2 = triangle_attribute_fetch_float3(kg, desc, tri + 2);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -315,9 +345,9 @@ ccl_device float4 triangle_attribute_float4(KernelGlobals *kg,
   if (desc.element == ATTR_ELEMENT_CORNER_BYTE) {
     int tri = desc.offset + sd->prim * 3;
 
-    float4 f0 = color_uchar4_to_float4(kernel_tex_fetch(__attributes_uchar4, tri + 0));
-    float4 f1 = color_uchar4_to_float4(kernel_tex_fetch(__attributes_uchar4, tri + 1));
-    float4 f2 = color_uchar4_to_float4(kernel_tex_fetch(__attributes_uchar4, tri + 2));
+    float4 f0 = triangle_attribute_fetch_uchar4(kg, desc, tri + 0);
+    float4 f1 = triangle_attribute_fetch_uchar4(kg, desc, tri + 1);
+    float4 f2 = triangle_attribute_fetch_uchar4(kg, desc, tri + 2);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
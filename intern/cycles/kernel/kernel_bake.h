@@ -287,7 +287,7 @@ ccl_device void kernel_bake_evaluate(
       v,
       1.0f,
       0.5f,
-      !(kernel_tex_fetch(__object_flag, object) & SD_OBJECT_TRANSFORM_APPLIED),
+      !(kernel_tex_fetch(__instances, object).flag & SD_OBJECT_TRANSFORM_APPLIED),
       LAMP_NONE);
   sd.I = sd.N;
 
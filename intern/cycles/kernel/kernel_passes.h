@@ -147,6 +147,18 @@ ccl_device_inline void kernel_write_debug_passes(KernelGlobals *kg,
 }
 #endif /* __KERNEL_DEBUG__ */
 
+#if defined(__KERNEL_CPU__) && !defined(__SPLIT_KERNEL__)
+ccl_device_inline void kernel_write_profile_pass(KernelGlobals *kg, ccl_global float *buffer)
+{
+  /* Shader time is stored in microseconds to keep values in a readable range. */
+  kernel_write_pass_float4(buffer + kernel_data.film.pass_profile,
+                           make_float4((float)kg->profiler.traversal_steps,
+                                       (float)kg->profiler.intersections,
+                                       (float)(kg->profiler.shader_time * 1e6),
+                                       0.0f));
+}
+#endif
+
 #ifdef __KERNEL_CPU__
 #  define WRITE_ID_SLOT(buffer, depth, id, matte_weight, name) \
     kernel_write_id_pass_cpu(buffer, depth * 2, id, matte_weight, kg->coverage_##name)
@@ -392,6 +404,12 @@ ccl_device_inline void kernel_write_result(KernelGlobals *kg,
   kernel_write_debug_passes(kg, buffer, L);
 #endif
 
+#if defined(__KERNEL_CPU__) && !defined(__SPLIT_KERNEL__)
+  if (kernel_data.film.pass_profile) {
+    kernel_write_profile_pass(kg, buffer);
+  }
+#endif
+
   /* Adaptive Sampling. Fill the additional buffer with the odd samples and calculate our stopping
      criteria. This is the heuristic from "A hierarchical automatic stopping condition for Monte
      Carlo global illumination" except that here it is applied per pixel and not in hierarchical
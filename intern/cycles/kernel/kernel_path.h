@@ -69,7 +69,9 @@ ccl_device_forceinline bool kernel_path_scene_intersect(KernelGlobals *kg,
     ray->t = kernel_data.background.ao_distance;
   }
 
+  PROFILING_COST_INTERSECT_BEGIN(kg);
   bool hit = scene_intersect(kg, ray, visibility, isect);
+  PROFILING_COST_INTERSECT_END_HIT(kg, hit, isect);
 
 #ifdef __KERNEL_DEBUG__
   if (state->flag & PATH_RAY_CAMERA) {
@@ -679,6 +681,8 @@ ccl_device void kernel_path_trace(
   }
 #  endif
 
+  PROFILING_COST_RESET(kg);
+
   /* Initialize state. */
   float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
 
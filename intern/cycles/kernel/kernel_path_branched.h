@@ -541,6 +541,7 @@ ccl_device void kernel_branched_path_trace(
   PathRadiance L;
 
   if (ray.t != 0.0f) {
+    PROFILING_COST_RESET(kg);
     kernel_branched_path_integrate(kg, rng_hash, sample, ray, buffer, &L);
     kernel_write_result(kg, buffer, sample, &L);
   }
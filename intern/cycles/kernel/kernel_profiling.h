@@ -32,13 +32,62 @@ CCL_NAMESPACE_BEGIN
     }
 #  define PROFILING_OBJECT(object) \
     if ((object) != PRIM_NONE) { \
-      profiling_helper.set_object(object); \
+      profiling_helper.set_object(object_instance_object(kg, object)); \
     }
+
+/* Statistics are gathered per object, for all its instances together. */
+#  define PROFILING_OBJECT_INDEX(kg, object) \
+    (((object) == OBJECT_NONE) ? OBJECT_NONE : object_instance_object(kg, object))
+
+/* Ray cost counters for the profile pass and per-object statistics. They are only counted
+ * when the pass is enabled or the profiler is running, as decided at the start of a sample. */
+#  define PROFILING_COST_RESET(kg) (kg)->profiler.reset_cost(kernel_data.film.pass_profile != 0)
+#  define PROFILING_COST_TRAVERSAL_STEP(kg) \
+    do { \
+      if ((kg)->profiler.use_cost) { \
+        (kg)->profiler.traversal_steps++; \
+      } \
+    } while (0)
+#  define PROFILING_COST_INTERSECTION(kg) \
+    do { \
+      if ((kg)->profiler.use_cost) { \
+        (kg)->profiler.intersections++; \
+      } \
+    } while (0)
+/* The cost of a scene intersection is charged to one object. Camera and bounce rays charge the
+ * object they hit, shadow and subsurface rays the object they are cast from, and volume stack rays
+ * the nearest volume they hit. Without an object the cost only goes to the profile pass. */
+#  define PROFILING_COST_INTERSECT_BEGIN(kg) \
+    const uint32_t profiling_traversal_steps = (kg)->profiler.traversal_steps; \
+    const uint32_t profiling_intersections = (kg)->profiler.intersections
+#  define PROFILING_COST_INTERSECT_END(kg, object) \
+    if ((kg)->profiler.use_cost) { \
+      (kg)->profiler.add_object_cost(PROFILING_OBJECT_INDEX(kg, object), \
+                                     (kg)->profiler.traversal_steps - profiling_traversal_steps, \
+                                     (kg)->profiler.intersections - profiling_intersections); \
+    }
+#  define PROFILING_COST_INTERSECT_END_HIT(kg, hit, isect) \
+    PROFILING_COST_INTERSECT_END(kg, \
+                                 !(hit) ? OBJECT_NONE : \
+                                          ((isect)->object == OBJECT_NONE) ? \
+                                          kernel_tex_fetch(__prim_object, (isect)->prim) : \
+                                          (isect)->object)
+#  define PROFILING_COST_SHADER_TIMER(kg, object) \
+    ProfilingShaderTimer profiling_shader_timer( \
+        &(kg)->profiler, (kg)->profiler.use_cost, PROFILING_OBJECT_INDEX(kg, object))
 #else
 #  define PROFILING_INIT(kg, event)
 #  define PROFILING_EVENT(event)
 #  define PROFILING_SHADER(shader)
 #  define PROFILING_OBJECT(object)
+
+#  define PROFILING_COST_RESET(kg)
+#  define PROFILING_COST_TRAVERSAL_STEP(kg)
+#  define PROFILING_COST_INTERSECTION(kg)
+#  define PROFILING_COST_INTERSECT_BEGIN(kg)
+#  define PROFILING_COST_INTERSECT_END(kg, object)
+#  define PROFILING_COST_INTERSECT_END_HIT(kg, hit, isect)
+#  define PROFILING_COST_SHADER_TIMER(kg, object)
 #endif /* __KERNEL_CPU__ */
 
 CCL_NAMESPACE_END
@@ -71,7 +71,7 @@ ccl_device_noinline
 
   sd->type = isect->type;
   sd->flag = 0;
-  sd->object_flag = kernel_tex_fetch(__object_flag, sd->object);
+  sd->object_flag = kernel_tex_fetch(__instances, sd->object).flag;
 
   /* matrices and time */
 #ifdef __OBJECT_MOTION__
@@ -181,7 +181,7 @@ ccl_device_inline
 
   /* object, matrices, time, ray_length stay the same */
   sd->flag = 0;
-  sd->object_flag = kernel_tex_fetch(__object_flag, sd->object);
+  sd->object_flag = kernel_tex_fetch(__instances, sd->object).flag;
   sd->prim = kernel_tex_fetch(__prim_index, isect->prim);
   sd->type = isect->type;
 
@@ -301,7 +301,7 @@ ccl_device_inline void shader_setup_from_sample(KernelGlobals *kg,
   sd->flag = kernel_tex_fetch(__shaders, (sd->shader & SHADER_MASK)).flags;
   sd->object_flag = 0;
   if (sd->object != OBJECT_NONE) {
-    sd->object_flag |= kernel_tex_fetch(__object_flag, sd->object);
+    sd->object_flag |= kernel_tex_fetch(__instances, sd->object).flag;
 
 #ifdef __OBJECT_MOTION__
     shader_setup_object_transforms(kg, sd, time);
@@ -409,7 +409,7 @@ ccl_device void shader_setup_from_displace(
       v,
       0.0f,
       0.5f,
-      !(kernel_tex_fetch(__object_flag, object) & SD_OBJECT_TRANSFORM_APPLIED),
+      !(kernel_tex_fetch(__instances, object).flag & SD_OBJECT_TRANSFORM_APPLIED),
       LAMP_NONE);
 }
 
@@ -1069,6 +1069,7 @@ ccl_device void shader_eval_surface(KernelGlobals *kg,
                                     int path_flag)
 {
   PROFILING_INIT(kg, PROFILING_SHADER_EVAL);
+  PROFILING_COST_SHADER_TIMER(kg, sd->object);
 
   /* If path is being terminated, we are tracing a shadow ray or evaluating
    * emission, then we don't need to store closures. The emission and shadow
@@ -1291,7 +1292,7 @@ ccl_device_inline void shader_eval_volume(KernelGlobals *kg,
     sd->object_flag &= ~SD_OBJECT_FLAGS;
 
     if (sd->object != OBJECT_NONE) {
-      sd->object_flag |= kernel_tex_fetch(__object_flag, sd->object);
+      sd->object_flag |= kernel_tex_fetch(__instances, sd->object).flag;
 
 #  ifdef __OBJECT_MOTION__
       /* todo: this is inefficient for motion blur, we should be
@@ -1301,6 +1302,7 @@ ccl_device_inline void shader_eval_volume(KernelGlobals *kg,
     }
 
     /* evaluate shader */
+    PROFILING_COST_SHADER_TIMER(kg, sd->object);
 #  ifdef __SVM__
 #    ifdef __OSL__
     if (kg->osl) {
@@ -383,12 +383,12 @@ ccl_device bool shadow_blocked_transparent_stepped(KernelGlobals *kg,
 #  endif /* __KERNEL_GPU__ || !__SHADOW_RECORD_ALL__ */
 #endif   /* __TRANSPARENT_SHADOWS__ */
 
-ccl_device_inline bool shadow_blocked(KernelGlobals *kg,
-                                      ShaderData *sd,
-                                      ShaderData *shadow_sd,
-                                      ccl_addr_space PathState *state,
-                                      Ray *ray,
-                                      float3 *shadow)
+ccl_device_inline bool shadow_blocked_intersect(KernelGlobals *kg,
+                                                ShaderData *sd,
+                                                ShaderData *shadow_sd,
+                                                ccl_addr_space PathState *state,
+                                                Ray *ray,
+                                                float3 *shadow)
 {
   *shadow = make_float3(1.0f, 1.0f, 1.0f);
 #if !defined(__KERNEL_OPTIX__)
@@ -461,6 +461,19 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg,
 #endif   /* __TRANSPARENT_SHADOWS__ */
 }
 
+ccl_device_inline bool shadow_blocked(KernelGlobals *kg,
+                                      ShaderData *sd,
+                                      ShaderData *shadow_sd,
+                                      ccl_addr_space PathState *state,
+                                      Ray *ray,
+                                      float3 *shadow)
+{
+  PROFILING_COST_INTERSECT_BEGIN(kg);
+  const bool blocked = shadow_blocked_intersect(kg, sd, shadow_sd, state, ray, shadow);
+  PROFILING_COST_INTERSECT_END(kg, sd->object);
+  return blocked;
+}
+
 #undef SHADOW_STACK_MAX_HITS
 
 CCL_NAMESPACE_END
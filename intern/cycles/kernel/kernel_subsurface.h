@@ -222,7 +222,9 @@ ccl_device_inline int subsurface_scatter_disk(KernelGlobals *kg,
 
   /* intersect with the same object. if multiple intersections are found it
    * will use at most BSSRDF_MAX_HITS hits, a random subset of all hits */
+  PROFILING_COST_INTERSECT_BEGIN(kg);
   scene_intersect_local(kg, ray, ss_isect, sd->object, lcg_state, BSSRDF_MAX_HITS);
+  PROFILING_COST_INTERSECT_END(kg, sd->object);
   int num_eval_hits = min(ss_isect->num_hits, BSSRDF_MAX_HITS);
 
   for (int hit = 0; hit < num_eval_hits; hit++) {
@@ -424,7 +426,9 @@ ccl_device_noinline
     float t = -logf(1.0f - rdist) / sample_sigma_t;
 
     ray->t = t;
+    PROFILING_COST_INTERSECT_BEGIN(kg);
     scene_intersect_local(kg, ray, ss_isect, sd->object, NULL, 1);
+    PROFILING_COST_INTERSECT_END(kg, sd->object);
     hit = (ss_isect->num_hits > 0);
 
     if (hit) {
@@ -27,14 +27,13 @@ KERNEL_TEX(uint, __prim_type)
 KERNEL_TEX(uint, __prim_visibility)
 KERNEL_TEX(uint, __prim_index)
 KERNEL_TEX(uint, __prim_object)
-KERNEL_TEX(uint, __object_node)
 KERNEL_TEX(float2, __prim_time)
 
 /* objects */
 KERNEL_TEX(KernelObject, __objects)
+KERNEL_TEX(KernelInstance, __instances)
 KERNEL_TEX(Transform, __object_motion_pass)
 KERNEL_TEX(DecomposedTransform, __object_motion)
-KERNEL_TEX(uint, __object_flag)
 KERNEL_TEX(float, __object_volume_step)
 
 /* cameras */
@@ -60,6 +59,7 @@ KERNEL_TEX(float, __attributes_float)
 KERNEL_TEX(float2, __attributes_float2)
 KERNEL_TEX(float4, __attributes_float3)
 KERNEL_TEX(uchar4, __attributes_uchar4)
+KERNEL_TEX(uint, __attributes_uint)
 
 /* lights */
 KERNEL_TEX(KernelLightDistribution, __light_distribution)
@@ -374,6 +374,7 @@ typedef enum PassType {
   PASS_AOV_VALUE,
   PASS_ADAPTIVE_AUX_BUFFER,
   PASS_SAMPLE_COUNT,
+  PASS_PROFILE,
   PASS_CATEGORY_MAIN_END = 31,
 
   PASS_MIST = 32,
@@ -771,6 +772,14 @@ typedef enum AttributeStandard {
 typedef enum AttributeFlag {
   ATTR_FINAL_SIZE = (1 << 0),
   ATTR_SUBDIVIDED = (1 << 1),
+
+  /* Compact storage formats of triangle mesh attributes, packed in __attributes_uint.
+   * Unit vectors are octahedral encoded in two 16 bit integers, float2 values are
+   * stored as half floats. */
+  ATTR_COMPACT_OCTAHEDRAL = (1 << 2),
+  ATTR_COMPACT_HALF = (1 << 3),
+  /* Byte colors are sRGB encoded and converted to linear on lookup. */
+  ATTR_COMPACT_SRGB = (1 << 4),
 } AttributeFlag;
 
 typedef struct AttributeDescriptor {
@@ -1254,7 +1263,7 @@ typedef struct KernelFilm {
 
   int pass_bake_primitive;
   int pass_bake_differential;
-  int pad;
+  int pass_profile;
 
 #ifdef __KERNEL_DEBUG__
   int pass_bvh_traversed_nodes;
@@ -1458,17 +1467,9 @@ static_assert_align(KernelData, 16);
 /* Kernel data structures. */
 
 typedef struct KernelObject {
-  Transform tfm;
-  Transform itfm;
-
   float surface_area;
   float pass_id;
-  float random_number;
   float color[3];
-  int particle_index;
-
-  float dupli_generated[3];
-  float dupli_uv[2];
 
   int numkeys;
   int numsteps;
@@ -1476,13 +1477,37 @@ typedef struct KernelObject {
 
   uint patch_map_offset;
   uint attribute_map_offset;
-  uint motion_offset;
 
   float cryptomatte_object;
   float cryptomatte_asset;
 } KernelObject;
 static_assert_align(KernelObject, 16);
 
+/* Compact per-instance record. Every object has at least one instance, and the kernel refers to
+ * objects by the index of their instance. Instances of the same object only differ in what is
+ * stored here, everything else comes from the KernelObject they share. */
+typedef struct KernelInstance {
+  Transform tfm;
+  Transform itfm;
+
+  /* Root node of the BVH of the instanced geometry, negative for a leaf node. With Embree the
+   * offset of the geometry primitives instead. */
+  int node;
+  /* Index of the shared KernelObject. */
+  int object;
+  /* Object flags. */
+  uint flag;
+  float random_number;
+
+  float dupli_generated[3];
+  int particle_index;
+
+  float dupli_uv[2];
+  uint motion_offset;
+  int pad1;
+} KernelInstance;
+static_assert_align(KernelInstance, 16);
+
 typedef struct KernelSpotLight {
   float radius;
   float invarea;
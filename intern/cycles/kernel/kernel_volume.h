@@ -125,7 +125,7 @@ ccl_device float volume_stack_step_size(KernelGlobals *kg, ccl_addr_space Volume
        * heterogeneous volume objects may be using the same shader. */
       int object = stack[i].object;
       if (object != OBJECT_NONE) {
-        int object_flag = kernel_tex_fetch(__object_flag, object);
+        int object_flag = kernel_tex_fetch(__instances, object).flag;
         if (object_flag & SD_OBJECT_HAS_VOLUME_ATTRIBUTES) {
           heterogeneous = true;
         }
@@ -1197,6 +1197,7 @@ ccl_device void kernel_volume_stack_init(KernelGlobals *kg,
 
 #  ifdef __VOLUME_RECORD_ALL__
   Intersection hits[2 * VOLUME_STACK_SIZE + 1];
+  PROFILING_COST_INTERSECT_BEGIN(kg);
   uint num_hits = scene_intersect_volume_all(
       kg, &volume_ray, hits, 2 * VOLUME_STACK_SIZE, visibility);
   if (num_hits > 0) {
@@ -1204,6 +1205,7 @@ ccl_device void kernel_volume_stack_init(KernelGlobals *kg,
     Intersection *isect = hits;
 
     qsort(hits, num_hits, sizeof(Intersection), intersections_compare);
+    PROFILING_COST_INTERSECT_END_HIT(kg, true, hits);
 
     for (uint hit = 0; hit < num_hits; ++hit, ++isect) {
       shader_setup_from_ray(kg, stack_sd, isect, &volume_ray);
@@ -1363,12 +1365,14 @@ ccl_device void kernel_volume_stack_update_for_subsurface(KernelGlobals *kg,
 
 #    ifdef __VOLUME_RECORD_ALL__
   Intersection hits[2 * VOLUME_STACK_SIZE + 1];
+  PROFILING_COST_INTERSECT_BEGIN(kg);
   uint num_hits = scene_intersect_volume_all(
       kg, &volume_ray, hits, 2 * VOLUME_STACK_SIZE, PATH_RAY_ALL_VISIBILITY);
   if (num_hits > 0) {
     Intersection *isect = hits;
 
     qsort(hits, num_hits, sizeof(Intersection), intersections_compare);
+    PROFILING_COST_INTERSECT_END_HIT(kg, true, hits);
 
     for (uint hit = 0; hit < num_hits; ++hit, ++isect) {
       shader_setup_from_ray(kg, stack_sd, isect, &volume_ray);
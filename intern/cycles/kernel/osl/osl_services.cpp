@@ -834,7 +834,7 @@ bool OSLRenderServices::get_object_standard_attribute(
     return set_attribute_float3_3(P, type, derivatives, val);
   }
   else if (name == u_geom_name) {
-    ustring object_name = kg->osl->object_names[sd->object];
+    ustring object_name = kg->osl->object_names[object_instance_object(kg, sd->object)];
     return set_attribute_string(object_name, type, derivatives, val);
   }
   else if (name == u_is_smooth) {
@@ -968,6 +968,9 @@ bool OSLRenderServices::get_attribute(
 
     if (object == OBJECT_NONE)
       return get_background_attribute(kg, sd, name, type, derivatives, val);
+
+    /* Attributes are shared by all instances of an object. */
+    object = object_instance_object(kg, object);
   }
 
   /* find attribute on object */
@@ -383,7 +383,7 @@ int OSLShader::find_attribute(KernelGlobals *kg,
                               AttributeDescriptor *desc)
 {
   /* for OSL, a hash map is used to lookup the attribute by name. */
-  int object = sd->object * ATTR_PRIM_TYPES;
+  int object = object_instance_object(kg, sd->object) * ATTR_PRIM_TYPES;
 
   OSLGlobals::AttributeMap &attr_map = kg->osl->attribute_map[object];
   ustring stdname(std::string("geom:") +
@@ -59,6 +59,7 @@ ccl_device void kernel_path_init(KernelGlobals *kg)
      * These rays proceed with path-iteration.
      */
     kernel_split_state.throughput[ray_index] = make_float3(1.0f, 1.0f, 1.0f);
+    PROFILING_COST_RESET(kg);
     path_radiance_init(kg, &kernel_split_state.path_radiance[ray_index]);
     path_state_init(kg,
                     AS_SHADER_DATA(&kernel_split_state.sd_DL_shadow[ray_index]),
@@ -54,7 +54,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +76,39 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  else
+  /* On the CPU a single thread owns the whole block, so use a stable bottom-up
+   * merge sort instead of the bitonic network. */
+  ccl_local ushort *src = local_index;
+  ccl_local ushort *dst = &locals->local_index_temp[0];
+
+  for (int width = 1; width < SHADER_SORT_BLOCK_SIZE; width <<= 1) {
+    for (int start = 0; start < SHADER_SORT_BLOCK_SIZE; start += 2 * width) {
+      int mid = min(start + width, SHADER_SORT_BLOCK_SIZE);
+      int end = min(start + 2 * width, SHADER_SORT_BLOCK_SIZE);
+      int a = start, b = mid, k = start;
+
+      while (a < mid && b < end) {
+        dst[k++] = (local_value[src[b]] < local_value[src[a]]) ? src[b++] : src[a++];
+      }
+      while (a < mid) {
+        dst[k++] = src[a++];
+      }
+      while (b < end) {
+        dst[k++] = src[b++];
+      }
+    }
+
+    ccl_local ushort *tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  if (src != local_index) {
+    for (int i = 0; i < SHADER_SORT_BLOCK_SIZE; i++) {
+      local_index[i] = src[i];
+    }
+  }
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
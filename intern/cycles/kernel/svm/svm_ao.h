@@ -47,6 +47,8 @@ ccl_device_noinline float svm_ao(KernelGlobals *kg,
   float3 T, B;
   make_orthonormals(N, &T, &B);
 
+  PROFILING_COST_INTERSECT_BEGIN(kg);
+
   int unoccluded = 0;
   for (int sample = 0; sample < num_samples; sample++) {
     float disk_u, disk_v;
@@ -78,6 +80,8 @@ ccl_device_noinline float svm_ao(KernelGlobals *kg,
     }
   }
 
+  PROFILING_COST_INTERSECT_END(kg, sd->object);
+
   return ((float)unoccluded) / num_samples;
 }
 
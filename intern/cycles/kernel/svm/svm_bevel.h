@@ -49,6 +49,8 @@ ccl_device_noinline float3 svm_bevel(KernelGlobals *kg,
   LocalIntersection isect;
   uint lcg_state = lcg_state_init_addrspace(state, 0x64c6a40e);
 
+  PROFILING_COST_INTERSECT_BEGIN(kg);
+
   /* Sample normals from surrounding points on surface. */
   float3 sum_N = make_float3(0.0f, 0.0f, 0.0f);
 
@@ -136,7 +138,7 @@ ccl_device_noinline float3 svm_bevel(KernelGlobals *kg,
       int object = (isect.hits[hit].object == OBJECT_NONE) ?
                        kernel_tex_fetch(__prim_object, isect.hits[hit].prim) :
                        isect.hits[hit].object;
-      int object_flag = kernel_tex_fetch(__object_flag, object);
+      int object_flag = kernel_tex_fetch(__instances, object).flag;
       if (object_flag & SD_OBJECT_NEGATIVE_SCALE_APPLIED) {
         hit_Ng = -hit_Ng;
       }
@@ -193,6 +195,8 @@ ccl_device_noinline float3 svm_bevel(KernelGlobals *kg,
     }
   }
 
+  PROFILING_COST_INTERSECT_END(kg, sd->object);
+
   /* Normalize. */
   float3 N = safe_normalize(sum_N);
   return is_zero(N) ? sd->N : (sd->flag & SD_BACKFACING) ? -N : N;
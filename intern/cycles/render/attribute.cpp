@@ -20,6 +20,8 @@
 #include "render/mesh.h"
 
 #include "util/util_foreach.h"
+#include "util/util_half.h"
+#include "util/util_md5.h"
 #include "util/util_transform.h"
 
 CCL_NAMESPACE_BEGIN
@@ -28,7 +30,14 @@ CCL_NAMESPACE_BEGIN
 
 Attribute::Attribute(
     ustring name, TypeDesc type, AttributeElement element, Geometry *geom, AttributePrimitive prim)
-    : name(name), std(ATTR_STD_NONE), type(type), element(element), flags(0)
+    : name(name),
+      std(ATTR_STD_NONE),
+      type(type),
+      element(element),
+      flags(0),
+      compact(COMPACT_AUTO),
+      compact_flags_cache(0),
+      compact_flags_cache_valid(false)
 {
   /* string and matrix not supported! */
   assert(type == TypeDesc::TypeFloat || type == TypeDesc::TypeColor ||
@@ -56,6 +65,8 @@ Attribute::~Attribute()
 
 void Attribute::resize(Geometry *geom, AttributePrimitive prim, bool reserve_only)
 {
+  compact_flags_cache_valid = false;
+
   if (element != ATTR_ELEMENT_VOXEL) {
     if (reserve_only) {
       buffer.reserve(buffer_size(geom, prim));
@@ -68,6 +79,8 @@ void Attribute::resize(Geometry *geom, AttributePrimitive prim, bool reserve_onl
 
 void Attribute::resize(size_t num_elements)
 {
+  compact_flags_cache_valid = false;
+
   if (element != ATTR_ELEMENT_VOXEL) {
     buffer.resize(num_elements * data_sizeof(), 0);
   }
@@ -237,6 +250,65 @@ size_t Attribute::buffer_size(Geometry *geom, AttributePrimitive prim) const
   return element_size(geom, prim) * data_sizeof();
 }
 
+uint Attribute::compact_flags(Geometry *geom, AttributePrimitive prim) const
+{
+  /* Compact formats are only decoded for triangles of meshes without subdivision. */
+  if (compact == COMPACT_NEVER || prim != ATTR_PRIM_GEOMETRY || geom->type != Geometry::MESH) {
+    return 0;
+  }
+  if (static_cast<Mesh *>(geom)->subd_faces.size()) {
+    return 0;
+  }
+  if (element != ATTR_ELEMENT_VERTEX && element != ATTR_ELEMENT_CORNER) {
+    return 0;
+  }
+
+  const size_t size = element_size(geom, prim);
+
+  if (type == TypeDesc::TypeNormal || type == TypeDesc::TypeVector) {
+    /* Octahedral encoding only represents unit vectors, with an angular error
+     * small enough to not be visible in shading. It is never exact, so it has
+     * to be requested explicitly. */
+    if (compact != COMPACT_ALWAYS) {
+      return 0;
+    }
+    const float3 *data = data_float3();
+    for (size_t i = 0; i < size; i++) {
+      if (!(fabsf(len(data[i]) - 1.0f) < 1e-4f)) {
+        return 0;
+      }
+    }
+    return ATTR_COMPACT_OCTAHEDRAL;
+  }
+  else if (type == TypeFloat2) {
+    const float2 *data = data_float2();
+    for (size_t i = 0; i < size; i++) {
+      /* Out of range values or NaN can not be stored. */
+      if (!(fabsf(data[i].x) <= 65504.0f && fabsf(data[i].y) <= 65504.0f)) {
+        return 0;
+      }
+      if (compact == COMPACT_AUTO) {
+        const float2 value = half2_to_float2(float2_to_half2(data[i]));
+        if (value.x != data[i].x || value.y != data[i].y) {
+          return 0;
+        }
+      }
+    }
+    return ATTR_COMPACT_HALF;
+  }
+
+  return 0;
+}
+
+uint Attribute::cached_compact_flags(Geometry *geom, AttributePrimitive prim, bool modified)
+{
+  if (modified || !compact_flags_cache_valid) {
+    compact_flags_cache = compact_flags(geom, prim);
+    compact_flags_cache_valid = true;
+  }
+  return compact_flags_cache;
+}
+
 bool Attribute::same_storage(TypeDesc a, TypeDesc b)
 {
   if (a == b)
@@ -614,6 +686,38 @@ void AttributeSet::clear(bool preserve_voxel_data)
   }
 }
 
+void AttributeSet::hash(MD5Hash &md5) const
+{
+  foreach (const Attribute &attr, attributes) {
+    md5.append(attr.name.string());
+
+    const int header[] = {attr.std,
+                          attr.type.basetype,
+                          attr.type.aggregate,
+                          attr.type.vecsemantics,
+                          attr.type.arraylen,
+                          attr.element,
+                          (int)attr.flags,
+                          attr.compact};
+    md5.append((const uint8_t *)header, sizeof(header));
+
+    if (attr.element == ATTR_ELEMENT_VOXEL) {
+      /* Voxel data lives in the image manager, the slot identifies it. */
+      const int slot = attr.data_voxel().svm_slot();
+      md5.append((const uint8_t *)&slot, sizeof(slot));
+    }
+    else {
+      /* MD5Hash takes int sizes, append large buffers in chunks. */
+      const uint8_t *data = (const uint8_t *)attr.data();
+      const size_t size = attr.buffer.size();
+      const size_t chunk_size = 1 << 30;
+      for (size_t offset = 0; offset < size; offset += chunk_size) {
+        md5.append(data + offset, (int)std::min(chunk_size, size - offset));
+      }
+    }
+  }
+}
+
 /* AttributeRequest */
 
 AttributeRequest::AttributeRequest(ustring name_)
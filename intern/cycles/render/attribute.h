@@ -34,6 +34,7 @@ class AttributeRequest;
 class AttributeRequestSet;
 class AttributeSet;
 class ImageHandle;
+class MD5Hash;
 class Geometry;
 class Hair;
 class Mesh;
@@ -54,6 +55,23 @@ class Attribute {
   AttributeElement element;
   uint flags; /* enum AttributeFlag */
 
+  /* Storage of the attribute in device memory. Compact formats trade precision
+   * for memory, see ATTR_COMPACT_* flags. */
+  enum CompactMode {
+    /* Always store full precision values. */
+    COMPACT_NEVER,
+    /* Use a compact format only if it represents the data exactly. */
+    COMPACT_AUTO,
+    /* Use a compact format whenever it can represent the data, even if lossy. This is the
+     * only mode using octahedral encoding for unit vectors. */
+    COMPACT_ALWAYS,
+  };
+  CompactMode compact;
+
+  /* Result of the last compact_flags() scan. */
+  uint compact_flags_cache;
+  bool compact_flags_cache_valid;
+
   Attribute(ustring name,
             TypeDesc type,
             AttributeElement element,
@@ -72,6 +90,11 @@ class Attribute {
   size_t element_size(Geometry *geom, AttributePrimitive prim) const;
   size_t buffer_size(Geometry *geom, AttributePrimitive prim) const;
 
+  /* Compact storage format flags to use for device memory, or 0 for full precision. */
+  uint compact_flags(Geometry *geom, AttributePrimitive prim) const;
+  /* Same, but only scans the data again if it was modified since the previous call. */
+  uint cached_compact_flags(Geometry *geom, AttributePrimitive prim, bool modified);
+
   char *data()
   {
     return (buffer.size()) ? &buffer[0] : NULL;
@@ -193,6 +216,9 @@ class AttributeSet {
 
   void resize(bool reserve_only = false);
   void clear(bool preserve_voxel_data = false);
+
+  /* Hash of names, types and data of all attributes. */
+  void hash(MD5Hash &md5) const;
 };
 
 /* AttributeRequest
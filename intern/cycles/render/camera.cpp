@@ -500,7 +500,14 @@ void Camera::device_update_volume(Device * /*device*/, DeviceScene *dscene, Scen
   BoundBox viewplane_boundbox = viewplane_bounds_get();
   for (size_t i = 0; i < scene->objects.size(); ++i) {
     Object *object = scene->objects[i];
-    if (object->geometry->has_volume && viewplane_boundbox.intersects(object->bounds)) {
+    if (!object->geometry->has_volume) {
+      continue;
+    }
+    bool inside_volume = viewplane_boundbox.intersects(object->bounds);
+    for (size_t j = 0; j < object->num_instances() && !inside_volume; ++j) {
+      inside_volume = viewplane_boundbox.intersects(object->instance_bounds(j));
+    }
+    if (inside_volume) {
       /* TODO(sergey): Consider adding more grained check. */
       VLOG(1) << "Detected camera inside volume.";
       kcam->is_inside_volume = 1;
@@ -190,6 +190,11 @@ void Pass::add(PassType type, vector<Pass> &passes, const char *name)
       pass.components = 1;
       pass.exposure = false;
       break;
+    case PASS_PROFILE:
+      /* Traversal steps, intersection tests and shader time, only written by the CPU kernel. */
+      pass.components = 4;
+      pass.exposure = false;
+      break;
     case PASS_AOV_COLOR:
       pass.components = 4;
       break;
@@ -368,6 +373,7 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
   kfilm->use_light_pass = use_light_visibility;
   kfilm->pass_aov_value_num = 0;
   kfilm->pass_aov_color_num = 0;
+  kfilm->pass_profile = 0;
 
   bool have_cryptomatte = false;
 
@@ -512,6 +518,15 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
       case PASS_SAMPLE_COUNT:
         kfilm->pass_sample_count = kfilm->pass_stride;
         break;
+      case PASS_PROFILE:
+        /* Ray cost is counted per path in the thread's profiling state, which the split kernel
+         * shares between all the paths it has in flight. */
+        if (device->info.use_split_kernel) {
+          device->set_error("Debug Profile pass is not supported with the split kernel");
+          break;
+        }
+        kfilm->pass_profile = kfilm->pass_stride;
+        break;
       case PASS_AOV_COLOR:
         if (kfilm->pass_aov_color_num == 0) {
           kfilm->pass_aov_color = kfilm->pass_stride;
@@ -39,8 +39,11 @@
 #include "kernel/osl/osl_globals.h"
 
 #include "util/util_foreach.h"
+#include "util/util_half.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -61,6 +64,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 {
   need_update = true;
   need_update_rebuild = false;
+  need_update_packed = true;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -89,6 +93,12 @@ void Geometry::clear()
   transform_normal = transform_identity();
 }
 
+void Geometry::hash_content(MD5Hash &md5)
+{
+  hash(md5);
+  attributes.hash(md5);
+}
+
 bool Geometry::need_attribute(Scene *scene, AttributeStandard std)
 {
   if (std == ATTR_STD_NONE)
@@ -265,6 +275,8 @@ GeometryManager::GeometryManager()
 {
   need_update = true;
   need_flags_update = true;
+  attribute_compact_saved = 0;
+  packed_default_shader_id = -1;
 }
 
 GeometryManager::~GeometryManager()
@@ -474,20 +486,67 @@ void GeometryManager::update_svm_attributes(Device *,
   dscene->attributes_map.copy_to_device();
 }
 
+/* Device arrays that keep their size and device memory can be updated in place. */
+template<typename T> static bool device_vector_reusable(device_vector<T> &data, size_t size)
+{
+  return data.size() == size && (size == 0 || data.device_pointer != 0);
+}
+
+/* Element ranges of a device array to copy, adjacent ranges are merged. */
+class DeviceCopyRanges {
+ public:
+  void add(size_t begin, size_t end)
+  {
+    if (begin == end) {
+      return;
+    }
+    if (!ranges.empty() && ranges.back().second == begin) {
+      ranges.back().second = end;
+    }
+    else {
+      ranges.push_back(std::make_pair(begin, end));
+    }
+  }
+
+  template<typename T> void copy_to_device(device_vector<T> &data)
+  {
+    for (size_t i = 0; i < ranges.size(); i++) {
+      data.copy_to_device_range(ranges[i].first, ranges[i].second - ranges[i].first);
+    }
+  }
+
+ private:
+  vector<std::pair<size_t, size_t>> ranges;
+};
+
 static void update_attribute_element_size(Geometry *geom,
                                           Attribute *mattr,
                                           AttributePrimitive prim,
+                                          AttributeDescriptor &desc,
                                           size_t *attr_float_size,
                                           size_t *attr_float2_size,
                                           size_t *attr_float3_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_uint_size,
+                                          size_t *attr_compact_full_size)
 {
   if (mattr) {
     size_t size = mattr->element_size(geom, prim);
 
+    /* choose storage format here, the arrays are filled accordingly */
+    desc.flags = mattr->flags | mattr->cached_compact_flags(geom, prim, false);
+
     if (mattr->element == ATTR_ELEMENT_VOXEL) {
       /* pass */
     }
+    else if (desc.flags & ATTR_COMPACT_OCTAHEDRAL) {
+      *attr_uint_size += size;
+      *attr_compact_full_size += size * sizeof(float4);
+    }
+    else if (desc.flags & ATTR_COMPACT_HALF) {
+      *attr_uint_size += size;
+      *attr_compact_full_size += size * sizeof(float2);
+    }
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
       *attr_uchar4_size += size;
     }
@@ -498,7 +557,7 @@ static void update_attribute_element_size(Geometry *geom,
       *attr_float2_size += size;
     }
     else if (mattr->type == TypeDesc::TypeMatrix) {
-      *attr_float3_size += size * 4;
+      *attr_float3_size += size * 3;
     }
     else {
       *attr_float3_size += size;
@@ -515,15 +574,17 @@ static void update_attribute_element_offset(Geometry *geom,
                                             size_t &attr_float3_offset,
                                             device_vector<uchar4> &attr_uchar4,
                                             size_t &attr_uchar4_offset,
+                                            device_vector<uint> &attr_uint,
+                                            size_t &attr_uint_offset,
                                             Attribute *mattr,
                                             AttributePrimitive prim,
                                             TypeDesc &type,
-                                            AttributeDescriptor &desc)
+                                            AttributeDescriptor &desc,
+                                            bool copy_data)
 {
   if (mattr) {
-    /* store element and type */
+    /* store element and type, flags were set when computing the size */
     desc.element = mattr->element;
-    desc.flags = mattr->flags;
     type = mattr->type;
 
     /* store attribute data in arrays */
@@ -537,53 +598,80 @@ static void update_attribute_element_offset(Geometry *geom,
       ImageHandle &handle = mattr->data_voxel();
       offset = handle.svm_slot();
     }
+    else if (desc.flags & ATTR_COMPACT_OCTAHEDRAL) {
+      offset = attr_uint_offset;
+      if (copy_data) {
+        float3 *data = mattr->data_float3();
+        assert(attr_uint.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_uint[offset + k] = float3_to_octahedral(data[k]);
+        }
+      }
+      attr_uint_offset += size;
+    }
+    else if (desc.flags & ATTR_COMPACT_HALF) {
+      offset = attr_uint_offset;
+      if (copy_data) {
+        float2 *data = mattr->data_float2();
+        assert(attr_uint.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_uint[offset + k] = float2_to_half2(data[k]);
+        }
+      }
+      attr_uint_offset += size;
+    }
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
-      uchar4 *data = mattr->data_uchar4();
       offset = attr_uchar4_offset;
-
-      assert(attr_uchar4.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_uchar4[offset + k] = data[k];
+      if (copy_data) {
+        uchar4 *data = mattr->data_uchar4();
+        assert(attr_uchar4.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_uchar4[offset + k] = data[k];
+        }
       }
       attr_uchar4_offset += size;
     }
     else if (mattr->type == TypeDesc::TypeFloat) {
-      float *data = mattr->data_float();
       offset = attr_float_offset;
-
-      assert(attr_float.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float[offset + k] = data[k];
+      if (copy_data) {
+        float *data = mattr->data_float();
+        assert(attr_float.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_float[offset + k] = data[k];
+        }
       }
       attr_float_offset += size;
     }
     else if (mattr->type == TypeFloat2) {
-      float2 *data = mattr->data_float2();
       offset = attr_float2_offset;
-
-      assert(attr_float2.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float2[offset + k] = data[k];
+      if (copy_data) {
+        float2 *data = mattr->data_float2();
+        assert(attr_float2.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_float2[offset + k] = data[k];
+        }
       }
       attr_float2_offset += size;
     }
     else if (mattr->type == TypeDesc::TypeMatrix) {
-      Transform *tfm = mattr->data_transform();
       offset = attr_float3_offset;
-
-      assert(attr_float3.size() >= offset + size * 3);
-      for (size_t k = 0; k < size * 3; k++) {
-        attr_float3[offset + k] = (&tfm->x)[k];
+      if (copy_data) {
+        Transform *tfm = mattr->data_transform();
+        assert(attr_float3.size() >= offset + size * 3);
+        for (size_t k = 0; k < size * 3; k++) {
+          attr_float3[offset + k] = (&tfm->x)[k];
+        }
       }
       attr_float3_offset += size * 3;
     }
     else {
-      float4 *data = mattr->data_float4();
       offset = attr_float3_offset;
-
-      assert(attr_float3.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float3[offset + k] = data[k];
+      if (copy_data) {
+        float4 *data = mattr->data_float4();
+        assert(attr_float3.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_float3[offset + k] = data[k];
+        }
       }
       attr_float3_offset += size;
     }
@@ -631,6 +719,92 @@ static void update_attribute_element_offset(Geometry *geom,
   }
 }
 
+static bool attribute_offsets_equal(const AttributeArrayOffsets &a,
+                                    const AttributeArrayOffsets &b)
+{
+  return a.float_offset == b.float_offset && a.float2_offset == b.float2_offset &&
+         a.float3_offset == b.float3_offset && a.uchar4_offset == b.uchar4_offset &&
+         a.uint_offset == b.uint_offset;
+}
+
+/* Choose the compact storage formats of the attributes, the data is only scanned again
+ * for geometry that changed since it was last packed. */
+static void update_geometry_attribute_compact_flags(Geometry *geom,
+                                                    AttributeRequestSet *attributes)
+{
+  foreach (AttributeRequest &req, attributes->requests) {
+    Attribute *attr = geom->attributes.find(req);
+    if (attr) {
+      attr->cached_compact_flags(geom, ATTR_PRIM_GEOMETRY, geom->need_update_packed);
+    }
+  }
+}
+
+static void update_geometry_attributes(Geometry *geom,
+                                       AttributeRequestSet *attributes,
+                                       DeviceScene *dscene,
+                                       AttributeArrayOffsets offsets,
+                                       bool copy_data,
+                                       Progress *progress)
+{
+  /* todo: we now store std and name attributes from requests even if
+   * they actually refer to the same mesh attributes, optimize */
+  foreach (AttributeRequest &req, attributes->requests) {
+    Attribute *attr = geom->attributes.find(req);
+    update_attribute_element_offset(geom,
+                                    dscene->attributes_float,
+                                    offsets.float_offset,
+                                    dscene->attributes_float2,
+                                    offsets.float2_offset,
+                                    dscene->attributes_float3,
+                                    offsets.float3_offset,
+                                    dscene->attributes_uchar4,
+                                    offsets.uchar4_offset,
+                                    dscene->attributes_uint,
+                                    offsets.uint_offset,
+                                    attr,
+                                    ATTR_PRIM_GEOMETRY,
+                                    req.type,
+                                    req.desc,
+                                    copy_data);
+
+    if (geom->type == Geometry::MESH) {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      Attribute *subd_attr = mesh->subd_attributes.find(req);
+
+      update_attribute_element_offset(mesh,
+                                      dscene->attributes_float,
+                                      offsets.float_offset,
+                                      dscene->attributes_float2,
+                                      offsets.float2_offset,
+                                      dscene->attributes_float3,
+                                      offsets.float3_offset,
+                                      dscene->attributes_uchar4,
+                                      offsets.uchar4_offset,
+                                      dscene->attributes_uint,
+                                      offsets.uint_offset,
+                                      subd_attr,
+                                      ATTR_PRIM_SUBD,
+                                      req.subd_type,
+                                      req.subd_desc,
+                                      copy_data);
+    }
+
+    if (progress->get_cancel())
+      return;
+  }
+}
+
+static void compute_object_bounds(vector<Object *> *objects,
+                                  size_t start,
+                                  size_t end,
+                                  bool motion_blur)
+{
+  for (size_t i = start; i < end; i++) {
+    (*objects)[i]->compute_bounds(motion_blur);
+  }
+}
+
 void GeometryManager::device_update_attributes(Device *device,
                                                DeviceScene *dscene,
                                                Scene *scene,
@@ -658,25 +832,51 @@ void GeometryManager::device_update_attributes(Device *device,
    * maps next */
 
   /* Pre-allocate attributes to avoid arrays re-allocation which would
-   * take 2x of overall attribute memory usage.
+   * take 2x of overall attribute memory usage. The offsets of each geometry
+   * are recorded here, so that the arrays can be filled in parallel with the
+   * same layout as filling them one geometry after another.
    */
+  vector<AttributeArrayOffsets> geom_offsets(scene->geometry.size());
+
+  /* Choosing a compact storage format scans the attribute data, do that for all
+   * geometry in parallel before the arrays are sized. */
+  {
+    TaskPool pool;
+    for (size_t i = 0; i < scene->geometry.size(); i++) {
+      pool.push(function_bind(
+          &update_geometry_attribute_compact_flags, scene->geometry[i], &geom_attributes[i]));
+    }
+    pool.wait_work();
+  }
+
   size_t attr_float_size = 0;
   size_t attr_float2_size = 0;
   size_t attr_float3_size = 0;
   size_t attr_uchar4_size = 0;
+  size_t attr_uint_size = 0;
+  size_t attr_compact_full_size = 0;
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
     AttributeRequestSet &attributes = geom_attributes[i];
+
+    geom_offsets[i].float_offset = attr_float_size;
+    geom_offsets[i].float2_offset = attr_float2_size;
+    geom_offsets[i].float3_offset = attr_float3_size;
+    geom_offsets[i].uchar4_offset = attr_uchar4_size;
+    geom_offsets[i].uint_offset = attr_uint_size;
     foreach (AttributeRequest &req, attributes.requests) {
       Attribute *attr = geom->attributes.find(req);
 
       update_attribute_element_size(geom,
                                     attr,
                                     ATTR_PRIM_GEOMETRY,
+                                    req.desc,
                                     &attr_float_size,
                                     &attr_float2_size,
                                     &attr_float3_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_uint_size,
+                                    &attr_compact_full_size);
 
       if (geom->type == Geometry::MESH) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -685,70 +885,67 @@ void GeometryManager::device_update_attributes(Device *device,
         update_attribute_element_size(mesh,
                                       subd_attr,
                                       ATTR_PRIM_SUBD,
+                                      req.subd_desc,
                                       &attr_float_size,
                                       &attr_float2_size,
                                       &attr_float3_size,
-                                      &attr_uchar4_size);
+                                      &attr_uchar4_size,
+                                      &attr_uint_size,
+                                      &attr_compact_full_size);
       }
     }
   }
 
+  AttributeArrayOffsets attr_sizes;
+  attr_sizes.float_offset = attr_float_size;
+  attr_sizes.float2_offset = attr_float2_size;
+  attr_sizes.float3_offset = attr_float3_size;
+  attr_sizes.uchar4_offset = attr_uchar4_size;
+  attr_sizes.uint_offset = attr_uint_size;
+
+  /* When every geometry keeps its place in the arrays, only geometry that changed since
+   * the previous update is packed and copied to the device again. */
+  bool pack_changed_only = device_vector_reusable(dscene->attributes_float, attr_float_size) &&
+                           device_vector_reusable(dscene->attributes_float2, attr_float2_size) &&
+                           device_vector_reusable(dscene->attributes_float3, attr_float3_size) &&
+                           device_vector_reusable(dscene->attributes_uchar4, attr_uchar4_size) &&
+                           device_vector_reusable(dscene->attributes_uint, attr_uint_size) &&
+                           packed_attribute_geometry == scene->geometry;
+  for (size_t i = 0; pack_changed_only && i < scene->geometry.size(); i++) {
+    pack_changed_only = attribute_offsets_equal(geom_offsets[i], packed_attribute_offsets[i]);
+  }
+  packed_attribute_geometry.clear();
+
   dscene->attributes_float.alloc(attr_float_size);
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
   dscene->attributes_uchar4.alloc(attr_uchar4_size);
-
-  size_t attr_float_offset = 0;
-  size_t attr_float2_offset = 0;
-  size_t attr_float3_offset = 0;
-  size_t attr_uchar4_offset = 0;
-
-  /* Fill in attributes. */
+  dscene->attributes_uint.alloc(attr_uint_size);
+
+  attribute_sizes.clear();
+  attribute_sizes.add_entry(NamedSizeEntry("Float", attr_float_size * sizeof(float)));
+  attribute_sizes.add_entry(NamedSizeEntry("Float2", attr_float2_size * sizeof(float2)));
+  attribute_sizes.add_entry(NamedSizeEntry("Float3", attr_float3_size * sizeof(float4)));
+  attribute_sizes.add_entry(NamedSizeEntry("Byte", attr_uchar4_size * sizeof(uchar4)));
+  attribute_sizes.add_entry(NamedSizeEntry("Compact", attr_uint_size * sizeof(uint)));
+  attribute_compact_saved = attr_compact_full_size - attr_uint_size * sizeof(uint);
+
+  /* Fill in attributes. Descriptors are computed for all geometry, data is only copied
+   * for geometry that is packed again. */
+  TaskPool pool;
   for (size_t i = 0; i < scene->geometry.size(); i++) {
-    Geometry *geom = scene->geometry[i];
-    AttributeRequestSet &attributes = geom_attributes[i];
-
-    /* todo: we now store std and name attributes from requests even if
-     * they actually refer to the same mesh attributes, optimize */
-    foreach (AttributeRequest &req, attributes.requests) {
-      Attribute *attr = geom->attributes.find(req);
-      update_attribute_element_offset(geom,
-                                      dscene->attributes_float,
-                                      attr_float_offset,
-                                      dscene->attributes_float2,
-                                      attr_float2_offset,
-                                      dscene->attributes_float3,
-                                      attr_float3_offset,
-                                      dscene->attributes_uchar4,
-                                      attr_uchar4_offset,
-                                      attr,
-                                      ATTR_PRIM_GEOMETRY,
-                                      req.type,
-                                      req.desc);
-
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        Attribute *subd_attr = mesh->subd_attributes.find(req);
-
-        update_attribute_element_offset(mesh,
-                                        dscene->attributes_float,
-                                        attr_float_offset,
-                                        dscene->attributes_float2,
-                                        attr_float2_offset,
-                                        dscene->attributes_float3,
-                                        attr_float3_offset,
-                                        dscene->attributes_uchar4,
-                                        attr_uchar4_offset,
-                                        subd_attr,
-                                        ATTR_PRIM_SUBD,
-                                        req.subd_type,
-                                        req.subd_desc);
-      }
-
-      if (progress.get_cancel())
-        return;
-    }
+    pool.push(function_bind(&update_geometry_attributes,
+                            scene->geometry[i],
+                            &geom_attributes[i],
+                            dscene,
+                            geom_offsets[i],
+                            !pack_changed_only || scene->geometry[i]->need_update_packed,
+                            &progress));
   }
+  pool.wait_work();
+
+  if (progress.get_cancel())
+    return;
 
   /* create attribute lookup maps */
   if (scene->shader_manager->use_osl())
@@ -762,22 +959,54 @@ void GeometryManager::device_update_attributes(Device *device,
   /* copy to device */
   progress.set_status("Updating Mesh", "Copying Attributes to device");
 
-  if (dscene->attributes_float.size()) {
-    dscene->attributes_float.copy_to_device();
-  }
-  if (dscene->attributes_float2.size()) {
-    dscene->attributes_float2.copy_to_device();
-  }
-  if (dscene->attributes_float3.size()) {
-    dscene->attributes_float3.copy_to_device();
+  if (pack_changed_only) {
+    DeviceCopyRanges float_ranges, float2_ranges, float3_ranges, uchar4_ranges, uint_ranges;
+
+    for (size_t i = 0; i < scene->geometry.size(); i++) {
+      if (!scene->geometry[i]->need_update_packed) {
+        continue;
+      }
+
+      const AttributeArrayOffsets &begin = geom_offsets[i];
+      const AttributeArrayOffsets &end = (i + 1 < scene->geometry.size()) ? geom_offsets[i + 1] :
+                                                                            attr_sizes;
+      float_ranges.add(begin.float_offset, end.float_offset);
+      float2_ranges.add(begin.float2_offset, end.float2_offset);
+      float3_ranges.add(begin.float3_offset, end.float3_offset);
+      uchar4_ranges.add(begin.uchar4_offset, end.uchar4_offset);
+      uint_ranges.add(begin.uint_offset, end.uint_offset);
+    }
+
+    float_ranges.copy_to_device(dscene->attributes_float);
+    float2_ranges.copy_to_device(dscene->attributes_float2);
+    float3_ranges.copy_to_device(dscene->attributes_float3);
+    uchar4_ranges.copy_to_device(dscene->attributes_uchar4);
+    uint_ranges.copy_to_device(dscene->attributes_uint);
   }
-  if (dscene->attributes_uchar4.size()) {
-    dscene->attributes_uchar4.copy_to_device();
+  else {
+    if (dscene->attributes_float.size()) {
+      dscene->attributes_float.copy_to_device();
+    }
+    if (dscene->attributes_float2.size()) {
+      dscene->attributes_float2.copy_to_device();
+    }
+    if (dscene->attributes_float3.size()) {
+      dscene->attributes_float3.copy_to_device();
+    }
+    if (dscene->attributes_uchar4.size()) {
+      dscene->attributes_uchar4.copy_to_device();
+    }
+    if (dscene->attributes_uint.size()) {
+      dscene->attributes_uint.copy_to_device();
+    }
   }
 
   if (progress.get_cancel())
     return;
 
+  packed_attribute_geometry = scene->geometry;
+  packed_attribute_offsets = geom_offsets;
+
   /* After mesh attributes and patch tables have been copied to device memory,
    * we need to update offsets in the objects. */
   scene->object_manager->device_update_mesh_offsets(device, dscene, scene);
@@ -843,6 +1072,69 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
   }
 }
 
+/* Per geometry packing, offsets into the arrays are computed by mesh_calc_offset()
+ * so these can run in parallel. */
+
+static void pack_mesh_triangles(Scene *scene,
+                                Mesh *mesh,
+                                const vector<uint> *tri_prim_index,
+                                uint *tri_shader,
+                                float4 *vnormal,
+                                uint4 *tri_vindex,
+                                uint *tri_patch,
+                                float2 *tri_patch_uv,
+                                Progress *progress)
+{
+  if (progress->get_cancel())
+    return;
+
+  mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+  mesh->pack_normals(&vnormal[mesh->vert_offset]);
+  mesh->pack_verts(*tri_prim_index,
+                   &tri_vindex[mesh->prim_offset],
+                   &tri_patch[mesh->prim_offset],
+                   &tri_patch_uv[mesh->vert_offset],
+                   mesh->vert_offset,
+                   mesh->prim_offset);
+}
+
+static void pack_hair_curves(
+    Scene *scene, Hair *hair, float4 *curve_keys, float4 *curves, Progress *progress)
+{
+  if (progress->get_cancel())
+    return;
+
+  hair->pack_curves(scene,
+                    &curve_keys[hair->curvekey_offset],
+                    &curves[hair->prim_offset],
+                    hair->curvekey_offset);
+}
+
+static void pack_mesh_patches(Mesh *mesh, uint *patch_data, Progress *progress)
+{
+  if (progress->get_cancel())
+    return;
+
+  mesh->pack_patches(
+      &patch_data[mesh->patch_offset], mesh->vert_offset, mesh->face_offset, mesh->corner_offset);
+
+  if (mesh->patch_table) {
+    mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
+                                              mesh->patch_table_offset);
+  }
+}
+
+static void pack_mesh_triangle_verts(Mesh *mesh, float4 *prim_tri_verts)
+{
+  for (size_t i = 0; i < mesh->num_triangles(); ++i) {
+    Mesh::Triangle t = mesh->get_triangle(i);
+    size_t offset = 3 * (i + mesh->prim_offset);
+    prim_tri_verts[offset + 0] = float3_to_float4(mesh->verts[t.v[0]]);
+    prim_tri_verts[offset + 1] = float3_to_float4(mesh->verts[t.v[1]]);
+    prim_tri_verts[offset + 2] = float3_to_float4(mesh->verts[t.v[2]]);
+  }
+}
+
 void GeometryManager::device_update_mesh(
     Device *, DeviceScene *dscene, Scene *scene, bool for_displacement, Progress &progress)
 {
@@ -906,6 +1198,76 @@ void GeometryManager::device_update_mesh(
     }
   }
 
+  /* Ranges of the geometry in the vertex and primitive arrays. */
+  vector<GeometryPackedRange> packed_ranges(scene->geometry.size());
+  for (size_t i = 0; i < scene->geometry.size(); i++) {
+    Geometry *geom = scene->geometry[i];
+    GeometryPackedRange &range = packed_ranges[i];
+
+    range.geom = geom;
+    range.vert_offset = 0;
+    range.vert_size = 0;
+    range.prim_offset = geom->prim_offset;
+    range.prim_size = 0;
+    foreach (Shader *shader, geom->used_shaders) {
+      range.shader_ids.push_back(shader->id);
+    }
+
+    if (geom->type == Geometry::MESH) {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      range.vert_offset = mesh->vert_offset;
+      range.vert_size = mesh->verts.size();
+      range.prim_size = mesh->num_triangles();
+    }
+    else if (geom->type == Geometry::HAIR) {
+      Hair *hair = static_cast<Hair *>(geom);
+      range.vert_offset = hair->curvekey_offset;
+      range.vert_size = hair->curve_keys.size();
+      range.prim_size = hair->num_curves();
+    }
+  }
+
+  /* When all geometry keeps its place in the arrays, only geometry that changed since it was
+   * last packed, or whose primitives moved in the BVH, is packed and copied again. */
+  bool pack_changed_only = !for_displacement && patch_size == 0 &&
+                           packed_default_shader_id == scene->default_surface->id &&
+                           packed_geometry.size() == packed_ranges.size() &&
+                           packed_tri_prim_index.size() == tri_size &&
+                           device_vector_reusable(dscene->tri_shader, tri_size) &&
+                           device_vector_reusable(dscene->tri_vnormal, vert_size) &&
+                           device_vector_reusable(dscene->tri_vindex, tri_size) &&
+                           device_vector_reusable(dscene->tri_patch, tri_size) &&
+                           device_vector_reusable(dscene->tri_patch_uv, vert_size) &&
+                           device_vector_reusable(dscene->curve_keys, curve_key_size) &&
+                           device_vector_reusable(dscene->curves, curve_size);
+  for (size_t i = 0; pack_changed_only && i < packed_ranges.size(); i++) {
+    const GeometryPackedRange &a = packed_ranges[i];
+    const GeometryPackedRange &b = packed_geometry[i];
+    pack_changed_only = a.vert_offset == b.vert_offset && a.vert_size == b.vert_size &&
+                        a.prim_offset == b.prim_offset && a.prim_size == b.prim_size;
+  }
+
+  vector<bool> geom_pack(scene->geometry.size(), true);
+  if (pack_changed_only) {
+    for (size_t i = 0; i < packed_ranges.size(); i++) {
+      const GeometryPackedRange &range = packed_ranges[i];
+      Geometry *geom = range.geom;
+
+      bool prim_index_changed = false;
+      if (geom->type == Geometry::MESH && range.prim_size) {
+        prim_index_changed = memcmp(&tri_prim_index[range.prim_offset],
+                                    &packed_tri_prim_index[range.prim_offset],
+                                    sizeof(uint) * range.prim_size) != 0;
+      }
+
+      geom_pack[i] = geom->need_update_packed || geom != packed_geometry[i].geom ||
+                     range.shader_ids != packed_geometry[i].shader_ids || prim_index_changed;
+    }
+  }
+
+  /* Recorded again once packing completes without being cancelled. */
+  packed_geometry.clear();
+
   /* Fill in all the arrays. */
   if (tri_size != 0) {
     /* normals */
@@ -917,30 +1279,53 @@ void GeometryManager::device_update_mesh(
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        mesh->pack_normals(&vnormal[mesh->vert_offset]);
-        mesh->pack_verts(tri_prim_index,
-                         &tri_vindex[mesh->prim_offset],
-                         &tri_patch[mesh->prim_offset],
-                         &tri_patch_uv[mesh->vert_offset],
-                         mesh->vert_offset,
-                         mesh->prim_offset);
-        if (progress.get_cancel())
-          return;
+    TaskPool pool;
+    for (size_t i = 0; i < scene->geometry.size(); i++) {
+      Geometry *geom = scene->geometry[i];
+      if (geom->type == Geometry::MESH && geom_pack[i]) {
+        pool.push(function_bind(&pack_mesh_triangles,
+                                scene,
+                                static_cast<Mesh *>(geom),
+                                &tri_prim_index,
+                                tri_shader,
+                                vnormal,
+                                tri_vindex,
+                                tri_patch,
+                                tri_patch_uv,
+                                &progress));
       }
     }
+    pool.wait_work();
+
+    if (progress.get_cancel())
+      return;
 
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
-    dscene->tri_shader.copy_to_device();
-    dscene->tri_vnormal.copy_to_device();
-    dscene->tri_vindex.copy_to_device();
-    dscene->tri_patch.copy_to_device();
-    dscene->tri_patch_uv.copy_to_device();
+    if (pack_changed_only) {
+      DeviceCopyRanges vert_ranges, tri_ranges;
+      for (size_t i = 0; i < packed_ranges.size(); i++) {
+        const GeometryPackedRange &range = packed_ranges[i];
+        if (range.geom->type == Geometry::MESH && geom_pack[i]) {
+          vert_ranges.add(range.vert_offset, range.vert_offset + range.vert_size);
+          tri_ranges.add(range.prim_offset, range.prim_offset + range.prim_size);
+        }
+      }
+
+      tri_ranges.copy_to_device(dscene->tri_shader);
+      vert_ranges.copy_to_device(dscene->tri_vnormal);
+      tri_ranges.copy_to_device(dscene->tri_vindex);
+      tri_ranges.copy_to_device(dscene->tri_patch);
+      vert_ranges.copy_to_device(dscene->tri_patch_uv);
+    }
+    else {
+      dscene->tri_shader.copy_to_device();
+      dscene->tri_vnormal.copy_to_device();
+      dscene->tri_vindex.copy_to_device();
+      dscene->tri_patch.copy_to_device();
+      dscene->tri_patch_uv.copy_to_device();
+    }
   }
 
   if (curve_size != 0) {
@@ -949,20 +1334,40 @@ void GeometryManager::device_update_mesh(
     float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
     float4 *curves = dscene->curves.alloc(curve_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::HAIR) {
-        Hair *hair = static_cast<Hair *>(geom);
-        hair->pack_curves(scene,
-                          &curve_keys[hair->curvekey_offset],
-                          &curves[hair->prim_offset],
-                          hair->curvekey_offset);
-        if (progress.get_cancel())
-          return;
+    TaskPool pool;
+    for (size_t i = 0; i < scene->geometry.size(); i++) {
+      Geometry *geom = scene->geometry[i];
+      if (geom->type == Geometry::HAIR && geom_pack[i]) {
+        pool.push(function_bind(&pack_hair_curves,
+                                scene,
+                                static_cast<Hair *>(geom),
+                                curve_keys,
+                                curves,
+                                &progress));
       }
     }
+    pool.wait_work();
 
-    dscene->curve_keys.copy_to_device();
-    dscene->curves.copy_to_device();
+    if (progress.get_cancel())
+      return;
+
+    if (pack_changed_only) {
+      DeviceCopyRanges key_ranges, curve_ranges;
+      for (size_t i = 0; i < packed_ranges.size(); i++) {
+        const GeometryPackedRange &range = packed_ranges[i];
+        if (range.geom->type == Geometry::HAIR && geom_pack[i]) {
+          key_ranges.add(range.vert_offset, range.vert_offset + range.vert_size);
+          curve_ranges.add(range.prim_offset, range.prim_offset + range.prim_size);
+        }
+      }
+
+      key_ranges.copy_to_device(dscene->curve_keys);
+      curve_ranges.copy_to_device(dscene->curves);
+    }
+    else {
+      dscene->curve_keys.copy_to_device();
+      dscene->curves.copy_to_device();
+    }
   }
 
   if (patch_size != 0) {
@@ -970,42 +1375,40 @@ void GeometryManager::device_update_mesh(
 
     uint *patch_data = dscene->patches.alloc(patch_size);
 
+    TaskPool pool;
     foreach (Geometry *geom, scene->geometry) {
       if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_patches(&patch_data[mesh->patch_offset],
-                           mesh->vert_offset,
-                           mesh->face_offset,
-                           mesh->corner_offset);
-
-        if (mesh->patch_table) {
-          mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
-                                                    mesh->patch_table_offset);
-        }
-
-        if (progress.get_cancel())
-          return;
+        pool.push(
+            function_bind(&pack_mesh_patches, static_cast<Mesh *>(geom), patch_data, &progress));
       }
     }
+    pool.wait_work();
+
+    if (progress.get_cancel())
+      return;
 
     dscene->patches.copy_to_device();
   }
 
   if (for_displacement) {
     float4 *prim_tri_verts = dscene->prim_tri_verts.alloc(tri_size * 3);
+    TaskPool pool;
     foreach (Geometry *geom, scene->geometry) {
       if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        for (size_t i = 0; i < mesh->num_triangles(); ++i) {
-          Mesh::Triangle t = mesh->get_triangle(i);
-          size_t offset = 3 * (i + mesh->prim_offset);
-          prim_tri_verts[offset + 0] = float3_to_float4(mesh->verts[t.v[0]]);
-          prim_tri_verts[offset + 1] = float3_to_float4(mesh->verts[t.v[1]]);
-          prim_tri_verts[offset + 2] = float3_to_float4(mesh->verts[t.v[2]]);
-        }
+        pool.push(function_bind(
+            &pack_mesh_triangle_verts, static_cast<Mesh *>(geom), prim_tri_verts));
       }
     }
+    pool.wait_work();
     dscene->prim_tri_verts.copy_to_device();
+
+    /* The arrays are packed again for rendering once the BVH is built. */
+    packed_geometry.clear();
+  }
+  else {
+    packed_geometry.swap(packed_ranges);
+    packed_default_shader_id = scene->default_surface->id;
+    packed_tri_prim_index.swap(tri_prim_index);
   }
 }
 
@@ -1068,9 +1471,20 @@ void GeometryManager::device_update_bvh(Device *device,
     dscene->bvh_leaf_nodes.steal_data(pack.leaf_nodes);
     dscene->bvh_leaf_nodes.copy_to_device();
   }
-  if (pack.object_node.size()) {
-    dscene->object_node.steal_data(pack.object_node);
-    dscene->object_node.copy_to_device();
+  if (dscene->instances.size()) {
+    /* Root nodes of the instanced geometry go into the instance records that were filled in by
+     * the object manager, shared by all instances of an object. */
+    KernelInstance *kinstances = dscene->instances.data();
+    foreach (Object *ob, scene->objects) {
+      map<Geometry *, int>::const_iterator it = pack.geometry_node.find(ob->geometry);
+      const int node = (it != pack.geometry_node.end()) ? it->second : 0;
+
+      kinstances[ob->get_device_index()].node = node;
+      for (size_t i = 0; i < ob->num_instances(); i++) {
+        kinstances[ob->get_instance_device_index(i)].node = node;
+      }
+    }
+    dscene->instances.copy_to_device();
   }
   if (pack.prim_tri_index.size()) {
     dscene->prim_tri_index.steal_data(pack.prim_tri_index);
@@ -1230,15 +1644,22 @@ void GeometryManager::device_update(Device *device,
 
   VLOG(1) << "Total " << scene->geometry.size() << " meshes.";
 
+  update_times.clear();
+
   bool true_displacement_used = false;
   size_t total_tess_needed = 0;
 
+  double stage_start = time_dt();
   foreach (Geometry *geom, scene->geometry) {
     foreach (Shader *shader, geom->used_shaders) {
       if (shader->need_update_geometry)
         geom->need_update = true;
     }
 
+    if (geom->need_update) {
+      geom->need_update_packed = true;
+    }
+
     if (geom->need_update && geom->type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
@@ -1265,9 +1686,11 @@ void GeometryManager::device_update(Device *device,
         return;
     }
   }
+  update_times.add_entry(NamedTimeEntry("Normals", time_dt() - stage_start));
 
   /* Tessellate meshes that are using subdivision */
   if (total_tess_needed) {
+    stage_start = time_dt();
     Camera *dicing_camera = scene->dicing_camera;
     dicing_camera->update(scene);
 
@@ -1299,28 +1722,36 @@ void GeometryManager::device_update(Device *device,
           return;
       }
     }
+    update_times.add_entry(NamedTimeEntry("Tessellation", time_dt() - stage_start));
   }
 
   /* Update images needed for true displacement. */
   bool old_need_object_flags_update = false;
   if (true_displacement_used) {
     VLOG(1) << "Updating images used for true displacement.";
+    stage_start = time_dt();
     device_update_displacement_images(device, scene, progress);
     old_need_object_flags_update = scene->object_manager->need_flags_update;
     scene->object_manager->device_update_flags(device, dscene, scene, progress, false);
+    update_times.add_entry(NamedTimeEntry("Displacement images", time_dt() - stage_start));
   }
 
-  /* Device update. */
-  device_free(device, dscene);
+  /* Device update. Without true displacement the arrays packed from geometry are kept, so
+   * only geometry that changed has to be packed and copied again. */
+  device_free(device, dscene, true_displacement_used);
 
   mesh_calc_offset(scene);
   if (true_displacement_used) {
+    stage_start = time_dt();
     device_update_mesh(device, dscene, scene, true, progress);
+    update_times.add_entry(NamedTimeEntry("Mesh for displacement", time_dt() - stage_start));
   }
   if (progress.get_cancel())
     return;
 
+  stage_start = time_dt();
   device_update_attributes(device, dscene, scene, progress);
+  update_times.add_entry(NamedTimeEntry("Attributes", time_dt() - stage_start));
   if (progress.get_cancel())
     return;
 
@@ -1330,6 +1761,7 @@ void GeometryManager::device_update(Device *device,
   BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
                                                     device->get_bvh_layout_mask());
 
+  stage_start = time_dt();
   foreach (Geometry *geom, scene->geometry) {
     if (geom->need_update) {
       if (geom->type == Geometry::MESH) {
@@ -1356,7 +1788,9 @@ void GeometryManager::device_update(Device *device,
     if (progress.get_cancel())
       return;
   }
+  update_times.add_entry(NamedTimeEntry("Displacement", time_dt() - stage_start));
 
+  stage_start = time_dt();
   TaskPool pool;
 
   size_t i = 0;
@@ -1373,6 +1807,7 @@ void GeometryManager::device_update(Device *device,
   TaskPool::Summary summary;
   pool.wait_work(&summary);
   VLOG(2) << "Objects BVH build pool statistics:\n" << summary.full_report();
+  update_times.add_entry(NamedTimeEntry("Object BVH", time_dt() - stage_start));
 
   foreach (Shader *shader, scene->shaders) {
     shader->need_update_geometry = false;
@@ -1381,23 +1816,37 @@ void GeometryManager::device_update(Device *device,
   Scene::MotionType need_motion = scene->need_motion();
   bool motion_blur = need_motion == Scene::MOTION_BLUR;
 
-  /* Update objects. */
-  vector<Object *> volume_objects;
-  foreach (Object *object, scene->objects) {
-    object->compute_bounds(motion_blur);
+  /* Update object bounds, in chunks since scenes can have millions of instances. */
+  const size_t num_objects = scene->objects.size();
+  const size_t objects_per_task = 1024;
+  for (size_t start = 0; start < num_objects; start += objects_per_task) {
+    pool.push(function_bind(&compute_object_bounds,
+                            &scene->objects,
+                            start,
+                            std::min(start + objects_per_task, num_objects),
+                            motion_blur));
   }
+  pool.wait_work();
 
   if (progress.get_cancel())
     return;
 
+  stage_start = time_dt();
   device_update_bvh(device, dscene, scene, progress);
+  update_times.add_entry(NamedTimeEntry("Scene BVH", time_dt() - stage_start));
   if (progress.get_cancel())
     return;
 
+  stage_start = time_dt();
   device_update_mesh(device, dscene, scene, false, progress);
+  update_times.add_entry(NamedTimeEntry("Mesh", time_dt() - stage_start));
   if (progress.get_cancel())
     return;
 
+  foreach (Geometry *geom, scene->geometry) {
+    geom->need_update_packed = false;
+  }
+
   need_update = false;
 
   if (true_displacement_used) {
@@ -1411,11 +1860,10 @@ void GeometryManager::device_update(Device *device,
   }
 }
 
-void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool free_packed_arrays)
 {
   dscene->bvh_nodes.free();
   dscene->bvh_leaf_nodes.free();
-  dscene->object_node.free();
   dscene->prim_tri_verts.free();
   dscene->prim_tri_index.free();
   dscene->prim_type.free();
@@ -1423,19 +1871,26 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->prim_index.free();
   dscene->prim_object.free();
   dscene->prim_time.free();
-  dscene->tri_shader.free();
-  dscene->tri_vnormal.free();
-  dscene->tri_vindex.free();
-  dscene->tri_patch.free();
-  dscene->tri_patch_uv.free();
-  dscene->curves.free();
-  dscene->curve_keys.free();
   dscene->patches.free();
   dscene->attributes_map.free();
-  dscene->attributes_float.free();
-  dscene->attributes_float2.free();
-  dscene->attributes_float3.free();
-  dscene->attributes_uchar4.free();
+
+  if (free_packed_arrays) {
+    dscene->tri_shader.free();
+    dscene->tri_vnormal.free();
+    dscene->tri_vindex.free();
+    dscene->tri_patch.free();
+    dscene->tri_patch_uv.free();
+    dscene->curves.free();
+    dscene->curve_keys.free();
+    dscene->attributes_float.free();
+    dscene->attributes_float2.free();
+    dscene->attributes_float3.free();
+    dscene->attributes_uchar4.free();
+    dscene->attributes_uint.free();
+
+    packed_geometry.clear();
+    packed_attribute_geometry.clear();
+  }
 
   /* Signal for shaders like displacement not to do ray tracing. */
   dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
@@ -1465,6 +1920,10 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
   }
+
+  stats->mesh.update_times = update_times;
+  stats->mesh.attributes = attribute_sizes;
+  stats->mesh.attributes_compact_saved = attribute_compact_saved;
 }
 
 CCL_NAMESPACE_END
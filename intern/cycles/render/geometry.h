@@ -22,6 +22,7 @@
 #include "bvh/bvh_params.h"
 
 #include "render/attribute.h"
+#include "render/stats.h"
 
 #include "util/util_boundbox.h"
 #include "util/util_set.h"
@@ -34,9 +35,9 @@ CCL_NAMESPACE_BEGIN
 class BVH;
 class Device;
 class DeviceScene;
+class MD5Hash;
 class Mesh;
 class Progress;
-class RenderStats;
 class Scene;
 class SceneParams;
 class Shader;
@@ -88,6 +89,12 @@ class Geometry : public Node {
   /* Update Flags */
   bool need_update;
   bool need_update_rebuild;
+  /* Content changed since the geometry was last packed into the device arrays. */
+  bool need_update_packed;
+
+  /* Hash of the synchronized content, used to detect geometry that did not
+   * change between renders with persistent data. Empty if not computed. */
+  string content_hash;
 
   /* Constructor/Destructor */
   explicit Geometry(const NodeType *node_type, const Type type);
@@ -96,6 +103,7 @@ class Geometry : public Node {
   /* Geometry */
   virtual void clear();
   virtual void compute_bounds() = 0;
+  virtual void hash_content(MD5Hash &md5);
   virtual void apply_transform(const Transform &tfm, const bool apply_to_motion) = 0;
 
   /* Attribute Requests */
@@ -142,6 +150,26 @@ class Geometry : public Node {
 
 /* Geometry Manager */
 
+/* Offsets of the first element of a geometry in each of the attribute arrays. */
+struct AttributeArrayOffsets {
+  size_t float_offset;
+  size_t float2_offset;
+  size_t float3_offset;
+  size_t uchar4_offset;
+  size_t uint_offset;
+};
+
+/* Elements of a geometry in the mesh or curve arrays, vertices or curve keys and
+ * triangles or curves, along with the shader ids packed into the primitives. */
+struct GeometryPackedRange {
+  Geometry *geom;
+  size_t vert_offset;
+  size_t vert_size;
+  size_t prim_offset;
+  size_t prim_size;
+  vector<int> shader_ids;
+};
+
 class GeometryManager {
  public:
   /* Update Flags */
@@ -155,7 +183,7 @@ class GeometryManager {
   /* Device Updates */
   void device_update_preprocess(Device *device, Scene *scene, Progress &progress);
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
-  void device_free(Device *device, DeviceScene *dscene);
+  void device_free(Device *device, DeviceScene *dscene, bool free_packed_arrays = true);
 
   /* Updates */
   void tag_update(Scene *scene);
@@ -164,6 +192,21 @@ class GeometryManager {
   void collect_statistics(const Scene *scene, RenderStats *stats);
 
  protected:
+  /* Time spent in the stages of the last device update. */
+  NamedTimeStats update_times;
+
+  /* Device memory of attributes per storage format, and memory saved by compact formats. */
+  NamedSizeStats attribute_sizes;
+  size_t attribute_compact_saved;
+
+  /* Layout of the device arrays packed by the previous update. As long as it stays the
+   * same, only geometry that changed is packed and copied to the device again. */
+  vector<GeometryPackedRange> packed_geometry;
+  int packed_default_shader_id;
+  vector<uint> packed_tri_prim_index;
+  vector<Geometry *> packed_attribute_geometry;
+  vector<AttributeArrayOffsets> packed_attribute_offsets;
+
   bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress &progress);
 
   void create_volume_mesh(Mesh *mesh, Progress &progress);
@@ -25,6 +25,7 @@
 #include "util/util_image.h"
 #include "util/util_image_impl.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_texture.h"
@@ -257,6 +258,17 @@ bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
   }
 }
 
+bool ImageLoader::hash_content(MD5Hash & /*md5*/)
+{
+  return false;
+}
+
+static string image_loader_content_hash(ImageLoader *loader)
+{
+  MD5Hash md5;
+  return (loader->hash_content(md5)) ? md5.get_hex() : "";
+}
+
 /* Image Manager */
 
 ImageManager::ImageManager(const DeviceInfo &info)
@@ -385,6 +397,20 @@ int ImageManager::add_image_slot(ImageLoader *loader,
     img = images[slot];
     if (img && ImageLoader::equals(img->loader, loader) && img->params == params) {
       img->users++;
+
+      /* Builtin images kept from a previous render are reloaded if their
+       * contents changed in the meantime. */
+      if (img->builtin && !img->content_hash.empty()) {
+        string content_hash = image_loader_content_hash(loader);
+        if (content_hash != img->content_hash) {
+          swap(img->loader, loader);
+          img->content_hash = content_hash;
+          img->need_metadata = true;
+          img->need_load = true;
+          need_update = true;
+        }
+      }
+
       delete loader;
       return slot;
     }
@@ -407,6 +433,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->need_metadata = true;
   img->need_load = !(osl_texture_system && !img->loader->osl_filepath().empty());
   img->builtin = builtin;
+  img->content_hash = (builtin) ? image_loader_content_hash(loader) : "";
   img->users = 1;
   img->mem = NULL;
 
@@ -819,7 +846,9 @@ void ImageManager::device_free_builtin(Device *device)
 {
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
-    if (img && img->builtin) {
+    /* Builtin images with a content hash stay in device memory, they are
+     * compared against the loader of the next render in add_image_slot(). */
+    if (img && img->builtin && img->content_hash.empty()) {
       device_free_image(device, slot);
     }
   }
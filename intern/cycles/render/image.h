@@ -35,6 +35,7 @@ class ImageHandle;
 class ImageKey;
 class ImageMetaData;
 class ImageManager;
+class MD5Hash;
 class Progress;
 class RenderStats;
 class Scene;
@@ -124,6 +125,11 @@ class ImageLoader {
   virtual bool equals(const ImageLoader &other) const = 0;
   static bool equals(const ImageLoader *a, const ImageLoader *b);
 
+  /* Optional hash of the image contents, used to keep builtin images in device
+   * memory between renders with persistent data. Returns false if the contents
+   * can not be identified cheaply, the image is then reloaded for every render. */
+  virtual bool hash_content(MD5Hash &md5);
+
   /* Work around for no RTTI. */
 };
 
@@ -194,6 +200,7 @@ class ImageManager {
     bool need_metadata;
     bool need_load;
     bool builtin;
+    string content_hash;
 
     string mem_name;
     device_texture *mem;
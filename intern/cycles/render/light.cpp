@@ -290,9 +290,10 @@ void LightManager::device_update_distribution(Device *,
       continue;
     }
 
-    /* Count triangles. */
+    /* Count triangles, for the object and each of its additional instances. */
     Mesh *mesh = static_cast<Mesh *>(object->geometry);
     size_t mesh_num_triangles = mesh->num_triangles();
+    size_t num_emissive_triangles = 0;
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->shader[i];
       Shader *shader = (shader_index < mesh->used_shaders.size()) ?
@@ -300,9 +301,10 @@ void LightManager::device_update_distribution(Device *,
                            scene->default_surface;
 
       if (shader->use_mis && shader->has_surface_emission) {
-        num_triangles++;
+        num_emissive_triangles++;
       }
     }
+    num_triangles += num_emissive_triangles * (1 + object->num_instances());
   }
 
   size_t num_distribution = num_triangles + num_lights;
@@ -326,9 +328,6 @@ void LightManager::device_update_distribution(Device *,
     }
     /* Sum area. */
     Mesh *mesh = static_cast<Mesh *>(object->geometry);
-    bool transform_applied = mesh->transform_applied;
-    Transform tfm = object->tfm;
-    int object_id = j;
     int shader_flag = 0;
 
     if (!(object->visibility & PATH_RAY_DIFFUSE)) {
@@ -348,35 +347,42 @@ void LightManager::device_update_distribution(Device *,
       use_light_visibility = true;
     }
 
-    size_t mesh_num_triangles = mesh->num_triangles();
-    for (size_t i = 0; i < mesh_num_triangles; i++) {
-      int shader_index = mesh->shader[i];
-      Shader *shader = (shader_index < mesh->used_shaders.size()) ?
-                           mesh->used_shaders[shader_index] :
-                           scene->default_surface;
-
-      if (shader->use_mis && shader->has_surface_emission) {
-        distribution[offset].totarea = totarea;
-        distribution[offset].prim = i + mesh->prim_offset;
-        distribution[offset].mesh_light.shader_flag = shader_flag;
-        distribution[offset].mesh_light.object_id = object_id;
-        offset++;
-
-        Mesh::Triangle t = mesh->get_triangle(i);
-        if (!t.valid(&mesh->verts[0])) {
-          continue;
+    /* The object itself and then its additional instances. */
+    for (int k = -1; k < (int)object->num_instances(); k++) {
+      const int object_id = (k == -1) ? j : object->get_instance_device_index(k);
+      const bool transform_applied = (k == -1) && mesh->transform_applied;
+      const Transform &tfm = object->get_device_transform(object_id);
+
+      size_t mesh_num_triangles = mesh->num_triangles();
+      for (size_t i = 0; i < mesh_num_triangles; i++) {
+        int shader_index = mesh->shader[i];
+        Shader *shader = (shader_index < mesh->used_shaders.size()) ?
+                             mesh->used_shaders[shader_index] :
+                             scene->default_surface;
+
+        if (shader->use_mis && shader->has_surface_emission) {
+          distribution[offset].totarea = totarea;
+          distribution[offset].prim = i + mesh->prim_offset;
+          distribution[offset].mesh_light.shader_flag = shader_flag;
+          distribution[offset].mesh_light.object_id = object_id;
+          offset++;
+
+          Mesh::Triangle t = mesh->get_triangle(i);
+          if (!t.valid(&mesh->verts[0])) {
+            continue;
+          }
+          float3 p1 = mesh->verts[t.v[0]];
+          float3 p2 = mesh->verts[t.v[1]];
+          float3 p3 = mesh->verts[t.v[2]];
+
+          if (!transform_applied) {
+            p1 = transform_point(&tfm, p1);
+            p2 = transform_point(&tfm, p2);
+            p3 = transform_point(&tfm, p3);
+          }
+
+          totarea += triangle_area(p1, p2, p3);
         }
-        float3 p1 = mesh->verts[t.v[0]];
-        float3 p2 = mesh->verts[t.v[1]];
-        float3 p3 = mesh->verts[t.v[2]];
-
-        if (!transform_applied) {
-          p1 = transform_point(&tfm, p1);
-          p2 = transform_point(&tfm, p2);
-          p3 = transform_point(&tfm, p3);
-        }
-
-        totarea += triangle_area(p1, p2, p3);
       }
     }
 
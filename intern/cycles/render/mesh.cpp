@@ -30,6 +30,7 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
 
@@ -247,6 +248,35 @@ void Mesh::clear()
   clear(false);
 }
 
+void Mesh::hash_content(MD5Hash &md5)
+{
+  Geometry::hash_content(md5);
+
+  /* Subdivision and volume data is not stored in sockets. Subdivision faces
+   * are hashed member by member to skip struct padding. */
+  const int subd_header[] = {subdivision_type, num_ngons};
+  md5.append((const uint8_t *)subd_header, sizeof(subd_header));
+
+  for (size_t i = 0; i < subd_faces.size(); i++) {
+    const SubdFace &face = subd_faces[i];
+    const int face_data[] = {face.start_corner, face.num_corners, face.shader, face.smooth};
+    md5.append((const uint8_t *)face_data, sizeof(face_data));
+  }
+  if (subd_face_corners.size()) {
+    md5.append((const uint8_t *)subd_face_corners.data(),
+               subd_face_corners.size() * sizeof(int));
+  }
+  if (subd_creases.size()) {
+    md5.append((const uint8_t *)subd_creases.data(),
+               subd_creases.size() * sizeof(SubdEdgeCrease));
+  }
+  subd_attributes.hash(md5);
+
+  const float volume_data[] = {volume_clipping, volume_step_size};
+  md5.append((const uint8_t *)volume_data, sizeof(volume_data));
+  md5.append((const uint8_t *)&volume_object_space, sizeof(volume_object_space));
+}
+
 void Mesh::add_vertex(float3 P)
 {
   verts.push_back_reserved(P);
@@ -177,6 +177,7 @@ class Mesh : public Geometry {
   void reserve_subd_faces(int numfaces, int num_ngons, int numcorners);
   void clear(bool preserve_voxel_data);
   void clear() override;
+  void hash_content(MD5Hash &md5) override;
   void add_vertex(float3 P);
   void add_vertex_slow(float3 P);
   void add_triangle(int v0, int v1, int v2, int shader, bool smooth);
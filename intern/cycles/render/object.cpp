@@ -24,13 +24,16 @@
 #include "render/mesh.h"
 #include "render/particles.h"
 #include "render/scene.h"
+#include "render/shader.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_map.h"
 #include "util/util_murmurhash.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
 
 #include "subd/subd_patch_table.h"
@@ -58,12 +61,18 @@ struct UpdateObjectTransformState {
    */
   map<Mesh *, float> surface_area_map;
 
-  /* Motion offsets for each object. */
+  /* Surface area is only used by OSL shaders, and for instances with non-uniform
+   * scale it has to be computed from all triangles of each instance. */
+  bool need_surface_area;
+
+  /* Motion offsets for each object, and for the additional instances of each
+   * object with moving instances. */
   array<uint> motion_offset;
+  array<uint> instance_motion_offset;
 
   /* Packed object arrays. Those will be filled in. */
-  uint *object_flag;
   KernelObject *objects;
+  KernelInstance *instances;
   Transform *object_motion_pass;
   DecomposedTransform *object_motion;
   float *object_volume_step;
@@ -82,6 +91,9 @@ struct UpdateObjectTransformState {
 
   /* First unused object index in the queue. */
   int queue_start_object;
+
+  /* Number of objects handed out per task. */
+  int objects_per_task;
 };
 
 /* Object */
@@ -112,6 +124,9 @@ Object::Object() : Node(node_type)
   particle_system = NULL;
   particle_index = 0;
   bounds = BoundBox::empty;
+  index = 0;
+  instance_index = 0;
+  instance_motion_blur = false;
 }
 
 Object::~Object()
@@ -153,25 +168,34 @@ void Object::update_motion()
   }
 }
 
-void Object::compute_bounds(bool motion_blur)
+static BoundBox motion_bounds(const BoundBox &mbounds, const Transform *motion, size_t num_steps)
 {
-  BoundBox mbounds = geometry->bounds;
+  array<DecomposedTransform> decomp(num_steps);
+  transform_motion_decompose(decomp.data(), motion, num_steps);
 
-  if (motion_blur && use_motion()) {
-    array<DecomposedTransform> decomp(motion.size());
-    transform_motion_decompose(decomp.data(), motion.data(), motion.size());
+  BoundBox bounds = BoundBox::empty;
 
-    bounds = BoundBox::empty;
+  /* todo: this is really terrible. according to pbrt there is a better
+   * way to find this iteratively, but did not find implementation yet
+   * or try to implement myself */
+  for (float t = 0.0f; t < 1.0f; t += (1.0f / 128.0f)) {
+    Transform ttfm;
 
-    /* todo: this is really terrible. according to pbrt there is a better
-     * way to find this iteratively, but did not find implementation yet
-     * or try to implement myself */
-    for (float t = 0.0f; t < 1.0f; t += (1.0f / 128.0f)) {
-      Transform ttfm;
+    transform_motion_array_interpolate(&ttfm, decomp.data(), num_steps, t);
+    bounds.grow(mbounds.transformed(&ttfm));
+  }
 
-      transform_motion_array_interpolate(&ttfm, decomp.data(), motion.size(), t);
-      bounds.grow(mbounds.transformed(&ttfm));
-    }
+  return bounds;
+}
+
+void Object::compute_bounds(bool motion_blur)
+{
+  BoundBox mbounds = geometry->bounds;
+
+  instance_motion_blur = motion_blur;
+
+  if (motion_blur && use_motion()) {
+    bounds = motion_bounds(mbounds, motion.data(), motion.size());
   }
   else {
     /* No motion blur case. */
@@ -349,6 +373,124 @@ int Object::get_device_index() const
   return index;
 }
 
+int Object::get_instance_device_index(size_t i) const
+{
+  return instance_index + (int)i;
+}
+
+size_t Object::instance_motion_steps() const
+{
+  return (instance_motion.size()) ? instance_motion.size() / num_instances() : 0;
+}
+
+bool Object::instance_use_motion(size_t i) const
+{
+  const size_t num_steps = instance_motion_steps();
+  if (num_steps < 2) {
+    return false;
+  }
+
+  const Transform *motion_tfm = &instance_motion[i * num_steps];
+  for (size_t step = 0; step < num_steps; step++) {
+    if (motion_tfm[step] != instance_tfm[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Object::update_instance_motion()
+{
+  const size_t num_steps = instance_motion_steps();
+  if (num_steps < 2) {
+    instance_motion.clear();
+    return;
+  }
+
+  bool have_motion = false;
+
+  for (size_t i = 0; i < num_instances(); i++) {
+    Transform *motion_tfm = &instance_motion[i * num_steps];
+
+    for (size_t step = 0; step < num_steps; step++) {
+      if (motion_tfm[step] == transform_empty()) {
+        if (hide_on_missing_motion) {
+          /* Hide the instance like update_motion() hides the object. */
+          instance_tfm[i] = transform_empty();
+          for (size_t j = 0; j < num_steps; j++) {
+            motion_tfm[j] = transform_empty();
+          }
+          break;
+        }
+        else {
+          motion_tfm[step] = instance_tfm[i];
+        }
+      }
+
+      have_motion = have_motion || motion_tfm[step] != instance_tfm[i];
+    }
+  }
+
+  if (!have_motion) {
+    instance_motion.clear();
+  }
+}
+
+BoundBox Object::instance_bounds(size_t i) const
+{
+  /* The geometry of additional instances is always instanced. */
+  if (instance_motion_blur && instance_use_motion(i)) {
+    const size_t num_steps = instance_motion_steps();
+    return motion_bounds(geometry->bounds, &instance_motion[i * num_steps], num_steps);
+  }
+  return geometry->bounds.transformed(&instance_tfm[i]);
+}
+
+const Transform &Object::get_device_transform(int device_index) const
+{
+  if (device_index == index) {
+    return tfm;
+  }
+  return instance_tfm[device_index - instance_index];
+}
+
+const Transform *Object::get_device_motion(int device_index, size_t *num_steps) const
+{
+  if (device_index == index) {
+    *num_steps = motion.size();
+    return (use_motion()) ? motion.data() : NULL;
+  }
+
+  const size_t i = device_index - instance_index;
+  *num_steps = instance_motion_steps();
+  return (instance_use_motion(i)) ? &instance_motion[i * *num_steps] : NULL;
+}
+
+BoundBox Object::get_device_bounds(int device_index) const
+{
+  if (device_index == index) {
+    return bounds;
+  }
+  return instance_bounds(device_index - instance_index);
+}
+
+static bool object_instance_index_less(int device_index, const Object *object)
+{
+  return device_index < object->get_instance_device_index(0);
+}
+
+Object *object_from_device_index(const vector<Object *> &objects, int device_index)
+{
+  if (device_index < (int)objects.size()) {
+    return objects[device_index];
+  }
+  /* Additional instances come after all objects, in the order of the objects. */
+  vector<Object *>::const_iterator it = upper_bound(
+      objects.begin(), objects.end(), device_index, object_instance_index_less);
+  assert(it != objects.begin());
+  return *(it - 1);
+}
+
 /* Object Manager */
 
 ObjectManager::ObjectManager()
@@ -381,6 +523,10 @@ static float object_surface_area(UpdateObjectTransformState *state,
     }
   }
 
+  if (!state->need_surface_area) {
+    return 0.0f;
+  }
+
   /* Compute surface area. for uniform scale we can do avoid the many
    * transform calls and share computation for instances.
    *
@@ -454,17 +600,13 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   int particle_index = (ob->particle_system) ?
                            ob->particle_index + state->particle_offset[ob->particle_system] :
                            0;
+  uint motion_offset = 0;
 
-  kobject.tfm = tfm;
-  kobject.itfm = itfm;
   kobject.surface_area = object_surface_area(state, tfm, geom);
   kobject.color[0] = color.x;
   kobject.color[1] = color.y;
   kobject.color[2] = color.z;
   kobject.pass_id = pass_id;
-  kobject.random_number = random_number;
-  kobject.particle_index = particle_index;
-  kobject.motion_offset = 0;
 
   if (geom->use_motion_blur) {
     state->have_motion = true;
@@ -507,24 +649,19 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   }
   else if (state->need_motion == Scene::MOTION_BLUR) {
     if (ob->use_motion()) {
-      kobject.motion_offset = state->motion_offset[ob->index];
+      motion_offset = state->motion_offset[ob->index];
 
       /* Decompose transforms for interpolation. */
-      DecomposedTransform *decomp = state->object_motion + kobject.motion_offset;
+      DecomposedTransform *decomp = state->object_motion + motion_offset;
       transform_motion_decompose(decomp, ob->motion.data(), ob->motion.size());
       flag |= SD_OBJECT_MOTION;
       state->have_motion = true;
     }
   }
 
-  /* Dupli object coords and motion info. */
-  kobject.dupli_generated[0] = ob->dupli_generated[0];
-  kobject.dupli_generated[1] = ob->dupli_generated[1];
-  kobject.dupli_generated[2] = ob->dupli_generated[2];
+  /* Motion info. */
   kobject.numkeys = (geom->type == Geometry::HAIR) ? static_cast<Hair *>(geom)->curve_keys.size() :
                                                      0;
-  kobject.dupli_uv[0] = ob->dupli_uv[0];
-  kobject.dupli_uv[1] = ob->dupli_uv[1];
   int totalsteps = geom->motion_steps;
   kobject.numsteps = (totalsteps - 1) / 2;
   kobject.numverts = (geom->type == Geometry::MESH) ? static_cast<Mesh *>(geom)->verts.size() : 0;
@@ -539,29 +676,105 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   if (ob->use_holdout) {
     flag |= SD_OBJECT_HOLDOUT_MASK;
   }
-  state->object_flag[ob->index] = flag;
   state->object_volume_step[ob->index] = FLT_MAX;
 
+  /* Instance record, the root node is filled in when the BVH is built. */
+  KernelInstance &kinstance = state->instances[ob->index];
+  kinstance.tfm = tfm;
+  kinstance.itfm = itfm;
+  kinstance.node = 0;
+  kinstance.object = ob->index;
+  kinstance.flag = flag;
+  kinstance.random_number = random_number;
+  kinstance.dupli_generated[0] = ob->dupli_generated[0];
+  kinstance.dupli_generated[1] = ob->dupli_generated[1];
+  kinstance.dupli_generated[2] = ob->dupli_generated[2];
+  kinstance.particle_index = particle_index;
+  kinstance.dupli_uv[0] = ob->dupli_uv[0];
+  kinstance.dupli_uv[1] = ob->dupli_uv[1];
+  kinstance.motion_offset = motion_offset;
+  kinstance.pad1 = 0;
+
   /* Have curves. */
   if (geom->type == Geometry::HAIR) {
     state->have_curves = true;
   }
 }
 
+/* Additional instances share the object data and flags with the object. Filled in after the
+ * object, in chunks since there can be millions. */
+static void device_update_object_instances(UpdateObjectTransformState *state,
+                                           const Object *ob,
+                                           size_t start,
+                                           size_t end)
+{
+  const uint object_flag = state->instances[ob->get_device_index()].flag & ~SD_OBJECT_MOTION;
+  const int particle_offset = (ob->particle_system) ?
+                                  state->particle_offset.find(ob->particle_system)->second :
+                                  0;
+  const size_t num_motion_steps = ob->instance_motion_steps();
+
+  for (size_t i = start; i < end; i++) {
+    const int device_index = ob->get_instance_device_index(i);
+    const Transform &tfm = ob->instance_tfm[i];
+    const Transform itfm = transform_inverse(tfm);
+    uint flag = object_flag;
+    uint motion_offset = 0;
+
+    if (state->need_motion == Scene::MOTION_PASS) {
+      Transform tfm_pre = tfm, tfm_post = tfm;
+      if (num_motion_steps) {
+        tfm_pre = ob->instance_motion[i * num_motion_steps];
+        tfm_post = ob->instance_motion[(i + 1) * num_motion_steps - 1];
+      }
+
+      if (!(flag & SD_OBJECT_HAS_VERTEX_MOTION)) {
+        tfm_pre = tfm_pre * itfm;
+        tfm_post = tfm_post * itfm;
+      }
+
+      const int motion_pass_offset = device_index * OBJECT_MOTION_PASS_SIZE;
+      state->object_motion_pass[motion_pass_offset + 0] = tfm_pre;
+      state->object_motion_pass[motion_pass_offset + 1] = tfm_post;
+    }
+    else if (state->need_motion == Scene::MOTION_BLUR && ob->instance_use_motion(i)) {
+      motion_offset = state->instance_motion_offset[ob->get_device_index()] +
+                      i * num_motion_steps;
+      transform_motion_decompose(state->object_motion + motion_offset,
+                                 &ob->instance_motion[i * num_motion_steps],
+                                 num_motion_steps);
+      flag |= SD_OBJECT_MOTION;
+    }
+
+    KernelInstance &kinstance = state->instances[device_index];
+    kinstance.tfm = tfm;
+    kinstance.itfm = itfm;
+    kinstance.node = 0;
+    kinstance.object = ob->get_device_index();
+    kinstance.flag = flag;
+    kinstance.random_number = (float)ob->instance_random_id[i] * (1.0f / (float)0xFFFFFFFF);
+    kinstance.dupli_generated[0] = ob->instance_dupli_generated[i].x;
+    kinstance.dupli_generated[1] = ob->instance_dupli_generated[i].y;
+    kinstance.dupli_generated[2] = ob->instance_dupli_generated[i].z;
+    kinstance.particle_index = (ob->particle_system) ?
+                                   ob->instance_particle_index[i] + particle_offset :
+                                   0;
+    kinstance.dupli_uv[0] = ob->instance_dupli_uv[i].x;
+    kinstance.dupli_uv[1] = ob->instance_dupli_uv[i].y;
+    kinstance.motion_offset = motion_offset;
+    kinstance.pad1 = 0;
+  }
+}
+
 bool ObjectManager::device_update_object_transform_pop_work(UpdateObjectTransformState *state,
                                                             int *start_index,
                                                             int *num_objects)
 {
-  /* Tweakable parameter, number of objects per chunk.
-   * Too small value will cause some extra overhead due to spin lock,
-   * too big value might not use all threads nicely.
-   */
-  static const int OBJECTS_PER_TASK = 32;
   bool have_work = false;
   state->queue_lock.lock();
   int num_scene_objects = state->scene->objects.size();
   if (state->queue_start_object < num_scene_objects) {
-    int count = min(OBJECTS_PER_TASK, num_scene_objects - state->queue_start_object);
+    int count = min(state->objects_per_task, num_scene_objects - state->queue_start_object);
     *start_index = state->queue_start_object;
     *num_objects = count;
     state->queue_start_object += count;
@@ -591,16 +804,26 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
   state.have_curves = false;
   state.scene = scene;
   state.queue_start_object = 0;
+  state.need_surface_area = scene->shader_manager->use_osl();
+
+  /* Every object has an instance record, followed by the additional instances. */
+  size_t num_instances = scene->objects.size();
+  foreach (Object *ob, scene->objects) {
+    num_instances += ob->num_instances();
+  }
 
   state.objects = dscene->objects.alloc(scene->objects.size());
-  state.object_flag = dscene->object_flag.alloc(scene->objects.size());
+  state.instances = dscene->instances.alloc(num_instances);
   state.object_volume_step = dscene->object_volume_step.alloc(scene->objects.size());
   state.object_motion = NULL;
   state.object_motion_pass = NULL;
 
   if (state.need_motion == Scene::MOTION_PASS) {
     state.object_motion_pass = dscene->object_motion_pass.alloc(OBJECT_MOTION_PASS_SIZE *
-                                                                scene->objects.size());
+                                                                num_instances);
+    foreach (Object *ob, scene->objects) {
+      ob->update_instance_motion();
+    }
   }
   else if (state.need_motion == Scene::MOTION_BLUR) {
     /* Set object offsets into global object motion array. */
@@ -616,6 +839,20 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
       motion_offset += ob->motion.size();
     }
 
+    /* Moving instances of an object are at a fixed stride after the motion of all objects. */
+    uint *instance_motion_offsets = state.instance_motion_offset.resize(scene->objects.size());
+
+    foreach (Object *ob, scene->objects) {
+      *instance_motion_offsets = motion_offset;
+      instance_motion_offsets++;
+
+      ob->update_instance_motion();
+      motion_offset += ob->instance_motion.size();
+      if (ob->instance_motion.size()) {
+        state.have_motion = true;
+      }
+    }
+
     state.object_motion = dscene->object_motion.alloc(motion_offset);
   }
 
@@ -642,6 +879,16 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
   }
   else {
     const int num_threads = TaskScheduler::num_threads();
+
+    /* Tweakable parameter, number of objects per chunk.
+     * Too small value will cause some extra overhead due to spin lock,
+     * too big value might not use all threads nicely. Scenes with millions
+     * of instances use bigger chunks to keep lock contention low.
+     */
+    static const int OBJECTS_PER_TASK = 32;
+    state.objects_per_task = max(OBJECTS_PER_TASK,
+                                 (int)(scene->objects.size() / (num_threads * 64)));
+
     TaskPool pool;
     for (int i = 0; i < num_threads; ++i) {
       pool.push(function_bind(&ObjectManager::device_update_object_transform_task, this, &state));
@@ -652,7 +899,28 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
     }
   }
 
+  if (num_instances > scene->objects.size()) {
+    static const size_t INSTANCES_PER_TASK = 4096;
+
+    TaskPool pool;
+    foreach (Object *ob, scene->objects) {
+      const size_t num_object_instances = ob->num_instances();
+      for (size_t start = 0; start < num_object_instances; start += INSTANCES_PER_TASK) {
+        pool.push(function_bind(&device_update_object_instances,
+                                &state,
+                                ob,
+                                start,
+                                min(start + INSTANCES_PER_TASK, num_object_instances)));
+      }
+    }
+    pool.wait_work();
+    if (progress.get_cancel()) {
+      return;
+    }
+  }
+
   dscene->objects.copy_to_device();
+  dscene->instances.copy_to_device();
   if (state.need_motion == Scene::MOTION_PASS) {
     dscene->object_motion_pass.copy_to_device();
   }
@@ -680,11 +948,15 @@ void ObjectManager::device_update(Device *device,
   if (scene->objects.size() == 0)
     return;
 
-  /* Assign object IDs. */
+  /* Assign object IDs, additional instances are numbered after all objects. */
   int index = 0;
   foreach (Object *object, scene->objects) {
     object->index = index++;
   }
+  foreach (Object *object, scene->objects) {
+    object->instance_index = index;
+    index += object->num_instances();
+  }
 
   /* set object transform matrices, before applying static transforms */
   progress.set_status("Updating Objects", "Copying Transformations to device");
@@ -701,6 +973,108 @@ void ObjectManager::device_update(Device *device,
   }
 }
 
+/* Uniform grid over the bounds of all volume objects and their instances, so that testing an
+ * object for intersection with volumes only visits the volumes near it. */
+
+class VolumeBoundsGrid {
+ public:
+  explicit VolumeBoundsGrid(const vector<pair<Object *, BoundBox>> &volumes) : volumes(volumes)
+  {
+    grid_bounds = BoundBox::empty;
+    for (size_t i = 0; i < volumes.size(); i++) {
+      grid_bounds.grow(volumes[i].second);
+    }
+
+    /* About one volume per cell. */
+    resolution = clamp((int)cbrtf((float)volumes.size()), 1, 64);
+    const float3 size = grid_bounds.size();
+    for (int axis = 0; axis < 3; axis++) {
+      inv_cell_size[axis] = (size[axis] > 0.0f) ? resolution / size[axis] : 0.0f;
+    }
+
+    /* Count the volumes in each cell, then store them contiguously per cell. */
+    cell_offset.resize(resolution * resolution * resolution + 1, 0);
+    for (size_t i = 0; i < volumes.size(); i++) {
+      int lo[3], hi[3];
+      cell_range(volumes[i].second, lo, hi);
+      for (int z = lo[2]; z <= hi[2]; z++) {
+        for (int y = lo[1]; y <= hi[1]; y++) {
+          for (int x = lo[0]; x <= hi[0]; x++) {
+            cell_offset[cell_index(x, y, z) + 1]++;
+          }
+        }
+      }
+    }
+
+    for (size_t cell = 1; cell < cell_offset.size(); cell++) {
+      cell_offset[cell] += cell_offset[cell - 1];
+    }
+
+    cell_volumes.resize(cell_offset.back());
+    vector<int> cell_fill(cell_offset.begin(), cell_offset.end() - 1);
+    for (size_t i = 0; i < volumes.size(); i++) {
+      int lo[3], hi[3];
+      cell_range(volumes[i].second, lo, hi);
+      for (int z = lo[2]; z <= hi[2]; z++) {
+        for (int y = lo[1]; y <= hi[1]; y++) {
+          for (int x = lo[0]; x <= hi[0]; x++) {
+            cell_volumes[cell_fill[cell_index(x, y, z)]++] = (int)i;
+          }
+        }
+      }
+    }
+  }
+
+  /* Test if the bounds intersect a volume of another object. */
+  bool intersects(const Object *object, BoundBox bounds) const
+  {
+    if (!bounds.intersects(grid_bounds)) {
+      return false;
+    }
+
+    int lo[3], hi[3];
+    cell_range(bounds, lo, hi);
+    for (int z = lo[2]; z <= hi[2]; z++) {
+      for (int y = lo[1]; y <= hi[1]; y++) {
+        for (int x = lo[0]; x <= hi[0]; x++) {
+          const int cell = cell_index(x, y, z);
+          for (int j = cell_offset[cell]; j < cell_offset[cell + 1]; j++) {
+            const pair<Object *, BoundBox> &volume = volumes[cell_volumes[j]];
+            if (volume.first != object && bounds.intersects(volume.second)) {
+              return true;
+            }
+          }
+        }
+      }
+    }
+
+    return false;
+  }
+
+ protected:
+  int cell_index(int x, int y, int z) const
+  {
+    return (z * resolution + y) * resolution + x;
+  }
+
+  void cell_range(const BoundBox &bounds, int lo[3], int hi[3]) const
+  {
+    for (int axis = 0; axis < 3; axis++) {
+      const float min_offset = (bounds.min[axis] - grid_bounds.min[axis]) * inv_cell_size[axis];
+      const float max_offset = (bounds.max[axis] - grid_bounds.min[axis]) * inv_cell_size[axis];
+      lo[axis] = clamp((int)floorf(min_offset), 0, resolution - 1);
+      hi[axis] = clamp((int)floorf(max_offset), 0, resolution - 1);
+    }
+  }
+
+  const vector<pair<Object *, BoundBox>> &volumes;
+  BoundBox grid_bounds;
+  int resolution;
+  float inv_cell_size[3];
+  vector<int> cell_offset;
+  vector<int> cell_volumes;
+};
+
 void ObjectManager::device_update_flags(
     Device *, DeviceScene *dscene, Scene *scene, Progress & /*progress*/, bool bounds_valid)
 {
@@ -713,17 +1087,20 @@ void ObjectManager::device_update_flags(
   if (scene->objects.size() == 0)
     return;
 
-  /* Object info flag. */
-  uint *object_flag = dscene->object_flag.data();
+  /* Object info flag, stored in the instance records. */
+  KernelInstance *kinstances = dscene->instances.data();
   float *object_volume_step = dscene->object_volume_step.data();
 
-  /* Object volume intersection. */
-  vector<Object *> volume_objects;
+  /* Object volume intersection, against all instances of volume objects. */
+  vector<pair<Object *, BoundBox>> volume_bounds;
   bool has_volume_objects = false;
   foreach (Object *object, scene->objects) {
     if (object->geometry->has_volume) {
       if (bounds_valid) {
-        volume_objects.push_back(object);
+        volume_bounds.push_back(pair<Object *, BoundBox>(object, object->bounds));
+        for (size_t i = 0; i < object->num_instances(); i++) {
+          volume_bounds.push_back(pair<Object *, BoundBox>(object, object->instance_bounds(i)));
+        }
       }
       has_volume_objects = true;
       object_volume_step[object->index] = object->compute_volume_step_size();
@@ -733,49 +1110,61 @@ void ObjectManager::device_update_flags(
     }
   }
 
+  unique_ptr<VolumeBoundsGrid> volume_grid;
+  if (!volume_bounds.empty()) {
+    volume_grid.reset(new VolumeBoundsGrid(volume_bounds));
+  }
+
   foreach (Object *object, scene->objects) {
+    uint set_flag = 0, clear_flag = 0;
+
     if (object->geometry->has_volume) {
-      object_flag[object->index] |= SD_OBJECT_HAS_VOLUME;
-      object_flag[object->index] &= ~SD_OBJECT_HAS_VOLUME_ATTRIBUTES;
+      set_flag |= SD_OBJECT_HAS_VOLUME;
+      clear_flag |= SD_OBJECT_HAS_VOLUME_ATTRIBUTES;
 
       foreach (Attribute &attr, object->geometry->attributes.attributes) {
         if (attr.element == ATTR_ELEMENT_VOXEL) {
-          object_flag[object->index] |= SD_OBJECT_HAS_VOLUME_ATTRIBUTES;
+          set_flag |= SD_OBJECT_HAS_VOLUME_ATTRIBUTES;
         }
       }
     }
     else {
-      object_flag[object->index] &= ~(SD_OBJECT_HAS_VOLUME | SD_OBJECT_HAS_VOLUME_ATTRIBUTES);
+      clear_flag |= SD_OBJECT_HAS_VOLUME | SD_OBJECT_HAS_VOLUME_ATTRIBUTES;
     }
 
     if (object->is_shadow_catcher) {
-      object_flag[object->index] |= SD_OBJECT_SHADOW_CATCHER;
+      set_flag |= SD_OBJECT_SHADOW_CATCHER;
     }
     else {
-      object_flag[object->index] &= ~SD_OBJECT_SHADOW_CATCHER;
+      clear_flag |= SD_OBJECT_SHADOW_CATCHER;
     }
 
-    if (bounds_valid) {
-      foreach (Object *volume_object, volume_objects) {
-        if (object == volume_object) {
-          continue;
-        }
-        if (object->bounds.intersects(volume_object->bounds)) {
-          object_flag[object->index] |= SD_OBJECT_INTERSECTS_VOLUME;
-          break;
+    /* The object itself and then its additional instances. */
+    for (int i = -1; i < (int)object->num_instances(); i++) {
+      const int device_index = (i == -1) ? object->index : object->get_instance_device_index(i);
+      uint flag = (kinstances[device_index].flag & ~clear_flag) | set_flag;
+
+      if (bounds_valid) {
+        if (volume_grid) {
+          BoundBox bounds = (i == -1) ? object->bounds : object->instance_bounds(i);
+          if (volume_grid->intersects(object, bounds)) {
+            flag |= SD_OBJECT_INTERSECTS_VOLUME;
+          }
         }
       }
-    }
-    else if (has_volume_objects) {
-      /* Not really valid, but can't make more reliable in the case
-       * of bounds not being up to date.
-       */
-      object_flag[object->index] |= SD_OBJECT_INTERSECTS_VOLUME;
+      else if (has_volume_objects) {
+        /* Not really valid, but can't make more reliable in the case
+         * of bounds not being up to date.
+         */
+        flag |= SD_OBJECT_INTERSECTS_VOLUME;
+      }
+
+      kinstances[device_index].flag = flag;
     }
   }
 
   /* Copy object flag. */
-  dscene->object_flag.copy_to_device();
+  dscene->instances.copy_to_device();
   dscene->object_volume_step.copy_to_device();
 }
 
@@ -820,9 +1209,9 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
 void ObjectManager::device_free(Device *, DeviceScene *dscene)
 {
   dscene->objects.free();
+  dscene->instances.free();
   dscene->object_motion_pass.free();
   dscene->object_motion.free();
-  dscene->object_flag.free();
   dscene->object_volume_step.free();
 }
 
@@ -841,17 +1230,19 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
 
   foreach (Object *object, scene->objects) {
     map<Geometry *, int>::iterator it = geometry_users.find(object->geometry);
+    /* Additional instances are users of the geometry as well. */
+    const int users = 1 + object->num_instances();
 
     if (it == geometry_users.end())
-      geometry_users[object->geometry] = 1;
+      geometry_users[object->geometry] = users;
     else
-      it->second++;
+      it->second += users;
   }
 
   if (progress.get_cancel())
     return;
 
-  uint *object_flag = dscene->object_flag.data();
+  KernelInstance *kinstances = dscene->instances.data();
 
   /* apply transforms for objects with single user geometry */
   foreach (Object *object, scene->objects) {
@@ -879,9 +1270,9 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
             return;
         }
 
-        object_flag[i] |= SD_OBJECT_TRANSFORM_APPLIED;
+        kinstances[i].flag |= SD_OBJECT_TRANSFORM_APPLIED;
         if (geom->transform_negative_scaled)
-          object_flag[i] |= SD_OBJECT_NEGATIVE_SCALE_APPLIED;
+          kinstances[i].flag |= SD_OBJECT_NEGATIVE_SCALE_APPLIED;
       }
       else
         have_instancing = true;
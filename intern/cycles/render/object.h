@@ -66,6 +66,21 @@ class Object : public Node {
   ParticleSystem *particle_system;
   int particle_index;
 
+  /* Additional instances of this object, traced and shaded like the object
+   * itself but with their own transform, random ID, dupli texture coordinates
+   * and particle. Settings that depend on the object scale like the volume
+   * density come from the object. Much cheaper than an object each for large
+   * numbers of instances. */
+  array<Transform> instance_tfm;
+  array<uint> instance_random_id;
+  array<float3> instance_dupli_generated;
+  array<float2> instance_dupli_uv;
+  /* Index of the particle in the particle system of the object. */
+  array<int> instance_particle_index;
+  /* Motion transforms of the additional instances, the same number of steps
+   * for each instance one after the other, or empty without motion. */
+  array<Transform> instance_motion;
+
   Object();
   ~Object();
 
@@ -97,6 +112,29 @@ class Object : public Node {
   /* Returns the index that is used in the kernel for this object. */
   int get_device_index() const;
 
+  size_t num_instances() const
+  {
+    return instance_tfm.size();
+  }
+
+  /* Returns the index that is used in the kernel for an additional instance. */
+  int get_instance_device_index(size_t i) const;
+
+  /* Motion of the additional instances, see update_motion(). */
+  size_t instance_motion_steps() const;
+  bool instance_use_motion(size_t i) const;
+  void update_instance_motion();
+
+  /* Bounds of an additional instance. */
+  BoundBox instance_bounds(size_t i) const;
+
+  /* Transform, motion and bounds of the object or one of its additional
+   * instances, by the index that is used in the kernel. The motion is NULL
+   * when there is no motion. */
+  const Transform &get_device_transform(int device_index) const;
+  const Transform *get_device_motion(int device_index, size_t *num_steps) const;
+  BoundBox get_device_bounds(int device_index) const;
+
   /* Compute step size from attributes, shaders, transforms. */
   float compute_volume_step_size() const;
 
@@ -105,9 +143,22 @@ class Object : public Node {
    * in the device vectors. Gets set in device_update. */
   int index;
 
+  /* Index of the first additional instance in the device vectors, they come
+   * after all objects. Gets set in device_update. */
+  int instance_index;
+
+  /* Bounds of additional instances include their motion. Gets set in
+   * compute_bounds. */
+  bool instance_motion_blur;
+
   friend class ObjectManager;
 };
 
+/* Returns the object which an index used in the kernel belongs to, either
+ * the object itself or one of its additional instances. The objects must be
+ * in the order of their indices. */
+Object *object_from_device_index(const vector<Object *> &objects, int device_index);
+
 /* Object Manager */
 
 class ObjectManager {
@@ -43,7 +43,6 @@ CCL_NAMESPACE_BEGIN
 DeviceScene::DeviceScene(Device *device)
     : bvh_nodes(device, "__bvh_nodes", MEM_GLOBAL),
       bvh_leaf_nodes(device, "__bvh_leaf_nodes", MEM_GLOBAL),
-      object_node(device, "__object_node", MEM_GLOBAL),
       prim_tri_index(device, "__prim_tri_index", MEM_GLOBAL),
       prim_tri_verts(device, "__prim_tri_verts", MEM_GLOBAL),
       prim_type(device, "__prim_type", MEM_GLOBAL),
@@ -60,9 +59,9 @@ DeviceScene::DeviceScene(Device *device)
       curve_keys(device, "__curve_keys", MEM_GLOBAL),
       patches(device, "__patches", MEM_GLOBAL),
       objects(device, "__objects", MEM_GLOBAL),
+      instances(device, "__instances", MEM_GLOBAL),
       object_motion_pass(device, "__object_motion_pass", MEM_GLOBAL),
       object_motion(device, "__object_motion", MEM_GLOBAL),
-      object_flag(device, "__object_flag", MEM_GLOBAL),
       object_volume_step(device, "__object_volume_step", MEM_GLOBAL),
       camera_motion(device, "__camera_motion", MEM_GLOBAL),
       attributes_map(device, "__attributes_map", MEM_GLOBAL),
@@ -70,6 +69,7 @@ DeviceScene::DeviceScene(Device *device)
       attributes_float2(device, "__attributes_float2", MEM_GLOBAL),
       attributes_float3(device, "__attributes_float3", MEM_GLOBAL),
       attributes_uchar4(device, "__attributes_uchar4", MEM_GLOBAL),
+      attributes_uint(device, "__attributes_uint", MEM_GLOBAL),
       light_distribution(device, "__light_distribution", MEM_GLOBAL),
       lights(device, "__lights", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
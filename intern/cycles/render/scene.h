@@ -65,7 +65,6 @@ class DeviceScene {
   /* BVH */
   device_vector<int4> bvh_nodes;
   device_vector<int4> bvh_leaf_nodes;
-  device_vector<int> object_node;
   device_vector<uint> prim_tri_index;
   device_vector<float4> prim_tri_verts;
   device_vector<int> prim_type;
@@ -88,9 +87,9 @@ class DeviceScene {
 
   /* objects */
   device_vector<KernelObject> objects;
+  device_vector<KernelInstance> instances;
   device_vector<Transform> object_motion_pass;
   device_vector<DecomposedTransform> object_motion;
-  device_vector<uint> object_flag;
   device_vector<float> object_volume_step;
 
   /* cameras */
@@ -102,6 +101,7 @@ class DeviceScene {
   device_vector<float2> attributes_float2;
   device_vector<float4> attributes_float3;
   device_vector<uchar4> attributes_uchar4;
+  device_vector<uint> attributes_uint;
 
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
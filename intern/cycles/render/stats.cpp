@@ -45,6 +45,14 @@ bool namedSampleCountPairComparator(const NamedSampleCountPair &a, const NamedSa
   return a.samples > b.samples;
 }
 
+bool namedRayCostEntryComparator(const NamedRayCostEntry &a, const NamedRayCostEntry &b)
+{
+  if (a.shader_time != b.shader_time) {
+    return a.shader_time > b.shader_time;
+  }
+  return a.traversal_steps > b.traversal_steps;
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry() : name(""), size(0)
@@ -67,6 +75,12 @@ void NamedSizeStats::add_entry(const NamedSizeEntry &entry)
   entries.push_back(entry);
 }
 
+void NamedSizeStats::clear()
+{
+  total_size = 0;
+  entries.clear();
+}
+
 string NamedSizeStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
@@ -87,6 +101,41 @@ string NamedSizeStats::full_report(int indent_level)
   return result;
 }
 
+/* Named time statistics. */
+
+NamedTimeEntry::NamedTimeEntry(const string &name, double time) : name(name), time(time)
+{
+}
+
+NamedTimeStats::NamedTimeStats() : total_time(0.0)
+{
+}
+
+void NamedTimeStats::add_entry(const NamedTimeEntry &entry)
+{
+  total_time += entry.time;
+  entries.push_back(entry);
+}
+
+void NamedTimeStats::clear()
+{
+  total_time = 0.0;
+  entries.clear();
+}
+
+string NamedTimeStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string double_indent = indent + indent;
+  string result = "";
+  result += string_printf("%sTotal time: %.2fs\n", indent.c_str(), total_time);
+  foreach (const NamedTimeEntry &entry, entries) {
+    result += string_printf(
+        "%s%-32s %.2fs\n", double_indent.c_str(), entry.name.c_str(), entry.time);
+  }
+  return result;
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0)
@@ -196,9 +245,65 @@ string NamedSampleCountStats::full_report(int indent_level)
   return result;
 }
 
+/* Named ray cost entries. */
+
+NamedRayCostEntry::NamedRayCostEntry(const ustring &name,
+                                     uint64_t traversal_steps,
+                                     uint64_t intersections,
+                                     double shader_time)
+    : name(name),
+      traversal_steps(traversal_steps),
+      intersections(intersections),
+      shader_time(shader_time)
+{
+}
+
+NamedRayCostStats::NamedRayCostStats()
+{
+}
+
+void NamedRayCostStats::add(const ustring &name,
+                            uint64_t traversal_steps,
+                            uint64_t intersections,
+                            double shader_time)
+{
+  entry_map::iterator entry = entries.find(name);
+  if (entry != entries.end()) {
+    entry->second.traversal_steps += traversal_steps;
+    entry->second.intersections += intersections;
+    entry->second.shader_time += shader_time;
+    return;
+  }
+  entries.emplace(name, NamedRayCostEntry(name, traversal_steps, intersections, shader_time));
+}
+
+string NamedRayCostStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+
+  vector<NamedRayCostEntry> sorted_entries;
+  sorted_entries.reserve(entries.size());
+  foreach (entry_map::const_reference entry, entries) {
+    sorted_entries.push_back(entry.second);
+  }
+
+  sort(sorted_entries.begin(), sorted_entries.end(), namedRayCostEntryComparator);
+
+  string result = "";
+  foreach (const NamedRayCostEntry &entry, sorted_entries) {
+    result += indent +
+              string_printf("%-32s: Shading %.2fs, Traversal steps %s, Intersections %s\n",
+                            entry.name.c_str(),
+                            entry.shader_time,
+                            string_human_readable_number(entry.traversal_steps).c_str(),
+                            string_human_readable_number(entry.intersections).c_str());
+  }
+  return result;
+}
+
 /* Mesh statistics. */
 
-MeshStats::MeshStats()
+MeshStats::MeshStats() : attributes_compact_saved(0)
 {
 }
 
@@ -207,6 +312,17 @@ string MeshStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  if (attributes.total_size) {
+    const string child_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+    result += indent + "Attributes:\n" + attributes.full_report(indent_level + 1);
+    result += string_printf("%sSaved by compact formats: %s (%s bytes)\n",
+                            child_indent.c_str(),
+                            string_human_readable_size(attributes_compact_saved).c_str(),
+                            string_human_readable_number(attributes_compact_saved).c_str());
+  }
+  if (update_times.entries.size()) {
+    result += indent + "Update times:\n" + update_times.full_report(indent_level + 1);
+  }
   return result;
 }
 
@@ -299,6 +415,16 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
       objects.add(object->name, samples, hits);
     }
   }
+
+  object_costs.entries.clear();
+  foreach (Object *object, scene->objects) {
+    uint64_t traversal_steps, intersections;
+    double shader_time;
+    if (prof.get_object_cost(
+            object->get_device_index(), traversal_steps, intersections, shader_time)) {
+      object_costs.add(object->name, traversal_steps, intersections, shader_time);
+    }
+  }
 }
 
 string RenderStats::full_report()
@@ -310,6 +436,7 @@ string RenderStats::full_report()
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
     result += "Object statistics:\n" + objects.full_report(1);
+    result += "Object cost statistics:\n" + object_costs.full_report(1);
   }
   else {
     result += "Profiling information not available (only works with CPU rendering)";
@@ -52,6 +52,9 @@ class NamedSizeStats {
   /* Add entry to the statistics. */
   void add_entry(const NamedSizeEntry &entry);
 
+  /* Remove all entries. */
+  void clear();
+
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
@@ -109,6 +112,67 @@ class NamedSampleCountStats {
   entry_map entries;
 };
 
+/* Named entry containing the ray cost of an object as counted for the profile
+ * pass: BVH traversal steps and intersection tests of rays hitting the object,
+ * and the time spent evaluating its shaders. */
+class NamedRayCostEntry {
+ public:
+  NamedRayCostEntry(const ustring &name,
+                    uint64_t traversal_steps,
+                    uint64_t intersections,
+                    double shader_time);
+
+  ustring name;
+  uint64_t traversal_steps;
+  uint64_t intersections;
+  double shader_time;
+};
+
+/* Contains ray cost statistics as described above. */
+class NamedRayCostStats {
+ public:
+  NamedRayCostStats();
+
+  string full_report(int indent_level = 0);
+  void add(const ustring &name,
+           uint64_t traversal_steps,
+           uint64_t intersections,
+           double shader_time);
+
+  typedef unordered_map<ustring, NamedRayCostEntry, ustringHash> entry_map;
+  entry_map entries;
+};
+
+/* Named entry containing the time spent in one stage of an update, in seconds. */
+class NamedTimeEntry {
+ public:
+  NamedTimeEntry(const string &name, double time);
+
+  string name;
+  double time;
+};
+
+/* Container of named time entries, reported in the order they were added so
+ * that update stages show up in execution order. */
+class NamedTimeStats {
+ public:
+  NamedTimeStats();
+
+  /* Add entry to the statistics. */
+  void add_entry(const NamedTimeEntry &entry);
+
+  /* Remove all entries. */
+  void clear();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Total time of all entries. */
+  double total_time;
+
+  vector<NamedTimeEntry> entries;
+};
+
 /* Statistics about mesh in the render database. */
 class MeshStats {
  public:
@@ -122,6 +186,14 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Time spent in the stages of the last geometry device update. */
+  NamedTimeStats update_times;
+
+  /* Device memory of attributes per storage format, and memory saved by
+   * compact formats compared to full precision. */
+  NamedSizeStats attributes;
+  size_t attributes_compact_saved;
 };
 
 /* Statistics about images held in memory. */
@@ -153,6 +225,7 @@ class RenderStats {
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
+  NamedRayCostStats object_costs;
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+#include "render/buffers.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/session.h"
+#include "render/shader.h"
+#include "util/util_color.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Vertex colors as painted in Blender, sRGB encoded bytes. Mostly dark values, where storing
+ * linear bytes loses the most. */
+const uchar srgb_values[] = {0, 1, 2, 4, 8, 12, 16, 24, 32, 64, 128, 255};
+const int num_colors = sizeof(srgb_values) / sizeof(*srgb_values);
+
+/* Pixels per color horizontally and per row vertically. */
+const int patch_size = 8;
+const int num_rows = 3;
+
+uchar4 painted_color(int i)
+{
+  return make_uchar4(srgb_values[i],
+                     srgb_values[(i + 3) % num_colors],
+                     srgb_values[(i + 7) % num_colors],
+                     255);
+}
+
+float3 expected_linear_color(int i)
+{
+  const float4 srgb = color_uchar4_to_float4(painted_color(i));
+  return make_float3(color_srgb_to_linear(srgb.x),
+                     color_srgb_to_linear(srgb.y),
+                     color_srgb_to_linear(srgb.z));
+}
+
+/* Emission shader showing a color attribute, either through an attribute node or through a
+ * vertex color node. */
+Shader *add_emission_shader(Scene *scene, ustring layer, bool use_vertex_color_node)
+{
+  ShaderGraph *graph = new ShaderGraph();
+
+  ShaderNode *color_node;
+  if (use_vertex_color_node) {
+    VertexColorNode *vertex_color = new VertexColorNode();
+    vertex_color->layer_name = layer;
+    color_node = vertex_color;
+  }
+  else {
+    AttributeNode *attribute = new AttributeNode();
+    attribute->attribute = layer;
+    color_node = attribute;
+  }
+  graph->add(color_node);
+
+  EmissionNode *emission = new EmissionNode();
+  emission->strength = 1.0f;
+  graph->add(emission);
+
+  graph->connect(color_node->output("Color"), emission->input("Color"));
+  graph->connect(emission->output("Emission"), graph->output()->input("Surface"));
+
+  Shader *shader = new Shader();
+  shader->name = layer;
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+  scene->shaders.push_back(shader);
+  return shader;
+}
+
+/* A row of flat colored quads at depth 1, one quad per color, spanning x from -1 to 1. The row
+ * covers y from y_min to y_min + 2 / num_rows. */
+void add_color_row(Scene *scene, Shader *shader, ustring layer, float y_min, bool srgb_bytes)
+{
+  Mesh *mesh = new Mesh();
+  mesh->used_shaders.push_back(shader);
+  scene->geometry.push_back(mesh);
+
+  Object *object = new Object();
+  object->geometry = mesh;
+  object->tfm = transform_identity();
+  scene->objects.push_back(object);
+
+  const float y_max = y_min + 2.0f / num_rows;
+  const float width = 2.0f / num_colors;
+  mesh->reserve_mesh(num_colors * 4, num_colors * 2);
+  for (int i = 0; i < num_colors; i++) {
+    const float x_min = -1.0f + i * width;
+    mesh->add_vertex(make_float3(x_min, y_min, 1.0f));
+    mesh->add_vertex(make_float3(x_min + width, y_min, 1.0f));
+    mesh->add_vertex(make_float3(x_min + width, y_max, 1.0f));
+    mesh->add_vertex(make_float3(x_min, y_max, 1.0f));
+    mesh->add_triangle(i * 4 + 0, i * 4 + 1, i * 4 + 2, 0, false);
+    mesh->add_triangle(i * 4 + 0, i * 4 + 2, i * 4 + 3, 0, false);
+  }
+
+  /* The same conversions as the Blender mesh sync, before and after vertex colors kept their
+   * sRGB encoding. */
+  Attribute *attr = mesh->attributes.add(layer, TypeRGBA, ATTR_ELEMENT_CORNER_BYTE);
+  if (srgb_bytes) {
+    attr->flags |= ATTR_COMPACT_SRGB;
+  }
+  uchar4 *cdata = attr->data_uchar4();
+  for (int i = 0; i < num_colors; i++) {
+    float4 color = color_uchar4_to_float4(painted_color(i));
+    if (!srgb_bytes) {
+      color = color_srgb_to_linear_v4(color);
+    }
+    for (int corner = 0; corner < 6; corner++) {
+      *(cdata++) = color_float4_to_uchar4(color);
+    }
+  }
+}
+
+}  // namespace
+
+/* Render the vertex colors stored both ways with the CPU device, every consumer has to see the
+ * same linear colors up to the precision of the old linear bytes. */
+TEST(render_vertex_color, srgb_bytes_match_linear_bytes)
+{
+  vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK_CPU);
+  ASSERT_FALSE(devices.empty());
+
+  const int width = num_colors * patch_size;
+  const int height = num_rows * patch_size;
+
+  SessionParams session_params;
+  session_params.device = devices.front();
+  session_params.background = true;
+  session_params.progressive = true;
+  session_params.samples = 1;
+  session_params.threads = 1;
+  /* Keeps the render buffers around after rendering. */
+  session_params.write_render_cb = [](const uchar *, int, int, int) { return true; };
+
+  Session *session = new Session(session_params);
+  Scene *scene = new Scene(SceneParams(), session->device);
+  session->scene = scene;
+
+  scene->camera->type = CAMERA_ORTHOGRAPHIC;
+  scene->camera->matrix = transform_identity();
+  scene->camera->width = scene->camera->full_width = width;
+  scene->camera->height = scene->camera->full_height = height;
+  /* The rows of quads fill the whole view. */
+  scene->camera->viewplane.left = -1.0f;
+  scene->camera->viewplane.right = 1.0f;
+  scene->camera->viewplane.bottom = -1.0f;
+  scene->camera->viewplane.top = 1.0f;
+  scene->camera->need_update = true;
+
+  /* One sample per pixel inside the pixel, so pixels inside a quad only see that quad. */
+  scene->film->filter_type = FILTER_BOX;
+  scene->film->filter_width = 1.0f;
+  scene->film->tag_update(scene);
+
+  /* The rows with sRGB bytes are outside, so the result does not depend on the direction of the
+   * vertical raster axis. */
+  const ustring before("LinearBytes"), after("SRGBBytes");
+  add_color_row(scene, add_emission_shader(scene, after, false), after, -1.0f, true);
+  add_color_row(scene, add_emission_shader(scene, before, false), before, -1.0f / 3.0f, false);
+  add_color_row(scene, add_emission_shader(scene, after, true), after, 1.0f / 3.0f, true);
+
+  BufferParams buffer_params;
+  buffer_params.width = width;
+  buffer_params.height = height;
+  buffer_params.full_width = width;
+  buffer_params.full_height = height;
+  Pass::add(PASS_COMBINED, buffer_params.passes, "Combined");
+  scene->film->tag_passes_update(scene, buffer_params.passes);
+
+  session->reset(buffer_params, session_params.samples);
+  session->start();
+  session->wait();
+
+  ASSERT_FALSE(session->progress.get_error()) << session->progress.get_error_message();
+
+  vector<float> pixels(width * height * 4);
+  ASSERT_TRUE(session->buffers->get_pass_rect(
+      "Combined", 1.0f, session_params.samples, 4, pixels.data()));
+
+  /* Half a step of the old linear bytes. */
+  const float linear_byte_error = 0.5f / 255.0f;
+  float error_before = 0.0f, error_after = 0.0f;
+
+  for (int i = 0; i < num_colors; i++) {
+    const float3 expected = expected_linear_color(i);
+    const int x = i * patch_size + patch_size / 2;
+    float3 row_color[num_rows];
+    for (int row = 0; row < num_rows; row++) {
+      const float *pixel = &pixels[((row * patch_size + patch_size / 2) * width + x) * 4];
+      row_color[row] = make_float3(pixel[0], pixel[1], pixel[2]);
+    }
+
+    for (int c = 0; c < 3; c++) {
+      const float tolerance = 1e-3f * expected[c] + 1e-6f;
+      /* Attribute node and vertex color node decode the sRGB bytes. */
+      EXPECT_NEAR(row_color[0][c], expected[c], tolerance) << "color " << i << " channel " << c;
+      EXPECT_NEAR(row_color[2][c], expected[c], tolerance) << "color " << i << " channel " << c;
+      /* The linear bytes are only accurate to half a byte step, the colors of both encodings
+       * may not differ by more than that. */
+      EXPECT_NEAR(row_color[1][c], expected[c], linear_byte_error + tolerance)
+          << "color " << i << " channel " << c;
+      EXPECT_NEAR(row_color[0][c], row_color[1][c], linear_byte_error + tolerance)
+          << "color " << i << " channel " << c;
+
+      error_before += fabsf(row_color[1][c] - expected[c]);
+      error_after += fabsf(row_color[0][c] - expected[c]);
+    }
+  }
+
+  /* Dark colors are what the sRGB bytes are for. */
+  EXPECT_LT(error_after, error_before);
+
+  delete session;
+}
+
+CCL_NAMESPACE_END
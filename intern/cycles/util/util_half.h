@@ -160,10 +160,34 @@ ccl_device_inline half float_to_half(float f)
   return (value_bits | sign_bit);
 }
 
+/* Pack two floats as half floats into a uint, used for compact attribute storage. */
+ccl_device_inline uint float2_to_half2(float2 f)
+{
+  return (uint)(unsigned short)float_to_half(f.x) |
+         ((uint)(unsigned short)float_to_half(f.y) << 16);
+}
+
 #  endif
 
 #endif
 
+/* Unpack two half floats stored in a uint by float2_to_half2. Denormals are not
+ * handled, as they are flushed to zero when packing. */
+ccl_device_inline float half_bits_to_float(uint h)
+{
+  const uint sign = (h & 0x8000) << 16;
+  const uint exponent = h & 0x7c00;
+  if (exponent == 0) {
+    return __uint_as_float(sign);
+  }
+  return __uint_as_float(sign | ((exponent + 0x1C000) << 13) | ((h & 0x03ff) << 13));
+}
+
+ccl_device_inline float2 half2_to_float2(uint packed)
+{
+  return make_float2(half_bits_to_float(packed & 0xffff), half_bits_to_float(packed >> 16));
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_HALF_H__ */
@@ -494,6 +494,37 @@ ccl_device_inline float3 ensure_finite3(float3 v)
   return v;
 }
 
+/* Octahedral encoding of unit vectors into two signed 16 bit integers packed
+ * in a uint, used for compact attribute storage. */
+
+ccl_device_inline uint float3_to_octahedral(float3 v)
+{
+  const float inv_l1 = 1.0f / (fabsf(v.x) + fabsf(v.y) + fabsf(v.z));
+  float x = v.x * inv_l1;
+  float y = v.y * inv_l1;
+  if (v.z < 0.0f) {
+    const float tx = x;
+    x = (1.0f - fabsf(y)) * signf(tx);
+    y = (1.0f - fabsf(tx)) * signf(y);
+  }
+  const int qx = (int)floorf(clamp(x, -1.0f, 1.0f) * 32767.0f + 0.5f);
+  const int qy = (int)floorf(clamp(y, -1.0f, 1.0f) * 32767.0f + 0.5f);
+  return ((uint)qx & 0xffff) | (((uint)qy & 0xffff) << 16);
+}
+
+ccl_device_inline float3 octahedral_to_float3(uint packed)
+{
+  float x = max((float)(short)(packed & 0xffff) * (1.0f / 32767.0f), -1.0f);
+  float y = max((float)(short)(packed >> 16) * (1.0f / 32767.0f), -1.0f);
+  const float z = 1.0f - fabsf(x) - fabsf(y);
+  if (z < 0.0f) {
+    const float tx = x;
+    x = (1.0f - fabsf(y)) * signf(tx);
+    y = (1.0f - fabsf(tx)) * signf(y);
+  }
+  return normalize(make_float3(x, y, z));
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_MATH_FLOAT3_H__ */
@@ -83,6 +83,10 @@ void Profiler::reset(int num_shaders, int num_objects)
   shader_hits.assign(num_shaders, 0);
   object_hits.assign(num_objects, 0);
 
+  object_traversal_steps.assign(num_objects, 0);
+  object_intersections.assign(num_objects, 0);
+  object_shader_time.assign(num_objects, 0.0);
+
   event_samples.assign(PROFILING_NUM_EVENTS, 0);
   shader_samples.assign(num_shaders, 0);
   object_samples.assign(num_objects, 0);
@@ -122,10 +126,17 @@ void Profiler::add_state(ProfilingState *state)
   state->shader_hits.assign(shader_hits.size(), 0);
   state->object_hits.assign(object_hits.size(), 0);
 
+  /* Resize thread-local cost counters. */
+  state->object_traversal_steps.assign(object_traversal_steps.size(), 0);
+  state->object_intersections.assign(object_intersections.size(), 0);
+  state->object_shader_time.assign(object_shader_time.size(), 0.0);
+
   /* Initialize the state. */
   state->event = PROFILING_UNKNOWN;
   state->shader = -1;
   state->object = -1;
+  state->use_object_cost = (worker != NULL);
+  state->reset_cost(false);
   state->active = true;
 }
 
@@ -147,6 +158,14 @@ void Profiler::remove_state(ProfilingState *state)
   for (int i = 0; i < object_hits.size(); i++) {
     object_hits[i] += state->object_hits[i];
   }
+
+  /* Merge thread-local cost counters. */
+  assert(object_traversal_steps.size() == state->object_traversal_steps.size());
+  for (int i = 0; i < object_traversal_steps.size(); i++) {
+    object_traversal_steps[i] += state->object_traversal_steps[i];
+    object_intersections[i] += state->object_intersections[i];
+    object_shader_time[i] += state->object_shader_time[i];
+  }
 }
 
 uint64_t Profiler::get_event(ProfilingEvent event)
@@ -177,4 +196,19 @@ bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
   return true;
 }
 
+bool Profiler::get_object_cost(int object,
+                               uint64_t &traversal_steps,
+                               uint64_t &intersections,
+                               double &shader_time)
+{
+  assert(worker == NULL);
+  if (object_traversal_steps[object] == 0 && object_shader_time[object] == 0.0) {
+    return false;
+  }
+  traversal_steps = object_traversal_steps[object];
+  intersections = object_intersections[object];
+  shader_time = object_shader_time[object];
+  return true;
+}
+
 CCL_NAMESPACE_END
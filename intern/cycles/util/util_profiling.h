@@ -21,6 +21,7 @@
 
 #include "util/util_map.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -85,6 +86,49 @@ struct ProfilingState {
 
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
+
+  /* Cost counters of the current path sample, written to the profile pass
+   * and reset at the start of every sample by the kernel. Traversal steps and
+   * intersection tests are only counted by the Cycles BVH, not by Embree. */
+  uint32_t traversal_steps = 0;
+  uint32_t intersections = 0;
+  double shader_time = 0.0;
+
+  /* Count the cost even if the profile pass is disabled, so the per-object
+   * totals are available for the render statistics. */
+  bool use_object_cost = false;
+
+  /* Whether the counters are updated for the current sample at all. */
+  bool use_cost = false;
+
+  /* Thread-local per-object totals of the counters above. */
+  vector<uint64_t> object_traversal_steps;
+  vector<uint64_t> object_intersections;
+  vector<double> object_shader_time;
+
+  inline void reset_cost(bool use_pass)
+  {
+    use_cost = use_pass || use_object_cost;
+    traversal_steps = 0;
+    intersections = 0;
+    shader_time = 0.0;
+  }
+
+  inline void add_object_cost(int object, uint32_t steps, uint32_t isects)
+  {
+    if (active && object >= 0 && object < object_traversal_steps.size()) {
+      object_traversal_steps[object] += steps;
+      object_intersections[object] += isects;
+    }
+  }
+
+  inline void add_object_shader_time(int object, double time)
+  {
+    shader_time += time;
+    if (active && object >= 0 && object < object_shader_time.size()) {
+      object_shader_time[object] += time;
+    }
+  }
 };
 
 class Profiler {
@@ -103,6 +147,10 @@ class Profiler {
   uint64_t get_event(ProfilingEvent event);
   bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
   bool get_object(int object, uint64_t &samples, uint64_t &hits);
+  bool get_object_cost(int object,
+                       uint64_t &traversal_steps,
+                       uint64_t &intersections,
+                       double &shader_time);
 
  protected:
   void run();
@@ -117,10 +165,16 @@ class Profiler {
   /* Tracks the total amounts every object/shader was hit.
    * Used to evaluate relative cost, written by the render thread.
    * Indexed by the shader and object IDs that the kernel also uses
-   * to index __object_flag and __shaders. */
+   * to index __objects and __shaders. */
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
 
+  /* Per-object totals of the ray cost counted by the kernel for the profile pass.
+   * Shader time is in seconds. */
+  vector<uint64_t> object_traversal_steps;
+  vector<uint64_t> object_intersections;
+  vector<double> object_shader_time;
+
   volatile bool do_stop_worker;
   thread *worker;
 
@@ -169,6 +223,28 @@ class ProfilingHelper {
   uint32_t previous_event;
 };
 
+/* Scoped timer adding the time spent in a shader evaluation to the current
+ * sample and object, does nothing unless enabled. */
+class ProfilingShaderTimer {
+ public:
+  ProfilingShaderTimer(ProfilingState *state, bool enabled, int object)
+      : state(state), object(object), start_time(enabled ? time_dt() : -1.0)
+  {
+  }
+
+  ~ProfilingShaderTimer()
+  {
+    if (start_time >= 0.0) {
+      state->add_object_shader_time(object, time_dt() - start_time);
+    }
+  }
+
+ private:
+  ProfilingState *state;
+  int object;
+  double start_time;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_PROFILING_H__ */
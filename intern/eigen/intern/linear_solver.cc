@@ -268,14 +268,8 @@ void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int in
 
 /* Solve */
 
-bool EIG_linear_solver_solve(LinearSolver *solver)
+static bool linear_solver_factorize(LinearSolver *solver)
 {
-  /* nothing to solve, perhaps all variables were locked */
-  if (solver->m == 0 || solver->n == 0)
-    return true;
-
-  bool result = true;
-
   assert(solver->state != LinearSolver::STATE_VARIABLES_CONSTRUCT);
 
   if (solver->state == LinearSolver::STATE_MATRIX_CONSTRUCT) {
@@ -297,11 +291,49 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
     solver->sparseLU = sparseLU;
 
     sparseLU->compute(M);
-    result = (sparseLU->info() == Eigen::Success);
 
     solver->state = LinearSolver::STATE_MATRIX_SOLVED;
   }
 
+  return (solver->sparseLU->info() == Eigen::Success);
+}
+
+bool EIG_linear_solver_factorize(LinearSolver *solver)
+{
+  /* nothing to solve, perhaps all variables were locked */
+  if (solver->m == 0 || solver->n == 0)
+    return true;
+
+  return linear_solver_factorize(solver);
+}
+
+bool EIG_linear_solver_solve_dense(LinearSolver *solver, int num_rhs, const double *b, double *x)
+{
+  if (solver->m == 0 || solver->n == 0)
+    return true;
+
+  /* factorization is not thread safe, it must be done before */
+  assert(solver->state == LinearSolver::STATE_MATRIX_SOLVED);
+  assert(!solver->least_squares && solver->m == solver->n);
+
+  if (solver->sparseLU->info() != Eigen::Success)
+    return false;
+
+  Eigen::Map<const Eigen::MatrixXd> B(b, solver->m, num_rhs);
+  Eigen::Map<Eigen::MatrixXd> X(x, solver->n, num_rhs);
+  X = solver->sparseLU->solve(B);
+
+  return true;
+}
+
+bool EIG_linear_solver_solve(LinearSolver *solver)
+{
+  /* nothing to solve, perhaps all variables were locked */
+  if (solver->m == 0 || solver->n == 0)
+    return true;
+
+  bool result = linear_solver_factorize(solver);
+
   if (result) {
     /* solve for each right hand side */
     for (int rhs = 0; rhs < solver->num_rhs; rhs++) {
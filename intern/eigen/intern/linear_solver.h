@@ -58,6 +58,16 @@ void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int in
 
 bool EIG_linear_solver_solve(LinearSolver *solver);
 
+/* Solve for many right hand sides at once, bypassing the variables. Only for square systems
+ * without locked variables. b and x hold num_right_hand_sides columns of num_columns values.
+ * Once the matrix is factorized, dense solves may run from multiple threads at the same time. */
+
+bool EIG_linear_solver_factorize(LinearSolver *solver);
+bool EIG_linear_solver_solve_dense(LinearSolver *solver,
+                                   int num_right_hand_sides,
+                                   const double *b,
+                                   double *x);
+
 /* Debugging */
 
 void EIG_linear_solver_print_matrix(LinearSolver *solver);
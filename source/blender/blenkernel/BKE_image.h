@@ -242,6 +242,8 @@ void BKE_image_user_id_eval_animation(struct Depsgraph *depsgrah, struct ID *id)
 
 /* sets index offset for multilayer files */
 struct RenderPass *BKE_image_multilayer_index(struct RenderResult *rr, struct ImageUser *iuser);
+/* Read the passes of a multilayer sequence frame which were not used so far. */
+void BKE_image_multilayer_read_passes(struct Image *ima, struct ImageUser *iuser);
 
 /* sets index offset for multiview files */
 void BKE_image_multiview_index(struct Image *ima, struct ImageUser *iuser);
@@ -367,6 +369,31 @@ bool BKE_image_remove_renderslot(struct Image *ima, struct ImageUser *iuser, int
 struct RenderSlot *BKE_image_get_renderslot(struct Image *ima, int slot);
 bool BKE_image_clear_renderslot(struct Image *ima, struct ImageUser *iuser, int slot);
 
+/* Tiled, mipmapped access to image files with a global memory budget (image_tiled.c). */
+typedef struct ImageTiledTexture ImageTiledTexture;
+
+ImageTiledTexture *BKE_image_tiled_acquire(struct Image *ima, struct ImageUser *iuser);
+ImageTiledTexture *BKE_image_tiled_acquire_file(const char *filepath, const char *colorspace);
+void BKE_image_tiled_release(ImageTiledTexture *texture);
+int BKE_image_tiled_levels(const ImageTiledTexture *texture);
+bool BKE_image_tiled_is_float(const ImageTiledTexture *texture);
+void BKE_image_tiled_size(const ImageTiledTexture *texture,
+                          int level,
+                          int *r_width,
+                          int *r_height);
+void BKE_image_tiled_sample(
+    ImageTiledTexture *texture, float u, float v, float lod, float r_color[4]);
+void BKE_image_tiled_read_rect(ImageTiledTexture *texture,
+                               int level,
+                               int xmin,
+                               int ymin,
+                               int width,
+                               int height,
+                               float *r_rect);
+void BKE_image_tiled_cache_limit_set(size_t limit);
+size_t BKE_image_tiled_cache_memory_in_use(void);
+void BKE_image_tiled_cache_free(void);
+
 #ifdef __cplusplus
 }
 #endif
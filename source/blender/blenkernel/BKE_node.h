@@ -623,6 +623,10 @@ struct bNode *nodeGetActiveTexture(struct bNodeTree *ntree);
 
 void nodeUpdate(struct bNodeTree *ntree, struct bNode *node);
 bool nodeUpdateID(struct bNodeTree *ntree, struct ID *id);
+/* Changes whenever #nodeUpdateID finds nodes using the ID, so cached node results depending on
+ * the ID data can be invalidated. Zero for IDs that were never updated. */
+unsigned int BKE_node_id_update_generation(const struct ID *id);
+void BKE_node_id_update_generation_bump(const struct ID *id);
 void nodeUpdateInternalLinks(struct bNodeTree *ntree, struct bNode *node);
 
 int nodeSocketIsHidden(struct bNodeSocket *sock);
@@ -87,9 +87,14 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
   } \
   ((void)0)
 
+/* Number of frames prefetching may render at the same time. */
+#define SEQ_PREFETCH_MAX_FRAMES 4
+
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Frames rendered by prefetching at the same time use consecutive IDs from here on. */
   SEQ_TASK_PREFETCH_RENDER,
+  SEQ_TASK_MAX = SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_MAX_FRAMES,
 } eSeqTaskId;
 
 typedef struct SeqRenderData {
@@ -219,6 +224,10 @@ struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context,
                                               float cfra,
                                               int chan_shown,
                                               struct ListBase *seqbasep);
+bool BKE_sequencer_strip_can_decode(const SeqRenderData *context, struct Sequence *seq);
+struct ImBuf *BKE_sequencer_strip_decode(const SeqRenderData *context,
+                                         struct Sequence *seq,
+                                         float cfra);
 struct ImBuf *BKE_sequencer_effect_execute_threaded(struct SeqEffectHandle *sh,
                                                     const SeqRenderData *context,
                                                     struct Sequence *seq,
@@ -313,6 +322,10 @@ void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context,
                                  short *do_update,
                                  float *num_frames_prefetched);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue,
+                                       short *stop,
+                                       short *do_update,
+                                       float *progress);
 
 void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
 /* **********************************************************************
@@ -361,6 +374,7 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
                                                     int cache_type,
                                                     float cost));
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
+size_t BKE_sequencer_cache_get_memory_free(struct Scene *scene);
 
 /* **********************************************************************
  * seqprefetch.c
@@ -378,6 +392,9 @@ void BKE_sequencer_prefetch_get_time_range(struct Scene *scene, int *start, int
 SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context);
 struct Sequence *BKE_sequencer_prefetch_get_original_sequence(struct Sequence *seq,
                                                               struct Scene *scene);
+struct ImBuf *BKE_sequencer_prefetch_decoded_ibuf_get(const SeqRenderData *context,
+                                                      struct Sequence *seq,
+                                                      float cfra);
 
 /* **********************************************************************
  * seqeffects.c
@@ -398,6 +415,17 @@ float BKE_sequencer_speed_effect_target_frame_get(const SeqRenderData *context,
 struct SeqEffectHandle BKE_sequence_get_effect(struct Sequence *seq);
 int BKE_sequence_effect_get_num_inputs(int seq_type);
 int BKE_sequence_effect_get_supports_mask(int seq_type);
+
+/* Instruction sets of the vectorized blend effects. */
+enum {
+  SEQ_EFFECT_SIMD_NONE = 0,
+  SEQ_EFFECT_SIMD_SSE2 = 1,
+  SEQ_EFFECT_SIMD_AVX2 = 2,
+};
+
+/* Use blend effect kernels up to the given instruction set, returns the one used on this CPU. */
+int BKE_sequencer_effect_simd_set(int simd);
+
 void BKE_sequencer_text_font_unload(struct TextVars *data, const bool do_id_user);
 void BKE_sequencer_text_font_load(struct TextVars *data, const bool do_id_user);
 
@@ -293,6 +293,7 @@ void BKE_images_init(void)
 
 void BKE_images_exit(void)
 {
+  BKE_image_tiled_cache_free();
   BLI_mutex_free(image_mutex);
 }
 
@@ -3907,8 +3908,163 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
   /* set proper views */
   image_init_multilayer_multiview(ima, ima->rr);
 }
+
+/* Multilayer sequences read only the passes which are used: the render result of a frame is
+ * created from the file header, pass buffers are read on first use. Otherwise every frame
+ * decodes all passes of the file, while compositing or viewing usually needs one. */
+
+static bool image_multilayer_sequence_use_lazy(Image *ima)
+{
+  /* The render result of multiview sequences is merged from several files. */
+  return ima->source == IMA_SRC_SEQUENCE && !BKE_image_is_multiview(ima);
+}
+
+static void image_multilayer_sequence_filepath(Image *ima,
+                                               ImageUser *iuser,
+                                               int frame,
+                                               char r_filepath[FILE_MAX])
+{
+  ImageUser iuser_t = {0};
+
+  if (iuser) {
+    iuser_t = *iuser;
+  }
+  iuser_t.framenr = frame;
+  iuser_t.view = 0;
+  BKE_image_user_file_path(&iuser_t, ima, r_filepath);
+}
+
+/* Create the render result of a frame without reading any pass, false if the frame is not a
+ * multilayer file. */
+static bool image_multilayer_sequence_open(Image *ima, ImageUser *iuser, int frame)
+{
+  char filepath[FILE_MAX];
+  void *exrhandle = IMB_exr_get_handle();
+  int width, height;
+
+  image_multilayer_sequence_filepath(ima, iuser, frame, filepath);
+
+  if (IMB_exr_begin_read(exrhandle, filepath, &width, &height) &&
+      IMB_exr_has_multilayer(exrhandle)) {
+    const char *colorspace = ima->colorspace_settings.name;
+    bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 32, 0);
+
+    ima->rr = RE_MultilayerConvert(exrhandle, colorspace, predivide, width, height);
+
+    if (ima->rr != NULL) {
+      ima->rr->framenr = frame;
+      IMB_exr_read_metadata(exrhandle, &ibuf->metadata);
+      BKE_stamp_info_from_imbuf(ima->rr, ibuf);
+    }
+    IMB_freeImBuf(ibuf);
+  }
+  IMB_exr_close(exrhandle);
+
+  if (ima->rr == NULL) {
+    return false;
+  }
+
+  ima->type = IMA_TYPE_MULTILAYER;
+  image_init_multilayer_multiview(ima, ima->rr);
+  return true;
+}
+
+/* Read the buffers of the passes which were not read yet, all passes when rpass is NULL. */
+static void image_multilayer_sequence_read_passes(Image *ima, ImageUser *iuser, RenderPass *rpass)
+{
+  RenderResult *rr = ima->rr;
+  int totpass = 0;
+
+  LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+    totpass += BLI_listbase_count(&rl->passes);
+  }
+
+  if (totpass == 0) {
+    return;
+  }
+
+  const char **passnames = MEM_mallocN(sizeof(char *) * totpass, __func__);
+  char(*fullnames)[EXR_LAY_MAXNAME + EXR_PASS_MAXNAME + EXR_VIEW_MAXNAME + 3] = MEM_mallocN(
+      sizeof(*fullnames) * totpass, __func__);
+
+  totpass = 0;
+
+  LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+    LISTBASE_FOREACH (RenderPass *, rp, &rl->passes) {
+      if (rp->rect == NULL && ELEM(rpass, NULL, rp)) {
+        if (rp->view[0] != '\0') {
+          BLI_snprintf(fullnames[totpass],
+                       sizeof(*fullnames),
+                       "%s.%s.%s",
+                       rl->name,
+                       rp->name,
+                       rp->view);
+        }
+        else {
+          BLI_snprintf(fullnames[totpass], sizeof(*fullnames), "%s.%s", rl->name, rp->name);
+        }
+        passnames[totpass] = fullnames[totpass];
+        totpass++;
+      }
+    }
+  }
+
+  if (totpass != 0) {
+    char filepath[FILE_MAX];
+    void *exrhandle = IMB_exr_get_handle();
+    int width, height;
+
+    image_multilayer_sequence_filepath(ima, iuser, rr->framenr, filepath);
+
+    if (IMB_exr_begin_read(exrhandle, filepath, &width, &height) && width == rr->rectx &&
+        height == rr->recty) {
+      const char *colorspace = ima->colorspace_settings.name;
+      bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+
+      IMB_exr_read_passes(exrhandle, passnames, totpass, NULL);
+
+      /* Move the buffers of the read passes to the render result of the image. */
+      RenderResult *rr_read = RE_MultilayerConvert(
+          exrhandle, colorspace, predivide, width, height);
+      if (rr_read) {
+        LISTBASE_FOREACH (RenderLayer *, rl_read, &rr_read->layers) {
+          RenderLayer *rl = RE_GetRenderLayer(rr, rl_read->name);
+          if (rl == NULL) {
+            continue;
+          }
+          LISTBASE_FOREACH (RenderPass *, rp_read, &rl_read->passes) {
+            RenderPass *rp = RE_pass_find_by_name(rl, rp_read->name, rp_read->view);
+            if (rp && rp->rect == NULL && rp_read->rect && rp->channels == rp_read->channels) {
+              rp->rect = rp_read->rect;
+              rp_read->rect = NULL;
+            }
+          }
+        }
+        RE_FreeRenderResult(rr_read);
+      }
+    }
+    IMB_exr_close(exrhandle);
+  }
+
+  MEM_freeN(passnames);
+  MEM_freeN(fullnames);
+}
 #endif /* WITH_OPENEXR */
 
+void BKE_image_multilayer_read_passes(Image *ima, ImageUser *iuser)
+{
+#ifdef WITH_OPENEXR
+  BLI_mutex_lock(image_mutex);
+  if (ima->rr && ima->type == IMA_TYPE_MULTILAYER && image_multilayer_sequence_use_lazy(ima)) {
+    image_multilayer_sequence_read_passes(ima, iuser, NULL);
+  }
+  BLI_mutex_unlock(image_mutex);
+#else
+  UNUSED_VARS(ima, iuser);
+#endif
+}
+
 /* common stuff to do with images after loading */
 static void image_initialize_after_load(Image *ima, ImageUser *iuser, ImBuf *UNUSED(ibuf))
 {
@@ -4101,17 +4257,34 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int e
       ima->rr = NULL;
     }
 
-    ibuf = image_load_sequence_file(ima, iuser, entry, frame);
+    bool is_open = false;
 
-    if (ibuf) { /* actually an error */
-      ima->type = IMA_TYPE_IMAGE;
-      printf("error, multi is normal image\n");
+#ifdef WITH_OPENEXR
+    if (image_multilayer_sequence_use_lazy(ima)) {
+      is_open = image_multilayer_sequence_open(ima, iuser, frame);
+      ima->lastframe = frame;
+    }
+#endif
+
+    if (!is_open) {
+      ibuf = image_load_sequence_file(ima, iuser, entry, frame);
+
+      if (ibuf) { /* actually an error */
+        ima->type = IMA_TYPE_IMAGE;
+        printf("error, multi is normal image\n");
+      }
     }
   }
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+#ifdef WITH_OPENEXR
+    if (rpass && rpass->rect == NULL) {
+      image_multilayer_sequence_read_passes(ima, iuser, rpass);
+    }
+#endif
+
+    if (rpass && rpass->rect) {
       // printf("load from pass %s\n", rpass->name);
       /* since we free  render results, we copy the rect */
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -0,0 +1,795 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Tiled, mipmapped access to image files, without keeping full resolution buffers in memory.
+ *
+ * The first time a file is used, it is converted to a cache file in the temporary directory
+ * which holds all mip levels split in tiles of a fixed size. The file is read in bands of rows
+ * while converting, so the full resolution image is never in memory. Tiles are then read on
+ * demand.
+ * All textures share one memory budget, the least recently used tiles are freed first.
+ *
+ * Pixels are returned like they are stored in an ImBuf loaded from the file: float images in
+ * scene linear with premultiplied alpha, byte images divided by 255 in the image colorspace.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_image_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_image.h"
+
+#include "atomic_ops.h"
+
+/* Width and height of tiles in pixels. */
+#define TILED_TILE_SIZE 64
+/* Enough for images up to 2^31 pixels wide. */
+#define TILED_MAX_LEVELS 32
+/* Identifies cache files, bump the version when the layout changes. */
+#define TILED_FILE_MAGIC "BTEX"
+#define TILED_FILE_VERSION 1
+/* Default memory budget of all tiles. */
+#define TILED_DEFAULT_LIMIT ((size_t)1024 * 1024 * 1024)
+
+/* Header of cache files, followed by the tiles of all levels, from full resolution down. */
+typedef struct TiledFileHeader {
+  char magic[4];
+  int version;
+  /* Source of the cache file, to detect hash collisions. */
+  char filepath[FILE_MAX];
+  char colorspace[IMA_MAX_SPACE];
+  /* Modification time and size of the source, the cache file is outdated when they change. */
+  int64_t source_mtime, source_size;
+  int width, height;
+  int tot_levels;
+  int is_float;
+} TiledFileHeader;
+
+typedef struct ImageTiledLevel {
+  int width, height;
+  int xtiles, ytiles;
+  /* Index of the first tile of the level. */
+  int first_tile;
+} ImageTiledLevel;
+
+typedef struct ImageTiledTile {
+  struct ImageTiledTile *next, *prev;
+  struct ImageTiledTexture *texture;
+  int index;
+  int users;
+  /* RGBA float or byte pixels, rows from bottom to top like ImBuf. */
+  void *pixels;
+} ImageTiledTile;
+
+struct ImageTiledTexture {
+  struct ImageTiledTexture *next, *prev;
+  char filepath[FILE_MAX];
+  char colorspace[IMA_MAX_SPACE];
+  /* Of the source when the cache file was written. */
+  int64_t source_mtime, source_size;
+
+  FILE *file;
+  bool is_float;
+  size_t tile_size_in_bytes;
+
+  int tot_levels, tot_tiles;
+  ImageTiledLevel levels[TILED_MAX_LEVELS];
+  /* Loaded tiles, NULL for tiles which are not in memory. */
+  ImageTiledTile **tiles;
+
+  int users;
+};
+
+static struct {
+  ListBase textures;
+  /* Tiles in memory, most recently used first. */
+  ListBase tiles;
+  size_t mem_in_use, mem_limit;
+} tiled_cache = {{NULL, NULL}, {NULL, NULL}, 0, TILED_DEFAULT_LIMIT};
+
+/* Protects the texture list, tile lists and reading from cache files. */
+static ThreadMutex tiled_cache_mutex = BLI_MUTEX_INITIALIZER;
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Files
+ * \{ */
+
+static void tiled_levels_init(ImageTiledTexture *texture, int width, int height, int tot_levels)
+{
+  texture->tot_levels = tot_levels;
+  texture->tot_tiles = 0;
+
+  for (int level = 0; level < tot_levels; level++) {
+    ImageTiledLevel *tlevel = &texture->levels[level];
+
+    tlevel->width = width;
+    tlevel->height = height;
+    tlevel->xtiles = (width + TILED_TILE_SIZE - 1) / TILED_TILE_SIZE;
+    tlevel->ytiles = (height + TILED_TILE_SIZE - 1) / TILED_TILE_SIZE;
+    tlevel->first_tile = texture->tot_tiles;
+    texture->tot_tiles += tlevel->xtiles * tlevel->ytiles;
+
+    /* Same sizes as IMB_onehalf. */
+    width = max_ii(width / 2, 1);
+    height = max_ii(height / 2, 1);
+  }
+}
+
+static int tiled_tot_levels(int width, int height)
+{
+  int tot_levels = 1;
+
+  while ((width > 1 || height > 1) && tot_levels < TILED_MAX_LEVELS) {
+    width = max_ii(width / 2, 1);
+    height = max_ii(height / 2, 1);
+    tot_levels++;
+  }
+
+  return tot_levels;
+}
+
+static bool tiled_source_stat(const char *filepath, int64_t *r_mtime, int64_t *r_size)
+{
+  BLI_stat_t st;
+
+  if (BLI_stat(filepath, &st) != 0) {
+    return false;
+  }
+
+  *r_mtime = (int64_t)st.st_mtime;
+  *r_size = (int64_t)st.st_size;
+  return true;
+}
+
+static void tiled_cache_filepath(const char *filepath,
+                                 const char *colorspace,
+                                 char r_cachepath[FILE_MAX])
+{
+  char filename[64];
+  const unsigned int hash = BLI_ghashutil_strhash_p(filepath) ^
+                            (BLI_ghashutil_strhash_p(colorspace) * 31u);
+
+  BLI_snprintf(filename, sizeof(filename), "blender_tiled_%08x.btex", hash);
+  BLI_join_dirfile(r_cachepath, FILE_MAX, BKE_tempdir_base(), filename);
+}
+
+/* A level of a cache file being written. */
+typedef struct TiledWriterLevel {
+  /* One row of tiles, tile after tile like in the file, filled from its top row down. */
+  void *tile_row;
+  /* Rows to halve for the next level, the odd row waits for the even row below it. NULL for
+   * the last level. */
+  ImBuf *pair;
+} TiledWriterLevel;
+
+/* Builds a cache file from the bands of the image file, so only a few rows of each level are
+ * in memory at once. */
+typedef struct TiledWriter {
+  FILE *file;
+  TiledFileHeader header;
+  ImageTiledTexture texture;
+  TiledWriterLevel levels[TILED_MAX_LEVELS];
+  size_t pixel_size, tile_size_in_bytes;
+  bool is_init;
+  /* Next row of the full resolution image, rows come from the top down. */
+  int next_y;
+} TiledWriter;
+
+BLI_INLINE void *tiled_imbuf_row(ImBuf *ibuf, bool is_float, int y)
+{
+  const size_t offset = (size_t)y * ibuf->x * 4;
+
+  return is_float ? (void *)(ibuf->rect_float + offset) : (void *)((uchar *)ibuf->rect + offset);
+}
+
+static void tiled_writer_init(TiledWriter *writer, const ImBuf *band, int height)
+{
+  TiledFileHeader *header = &writer->header;
+
+  header->width = band->x;
+  header->height = height;
+  header->tot_levels = tiled_tot_levels(header->width, header->height);
+  /* Only the float buffer is stored if there are both. */
+  header->is_float = band->rect_float != NULL;
+  tiled_levels_init(&writer->texture, header->width, header->height, header->tot_levels);
+
+  writer->pixel_size = header->is_float ? sizeof(float[4]) : sizeof(uchar[4]);
+  writer->tile_size_in_bytes = (size_t)TILED_TILE_SIZE * TILED_TILE_SIZE * writer->pixel_size;
+
+  for (int level = 0; level < header->tot_levels; level++) {
+    const ImageTiledLevel *tlevel = &writer->texture.levels[level];
+    TiledWriterLevel *wlevel = &writer->levels[level];
+
+    wlevel->tile_row = MEM_callocN(writer->tile_size_in_bytes * tlevel->xtiles, __func__);
+    if (level + 1 < header->tot_levels) {
+      wlevel->pair = IMB_allocImBuf(tlevel->width,
+                                    min_ii(tlevel->height, 2),
+                                    band->planes,
+                                    header->is_float ? IB_rectfloat : IB_rect);
+    }
+  }
+
+  writer->next_y = height - 1;
+  writer->is_init = true;
+}
+
+static void tiled_writer_free(TiledWriter *writer)
+{
+  for (int level = 0; level < TILED_MAX_LEVELS; level++) {
+    TiledWriterLevel *wlevel = &writer->levels[level];
+
+    if (wlevel->tile_row) {
+      MEM_freeN(wlevel->tile_row);
+    }
+    if (wlevel->pair) {
+      IMB_freeImBuf(wlevel->pair);
+    }
+  }
+}
+
+/* Add row y of a level. Rows of tiles are written once their bottom row is added, tiles at the
+ * right and top border are padded with zeros. */
+static bool tiled_writer_add_row(TiledWriter *writer, int level, int y, const void *row)
+{
+  const ImageTiledLevel *tlevel = &writer->texture.levels[level];
+  TiledWriterLevel *wlevel = &writer->levels[level];
+  const bool is_float = writer->header.is_float;
+  const size_t pixel_size = writer->pixel_size;
+  const int tile_y = y % TILED_TILE_SIZE;
+
+  for (int tx = 0; tx < tlevel->xtiles; tx++) {
+    const int xmin = tx * TILED_TILE_SIZE;
+    const int width = min_ii(TILED_TILE_SIZE, tlevel->width - xmin);
+    char *dst = (char *)wlevel->tile_row + tx * writer->tile_size_in_bytes +
+                tile_y * TILED_TILE_SIZE * pixel_size;
+
+    memcpy(dst, (const char *)row + xmin * pixel_size, width * pixel_size);
+  }
+
+  if (tile_y == 0) {
+    const size_t tile_row_size = writer->tile_size_in_bytes * tlevel->xtiles;
+    const int first_tile = tlevel->first_tile + (y / TILED_TILE_SIZE) * tlevel->xtiles;
+    const int64_t offset = sizeof(TiledFileHeader) + first_tile * writer->tile_size_in_bytes;
+
+    if (BLI_fseek(writer->file, offset, SEEK_SET) != 0 ||
+        fwrite(wlevel->tile_row, tile_row_size, 1, writer->file) != 1) {
+      return false;
+    }
+    memset(wlevel->tile_row, 0, tile_row_size);
+  }
+
+  ImBuf *pair = wlevel->pair;
+  if (pair == NULL) {
+    return true;
+  }
+
+  /* Halve rows 2k and 2k + 1 into row k of the next level, like IMB_onehalf does. */
+  const size_t row_size = pixel_size * tlevel->width;
+  if (pair->y == 2 && (y % 2) == 1) {
+    memcpy(tiled_imbuf_row(pair, is_float, 1), row, row_size);
+    return true;
+  }
+  if (pair->y == 2 && y + 1 == tlevel->height) {
+    /* The top row of an odd height is left out. */
+    return true;
+  }
+  memcpy(tiled_imbuf_row(pair, is_float, 0), row, row_size);
+
+  ImBuf *ibuf_half = IMB_onehalf(pair);
+  if (ibuf_half == NULL) {
+    return false;
+  }
+  const bool ok = tiled_writer_add_row(
+      writer, level + 1, y / 2, tiled_imbuf_row(ibuf_half, is_float, 0));
+  IMB_freeImBuf(ibuf_half);
+
+  return ok;
+}
+
+static bool tiled_writer_band(void *userdata, ImBuf *band, int ymin, int height)
+{
+  TiledWriter *writer = userdata;
+
+  if (!writer->is_init) {
+    tiled_writer_init(writer, band, height);
+  }
+
+  const bool is_float = writer->header.is_float;
+
+  /* Bands must be contiguous and all alike. */
+  if (band->x != writer->header.width || height != writer->header.height ||
+      ymin + band->y - 1 != writer->next_y ||
+      (is_float ? band->rect_float == NULL : band->rect == NULL)) {
+    return false;
+  }
+
+  for (int y = ymin + band->y - 1; y >= ymin; y--) {
+    if (!tiled_writer_add_row(writer, 0, y, tiled_imbuf_row(band, is_float, y - ymin))) {
+      return false;
+    }
+  }
+  writer->next_y = ymin - 1;
+
+  return true;
+}
+
+/* Convert the image file to a cache file with all mip levels. The image is read in bands,
+ * the full resolution image is never in memory. */
+static bool tiled_cache_file_write(const char *filepath,
+                                   const char *colorspace,
+                                   const char *cachepath)
+{
+  char colorspace_load[IM_MAX_SPACE];
+  STRNCPY(colorspace_load, colorspace);
+
+  TiledWriter writer = {NULL};
+  TiledFileHeader *header = &writer.header;
+
+  memcpy(header->magic, TILED_FILE_MAGIC, sizeof(header->magic));
+  header->version = TILED_FILE_VERSION;
+  STRNCPY(header->filepath, filepath);
+  STRNCPY(header->colorspace, colorspace);
+  if (!tiled_source_stat(filepath, &header->source_mtime, &header->source_size)) {
+    return false;
+  }
+
+  /* Write to a temporary file first, other instances may read the cache file meanwhile. */
+  static uint32_t tmp_counter = 0;
+  char cachepath_tmp[FILE_MAX];
+  BLI_snprintf(cachepath_tmp,
+               sizeof(cachepath_tmp),
+               "%s.%u.tmp",
+               cachepath,
+               atomic_add_and_fetch_uint32(&tmp_counter, 1));
+
+  writer.file = BLI_fopen(cachepath_tmp, "wb");
+  bool ok = (writer.file != NULL);
+
+  if (ok) {
+    ok = IMB_loadiffname_bands(
+             filepath, IB_rect, colorspace_load, tiled_writer_band, &writer) &&
+         writer.is_init && writer.next_y == -1;
+
+    /* The header goes last, the tiles are only complete once all bands are read. */
+    if (ok) {
+      ok = BLI_fseek(writer.file, 0, SEEK_SET) == 0 &&
+           fwrite(header, sizeof(*header), 1, writer.file) == 1;
+    }
+
+    ok = (fclose(writer.file) == 0) && ok;
+  }
+
+  tiled_writer_free(&writer);
+
+  if (ok) {
+    if (BLI_exists(cachepath)) {
+      BLI_delete(cachepath, false, false);
+    }
+    ok = BLI_rename(cachepath_tmp, cachepath) == 0;
+  }
+  if (!ok && BLI_exists(cachepath_tmp)) {
+    BLI_delete(cachepath_tmp, false, false);
+  }
+
+  return ok;
+}
+
+/* Open the cache file of the image file, NULL if it is missing, outdated or of another file. */
+static ImageTiledTexture *tiled_texture_open(const char *filepath,
+                                             const char *colorspace,
+                                             const char *cachepath)
+{
+  int64_t source_mtime, source_size;
+
+  if (!BLI_exists(cachepath) || !tiled_source_stat(filepath, &source_mtime, &source_size)) {
+    return NULL;
+  }
+
+  FILE *file = BLI_fopen(cachepath, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+
+  TiledFileHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, TILED_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != TILED_FILE_VERSION || header.source_mtime != source_mtime ||
+      header.source_size != source_size || !STREQLEN(header.filepath, filepath, FILE_MAX) ||
+      !STREQLEN(header.colorspace, colorspace, IMA_MAX_SPACE) || header.width <= 0 ||
+      header.height <= 0 || header.tot_levels != tiled_tot_levels(header.width, header.height)) {
+    fclose(file);
+    return NULL;
+  }
+
+  ImageTiledTexture *texture = MEM_callocN(sizeof(ImageTiledTexture), __func__);
+  STRNCPY(texture->filepath, filepath);
+  STRNCPY(texture->colorspace, colorspace);
+  texture->source_mtime = header.source_mtime;
+  texture->source_size = header.source_size;
+  texture->file = file;
+  texture->is_float = header.is_float;
+  texture->tile_size_in_bytes = (size_t)TILED_TILE_SIZE * TILED_TILE_SIZE *
+                                (texture->is_float ? sizeof(float[4]) : sizeof(uchar[4]));
+  tiled_levels_init(texture, header.width, header.height, header.tot_levels);
+  texture->tiles = MEM_callocN(sizeof(ImageTiledTile *) * texture->tot_tiles, __func__);
+
+  return texture;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tiles
+ * \{ */
+
+static void tiled_tile_free(ImageTiledTile *tile)
+{
+  tile->texture->tiles[tile->index] = NULL;
+  tiled_cache.mem_in_use -= tile->texture->tile_size_in_bytes;
+  BLI_remlink(&tiled_cache.tiles, tile);
+  MEM_freeN(tile->pixels);
+  MEM_freeN(tile);
+}
+
+/* Free least recently used tiles until the cache is within its budget. */
+static void tiled_cache_limit(void)
+{
+  ImageTiledTile *tile, *tile_prev;
+
+  for (tile = tiled_cache.tiles.last; tile && tiled_cache.mem_in_use > tiled_cache.mem_limit;
+       tile = tile_prev) {
+    tile_prev = tile->prev;
+    if (tile->users == 0) {
+      tiled_tile_free(tile);
+    }
+  }
+}
+
+static ImageTiledTile *tiled_tile_acquire(ImageTiledTexture *texture, int index)
+{
+  BLI_mutex_lock(&tiled_cache_mutex);
+
+  ImageTiledTile *tile = texture->tiles[index];
+
+  if (tile) {
+    BLI_remlink(&tiled_cache.tiles, tile);
+    BLI_addhead(&tiled_cache.tiles, tile);
+  }
+  else {
+    tile = MEM_callocN(sizeof(ImageTiledTile), __func__);
+    tile->texture = texture;
+    tile->index = index;
+    tile->pixels = MEM_mallocN(texture->tile_size_in_bytes, __func__);
+
+    const int64_t offset = sizeof(TiledFileHeader) + index * texture->tile_size_in_bytes;
+    if (BLI_fseek(texture->file, offset, SEEK_SET) != 0 ||
+        fread(tile->pixels, texture->tile_size_in_bytes, 1, texture->file) != 1) {
+      memset(tile->pixels, 0, texture->tile_size_in_bytes);
+    }
+
+    texture->tiles[index] = tile;
+    tiled_cache.mem_in_use += texture->tile_size_in_bytes;
+    BLI_addhead(&tiled_cache.tiles, tile);
+  }
+
+  tile->users++;
+  tiled_cache_limit();
+
+  BLI_mutex_unlock(&tiled_cache_mutex);
+
+  return tile;
+}
+
+static void tiled_texture_free(ImageTiledTexture *texture)
+{
+  for (int index = 0; index < texture->tot_tiles; index++) {
+    if (texture->tiles[index]) {
+      tiled_tile_free(texture->tiles[index]);
+    }
+  }
+
+  fclose(texture->file);
+  MEM_freeN(texture->tiles);
+  MEM_freeN(texture);
+}
+
+static void tiled_tile_release(ImageTiledTile *tile)
+{
+  /* Tiles only get new users with the lock held, so the lock is not needed here. */
+  atomic_sub_and_fetch_int32(&tile->users, 1);
+}
+
+BLI_INLINE void tiled_tile_pixel(const ImageTiledTexture *texture,
+                                 const ImageTiledTile *tile,
+                                 int x,
+                                 int y,
+                                 float r_color[4])
+{
+  const size_t offset = ((size_t)y * TILED_TILE_SIZE + x) * 4;
+
+  if (texture->is_float) {
+    copy_v4_v4(r_color, (float *)tile->pixels + offset);
+  }
+  else {
+    const uchar *pixel = (uchar *)tile->pixels + offset;
+    r_color[0] = pixel[0] * (1.0f / 255.0f);
+    r_color[1] = pixel[1] * (1.0f / 255.0f);
+    r_color[2] = pixel[2] * (1.0f / 255.0f);
+    r_color[3] = pixel[3] * (1.0f / 255.0f);
+  }
+}
+
+BLI_INLINE int tiled_tile_index(const ImageTiledLevel *tlevel, int x, int y)
+{
+  return tlevel->first_tile + (y / TILED_TILE_SIZE) * tlevel->xtiles + (x / TILED_TILE_SIZE);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+ImageTiledTexture *BKE_image_tiled_acquire_file(const char *filepath, const char *colorspace)
+{
+  ImageTiledTexture *texture = NULL;
+  int64_t source_mtime = 0, source_size = 0;
+
+  tiled_source_stat(filepath, &source_mtime, &source_size);
+
+  BLI_mutex_lock(&tiled_cache_mutex);
+  LISTBASE_FOREACH (ImageTiledTexture *, texture_iter, &tiled_cache.textures) {
+    if (STREQ(texture_iter->filepath, filepath) && STREQ(texture_iter->colorspace, colorspace)) {
+      if ((texture_iter->source_mtime != source_mtime ||
+           texture_iter->source_size != source_size) &&
+          texture_iter->users == 0) {
+        /* The file changed since, convert it again. Users keep the outdated tiles. */
+        BLI_remlink(&tiled_cache.textures, texture_iter);
+        tiled_texture_free(texture_iter);
+        break;
+      }
+      texture = texture_iter;
+      texture->users++;
+      break;
+    }
+  }
+  BLI_mutex_unlock(&tiled_cache_mutex);
+
+  if (texture) {
+    return texture;
+  }
+
+  /* Converting can take a while, don't block access to other textures meanwhile. */
+  char cachepath[FILE_MAX];
+  tiled_cache_filepath(filepath, colorspace, cachepath);
+
+  texture = tiled_texture_open(filepath, colorspace, cachepath);
+  if (texture == NULL) {
+    if (!tiled_cache_file_write(filepath, colorspace, cachepath)) {
+      return NULL;
+    }
+    texture = tiled_texture_open(filepath, colorspace, cachepath);
+    if (texture == NULL) {
+      return NULL;
+    }
+  }
+
+  BLI_mutex_lock(&tiled_cache_mutex);
+  ImageTiledTexture *texture_new = texture;
+  LISTBASE_FOREACH (ImageTiledTexture *, texture_iter, &tiled_cache.textures) {
+    if (STREQ(texture_iter->filepath, filepath) && STREQ(texture_iter->colorspace, colorspace)) {
+      texture = texture_iter;
+      break;
+    }
+  }
+  if (texture == texture_new) {
+    BLI_addtail(&tiled_cache.textures, texture);
+  }
+  else {
+    /* Opened by another thread meanwhile. */
+    tiled_texture_free(texture_new);
+  }
+  texture->users++;
+  BLI_mutex_unlock(&tiled_cache_mutex);
+
+  return texture;
+}
+
+ImageTiledTexture *BKE_image_tiled_acquire(Image *ima, ImageUser *iuser)
+{
+  char filepath[FILE_MAX];
+
+  /* Painted images differ from their file. */
+  if (!ELEM(ima->source, IMA_SRC_FILE, IMA_SRC_TILED) || BKE_image_has_packedfile(ima) ||
+      BKE_image_is_dirty(ima)) {
+    return NULL;
+  }
+
+  BKE_image_user_file_path(iuser, ima, filepath);
+
+  return BKE_image_tiled_acquire_file(filepath, ima->colorspace_settings.name);
+}
+
+void BKE_image_tiled_release(ImageTiledTexture *texture)
+{
+  BLI_mutex_lock(&tiled_cache_mutex);
+  texture->users--;
+  BLI_mutex_unlock(&tiled_cache_mutex);
+}
+
+int BKE_image_tiled_levels(const ImageTiledTexture *texture)
+{
+  return texture->tot_levels;
+}
+
+/* Float textures are scene linear, byte ones are in the image colorspace. */
+bool BKE_image_tiled_is_float(const ImageTiledTexture *texture)
+{
+  return texture->is_float;
+}
+
+void BKE_image_tiled_size(const ImageTiledTexture *texture,
+                          int level,
+                          int *r_width,
+                          int *r_height)
+{
+  const ImageTiledLevel *tlevel = &texture->levels[clamp_i(level, 0, texture->tot_levels - 1)];
+
+  *r_width = tlevel->width;
+  *r_height = tlevel->height;
+}
+
+void BKE_image_tiled_read_rect(ImageTiledTexture *texture,
+                               int level,
+                               int xmin,
+                               int ymin,
+                               int width,
+                               int height,
+                               float *r_rect)
+{
+  const ImageTiledLevel *tlevel = &texture->levels[clamp_i(level, 0, texture->tot_levels - 1)];
+
+  memset(r_rect, 0, sizeof(float[4]) * width * height);
+
+  const int x_begin = max_ii(xmin, 0), x_end = min_ii(xmin + width, tlevel->width);
+  const int y_begin = max_ii(ymin, 0), y_end = min_ii(ymin + height, tlevel->height);
+
+  /* Visit every tile overlapping the rectangle once. */
+  for (int ty = y_begin; ty < y_end; ty = (ty / TILED_TILE_SIZE + 1) * TILED_TILE_SIZE) {
+    for (int tx = x_begin; tx < x_end; tx = (tx / TILED_TILE_SIZE + 1) * TILED_TILE_SIZE) {
+      ImageTiledTile *tile = tiled_tile_acquire(texture, tiled_tile_index(tlevel, tx, ty));
+      const int tile_x_end = min_ii((tx / TILED_TILE_SIZE + 1) * TILED_TILE_SIZE, x_end);
+      const int tile_y_end = min_ii((ty / TILED_TILE_SIZE + 1) * TILED_TILE_SIZE, y_end);
+
+      for (int y = ty; y < tile_y_end; y++) {
+        float *dst = r_rect + ((size_t)(y - ymin) * width + (tx - xmin)) * 4;
+        for (int x = tx; x < tile_x_end; x++, dst += 4) {
+          tiled_tile_pixel(texture, tile, x % TILED_TILE_SIZE, y % TILED_TILE_SIZE, dst);
+        }
+      }
+
+      tiled_tile_release(tile);
+    }
+  }
+}
+
+/* Bilinear sample of a level with repeat extension, u and v are in pixels. */
+static void tiled_sample_level(ImageTiledTexture *texture, int level, float u, float v, float r[4])
+{
+  const ImageTiledLevel *tlevel = &texture->levels[level];
+  const int x0_unwrapped = (int)floorf(u - 0.5f), y0_unwrapped = (int)floorf(v - 0.5f);
+  const float fx = u - 0.5f - x0_unwrapped, fy = v - 0.5f - y0_unwrapped;
+  const int x0 = mod_i(x0_unwrapped, tlevel->width), y0 = mod_i(y0_unwrapped, tlevel->height);
+  const int x1 = (x0 + 1) % tlevel->width, y1 = (y0 + 1) % tlevel->height;
+  const int xs[4] = {x0, x1, x0, x1}, ys[4] = {y0, y0, y1, y1};
+  const float weights[4] = {
+      (1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy, fx * fy};
+  ImageTiledTile *tile = NULL;
+
+  zero_v4(r);
+  for (int i = 0; i < 4; i++) {
+    const int index = tiled_tile_index(tlevel, xs[i], ys[i]);
+    float color[4];
+
+    /* All pixels are in the same tile most of the time. */
+    if (tile == NULL || tile->index != index) {
+      if (tile) {
+        tiled_tile_release(tile);
+      }
+      tile = tiled_tile_acquire(texture, index);
+    }
+
+    tiled_tile_pixel(texture, tile, xs[i] % TILED_TILE_SIZE, ys[i] % TILED_TILE_SIZE, color);
+    madd_v4_v4fl(r, color, weights[i]);
+  }
+  tiled_tile_release(tile);
+}
+
+void BKE_image_tiled_sample(
+    ImageTiledTexture *texture, float u, float v, float lod, float r_color[4])
+{
+  lod = clamp_f(lod, 0.0f, (float)(texture->tot_levels - 1));
+
+  const int level = (int)lod;
+  const float level_factor = lod - (float)level;
+  const ImageTiledLevel *tlevel = &texture->levels[level];
+
+  tiled_sample_level(texture, level, u * tlevel->width, v * tlevel->height, r_color);
+
+  if (level_factor > 0.0f && level + 1 < texture->tot_levels) {
+    const ImageTiledLevel *tlevel_next = &texture->levels[level + 1];
+    float color_next[4];
+
+    tiled_sample_level(
+        texture, level + 1, u * tlevel_next->width, v * tlevel_next->height, color_next);
+    interp_v4_v4v4(r_color, r_color, color_next, level_factor);
+  }
+}
+
+void BKE_image_tiled_cache_limit_set(size_t limit)
+{
+  BLI_mutex_lock(&tiled_cache_mutex);
+  tiled_cache.mem_limit = limit;
+  tiled_cache_limit();
+  BLI_mutex_unlock(&tiled_cache_mutex);
+}
+
+size_t BKE_image_tiled_cache_memory_in_use(void)
+{
+  return tiled_cache.mem_in_use;
+}
+
+void BKE_image_tiled_cache_free(void)
+{
+  BLI_mutex_lock(&tiled_cache_mutex);
+
+  LISTBASE_FOREACH_MUTABLE (ImageTiledTile *, tile, &tiled_cache.tiles) {
+    tiled_tile_free(tile);
+  }
+
+  LISTBASE_FOREACH_MUTABLE (ImageTiledTexture *, texture, &tiled_cache.textures) {
+    BLI_assert(texture->users == 0);
+    tiled_texture_free(texture);
+  }
+  BLI_listbase_clear(&tiled_cache.textures);
+
+  BLI_mutex_unlock(&tiled_cache_mutex);
+}
+
+/** \} */
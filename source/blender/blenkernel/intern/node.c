@@ -3696,6 +3696,38 @@ void nodeUpdate(bNodeTree *ntree, bNode *node)
   ntree->is_updating = false;
 }
 
+/* Update generations of IDs by their session UUID, so they are shared with copy-on-write copies.
+ * Generations are taken from one counter, a generation is never used twice. */
+static GHash *node_id_update_generations = NULL;
+static unsigned int node_id_update_generation_last = 0;
+static ThreadMutex node_id_update_generations_mutex = BLI_MUTEX_INITIALIZER;
+
+unsigned int BKE_node_id_update_generation(const ID *id)
+{
+  unsigned int generation = 0;
+  BLI_mutex_lock(&node_id_update_generations_mutex);
+  if (node_id_update_generations) {
+    generation = POINTER_AS_UINT(
+        BLI_ghash_lookup(node_id_update_generations, POINTER_FROM_UINT(id->session_uuid)));
+  }
+  BLI_mutex_unlock(&node_id_update_generations_mutex);
+  return generation;
+}
+
+void BKE_node_id_update_generation_bump(const ID *id)
+{
+  BLI_mutex_lock(&node_id_update_generations_mutex);
+  if (node_id_update_generations == NULL) {
+    node_id_update_generations = BLI_ghash_int_new(__func__);
+  }
+  BLI_ghash_reinsert(node_id_update_generations,
+                     POINTER_FROM_UINT(id->session_uuid),
+                     POINTER_FROM_UINT(++node_id_update_generation_last),
+                     NULL,
+                     NULL);
+  BLI_mutex_unlock(&node_id_update_generations_mutex);
+}
+
 bool nodeUpdateID(bNodeTree *ntree, ID *id)
 {
   bNode *node;
@@ -3727,6 +3759,10 @@ bool nodeUpdateID(bNodeTree *ntree, ID *id)
     nodeUpdateInternalLinks(ntree, node);
   }
 
+  if (changed) {
+    BKE_node_id_update_generation_bump(id);
+  }
+
   ntree->is_updating = false;
   return changed;
 }
@@ -4386,6 +4422,11 @@ void free_nodesystem(void)
     BLI_ghash_free(nodetreetypes_hash, NULL, ntree_free_type);
     nodetreetypes_hash = NULL;
   }
+
+  if (node_id_update_generations) {
+    BLI_ghash_free(node_id_update_generations, NULL, NULL);
+    node_id_update_generations = NULL;
+  }
 }
 
 /* -------------------------------------------------------------------- */
@@ -24,6 +24,22 @@
 #include <stddef.h>
 #include <time.h>
 
+#ifndef WIN32
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -81,7 +97,8 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data is stored uncompressed, compressed with LZO (fast) or with zlib, depending on the
+ * compression level in user preferences. Compression is stored per image.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
@@ -89,16 +106,28 @@
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
  *
+ * Files are indexed by path and file headers are kept in memory once read, so lookups of
+ * frames that are not cached don't touch the disk. Image data is read from the memory mapped
+ * file and decompressed straight into the image buffer.
+ *
  */
 
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* DiskCacheHeaderEntry.compression */
+enum {
+  DCACHE_COMPRESSION_NONE = 0,
+  DCACHE_COMPRESSION_ZLIB = 1,
+  DCACHE_COMPRESSION_LZO = 2,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char compression;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -114,6 +143,7 @@ typedef struct SeqDiskCache {
   Main *bmain;
   int64_t timestamp;
   ListBase files;
+  struct GHash *files_hash; /* DiskCacheFile by path. */
   ThreadMutex read_write_mutex;
   size_t size_total;
 } SeqDiskCache;
@@ -130,6 +160,7 @@ typedef struct DiskCacheFile {
   int render_size;
   int view_id;
   int start_frame;
+  DiskCacheHeader *header; /* Copy of the header of the file, NULL until it is read. */
 } DiskCacheFile;
 
 typedef struct SeqCache {
@@ -138,7 +169,8 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last key stored by each task, frames rendered at the same time are linked separately. */
+  struct SeqCacheKey *last_key[SEQ_TASK_MAX];
   size_t memory_used;
   SeqDiskCache *disk_cache;
 } SeqCache;
@@ -172,18 +204,28 @@ static char *seq_disk_cache_base_dir(void)
   return U.sequencer_disk_cache_dir;
 }
 
-static int seq_disk_cache_compression_level(void)
+/* Returns one of DCACHE_COMPRESSION_*, r_level is the zlib compression level. */
+static int seq_disk_cache_compression(int *r_level)
 {
+  *r_level = 0;
+
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
-      return 0;
+      return DCACHE_COMPRESSION_NONE;
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
-      return 1;
+#ifdef WITH_LZO
+      return DCACHE_COMPRESSION_LZO;
+#else
+      *r_level = 1;
+      return DCACHE_COMPRESSION_ZLIB;
+#endif
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
-      return 9;
+      *r_level = 9;
+      return DCACHE_COMPRESSION_ZLIB;
   }
 
-  return U.sequencer_disk_cache_compression;
+  *r_level = U.sequencer_disk_cache_compression;
+  return DCACHE_COMPRESSION_ZLIB;
 }
 
 static size_t seq_disk_cache_size_limit(void)
@@ -217,16 +259,37 @@ static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache,
          &cache_file->start_frame);
   cache_file->start_frame *= DCACHE_IMAGES_PER_FILE;
   BLI_addtail(&disk_cache->files, cache_file);
+  BLI_ghash_insert(disk_cache->files_hash, cache_file->path, cache_file);
   return cache_file;
 }
 
+static void seq_disk_cache_free_file(DiskCacheFile *cache_file)
+{
+  MEM_SAFE_FREE(cache_file->header);
+  MEM_freeN(cache_file);
+}
+
+static void seq_disk_cache_free_files(SeqDiskCache *disk_cache)
+{
+  BLI_ghash_clear(disk_cache->files_hash, NULL, NULL);
+  LISTBASE_FOREACH_MUTABLE (DiskCacheFile *, cache_file, &disk_cache->files) {
+    seq_disk_cache_free_file(cache_file);
+  }
+  BLI_listbase_clear(&disk_cache->files);
+}
+
 static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
 {
   struct direntry *filelist, *fl;
   uint nbr, i;
+  char dir[FILE_MAX];
   disk_cache->size_total = 0;
 
-  i = nbr = BLI_filelist_dir_contents(path, &filelist);
+  /* Paths of entries are concatenated to the directory path. */
+  BLI_strncpy(dir, path, sizeof(dir));
+  BLI_path_slash_ensure(dir);
+
+  i = nbr = BLI_filelist_dir_contents(dir, &filelist);
   fl = filelist;
   while (i--) {
     /* Don't follow links. */
@@ -279,8 +342,9 @@ static void seq_disk_cache_delete_file(SeqDiskCache *disk_cache, DiskCacheFile *
 {
   disk_cache->size_total -= file->fstat.st_size;
   BLI_delete(file->path, false, false);
+  BLI_ghash_remove(disk_cache->files_hash, file->path, NULL, NULL);
   BLI_remlink(&disk_cache->files, file);
-  MEM_freeN(file);
+  seq_disk_cache_free_file(file);
 }
 
 static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
@@ -297,7 +361,7 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 
     if (BLI_exists(oldest_file->path) == 0) {
       /* File may have been manually deleted during runtime, do re-scan. */
-      BLI_freelistN(&disk_cache->files);
+      seq_disk_cache_free_files(disk_cache);
       seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
       continue;
     }
@@ -311,15 +375,7 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 
 static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
 {
-  DiskCacheFile *cache_file = disk_cache->files.first;
-
-  for (; cache_file; cache_file = cache_file->next) {
-    if (BLI_strcasecmp(cache_file->path, path) == 0) {
-      return cache_file;
-    }
-  }
-
-  return NULL;
+  return BLI_ghash_lookup(disk_cache->files_hash, path);
 }
 
 /* Update file size and timestamp. */
@@ -474,31 +530,179 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
 {
   if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+    return ibuf->rect;
   }
-  else {
+  return ibuf->rect_float;
+}
+
+#ifdef WITH_LZO
+static size_t seq_disk_cache_write_lzo(void *data,
+                                       FILE *file,
+                                       DiskCacheHeaderEntry *header_entry)
+{
+  lzo_uint size_raw = (lzo_uint)header_entry->size_raw;
+  lzo_uint size_compressed = LZO_OUT_LEN(size_raw);
+  unsigned char *buffer = MEM_mallocN(size_compressed, "seq disk cache lzo buffer");
+  void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, "seq disk cache lzo wrkmem");
+  size_t bytes_written = 0;
+
+  int r = lzo1x_1_compress(data, size_raw, buffer, &size_compressed, wrkmem);
+
+  /* Store incompressible images uncompressed. */
+  if (r == LZO_E_OK && size_compressed < size_raw) {
+    if (BLI_fseek(file, header_entry->offset, SEEK_SET) == 0 &&
+        fwrite(buffer, 1, size_compressed, file) == size_compressed) {
+      bytes_written = size_compressed;
+    }
+  }
+
+  MEM_freeN(wrkmem);
+  MEM_freeN(buffer);
+  return bytes_written;
+}
+#endif
+
+/* Write image data to file at offset of header_entry, compression is set to the used method.
+ * Returns size of data written to the file, 0 on failure.
+ */
+static size_t seq_disk_cache_write_imbuf(ImBuf *ibuf,
+                                         FILE *file,
+                                         DiskCacheHeaderEntry *header_entry)
+{
+  void *data = seq_disk_cache_imbuf_data(ibuf);
+  int level;
+
+  header_entry->compression = seq_disk_cache_compression(&level);
+
+#ifdef WITH_LZO
+  if (header_entry->compression == DCACHE_COMPRESSION_LZO) {
+    size_t bytes_written = seq_disk_cache_write_lzo(data, file, header_entry);
+    if (bytes_written != 0) {
+      return bytes_written;
+    }
+    header_entry->compression = DCACHE_COMPRESSION_NONE;
+  }
+#endif
+
+  if (header_entry->compression == DCACHE_COMPRESSION_ZLIB) {
     return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+        data, header_entry->size_raw, file, header_entry->offset, level);
   }
+
+  header_entry->compression = DCACHE_COMPRESSION_NONE;
+  if (BLI_fseek(file, header_entry->offset, SEEK_SET) != 0 ||
+      fwrite(data, 1, header_entry->size_raw, file) != header_entry->size_raw) {
+    return 0;
+  }
+  return header_entry->size_raw;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+/* Map stored image data into memory. Returns pointer to the data, which must be released with
+ * seq_disk_cache_data_release(), NULL on failure.
+ */
+static const void *seq_disk_cache_data_acquire(FILE *file,
+                                               DiskCacheHeaderEntry *header_entry,
+                                               void **r_handle,
+                                               size_t *r_handle_size)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  const uint64_t data_end = header_entry->offset + header_entry->size_compressed;
+  BLI_stat_t st;
+
+  *r_handle = NULL;
+  *r_handle_size = 0;
+
+  /* Data may be missing if file was overwritten by another Blender instance. */
+  if (BLI_fstat(fileno(file), &st) == -1 || (uint64_t)st.st_size < data_end) {
+    return NULL;
   }
-  else {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+
+#ifndef WIN32
+  /* Offset of mapping must be aligned to page size. */
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  const uint64_t map_offset = header_entry->offset - header_entry->offset % page_size;
+  const size_t map_size = (size_t)(data_end - map_offset);
+  void *map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fileno(file), (off_t)map_offset);
+
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  *r_handle = map;
+  *r_handle_size = map_size;
+  return (const char *)map + (header_entry->offset - map_offset);
+#else
+  void *buffer = MEM_mallocN(header_entry->size_compressed, "seq disk cache read buffer");
+
+  if (BLI_fseek(file, header_entry->offset, SEEK_SET) != 0 ||
+      fread(buffer, 1, header_entry->size_compressed, file) != header_entry->size_compressed) {
+    MEM_freeN(buffer);
+    return NULL;
   }
+
+  *r_handle = buffer;
+  *r_handle_size = header_entry->size_compressed;
+  return buffer;
+#endif
+}
+
+static void seq_disk_cache_data_release(void *handle, size_t handle_size)
+{
+#ifndef WIN32
+  munmap(handle, handle_size);
+#else
+  UNUSED_VARS(handle_size);
+  MEM_freeN(handle);
+#endif
+}
+
+/* Decompress image data straight into buffer of ibuf. Returns size of decompressed data. */
+static size_t seq_disk_cache_read_imbuf(ImBuf *ibuf,
+                                        FILE *file,
+                                        DiskCacheHeaderEntry *header_entry)
+{
+  void *handle;
+  size_t handle_size;
+  const void *data = seq_disk_cache_data_acquire(file, header_entry, &handle, &handle_size);
+
+  if (data == NULL) {
+    return 0;
+  }
+
+  void *buffer = seq_disk_cache_imbuf_data(ibuf);
+  size_t bytes_read = 0;
+
+  switch (header_entry->compression) {
+    case DCACHE_COMPRESSION_NONE:
+      if (header_entry->size_compressed == header_entry->size_raw) {
+        memcpy(buffer, data, header_entry->size_raw);
+        bytes_read = header_entry->size_raw;
+      }
+      break;
+    case DCACHE_COMPRESSION_ZLIB: {
+      uLongf size_raw = (uLongf)header_entry->size_raw;
+      if (uncompress(buffer, &size_raw, data, (uLong)header_entry->size_compressed) == Z_OK) {
+        bytes_read = size_raw;
+      }
+      break;
+    }
+#ifdef WITH_LZO
+    case DCACHE_COMPRESSION_LZO: {
+      lzo_uint size_raw = (lzo_uint)header_entry->size_raw;
+      if (lzo1x_decompress_safe(
+              data, (lzo_uint)header_entry->size_compressed, buffer, &size_raw, NULL) ==
+          LZO_E_OK) {
+        bytes_read = size_raw;
+      }
+      break;
+    }
+#endif
+  }
+
+  seq_disk_cache_data_release(handle, handle_size);
+  return bytes_read;
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -576,7 +780,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
 static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *header)
 {
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if (header->entry[i].frameno == key->nfra) {
+    if (header->entry[i].size_compressed != 0 && header->entry[i].frameno == key->nfra) {
       return i;
     }
   }
@@ -584,6 +788,16 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
+/* Header of file is read only once, then the copy in memory is used. */
+static DiskCacheHeader *seq_disk_cache_file_header_get(DiskCacheFile *cache_file, FILE *file)
+{
+  if (cache_file->header == NULL) {
+    cache_file->header = MEM_callocN(sizeof(DiskCacheHeader), "DiskCacheHeader");
+    seq_disk_cache_read_header(file, cache_file->header);
+  }
+  return cache_file->header;
+}
+
 static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
 {
   char path[FILE_MAX];
@@ -597,15 +811,16 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
     if (!file) {
       return false;
     }
-    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
-  DiskCacheHeader header;
-  memset(&header, 0, sizeof(header));
-  seq_disk_cache_read_header(file, &header);
+  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
+  if (cache_file == NULL) {
+    cache_file = seq_disk_cache_add_file_to_list(disk_cache, path);
+  }
+
+  DiskCacheHeader header = *seq_disk_cache_file_header_get(cache_file, file);
   int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  size_t bytes_written = seq_disk_cache_write_imbuf(ibuf, file, &header.entry[entry_index]);
 
   if (bytes_written != 0) {
     /* Last step is writing header, as image data can be overwritten,
@@ -613,30 +828,42 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
      */
     header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
+    *cache_file->header = header;
     fclose(file);
+    seq_disk_cache_update_file(disk_cache, path);
 
     return true;
   }
 
+  fclose(file);
   return false;
 }
 
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
 {
   char path[FILE_MAX];
-  DiskCacheHeader header;
 
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
+
+  /* Files are indexed when the cache is created and when they are written,
+   * so there is no need to touch the disk for files that were never written.
+   */
+  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
+  if (cache_file == NULL) {
+    return NULL;
+  }
+
+  if (cache_file->header != NULL && seq_disk_cache_get_header_entry(key, cache_file->header) < 0) {
+    return NULL;
+  }
 
   FILE *file = BLI_fopen(path, "rb");
   if (!file) {
     return NULL;
   }
 
-  seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+  DiskCacheHeader *header = seq_disk_cache_file_header_get(cache_file, file);
+  int entry_index = seq_disk_cache_get_header_entry(key, header);
 
   /* Item not found. */
   if (entry_index < 0) {
@@ -649,32 +876,32 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
   size_t expected_size;
 
-  if (header.entry[entry_index].size_raw == size_char) {
+  if (header->entry[entry_index].size_raw == size_char) {
     expected_size = size_char;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, header->entry[entry_index].colorspace_name);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
+  else if (header->entry[entry_index].size_raw == size_float) {
     expected_size = size_float;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_float_colorspace(ibuf,
+                                                header->entry[entry_index].colorspace_name);
   }
   else {
     fclose(file);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  size_t bytes_read = seq_disk_cache_read_imbuf(ibuf, file, &header->entry[entry_index]);
+  fclose(file);
 
   /* Sanity check. */
   if (bytes_read != expected_size) {
-    fclose(file);
     IMB_freeImBuf(ibuf);
     return NULL;
   }
   BLI_file_touch(path);
   seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
@@ -798,7 +1025,7 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
-    cache->last_key = key;
+    cache->last_key[key->task_id] = key;
     cache->memory_used += IMB_get_size_in_memory(ibuf);
   }
 }
@@ -1047,6 +1274,7 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
 
   cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   cache->disk_cache->bmain = bmain;
+  cache->disk_cache->files_hash = BLI_ghash_str_new("SeqDiskCache files hash");
   BLI_mutex_init(&cache->disk_cache->read_write_mutex);
   seq_disk_cache_handle_versioning(cache->disk_cache);
   seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
@@ -1062,7 +1290,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1112,7 +1339,8 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
-    BLI_freelistN(&cache->disk_cache->files);
+    seq_disk_cache_free_files(cache->disk_cache);
+    BLI_ghash_free(cache->disk_cache->files_hash, NULL, NULL);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
   }
@@ -1146,7 +1374,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1210,7 +1438,7 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1300,8 +1528,8 @@ bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
     return true;
   }
   else {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = NULL;
+    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key[context->task_id]);
+    scene->ed->cache->last_key[context->task_id] = NULL;
     return false;
   }
 }
@@ -1373,27 +1601,27 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = cache->last_key[key->task_id];
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = cache->last_key[key->task_id];
   seq_cache_put(cache, key, i);
 
   /* Restore pointer to previous item as this one will be freed when stack is rendered. */
   if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
+    cache->last_key[key->task_id] = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
    * Item is already put in cache, so cache->last_key points to current key.
    */
   if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = cache->last_key[key->task_id];
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    cache->last_key[key->task_id] = NULL;
   }
 
   seq_cache_unlock(scene);
@@ -1436,7 +1664,7 @@ void BKE_sequencer_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1450,3 +1678,15 @@ bool BKE_sequencer_cache_is_full(Scene *scene)
 
   return memory_total < cache->memory_used;
 }
+
+/* Memory which may still be used before the cache is full. */
+size_t BKE_sequencer_cache_get_memory_free(Scene *scene)
+{
+  size_t memory_total = seq_cache_get_mem_total();
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return memory_total;
+  }
+
+  return (cache->memory_used < memory_total) ? memory_total - cache->memory_used : 0;
+}
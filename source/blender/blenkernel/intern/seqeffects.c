@@ -28,6 +28,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+/* AVX2 kernels are built into x86-64 builds as well, they are only used when the CPU supports
+ * them. */
+#  if defined(__x86_64__) || defined(_M_X64)
+#    include <immintrin.h>
+#    define WITH_SEQ_EFFECT_AVX2
+#    ifdef _MSC_VER
+#      define SEQ_AVX2_FUNC
+#    else
+#      define SEQ_AVX2_FUNC __attribute__((target("avx2")))
+#    endif
+#    define SEQ_AVX2_INLINE static inline SEQ_AVX2_FUNC
+#  endif
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
@@ -35,6 +51,7 @@
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_system.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -183,6 +200,240 @@ static ImBuf *prepare_effect_imbufs(const SeqRenderData *context,
   return out;
 }
 
+/*********************** Vectorized Blending *************************/
+
+/* Blend effects run vectorized kernels one row at a time when the CPU supports them,
+ * alternating the factor of both fields like the scalar loops do.
+ * Byte kernels give the same results as the scalar code, bit for bit. The SSE2 kernels are used
+ * on every x86-64 CPU, AVX2 kernels process twice as many pixels at once and are picked at
+ * runtime. */
+
+static int seq_effect_simd = SEQ_EFFECT_SIMD_AVX2;
+
+static bool seq_effect_cpu_support_avx2(void)
+{
+#ifdef WITH_SEQ_EFFECT_AVX2
+  static int cpu_support_avx2 = -1;
+  if (cpu_support_avx2 == -1) {
+    cpu_support_avx2 = BLI_cpu_support_avx2();
+  }
+  return cpu_support_avx2 != 0;
+#else
+  return false;
+#endif
+}
+
+static int seq_effect_simd_get(void)
+{
+#ifdef __SSE2__
+  if (seq_effect_simd >= SEQ_EFFECT_SIMD_AVX2 && !seq_effect_cpu_support_avx2()) {
+    return SEQ_EFFECT_SIMD_SSE2;
+  }
+  return seq_effect_simd;
+#else
+  return SEQ_EFFECT_SIMD_NONE;
+#endif
+}
+
+int BKE_sequencer_effect_simd_set(int simd)
+{
+  seq_effect_simd = simd;
+  return seq_effect_simd_get();
+}
+
+#ifdef __SSE2__
+
+typedef void (*SeqEffectRowByteFunc)(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out);
+typedef void (*SeqEffectRowFloatFunc)(float fac, int x, float *rect1, float *rect2, float *out);
+
+typedef struct SeqEffectRowKernels {
+  SeqEffectRowByteFunc row_byte;
+  SeqEffectRowFloatFunc row_float;
+  SeqEffectRowByteFunc row_byte_avx2;
+  SeqEffectRowFloatFunc row_float_avx2;
+} SeqEffectRowKernels;
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+#    define SEQ_EFFECT_ROW_KERNELS(name) \
+      { \
+        do_##name##_effect_row_byte_sse2, do_##name##_effect_row_float_sse2, \
+            do_##name##_effect_row_byte_avx2, do_##name##_effect_row_float_avx2 \
+      }
+#  else
+#    define SEQ_EFFECT_ROW_KERNELS(name) \
+      { \
+        do_##name##_effect_row_byte_sse2, do_##name##_effect_row_float_sse2, NULL, NULL \
+      }
+#  endif
+
+/* Returns false when the scalar code has to be used. */
+static bool seq_effect_simd_apply(const SeqRenderData *context,
+                                  const SeqEffectRowKernels *kernels,
+                                  float facf0,
+                                  float facf1,
+                                  ImBuf *ibuf1,
+                                  ImBuf *ibuf2,
+                                  int start_line,
+                                  int total_lines,
+                                  ImBuf *out)
+{
+  const int x = context->rectx;
+  const int simd = seq_effect_simd_get();
+  SeqEffectRowByteFunc row_byte = kernels->row_byte;
+  SeqEffectRowFloatFunc row_float = kernels->row_float;
+
+  if (simd == SEQ_EFFECT_SIMD_NONE) {
+    return false;
+  }
+  if (simd == SEQ_EFFECT_SIMD_AVX2 && kernels->row_byte_avx2) {
+    row_byte = kernels->row_byte_avx2;
+    row_float = kernels->row_float_avx2;
+  }
+
+  if (out->rect_float) {
+    float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+
+    slice_get_float_buffers(
+        context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+    for (int y = 0; y < total_lines; y++) {
+      const size_t offset = (size_t)y * x * 4;
+      row_float((y % 2) ? facf1 : facf0, x, rect1 + offset, rect2 + offset, rect_out + offset);
+    }
+  }
+  else {
+    unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+
+    slice_get_byte_buffers(
+        context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+    for (int y = 0; y < total_lines; y++) {
+      const size_t offset = (size_t)y * x * 4;
+      row_byte((y % 2) ? facf1 : facf0, x, rect1 + offset, rect2 + offset, rect_out + offset);
+    }
+  }
+
+  return true;
+}
+
+/* RGB from the first vector, alpha from the second. */
+BLI_INLINE __m128 seq_sse_select_alpha(__m128 rgb, __m128 alpha)
+{
+  const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  return _mm_or_ps(_mm_andnot_ps(mask, rgb), _mm_and_ps(mask, alpha));
+}
+
+/* Same as straight_uchar_to_premul_float(). */
+BLI_INLINE __m128 seq_sse_straight_uchar_to_premul_float(const unsigned char *color)
+{
+  const __m128i zero = _mm_setzero_si128();
+  int bytes;
+  memcpy(&bytes, color, sizeof(bytes));
+  __m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+  value = _mm_unpacklo_epi16(value, zero);
+
+  const __m128 color_v = _mm_cvtepi32_ps(value);
+  const __m128 alpha = _mm_mul_ps(_mm_shuffle_ps(color_v, color_v, _MM_SHUFFLE(3, 3, 3, 3)),
+                                  _mm_set1_ps(1.0f / 255.0f));
+  const __m128 fac = _mm_mul_ps(alpha, _mm_set1_ps(1.0f / 255.0f));
+  return seq_sse_select_alpha(_mm_mul_ps(color_v, fac), alpha);
+}
+
+/* Same as premul_float_to_straight_uchar(). */
+BLI_INLINE void seq_sse_premul_float_to_straight_uchar(unsigned char *result, __m128 color)
+{
+  const float alpha = _mm_cvtss_f32(_mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3)));
+  if (alpha != 0.0f && alpha != 1.0f) {
+    color = seq_sse_select_alpha(_mm_mul_ps(color, _mm_set1_ps(1.0f / alpha)), color);
+  }
+
+  /* Same as unit_float_to_uchar_clamp(). */
+  const __m128 value = _mm_add_ps(_mm_mul_ps(_mm_max_ps(color, _mm_setzero_ps()),
+                                             _mm_set1_ps(255.0f)),
+                                  _mm_set1_ps(0.5f));
+  const __m128i over = _mm_castps_si128(_mm_cmpgt_ps(color, _mm_set1_ps(1.0f - 0.5f / 255.0f)));
+  __m128i value_int = _mm_cvttps_epi32(value);
+  value_int = _mm_or_si128(_mm_andnot_si128(over, value_int),
+                           _mm_and_si128(over, _mm_set1_epi32(255)));
+  value_int = _mm_packs_epi32(value_int, value_int);
+  value_int = _mm_packus_epi16(value_int, value_int);
+
+  const int bytes = _mm_cvtsi128_si32(value_int);
+  memcpy(result, &bytes, sizeof(bytes));
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+/* AVX2 kernels work on two pixels per float vector, with the same operations as the SSE2
+ * kernels for every pixel. */
+
+/* Alpha of both pixels in all of their channels. */
+SEQ_AVX2_INLINE __m256 seq_avx2_splat_alpha(__m256 color)
+{
+  return _mm256_permute_ps(color, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* RGB from the first vector, alpha from the second. */
+SEQ_AVX2_INLINE __m256 seq_avx2_select_alpha(__m256 rgb, __m256 alpha)
+{
+  return _mm256_blend_ps(rgb, alpha, 0x88);
+}
+
+/* Same as straight_uchar_to_premul_float(), for two pixels. */
+SEQ_AVX2_INLINE __m256 seq_avx2_straight_uchar_to_premul_float(const unsigned char *color)
+{
+  const __m256 color_v = _mm256_cvtepi32_ps(
+      _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)color)));
+  const __m256 alpha = _mm256_mul_ps(seq_avx2_splat_alpha(color_v),
+                                     _mm256_set1_ps(1.0f / 255.0f));
+  const __m256 fac = _mm256_mul_ps(alpha, _mm256_set1_ps(1.0f / 255.0f));
+  return seq_avx2_select_alpha(_mm256_mul_ps(color_v, fac), alpha);
+}
+
+/* Same as premul_float_to_straight_uchar(), for two pixels. */
+SEQ_AVX2_INLINE void seq_avx2_premul_float_to_straight_uchar(unsigned char *result, __m256 color)
+{
+  const __m256 alpha = seq_avx2_splat_alpha(color);
+  const __m256 unpremul = _mm256_and_ps(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_NEQ_UQ),
+                                        _mm256_cmp_ps(alpha, _mm256_set1_ps(1.0f), _CMP_NEQ_UQ));
+  const __m256 straight = seq_avx2_select_alpha(
+      _mm256_mul_ps(color, _mm256_div_ps(_mm256_set1_ps(1.0f), alpha)), color);
+  color = _mm256_blendv_ps(color, straight, unpremul);
+
+  /* Same as unit_float_to_uchar_clamp(). */
+  const __m256 value = _mm256_add_ps(
+      _mm256_mul_ps(_mm256_max_ps(color, _mm256_setzero_ps()), _mm256_set1_ps(255.0f)),
+      _mm256_set1_ps(0.5f));
+  const __m256i over = _mm256_castps_si256(
+      _mm256_cmp_ps(color, _mm256_set1_ps(1.0f - 0.5f / 255.0f), _CMP_GT_OQ));
+  __m256i value_int = _mm256_cvttps_epi32(value);
+  value_int = _mm256_blendv_epi8(value_int, _mm256_set1_epi32(255), over);
+
+  __m128i bytes = _mm_packs_epi32(_mm256_castsi256_si128(value_int),
+                                  _mm256_extracti128_si256(value_int, 1));
+  bytes = _mm_packus_epi16(bytes, bytes);
+  _mm_storel_epi64((__m128i *)result, bytes);
+}
+
+/* Write the pixels of two which are selected by a float compare mask, from rect. */
+SEQ_AVX2_INLINE void seq_avx2_copy_masked_pixels(unsigned char *result,
+                                                 const unsigned char *rect,
+                                                 __m256 mask)
+{
+  const int bits = _mm256_movemask_ps(mask);
+  if (bits & 0x01) {
+    memcpy(result, rect, sizeof(int));
+  }
+  if (bits & 0x10) {
+    memcpy(result + 4, rect + 4, sizeof(int));
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 /*********************** Alpha Over *************************/
 
 static void init_alpha_over_or_under(Sequence *seq)
@@ -348,6 +599,115 @@ static void do_alphaover_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+static void do_alphaover_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  if (fac <= 0.0f) {
+    memcpy(out, rect2, sizeof(int) * x);
+    return;
+  }
+
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const float mfac = 1.0f - fac * (rect1[3] * (1.0f / 255.0f));
+    if (mfac <= 0.0f) {
+      memcpy(out, rect1, sizeof(int));
+      continue;
+    }
+
+    const __m128 rt1 = seq_sse_straight_uchar_to_premul_float(rect1);
+    const __m128 rt2 = seq_sse_straight_uchar_to_premul_float(rect2);
+    seq_sse_premul_float_to_straight_uchar(
+        out, _mm_add_ps(_mm_mul_ps(fac_v, rt1), _mm_mul_ps(_mm_set1_ps(mfac), rt2)));
+  }
+}
+
+static void do_alphaover_effect_row_float_sse2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  if (fac <= 0.0f) {
+    memcpy(out, rect2, sizeof(float[4]) * x);
+    return;
+  }
+
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const float mfac = 1.0f - fac * rect1[3];
+    if (mfac <= 0.0f) {
+      memcpy(out, rect1, sizeof(float[4]));
+      continue;
+    }
+
+    _mm_storeu_ps(out,
+                  _mm_add_ps(_mm_mul_ps(fac_v, _mm_loadu_ps(rect1)),
+                             _mm_mul_ps(_mm_set1_ps(mfac), _mm_loadu_ps(rect2))));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+static SEQ_AVX2_FUNC void do_alphaover_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  if (fac <= 0.0f) {
+    memcpy(out, rect2, sizeof(int) * x);
+    return;
+  }
+
+  const __m256 fac_v = _mm256_set1_ps(fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = seq_avx2_straight_uchar_to_premul_float(rect1);
+    const __m256 rt2 = seq_avx2_straight_uchar_to_premul_float(rect2);
+    const __m256 mfac = _mm256_sub_ps(_mm256_set1_ps(1.0f),
+                                      _mm256_mul_ps(fac_v, seq_avx2_splat_alpha(rt1)));
+
+    unsigned char result[8];
+    seq_avx2_premul_float_to_straight_uchar(
+        result, _mm256_add_ps(_mm256_mul_ps(fac_v, rt1), _mm256_mul_ps(mfac, rt2)));
+    seq_avx2_copy_masked_pixels(
+        result, rect1, _mm256_cmp_ps(mfac, _mm256_setzero_ps(), _CMP_LE_OQ));
+    memcpy(out, result, sizeof(result));
+  }
+
+  if (i < x) {
+    do_alphaover_effect_row_byte_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_alphaover_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  if (fac <= 0.0f) {
+    memcpy(out, rect2, sizeof(float[4]) * x);
+    return;
+  }
+
+  const __m256 fac_v = _mm256_set1_ps(fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = _mm256_loadu_ps(rect1);
+    const __m256 rt2 = _mm256_loadu_ps(rect2);
+    const __m256 mfac = _mm256_sub_ps(_mm256_set1_ps(1.0f),
+                                      _mm256_mul_ps(fac_v, seq_avx2_splat_alpha(rt1)));
+    const __m256 color = _mm256_add_ps(_mm256_mul_ps(fac_v, rt1), _mm256_mul_ps(mfac, rt2));
+    _mm256_storeu_ps(
+        out, _mm256_blendv_ps(color, rt1, _mm256_cmp_ps(mfac, _mm256_setzero_ps(), _CMP_LE_OQ)));
+  }
+
+  if (i < x) {
+    do_alphaover_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_alphaover_effect(const SeqRenderData *context,
                                 Sequence *UNUSED(seq),
                                 float UNUSED(cfra),
@@ -360,6 +720,22 @@ static void do_alphaover_effect(const SeqRenderData *context,
                                 int total_lines,
                                 ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(alphaover);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -555,6 +931,121 @@ static void do_alphaunder_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+static void do_alphaunder_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const float alpha2 = rect2[3] * (1.0f / 255.0f);
+    if (alpha2 <= 0.0f && fac >= 1.0f) {
+      memcpy(out, rect1, sizeof(int));
+      continue;
+    }
+
+    const float mfac = fac * (1.0f - alpha2);
+    if (alpha2 >= 1.0f || mfac <= 0.0f) {
+      memcpy(out, rect2, sizeof(int));
+      continue;
+    }
+
+    const __m128 rt1 = seq_sse_straight_uchar_to_premul_float(rect1);
+    const __m128 rt2 = seq_sse_straight_uchar_to_premul_float(rect2);
+    seq_sse_premul_float_to_straight_uchar(out,
+                                           _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mfac), rt1), rt2));
+  }
+}
+
+static void do_alphaunder_effect_row_float_sse2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    if (rect2[3] <= 0.0f && fac >= 1.0f) {
+      memcpy(out, rect1, sizeof(float[4]));
+      continue;
+    }
+
+    const float mfac = fac * (1.0f - rect2[3]);
+    if (rect2[3] >= 1.0f || mfac == 0.0f) {
+      memcpy(out, rect2, sizeof(float[4]));
+      continue;
+    }
+
+    _mm_storeu_ps(
+        out, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mfac), _mm_loadu_ps(rect1)), _mm_loadu_ps(rect2)));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+static SEQ_AVX2_FUNC void do_alphaunder_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const __m256 fac_v = _mm256_set1_ps(fac);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = seq_avx2_straight_uchar_to_premul_float(rect1);
+    const __m256 rt2 = seq_avx2_straight_uchar_to_premul_float(rect2);
+    const __m256 alpha2 = seq_avx2_splat_alpha(rt2);
+    const __m256 mfac = _mm256_mul_ps(fac_v, _mm256_sub_ps(one, alpha2));
+
+    unsigned char result[8];
+    seq_avx2_premul_float_to_straight_uchar(result,
+                                            _mm256_add_ps(_mm256_mul_ps(mfac, rt1), rt2));
+    seq_avx2_copy_masked_pixels(result,
+                                rect2,
+                                _mm256_or_ps(_mm256_cmp_ps(alpha2, one, _CMP_GE_OQ),
+                                             _mm256_cmp_ps(mfac, zero, _CMP_LE_OQ)));
+    seq_avx2_copy_masked_pixels(result,
+                                rect1,
+                                _mm256_and_ps(_mm256_cmp_ps(alpha2, zero, _CMP_LE_OQ),
+                                              _mm256_cmp_ps(fac_v, one, _CMP_GE_OQ)));
+    memcpy(out, result, sizeof(result));
+  }
+
+  if (i < x) {
+    do_alphaunder_effect_row_byte_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_alphaunder_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac_v = _mm256_set1_ps(fac);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = _mm256_loadu_ps(rect1);
+    const __m256 rt2 = _mm256_loadu_ps(rect2);
+    const __m256 alpha2 = seq_avx2_splat_alpha(rt2);
+    const __m256 mfac = _mm256_mul_ps(fac_v, _mm256_sub_ps(one, alpha2));
+
+    __m256 color = _mm256_add_ps(_mm256_mul_ps(mfac, rt1), rt2);
+    color = _mm256_blendv_ps(color,
+                             rt2,
+                             _mm256_or_ps(_mm256_cmp_ps(alpha2, one, _CMP_GE_OQ),
+                                          _mm256_cmp_ps(mfac, zero, _CMP_EQ_OQ)));
+    color = _mm256_blendv_ps(color,
+                             rt1,
+                             _mm256_and_ps(_mm256_cmp_ps(alpha2, zero, _CMP_LE_OQ),
+                                           _mm256_cmp_ps(fac_v, one, _CMP_GE_OQ)));
+    _mm256_storeu_ps(out, color);
+  }
+
+  if (i < x) {
+    do_alphaunder_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_alphaunder_effect(const SeqRenderData *context,
                                  Sequence *UNUSED(seq),
                                  float UNUSED(cfra),
@@ -567,6 +1058,22 @@ static void do_alphaunder_effect(const SeqRenderData *context,
                                  int total_lines,
                                  ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(alphaunder);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -690,6 +1197,109 @@ static void do_cross_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+static void do_cross_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac2 = (int)(256.0f * fac);
+  const int fac1 = 256 - fac2;
+  int i = 0;
+
+  /* Products only fit 16 bits for factors in the 0..1 range. */
+  if (fac2 >= 0 && fac2 <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fac1_v = _mm_set1_epi16((short)fac1);
+    const __m128i fac2_v = _mm_set1_epi16((short)fac2);
+
+    for (; i + 4 <= x; i += 4) {
+      const __m128i rt1 = _mm_loadu_si128((const __m128i *)(rect1 + i * 4));
+      const __m128i rt2 = _mm_loadu_si128((const __m128i *)(rect2 + i * 4));
+      __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(rt1, zero), fac1_v),
+                                 _mm_mullo_epi16(_mm_unpacklo_epi8(rt2, zero), fac2_v));
+      __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(rt1, zero), fac1_v),
+                                 _mm_mullo_epi16(_mm_unpackhi_epi8(rt2, zero), fac2_v));
+      lo = _mm_srli_epi16(lo, 8);
+      hi = _mm_srli_epi16(hi, 8);
+      _mm_storeu_si128((__m128i *)(out + i * 4), _mm_packus_epi16(lo, hi));
+    }
+  }
+
+  if (i < x) {
+    do_cross_effect_byte(fac, fac, x - i, 1, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static void do_cross_effect_row_float_sse2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m128 fac1_v = _mm_set1_ps(1.0f - fac);
+  const __m128 fac2_v = _mm_set1_ps(fac);
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    _mm_storeu_ps(out,
+                  _mm_add_ps(_mm_mul_ps(fac1_v, _mm_loadu_ps(rect1)),
+                             _mm_mul_ps(fac2_v, _mm_loadu_ps(rect2))));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+static SEQ_AVX2_FUNC void do_cross_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac2 = (int)(256.0f * fac);
+  const int fac1 = 256 - fac2;
+  int i = 0;
+
+  if (fac2 >= 0 && fac2 <= 256) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fac1_v = _mm256_set1_epi16((short)fac1);
+    const __m256i fac2_v = _mm256_set1_epi16((short)fac2);
+
+    /* Unpacking and packing work within 128 bit lanes, which keeps the pixel order. */
+    for (; i + 8 <= x; i += 8) {
+      const __m256i rt1 = _mm256_loadu_si256((const __m256i *)(rect1 + i * 4));
+      const __m256i rt2 = _mm256_loadu_si256((const __m256i *)(rect2 + i * 4));
+      __m256i lo = _mm256_add_epi16(
+          _mm256_mullo_epi16(_mm256_unpacklo_epi8(rt1, zero), fac1_v),
+          _mm256_mullo_epi16(_mm256_unpacklo_epi8(rt2, zero), fac2_v));
+      __m256i hi = _mm256_add_epi16(
+          _mm256_mullo_epi16(_mm256_unpackhi_epi8(rt1, zero), fac1_v),
+          _mm256_mullo_epi16(_mm256_unpackhi_epi8(rt2, zero), fac2_v));
+      lo = _mm256_srli_epi16(lo, 8);
+      hi = _mm256_srli_epi16(hi, 8);
+      _mm256_storeu_si256((__m256i *)(out + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+  }
+
+  if (i < x) {
+    do_cross_effect_row_byte_sse2(fac, x - i, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_cross_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac1_v = _mm256_set1_ps(1.0f - fac);
+  const __m256 fac2_v = _mm256_set1_ps(fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    _mm256_storeu_ps(out,
+                     _mm256_add_ps(_mm256_mul_ps(fac1_v, _mm256_loadu_ps(rect1)),
+                                   _mm256_mul_ps(fac2_v, _mm256_loadu_ps(rect2))));
+  }
+
+  if (i < x) {
+    do_cross_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_cross_effect(const SeqRenderData *context,
                             Sequence *UNUSED(seq),
                             float UNUSED(cfra),
@@ -702,6 +1312,22 @@ static void do_cross_effect(const SeqRenderData *context,
                             int total_lines,
                             ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(cross);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -977,6 +1603,187 @@ static void do_gammacross_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+/* Same as gammaCorrect() or invGammaCorrect() of four values, depending on the tables.
+ * Returns false when a value is neither inside of the tables nor one, the scalar code handles
+ * those. */
+BLI_INLINE bool seq_sse_gamma_table(__m128 c,
+                                    const float *range_table,
+                                    const float *factor_table,
+                                    __m128 *r_result)
+{
+  const __m128 pos = _mm_mul_ps(c, _mm_set1_ps(inv_color_step));
+  const __m128 in_table = _mm_and_ps(_mm_cmpge_ps(pos, _mm_setzero_ps()),
+                                     _mm_cmplt_ps(pos, _mm_set1_ps(RE_GAMMA_TABLE_SIZE)));
+  const __m128 is_one = _mm_cmpeq_ps(c, _mm_set1_ps(1.0f));
+  if (_mm_movemask_ps(_mm_or_ps(in_table, is_one)) != 0xf) {
+    return false;
+  }
+
+  /* Positions are not negative, truncation is the same as floorf(). */
+  int index[4];
+  _mm_storeu_si128((__m128i *)index,
+                   _mm_and_si128(_mm_cvttps_epi32(pos), _mm_castps_si128(in_table)));
+  const __m128 domain = _mm_setr_ps(color_domain_table[index[0]],
+                                    color_domain_table[index[1]],
+                                    color_domain_table[index[2]],
+                                    color_domain_table[index[3]]);
+  const __m128 range = _mm_setr_ps(
+      range_table[index[0]], range_table[index[1]], range_table[index[2]], range_table[index[3]]);
+  const __m128 factor = _mm_setr_ps(factor_table[index[0]],
+                                    factor_table[index[1]],
+                                    factor_table[index[2]],
+                                    factor_table[index[3]]);
+  const __m128 result = _mm_add_ps(range, _mm_mul_ps(_mm_sub_ps(c, domain), factor));
+
+  /* The power of one is one. */
+  *r_result = _mm_or_ps(_mm_and_ps(in_table, result),
+                        _mm_andnot_ps(in_table, _mm_set1_ps(1.0f)));
+  return true;
+}
+
+BLI_INLINE bool seq_sse_gammacross(
+    __m128 fac1_v, __m128 fac2_v, __m128 rt1, __m128 rt2, __m128 *r_result)
+{
+  __m128 inv1, inv2;
+  if (!seq_sse_gamma_table(rt1, inv_gamma_range_table, inv_gamfactor_table, &inv1) ||
+      !seq_sse_gamma_table(rt2, inv_gamma_range_table, inv_gamfactor_table, &inv2)) {
+    return false;
+  }
+
+  const __m128 mix = _mm_add_ps(_mm_mul_ps(fac1_v, inv1), _mm_mul_ps(fac2_v, inv2));
+  return seq_sse_gamma_table(mix, gamma_range_table, gamfactor_table, r_result);
+}
+
+static void do_gammacross_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const __m128 fac1_v = _mm_set1_ps(1.0f - fac);
+  const __m128 fac2_v = _mm_set1_ps(fac);
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const __m128 rt1 = seq_sse_straight_uchar_to_premul_float(rect1);
+    const __m128 rt2 = seq_sse_straight_uchar_to_premul_float(rect2);
+    __m128 color;
+    if (seq_sse_gammacross(fac1_v, fac2_v, rt1, rt2, &color)) {
+      seq_sse_premul_float_to_straight_uchar(out, color);
+    }
+    else {
+      do_gammacross_effect_byte(fac, fac, 1, 1, rect1, rect2, out);
+    }
+  }
+}
+
+static void do_gammacross_effect_row_float_sse2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m128 fac1_v = _mm_set1_ps(1.0f - fac);
+  const __m128 fac2_v = _mm_set1_ps(fac);
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    __m128 color;
+    if (seq_sse_gammacross(fac1_v, fac2_v, _mm_loadu_ps(rect1), _mm_loadu_ps(rect2), &color)) {
+      _mm_storeu_ps(out, color);
+    }
+    else {
+      do_gammacross_effect_float(fac, fac, 1, 1, rect1, rect2, out);
+    }
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+/* Same as seq_sse_gamma_table(), for eight values. */
+SEQ_AVX2_INLINE bool seq_avx2_gamma_table(__m256 c,
+                                          const float *range_table,
+                                          const float *factor_table,
+                                          __m256 *r_result)
+{
+  const __m256 pos = _mm256_mul_ps(c, _mm256_set1_ps(inv_color_step));
+  const __m256 in_table = _mm256_and_ps(
+      _mm256_cmp_ps(pos, _mm256_setzero_ps(), _CMP_GE_OQ),
+      _mm256_cmp_ps(pos, _mm256_set1_ps(RE_GAMMA_TABLE_SIZE), _CMP_LT_OQ));
+  const __m256 is_one = _mm256_cmp_ps(c, _mm256_set1_ps(1.0f), _CMP_EQ_OQ);
+  if (_mm256_movemask_ps(_mm256_or_ps(in_table, is_one)) != 0xff) {
+    return false;
+  }
+
+  const __m256i index = _mm256_and_si256(_mm256_cvttps_epi32(pos),
+                                         _mm256_castps_si256(in_table));
+  const __m256 domain = _mm256_i32gather_ps(color_domain_table, index, 4);
+  const __m256 range = _mm256_i32gather_ps(range_table, index, 4);
+  const __m256 factor = _mm256_i32gather_ps(factor_table, index, 4);
+  const __m256 result = _mm256_add_ps(range, _mm256_mul_ps(_mm256_sub_ps(c, domain), factor));
+
+  *r_result = _mm256_blendv_ps(_mm256_set1_ps(1.0f), result, in_table);
+  return true;
+}
+
+SEQ_AVX2_INLINE bool seq_avx2_gammacross(
+    __m256 fac1_v, __m256 fac2_v, __m256 rt1, __m256 rt2, __m256 *r_result)
+{
+  __m256 inv1, inv2;
+  if (!seq_avx2_gamma_table(rt1, inv_gamma_range_table, inv_gamfactor_table, &inv1) ||
+      !seq_avx2_gamma_table(rt2, inv_gamma_range_table, inv_gamfactor_table, &inv2)) {
+    return false;
+  }
+
+  const __m256 mix = _mm256_add_ps(_mm256_mul_ps(fac1_v, inv1), _mm256_mul_ps(fac2_v, inv2));
+  return seq_avx2_gamma_table(mix, gamma_range_table, gamfactor_table, r_result);
+}
+
+static SEQ_AVX2_FUNC void do_gammacross_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const __m256 fac1_v = _mm256_set1_ps(1.0f - fac);
+  const __m256 fac2_v = _mm256_set1_ps(fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = seq_avx2_straight_uchar_to_premul_float(rect1);
+    const __m256 rt2 = seq_avx2_straight_uchar_to_premul_float(rect2);
+    __m256 color;
+    if (seq_avx2_gammacross(fac1_v, fac2_v, rt1, rt2, &color)) {
+      seq_avx2_premul_float_to_straight_uchar(out, color);
+    }
+    else {
+      do_gammacross_effect_row_byte_sse2(fac, 2, rect1, rect2, out);
+    }
+  }
+
+  if (i < x) {
+    do_gammacross_effect_row_byte_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_gammacross_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac1_v = _mm256_set1_ps(1.0f - fac);
+  const __m256 fac2_v = _mm256_set1_ps(fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    __m256 color;
+    if (seq_avx2_gammacross(
+            fac1_v, fac2_v, _mm256_loadu_ps(rect1), _mm256_loadu_ps(rect2), &color)) {
+      _mm256_storeu_ps(out, color);
+    }
+    else {
+      do_gammacross_effect_row_float_sse2(fac, 2, rect1, rect2, out);
+    }
+  }
+
+  if (i < x) {
+    do_gammacross_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static struct ImBuf *gammacross_init_execution(const SeqRenderData *context,
                                                ImBuf *ibuf1,
                                                ImBuf *ibuf2,
@@ -1000,6 +1807,16 @@ static void do_gammacross_effect(const SeqRenderData *context,
                                  int total_lines,
                                  ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(gammacross);
+
+  /* Both fields use the first factor, like the scalar code. */
+  if (seq_effect_simd_apply(
+          context, &kernels, facf0, facf0, ibuf1, ibuf2, start_line, total_lines, out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -1123,6 +1940,126 @@ static void do_add_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+/* (fac * alpha2 * color2) >> 16 for the RGB channels of four pixels, zero for alpha.
+ * Factor times alpha fits in 16 bits for factors in the 0..256 range. */
+BLI_INLINE __m128i seq_sse_add_sub_term(__m128i fac_v, __m128i rt2)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_unpacklo_epi8(rt2, zero);
+  const __m128i hi = _mm_unpackhi_epi8(rt2, zero);
+  __m128i alpha_lo = _mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i alpha_hi = _mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha_lo = _mm_shufflehi_epi16(alpha_lo, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha_hi = _mm_shufflehi_epi16(alpha_hi, _MM_SHUFFLE(3, 3, 3, 3));
+
+  const __m128i term = _mm_packus_epi16(
+      _mm_mulhi_epu16(_mm_mullo_epi16(fac_v, alpha_lo), lo),
+      _mm_mulhi_epu16(_mm_mullo_epi16(fac_v, alpha_hi), hi));
+  return _mm_and_si128(term, _mm_set1_epi32(0x00ffffff));
+}
+
+static void do_add_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m128i fac_v = _mm_set1_epi16((short)fac1);
+
+    for (; i + 4 <= x; i += 4) {
+      const __m128i rt1 = _mm_loadu_si128((const __m128i *)(rect1 + i * 4));
+      const __m128i rt2 = _mm_loadu_si128((const __m128i *)(rect2 + i * 4));
+      _mm_storeu_si128((__m128i *)(out + i * 4),
+                       _mm_adds_epu8(rt1, seq_sse_add_sub_term(fac_v, rt2)));
+    }
+  }
+
+  if (i < x) {
+    do_add_effect_byte(fac, fac, x - i, 1, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static void do_add_effect_row_float_sse2(float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const float fac_inv = 1.0f - fac;
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const float m = (1.0f - (rect1[3] * fac_inv)) * rect2[3];
+    const __m128 rt1 = _mm_loadu_ps(rect1);
+    const __m128 color = _mm_add_ps(rt1, _mm_mul_ps(_mm_set1_ps(m), _mm_loadu_ps(rect2)));
+    _mm_storeu_ps(out, seq_sse_select_alpha(color, rt1));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+/* Same as seq_sse_add_sub_term(), for eight pixels. */
+SEQ_AVX2_INLINE __m256i seq_avx2_add_sub_term(__m256i fac_v, __m256i rt2)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i lo = _mm256_unpacklo_epi8(rt2, zero);
+  const __m256i hi = _mm256_unpackhi_epi8(rt2, zero);
+  __m256i alpha_lo = _mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3));
+  __m256i alpha_hi = _mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha_lo = _mm256_shufflehi_epi16(alpha_lo, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha_hi = _mm256_shufflehi_epi16(alpha_hi, _MM_SHUFFLE(3, 3, 3, 3));
+
+  const __m256i term = _mm256_packus_epi16(
+      _mm256_mulhi_epu16(_mm256_mullo_epi16(fac_v, alpha_lo), lo),
+      _mm256_mulhi_epu16(_mm256_mullo_epi16(fac_v, alpha_hi), hi));
+  return _mm256_and_si256(term, _mm256_set1_epi32(0x00ffffff));
+}
+
+static SEQ_AVX2_FUNC void do_add_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m256i fac_v = _mm256_set1_epi16((short)fac1);
+
+    for (; i + 8 <= x; i += 8) {
+      const __m256i rt1 = _mm256_loadu_si256((const __m256i *)(rect1 + i * 4));
+      const __m256i rt2 = _mm256_loadu_si256((const __m256i *)(rect2 + i * 4));
+      _mm256_storeu_si256((__m256i *)(out + i * 4),
+                          _mm256_adds_epu8(rt1, seq_avx2_add_sub_term(fac_v, rt2)));
+    }
+  }
+
+  if (i < x) {
+    do_add_effect_row_byte_sse2(fac, x - i, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_add_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac_inv = _mm256_set1_ps(1.0f - fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = _mm256_loadu_ps(rect1);
+    const __m256 rt2 = _mm256_loadu_ps(rect2);
+    const __m256 m = _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(seq_avx2_splat_alpha(rt1), fac_inv)),
+        seq_avx2_splat_alpha(rt2));
+    const __m256 color = _mm256_add_ps(rt1, _mm256_mul_ps(m, rt2));
+    _mm256_storeu_ps(out, seq_avx2_select_alpha(color, rt1));
+  }
+
+  if (i < x) {
+    do_add_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_add_effect(const SeqRenderData *context,
                           Sequence *UNUSED(seq),
                           float UNUSED(cfra),
@@ -1135,6 +2072,22 @@ static void do_add_effect(const SeqRenderData *context,
                           int total_lines,
                           ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(add);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -1258,6 +2211,93 @@ static void do_sub_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+static void do_sub_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m128i fac_v = _mm_set1_epi16((short)fac1);
+
+    for (; i + 4 <= x; i += 4) {
+      const __m128i rt1 = _mm_loadu_si128((const __m128i *)(rect1 + i * 4));
+      const __m128i rt2 = _mm_loadu_si128((const __m128i *)(rect2 + i * 4));
+      _mm_storeu_si128((__m128i *)(out + i * 4),
+                       _mm_subs_epu8(rt1, seq_sse_add_sub_term(fac_v, rt2)));
+    }
+  }
+
+  if (i < x) {
+    do_sub_effect_byte(fac, fac, x - i, 1, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static void do_sub_effect_row_float_sse2(float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const float fac_inv = 1.0f - fac;
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const float m = (1.0f - (rect1[3] * fac_inv)) * rect2[3];
+    const __m128 rt1 = _mm_loadu_ps(rect1);
+    __m128 color = _mm_sub_ps(rt1, _mm_mul_ps(_mm_set1_ps(m), _mm_loadu_ps(rect2)));
+    color = _mm_max_ps(color, _mm_setzero_ps());
+    _mm_storeu_ps(out, seq_sse_select_alpha(color, rt1));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+static SEQ_AVX2_FUNC void do_sub_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m256i fac_v = _mm256_set1_epi16((short)fac1);
+
+    for (; i + 8 <= x; i += 8) {
+      const __m256i rt1 = _mm256_loadu_si256((const __m256i *)(rect1 + i * 4));
+      const __m256i rt2 = _mm256_loadu_si256((const __m256i *)(rect2 + i * 4));
+      _mm256_storeu_si256((__m256i *)(out + i * 4),
+                          _mm256_subs_epu8(rt1, seq_avx2_add_sub_term(fac_v, rt2)));
+    }
+  }
+
+  if (i < x) {
+    do_sub_effect_row_byte_sse2(fac, x - i, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_sub_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac_inv = _mm256_set1_ps(1.0f - fac);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = _mm256_loadu_ps(rect1);
+    const __m256 rt2 = _mm256_loadu_ps(rect2);
+    const __m256 m = _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(seq_avx2_splat_alpha(rt1), fac_inv)),
+        seq_avx2_splat_alpha(rt2));
+    __m256 color = _mm256_sub_ps(rt1, _mm256_mul_ps(m, rt2));
+    color = _mm256_max_ps(color, _mm256_setzero_ps());
+    _mm256_storeu_ps(out, seq_avx2_select_alpha(color, rt1));
+  }
+
+  if (i < x) {
+    do_sub_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_sub_effect(const SeqRenderData *context,
                           Sequence *UNUSED(seq),
                           float UNUSED(cfra),
@@ -1270,6 +2310,22 @@ static void do_sub_effect(const SeqRenderData *context,
                           int total_lines,
                           ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(sub);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            out->rect_float ? facf1 : facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
@@ -1509,6 +2565,122 @@ static void do_mul_effect_float(
   }
 }
 
+#ifdef __SSE2__
+
+/* rt1 + ((fac * rt1 * (rt2 - 255)) >> 16) for eight channels in 16 bits. The shifted term is
+ * minus the rounded up quotient of fac * rt1 * (255 - rt2), which is never larger than rt1. */
+BLI_INLINE __m128i seq_sse_mul_channels(__m128i fac_v, __m128i rt1, __m128i rt2)
+{
+  const __m128i scaled = _mm_mullo_epi16(fac_v, rt1);
+  const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), rt2);
+  const __m128i hi = _mm_mulhi_epu16(scaled, inv);
+  const __m128i lo_zero = _mm_cmpeq_epi16(_mm_mullo_epi16(scaled, inv), _mm_setzero_si128());
+  const __m128i quotient = _mm_add_epi16(hi, _mm_andnot_si128(lo_zero, _mm_set1_epi16(1)));
+  return _mm_sub_epi16(rt1, quotient);
+}
+
+static void do_mul_effect_row_byte_sse2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fac_v = _mm_set1_epi16((short)fac1);
+
+    for (; i + 4 <= x; i += 4) {
+      const __m128i rt1 = _mm_loadu_si128((const __m128i *)(rect1 + i * 4));
+      const __m128i rt2 = _mm_loadu_si128((const __m128i *)(rect2 + i * 4));
+      const __m128i lo = seq_sse_mul_channels(
+          fac_v, _mm_unpacklo_epi8(rt1, zero), _mm_unpacklo_epi8(rt2, zero));
+      const __m128i hi = seq_sse_mul_channels(
+          fac_v, _mm_unpackhi_epi8(rt1, zero), _mm_unpackhi_epi8(rt2, zero));
+      _mm_storeu_si128((__m128i *)(out + i * 4), _mm_packus_epi16(lo, hi));
+    }
+  }
+
+  if (i < x) {
+    do_mul_effect_byte(fac, fac, x - i, 1, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static void do_mul_effect_row_float_sse2(float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (int i = 0; i < x; i++, rect1 += 4, rect2 += 4, out += 4) {
+    const __m128 rt1 = _mm_loadu_ps(rect1);
+    const __m128 term = _mm_mul_ps(_mm_mul_ps(fac_v, rt1), _mm_sub_ps(_mm_loadu_ps(rect2), one));
+    _mm_storeu_ps(out, _mm_add_ps(rt1, term));
+  }
+}
+
+#  ifdef WITH_SEQ_EFFECT_AVX2
+
+/* Same as seq_sse_mul_channels(), for sixteen channels. */
+SEQ_AVX2_INLINE __m256i seq_avx2_mul_channels(__m256i fac_v, __m256i rt1, __m256i rt2)
+{
+  const __m256i scaled = _mm256_mullo_epi16(fac_v, rt1);
+  const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), rt2);
+  const __m256i hi = _mm256_mulhi_epu16(scaled, inv);
+  const __m256i lo_zero = _mm256_cmpeq_epi16(_mm256_mullo_epi16(scaled, inv),
+                                             _mm256_setzero_si256());
+  const __m256i quotient = _mm256_add_epi16(hi,
+                                            _mm256_andnot_si256(lo_zero, _mm256_set1_epi16(1)));
+  return _mm256_sub_epi16(rt1, quotient);
+}
+
+static SEQ_AVX2_FUNC void do_mul_effect_row_byte_avx2(
+    float fac, int x, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+{
+  const int fac1 = (int)(256.0f * fac);
+  int i = 0;
+
+  if (fac1 >= 0 && fac1 <= 256) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fac_v = _mm256_set1_epi16((short)fac1);
+
+    for (; i + 8 <= x; i += 8) {
+      const __m256i rt1 = _mm256_loadu_si256((const __m256i *)(rect1 + i * 4));
+      const __m256i rt2 = _mm256_loadu_si256((const __m256i *)(rect2 + i * 4));
+      const __m256i lo = seq_avx2_mul_channels(
+          fac_v, _mm256_unpacklo_epi8(rt1, zero), _mm256_unpacklo_epi8(rt2, zero));
+      const __m256i hi = seq_avx2_mul_channels(
+          fac_v, _mm256_unpackhi_epi8(rt1, zero), _mm256_unpackhi_epi8(rt2, zero));
+      _mm256_storeu_si256((__m256i *)(out + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+  }
+
+  if (i < x) {
+    do_mul_effect_row_byte_sse2(fac, x - i, rect1 + i * 4, rect2 + i * 4, out + i * 4);
+  }
+}
+
+static SEQ_AVX2_FUNC void do_mul_effect_row_float_avx2(
+    float fac, int x, float *rect1, float *rect2, float *out)
+{
+  const __m256 fac_v = _mm256_set1_ps(fac);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  int i = 0;
+
+  for (; i + 2 <= x; i += 2, rect1 += 8, rect2 += 8, out += 8) {
+    const __m256 rt1 = _mm256_loadu_ps(rect1);
+    const __m256 term = _mm256_mul_ps(_mm256_mul_ps(fac_v, rt1),
+                                      _mm256_sub_ps(_mm256_loadu_ps(rect2), one));
+    _mm256_storeu_ps(out, _mm256_add_ps(rt1, term));
+  }
+
+  if (i < x) {
+    do_mul_effect_row_float_sse2(fac, x - i, rect1, rect2, out);
+  }
+}
+
+#  endif /* WITH_SEQ_EFFECT_AVX2 */
+
+#endif /* __SSE2__ */
+
 static void do_mul_effect(const SeqRenderData *context,
                           Sequence *UNUSED(seq),
                           float UNUSED(cfra),
@@ -1521,6 +2693,22 @@ static void do_mul_effect(const SeqRenderData *context,
                           int total_lines,
                           ImBuf *out)
 {
+#ifdef __SSE2__
+  static const SeqEffectRowKernels kernels = SEQ_EFFECT_ROW_KERNELS(mul);
+
+  if (seq_effect_simd_apply(context,
+                            &kernels,
+                            facf0,
+                            facf1,
+                            ibuf1,
+                            ibuf2,
+                            start_line,
+                            total_lines,
+                            out)) {
+    return;
+  }
+#endif
+
   if (out->rect_float) {
     float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
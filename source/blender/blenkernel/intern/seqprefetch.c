@@ -21,12 +21,15 @@
  * \ingroup bke
  */
 
+#include <limits.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
@@ -34,6 +37,8 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -54,23 +59,73 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+/* Number of frames decode workers may run ahead of the frame being rendered. */
+#define SEQ_PREFETCH_DECODE_AHEAD 8
+
+typedef struct PrefetchDecodedFrame {
+  struct PrefetchDecodedFrame *next, *prev;
+  int cfra;
+  ImBuf *ibuf;
+} PrefetchDecodedFrame;
+
+/* Decodes the frames of one image or movie strip on its own thread, while the prefetch job
+ * renders effects and blending of earlier frames. */
+typedef struct PrefetchDecoder {
+  struct PrefetchDecoder *next, *prev;
+
+  /* Copy of the original strip, with its own movie handles. */
+  Sequence *seq;
+  TaskPool *task_pool;
+
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  /* Decoded frames in increasing order, not taken by the render yet. */
+  ListBase frames;
+  /* First frame decoded since the last reset, next frame to decode and end of the frames which
+   * may be decoded. */
+  int cfra_begin, cfra_next, cfra_end;
+  bool is_decoding;
+} PrefetchDecoder;
+
+/* One frame in flight. Every frame has its own depsgraph, so the animation of a frame can be
+ * evaluated while other frames are still rendering. */
+typedef struct PrefetchRender {
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* Context of the evaluated scene, and the same context for the original scene, which cache
+   * entries are stored with. Both have the task ID of this render, so the temp cache entries of
+   * frames in flight are kept apart. */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* Renders the frame when frames are rendered in parallel, NULL otherwise. */
+  TaskPool *task_pool;
+  int cfra;
+  bool is_rendering;
+} PrefetchRender;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
+  ListBase decoders;
+  /* Memory of the decoded frames which are not taken by the render yet. */
+  size_t decoded_memory_used;
+
+  /* Frames in flight, when there is only one the prefetch job renders it itself. */
+  PrefetchRender renders[SEQ_PREFETCH_MAX_FRAMES];
+  int num_renders;
+  ThreadMutex render_mutex;
+  ThreadCondition render_cond;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
   struct ListBase *seqbasep;
   struct ListBase *seqbasep_cpy;
 
@@ -160,12 +215,24 @@ Sequence *BKE_sequencer_prefetch_get_original_sequence(Sequence *seq, Scene *sce
   return sequencer_prefetch_get_original_sequence(seq, &ed->seqbase);
 }
 
+static PrefetchRender *seq_prefetch_render_find(PrefetchJob *pfjob, const Scene *scene_eval)
+{
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    if (pfjob->renders[i].scene_eval == scene_eval) {
+      return &pfjob->renders[i];
+    }
+  }
+  return NULL;
+}
+
 /* for cache context swapping */
 SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchRender *render = seq_prefetch_render_find(pfjob, context->scene);
 
-  return &pfjob->context;
+  BLI_assert(render != NULL);
+  return &render->context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -187,38 +254,37 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = pfjob->cfra + pfjob->num_frames_prefetched;
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchRender *render)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (render->depsgraph != NULL) {
+    DEG_graph_free(render->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  render->depsgraph = NULL;
+  render->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchRender *render, int cfra)
 {
-  DEG_evaluate_on_framechange(
-      pfjob->bmain_eval, pfjob->depsgraph, pfjob->cfra + pfjob->num_frames_prefetched);
+  DEG_evaluate_on_framechange(render->bmain_eval, render->depsgraph, cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob, PrefetchRender *render)
 {
-  Main *bmain = pfjob->bmain_eval;
+  Main *bmain = render->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  render->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(render->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph, bmain, scene, view_layer);
+  DEG_graph_build_for_render_pipeline(render->depsgraph, bmain, scene, view_layer);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(render, pfjob->cfra + pfjob->num_frames_prefetched);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  render->scene_eval = DEG_get_evaluated_scene(render->depsgraph);
+  render->scene_eval->ed->cache_flag = 0;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -275,32 +341,36 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
-                                pfjob->scene,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    PrefetchRender *render = &pfjob->renders[i];
+
+    BKE_sequencer_new_render_data(render->bmain_eval,
+                                  render->depsgraph,
+                                  render->scene_eval,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &render->context_cpy);
+    render->context_cpy.is_prefetch_render = true;
+    render->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+
+    BKE_sequencer_new_render_data(pfjob->bmain,
+                                  render->depsgraph,
+                                  pfjob->scene,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &render->context);
+    render->context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for both threads.
+     */
+    render->context.task_id = render->context_cpy.task_id;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -311,8 +381,10 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->renders[i]);
+    seq_prefetch_init_depsgraph(pfjob, &pfjob->renders[i]);
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
@@ -337,20 +409,27 @@ void BKE_sequencer_prefetch_free(Scene *scene)
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    PrefetchRender *render = &pfjob->renders[i];
+    if (render->task_pool) {
+      BLI_task_pool_free(render->task_pool);
+    }
+    seq_prefetch_free_depsgraph(render);
+    BKE_main_free(render->bmain_eval);
+  }
+  BLI_mutex_end(&pfjob->render_mutex);
+  BLI_condition_end(&pfjob->render_cond);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static bool seq_prefetch_do_skip_frame(Scene *scene)
+static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, PrefetchRender *render)
 {
-  Editing *ed = scene->ed;
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-  float cfra = pfjob->cfra + pfjob->num_frames_prefetched;
+  Editing *ed = pfjob->scene->ed;
+  float cfra = render->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = BKE_sequencer_get_shown_sequences(ed->seqbasep, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &render->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
@@ -403,20 +482,294 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
   return false;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Decode Workers
+ * \{ */
+
+/* Decoded frames are not in the sequencer cache until they are rendered, so they share its
+ * memory budget. Decoding stops when they would not fit into the cache. */
+static bool seq_prefetch_decoders_over_budget(PrefetchJob *pfjob)
+{
+  const size_t decoded_memory_used = atomic_add_and_fetch_z(&pfjob->decoded_memory_used, 0);
+  return decoded_memory_used >= BKE_sequencer_cache_get_memory_free(pfjob->scene);
+}
+
+static void seq_prefetch_decoder_frames_free(PrefetchJob *pfjob,
+                                             PrefetchDecoder *decoder,
+                                             int cfra_before)
+{
+  LISTBASE_FOREACH_MUTABLE (PrefetchDecodedFrame *, frame, &decoder->frames) {
+    if (frame->cfra >= cfra_before) {
+      break;
+    }
+    atomic_sub_and_fetch_z(&pfjob->decoded_memory_used, IMB_get_size_in_memory(frame->ibuf));
+    IMB_freeImBuf(frame->ibuf);
+    BLI_freelinkN(&decoder->frames, frame);
+  }
+}
+
+static void seq_prefetch_decode_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PrefetchJob *pfjob = BLI_task_pool_user_data(pool);
+  PrefetchDecoder *decoder = taskdata;
+
+  BLI_mutex_lock(&decoder->mutex);
+  while (decoder->cfra_next < decoder->cfra_end && !pfjob->stop &&
+         !seq_prefetch_decoders_over_budget(pfjob)) {
+    const int cfra = decoder->cfra_next;
+    BLI_mutex_unlock(&decoder->mutex);
+
+    ImBuf *ibuf = BKE_sequencer_strip_decode(&pfjob->renders[0].context, decoder->seq, cfra);
+
+    BLI_mutex_lock(&decoder->mutex);
+    if (ibuf) {
+      atomic_add_and_fetch_z(&pfjob->decoded_memory_used, IMB_get_size_in_memory(ibuf));
+      PrefetchDecodedFrame *frame = MEM_callocN(sizeof(PrefetchDecodedFrame), __func__);
+      frame->cfra = cfra;
+      frame->ibuf = ibuf;
+      BLI_addtail(&decoder->frames, frame);
+    }
+    decoder->cfra_next = cfra + 1;
+    BLI_condition_notify_all(&decoder->cond);
+  }
+  decoder->is_decoding = false;
+  BLI_condition_notify_all(&decoder->cond);
+  BLI_mutex_unlock(&decoder->mutex);
+}
+
+/* Create decode workers for the strips in the prefetched area, every strip gets its own thread
+ * so that movies are decoded sequentially and in parallel to each other.
+ *
+ * Workers only pay off on threads which are left over by the main thread and the frames in
+ * flight, otherwise they compete with rendering and prefetching gets slower than rendering
+ * frames one by one. Strips without a worker are decoded by the prefetch job as before. */
+static void seq_prefetch_decoders_init(PrefetchJob *pfjob)
+{
+  Editing *ed = pfjob->scene->ed;
+  int num_spare_threads = BLI_system_thread_count() - 1 - pfjob->num_renders;
+
+  LISTBASE_FOREACH (Sequence *, seq, ed->seqbasep) {
+    if (num_spare_threads <= 0) {
+      break;
+    }
+    if ((seq->flag & SEQ_MUTE) || seq->enddisp <= pfjob->cfra ||
+        seq->startdisp > pfjob->scene->r.efra ||
+        !BKE_sequencer_strip_can_decode(&pfjob->renders[0].context, seq)) {
+      continue;
+    }
+
+    PrefetchDecoder *decoder = MEM_callocN(sizeof(PrefetchDecoder), "PrefetchDecoder");
+    decoder->seq = MEM_dupallocN(seq);
+    BLI_listbase_clear(&decoder->seq->anims);
+    decoder->task_pool = BLI_task_pool_create_background_serial(pfjob, TASK_PRIORITY_LOW);
+    BLI_mutex_init(&decoder->mutex);
+    BLI_condition_init(&decoder->cond);
+    decoder->cfra_begin = decoder->cfra_next = max_ii(pfjob->cfra, seq->startdisp);
+    BLI_addtail(&pfjob->decoders, decoder);
+    num_spare_threads--;
+  }
+}
+
+static void seq_prefetch_decoders_free(PrefetchJob *pfjob)
+{
+  LISTBASE_FOREACH (PrefetchDecoder *, decoder, &pfjob->decoders) {
+    BLI_mutex_lock(&decoder->mutex);
+    decoder->cfra_end = decoder->cfra_next;
+    BLI_mutex_unlock(&decoder->mutex);
+  }
+
+  LISTBASE_FOREACH_MUTABLE (PrefetchDecoder *, decoder, &pfjob->decoders) {
+    BLI_task_pool_work_and_wait(decoder->task_pool);
+    BLI_task_pool_free(decoder->task_pool);
+    seq_prefetch_decoder_frames_free(pfjob, decoder, INT_MAX);
+    BLI_mutex_end(&decoder->mutex);
+    BLI_condition_end(&decoder->cond);
+    BKE_sequence_free_anim(decoder->seq);
+    MEM_freeN(decoder->seq);
+    MEM_freeN(decoder);
+  }
+  BLI_listbase_clear(&pfjob->decoders);
+}
+
+/* Let decode workers continue up to a few frames after the frame about to be rendered.
+ * Decoded frames before `cfra_first`, the first frame which is still rendering, are freed. */
+static void seq_prefetch_decoders_update(PrefetchJob *pfjob, int cfra_first, int cfra)
+{
+  const bool is_over_budget = seq_prefetch_decoders_over_budget(pfjob);
+
+  LISTBASE_FOREACH (PrefetchDecoder *, decoder, &pfjob->decoders) {
+    Sequence *seq = decoder->seq;
+
+    const int cfra_start = max_ii(cfra_first, seq->startdisp);
+
+    BLI_mutex_lock(&decoder->mutex);
+    if (cfra_start < decoder->cfra_begin || cfra_start > decoder->cfra_next) {
+      /* The prefetched area moved, continue decoding from the new frame. */
+      if (decoder->is_decoding) {
+        decoder->cfra_end = decoder->cfra_next;
+        BLI_mutex_unlock(&decoder->mutex);
+        continue;
+      }
+      seq_prefetch_decoder_frames_free(pfjob, decoder, INT_MAX);
+      decoder->cfra_begin = decoder->cfra_next = cfra_start;
+    }
+    else {
+      seq_prefetch_decoder_frames_free(pfjob, decoder, cfra_first);
+    }
+
+    decoder->cfra_end = min_iii(
+        cfra + SEQ_PREFETCH_DECODE_AHEAD, seq->enddisp, pfjob->scene->r.efra + 1);
+
+    if (!decoder->is_decoding && !is_over_budget && decoder->cfra_next < decoder->cfra_end) {
+      decoder->is_decoding = true;
+      BLI_task_pool_push(decoder->task_pool, seq_prefetch_decode_task, decoder, false, NULL);
+    }
+    BLI_mutex_unlock(&decoder->mutex);
+  }
+}
+
+/* Take the frame of a strip from its decode worker, waiting for it when it is being decoded.
+ * Returns NULL when the frame is not handled by a decode worker. */
+ImBuf *BKE_sequencer_prefetch_decoded_ibuf_get(const SeqRenderData *context,
+                                               Sequence *seq,
+                                               float cfra)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchDecoder *decoder = NULL;
+  ImBuf *ibuf = NULL;
+
+  /* Strips of other scenes may have the same name. */
+  if (pfjob == NULL || seq_prefetch_render_find(pfjob, context->scene) == NULL ||
+      cfra != floorf(cfra)) {
+    return NULL;
+  }
+
+  LISTBASE_FOREACH (PrefetchDecoder *, decoder_iter, &pfjob->decoders) {
+    if (STREQ(decoder_iter->seq->name, seq->name)) {
+      decoder = decoder_iter;
+      break;
+    }
+  }
+
+  if (decoder == NULL) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(&decoder->mutex);
+  while (decoder->is_decoding && cfra >= decoder->cfra_next && cfra < decoder->cfra_end) {
+    BLI_condition_wait(&decoder->cond, &decoder->mutex);
+  }
+
+  /* Frames in flight do not finish in order, so the frame is not necessarily the first one. */
+  LISTBASE_FOREACH (PrefetchDecodedFrame *, frame, &decoder->frames) {
+    if (frame->cfra == (int)cfra) {
+      ibuf = frame->ibuf;
+      atomic_sub_and_fetch_z(&pfjob->decoded_memory_used, IMB_get_size_in_memory(ibuf));
+      BLI_freelinkN(&decoder->frames, frame);
+      break;
+    }
+  }
+  BLI_mutex_unlock(&decoder->mutex);
+  return ibuf;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Frames in Flight
+ *
+ * When there are enough threads, several frames are rendered at the same time. The prefetch job
+ * evaluates the animation of a frame with a free render, and hands the frame over to the task
+ * pool of that render.
+ * \{ */
+
+static void seq_prefetch_render_frame(PrefetchJob *pfjob, PrefetchRender *render)
+{
+  ImBuf *ibuf = BKE_sequencer_give_ibuf(&render->context_cpy, render->cfra, 0);
+  BKE_sequencer_cache_free_temp_cache(pfjob->scene, render->context.task_id, render->cfra);
+  IMB_freeImBuf(ibuf);
+}
+
+static void seq_prefetch_render_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PrefetchJob *pfjob = BLI_task_pool_user_data(pool);
+  PrefetchRender *render = taskdata;
+
+  seq_prefetch_render_frame(pfjob, render);
+
+  BLI_mutex_lock(&pfjob->render_mutex);
+  render->is_rendering = false;
+  BLI_condition_notify_all(&pfjob->render_cond);
+  BLI_mutex_unlock(&pfjob->render_mutex);
+}
+
+/* Wait until a render is free. */
+static PrefetchRender *seq_prefetch_render_get_free(PrefetchJob *pfjob)
+{
+  BLI_mutex_lock(&pfjob->render_mutex);
+  for (;;) {
+    for (int i = 0; i < pfjob->num_renders; i++) {
+      if (!pfjob->renders[i].is_rendering) {
+        BLI_mutex_unlock(&pfjob->render_mutex);
+        return &pfjob->renders[i];
+      }
+    }
+    BLI_condition_wait(&pfjob->render_cond, &pfjob->render_mutex);
+  }
+}
+
+/* First frame which is still rendering, `cfra` when there is none before it. */
+static int seq_prefetch_render_cfra_first(PrefetchJob *pfjob, int cfra)
+{
+  BLI_mutex_lock(&pfjob->render_mutex);
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    if (pfjob->renders[i].is_rendering) {
+      cfra = min_ii(cfra, pfjob->renders[i].cfra);
+    }
+  }
+  BLI_mutex_unlock(&pfjob->render_mutex);
+  return cfra;
+}
+
+static void seq_prefetch_render_start(PrefetchJob *pfjob, PrefetchRender *render)
+{
+  if (render->task_pool == NULL) {
+    seq_prefetch_render_frame(pfjob, render);
+    return;
+  }
+
+  BLI_mutex_lock(&pfjob->render_mutex);
+  render->is_rendering = true;
+  BLI_mutex_unlock(&pfjob->render_mutex);
+  BLI_task_pool_push(render->task_pool, seq_prefetch_render_task, render, false, NULL);
+}
+
+static void seq_prefetch_render_wait_all(PrefetchJob *pfjob)
+{
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    if (pfjob->renders[i].task_pool) {
+      BLI_task_pool_work_and_wait(pfjob->renders[i].task_pool);
+    }
+  }
+}
+
+/** \} */
+
 static void *seq_prefetch_frames(void *job)
 {
   PrefetchJob *pfjob = (PrefetchJob *)job;
 
+  seq_prefetch_decoders_init(pfjob);
+
   while (pfjob->cfra + pfjob->num_frames_prefetched <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+    PrefetchRender *render = seq_prefetch_render_get_free(pfjob);
+    render->cfra = pfjob->cfra + pfjob->num_frames_prefetched;
+    render->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    BKE_animsys_evaluate_animdata(&pfjob->context_cpy.scene->id,
-                                  adt,
-                                  pfjob->cfra + pfjob->num_frames_prefetched,
-                                  ADT_RECALC_ALL,
-                                  false);
+    seq_prefetch_update_depsgraph(render, render->cfra);
+    AnimData *adt = BKE_animdata_from_id(&render->context_cpy.scene->id);
+    BKE_animsys_evaluate_animdata(
+        &render->context_cpy.scene->id, adt, render->cfra, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -424,18 +777,16 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    render->scene_eval->ed->prefetch_job = pfjob;
 
-    if (seq_prefetch_do_skip_frame(pfjob->scene)) {
+    if (seq_prefetch_do_skip_frame(pfjob, render)) {
       pfjob->num_frames_prefetched++;
       continue;
     }
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(
-        &pfjob->context_cpy, pfjob->cfra + pfjob->num_frames_prefetched, 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
-    IMB_freeImBuf(ibuf);
+    seq_prefetch_decoders_update(
+        pfjob, seq_prefetch_render_cfra_first(pfjob, render->cfra), render->cfra);
+    seq_prefetch_render_start(pfjob, render);
 
     /* suspend thread */
     BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
@@ -462,10 +813,17 @@ static void *seq_prefetch_frames(void *job)
     pfjob->num_frames_prefetched++;
   }
 
-  BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
+  seq_prefetch_render_wait_all(pfjob);
+  seq_prefetch_decoders_free(pfjob);
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene,
+                                        pfjob->renders[i].context.task_id,
+                                        pfjob->cfra + pfjob->num_frames_prefetched);
+  }
   pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  for (int i = 0; i < pfjob->num_renders; i++) {
+    pfjob->renders[i].scene_eval->ed->prefetch_job = NULL;
+  }
 
   return 0;
 }
@@ -484,10 +842,23 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
       pfjob->bmain = context->bmain;
-      pfjob->bmain_eval = BKE_main_new();
-
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+
+      /* Frames in flight share the threads left over by the main thread with the decode
+       * workers and the threading inside of effects, so they get about half of them. */
+      pfjob->num_renders = clamp_i(
+          (BLI_system_thread_count() - 1) / 2, 1, SEQ_PREFETCH_MAX_FRAMES);
+      BLI_mutex_init(&pfjob->render_mutex);
+      BLI_condition_init(&pfjob->render_cond);
+
+      for (int i = 0; i < pfjob->num_renders; i++) {
+        PrefetchRender *render = &pfjob->renders[i];
+        render->bmain_eval = BKE_main_new();
+        if (pfjob->num_renders > 1) {
+          render->task_pool = BLI_task_pool_create_background_serial(pfjob, TASK_PRIORITY_LOW);
+        }
+        seq_prefetch_init_depsgraph(pfjob, render);
+      }
     }
   }
   seq_prefetch_update_scene(context->scene);
@@ -31,6 +31,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_mask_types.h"
 #include "DNA_movieclip_types.h"
@@ -39,6 +41,7 @@
 #include "DNA_sequence_types.h"
 #include "DNA_sound_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_fileops.h"
@@ -51,6 +54,8 @@
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "PIL_time.h"
+
 #ifdef WIN32
 #  include "BLI_winstuff.h"
 #else
@@ -125,7 +130,11 @@ static ImBuf *seq_render_mask(const SeqRenderData *context, Mask *mask, float nr
 static int seq_num_files(Scene *scene, char views_format, const bool is_multiview);
 static void seq_anim_add_suffix(Scene *scene, struct anim *anim, const int view_id);
 
-static ThreadMutex seq_render_mutex = BLI_MUTEX_INITIALIZER;
+/* Frames rendered by prefetching may be rendered at the same time, other renders run alone.
+ * Renders which run alone wait for the write lock while holding the gate, so renders running at
+ * the same time can not keep them waiting forever. */
+static ThreadRWMutex seq_render_mutex = BLI_RWLOCK_INITIALIZER;
+static ThreadMutex seq_render_gate = BLI_MUTEX_INITIALIZER;
 
 /* **** XXX ******** */
 #define SELECT 1
@@ -1596,6 +1605,9 @@ typedef struct SeqIndexBuildContext {
   Depsgraph *depsgraph;
   Scene *scene;
   Sequence *seq, *orig_seq;
+
+  /* Progress of building this context, when the queue is built in threads. */
+  float progress;
 } SeqIndexBuildContext;
 
 #define PROXY_MAXFILE (2 * FILE_MAXDIR + FILE_MAXFILE)
@@ -1967,41 +1979,28 @@ static ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int c
   }
 }
 
-static void seq_proxy_build_frame(const SeqRenderData *context,
-                                  SeqRenderState *state,
-                                  Sequence *seq,
-                                  int cfra,
-                                  int proxy_render_size,
-                                  const bool overwrite)
+static void seq_proxy_write_frame(Sequence *seq,
+                                  ImBuf *ibuf_src,
+                                  const char *name,
+                                  int proxy_render_size)
 {
-  char name[PROXY_MAXFILE];
   int quality;
   int rectx, recty;
   int ok;
-  ImBuf *ibuf_tmp, *ibuf;
-  Editing *ed = context->scene->ed;
-
-  if (!seq_proxy_get_fname(ed, seq, cfra, proxy_render_size, name, context->view_id)) {
-    return;
-  }
-
-  if (!overwrite && BLI_exists(name)) {
-    return;
-  }
-
-  ibuf_tmp = seq_render_strip(context, state, seq, cfra);
+  ImBuf *ibuf;
 
-  rectx = (proxy_render_size * ibuf_tmp->x) / 100;
-  recty = (proxy_render_size * ibuf_tmp->y) / 100;
+  rectx = (proxy_render_size * ibuf_src->x) / 100;
+  recty = (proxy_render_size * ibuf_src->y) / 100;
 
-  if (ibuf_tmp->x != rectx || ibuf_tmp->y != recty) {
-    ibuf = IMB_dupImBuf(ibuf_tmp);
-    IMB_metadata_copy(ibuf, ibuf_tmp);
-    IMB_freeImBuf(ibuf_tmp);
-    IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+  if (ibuf_src->x != rectx || ibuf_src->y != recty) {
+    ibuf = IMB_dupImBuf(ibuf_src);
+    IMB_metadata_copy(ibuf, ibuf_src);
+    IMB_scaleImBuf_threaded(ibuf, (short)rectx, (short)recty);
   }
   else {
-    ibuf = ibuf_tmp;
+    /* Full size is written last, the source is not needed anymore. */
+    ibuf = ibuf_src;
+    IMB_refImBuf(ibuf);
   }
 
   /* depth = 32 is intentionally left in, otherwise ALPHA channels
@@ -2025,6 +2024,48 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
   IMB_freeImBuf(ibuf);
 }
 
+/* Render the strip once and write all proxy sizes of size_flags from it. */
+static void seq_proxy_build_frame(const SeqRenderData *context,
+                                  SeqRenderState *state,
+                                  Sequence *seq,
+                                  int cfra,
+                                  int size_flags,
+                                  const bool overwrite)
+{
+  const int proxy_flags[] = {IMB_PROXY_25, IMB_PROXY_50, IMB_PROXY_75, IMB_PROXY_100};
+  const int proxy_render_sizes[] = {25, 50, 75, 100};
+  char names[ARRAY_SIZE(proxy_flags)][PROXY_MAXFILE];
+  bool build[ARRAY_SIZE(proxy_flags)];
+  bool build_any = false;
+  Editing *ed = context->scene->ed;
+  ImBuf *ibuf;
+
+  for (int i = 0; i < ARRAY_SIZE(proxy_flags); i++) {
+    build[i] = (size_flags & proxy_flags[i]) &&
+               seq_proxy_get_fname(
+                   ed, seq, cfra, proxy_render_sizes[i], names[i], context->view_id) &&
+               (overwrite || !BLI_exists(names[i]));
+    build_any |= build[i];
+  }
+
+  if (!build_any) {
+    return;
+  }
+
+  ibuf = seq_render_strip(context, state, seq, cfra);
+  if (ibuf == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < ARRAY_SIZE(proxy_flags); i++) {
+    if (build[i]) {
+      seq_proxy_write_frame(seq, ibuf, names[i], proxy_render_sizes[i]);
+    }
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
 /**
  * Returns whether the file this context would read from even exist,
  * if not, don't create the context
@@ -2222,18 +2263,7 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context,
   sequencer_state_init(&state);
 
   for (cfra = seq->startdisp + seq->startstill; cfra < seq->enddisp - seq->endstill; cfra++) {
-    if (context->size_flags & IMB_PROXY_25) {
-      seq_proxy_build_frame(&render_context, &state, seq, cfra, 25, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_50) {
-      seq_proxy_build_frame(&render_context, &state, seq, cfra, 50, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_75) {
-      seq_proxy_build_frame(&render_context, &state, seq, cfra, 75, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_100) {
-      seq_proxy_build_frame(&render_context, &state, seq, cfra, 100, overwrite);
-    }
+    seq_proxy_build_frame(&render_context, &state, seq, cfra, context->size_flags, overwrite);
 
     *progress = (float)(cfra - seq->startdisp - seq->startstill) /
                 (seq->enddisp - seq->endstill - seq->startdisp - seq->startstill);
@@ -2266,6 +2296,127 @@ void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop
   MEM_freeN(context);
 }
 
+typedef struct SeqProxyBuildQueue {
+  ThreadQueue *contexts;
+  short *stop;
+  int num_running;
+} SeqProxyBuildQueue;
+
+static void *seq_proxy_build_thread(void *data)
+{
+  SeqProxyBuildQueue *build_queue = data;
+  SeqIndexBuildContext *context;
+
+  while (!*build_queue->stop && (context = BLI_thread_queue_pop(build_queue->contexts))) {
+    short do_update;
+    BKE_sequencer_proxy_rebuild(context, build_queue->stop, &do_update, &context->progress);
+    context->progress = 1.0f;
+  }
+
+  atomic_sub_and_fetch_int32(&build_queue->num_running, 1);
+  return NULL;
+}
+
+/* Number of strips to build at the same time, zero in preferences means one per thread. */
+static int seq_proxy_build_threads_num(int num_contexts)
+{
+  int num_threads = U.sequencer_proxy_build_threads;
+
+  if (num_threads <= 0) {
+    num_threads = BLI_system_thread_count();
+  }
+
+  return min_ii(num_threads, num_contexts);
+}
+
+/* Build the contexts from link_first to link_last. */
+static void seq_proxy_rebuild_links(LinkData *link_first,
+                                    LinkData *link_last,
+                                    short *stop,
+                                    short *do_update,
+                                    float *progress)
+{
+  LinkData *link_end = link_last->next;
+  LinkData *link;
+  int num_contexts = 0;
+  int i = 0;
+
+  for (link = link_first; link != link_end; link = link->next) {
+    num_contexts++;
+  }
+
+  const int num_threads = seq_proxy_build_threads_num(num_contexts);
+
+  if (num_threads <= 1) {
+    for (link = link_first; link != link_end; link = link->next) {
+      BKE_sequencer_proxy_rebuild(link->data, stop, do_update, progress);
+
+      if (*stop) {
+        return;
+      }
+    }
+    *progress = 1.0f;
+    *do_update = true;
+    return;
+  }
+
+  SeqProxyBuildQueue build_queue;
+  ListBase threads;
+
+  build_queue.contexts = BLI_thread_queue_init();
+  build_queue.stop = stop;
+  build_queue.num_running = num_threads;
+
+  for (link = link_first; link != link_end; link = link->next) {
+    SeqIndexBuildContext *context = link->data;
+    context->progress = 0.0f;
+    BLI_thread_queue_push(build_queue.contexts, context);
+  }
+  /* Threads exit when the queue is empty. */
+  BLI_thread_queue_nowait(build_queue.contexts);
+
+  BLI_threadpool_init(&threads, seq_proxy_build_thread, num_threads);
+  for (i = 0; i < num_threads; i++) {
+    BLI_threadpool_insert(&threads, &build_queue);
+  }
+
+  while (atomic_add_and_fetch_int32(&build_queue.num_running, 0) > 0) {
+    float total_progress = 0.0f;
+    for (link = link_first; link != link_end; link = link->next) {
+      total_progress += ((SeqIndexBuildContext *)link->data)->progress;
+    }
+    *progress = total_progress / num_contexts;
+    *do_update = true;
+
+    PIL_sleep_ms(10);
+  }
+
+  BLI_threadpool_end(&threads);
+  BLI_thread_queue_free(build_queue.contexts);
+
+  *progress = 1.0f;
+  *do_update = true;
+}
+
+/**
+ * Build proxies and time-code indices of all contexts in \a queue (#LinkData of
+ * #SeqIndexBuildContext), several strips are built at the same time.
+ */
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue,
+                                       short *stop,
+                                       short *do_update,
+                                       float *progress)
+{
+  LinkData *link_first = queue->first;
+
+  /* Strips can be added to the queue of a running job, build them after the others. */
+  while (link_first && !*stop) {
+    LinkData *link_last = queue->last;
+    seq_proxy_rebuild_links(link_first, link_last, stop, do_update, progress);
+    link_first = link_last->next;
+  }
+}
+
 void BKE_sequencer_proxy_set(struct Sequence *seq, bool value)
 {
   if (value) {
@@ -3786,6 +3937,51 @@ static ImBuf *do_render_strip_uncached(const SeqRenderData *context,
   return ibuf;
 }
 
+/**
+ * Check whether the raw frames of the strip can be decoded with #BKE_sequencer_strip_decode.
+ * This is the case for single view image and movie strips which don't display proxies.
+ */
+bool BKE_sequencer_strip_can_decode(const SeqRenderData *context, Sequence *seq)
+{
+  const IMB_Proxy_Size psize = seq_rendersize_to_proxysize(context->preview_render_size);
+
+  if (!ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE)) {
+    return false;
+  }
+  if ((seq->flag & SEQ_USE_VIEWS) != 0 && (context->scene->r.scemode & R_MULTIVIEW) != 0) {
+    return false;
+  }
+  if ((seq->flag & SEQ_USE_PROXY) != 0 && psize != IMB_PROXY_NONE &&
+      (seq->strip->proxy->build_size_flags & psize) != 0) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Decode the raw frame of a strip accepted by #BKE_sequencer_strip_can_decode, without going
+ * through the cache. Movies are read with the animation handles of \a seq, so decoding from
+ * another thread than the one rendering needs a copy of the strip with its own handles.
+ */
+ImBuf *BKE_sequencer_strip_decode(const SeqRenderData *context, Sequence *seq, float cfra)
+{
+  ImBuf *ibuf = NULL;
+  float nr = BKE_sequencer_give_stripelem_index(seq, cfra);
+
+  if (seq->type == SEQ_TYPE_IMAGE) {
+    ibuf = seq_render_image_strip(context, seq, nr, cfra);
+  }
+  else if (seq->type == SEQ_TYPE_MOVIE) {
+    ibuf = seq_render_movie_strip(context, seq, nr, cfra);
+  }
+
+  if (ibuf) {
+    sequencer_imbuf_assign_spaces(context->scene, ibuf);
+  }
+
+  return ibuf;
+}
+
 /* Estimate time spent by the program rendering the strip */
 static clock_t seq_estimate_render_cost_begin(void)
 {
@@ -3861,6 +4057,11 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
         is_proxy_image = (ibuf != NULL);
       }
 
+      if (ibuf == NULL && context->is_prefetch_render) {
+        /* Decoded ahead of time by a prefetch worker. */
+        ibuf = BKE_sequencer_prefetch_decoded_ibuf_get(context, seq, cfra);
+      }
+
       if (ibuf == NULL) {
         ibuf = do_render_strip_uncached(context, state, seq, cfra);
       }
@@ -4045,6 +4246,41 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
   return out;
 }
 
+static void seq_render_lock(bool exclusive)
+{
+  BLI_mutex_lock(&seq_render_gate);
+  BLI_rw_mutex_lock(&seq_render_mutex, exclusive ? THREAD_LOCK_WRITE : THREAD_LOCK_READ);
+  BLI_mutex_unlock(&seq_render_gate);
+}
+
+static void seq_render_unlock(void)
+{
+  BLI_rw_mutex_unlock(&seq_render_mutex);
+}
+
+/* Scene, clip, mask and text strips use data shared by all copies of the scene, like the render
+ * of other scenes, movie caches and fonts. Frames showing them are not rendered in parallel. */
+static bool seq_render_is_parallel_safe(ListBase *seqbase, float cfra)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbase) {
+    if (seq->startdisp > cfra || seq->enddisp <= cfra) {
+      continue;
+    }
+    if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK, SEQ_TYPE_TEXT)) {
+      return false;
+    }
+    if (seq->type == SEQ_TYPE_META && !seq_render_is_parallel_safe(&seq->seqbase, cfra)) {
+      return false;
+    }
+    LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+      if (smd->mask_id) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 /*
  * returned ImBuf is refed!
  * you have to free after usage!
@@ -4088,7 +4324,8 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
   float cost = 0;
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    seq_render_lock(!context->is_prefetch_render ||
+                    !seq_render_is_parallel_safe(seqbasep, cfra));
     out = seq_render_strip_stack(context, &state, seqbasep, cfra, chanshown);
     cost = seq_estimate_render_cost_end(context->scene, begin);
 
@@ -4100,7 +4337,7 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
       BKE_sequencer_cache_put_if_possible(
           context, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, out, cost, false);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    seq_render_unlock();
   }
 
   BKE_sequencer_prefetch_start(context, cfra, cost);
@@ -37,6 +37,7 @@
 #  endif
 
 #  include "BLI_math_base.h"
+#  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_global.h"
@@ -50,6 +51,10 @@
 
 #  include "IMB_imbuf.h"
 
+#  include "PIL_time.h"
+
+#  include "atomic_ops.h"
+
 /* This needs to be included after BLI_math_base.h otherwise it will redefine some math defines
  * like M_SQRT1_2 leading to warnings with MSVC */
 #  include <libavcodec/avcodec.h>
@@ -63,6 +68,15 @@
 
 struct StampData;
 
+/* Frames handed over from the render thread to the encode thread. */
+#  define FFMPEG_ENCODE_QUEUE_SIZE 4
+
+typedef struct FFMpegEncodeFrame {
+  AVFrame *frame; /* Image frame in Blender's own pixel format. */
+  int pts;
+  double audio_time; /* Audio is written up to this time along with the frame. */
+} FFMpegEncodeFrame;
+
 typedef struct FFMpegContext {
   int ffmpeg_type;
   int ffmpeg_codec;
@@ -81,12 +95,20 @@ typedef struct FFMpegContext {
   AVFormatContext *outfile;
   AVStream *video_stream;
   AVStream *audio_stream;
-  AVFrame *current_frame; /* Image frame in output pixel format. */
-
-  /* Image frame in Blender's own pixel format, may need conversion to the output pixel format. */
-  AVFrame *img_convert_frame;
+  AVFrame *current_frame; /* Image frame in output pixel format, when conversion is needed. */
   struct SwsContext *img_convert_ctx;
 
+  /* Pixel format conversion, encoding and muxing run on a separate thread, so rendering the
+   * next frame does not wait for the encoder. The render thread takes frames from free_queue,
+   * which blocks while all frames are waiting in encode_queue. */
+  ListBase encode_thread;
+  ThreadQueue *encode_queue;
+  ThreadQueue *free_queue;
+  FFMpegEncodeFrame encode_frames[FFMPEG_ENCODE_QUEUE_SIZE];
+  int32_t encode_error;      /* Set by the encode thread, atomic access. */
+  int32_t autosplit_pending; /* Set by the encode thread, atomic access. */
+  double encode_wait_time;   /* Time the render thread waited for a free frame. */
+
   uint8_t *audio_input_buffer;
   uint8_t *audio_deinterleave_buffer;
   int audio_input_samples;
@@ -114,6 +136,7 @@ typedef struct FFMpegContext {
 static void ffmpeg_dict_set_int(AVDictionary **dict, const char *key, int value);
 static void ffmpeg_dict_set_float(AVDictionary **dict, const char *key, float value);
 static void ffmpeg_set_expert_options(RenderData *rd);
+static void ffmpeg_encode_thread_start(FFMpegContext *context);
 static void ffmpeg_filepath_get(FFMpegContext *context,
                                 char *string,
                                 const struct RenderData *rd,
@@ -339,9 +362,8 @@ static const char **get_file_extensions(int format)
   }
 }
 
-/* Write a frame to the output file */
-static int write_video_frame(
-    FFMpegContext *context, const RenderData *rd, int cfra, AVFrame *frame, ReportList *reports)
+/* Write a frame to the output file, called from the encode thread */
+static int write_video_frame(FFMpegContext *context, int cfra, AVFrame *frame)
 {
   int got_output;
   int ret, success = 1;
@@ -378,30 +400,15 @@ static int write_video_frame(
     success = 0;
   }
 
-  if (!success) {
-    BKE_report(reports, RPT_ERROR, "Error writing frame");
-  }
-
   return success;
 }
 
-/* read and encode a frame of audio from the buffer */
-static AVFrame *generate_video_frame(FFMpegContext *context,
-                                     const uint8_t *pixels,
-                                     ReportList *reports)
+/* Copy the rendered pixels into a frame in Blender's own pixel format, called from the render
+ * thread. This is the only copy of the pixels, the frame is then handed to the encode thread. */
+static void fill_video_frame(FFMpegContext *context, const uint8_t *pixels, AVFrame *rgb_frame)
 {
   AVCodecContext *c = context->video_stream->codec;
   int height = c->height;
-  AVFrame *rgb_frame;
-
-  if (context->img_convert_frame != NULL) {
-    /* Pixel format conversion is needed. */
-    rgb_frame = context->img_convert_frame;
-  }
-  else {
-    /* The output pixel format is Blender's internal pixel format. */
-    rgb_frame = context->current_frame;
-  }
 
   /* Copy the Blender pixels into the FFmpeg datastructure, taking care of endianness and flipping
    * the image vertically. */
@@ -428,19 +435,27 @@ static AVFrame *generate_video_frame(FFMpegContext *context,
 #    error ENDIAN_ORDER should either be L_ENDIAN or B_ENDIAN.
 #  endif
   }
+}
+
+/* Convert to the output pixel format, if it's different that Blender's internal one.
+ * Called from the encode thread. */
+static AVFrame *convert_video_frame(FFMpegContext *context, AVFrame *rgb_frame)
+{
+  AVCodecContext *c = context->video_stream->codec;
 
-  /* Convert to the output pixel format, if it's different that Blender's internal one. */
-  if (context->img_convert_frame != NULL) {
-    BLI_assert(context->img_convert_ctx != NULL);
-    sws_scale(context->img_convert_ctx,
-              (const uint8_t *const *)rgb_frame->data,
-              rgb_frame->linesize,
-              0,
-              c->height,
-              context->current_frame->data,
-              context->current_frame->linesize);
+  if (context->img_convert_ctx == NULL) {
+    /* The output pixel format is Blender's internal pixel format. */
+    return rgb_frame;
   }
 
+  sws_scale(context->img_convert_ctx,
+            (const uint8_t *const *)rgb_frame->data,
+            rgb_frame->linesize,
+            0,
+            c->height,
+            context->current_frame->data,
+            context->current_frame->linesize);
+
   return context->current_frame;
 }
 
@@ -728,17 +743,14 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
   }
   av_dict_free(&opts);
 
-  /* FFmpeg expects its data in the output pixel format. */
-  context->current_frame = alloc_picture(c->pix_fmt, c->width, c->height);
-
   if (c->pix_fmt == AV_PIX_FMT_RGBA) {
     /* Output pixel format is the same we use internally, no conversion necessary. */
-    context->img_convert_frame = NULL;
+    context->current_frame = NULL;
     context->img_convert_ctx = NULL;
   }
   else {
-    /* Output pixel format is different, allocate frame for conversion. */
-    context->img_convert_frame = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
+    /* FFmpeg expects its data in the output pixel format, allocate frame for conversion. */
+    context->current_frame = alloc_picture(c->pix_fmt, c->width, c->height);
     context->img_convert_ctx = sws_getContext(c->width,
                                               c->height,
                                               AV_PIX_FMT_RGBA,
@@ -1131,6 +1143,10 @@ static int start_ffmpeg_impl(FFMpegContext *context,
   av_dump_format(of, 0, name, 1);
   av_dict_free(&opts);
 
+  if (context->video_stream) {
+    ffmpeg_encode_thread_start(context);
+  }
+
   return 1;
 
 fail:
@@ -1360,6 +1376,85 @@ static void write_audio_frames(FFMpegContext *context, double to_pts)
 }
 #  endif
 
+static void *ffmpeg_encode_thread(void *context_v)
+{
+  FFMpegContext *context = context_v;
+  FFMpegEncodeFrame *encode_frame;
+
+  /* Returns NULL once the queue is empty and ffmpeg_encode_thread_end() was called. */
+  while ((encode_frame = BLI_thread_queue_pop(context->encode_queue))) {
+    /* After an error, frames are only given back to the render thread. */
+    if (context->encode_error == 0) {
+      AVFrame *avframe = convert_video_frame(context, encode_frame->frame);
+
+      if (!write_video_frame(context, encode_frame->pts, avframe)) {
+        atomic_fetch_and_or_int32(&context->encode_error, 1);
+      }
+
+#  ifdef WITH_AUDASPACE
+      write_audio_frames(context, encode_frame->audio_time);
+#  endif
+
+      if (context->ffmpeg_autosplit &&
+          avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
+        atomic_fetch_and_or_int32(&context->autosplit_pending, 1);
+      }
+    }
+
+    BLI_thread_queue_push(context->free_queue, encode_frame);
+  }
+
+  return NULL;
+}
+
+static void ffmpeg_encode_thread_start(FFMpegContext *context)
+{
+  AVCodecContext *c = context->video_stream->codec;
+
+  context->encode_queue = BLI_thread_queue_init();
+  context->free_queue = BLI_thread_queue_init();
+  context->encode_error = 0;
+  context->autosplit_pending = 0;
+  context->encode_wait_time = 0.0;
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    FFMpegEncodeFrame *encode_frame = &context->encode_frames[i];
+    encode_frame->frame = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
+    BLI_thread_queue_push(context->free_queue, encode_frame);
+  }
+
+  BLI_threadpool_init(&context->encode_thread, ffmpeg_encode_thread, 1);
+  BLI_threadpool_insert(&context->encode_thread, context);
+}
+
+/* Waits for all queued frames to be encoded. */
+static void ffmpeg_encode_thread_end(FFMpegContext *context)
+{
+  if (context->encode_queue == NULL) {
+    return;
+  }
+
+  BLI_thread_queue_nowait(context->encode_queue);
+  BLI_threadpool_end(&context->encode_thread);
+
+  /* Errors of the last queued frames can not be reported by BKE_ffmpeg_append() anymore. */
+  if (context->encode_error) {
+    fprintf(stderr, "Error writing frame\n");
+  }
+
+  BLI_thread_queue_free(context->encode_queue);
+  BLI_thread_queue_free(context->free_queue);
+  context->encode_queue = NULL;
+  context->free_queue = NULL;
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    delete_picture(context->encode_frames[i].frame);
+    context->encode_frames[i].frame = NULL;
+  }
+
+  PRINT("Render thread waited %fs for the encoder\n", context->encode_wait_time);
+}
+
 int BKE_ffmpeg_append(void *context_v,
                       RenderData *rd,
                       int start_frame,
@@ -1371,7 +1466,8 @@ int BKE_ffmpeg_append(void *context_v,
                       ReportList *reports)
 {
   FFMpegContext *context = context_v;
-  AVFrame *avframe;
+  const double audio_time = (frame - start_frame) /
+                            (((double)rd->frs_sec) / (double)rd->frs_sec_base);
   int success = 1;
 
   PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
@@ -1380,22 +1476,43 @@ int BKE_ffmpeg_append(void *context_v,
   //  write_audio_frames(frame / (((double)rd->frs_sec) / rd->frs_sec_base));
 
   if (context->video_stream) {
-    avframe = generate_video_frame(context, (unsigned char *)pixels, reports);
-    success = (avframe && write_video_frame(context, rd, frame - start_frame, avframe, reports));
-
-    if (context->ffmpeg_autosplit) {
-      if (avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
-        end_ffmpeg_impl(context, true);
-        context->ffmpeg_autosplit_count++;
-        success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
+    FFMpegEncodeFrame *encode_frame;
+    const double wait_start = PIL_check_seconds_timer();
+
+    /* Blocks while the encode thread is behind. */
+    encode_frame = BLI_thread_queue_pop(context->free_queue);
+    context->encode_wait_time += PIL_check_seconds_timer() - wait_start;
+
+    /* Errors of previously queued frames are reported here. */
+    if (atomic_fetch_and_or_int32(&context->encode_error, 0)) {
+      BLI_thread_queue_push(context->free_queue, encode_frame);
+      BKE_report(reports, RPT_ERROR, "Error writing frame");
+      return 0;
+    }
+
+    fill_video_frame(context, (const uint8_t *)pixels, encode_frame->frame);
+    encode_frame->pts = frame - start_frame;
+    encode_frame->audio_time = audio_time;
+    BLI_thread_queue_push(context->encode_queue, encode_frame);
+
+    if (atomic_fetch_and_or_int32(&context->autosplit_pending, 0)) {
+      end_ffmpeg_impl(context, true);
+      /* Starting the next file resets the error of the frames encoded into this one. */
+      if (context->encode_error) {
+        BKE_report(reports, RPT_ERROR, "Error writing frame");
+        return 0;
       }
+      context->ffmpeg_autosplit_count++;
+      success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
     }
   }
-
 #  ifdef WITH_AUDASPACE
-  write_audio_frames(context,
-                     (frame - start_frame) / (((double)rd->frs_sec) / (double)rd->frs_sec_base));
+  else {
+    /* Audio is written by the encode thread when there is video. */
+    write_audio_frames(context, audio_time);
+  }
 #  endif
+
   return success;
 }
 
@@ -1403,6 +1520,10 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 {
   PRINT("Closing ffmpeg...\n");
 
+  /* Encode the frames still in the queue before flushing the encoder. This has to happen
+   * before the audio device is freed, the encode thread mixes down audio for every frame. */
+  ffmpeg_encode_thread_end(context);
+
 #  ifdef WITH_AUDASPACE
   if (is_autosplit == false) {
     if (context->audio_mixdown_device) {
@@ -1439,10 +1560,6 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
     delete_picture(context->current_frame);
     context->current_frame = NULL;
   }
-  if (context->img_convert_frame != NULL) {
-    delete_picture(context->img_convert_frame);
-    context->img_convert_frame = NULL;
-  }
 
   if (context->outfile != NULL && context->outfile->oformat) {
     if (!(context->outfile->oformat->flags & AVFMT_NOFILE)) {
@@ -158,6 +158,32 @@ int BLI_cpu_support_sse41(void)
   return 0;
 }
 
+/* Also checks that the operating system saves the AVX registers. */
+int BLI_cpu_support_avx2(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int result[4];
+  __cpuid(result, 0);
+  if (result[0] < 7) {
+    return 0;
+  }
+
+  /* OSXSAVE and AVX, then the XMM and YMM state enabled by the OS. */
+  __cpuid(result, 0x00000001);
+  if ((result[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6) {
+    return 0;
+  }
+
+  __cpuidex(result, 0x00000007, 0);
+  return (result[1] & ((int)1 << 5)) != 0;
+#else
+  return 0;
+#endif
+}
+
 void BLI_hostname_get(char *buffer, size_t bufsize)
 {
 #ifndef WIN32
@@ -25,12 +25,14 @@
 
 #include "DNA_brush_types.h"
 #include "DNA_genfile.h"
+#include "DNA_node_types.h"
 #include "DNA_screen_types.h"
 
 #include "BKE_collection.h"
 #include "BKE_colortools.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_node.h"
 
 #include "BLO_readfile.h"
 #include "readfile.h"
@@ -96,5 +98,14 @@ void blo_do_versions_290(FileData *fd, Library *UNUSED(lib), Main *bmain)
    */
   {
     /* Keep this block, even when empty. */
+
+    if (!DNA_struct_elem_find(fd->filesdna, "bNodeTree", "int", "cache_limit")) {
+      FOREACH_NODETREE_BEGIN (bmain, ntree, id) {
+        if (ntree->type == NTREE_COMPOSIT) {
+          ntree->cache_limit = 1024;
+        }
+      }
+      FOREACH_NODETREE_END;
+    }
   }
 }
@@ -844,6 +844,70 @@ finally:
 
 #ifdef USE_BVH
 
+/* Overlapping pairs are tested in the threaded BVH traversal, only pairs that may intersect
+ * are passed to #bm_isect_tri_tri, which edits the mesh and runs on a single thread. */
+struct OverlapData {
+  BMLoop *(*looptris)[3];
+  float eps_margin;
+};
+
+/**
+ * Check if all points of \a t_other are on one side of the plane of \a t_plane,
+ * further away than the margin. Distances are calculated in double precision,
+ * the margin includes the rounding error of the single precision intersection tests.
+ */
+static bool tri_plane_separated(const float *t_plane[3], const float *t_other[3], float margin)
+{
+  double e1[3], e2[3], no[3];
+  double scale = 0.0;
+  uint i, j;
+
+  for (j = 0; j < 3; j++) {
+    e1[j] = (double)t_plane[1][j] - (double)t_plane[0][j];
+    e2[j] = (double)t_plane[2][j] - (double)t_plane[0][j];
+  }
+  no[0] = e1[1] * e2[2] - e1[2] * e2[1];
+  no[1] = e1[2] * e2[0] - e1[0] * e2[2];
+  no[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+  const double no_len = sqrt(no[0] * no[0] + no[1] * no[1] + no[2] * no[2]);
+  if (no_len == 0.0) {
+    /* Degenerate, can't tell. */
+    return false;
+  }
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      scale = max_dd(scale, fabs((double)t_plane[i][j]));
+      scale = max_dd(scale, fabs((double)t_other[i][j]));
+    }
+  }
+  const double dist_min = (double)margin + scale * (double)(FLT_EPSILON * 16.0f);
+
+  bool above = true, below = true;
+  for (i = 0; i < 3; i++) {
+    const double dist = (no[0] * ((double)t_other[i][0] - (double)t_plane[0][0]) +
+                         no[1] * ((double)t_other[i][1] - (double)t_plane[0][1]) +
+                         no[2] * ((double)t_other[i][2] - (double)t_plane[0][2])) /
+                        no_len;
+    above = above && (dist > dist_min);
+    below = below && (dist < -dist_min);
+  }
+  return above || below;
+}
+
+static bool bm_isect_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+{
+  const struct OverlapData *data = userdata;
+  BMLoop **a = data->looptris[index_a];
+  BMLoop **b = data->looptris[index_b];
+  const float *t_a[3] = {a[0]->v->co, a[1]->v->co, a[2]->v->co};
+  const float *t_b[3] = {b[0]->v->co, b[1]->v->co, b[2]->v->co};
+
+  return !(tri_plane_separated(t_a, t_b, data->eps_margin) ||
+           tri_plane_separated(t_b, t_a, data->eps_margin));
+}
+
 struct RaycastData {
   const float **looptris;
   BLI_Buffer *z_buffer;
@@ -1103,7 +1167,12 @@ bool BM_mesh_intersect(BMesh *bm,
     flag &= ~BVH_OVERLAP_USE_THREADING;
   }
 #  endif
-  overlap = BLI_bvhtree_overlap_ex(tree_b, tree_a, &tree_overlap_tot, NULL, NULL, 0, flag);
+  struct OverlapData overlap_data = {
+      .looptris = looptris,
+      .eps_margin = s.epsilon.eps_margin,
+  };
+  overlap = BLI_bvhtree_overlap_ex(
+      tree_b, tree_a, &tree_overlap_tot, bm_isect_overlap_cb, &overlap_data, 0, flag);
 
   if (overlap) {
     uint i;
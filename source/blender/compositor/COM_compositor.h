@@ -348,6 +348,38 @@ void COM_execute(RenderData *rd,
                  const ColorManagedDisplaySettings *displaySettings,
                  const char *viewName);
 
+/**
+ * \brief Scheduling statistics of the CPU devices during the last COM_execute.
+ */
+typedef struct COM_ExecutionStats {
+  /** Executed chunks, and chunks a device took from the queue of another device. */
+  int chunks;
+  int stolen_chunks;
+  /** Seconds between scheduling and execution of chunks. */
+  double latency_average;
+  double latency_max;
+  /** Fraction of the execution time the CPU devices were executing chunks. */
+  double utilization;
+} COM_ExecutionStats;
+
+void COM_executionStats(COM_ExecutionStats *r_stats);
+
+/**
+ * \brief Execution time of an operation whose result is buffered or output during the last
+ * COM_execute. The time includes the operations it reads without a buffer in between.
+ */
+typedef struct COM_OperationStats {
+  char name[64];
+  int chunks;
+  double time;
+} COM_OperationStats;
+
+/**
+ * \brief Write the statistics of at most max_stats operations to r_stats.
+ * \return the number of operations with statistics
+ */
+int COM_executionOperationStats(COM_OperationStats *r_stats, int max_stats);
+
 /**
  * \brief Deinitialize the compositor caches and allocated memory.
  * Use COM_clearCaches to only free the caches.
@@ -358,7 +390,7 @@ void COM_deinitialize(void);
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
@@ -68,8 +68,9 @@ typedef enum CompositorPriority {
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
- * This is the default option.
+ * COM_TM_QUEUE is a multi-threaded model. CPU work is queued per CPUDevice and executed in a
+ * BLI_task pool, idle devices steal work from the others. OpenCL devices use the BLI_thread_queue
+ * pattern. This is the default option.
  */
 #define COM_TM_QUEUE 1
 
@@ -109,4 +110,8 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/* Result cache keys, see ResultCache. */
+#define COM_HASH_NONE 0
+#define COM_HASH_EMPTY 1
+
 #endif /* __COM_DEFINES_H__ */
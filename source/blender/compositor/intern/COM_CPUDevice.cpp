@@ -18,8 +18,24 @@
 
 #include "COM_CPUDevice.h"
 
-CPUDevice::CPUDevice(int thread_id) : Device(), m_thread_id(thread_id)
+#include "MEM_guardedalloc.h"
+
+#include "BLI_rect.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "COM_ExecutionGroup.h"
+#include "COM_NodeOperation.h"
+
+CPUDevice::CPUDevice(int thread_id)
+    : Device(), m_thread_id(thread_id), m_executionGroup(NULL), m_scratchUsed(0)
+{
+}
+
+void CPUDevice::deinitialize()
 {
+  clearScratch();
 }
 
 void CPUDevice::execute(WorkPackage *work)
@@ -30,7 +46,60 @@ void CPUDevice::execute(WorkPackage *work)
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
 
+  this->m_executionGroup = executionGroup;
+  this->m_chunkRect = rect;
+  const double start_time = PIL_check_seconds_timer();
   executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+  executionGroup->addExecutionTime(PIL_check_seconds_timer() - start_time);
+  this->m_executionGroup = NULL;
 
   executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
+
+bool CPUDevice::determineInputArea(ReadBufferOperation *readOperation, rcti *r_area)
+{
+  if (this->m_executionGroup == NULL) {
+    return false;
+  }
+  rcti rect = this->m_chunkRect;
+  BLI_rcti_init(r_area, 0, 0, 0, 0);
+  return this->m_executionGroup->getOutputOperation()->determineDependingAreaOfInterest(
+      &rect, readOperation, r_area);
+}
+
+float *CPUDevice::allocateScratch(size_t size)
+{
+  if (this->m_scratchUsed == this->m_scratch.size()) {
+    this->m_scratch.push_back(NULL);
+    this->m_scratchSize.push_back(0);
+  }
+  const unsigned int index = this->m_scratchUsed++;
+  if (this->m_scratchSize[index] < size) {
+    if (this->m_scratch[index]) {
+      MEM_freeN(this->m_scratch[index]);
+    }
+    this->m_scratch[index] = (float *)MEM_mallocN_aligned(
+        sizeof(float) * size, 16, "COM_CPUDevice scratch");
+    this->m_scratchSize[index] = size;
+  }
+  return this->m_scratch[index];
+}
+
+void CPUDevice::freeScratch(float *buffer)
+{
+  BLI_assert(this->m_scratchUsed > 0 && this->m_scratch[this->m_scratchUsed - 1] == buffer);
+  UNUSED_VARS_NDEBUG(buffer);
+  this->m_scratchUsed--;
+}
+
+void CPUDevice::clearScratch()
+{
+  BLI_assert(this->m_scratchUsed == 0);
+  for (unsigned int index = 0; index < this->m_scratch.size(); index++) {
+    if (this->m_scratch[index]) {
+      MEM_freeN(this->m_scratch[index]);
+    }
+  }
+  this->m_scratch.clear();
+  this->m_scratchSize.clear();
+}
@@ -19,8 +19,14 @@
 #ifndef __COM_CPUDEVICE_H__
 #define __COM_CPUDEVICE_H__
 
+#include <vector>
+
 #include "COM_Device.h"
 
+#include "DNA_vec_types.h"
+
+class ReadBufferOperation;
+
 /**
  * \brief class representing a CPU device.
  * \note for every hardware thread in the system a CPUDevice instance
@@ -36,13 +42,50 @@ class CPUDevice : public Device {
    */
   void execute(WorkPackage *work);
 
+  /**
+   * \brief determine the area of readOperation read by the chunk being executed
+   * \return false when no chunk is being executed or it does not read readOperation
+   */
+  bool determineInputArea(ReadBufferOperation *readOperation, rcti *r_area);
+
+  void deinitialize();
+
   int thread_id()
   {
     return m_thread_id;
   }
 
+  /**
+   * \brief allocate scratch memory of size floats for a temporary buffer
+   *
+   * Scratch memory is kept between work packages, area execution allocates the same buffers for
+   * every chunk so they are reused instead of allocated again.
+   * \note scratch memory must be freed in reverse order of allocation
+   * \see MemoryBuffer.createScratch
+   */
+  float *allocateScratch(size_t size);
+  void freeScratch(float *buffer);
+
+  /**
+   * \brief free all scratch memory, none of it may be in use
+   */
+  void clearScratch();
+
  protected:
   int m_thread_id;
+
+  /**
+   * \brief the group and area of the chunk being executed, NULL when idle
+   */
+  ExecutionGroup *m_executionGroup;
+  rcti m_chunkRect;
+
+  /**
+   * \brief scratch memory by allocation depth, with the size in floats
+   */
+  std::vector<float *> m_scratch;
+  std::vector<size_t> m_scratchSize;
+  unsigned int m_scratchUsed;
 };
 
 #endif
@@ -268,6 +268,40 @@ class CompositorContext {
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+
+  /**
+   * \brief evaluate pixel-wise operations a whole area at a time instead of per pixel
+   */
+  bool isBufferedExecution() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_BUFFERED) != 0;
+  }
+
+  /**
+   * \brief store intermediate color buffers as half floats and value buffers with a single
+   * channel, converting when they are read
+   */
+  bool isHalfBuffers() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_HALF_BUFFERS) != 0;
+  }
+
+  /**
+   * \brief keep results between executions, only while editing the node tree
+   */
+  bool isResultCacheEnabled() const
+  {
+    return !this->isRendering() && !this->isFastCalculation() &&
+           this->getbNodeTree()->cache_limit > 0;
+  }
+
+  /**
+   * \brief memory limit of the result cache in bytes
+   */
+  size_t getResultCacheLimit() const
+  {
+    return (size_t)this->getbNodeTree()->cache_limit * 1024 * 1024;
+  }
 };
 
 #endif
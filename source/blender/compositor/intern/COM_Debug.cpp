@@ -26,6 +26,7 @@
 
 extern "C" {
 #  include "BLI_fileops.h"
+#  include "BLI_math_base.h"
 #  include "BLI_path_util.h"
 #  include "BLI_string.h"
 #  include "BLI_sys_types.h"
@@ -33,6 +34,8 @@ extern "C" {
 #  include "BKE_appdir.h"
 #  include "BKE_node.h"
 #  include "DNA_node_types.h"
+
+#  include "PIL_time.h"
 }
 
 #  include "COM_ExecutionGroup.h"
@@ -41,6 +44,7 @@ extern "C" {
 
 #  include "COM_ReadBufferOperation.h"
 #  include "COM_ViewerOperation.h"
+#  include "COM_WorkScheduler.h"
 #  include "COM_WriteBufferOperation.h"
 
 int DebugInfo::m_file_index = 0;
@@ -118,6 +122,38 @@ void DebugInfo::execution_group_finished(const ExecutionGroup *group)
   m_group_states[group] = EG_FINISHED;
 }
 
+void DebugInfo::scheduler_finished()
+{
+  const double time = WorkScheduler::get_execution_time();
+  const int num_devices = WorkScheduler::get_num_cpu_devices();
+  int packages = 0;
+  double latency_total = 0.0, latency_max = 0.0;
+
+  for (int device = 0; device < num_devices; device++) {
+    const WorkScheduler::DeviceStats stats = WorkScheduler::get_cpu_device_stats(device);
+    packages += stats.packages;
+    latency_total += stats.latency_total;
+    latency_max = max_dd(latency_max, stats.latency_max);
+  }
+  if (packages == 0) {
+    return;
+  }
+
+  printf("Compositor: %d chunks in %.3f s, latency average %.3f ms, maximum %.3f ms\n",
+         packages,
+         time,
+         1000.0 * latency_total / packages,
+         1000.0 * latency_max);
+  for (int device = 0; device < num_devices; device++) {
+    const WorkScheduler::DeviceStats stats = WorkScheduler::get_cpu_device_stats(device);
+    printf("  CPU device %d: %d chunks, %d stolen, utilization %.1f%%\n",
+           device,
+           stats.packages,
+           stats.stolen,
+           (time > 0.0) ? 100.0 * stats.busy_time / time : 0.0);
+  }
+}
+
 int DebugInfo::graphviz_operation(const ExecutionSystem *system,
                                   const NodeOperation *operation,
                                   const ExecutionGroup *group,
@@ -528,5 +564,8 @@ void DebugInfo::execution_group_finished(const ExecutionGroup * /*group*/)
 void DebugInfo::graphviz(const ExecutionSystem * /*system*/)
 {
 }
+void DebugInfo::scheduler_finished()
+{
+}
 
 #endif
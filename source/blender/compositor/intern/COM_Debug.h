@@ -21,6 +21,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "COM_defines.h"
 
@@ -53,6 +54,9 @@ class DebugInfo {
 
   static void graphviz(const ExecutionSystem *system);
 
+  /** Print the statistics of the CPU devices of the WorkScheduler. */
+  static void scheduler_finished();
+
 #ifdef COM_DEBUG
  protected:
   static int graphviz_operation(const ExecutionSystem *system,
@@ -46,10 +46,13 @@ ExecutionGroup::ExecutionGroup()
   this->m_isOutput = false;
   this->m_complex = false;
   this->m_chunkExecutionStates = NULL;
+  this->m_executionTime = 0;
   this->m_bTree = NULL;
   this->m_height = 0;
   this->m_width = 0;
   this->m_cachedMaxReadBufferOffset = 0;
+  this->m_chunkWidth = 0;
+  this->m_chunkHeight = 0;
   this->m_numberOfXChunks = 0;
   this->m_numberOfYChunks = 0;
   this->m_numberOfChunks = 0;
@@ -126,6 +129,7 @@ void ExecutionGroup::initExecution()
   }
   unsigned int index;
   determineNumberOfChunks();
+  this->m_executionTime = 0;
 
   this->m_chunkExecutionStates = NULL;
   if (this->m_numberOfChunks != 0) {
@@ -143,6 +147,7 @@ void ExecutionGroup::initExecution()
     if (operation->isReadBufferOperation()) {
       ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
       this->m_cachedReadOperations.push_back(readOperation);
+      readOperation->getMemoryProxy()->addReader();
       maxNumber = max(maxNumber, readOperation->getOffset());
     }
   }
@@ -150,6 +155,34 @@ void ExecutionGroup::initExecution()
   this->m_cachedMaxReadBufferOffset = maxNumber;
 }
 
+void ExecutionGroup::setExecuted()
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+  }
+  /* The inputs won't be read anymore. */
+  releaseReadOperations();
+}
+
+void ExecutionGroup::releaseReadOperations()
+{
+  for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+    ReadBufferOperation *readOperation =
+        (ReadBufferOperation *)this->m_cachedReadOperations[index];
+    readOperation->getMemoryProxy()->removeReader();
+  }
+}
+
+bool ExecutionGroup::isFullyExecuted() const
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void ExecutionGroup::deinitExecution()
 {
   if (this->m_chunkExecutionStates != NULL) {
@@ -179,11 +212,19 @@ void ExecutionGroup::determineNumberOfChunks()
     this->m_numberOfChunks = 1;
   }
   else {
-    const float chunkSizef = this->m_chunkSize;
     const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
     const int border_height = BLI_rcti_size_y(&this->m_viewerBorder);
-    this->m_numberOfXChunks = ceil(border_width / chunkSizef);
-    this->m_numberOfYChunks = ceil(border_height / chunkSizef);
+    NodeOperation *operation = this->getOutputOperation();
+    this->m_chunkWidth = this->m_chunkSize;
+    this->m_chunkHeight = this->m_chunkSize;
+    if (operation->isAreaEvaluated() && border_width > 0) {
+      /* Same number of pixels per chunk, but in whole rows so that the chunk is contiguous in
+       * memory and pixel-wise operations can process it as a single row. */
+      this->m_chunkWidth = border_width;
+      this->m_chunkHeight = max_ii(1, (this->m_chunkSize * this->m_chunkSize) / border_width);
+    }
+    this->m_numberOfXChunks = ceil(border_width / (float)this->m_chunkWidth);
+    this->m_numberOfYChunks = ceil(border_height / (float)this->m_chunkHeight);
     this->m_numberOfChunks = this->m_numberOfXChunks * this->m_numberOfYChunks;
   }
 }
@@ -222,6 +263,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   float centerX = 0.5;
   float centerY = 0.5;
   OrderOfChunks chunkorder = COM_ORDER_OF_CHUNKS_DEFAULT;
+  bool use_hotspots = false;
 
   if (operation->isViewerOperation()) {
     ViewerOperation *viewer = (ViewerOperation *)operation;
@@ -244,6 +286,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       }
       break;
     case COM_TO_CENTER_OUT: {
+      use_hotspots = true;
       ChunkOrderHotspot *hotspots[1];
       hotspots[0] = new ChunkOrderHotspot(border_width * centerX, border_height * centerY, 0.0f);
       rcti rect;
@@ -267,6 +310,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       break;
     }
     case COM_TO_RULE_OF_THIRDS: {
+      use_hotspots = true;
       ChunkOrderHotspot *hotspots[9];
       unsigned int tx = border_width / 6;
       unsigned int ty = border_height / 6;
@@ -326,6 +370,9 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   bool finished = false;
   unsigned int startIndex = 0;
   const int maxNumberEvaluated = BLI_system_thread_count() * 2;
+  /* The chunks closest to the hotspots of the viewer, one for every thread, and the chunks they
+   * depend on are executed before other work. */
+  const unsigned int numberOfPriorityChunks = use_hotspots ? BLI_system_thread_count() : 0;
 
   while (!finished && !breaked) {
     bool startEvaluated = false;
@@ -340,7 +387,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
       const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
       if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
+        scheduleChunkWhenPossible(graph, xChunk, yChunk, index < numberOfPriorityChunks);
         finished = false;
         startEvaluated = true;
         numberEvaluated++;
@@ -403,13 +450,20 @@ MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy *mem
   return result;
 }
 
+void ExecutionGroup::addExecutionTime(double seconds)
+{
+  atomic_add_and_fetch_uint64(&this->m_executionTime, (uint64_t)(seconds * 1e6));
+}
+
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
   }
 
-  atomic_add_and_fetch_u(&this->m_chunksFinished, 1);
+  if (atomic_add_and_fetch_u(&this->m_chunksFinished, 1) == this->m_numberOfChunks) {
+    releaseReadOperations();
+  }
   if (memoryBuffers) {
     for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
       MemoryBuffer *buffer = memoryBuffers[index];
@@ -450,15 +504,15 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect,
         rect, this->m_viewerBorder.xmin, border_width, this->m_viewerBorder.ymin, border_height);
   }
   else {
-    const unsigned int minx = xChunk * this->m_chunkSize + this->m_viewerBorder.xmin;
-    const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
+    const unsigned int minx = xChunk * this->m_chunkWidth + this->m_viewerBorder.xmin;
+    const unsigned int miny = yChunk * this->m_chunkHeight + this->m_viewerBorder.ymin;
     const unsigned int width = min((unsigned int)this->m_viewerBorder.xmax, this->m_width);
     const unsigned int height = min((unsigned int)this->m_viewerBorder.ymax, this->m_height);
     BLI_rcti_init(rect,
                   min(minx, this->m_width),
-                  min(minx + this->m_chunkSize, width),
+                  min(minx + this->m_chunkWidth, width),
                   min(miny, this->m_height),
-                  min(miny + this->m_chunkSize, height));
+                  min(miny + this->m_chunkHeight, height));
   }
 }
 
@@ -481,10 +535,10 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/, rcti *re
   return NULL;
 }
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area, bool priority)
 {
   if (this->m_singleThreaded) {
-    return scheduleChunkWhenPossible(graph, 0, 0);
+    return scheduleChunkWhenPossible(graph, 0, 0, priority);
   }
   // find all chunks inside the rect
   // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -494,10 +548,10 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
   int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
   int maxy = min_ii(area->ymax - m_viewerBorder.ymin, m_viewerBorder.ymax - m_viewerBorder.ymin);
-  int minxchunk = minx / (int)m_chunkSize;
-  int maxxchunk = (maxx + (int)m_chunkSize - 1) / (int)m_chunkSize;
-  int minychunk = miny / (int)m_chunkSize;
-  int maxychunk = (maxy + (int)m_chunkSize - 1) / (int)m_chunkSize;
+  int minxchunk = minx / (int)m_chunkWidth;
+  int maxxchunk = (maxx + (int)m_chunkWidth - 1) / (int)m_chunkWidth;
+  int minychunk = miny / (int)m_chunkHeight;
+  int maxychunk = (maxy + (int)m_chunkHeight - 1) / (int)m_chunkHeight;
   minxchunk = max_ii(minxchunk, 0);
   minychunk = max_ii(minychunk, 0);
   maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
@@ -506,7 +560,7 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   bool result = true;
   for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
     for (indexy = minychunk; indexy < maxychunk; indexy++) {
-      if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
+      if (!scheduleChunkWhenPossible(graph, indexx, indexy, priority)) {
         result = false;
       }
     }
@@ -515,17 +569,20 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   return result;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber, bool priority)
 {
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-    WorkScheduler::schedule(this, chunkNumber);
+    WorkScheduler::schedule(this, chunkNumber, priority);
     return true;
   }
   return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                               int xChunk,
+                                               int yChunk,
+                                               bool priority)
 {
   if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
     return true;
@@ -563,7 +620,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
     ExecutionGroup *group = memoryProxy->getExecutor();
 
     if (group != NULL) {
-      if (!group->scheduleAreaWhenPossible(graph, &area)) {
+      if (!group->scheduleAreaWhenPossible(graph, &area, priority)) {
         canBeExecuted = false;
       }
     }
@@ -573,7 +630,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   }
 
   if (canBeExecuted) {
-    scheduleChunk(chunkNumber);
+    scheduleChunk(chunkNumber, priority);
   }
 
   return false;
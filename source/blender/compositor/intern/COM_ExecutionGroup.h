@@ -98,6 +98,14 @@ class ExecutionGroup {
    */
   unsigned int m_chunkSize;
 
+  /**
+   * \brief width and height of the chunks, based on the chunkSize
+   * \note groups that are evaluated per area use bands of whole rows, see
+   * NodeOperation.isAreaEvaluated
+   */
+  unsigned int m_chunkWidth;
+  unsigned int m_chunkHeight;
+
   /**
    * \brief number of chunks in the x-axis
    */
@@ -151,6 +159,12 @@ class ExecutionGroup {
    */
   unsigned int m_chunksFinished;
 
+  /**
+   * \brief time spent executing the chunks of this ExecutionGroup on all devices, in
+   * microseconds
+   */
+  uint64_t m_executionTime;
+
   /**
    * \brief the chunkExecutionStates holds per chunk the execution state. this state can be
    *   - COM_ES_NOT_SCHEDULED: not scheduled
@@ -217,11 +231,15 @@ class ExecutionGroup {
    * \param graph:
    * \param xChunk:
    * \param yChunk:
+   * \param priority: schedule the chunk and its inputs before other work
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+  bool scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                 int xChunk,
+                                 int yChunk,
+                                 bool priority = false);
 
   /**
    * \brief try to schedule a specific area.
@@ -229,17 +247,19 @@ class ExecutionGroup {
    * \note This method is called from other ExecutionGroup's.
    * \param graph:
    * \param rect:
+   * \param priority: schedule the chunks before other work
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
+  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect, bool priority = false);
 
   /**
    * \brief add a chunk to the WorkScheduler.
    * \param chunknumber:
+   * \param priority: schedule the chunk before other work
    */
-  bool scheduleChunk(unsigned int chunkNumber);
+  bool scheduleChunk(unsigned int chunkNumber, bool priority = false);
 
   /**
    * \brief determine the area of interest of a certain input area
@@ -252,6 +272,11 @@ class ExecutionGroup {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
 
+  /**
+   * \brief tell the MemoryProxies read by this group that it is done reading them
+   */
+  void releaseReadOperations();
+
  public:
   // constructors
   ExecutionGroup();
@@ -333,6 +358,25 @@ class ExecutionGroup {
    */
   NodeOperation *getOutputOperation() const;
 
+  /**
+   * \brief add the time a device spent executing a chunk
+   * \note thread safe
+   */
+  void addExecutionTime(double seconds);
+
+  /**
+   * \brief time spent executing the chunks of this ExecutionGroup, in seconds
+   */
+  double getExecutionTime() const
+  {
+    return this->m_executionTime * 1e-6;
+  }
+
+  unsigned int getNumberOfChunksFinished() const
+  {
+    return this->m_chunksFinished;
+  }
+
   /**
    * \brief compose multiple chunks into a single chunk
    * \return Memorybuffer *consolidated chunk
@@ -345,6 +389,17 @@ class ExecutionGroup {
    */
   void initExecution();
 
+  /**
+   * \brief mark all chunks as executed, used when the output buffer was restored from the
+   * ResultCache
+   */
+  void setExecuted();
+
+  /**
+   * \brief check whether all chunks of this ExecutionGroup have been executed
+   */
+  bool isFullyExecuted() const;
+
   /**
    * \brief get all inputbuffers needed to calculate an chunk
    * \note all inputbuffers must be executed
@@ -18,6 +18,9 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <typeinfo>
+
+#include "BLI_string.h"
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
@@ -31,6 +34,8 @@
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_WriteBufferOperation.h"
 #include "COM_WorkScheduler.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -147,12 +152,30 @@ void ExecutionSystem::execute()
   }
   unsigned int index;
 
+  const bool use_result_cache = this->m_context.isResultCacheEnabled();
+  ResultCache::Keys keys;
+  if (use_result_cache) {
+    ResultCache::determineKeys(this->m_context, this->m_operations, &keys);
+  }
+
   // First allocale all write buffer
+  const bool use_half_buffers = this->m_context.isHalfBuffers();
+  std::set<MemoryProxy *> full_precision_proxies;
+  if (use_half_buffers) {
+    findFullPrecisionProxies(&full_precision_proxies);
+  }
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
     if (operation->isWriteBufferOperation()) {
-      operation->setbNodeTree(this->m_context.getbNodeTree());
-      operation->initExecution();
+      WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+      MemoryProxy *proxy = writeOperation->getMemoryProxy();
+      /* Values and vectors are depths, coordinates and offsets, those need full precision. So
+       * do colors read as data. */
+      proxy->setHalfFloat(use_half_buffers && proxy->getDataType() == COM_DT_COLOR &&
+                          full_precision_proxies.count(proxy) == 0);
+      writeOperation->setbNodeTree(this->m_context.getbNodeTree());
+      writeOperation->setBufferedExecution(this->m_context.isBufferedExecution());
+      writeOperation->initExecution();
     }
   }
   // Connect read buffers to their write buffers
@@ -176,6 +199,17 @@ void ExecutionSystem::execute()
     executionGroup->setChunksize(this->m_context.getChunksize());
     executionGroup->initExecution();
   }
+  // Restore unchanged results of the previous execution, their groups don't need to run
+  if (use_result_cache) {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      ExecutionGroup *executionGroup = this->m_groups[index];
+      MemoryProxy *proxy = getCacheableProxy(executionGroup);
+      if (proxy && ResultCache::acquire(
+                       this->m_context, keys[executionGroup->getOutputOperation()], proxy)) {
+        executionGroup->setExecuted();
+      }
+    }
+  }
 
   WorkScheduler::start(this->m_context);
 
@@ -188,6 +222,17 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  // Keep the results for the next execution, partial results of a cancelled one are useless
+  if (use_result_cache && !editingtree->test_break(editingtree->tbh)) {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      ExecutionGroup *executionGroup = this->m_groups[index];
+      MemoryProxy *proxy = getCacheableProxy(executionGroup);
+      if (proxy && executionGroup->isFullyExecuted()) {
+        ResultCache::store(this->m_context, keys[executionGroup->getOutputOperation()], proxy);
+      }
+    }
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -199,6 +244,80 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::getOperationStats(std::vector<COM_OperationStats> *r_stats) const
+{
+  r_stats->clear();
+  for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *executionGroup = this->m_groups[index];
+    if (executionGroup->getNumberOfChunksFinished() == 0) {
+      continue;
+    }
+    /* A buffer is named after the operation writing into it. */
+    NodeOperation *operation = executionGroup->getOutputOperation();
+    if (operation->isWriteBufferOperation() && operation->getInputSocket(0)->isConnected()) {
+      operation = &operation->getInputSocket(0)->getLink()->getOperation();
+    }
+    /* Mangled names of classes start with the length of the name. */
+    const char *name = typeid(*operation).name();
+    while (*name >= '0' && *name <= '9') {
+      name++;
+    }
+
+    COM_OperationStats stats;
+    BLI_strncpy(stats.name, name, sizeof(stats.name));
+    stats.chunks = executionGroup->getNumberOfChunksFinished();
+    stats.time = executionGroup->getExecutionTime();
+    r_stats->push_back(stats);
+  }
+}
+
+MemoryProxy *ExecutionSystem::getCacheableProxy(ExecutionGroup *group)
+{
+  if (group->isOutputExecutionGroup()) {
+    return NULL;
+  }
+  NodeOperation *operation = group->getOutputOperation();
+  if (!operation->isWriteBufferOperation()) {
+    return NULL;
+  }
+  return ((WriteBufferOperation *)operation)->getMemoryProxy();
+}
+
+/* Add the buffers the input reads from, following the inputs of operations up to the buffers. */
+static void find_full_precision_proxies(NodeOperationInput *input,
+                                        std::set<NodeOperation *> *visited,
+                                        std::set<MemoryProxy *> *r_proxies)
+{
+  if (!input->isConnected()) {
+    return;
+  }
+  NodeOperation &operation = input->getLink()->getOperation();
+  if (!visited->insert(&operation).second) {
+    return;
+  }
+  if (operation.isReadBufferOperation()) {
+    r_proxies->insert(((ReadBufferOperation &)operation).getMemoryProxy());
+    return;
+  }
+  for (unsigned int index = 0; index < operation.getNumberOfInputSockets(); index++) {
+    find_full_precision_proxies(operation.getInputSocket(index), visited, r_proxies);
+  }
+}
+
+void ExecutionSystem::findFullPrecisionProxies(std::set<MemoryProxy *> *r_proxies) const
+{
+  std::set<NodeOperation *> visited;
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    NodeOperation *operation = this->m_operations[index];
+    for (unsigned int input = 0; input < operation->getNumberOfInputSockets(); input++) {
+      NodeOperationInput *socket = operation->getInputSocket(input);
+      if (socket->isFullPrecision()) {
+        find_full_precision_proxies(socket, &visited, r_proxies);
+      }
+    }
+  }
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
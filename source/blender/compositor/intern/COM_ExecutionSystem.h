@@ -21,8 +21,11 @@ class ExecutionGroup;
 #ifndef __COM_EXECUTIONSYSTEM_H__
 #define __COM_EXECUTIONSYSTEM_H__
 
+#include <set>
+
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_compositor.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
 #include "DNA_color_types.h"
@@ -186,9 +189,26 @@ class ExecutionSystem {
     return this->m_context;
   }
 
+  /**
+   * \brief the execution time of every executed group, named after the operation it writes
+   */
+  void getOperationStats(std::vector<COM_OperationStats> *r_stats) const;
+
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief the MemoryProxy holding the result of a group that can be kept in the ResultCache
+   */
+  static MemoryProxy *getCacheableProxy(ExecutionGroup *group);
+
+  /**
+   * \brief find the buffers read by full precision inputs, directly or through the operations of
+   * the group reading them
+   * \see NodeOperationInput.isFullPrecision
+   */
+  void findFullPrecisionProxies(std::set<MemoryProxy *> *r_proxies) const;
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
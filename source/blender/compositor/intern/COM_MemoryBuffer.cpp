@@ -18,6 +18,9 @@
 
 #include "COM_MemoryBuffer.h"
 
+#include "COM_CPUDevice.h"
+#include "COM_WorkScheduler.h"
+
 #include "MEM_guardedalloc.h"
 
 using std::max;
@@ -58,10 +61,19 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = chunkNumber;
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-  this->m_buffer = (float *)MEM_mallocN_aligned(
-      sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  if (memoryProxy->isHalfFloat()) {
+    this->m_buffer = NULL;
+    this->m_halfBuffer = (uint16_t *)MEM_mallocN_aligned(
+        sizeof(uint16_t) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  }
+  else {
+    this->m_buffer = (float *)MEM_mallocN_aligned(
+        sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+    this->m_halfBuffer = NULL;
+  }
   this->m_state = COM_MB_ALLOCATED;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_isScratch = false;
 }
 
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
@@ -74,8 +86,10 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  this->m_halfBuffer = NULL;
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_isScratch = false;
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 {
@@ -88,28 +102,91 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
   this->m_num_channels = determine_num_channels(dataType);
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  this->m_halfBuffer = NULL;
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = dataType;
+  this->m_isScratch = false;
+}
+
+MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect, CPUDevice *device)
+{
+  BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
+  this->m_width = BLI_rcti_size_x(&this->m_rect);
+  this->m_height = BLI_rcti_size_y(&this->m_rect);
+  this->m_memoryProxy = NULL;
+  this->m_chunkNumber = -1;
+  this->m_num_channels = determine_num_channels(dataType);
+  this->m_buffer = device->allocateScratch(determineBufferSize() * this->m_num_channels);
+  this->m_halfBuffer = NULL;
+  this->m_state = COM_MB_TEMPORARILY;
+  this->m_datatype = dataType;
+  this->m_isScratch = true;
+}
+
+MemoryBuffer *MemoryBuffer::createScratch(DataType datatype, rcti *rect)
+{
+  CPUDevice *device = WorkScheduler::current_cpu_device();
+  if (device == NULL) {
+    return new MemoryBuffer(datatype, rect);
+  }
+  return new MemoryBuffer(datatype, rect, device);
+}
+
+void MemoryBuffer::freeScratch(MemoryBuffer *buffer)
+{
+  if (buffer->m_isScratch) {
+    WorkScheduler::current_cpu_device()->freeScratch(buffer->m_buffer);
+    buffer->m_buffer = NULL;
+  }
+  delete buffer;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
-  MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-  memcpy(result->m_buffer,
-         this->m_buffer,
-         this->determineBufferSize() * this->m_num_channels * sizeof(float));
+  /* Float copies of half float buffers are not owned by a memory proxy. */
+  MemoryBuffer *result = this->m_memoryProxy ?
+                             new MemoryBuffer(this->m_memoryProxy, &this->m_rect) :
+                             new MemoryBuffer(this->m_datatype, &this->m_rect);
+  if (this->m_halfBuffer) {
+    result->copyContentFrom(this);
+  }
+  else {
+    memcpy(result->m_buffer,
+           this->m_buffer,
+           this->determineBufferSize() * this->m_num_channels * sizeof(float));
+  }
   return result;
 }
 void MemoryBuffer::clear()
 {
-  memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+  if (this->m_halfBuffer) {
+    /* Zero bits are a zero half float as well. */
+    memset(this->m_halfBuffer,
+           0,
+           this->determineBufferSize() * this->m_num_channels * sizeof(uint16_t));
+  }
+  else {
+    memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+  }
 }
 
 float MemoryBuffer::getMaximumValue()
 {
-  float result = this->m_buffer[0];
   const unsigned int size = this->determineBufferSize();
   unsigned int i;
 
+  if (this->m_halfBuffer) {
+    const uint16_t *hp_src = this->m_halfBuffer;
+    float result = com_half_to_float(*hp_src);
+    for (i = 0; i < size; i++, hp_src += this->m_num_channels) {
+      float value = com_half_to_float(*hp_src);
+      if (value > result) {
+        result = value;
+      }
+    }
+    return result;
+  }
+
+  float result = this->m_buffer[0];
   const float *fp_src = this->m_buffer;
 
   for (i = 0; i < size; i++, fp_src += this->m_num_channels) {
@@ -142,12 +219,48 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
   }
 }
 
+size_t MemoryBuffer::getMemorySize()
+{
+  const size_t element_size = this->m_halfBuffer ? sizeof(uint16_t) : sizeof(float);
+  return element_size * this->determineBufferSize() * this->m_num_channels;
+}
+
 MemoryBuffer::~MemoryBuffer()
 {
+  BLI_assert(!this->m_isScratch || this->m_buffer == NULL);
   if (this->m_buffer) {
     MEM_freeN(this->m_buffer);
     this->m_buffer = NULL;
   }
+  if (this->m_halfBuffer) {
+    MEM_freeN(this->m_halfBuffer);
+    this->m_halfBuffer = NULL;
+  }
+}
+
+/* Copy a row of values between buffers, converting between float and half float storage. */
+static void copy_row(float *dst,
+                     uint16_t *dst_half,
+                     const float *src,
+                     const uint16_t *src_half,
+                     unsigned int length)
+{
+  if (dst_half && src_half) {
+    memcpy(dst_half, src_half, length * sizeof(uint16_t));
+  }
+  else if (dst_half) {
+    for (unsigned int i = 0; i < length; i++) {
+      dst_half[i] = com_float_to_half(src[i]);
+    }
+  }
+  else if (src_half) {
+    for (unsigned int i = 0; i < length; i++) {
+      dst[i] = com_half_to_float(src_half[i]);
+    }
+  }
+  else {
+    memcpy(dst, src, length * sizeof(float));
+  }
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -170,9 +283,11 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
                   this->m_num_channels;
     offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) *
              this->m_num_channels;
-    memcpy(&this->m_buffer[offset],
-           &otherBuffer->m_buffer[otherOffset],
-           (maxX - minX) * this->m_num_channels * sizeof(float));
+    copy_row(this->m_buffer ? &this->m_buffer[offset] : NULL,
+             this->m_halfBuffer ? &this->m_halfBuffer[offset] : NULL,
+             otherBuffer->m_buffer ? &otherBuffer->m_buffer[otherOffset] : NULL,
+             otherBuffer->m_halfBuffer ? &otherBuffer->m_halfBuffer[otherOffset] : NULL,
+             (maxX - minX) * this->m_num_channels);
   }
 }
 
@@ -182,7 +297,14 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
       y < this->m_rect.ymax) {
     const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) *
                        this->m_num_channels;
-    memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+    if (this->m_halfBuffer) {
+      for (int i = 0; i < this->m_num_channels; i++) {
+        this->m_halfBuffer[offset + i] = com_float_to_half(color[i]);
+      }
+    }
+    else {
+      memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+    }
   }
 }
 
@@ -192,6 +314,13 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
       y < this->m_rect.ymax) {
     const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) *
                        this->m_num_channels;
+    if (this->m_halfBuffer) {
+      uint16_t *dst = &this->m_halfBuffer[offset];
+      for (int i = 0; i < this->m_num_channels; i++) {
+        dst[i] = com_float_to_half(com_half_to_float(dst[i]) + color[i]);
+      }
+      return;
+    }
     float *dst = &this->m_buffer[offset];
     const float *src = color;
     for (int i = 0; i < this->m_num_channels; i++, dst++, src++) {
@@ -200,6 +329,68 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
   }
 }
 
+void MemoryBuffer::readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y)
+{
+  /* Same as BLI_bilinear_interpolation_wrap_fl, reading half floats. */
+  const int width = this->m_width;
+  const int height = this->m_height;
+  const int components = this->m_num_channels;
+  int x1 = (int)floorf(u);
+  int x2 = (int)ceilf(u);
+  int y1 = (int)floorf(v);
+  int y2 = (int)ceilf(v);
+
+  /* pixel value must be already wrapped, however values at boundaries may flip */
+  if (wrap_x) {
+    if (x1 < 0) {
+      x1 = width - 1;
+    }
+    if (x2 >= width) {
+      x2 = 0;
+    }
+  }
+  else if (x2 < 0 || x1 >= width) {
+    copy_vn_fl(result, components, 0.0f);
+    return;
+  }
+
+  if (wrap_y) {
+    if (y1 < 0) {
+      y1 = height - 1;
+    }
+    if (y2 >= height) {
+      y2 = 0;
+    }
+  }
+  else if (y2 < 0 || y1 >= height) {
+    copy_vn_fl(result, components, 0.0f);
+    return;
+  }
+
+  /* sample including outside of edges of image */
+  const int xs[4] = {x1, x1, x2, x2};
+  const int ys[4] = {y1, y2, y1, y2};
+  float rows[4][4];
+  for (int i = 0; i < 4; i++) {
+    if (xs[i] < 0 || xs[i] > width - 1 || ys[i] < 0 || ys[i] > height - 1) {
+      zero_v4(rows[i]);
+    }
+    else {
+      this->readOffset(rows[i], (width * ys[i] + xs[i]) * components);
+    }
+  }
+
+  const float a = u - floorf(u);
+  const float b = v - floorf(v);
+  const float a_b = a * b;
+  const float ma_b = (1.0f - a) * b;
+  const float a_mb = a * (1.0f - b);
+  const float ma_mb = (1.0f - a) * (1.0f - b);
+  for (int i = 0; i < components; i++) {
+    result[i] = ma_mb * rows[0][i] + a_mb * rows[2][i] + ma_b * rows[1][i] + a_b * rows[3][i];
+  }
+}
+
 static void read_ewa_pixel_sampled(void *userdata, int x, int y, float result[4])
 {
   MemoryBuffer *buffer = (MemoryBuffer *)userdata;
@@ -27,6 +27,7 @@ class MemoryBuffer;
 
 #include "BLI_math.h"
 #include "BLI_rect.h"
+#include "BLI_sys_types.h"
 
 /**
  * \brief state of a memory buffer
@@ -48,8 +49,85 @@ typedef enum MemoryBufferExtend {
   COM_MB_REPEAT,
 } MemoryBufferExtend;
 
+class CPUDevice;
 class MemoryProxy;
 
+/**
+ * \brief convert a float to a half float, rounding to nearest even.
+ * Values out of the half float range are clamped to the largest half float, NaN is kept.
+ */
+inline uint16_t com_float_to_half(float value)
+{
+  union {
+    uint32_t u;
+    float f;
+  } f;
+  const uint32_t f16max = (127 + 16) << 23;
+  const uint32_t f32infty = 255 << 23;
+  f.f = value;
+  const uint32_t sign = f.u & 0x80000000u;
+  uint16_t result;
+
+  f.u ^= sign;
+  if (f.u > f32infty) {
+    result = 0x7e00;
+  }
+  else if (f.u >= f16max) {
+    result = 0x7bff;
+  }
+  else if (f.u < (113u << 23)) {
+    /* Denormal or zero, let the float addition do the rounding. */
+    union {
+      uint32_t u;
+      float f;
+    } denorm_magic;
+    denorm_magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+    f.f += denorm_magic.f;
+    result = (uint16_t)(f.u - denorm_magic.u);
+  }
+  else {
+    const uint32_t mant_odd = (f.u >> 13) & 1;
+    f.u += ((uint32_t)(15 - 127) << 23) + 0xfff;
+    f.u += mant_odd;
+    /* Rounding up may overflow into infinity. */
+    f.u >>= 13;
+    result = (uint16_t)(f.u < 0x7c00 ? f.u : 0x7bff);
+  }
+  return result | (uint16_t)(sign >> 16);
+}
+
+/**
+ * \brief convert a half float to a float
+ */
+inline float com_half_to_float(uint16_t value)
+{
+  const uint32_t shifted_exp = 0x7c00 << 13;
+  union {
+    uint32_t u;
+    float f;
+  } result;
+
+  result.u = (uint32_t)(value & 0x7fff) << 13;
+  const uint32_t exp = shifted_exp & result.u;
+  result.u += (127 - 15) << 23;
+  if (exp == shifted_exp) {
+    /* Inf or NaN. */
+    result.u += (128 - 16) << 23;
+  }
+  else if (exp == 0) {
+    /* Denormal or zero, renormalize. */
+    union {
+      uint32_t u;
+      float f;
+    } magic;
+    magic.u = 113 << 23;
+    result.u += 1 << 23;
+    result.f -= magic.f;
+  }
+  result.u |= (uint32_t)(value & 0x8000) << 16;
+  return result.f;
+}
+
 /**
  * \brief a MemoryBuffer contains access to the data of a chunk
  */
@@ -82,10 +160,17 @@ class MemoryBuffer {
   MemoryBufferState m_state;
 
   /**
-   * \brief the actual float buffer/data
+   * \brief the actual float buffer/data, NULL when the data is stored as half floats
    */
   float *m_buffer;
 
+  /**
+   * \brief the data stored as half floats, only used for buffers of a MemoryProxy with half
+   * float storage. Readers convert to float per pixel.
+   * \see MemoryProxy.isHalfFloat
+   */
+  uint16_t *m_halfBuffer;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -95,6 +180,12 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief the data is scratch memory of a CPUDevice, not owned by this buffer
+   * \see MemoryBuffer.createScratch
+   */
+  bool m_isScratch;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -116,6 +207,15 @@ class MemoryBuffer {
    */
   ~MemoryBuffer();
 
+  /**
+   * \brief create a temporarily MemoryBuffer for an area in the scratch memory of the CPUDevice
+   * executing the calling thread, so the buffers of area execution are not allocated for every
+   * chunk again. Without a CPUDevice the memory is allocated.
+   * \note scratch buffers must be freed with freeScratch in reverse order of creation
+   */
+  static MemoryBuffer *createScratch(DataType datatype, rcti *rect);
+  static void freeScratch(MemoryBuffer *buffer);
+
   /**
    * \brief read the ChunkNumber of this MemoryBuffer
    */
@@ -129,15 +229,47 @@ class MemoryBuffer {
     return this->m_num_channels;
   }
 
+  /**
+   * \brief is the data of this MemoryBuffer stored as half floats
+   */
+  bool isHalfFloat() const
+  {
+    return this->m_halfBuffer != NULL;
+  }
+
   /**
    * \brief get the data of this MemoryBuffer
    * \note buffer should already be available in memory
+   * \note not available for half float buffers, use the read methods or copyContentFrom
    */
   float *getBuffer()
   {
+    BLI_assert(!isHalfFloat());
     return this->m_buffer;
   }
 
+  /**
+   * \brief get the first channel of the pixel at (x, y), in absolute coordinates
+   * \note (x, y) must lie inside the rect of this MemoryBuffer
+   */
+  inline float *getElem(int x, int y)
+  {
+    BLI_assert(!isHalfFloat());
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    return this->m_buffer +
+           ((y - m_rect.ymin) * this->m_width + (x - m_rect.xmin)) * this->m_num_channels;
+  }
+
+  /**
+   * \brief whether the rows of area directly follow each other, so the area can be walked as a
+   * single row starting at getElem(area->xmin, area->ymin)
+   * \note area must lie inside the rect of this MemoryBuffer
+   */
+  inline bool isContiguous(const rcti *area) const
+  {
+    return BLI_rcti_size_x(area) == this->m_width;
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -246,8 +378,7 @@ class MemoryBuffer {
       int v = y;
       this->wrap_pixel(u, v, extend_x, extend_y);
       const int offset = (this->m_width * y + x) * this->m_num_channels;
-      float *buffer = &this->m_buffer[offset];
-      memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+      this->readOffset(result, offset);
     }
   }
 
@@ -272,8 +403,7 @@ class MemoryBuffer {
     BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
                (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
 #endif
-    float *buffer = &this->m_buffer[offset];
-    memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+    this->readOffset(result, offset);
   }
 
   void writePixel(int x, int y, const float color[4]);
@@ -292,6 +422,10 @@ class MemoryBuffer {
       copy_vn_fl(result, this->m_num_channels, 0.0f);
       return;
     }
+    if (isHalfFloat()) {
+      this->readBilinearHalf(result, u, v, extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
+      return;
+    }
     BLI_bilinear_interpolation_wrap_fl(this->m_buffer,
                                        result,
                                        this->m_width,
@@ -350,9 +484,37 @@ class MemoryBuffer {
   float getMaximumValue();
   float getMaximumValue(rcti *rect);
 
+  /**
+   * \brief the number of bytes allocated for the data
+   */
+  size_t getMemorySize();
+
  private:
   unsigned int determineBufferSize();
 
+  /**
+   * \brief read the pixel at a data offset, converting half floats
+   */
+  inline void readOffset(float *result, int offset)
+  {
+    if (this->m_halfBuffer) {
+      const uint16_t *buffer = &this->m_halfBuffer[offset];
+      for (unsigned int i = 0; i < this->m_num_channels; i++) {
+        result[i] = com_half_to_float(buffer[i]);
+      }
+    }
+    else {
+      memcpy(result, &this->m_buffer[offset], sizeof(float) * this->m_num_channels);
+    }
+  }
+
+  void readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y);
+
+  /**
+   * \brief construct new temporarily MemoryBuffer for an area in the scratch memory of device
+   */
+  MemoryBuffer(DataType datatype, rcti *rect, CPUDevice *device);
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBuffer")
 #endif
@@ -16,13 +16,47 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include <string.h>
+
+#include "BLI_math_base.h"
+#include "BLI_rect.h"
+
 #include "COM_MemoryProxy.h"
 
+/// \brief size of the blocks in which float copies are converted
+#define COM_FLOAT_COPY_BLOCK_SIZE 64
+
+static int float_buffer_index(DataType datatype)
+{
+  switch (datatype) {
+    case COM_DT_VALUE:
+      return 0;
+    case COM_DT_VECTOR:
+      return 1;
+    case COM_DT_COLOR:
+    default:
+      return 2;
+  }
+}
+
 MemoryProxy::MemoryProxy(DataType datatype)
 {
   this->m_writeBufferOperation = NULL;
   this->m_executor = NULL;
   this->m_datatype = datatype;
+  this->m_buffer = NULL;
+  this->m_halfFloat = false;
+  this->m_numberOfReaders = 0;
+  for (int index = 0; index < 3; index++) {
+    this->m_floatBuffers[index] = NULL;
+  }
+  BLI_mutex_init(&this->m_mutex);
+}
+
+MemoryProxy::~MemoryProxy()
+{
+  this->free();
+  BLI_mutex_end(&this->m_mutex);
 }
 
 void MemoryProxy::allocate(unsigned int width, unsigned int height)
@@ -42,4 +76,93 @@ void MemoryProxy::free()
     delete this->m_buffer;
     this->m_buffer = NULL;
   }
+  for (int index = 0; index < 3; index++) {
+    if (this->m_floatBuffers[index]) {
+      delete this->m_floatBuffers[index];
+      this->m_floatBuffers[index] = NULL;
+    }
+  }
+}
+
+MemoryBuffer *MemoryProxy::getFloatBuffer(DataType datatype, const rcti *area)
+{
+  MemoryBuffer *buffer = this->m_buffer;
+  if (buffer == NULL || (datatype == this->m_datatype && !buffer->isHalfFloat())) {
+    return buffer;
+  }
+
+  const rcti *rect = buffer->getRect();
+  const int index = float_buffer_index(datatype);
+  const int blocks_x = divide_ceil_u(BLI_rcti_size_x(rect), COM_FLOAT_COPY_BLOCK_SIZE);
+  const int blocks_y = divide_ceil_u(BLI_rcti_size_y(rect), COM_FLOAT_COPY_BLOCK_SIZE);
+  rcti convert = *rect;
+  if (area && !BLI_rcti_isect(area, rect, &convert)) {
+    BLI_rcti_init(&convert, rect->xmin, rect->xmin, rect->ymin, rect->ymin);
+  }
+
+  BLI_mutex_lock(&this->m_mutex);
+  MemoryBuffer *result = this->m_floatBuffers[index];
+  std::vector<bool> &converted = this->m_floatBlocksConverted[index];
+  if (result == NULL) {
+    result = new MemoryBuffer(datatype, buffer->getRect());
+    result->setCreatedState();
+    converted.assign(blocks_x * blocks_y, false);
+    this->m_floatBuffers[index] = result;
+  }
+
+  const unsigned int num_channels = result->get_num_channels();
+  const int block_xmin = (convert.xmin - rect->xmin) / COM_FLOAT_COPY_BLOCK_SIZE;
+  const int block_xmax = divide_ceil_u(convert.xmax - rect->xmin, COM_FLOAT_COPY_BLOCK_SIZE);
+  const int block_ymin = (convert.ymin - rect->ymin) / COM_FLOAT_COPY_BLOCK_SIZE;
+  const int block_ymax = divide_ceil_u(convert.ymax - rect->ymin, COM_FLOAT_COPY_BLOCK_SIZE);
+  for (int block_y = block_ymin; block_y < block_ymax; block_y++) {
+    for (int block_x = block_xmin; block_x < block_xmax; block_x++) {
+      if (converted[block_y * blocks_x + block_x]) {
+        continue;
+      }
+      const int xmin = rect->xmin + block_x * COM_FLOAT_COPY_BLOCK_SIZE;
+      const int ymin = rect->ymin + block_y * COM_FLOAT_COPY_BLOCK_SIZE;
+      const int xmax = min_ii(xmin + COM_FLOAT_COPY_BLOCK_SIZE, rect->xmax);
+      const int ymax = min_ii(ymin + COM_FLOAT_COPY_BLOCK_SIZE, rect->ymax);
+      float pixel[4];
+      for (int y = ymin; y < ymax; y++) {
+        for (int x = xmin; x < xmax; x++) {
+          buffer->readNoCheck(pixel, x, y);
+          this->convertPixel(pixel, datatype);
+          memcpy(result->getElem(x, y), pixel, sizeof(float) * num_channels);
+        }
+      }
+      converted[block_y * blocks_x + block_x] = true;
+    }
+  }
+  BLI_mutex_unlock(&this->m_mutex);
+
+  return result;
+}
+
+void MemoryProxy::addReader()
+{
+  this->m_numberOfReaders++;
+}
+
+void MemoryProxy::removeReader()
+{
+  BLI_mutex_lock(&this->m_mutex);
+  BLI_assert(this->m_numberOfReaders > 0);
+  if (--this->m_numberOfReaders == 0) {
+    for (int index = 0; index < 3; index++) {
+      if (this->m_floatBuffers[index]) {
+        delete this->m_floatBuffers[index];
+        this->m_floatBuffers[index] = NULL;
+      }
+    }
+  }
+  BLI_mutex_unlock(&this->m_mutex);
+}
+
+MemoryBuffer *MemoryProxy::releaseBuffer()
+{
+  MemoryBuffer *buffer = this->m_buffer;
+  this->m_buffer = NULL;
+  return buffer;
 }
@@ -23,6 +23,10 @@ class MemoryProxy;
 #include "COM_ExecutionGroup.h"
 #include "COM_MemoryBuffer.h"
 
+#include "BLI_threads.h"
+
+#include <vector>
+
 class ExecutionGroup;
 class WriteBufferOperation;
 
@@ -64,8 +68,33 @@ class MemoryProxy {
    */
   DataType m_datatype;
 
+  /**
+   * \brief store the allocated memory as half floats
+   */
+  bool m_halfFloat;
+
+  /**
+   * \brief float copies of the allocated memory for readers that access the data directly,
+   * per datatype they are read as.
+   * \see getFloatBuffer
+   */
+  MemoryBuffer *m_floatBuffers[3];
+
+  /**
+   * \brief blocks of the float copies converted so far, only the areas read are converted
+   */
+  std::vector<bool> m_floatBlocksConverted[3];
+
+  /**
+   * \brief number of ReadBufferOperations that still have to execute
+   */
+  int m_numberOfReaders;
+
+  ThreadMutex m_mutex;
+
  public:
   MemoryProxy(DataType type);
+  ~MemoryProxy();
 
   /**
    * \brief set the ExecutionGroup that can be scheduled to calculate a certain chunk.
@@ -112,6 +141,11 @@ class MemoryProxy {
    */
   void free();
 
+  /**
+   * \brief hand over the allocated memory, the caller becomes responsible for freeing it
+   */
+  MemoryBuffer *releaseBuffer();
+
   /**
    * \brief get the allocated memory
    */
@@ -125,6 +159,59 @@ class MemoryProxy {
     return this->m_datatype;
   }
 
+  /**
+   * \brief store the memory as half floats, must be set before allocating
+   */
+  void setHalfFloat(bool halfFloat)
+  {
+    this->m_halfFloat = halfFloat;
+  }
+
+  bool isHalfFloat() const
+  {
+    return this->m_halfFloat;
+  }
+
+  /**
+   * \brief convert a pixel of this buffer to datatype.
+   *
+   * Readers can read the buffer as a datatype with more channels, the buffer then stores the
+   * data before the conversion and readers convert it the same way ConvertOperation would.
+   */
+  inline void convertPixel(float pixel[4], DataType datatype) const
+  {
+    if (datatype == this->m_datatype) {
+      return;
+    }
+    if (this->m_datatype == COM_DT_VALUE) {
+      pixel[1] = pixel[2] = pixel[0];
+    }
+    if (datatype == COM_DT_COLOR) {
+      pixel[3] = 1.0f;
+    }
+  }
+
+  /**
+   * \brief get the allocated memory as floats with the channels of datatype.
+   *
+   * Returns the allocated memory itself when it already is, otherwise one copy is shared by all
+   * readers until they have executed. Only area is converted, or everything when it is NULL,
+   * the copy is undefined outside the areas requested so far.
+   * \note thread safe
+   */
+  MemoryBuffer *getFloatBuffer(DataType datatype, const rcti *area);
+
+  /**
+   * \brief register a ReadBufferOperation that will execute
+   */
+  void addReader();
+
+  /**
+   * \brief a ReadBufferOperation has executed, the float copies are freed after the last one
+   * \note thread safe
+   */
+  void removeReader();
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
@@ -36,6 +36,8 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_pixelWise = false;
+  this->m_parameterHash = COM_HASH_EMPTY;
   this->m_btree = NULL;
 }
 
@@ -134,6 +136,49 @@ void NodeOperation::deinitExecution()
 {
   /* pass */
 }
+
+void NodeOperation::renderArea(MemoryBuffer *output, const rcti *area)
+{
+  rcti rect = *area;
+
+  if (this->m_pixelWise) {
+    const unsigned int num_inputs = this->getNumberOfInputSockets();
+    std::vector<MemoryBuffer *> inputs(num_inputs);
+    for (unsigned int index = 0; index < num_inputs; index++) {
+      NodeOperationInput *socket = this->getInputSocket(index);
+      inputs[index] = MemoryBuffer::createScratch(socket->getDataType(), &rect);
+      this->getInputOperation(index)->renderArea(inputs[index], &rect);
+    }
+    if (!isBraked()) {
+      this->updateMemoryBufferArea(output, &rect, inputs.data());
+    }
+    /* Scratch buffers are freed in reverse order. */
+    for (unsigned int index = num_inputs; index > 0; index--) {
+      MemoryBuffer::freeScratch(inputs[index - 1]);
+    }
+    return;
+  }
+
+  /* Same as the per chunk evaluation in WriteBufferOperation, the operation may write more
+   * channels than the buffer holds so go through a temporary pixel. */
+  const int num_channels = output->get_num_channels();
+  float color[4];
+  void *data = this->m_complex ? this->initializeTileData(&rect) : NULL;
+  for (int y = rect.ymin; y < rect.ymax && !isBraked(); y++) {
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      if (this->m_complex) {
+        this->read(color, x, y, data);
+      }
+      else {
+        this->readSampled(color, x, y, COM_PS_NEAREST);
+      }
+      memcpy(output->getElem(x, y), color, sizeof(float) * num_channels);
+    }
+  }
+  if (data) {
+    this->deinitializeTileData(&rect, data);
+  }
+}
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
   return this->getInputSocket(inputSocketIndex)->getReader();
@@ -201,7 +246,11 @@ bool NodeOperation::determineDependingAreaOfInterest(rcti *input,
 NodeOperationInput::NodeOperationInput(NodeOperation *op,
                                        DataType datatype,
                                        InputResizeMode resizeMode)
-    : m_operation(op), m_datatype(datatype), m_resizeMode(resizeMode), m_link(NULL)
+    : m_operation(op),
+      m_datatype(datatype),
+      m_resizeMode(resizeMode),
+      m_link(NULL),
+      m_fullPrecision(false)
 {
 }
 
@@ -103,6 +103,21 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief does this operation only read its inputs at the pixel it is writing.
+   *
+   * Pixel-wise operations implement updateMemoryBufferArea, so that in buffered execution whole
+   * areas can be evaluated per operation instead of pulling every pixel through the tree.
+   * \see NodeOperation.renderArea
+   */
+  bool m_pixelWise;
+
+  /**
+   * \brief hash of the parameters of this operation, COM_HASH_NONE when its result is not cached
+   * \see ResultCache
+   */
+  uint64_t m_parameterHash;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -184,7 +199,7 @@ class NodeOperation : public SocketReader {
     return false;
   }
 
-  void setbNodeTree(const bNodeTree *tree)
+  virtual void setbNodeTree(const bNodeTree *tree)
   {
     this->m_btree = tree;
   }
@@ -201,6 +216,27 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief evaluate an area of this operation at once
+   * \note only called for pixel-wise operations, see setPixelWise
+   * \param output: the buffer to write to, contains at least area
+   * \param area: the area to calculate
+   * \param inputs: one buffer per input socket, each holding the input evaluated over area
+   */
+  virtual void updateMemoryBufferArea(MemoryBuffer * /*output*/,
+                                      const rcti * /*area*/,
+                                      MemoryBuffer ** /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief evaluate this operation over area into output
+   *
+   * Pixel-wise operations first evaluate their inputs into temporary buffers of the same area
+   * and then update the output at once. Other operations are sampled per pixel.
+   */
+  void renderArea(MemoryBuffer *output, const rcti *area);
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -277,6 +313,31 @@ class NodeOperation : public SocketReader {
     return this->m_complex;
   }
 
+  bool isPixelWise() const
+  {
+    return this->m_pixelWise;
+  }
+
+  /**
+   * \brief does executeRegion evaluate its input per area instead of per pixel
+   * \note only valid after initExecution
+   * \see NodeOperation.renderArea
+   */
+  virtual bool isAreaEvaluated()
+  {
+    return false;
+  }
+
+  void setParameterHash(uint64_t hash)
+  {
+    this->m_parameterHash = hash;
+  }
+
+  uint64_t getParameterHash() const
+  {
+    return this->m_parameterHash;
+  }
+
   virtual bool isSetOperation() const
   {
     return false;
@@ -413,6 +474,14 @@ class NodeOperation : public SocketReader {
     this->m_complex = complex;
   }
 
+  /**
+   * \brief set whether this operation is pixel-wise and implements updateMemoryBufferArea
+   */
+  void setPixelWise(bool pixelWise)
+  {
+    this->m_pixelWise = pixelWise;
+  }
+
   /**
    * \brief set if this NodeOperation can be scheduled on a OpenCLDevice
    */
@@ -444,6 +513,10 @@ class NodeOperationInput {
   /** Connected output */
   NodeOperationOutput *m_link;
 
+  /** The socket reads data that is not an image, e.g. speed vectors or cryptomatte IDs. Buffers
+   * read by it are never stored at half precision, also when it is a color socket. */
+  bool m_fullPrecision;
+
  public:
   NodeOperationInput(NodeOperation *op,
                      DataType datatype,
@@ -480,6 +553,15 @@ class NodeOperationInput {
     return this->m_resizeMode;
   }
 
+  void setFullPrecision(bool fullPrecision)
+  {
+    this->m_fullPrecision = fullPrecision;
+  }
+  bool isFullPrecision() const
+  {
+    return this->m_fullPrecision;
+  }
+
   SocketReader *getReader();
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
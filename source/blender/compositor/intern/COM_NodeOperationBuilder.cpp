@@ -23,8 +23,11 @@
 #include "COM_ExecutionSystem.h"
 #include "COM_Node.h"
 #include "COM_NodeConverter.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketProxyNode.h"
 
+#include "COM_ConvertOperation.h"
+#include "COM_FusedOperation.h"
 #include "COM_NodeOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
@@ -38,7 +41,11 @@
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(NULL), m_active_viewer(NULL)
+    : m_context(context),
+      m_current_node(NULL),
+      m_current_node_hash(COM_HASH_NONE),
+      m_current_node_operations(0),
+      m_active_viewer(NULL)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -51,11 +58,14 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 {
   /* interface handle for nodes */
   NodeConverter converter(this);
+  const bool use_result_cache = m_context->isResultCacheEnabled();
 
   for (int index = 0; index < m_graph.nodes().size(); index++) {
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_hash = use_result_cache ? ResultCache::hashNode(node) : COM_HASH_NONE;
+    m_current_node_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -107,6 +117,11 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* surround complex ops with read/write buffer */
   add_complex_operation_buffers();
 
+  /* evaluate chains of pixel-wise ops together */
+  if (m_context->isBufferedExecution()) {
+    fuse_pixel_wise_operations();
+  }
+
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
   m_links.clear();
@@ -125,6 +140,17 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+  if (m_current_node) {
+    /* Operations of the same node are told apart by the order in which they are added. */
+    if (m_current_node_hash != COM_HASH_NONE) {
+      uint64_t data[2] = {m_current_node_hash, m_current_node_operations};
+      operation->setParameterHash(ResultCache::hashData(data, sizeof(data)));
+    }
+    else {
+      operation->setParameterHash(COM_HASH_NONE);
+    }
+    m_current_node_operations++;
+  }
   m_operations.push_back(operation);
 }
 
@@ -336,6 +362,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input,
 
       SetValueOperation *op = new SetValueOperation();
       op->setValue(value);
+      op->setParameterHash(ResultCache::hashData(&value, sizeof(value)));
       addOperation(op);
       addLink(op->getOutputSocket(), input);
       break;
@@ -351,6 +378,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input,
 
       SetColorOperation *op = new SetColorOperation();
       op->setChannels(value);
+      op->setParameterHash(ResultCache::hashData(value, sizeof(value)));
       addOperation(op);
       addLink(op->getOutputSocket(), input);
       break;
@@ -366,6 +394,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input,
 
       SetVectorOperation *op = new SetVectorOperation();
       op->setVector(value);
+      op->setParameterHash(ResultCache::hashData(value, sizeof(value)));
       addOperation(op);
       addLink(op->getOutputSocket(), input);
       break;
@@ -479,8 +508,22 @@ WriteBufferOperation *NodeOperationBuilder::find_attached_write_buffer_operation
   return NULL;
 }
 
-void NodeOperationBuilder::add_input_buffers(NodeOperation * /*operation*/,
-                                             NodeOperationInput *input)
+/* The output converted by op when it only adds channels, ReadBufferOperation can do that. */
+static NodeOperationOutput *find_unconverted_output(NodeOperation *op)
+{
+  if (!(dynamic_cast<ConvertValueToColorOperation *>(op) ||
+        dynamic_cast<ConvertValueToVectorOperation *>(op) ||
+        dynamic_cast<ConvertVectorToColorOperation *>(op))) {
+    return NULL;
+  }
+  NodeOperationInput *input = op->getInputSocket(0);
+  if (!input->isConnected() || input->getLink()->getOperation().isReadBufferOperation()) {
+    return NULL;
+  }
+  return input->getLink();
+}
+
+void NodeOperationBuilder::add_input_buffers(NodeOperation *operation, NodeOperationInput *input)
 {
   if (!input->isConnected()) {
     return;
@@ -495,6 +538,16 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation * /*operation*/,
   /* this link will be replaced below */
   removeInputLink(input);
 
+  /* with half float buffers, buffer values and vectors with their own channels and let the
+   * ReadBufferOperation convert them, OpenCL kernels read the buffers directly */
+  const DataType datatype = output->getDataType();
+  if (m_context->isHalfBuffers() && !operation->isOpenCL()) {
+    NodeOperationOutput *unconverted = find_unconverted_output(&output->getOperation());
+    if (unconverted) {
+      output = unconverted;
+    }
+  }
+
   /* check of other end already has write operation, otherwise add a new one */
   WriteBufferOperation *writeoperation = find_attached_write_buffer_operation(output);
   if (!writeoperation) {
@@ -508,7 +561,7 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation * /*operation*/,
   }
 
   /* add readbuffer op for the input */
-  ReadBufferOperation *readoperation = new ReadBufferOperation(output->getDataType());
+  ReadBufferOperation *readoperation = new ReadBufferOperation(datatype);
   readoperation->setMemoryProxy(writeoperation->getMemoryProxy());
   this->addOperation(readoperation);
 
@@ -597,6 +650,108 @@ void NodeOperationBuilder::add_complex_operation_buffers()
   }
 }
 
+typedef std::map<NodeOperationOutput *, NodeOperationBuilder::OpInputs> OutputLinks;
+
+/* A pixel-wise operation is fused into the operation reading it when that is the only reader and
+ * it is pixel-wise as well. */
+static bool is_fused_into_reader(NodeOperation *op, const OutputLinks &output_links)
+{
+  if (!op->isPixelWise() || op->getNumberOfOutputSockets() != 1) {
+    return false;
+  }
+  OutputLinks::const_iterator it = output_links.find(op->getOutputSocket());
+  if (it == output_links.end() || it->second.size() != 1) {
+    return false;
+  }
+  return it->second.front()->getOperation().isPixelWise();
+}
+
+/* Collect the operations fused into op, inputs before the operations reading them. */
+static void collect_fused_operations_recursive(NodeOperationBuilder::Operations &fused_ops,
+                                               const OutputLinks &output_links,
+                                               NodeOperation *op)
+{
+  for (int i = 0; i < op->getNumberOfInputSockets(); i++) {
+    NodeOperationInput *input = op->getInputSocket(i);
+    if (input->isConnected()) {
+      NodeOperation *input_op = &input->getLink()->getOperation();
+      if (is_fused_into_reader(input_op, output_links)) {
+        collect_fused_operations_recursive(fused_ops, output_links, input_op);
+      }
+    }
+  }
+  fused_ops.push_back(op);
+}
+
+void NodeOperationBuilder::fuse_pixel_wise_operations()
+{
+  OutputLinks output_links;
+  for (Links::const_iterator it = m_links.begin(); it != m_links.end(); ++it) {
+    output_links[it->from()].push_back(it->to());
+  }
+
+  /* note: the fused operations are owned by the FusedOperation from here on */
+  std::vector<FusedOperation *> fused_ops;
+  std::set<NodeOperation *> fused;
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    if (!op->isPixelWise() || op->getNumberOfOutputSockets() != 1 ||
+        is_fused_into_reader(op, output_links)) {
+      continue;
+    }
+
+    Operations chain;
+    collect_fused_operations_recursive(chain, output_links, op);
+    if (chain.size() < 2) {
+      continue;
+    }
+
+    fused_ops.push_back(new FusedOperation(chain));
+    fused.insert(chain.begin(), chain.end());
+  }
+
+  if (fused_ops.empty()) {
+    return;
+  }
+
+  /* readers of the last operation of a chain read the fused operation instead,
+   * this includes operations fused into other chains */
+  for (std::vector<FusedOperation *>::const_iterator it = fused_ops.begin();
+       it != fused_ops.end();
+       ++it) {
+    FusedOperation *fused_op = *it;
+    OutputLinks::const_iterator readers = output_links.find(fused_op->getFusedOutputSocket());
+    if (readers == output_links.end()) {
+      continue;
+    }
+    for (OpInputs::const_iterator it_to = readers->second.begin();
+         it_to != readers->second.end();
+         ++it_to) {
+      removeInputLink(*it_to);
+      addLink(fused_op->getOutputSocket(), *it_to);
+    }
+  }
+
+  for (std::vector<FusedOperation *>::const_iterator it = fused_ops.begin();
+       it != fused_ops.end();
+       ++it) {
+    FusedOperation *fused_op = *it;
+    fused_op->determineInputs();
+    for (int index = 0; index < fused_op->getNumberOfInputSockets(); index++) {
+      addLink(fused_op->getInputLink(index), fused_op->getInputSocket(index));
+    }
+  }
+
+  Operations remaining_ops;
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    if (fused.find(*it) == fused.end()) {
+      remaining_ops.push_back(*it);
+    }
+  }
+  remaining_ops.insert(remaining_ops.end(), fused_ops.begin(), fused_ops.end());
+  m_operations = remaining_ops;
+}
+
 typedef std::set<NodeOperation *> Tags;
 
 static void find_reachable_operations_recursive(Tags &reachable, NodeOperation *op)
@@ -89,6 +89,9 @@ class NodeOperationBuilder {
   OutputSocketMap m_output_map;
 
   Node *m_current_node;
+  /** Parameter hash of the current node and the number of operations it added so far */
+  uint64_t m_current_node_hash;
+  unsigned int m_current_node_operations;
 
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
@@ -159,6 +162,9 @@ class NodeOperationBuilder {
   void add_input_buffers(NodeOperation *operation, NodeOperationInput *input);
   void add_output_buffers(NodeOperation *operation, NodeOperationOutput *output);
 
+  /** Replace chains of pixel-wise operations by a single FusedOperation */
+  void fuse_pixel_wise_operations();
+
   /** Remove unreachable operations */
   void prune_operations();
 
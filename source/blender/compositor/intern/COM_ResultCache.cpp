@@ -0,0 +1,502 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <string.h>
+#include <typeinfo>
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_node.h"
+
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "RNA_access.h"
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+#include "COM_Node.h"
+#include "COM_NodeOperation.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_defines.h"
+
+#include "COM_ResultCache.h" /* own include */
+
+/* Limits the recursion into nested structs of a node, e.g. curve mappings. */
+#define RNA_MAX_DEPTH 4
+
+/**
+ * 64 bit FNV-1a, COM_HASH_NONE is never returned so it can mark results that can't be cached.
+ */
+class Hasher {
+ private:
+  uint64_t m_hash;
+
+ public:
+  Hasher() : m_hash(14695981039346656037ULL)
+  {
+  }
+
+  void add(const void *data, size_t size)
+  {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+      this->m_hash ^= bytes[i];
+      this->m_hash *= 1099511628211ULL;
+    }
+  }
+
+  template<typename T> void add(const T &value)
+  {
+    this->add(&value, sizeof(value));
+  }
+
+  void addString(const char *str)
+  {
+    if (str) {
+      this->add(str, strlen(str) + 1);
+    }
+    else {
+      this->add('\0');
+    }
+  }
+
+  uint64_t get() const
+  {
+    return (this->m_hash == COM_HASH_NONE) ? COM_HASH_EMPTY : this->m_hash;
+  }
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Node Hashing
+ * \{ */
+
+/* Properties that only change the way a node is drawn. */
+static const char *rna_skip_properties[] = {
+    "rna_type",     "name",         "label",           "location",       "width",
+    "width_hidden", "height",       "dimensions",      "select",         "show_options",
+    "show_preview", "show_texture", "hide",            "color",          "use_custom_color",
+    "parent",       "is_linked",    "show_expanded",   "internal_links", NULL,
+};
+
+static bool rna_property_skip(const char *identifier)
+{
+  if (STRPREFIX(identifier, "bl_")) {
+    return true;
+  }
+  for (int i = 0; rna_skip_properties[i]; i++) {
+    if (STREQ(identifier, rna_skip_properties[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Nodes, links and sockets are reachable from almost everywhere, only follow them from the node
+ * itself. */
+static bool rna_struct_skip(StructRNA *type)
+{
+  return RNA_struct_is_a(type, &RNA_Node) || RNA_struct_is_a(type, &RNA_NodeLink) ||
+         RNA_struct_is_a(type, &RNA_NodeSocket);
+}
+
+/**
+ * Only a few datablocks are tracked: images and render results are tagged through
+ * #nodeUpdateID and #ntreeCompositTagRender. Anything else can change without notice.
+ */
+static bool hash_id(Hasher &hasher, bNode *bnode, ID *id)
+{
+  switch (GS(id->name)) {
+    case ID_NT:
+      /* Node groups are flattened, their nodes are hashed on their own. */
+      hasher.add(id);
+      return true;
+    case ID_IM: {
+      const Image *image = (const Image *)id;
+      if (id != bnode->id || ELEM(image->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE)) {
+        return false;
+      }
+      break;
+    }
+    case ID_SCE:
+      if (id != bnode->id || bnode->type != CMP_NODE_R_LAYERS) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+  /* The session UUID is shared with copy-on-write copies of the ID. */
+  hasher.add(id->session_uuid);
+  hasher.add(BKE_node_id_update_generation(id));
+  return true;
+}
+
+static bool hash_rna_struct(Hasher &hasher, PointerRNA *ptr, bNode *bnode, int depth);
+
+static bool hash_rna_pointer(Hasher &hasher, PointerRNA *ptr, bNode *bnode, int depth)
+{
+  if (ptr->data == NULL) {
+    hasher.add((void *)NULL);
+    return true;
+  }
+  if (RNA_struct_is_ID(ptr->type)) {
+    return hash_id(hasher, bnode, (ID *)ptr->data);
+  }
+  if (depth >= RNA_MAX_DEPTH) {
+    return true;
+  }
+  return hash_rna_struct(hasher, ptr, bnode, depth + 1);
+}
+
+static bool hash_rna_property(
+    Hasher &hasher, PointerRNA *ptr, PropertyRNA *prop, bNode *bnode, int depth)
+{
+  const int length = RNA_property_array_length(ptr, prop);
+
+  switch (RNA_property_type(prop)) {
+    case PROP_BOOLEAN:
+      if (length) {
+        bool *values = (bool *)MEM_mallocN(sizeof(bool) * length, __func__);
+        RNA_property_boolean_get_array(ptr, prop, values);
+        hasher.add(values, sizeof(bool) * length);
+        MEM_freeN(values);
+      }
+      else {
+        hasher.add(RNA_property_boolean_get(ptr, prop));
+      }
+      return true;
+    case PROP_INT:
+      if (length) {
+        int *values = (int *)MEM_mallocN(sizeof(int) * length, __func__);
+        RNA_property_int_get_array(ptr, prop, values);
+        hasher.add(values, sizeof(int) * length);
+        MEM_freeN(values);
+      }
+      else {
+        hasher.add(RNA_property_int_get(ptr, prop));
+      }
+      return true;
+    case PROP_FLOAT:
+      if (length) {
+        float *values = (float *)MEM_mallocN(sizeof(float) * length, __func__);
+        RNA_property_float_get_array(ptr, prop, values);
+        hasher.add(values, sizeof(float) * length);
+        MEM_freeN(values);
+      }
+      else {
+        hasher.add(RNA_property_float_get(ptr, prop));
+      }
+      return true;
+    case PROP_ENUM:
+      hasher.add(RNA_property_enum_get(ptr, prop));
+      return true;
+    case PROP_STRING: {
+      char fixedbuf[256];
+      int len;
+      char *value = RNA_property_string_get_alloc(ptr, prop, fixedbuf, sizeof(fixedbuf), &len);
+      hasher.add(value, len);
+      if (value != fixedbuf) {
+        MEM_freeN(value);
+      }
+      return true;
+    }
+    case PROP_POINTER: {
+      PointerRNA pointer = RNA_property_pointer_get(ptr, prop);
+      if (pointer.data && rna_struct_skip(pointer.type)) {
+        return true;
+      }
+      return hash_rna_pointer(hasher, &pointer, bnode, depth);
+    }
+    case PROP_COLLECTION: {
+      /* The sockets of the node hold the values of unconnected inputs. */
+      const bool is_socket_list = (depth == 0) && RNA_struct_is_a(ptr->type, &RNA_Node);
+      bool cacheable = true;
+      int items = 0;
+      RNA_PROP_BEGIN (ptr, itemptr, prop) {
+        if (!is_socket_list && rna_struct_skip(itemptr.type)) {
+          continue;
+        }
+        cacheable = hash_rna_pointer(hasher, &itemptr, bnode, depth);
+        items++;
+        if (!cacheable) {
+          break;
+        }
+      }
+      RNA_PROP_END;
+      hasher.add(items);
+      return cacheable;
+    }
+  }
+  return true;
+}
+
+static bool hash_rna_struct(Hasher &hasher, PointerRNA *ptr, bNode *bnode, int depth)
+{
+  bool cacheable = true;
+
+  hasher.addString(RNA_struct_identifier(ptr->type));
+  RNA_STRUCT_BEGIN (ptr, prop) {
+    const char *identifier = RNA_property_identifier(prop);
+    if (rna_property_skip(identifier)) {
+      continue;
+    }
+    hasher.addString(identifier);
+    cacheable = hash_rna_property(hasher, ptr, prop, bnode, depth);
+    if (!cacheable) {
+      break;
+    }
+  }
+  RNA_STRUCT_END;
+
+  return cacheable;
+}
+
+uint64_t ResultCache::hashNode(Node *node)
+{
+  bNodeTree *ntree = node->getbNodeTree();
+  bNode *bnode = node->getbNode();
+  if (ntree == NULL || bnode == NULL) {
+    return COM_HASH_NONE;
+  }
+
+  Hasher hasher;
+  hasher.add(bnode->type);
+  hasher.addString(bnode->idname);
+  hasher.add(bnode->custom1);
+  hasher.add(bnode->custom2);
+  hasher.add(bnode->custom3);
+  hasher.add(bnode->custom4);
+
+  PointerRNA ptr;
+  RNA_pointer_create(&ntree->id, &RNA_Node, bnode, &ptr);
+  if (!hash_rna_struct(hasher, &ptr, bnode, 0)) {
+    return COM_HASH_NONE;
+  }
+  return hasher.get();
+}
+
+uint64_t ResultCache::hashData(const void *data, size_t size)
+{
+  Hasher hasher;
+  hasher.add(data, size);
+  return hasher.get();
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Operation Keys
+ * \{ */
+
+static uint64_t hash_context(const CompositorContext &context)
+{
+  const RenderData *rd = context.getRenderData();
+  Hasher hasher;
+  hasher.add(context.getFramenumber());
+  hasher.add(context.getQuality());
+  hasher.add(context.isRendering());
+  hasher.add(context.isFastCalculation());
+  hasher.addString(context.getViewName());
+  if (rd) {
+    hasher.add(rd->xsch);
+    hasher.add(rd->ysch);
+    hasher.add(rd->size);
+    hasher.add(rd->mode);
+    hasher.add(rd->border);
+  }
+  return hasher.get();
+}
+
+static uint64_t determine_key(NodeOperation *operation,
+                              uint64_t context_hash,
+                              ResultCache::Keys *keys)
+{
+  ResultCache::Keys::const_iterator it = keys->find(operation);
+  if (it != keys->end()) {
+    return it->second;
+  }
+
+  uint64_t key = COM_HASH_NONE;
+  if (operation->isReadBufferOperation()) {
+    MemoryProxy *proxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+    key = determine_key(proxy->getWriteBufferOperation(), context_hash, keys);
+  }
+  else if (operation->getParameterHash() != COM_HASH_NONE) {
+    Hasher hasher;
+    bool cacheable = true;
+    hasher.add(context_hash);
+    hasher.addString(typeid(*operation).name());
+    hasher.add(operation->getWidth());
+    hasher.add(operation->getHeight());
+    hasher.add(operation->getParameterHash());
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      NodeOperationInput *input = operation->getInputSocket(index);
+      const uint64_t input_key = input->isConnected() ?
+                                     determine_key(
+                                         &input->getLink()->getOperation(), context_hash, keys) :
+                                     COM_HASH_NONE;
+      if (input_key == COM_HASH_NONE) {
+        cacheable = false;
+        break;
+      }
+      hasher.add(input_key);
+    }
+    if (cacheable) {
+      key = hasher.get();
+    }
+  }
+
+  (*keys)[operation] = key;
+  return key;
+}
+
+void ResultCache::determineKeys(const CompositorContext &context,
+                                const std::vector<NodeOperation *> &operations,
+                                Keys *r_keys)
+{
+  const uint64_t context_hash = hash_context(context);
+  for (unsigned int index = 0; index < operations.size(); index++) {
+    determine_key(operations[index], context_hash, r_keys);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Storage
+ * \{ */
+
+typedef struct CacheEntry {
+  struct CacheEntry *next, *prev;
+  uint64_t key;
+  MemoryBuffer *buffer;
+  size_t size;
+} CacheEntry;
+
+/* The cached results of the node tree of one scene, within the memory limit of that tree. */
+typedef struct TreeCache {
+  std::map<uint64_t, CacheEntry *> entries;
+  /* The entries, the most recently used one first. */
+  ListBase lru;
+  size_t size;
+} TreeCache;
+
+/* Trees by the session UUID of their scene, the same for the copy-on-write scene of renders. */
+static std::map<unsigned int, TreeCache> g_trees;
+static ThreadMutex g_mutex = BLI_MUTEX_INITIALIZER;
+
+static TreeCache &tree_cache(const CompositorContext &context)
+{
+  return g_trees[context.getScene()->id.session_uuid];
+}
+
+static void entry_free(TreeCache &cache, CacheEntry *entry)
+{
+  cache.entries.erase(entry->key);
+  BLI_remlink(&cache.lru, entry);
+  cache.size -= entry->size;
+  delete entry->buffer;
+  MEM_freeN(entry);
+}
+
+bool ResultCache::acquire(const CompositorContext &context, uint64_t key, MemoryProxy *proxy)
+{
+  MemoryBuffer *buffer = proxy->getBuffer();
+  if (key == COM_HASH_NONE || buffer == NULL) {
+    return false;
+  }
+
+  BLI_mutex_lock(&g_mutex);
+  TreeCache &cache = tree_cache(context);
+  std::map<uint64_t, CacheEntry *>::iterator it = cache.entries.find(key);
+  bool found = false;
+  if (it != cache.entries.end()) {
+    CacheEntry *entry = it->second;
+    MemoryBuffer *cached = entry->buffer;
+    if (cached->getWidth() == buffer->getWidth() && cached->getHeight() == buffer->getHeight() &&
+        cached->get_num_channels() == buffer->get_num_channels() &&
+        cached->isHalfFloat() == buffer->isHalfFloat()) {
+      buffer->copyContentFrom(cached);
+      BLI_remlink(&cache.lru, entry);
+      BLI_addhead(&cache.lru, entry);
+      found = true;
+    }
+  }
+  BLI_mutex_unlock(&g_mutex);
+
+  return found;
+}
+
+void ResultCache::store(const CompositorContext &context, uint64_t key, MemoryProxy *proxy)
+{
+  MemoryBuffer *buffer = proxy->getBuffer();
+  if (key == COM_HASH_NONE || buffer == NULL) {
+    return;
+  }
+
+  const size_t limit = context.getResultCacheLimit();
+  BLI_mutex_lock(&g_mutex);
+  TreeCache &cache = tree_cache(context);
+  std::map<uint64_t, CacheEntry *>::iterator it = cache.entries.find(key);
+  if (it != cache.entries.end()) {
+    /* The buffer was restored from the cache. */
+    BLI_remlink(&cache.lru, it->second);
+    BLI_addhead(&cache.lru, it->second);
+  }
+  else {
+    const size_t size = buffer->getMemorySize();
+    /* Evict the least recently used results, also when the limit of the tree was lowered. */
+    while (cache.lru.last && cache.size + size > limit) {
+      entry_free(cache, (CacheEntry *)cache.lru.last);
+    }
+    if (size <= limit) {
+      CacheEntry *entry = (CacheEntry *)MEM_callocN(sizeof(CacheEntry), __func__);
+      entry->key = key;
+      entry->buffer = proxy->releaseBuffer();
+      entry->size = size;
+      BLI_addhead(&cache.lru, entry);
+      cache.entries[key] = entry;
+      cache.size += size;
+    }
+  }
+  BLI_mutex_unlock(&g_mutex);
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_mutex);
+  for (std::map<unsigned int, TreeCache>::iterator it = g_trees.begin(); it != g_trees.end();
+       ++it) {
+    TreeCache &cache = it->second;
+    while (cache.lru.first) {
+      entry_free(cache, (CacheEntry *)cache.lru.first);
+    }
+  }
+  g_trees.clear();
+  BLI_mutex_unlock(&g_mutex);
+}
+
+/** \} */
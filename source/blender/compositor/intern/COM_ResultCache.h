@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include <map>
+#include <vector>
+
+#include "BLI_sys_types.h"
+
+class CompositorContext;
+class MemoryProxy;
+class Node;
+class NodeOperation;
+
+/**
+ * \brief keeps the buffers written by WriteBufferOperations between executions
+ * \ingroup Memory
+ *
+ * Every operation gets a key, the hash of its type, resolution, parameters and the keys of its
+ * inputs. When the key of a WriteBufferOperation did not change since the previous execution
+ * its buffer is restored from the cache, so its ExecutionGroup and everything upstream is not
+ * executed again. Every node tree has its own buffers within its own memory limit, the least
+ * recently used ones are evicted first.
+ */
+class ResultCache {
+ public:
+  typedef std::map<NodeOperation *, uint64_t> Keys;
+
+  /**
+   * \brief hash the parameters of a node
+   * \return COM_HASH_NONE when the result of the node depends on data that is not tracked
+   */
+  static uint64_t hashNode(Node *node);
+
+  /**
+   * \brief hash the parameters of an operation that are not stored in a node
+   */
+  static uint64_t hashData(const void *data, size_t size);
+
+  /**
+   * \brief determine the keys of all operations, COM_HASH_NONE when it can't be cached
+   */
+  static void determineKeys(const CompositorContext &context,
+                            const std::vector<NodeOperation *> &operations,
+                            Keys *r_keys);
+
+  /**
+   * \brief copy the buffer cached for key by the node tree of context into the buffer of proxy
+   * \return false when there is no matching buffer in the cache
+   */
+  static bool acquire(const CompositorContext &context, uint64_t key, MemoryProxy *proxy);
+
+  /**
+   * \brief take over the buffer of proxy and keep it for key, within the memory limit of the
+   * node tree of context
+   */
+  static void store(const CompositorContext &context, uint64_t key, MemoryProxy *proxy);
+
+  /**
+   * \brief free all cached buffers
+   */
+  static void clear();
+};
+
+#endif
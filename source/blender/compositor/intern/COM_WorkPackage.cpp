@@ -18,8 +18,12 @@
 
 #include "COM_WorkPackage.h"
 
-WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber)
+#include "PIL_time.h"
+
+WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber, bool priority)
 {
   this->m_executionGroup = group;
   this->m_chunkNumber = chunkNumber;
+  this->m_priority = priority;
+  this->m_scheduleTime = PIL_check_seconds_timer();
 }
@@ -39,13 +39,24 @@ class WorkPackage {
    */
   unsigned int m_chunkNumber;
 
+  /**
+   * \brief execute before packages without priority
+   */
+  bool m_priority;
+
+  /**
+   * \brief time the package was scheduled, for statistics
+   */
+  double m_scheduleTime;
+
  public:
   /**
    * constructor
    * \param group: the ExecutionGroup
    * \param chunkNumber: the number of the chunk
+   * \param priority: the chunk is visible in the viewer close to a hotspot
    */
-  WorkPackage(ExecutionGroup *group, unsigned int chunkNumber);
+  WorkPackage(ExecutionGroup *group, unsigned int chunkNumber, bool priority = false);
 
   /**
    * \brief get the ExecutionGroup
@@ -63,6 +74,16 @@ class WorkPackage {
     return this->m_chunkNumber;
   }
 
+  bool hasPriority() const
+  {
+    return this->m_priority;
+  }
+
+  double getScheduleTime() const
+  {
+    return this->m_scheduleTime;
+  }
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
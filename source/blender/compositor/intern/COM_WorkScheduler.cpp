@@ -16,10 +16,13 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
+#include <string.h>
 
 #include "COM_CPUDevice.h"
+#include "COM_Debug.h"
 #include "COM_OpenCLDevice.h"
 #include "COM_OpenCLKernels.cl.h"
 #include "COM_WorkScheduler.h"
@@ -29,6 +32,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
@@ -44,16 +49,38 @@
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
 #endif
 
+/// \brief number of consecutive chunks of an ExecutionGroup queued for the same CPUDevice
+#define COM_CPU_AFFINITY_CHUNKS 4
+
 /// \brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is created
 static vector<CPUDevice *> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-/// \brief list of all thread for every CPUDevice in cpudevices a thread exists
-static ListBase g_cputhreads;
+/**
+ * \brief work scheduled for a CPUDevice
+ * packages with priority are executed first, devices without work steal from the queues of other
+ * devices.
+ */
+struct CPUQueue {
+  SpinLock lock;
+  std::deque<WorkPackage *> priorityPackages;
+  std::deque<WorkPackage *> packages;
+  /// \brief the device is executing work, guarded by g_cpuqueues_lock
+  bool active;
+  /// \brief statistics of the device, only written by the thread executing the device
+  WorkScheduler::DeviceStats stats;
+};
+/// \brief the queue of every CPUDevice in cpudevices
+static vector<CPUQueue *> g_cpuqueues;
+static SpinLock g_cpuqueues_lock;
+/// \brief start of the last execution and its duration once it stopped
+static double g_start_time = 0.0;
+static double g_execution_time = 0.0;
+/// \brief task pool executing the cpu queues
+static TaskPool *g_cpupool;
 static bool g_cpuInitialized = false;
-/// \brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/// \brief all scheduled work for the gpu
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -72,19 +99,163 @@ static bool g_openclInitialized = false;
 #endif
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-void *WorkScheduler::thread_execute_cpu(void *data)
+static void cpu_queues_init(int num_queues)
 {
-  CPUDevice *device = (CPUDevice *)data;
-  WorkPackage *work;
-  BLI_thread_local_set(g_thread_device, device);
-  while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
-    device->execute(work);
-    delete work;
+  BLI_spin_init(&g_cpuqueues_lock);
+  for (int index = 0; index < num_queues; index++) {
+    CPUQueue *queue = new CPUQueue();
+    BLI_spin_init(&queue->lock);
+    queue->active = false;
+    memset(&queue->stats, 0, sizeof(queue->stats));
+    g_cpuqueues.push_back(queue);
+  }
+}
+
+static void cpu_queues_free()
+{
+  while (g_cpuqueues.size() > 0) {
+    CPUQueue *queue = g_cpuqueues.back();
+    g_cpuqueues.pop_back();
+    BLI_assert(queue->packages.empty() && queue->priorityPackages.empty());
+    BLI_spin_end(&queue->lock);
+    delete queue;
+  }
+  BLI_spin_end(&g_cpuqueues_lock);
+}
+
+static void cpu_queue_push(CPUQueue *queue, WorkPackage *package)
+{
+  BLI_spin_lock(&queue->lock);
+  if (package->hasPriority()) {
+    queue->priorityPackages.push_back(package);
+  }
+  else {
+    queue->packages.push_back(package);
+  }
+  BLI_spin_unlock(&queue->lock);
+}
+
+static WorkPackage *cpu_queue_pop(CPUQueue *queue, bool priority, bool steal)
+{
+  std::deque<WorkPackage *> &packages = priority ? queue->priorityPackages : queue->packages;
+  WorkPackage *package = NULL;
+
+  BLI_spin_lock(&queue->lock);
+  if (!packages.empty()) {
+    /* Thieves take the last package, so the owner continues with consecutive chunks. Priority
+     * packages are always taken in order. */
+    if (steal && !priority) {
+      package = packages.back();
+      packages.pop_back();
+    }
+    else {
+      package = packages.front();
+      packages.pop_front();
+    }
   }
+  BLI_spin_unlock(&queue->lock);
+  return package;
+}
 
+/* Next package for the device at index, priority packages of all queues come first. */
+static WorkPackage *cpu_queues_pop(int index, bool *r_stolen)
+{
+  const int num_queues = g_cpuqueues.size();
+  for (int priority = 1; priority >= 0; priority--) {
+    for (int offset = 0; offset < num_queues; offset++) {
+      CPUQueue *queue = g_cpuqueues[(index + offset) % num_queues];
+      WorkPackage *package = cpu_queue_pop(queue, priority, offset != 0);
+      if (package) {
+        *r_stolen = offset != 0;
+        return package;
+      }
+    }
+  }
   return NULL;
 }
 
+static bool cpu_queue_has_work(CPUQueue *queue)
+{
+  BLI_spin_lock(&queue->lock);
+  const bool result = !queue->packages.empty() || !queue->priorityPackages.empty();
+  BLI_spin_unlock(&queue->lock);
+  return result;
+}
+
+static bool cpu_queues_have_work()
+{
+  bool result = false;
+  for (int index = 0; index < g_cpuqueues.size() && !result; index++) {
+    result = cpu_queue_has_work(g_cpuqueues[index]);
+  }
+  return result;
+}
+
+/* Claim a device that is not executing work, preferably one with queued work.
+ * The lock of a queue is only taken within g_cpuqueues_lock, never the other way around. */
+static int cpu_device_acquire()
+{
+  int result = -1;
+  BLI_spin_lock(&g_cpuqueues_lock);
+  for (int index = 0; index < g_cpuqueues.size(); index++) {
+    CPUQueue *queue = g_cpuqueues[index];
+    if (!queue->active) {
+      const bool has_work = cpu_queue_has_work(queue);
+      if (result == -1 || has_work) {
+        result = index;
+      }
+      if (has_work) {
+        break;
+      }
+    }
+  }
+  if (result != -1) {
+    g_cpuqueues[result]->active = true;
+  }
+  BLI_spin_unlock(&g_cpuqueues_lock);
+  return result;
+}
+
+static void cpu_device_release(int index)
+{
+  BLI_spin_lock(&g_cpuqueues_lock);
+  g_cpuqueues[index]->active = false;
+  BLI_spin_unlock(&g_cpuqueues_lock);
+}
+
+/* Task executing work on a free CPUDevice. The queue of the device is executed first, when it is
+ * empty work is stolen from the queues of the other devices. */
+static void thread_execute_cpu(TaskPool *__restrict /*pool*/, void * /*data*/)
+{
+  int index;
+  /* Every package pushes a task, when all devices are busy the task has nothing to do. */
+  while ((index = cpu_device_acquire()) != -1) {
+    CPUDevice *device = g_cpudevices[index];
+    WorkScheduler::DeviceStats &stats = g_cpuqueues[index]->stats;
+    WorkPackage *work;
+    bool stolen;
+    BLI_thread_local_set(g_thread_device, device);
+    while ((work = cpu_queues_pop(index, &stolen))) {
+      const double start_time = PIL_check_seconds_timer();
+      device->execute(work);
+      const double latency = start_time - work->getScheduleTime();
+      stats.packages++;
+      stats.stolen += stolen ? 1 : 0;
+      stats.busy_time += PIL_check_seconds_timer() - start_time;
+      stats.latency_total += latency;
+      stats.latency_max = max_dd(stats.latency_max, latency);
+      delete work;
+    }
+    BLI_thread_local_set(g_thread_device, NULL);
+    cpu_device_release(index);
+
+    /* Work scheduled while this device was busy could have found no free device. */
+    if (!cpu_queues_have_work()) {
+      break;
+    }
+  }
+}
+
 void *WorkScheduler::thread_execute_gpu(void *data)
 {
   Device *device = (Device *)data;
@@ -99,9 +270,18 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 }
 #endif
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static void schedule_cpu(WorkPackage *package)
+{
+  const int index = (package->getChunkNumber() / COM_CPU_AFFINITY_CHUNKS) % g_cpuqueues.size();
+  cpu_queue_push(g_cpuqueues[index], package);
+  BLI_task_pool_push(g_cpupool, thread_execute_cpu, NULL, false, NULL);
+}
+#endif
+
+void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber, bool priority)
 {
-  WorkPackage *package = new WorkPackage(group, chunkNumber);
+  WorkPackage *package = new WorkPackage(group, chunkNumber, priority);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
   CPUDevice device(0);
   device.execute(package);
@@ -112,10 +292,10 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
     BLI_thread_queue_push(g_gpuqueue, package);
   }
   else {
-    BLI_thread_queue_push(g_cpuqueue, package);
+    schedule_cpu(package);
   }
 #  else
-  BLI_thread_queue_push(g_cpuqueue, package);
+  schedule_cpu(package);
 #  endif
 #endif
 }
@@ -124,12 +304,12 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   unsigned int index;
-  g_cpuqueue = BLI_thread_queue_init();
-  BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
-  for (index = 0; index < g_cpudevices.size(); index++) {
-    Device *device = g_cpudevices[index];
-    BLI_threadpool_insert(&g_cputhreads, device);
+  g_cpupool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  for (index = 0; index < g_cpuqueues.size(); index++) {
+    memset(&g_cpuqueues[index]->stats, 0, sizeof(DeviceStats));
   }
+  g_start_time = PIL_check_seconds_timer();
+  g_execution_time = 0.0;
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
     g_gpuqueue = BLI_thread_queue_init();
@@ -152,23 +332,23 @@ void WorkScheduler::finish()
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
   }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
-  }
-#  else
-  BLI_thread_queue_wait_finish(cpuqueue);
 #  endif
+  BLI_task_pool_work_and_wait(g_cpupool);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  BLI_thread_queue_nowait(g_cpuqueue);
-  BLI_threadpool_end(&g_cputhreads);
-  BLI_thread_queue_free(g_cpuqueue);
-  g_cpuqueue = NULL;
+  BLI_task_pool_work_and_wait(g_cpupool);
+  BLI_task_pool_free(g_cpupool);
+  g_cpupool = NULL;
+  /* Scratch memory is only reused within an execution. */
+  for (int index = 0; index < g_cpudevices.size(); index++) {
+    g_cpudevices[index]->clearScratch();
+  }
+  g_execution_time = PIL_check_seconds_timer() - g_start_time;
+  DebugInfo::scheduler_finished();
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -180,6 +360,35 @@ void WorkScheduler::stop()
 #endif
 }
 
+int WorkScheduler::get_num_cpu_devices()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  return g_cpuqueues.size();
+#else
+  return 0;
+#endif
+}
+
+WorkScheduler::DeviceStats WorkScheduler::get_cpu_device_stats(int index)
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  return g_cpuqueues[index]->stats;
+#else
+  (void)index;
+  DeviceStats stats = {0, 0, 0.0, 0.0, 0.0};
+  return stats;
+#endif
+}
+
+double WorkScheduler::get_execution_time()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  return g_execution_time;
+#else
+  return 0.0;
+#endif
+}
+
 bool WorkScheduler::hasGPUDevices()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
@@ -217,6 +426,7 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
       delete device;
     }
     if (g_cpuInitialized) {
+      cpu_queues_free();
       BLI_thread_local_delete(g_thread_device);
     }
     g_cpuInitialized = false;
@@ -229,6 +439,7 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
       device->initialize();
       g_cpudevices.push_back(device);
     }
+    cpu_queues_init(num_cpu_threads);
     BLI_thread_local_create(g_thread_device);
     g_cpuInitialized = true;
   }
@@ -337,6 +548,7 @@ void WorkScheduler::deinitialize()
       device->deinitialize();
       delete device;
     }
+    cpu_queues_free();
     BLI_thread_local_delete(g_thread_device);
     g_cpuInitialized = false;
   }
@@ -371,3 +583,12 @@ int WorkScheduler::current_thread_id()
   CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
   return device->thread_id();
 }
+
+CPUDevice *WorkScheduler::current_cpu_device()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  return (CPUDevice *)BLI_thread_local_get(g_thread_device);
+#else
+  return NULL;
+#endif
+}
@@ -27,6 +27,8 @@
 #include "COM_WorkPackage.h"
 #include "COM_defines.h"
 
+class CPUDevice;
+
 /** \brief the workscheduler
  * \ingroup execution
  */
@@ -38,12 +40,6 @@ class WorkScheduler {
    */
   static bool isStopping();
 
-  /**
-   * \brief main thread loop for cpudevices
-   * inside this loop new work is queried and being executed
-   */
-  static void *thread_execute_cpu(void *data);
-
   /**
    * \brief main thread loop for gpudevices
    * inside this loop new work is queried and being executed
@@ -55,12 +51,14 @@ class WorkScheduler {
    * \brief schedule a chunk of a group to be calculated.
    * An execution group schedules a chunk in the WorkScheduler
    * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
-   * otherwise the work is scheduled for an CPUDevice
+   * otherwise the work is scheduled for an CPUDevice. Consecutive chunks of a group are queued
+   * for the same CPUDevice.
    * \see ExecutionGroup.execute
    * \param group: the execution group
    * \param chunkNumber: the number of the chunk in the group to be executed
+   * \param priority: execute before work without priority
    */
-  static void schedule(ExecutionGroup *group, int chunkNumber);
+  static void schedule(ExecutionGroup *group, int chunkNumber, bool priority = false);
 
   /**
    * \brief initialize the WorkScheduler
@@ -84,15 +82,15 @@ class WorkScheduler {
 
   /**
    * \brief Start the execution
-   * this methods will start the WorkScheduler. Inside this method all threads are initialized.
-   * for every device a thread is created.
+   * this methods will start the WorkScheduler. CPU work is executed in a task pool of the BLI
+   * task scheduler, for every GPU device a thread is created.
    * \see initialize Initialization and query of the number of devices
    */
   static void start(CompositorContext &context);
 
   /**
    * \brief stop the execution
-   * All created thread by the start method are destroyed.
+   * The task pool and all created threads by the start method are destroyed.
    * \see start
    */
   static void stop();
@@ -110,8 +108,36 @@ class WorkScheduler {
    */
   static bool hasGPUDevices();
 
+  /** \brief work package statistics of a CPUDevice since the last start */
+  typedef struct DeviceStats {
+    /** Executed packages, and packages taken from the queue of another device. */
+    int packages;
+    int stolen;
+    /** Time spent executing packages. */
+    double busy_time;
+    /** Time between scheduling and execution of packages. */
+    double latency_total;
+    double latency_max;
+  } DeviceStats;
+
+  static int get_num_cpu_devices();
+  /**
+   * \brief statistics of the CPUDevice at index, valid once the execution stopped
+   * \see stop
+   */
+  static DeviceStats get_cpu_device_stats(int index);
+  /**
+   * \brief time between the last start and stop of the WorkScheduler
+   */
+  static double get_execution_time();
+
   static int current_thread_id();
 
+  /**
+   * \brief the CPUDevice executing work on the calling thread, NULL when there is none
+   */
+  static CPUDevice *current_cpu_device();
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkScheduler")
 #endif
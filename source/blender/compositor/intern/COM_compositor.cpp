@@ -16,6 +16,10 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include <string.h>
+#include <vector>
+
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -25,12 +29,15 @@
 
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 #include "clew.h"
 
 static ThreadMutex s_compositorMutex;
 static bool is_compositorMutex_init = false;
+/* Statistics of the last execution, guarded by s_compositorMutex. */
+static std::vector<COM_OperationStats> s_operationStats;
 
 void COM_execute(RenderData *rd,
                  Scene *scene,
@@ -90,6 +97,7 @@ void COM_execute(RenderData *rd,
     ExecutionSystem *system = new ExecutionSystem(
         rd, scene, editingtree, rendering, twopass, viewSettings, displaySettings, viewName);
     system->execute();
+    system->getOperationStats(&s_operationStats);
     delete system;
 
     if (editingtree->test_break(editingtree->tbh)) {
@@ -103,16 +111,67 @@ void COM_execute(RenderData *rd,
   ExecutionSystem *system = new ExecutionSystem(
       rd, scene, editingtree, rendering, false, viewSettings, displaySettings, viewName);
   system->execute();
+  system->getOperationStats(&s_operationStats);
   delete system;
 
   BLI_mutex_unlock(&s_compositorMutex);
 }
 
+void COM_executionStats(COM_ExecutionStats *r_stats)
+{
+  memset(r_stats, 0, sizeof(*r_stats));
+  if (!is_compositorMutex_init) {
+    return;
+  }
+
+  BLI_mutex_lock(&s_compositorMutex);
+  const int num_devices = WorkScheduler::get_num_cpu_devices();
+  double busy_time = 0.0, latency_total = 0.0;
+  for (int index = 0; index < num_devices; index++) {
+    const WorkScheduler::DeviceStats stats = WorkScheduler::get_cpu_device_stats(index);
+    r_stats->chunks += stats.packages;
+    r_stats->stolen_chunks += stats.stolen;
+    busy_time += stats.busy_time;
+    latency_total += stats.latency_total;
+    r_stats->latency_max = max_dd(r_stats->latency_max, stats.latency_max);
+  }
+  const double time = WorkScheduler::get_execution_time();
+  if (r_stats->chunks > 0) {
+    r_stats->latency_average = latency_total / r_stats->chunks;
+  }
+  if (time > 0.0 && num_devices > 0) {
+    r_stats->utilization = busy_time / (time * num_devices);
+  }
+  BLI_mutex_unlock(&s_compositorMutex);
+}
+
+int COM_executionOperationStats(COM_OperationStats *r_stats, int max_stats)
+{
+  if (!is_compositorMutex_init) {
+    return 0;
+  }
+
+  BLI_mutex_lock(&s_compositorMutex);
+  const int num_stats = s_operationStats.size();
+  for (int index = 0; index < min_ii(num_stats, max_stats); index++) {
+    r_stats[index] = s_operationStats[index];
+  }
+  BLI_mutex_unlock(&s_compositorMutex);
+  return num_stats;
+}
+
+void COM_clearCaches()
+{
+  ResultCache::clear();
+}
+
 void COM_deinitialize()
 {
+  COM_clearCaches();
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
     WorkScheduler::deinitialize();
+    s_operationStats.clear();
     is_compositorMutex_init = false;
     BLI_mutex_unlock(&s_compositorMutex);
     BLI_mutex_end(&s_compositorMutex);
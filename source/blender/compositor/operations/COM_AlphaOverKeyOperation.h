@@ -34,6 +34,6 @@ class AlphaOverKeyOperation : public MixBaseOperation {
   /**
    * the inner loop of this program
    */
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 #endif
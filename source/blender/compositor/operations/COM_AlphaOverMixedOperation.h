@@ -37,7 +37,7 @@ class AlphaOverMixedOperation : public MixBaseOperation {
   /**
    * the inner loop of this program
    */
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 
   void setX(float x)
   {
@@ -23,32 +23,23 @@ AlphaOverPremultiplyOperation::AlphaOverPremultiplyOperation() : MixBaseOperatio
   /* pass */
 }
 
-void AlphaOverPremultiplyOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void AlphaOverPremultiplyOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputOverColor[4];
-  float value[4];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    /* Zero alpha values should still permit an add of RGB data */
+    if (p.color2[3] < 0.0f) {
+      copy_v4_v4(p.out, p.color1);
+    }
+    else if (value == 1.0f && p.color2[3] >= 1.0f) {
+      copy_v4_v4(p.out, p.color2);
+    }
+    else {
+      float mul = 1.0f - value * p.color2[3];
 
-  this->m_inputValueOperation->readSampled(value, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputOverColor, x, y, sampler);
-
-  /* Zero alpha values should still permit an add of RGB data */
-  if (inputOverColor[3] < 0.0f) {
-    copy_v4_v4(output, inputColor1);
-  }
-  else if (value[0] == 1.0f && inputOverColor[3] >= 1.0f) {
-    copy_v4_v4(output, inputOverColor);
-  }
-  else {
-    float mul = 1.0f - value[0] * inputOverColor[3];
-
-    output[0] = (mul * inputColor1[0]) + value[0] * inputOverColor[0];
-    output[1] = (mul * inputColor1[1]) + value[0] * inputOverColor[1];
-    output[2] = (mul * inputColor1[2]) + value[0] * inputOverColor[2];
-    output[3] = (mul * inputColor1[3]) + value[0] * inputOverColor[3];
-  }
+      p.out[0] = (mul * p.color1[0]) + value * p.color2[0];
+      p.out[1] = (mul * p.color1[1]) + value * p.color2[1];
+      p.out[2] = (mul * p.color1[2]) + value * p.color2[2];
+      p.out[3] = (mul * p.color1[3]) + value * p.color2[3];
+    }
+  });
 }
@@ -18,10 +18,17 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "BLI_rect.h"
+#include "COM_FHTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
 
+/* Blur radius in pixels from which tiles are convolved using the FHT instead of gathering every
+ * pixel, the cost of the gather grows with the area of the bokeh. */
+#define COM_BOKEH_FFT_MIN_RADIUS 16
+
 BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
@@ -41,7 +48,7 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
   this->m_extend_bounds = false;
 }
 
-void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
+void *BokehBlurOperation::initializeTileData(rcti *rect)
 {
   lockMutex();
   if (!this->m_sizeavailable) {
@@ -49,9 +56,103 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
   }
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
   unlockMutex();
+
+  if (rect && useFFT()) {
+    return convolveFFT((MemoryBuffer *)buffer, rect);
+  }
   return buffer;
 }
 
+void BokehBlurOperation::deinitializeTileData(rcti *rect, void *data)
+{
+  if (rect && useFFT()) {
+    MemoryBuffer *result = (MemoryBuffer *)data;
+    delete result;
+  }
+}
+
+int BokehBlurOperation::getPixelSize()
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  return this->m_size * max_dim / 100.0f;
+}
+
+bool BokehBlurOperation::useFFT()
+{
+  return getPixelSize() >= COM_BOKEH_FFT_MIN_RADIUS;
+}
+
+MemoryBuffer *BokehBlurOperation::convolveFFT(MemoryBuffer *inputBuffer, rcti *rect)
+{
+  const int pixelSize = getPixelSize();
+  const int kernelSize = 2 * pixelSize + 1;
+  const float m = this->m_bokehDimension / pixelSize;
+  const rcti *inputRect = inputBuffer->getRect();
+
+  /* The gather reads offsets -pixelSize to pixelSize - 1, the kernel is mirrored for the
+   * convolution. The summed area table of the bokeh over the same offsets gives the sum of the
+   * weights that are inside the input for every pixel. */
+  float *kernel = (float *)MEM_callocN(
+      sizeof(float) * kernelSize * kernelSize * COM_NUM_CHANNELS_COLOR, "bokeh blur kernel");
+  float *table = (float *)MEM_callocN(
+      sizeof(float) * kernelSize * kernelSize * COM_NUM_CHANNELS_COLOR, "bokeh blur weights");
+  for (int j = 0; j < 2 * pixelSize; j++) {
+    for (int i = 0; i < 2 * pixelSize; i++) {
+      float bokeh[4];
+      const int dx = i - pixelSize;
+      const int dy = j - pixelSize;
+      this->m_inputBokehProgram->readSampled(
+          bokeh, this->m_bokehMidX - dx * m, this->m_bokehMidY - dy * m, COM_PS_NEAREST);
+      copy_v4_v4(&kernel[((pixelSize - dy) * kernelSize + pixelSize - dx) * 4], bokeh);
+
+      float *sum = &table[((j + 1) * kernelSize + i + 1) * 4];
+      add_v4_v4v4(sum, bokeh, &table[((j + 1) * kernelSize + i) * 4]);
+      add_v4_v4(sum, &table[(j * kernelSize + i + 1) * 4]);
+      sub_v4_v4(sum, &table[(j * kernelSize + i) * 4]);
+    }
+  }
+
+  MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, rect);
+  float *buffer = result->getBuffer();
+  memset(buffer,
+         0,
+         sizeof(float) * result->getWidth() * result->getHeight() * COM_NUM_CHANNELS_COLOR);
+  for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+    FHTConvolution convolution(&kernel[ch], kernelSize, kernelSize, COM_NUM_CHANNELS_COLOR);
+    convolution.convolve(&inputBuffer->getBuffer()[ch],
+                         inputRect,
+                         COM_NUM_CHANNELS_COLOR,
+                         &buffer[ch],
+                         rect,
+                         COM_NUM_CHANNELS_COLOR);
+  }
+
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    const int j0 = max(inputRect->ymin - y, -pixelSize) + pixelSize;
+    const int j1 = min(inputRect->ymax - y, pixelSize) + pixelSize;
+    for (int x = rect->xmin; x < rect->xmax; x++) {
+      const int i0 = max(inputRect->xmin - x, -pixelSize) + pixelSize;
+      const int i1 = min(inputRect->xmax - x, pixelSize) + pixelSize;
+      float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      if (i0 < i1 && j0 < j1) {
+        add_v4_v4v4(multiplier_accum,
+                    &table[(j1 * kernelSize + i1) * 4],
+                    &table[(j0 * kernelSize + i0) * 4]);
+        sub_v4_v4(multiplier_accum, &table[(j0 * kernelSize + i1) * 4]);
+        sub_v4_v4(multiplier_accum, &table[(j1 * kernelSize + i0) * 4]);
+      }
+      for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+        *buffer = (multiplier_accum[ch] != 0.0f) ? *buffer / multiplier_accum[ch] : 0.0f;
+        buffer++;
+      }
+    }
+  }
+
+  MEM_freeN(kernel);
+  MEM_freeN(table);
+  return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
   initMutex();
@@ -77,7 +178,14 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
   float bokeh[4];
 
   this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-  if (tempBoundingBox[0] > 0.0f) {
+  if (tempBoundingBox[0] > 0.0f && useFFT()) {
+    MemoryBuffer *result = (MemoryBuffer *)data;
+    const rcti *rect = result->getRect();
+    copy_v4_v4(output,
+               &result->getBuffer()[((y - rect->ymin) * result->getWidth() + (x - rect->xmin)) *
+                                    COM_NUM_CHANNELS_COLOR]);
+  }
+  else if (tempBoundingBox[0] > 0.0f) {
     float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
     float *buffer = inputBuffer->getBuffer();
@@ -28,6 +28,9 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   SocketReader *m_inputBokehProgram;
   SocketReader *m_inputBoundingBoxReader;
   void updateSize();
+  int getPixelSize();
+  bool useFFT();
+  MemoryBuffer *convolveFFT(MemoryBuffer *inputBuffer, rcti *rect);
   float m_size;
   bool m_sizeavailable;
   float m_bokehMidX;
@@ -39,6 +42,7 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   BokehBlurOperation();
 
   void *initializeTileData(rcti *rect);
+  void deinitializeTileData(rcti *rect, void *data);
   /**
    * the inner loop of this program
    */
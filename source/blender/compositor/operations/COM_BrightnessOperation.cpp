@@ -26,6 +26,7 @@ BrightnessOperation::BrightnessOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = NULL;
   this->m_use_premultiply = false;
+  this->setPixelWise(true);
 }
 
 void BrightnessOperation::setUsePremultiply(bool use_premultiply)
@@ -40,20 +41,15 @@ void BrightnessOperation::initExecution()
   this->m_inputContrastProgram = this->getInputSocketReader(2);
 }
 
-void BrightnessOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+/* Shared by the per pixel and the buffered execution. */
+inline void brightness_pixel(float output[4],
+                             const float input[4],
+                             float brightness,
+                             const float contrast,
+                             const bool use_premultiply)
 {
   float inputValue[4];
   float a, b;
-  float inputBrightness[4];
-  float inputContrast[4];
-  this->m_inputProgram->readSampled(inputValue, x, y, sampler);
-  this->m_inputBrightnessProgram->readSampled(inputBrightness, x, y, sampler);
-  this->m_inputContrastProgram->readSampled(inputContrast, x, y, sampler);
-  float brightness = inputBrightness[0];
-  float contrast = inputContrast[0];
   brightness /= 100.0f;
   float delta = contrast / 200.0f;
   /*
@@ -71,18 +67,56 @@ void BrightnessOperation::executePixelSampled(float output[4],
     a = max_ff(1.0f - delta * 2.0f, 0.0f);
     b = a * brightness + delta;
   }
-  if (this->m_use_premultiply) {
+  copy_v4_v4(inputValue, input);
+  if (use_premultiply) {
     premul_to_straight_v4(inputValue);
   }
   output[0] = a * inputValue[0] + b;
   output[1] = a * inputValue[1] + b;
   output[2] = a * inputValue[2] + b;
   output[3] = inputValue[3];
-  if (this->m_use_premultiply) {
+  if (use_premultiply) {
     straight_to_premul_v4(output);
   }
 }
 
+void BrightnessOperation::executePixelSampled(float output[4],
+                                              float x,
+                                              float y,
+                                              PixelSampler sampler)
+{
+  float inputValue[4];
+  float inputBrightness[4];
+  float inputContrast[4];
+  this->m_inputProgram->readSampled(inputValue, x, y, sampler);
+  this->m_inputBrightnessProgram->readSampled(inputBrightness, x, y, sampler);
+  this->m_inputContrastProgram->readSampled(inputContrast, x, y, sampler);
+  brightness_pixel(
+      output, inputValue, inputBrightness[0], inputContrast[0], this->m_use_premultiply);
+}
+
+void BrightnessOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  const int color_stride = inputs[0]->get_num_channels();
+  const int brightness_stride = inputs[1]->get_num_channels();
+  const int contrast_stride = inputs[2]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *color = inputs[0]->getElem(area->xmin, y);
+    const float *brightness = inputs[1]->getElem(area->xmin, y);
+    const float *contrast = inputs[2]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      brightness_pixel(out, color, brightness[0], contrast[0], this->m_use_premultiply);
+      out += COM_NUM_CHANNELS_COLOR;
+      color += color_stride;
+      brightness += brightness_stride;
+      contrast += contrast_stride;
+    }
+  }
+}
+
 void BrightnessOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
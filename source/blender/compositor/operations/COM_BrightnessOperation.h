@@ -39,6 +39,8 @@ class BrightnessOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -26,6 +26,7 @@ ChangeHSVOperation::ChangeHSVOperation() : NodeOperation()
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputOperation = NULL;
+  this->setPixelWise(true);
 }
 
 void ChangeHSVOperation::initExecution()
@@ -44,6 +45,25 @@ void ChangeHSVOperation::deinitExecution()
   this->m_valueOperation = NULL;
 }
 
+/* Shared by the per pixel and the buffered execution. */
+inline void change_hsv_pixel(float output[4],
+                             const float input[4],
+                             const float hue,
+                             const float saturation,
+                             const float value)
+{
+  output[0] = input[0] + (hue - 0.5f);
+  if (output[0] > 1.0f) {
+    output[0] -= 1.0f;
+  }
+  else if (output[0] < 0.0f) {
+    output[0] += 1.0f;
+  }
+  output[1] = input[1] * saturation;
+  output[2] = input[2] * value;
+  output[3] = input[3];
+}
+
 void ChangeHSVOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -57,14 +77,30 @@ void ChangeHSVOperation::executePixelSampled(float output[4],
   this->m_saturationOperation->readSampled(saturation, x, y, sampler);
   this->m_valueOperation->readSampled(value, x, y, sampler);
 
-  output[0] = inputColor1[0] + (hue[0] - 0.5f);
-  if (output[0] > 1.0f) {
-    output[0] -= 1.0f;
-  }
-  else if (output[0] < 0.0f) {
-    output[0] += 1.0f;
+  change_hsv_pixel(output, inputColor1, hue[0], saturation[0], value[0]);
+}
+
+void ChangeHSVOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  const int color_stride = inputs[0]->get_num_channels();
+  const int hue_stride = inputs[1]->get_num_channels();
+  const int saturation_stride = inputs[2]->get_num_channels();
+  const int value_stride = inputs[3]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *color = inputs[0]->getElem(area->xmin, y);
+    const float *hue = inputs[1]->getElem(area->xmin, y);
+    const float *saturation = inputs[2]->getElem(area->xmin, y);
+    const float *value = inputs[3]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      change_hsv_pixel(out, color, hue[0], saturation[0], value[0]);
+      out += COM_NUM_CHANNELS_COLOR;
+      color += color_stride;
+      hue += hue_stride;
+      saturation += saturation_stride;
+      value += value_stride;
+    }
   }
-  output[1] = inputColor1[1] * saturation[0];
-  output[2] = inputColor1[2] * value[0];
-  output[3] = inputColor1[3];
 }
@@ -44,5 +44,7 @@ class ChangeHSVOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 #endif
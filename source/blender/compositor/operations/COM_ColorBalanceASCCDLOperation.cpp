@@ -39,6 +39,7 @@ ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setPixelWise(true);
 }
 
 void ColorBalanceASCCDLOperation::initExecution()
@@ -47,6 +48,26 @@ void ColorBalanceASCCDLOperation::initExecution()
   this->m_inputColorOperation = this->getInputSocketReader(1);
 }
 
+/* Shared by the per pixel and the buffered execution. */
+inline void colorbalance_cdl_pixel(float output[4],
+                                   float fac,
+                                   const float inputColor[4],
+                                   const float offset[3],
+                                   const float power[3],
+                                   const float slope[3])
+{
+  fac = min(1.0f, fac);
+  const float mfac = 1.0f - fac;
+
+  output[0] = mfac * inputColor[0] +
+              fac * colorbalance_cdl(inputColor[0], offset[0], power[0], slope[0]);
+  output[1] = mfac * inputColor[1] +
+              fac * colorbalance_cdl(inputColor[1], offset[1], power[1], slope[1]);
+  output[2] = mfac * inputColor[2] +
+              fac * colorbalance_cdl(inputColor[2], offset[2], power[2], slope[2]);
+  output[3] = inputColor[3];
+}
+
 void ColorBalanceASCCDLOperation::executePixelSampled(float output[4],
                                                       float x,
                                                       float y,
@@ -58,20 +79,27 @@ void ColorBalanceASCCDLOperation::executePixelSampled(float output[4],
   this->m_inputValueOperation->readSampled(value, x, y, sampler);
   this->m_inputColorOperation->readSampled(inputColor, x, y, sampler);
 
-  float fac = value[0];
-  fac = min(1.0f, fac);
-  const float mfac = 1.0f - fac;
+  colorbalance_cdl_pixel(
+      output, value[0], inputColor, this->m_offset, this->m_power, this->m_slope);
+}
 
-  output[0] = mfac * inputColor[0] +
-              fac * colorbalance_cdl(
-                        inputColor[0], this->m_offset[0], this->m_power[0], this->m_slope[0]);
-  output[1] = mfac * inputColor[1] +
-              fac * colorbalance_cdl(
-                        inputColor[1], this->m_offset[1], this->m_power[1], this->m_slope[1]);
-  output[2] = mfac * inputColor[2] +
-              fac * colorbalance_cdl(
-                        inputColor[2], this->m_offset[2], this->m_power[2], this->m_slope[2]);
-  output[3] = inputColor[3];
+void ColorBalanceASCCDLOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  const int value_stride = inputs[0]->get_num_channels();
+  const int color_stride = inputs[1]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *value = inputs[0]->getElem(area->xmin, y);
+    const float *color = inputs[1]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      colorbalance_cdl_pixel(out, value[0], color, this->m_offset, this->m_power, this->m_slope);
+      out += COM_NUM_CHANNELS_COLOR;
+      value += value_stride;
+      color += color_stride;
+    }
+  }
 }
 
 void ColorBalanceASCCDLOperation::deinitExecution()
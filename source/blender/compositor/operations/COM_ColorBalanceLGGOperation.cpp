@@ -44,6 +44,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setPixelWise(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -52,6 +53,26 @@ void ColorBalanceLGGOperation::initExecution()
   this->m_inputColorOperation = this->getInputSocketReader(1);
 }
 
+/* Shared by the per pixel and the buffered execution. */
+inline void colorbalance_lgg_pixel(float output[4],
+                                   float fac,
+                                   const float inputColor[4],
+                                   const float lift[3],
+                                   const float gamma_inv[3],
+                                   const float gain[3])
+{
+  fac = min(1.0f, fac);
+  const float mfac = 1.0f - fac;
+
+  output[0] = mfac * inputColor[0] +
+              fac * colorbalance_lgg(inputColor[0], lift[0], gamma_inv[0], gain[0]);
+  output[1] = mfac * inputColor[1] +
+              fac * colorbalance_lgg(inputColor[1], lift[1], gamma_inv[1], gain[1]);
+  output[2] = mfac * inputColor[2] +
+              fac * colorbalance_lgg(inputColor[2], lift[2], gamma_inv[2], gain[2]);
+  output[3] = inputColor[3];
+}
+
 void ColorBalanceLGGOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -63,20 +84,27 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   this->m_inputValueOperation->readSampled(value, x, y, sampler);
   this->m_inputColorOperation->readSampled(inputColor, x, y, sampler);
 
-  float fac = value[0];
-  fac = min(1.0f, fac);
-  const float mfac = 1.0f - fac;
+  colorbalance_lgg_pixel(
+      output, value[0], inputColor, this->m_lift, this->m_gamma_inv, this->m_gain);
+}
 
-  output[0] = mfac * inputColor[0] +
-              fac * colorbalance_lgg(
-                        inputColor[0], this->m_lift[0], this->m_gamma_inv[0], this->m_gain[0]);
-  output[1] = mfac * inputColor[1] +
-              fac * colorbalance_lgg(
-                        inputColor[1], this->m_lift[1], this->m_gamma_inv[1], this->m_gain[1]);
-  output[2] = mfac * inputColor[2] +
-              fac * colorbalance_lgg(
-                        inputColor[2], this->m_lift[2], this->m_gamma_inv[2], this->m_gain[2]);
-  output[3] = inputColor[3];
+void ColorBalanceLGGOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                      const rcti *area,
+                                                      MemoryBuffer **inputs)
+{
+  const int value_stride = inputs[0]->get_num_channels();
+  const int color_stride = inputs[1]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *value = inputs[0]->getElem(area->xmin, y);
+    const float *color = inputs[1]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      colorbalance_lgg_pixel(out, value[0], color, this->m_lift, this->m_gamma_inv, this->m_gain);
+      out += COM_NUM_CHANNELS_COLOR;
+      value += value_stride;
+      color += color_stride;
+    }
+  }
 }
 
 void ColorBalanceLGGOperation::deinitExecution()
@@ -47,6 +47,8 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -36,6 +36,7 @@ ColorCurveOperation::ColorCurveOperation() : CurveBaseOperation()
   this->m_inputWhiteProgram = NULL;
 
   this->setResolutionInputSocketIndex(1);
+  this->setPixelWise(true);
 }
 void ColorCurveOperation::initExecution()
 {
@@ -48,6 +49,39 @@ void ColorCurveOperation::initExecution()
   BKE_curvemapping_premultiply(this->m_curveMapping, 0);
 }
 
+/* Shared by the per pixel and the buffered execution, black and bwmul are the levels of the
+ * pixel when not NULL. */
+static inline void curve_pixel(CurveMapping *cumap,
+                               float output[4],
+                               const float image[4],
+                               const float fac,
+                               const float black[3],
+                               const float bwmul[3])
+{
+  if (fac >= 1.0f) {
+    if (black) {
+      BKE_curvemapping_evaluate_premulRGBF_ex(cumap, output, image, black, bwmul);
+    }
+    else {
+      BKE_curvemapping_evaluate_premulRGBF(cumap, output, image);
+    }
+  }
+  else if (fac <= 0.0f) {
+    copy_v3_v3(output, image);
+  }
+  else {
+    float col[4];
+    if (black) {
+      BKE_curvemapping_evaluate_premulRGBF_ex(cumap, col, image, black, bwmul);
+    }
+    else {
+      BKE_curvemapping_evaluate_premulRGBF(cumap, col, image);
+    }
+    interp_v3_v3v3(output, image, col, fac);
+  }
+  output[3] = image[3];
+}
+
 void ColorCurveOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -73,18 +107,35 @@ void ColorCurveOperation::executePixelSampled(float output[4],
   this->m_inputFacProgram->readSampled(fac, x, y, sampler);
   this->m_inputImageProgram->readSampled(image, x, y, sampler);
 
-  if (*fac >= 1.0f) {
-    BKE_curvemapping_evaluate_premulRGBF_ex(cumap, output, image, black, bwmul);
-  }
-  else if (*fac <= 0.0f) {
-    copy_v3_v3(output, image);
-  }
-  else {
-    float col[4];
-    BKE_curvemapping_evaluate_premulRGBF_ex(cumap, col, image, black, bwmul);
-    interp_v3_v3v3(output, image, col, *fac);
+  curve_pixel(cumap, output, image, fac[0], black, bwmul);
+}
+
+void ColorCurveOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  CurveMapping *cumap = this->m_curveMapping;
+  const int fac_stride = inputs[0]->get_num_channels();
+  const int image_stride = inputs[1]->get_num_channels();
+  const int black_stride = inputs[2]->get_num_channels();
+  const int white_stride = inputs[3]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *fac = inputs[0]->getElem(area->xmin, y);
+    const float *image = inputs[1]->getElem(area->xmin, y);
+    const float *black = inputs[2]->getElem(area->xmin, y);
+    const float *white = inputs[3]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      float bwmul[3];
+      BKE_curvemapping_set_black_white_ex(black, white, bwmul);
+      curve_pixel(cumap, out, image, fac[0], black, bwmul);
+      out += COM_NUM_CHANNELS_COLOR;
+      fac += fac_stride;
+      image += image_stride;
+      black += black_stride;
+      white += white_stride;
+    }
   }
-  output[3] = image[3];
 }
 
 void ColorCurveOperation::deinitExecution()
@@ -108,6 +159,7 @@ ConstantLevelColorCurveOperation::ConstantLevelColorCurveOperation() : CurveBase
   this->m_inputImageProgram = NULL;
 
   this->setResolutionInputSocketIndex(1);
+  this->setPixelWise(true);
 }
 void ConstantLevelColorCurveOperation::initExecution()
 {
@@ -131,18 +183,27 @@ void ConstantLevelColorCurveOperation::executePixelSampled(float output[4],
   this->m_inputFacProgram->readSampled(fac, x, y, sampler);
   this->m_inputImageProgram->readSampled(image, x, y, sampler);
 
-  if (*fac >= 1.0f) {
-    BKE_curvemapping_evaluate_premulRGBF(this->m_curveMapping, output, image);
-  }
-  else if (*fac <= 0.0f) {
-    copy_v3_v3(output, image);
-  }
-  else {
-    float col[4];
-    BKE_curvemapping_evaluate_premulRGBF(this->m_curveMapping, col, image);
-    interp_v3_v3v3(output, image, col, *fac);
+  curve_pixel(this->m_curveMapping, output, image, fac[0], NULL, NULL);
+}
+
+void ConstantLevelColorCurveOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                              const rcti *area,
+                                                              MemoryBuffer **inputs)
+{
+  CurveMapping *cumap = this->m_curveMapping;
+  const int fac_stride = inputs[0]->get_num_channels();
+  const int image_stride = inputs[1]->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *fac = inputs[0]->getElem(area->xmin, y);
+    const float *image = inputs[1]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      curve_pixel(cumap, out, image, fac[0], NULL, NULL);
+      out += COM_NUM_CHANNELS_COLOR;
+      fac += fac_stride;
+      image += image_stride;
+    }
   }
-  output[3] = image[3];
 }
 
 void ConstantLevelColorCurveOperation::deinitExecution()
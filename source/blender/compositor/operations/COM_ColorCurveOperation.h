@@ -40,6 +40,8 @@ class ColorCurveOperation : public CurveBaseOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -69,6 +71,8 @@ class ConstantLevelColorCurveOperation : public CurveBaseOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
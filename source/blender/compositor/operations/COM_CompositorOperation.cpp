@@ -47,6 +47,7 @@ CompositorOperation::CompositorOperation() : NodeOperation()
 
   this->m_useAlphaInput = false;
   this->m_active = false;
+  this->m_bufferedExecution = false;
 
   this->m_scene = NULL;
   this->m_sceneName[0] = '\0';
@@ -193,11 +194,23 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   }
 #endif
 
+  /* Pixel-wise image inputs are evaluated for the whole area first. */
+  MemoryBuffer *image = NULL;
+  if (this->isAreaEvaluated()) {
+    image = MemoryBuffer::createScratch(COM_DT_COLOR, rect);
+    this->getInputOperation(0)->renderArea(image, rect);
+  }
+
   for (y = y1; y < y2 && (!breaked); y++) {
     for (x = x1; x < x2 && (!breaked); x++) {
       int input_x = x + dx, input_y = y + dy;
 
-      this->m_imageInput->readSampled(color, input_x, input_y, COM_PS_NEAREST);
+      if (image) {
+        copy_v4_v4(color, image->getElem(x, y));
+      }
+      else {
+        this->m_imageInput->readSampled(color, input_x, input_y, COM_PS_NEAREST);
+      }
       if (this->m_useAlphaInput) {
         this->m_alphaInput->readSampled(&(color[3]), input_x, input_y, COM_PS_NEAREST);
       }
@@ -215,6 +228,10 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
     offset += add;
     offset4 += add * COM_NUM_CHANNELS_COLOR;
   }
+
+  if (image) {
+    MemoryBuffer::freeScratch(image);
+  }
 }
 
 void CompositorOperation::determineResolution(unsigned int resolution[2],
@@ -75,6 +75,11 @@ class CompositorOperation : public NodeOperation {
    */
   bool m_active;
 
+  /**
+   * \brief evaluate a pixel-wise image input per area
+   */
+  bool m_bufferedExecution;
+
   /**
    * \brief View name, used for multiview
    */
@@ -122,5 +127,13 @@ class CompositorOperation : public NodeOperation {
   {
     this->m_active = active;
   }
+  void setBufferedExecution(bool bufferedExecution)
+  {
+    this->m_bufferedExecution = bufferedExecution;
+  }
+  bool isAreaEvaluated()
+  {
+    return this->m_bufferedExecution && this->getInputOperation(0)->isPixelWise();
+  }
 };
 #endif
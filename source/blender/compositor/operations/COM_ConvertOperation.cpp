@@ -35,12 +35,30 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = NULL;
 }
 
+/* Apply func to every pixel of area, the datatype conversions are inlined into the loop. */
+template<typename Func>
+static void convert_area(MemoryBuffer *output, const rcti *area, MemoryBuffer *input, Func func)
+{
+  const int out_stride = output->get_num_channels();
+  const int in_stride = input->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *in = input->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      func(out, in);
+      out += out_stride;
+      in += in_stride;
+    }
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setPixelWise(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -54,12 +72,23 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                          const rcti *area,
+                                                          MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = out[1] = out[2] = in[0];
+    out[3] = 1.0f;
+  });
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setPixelWise(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -72,12 +101,22 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                          const rcti *area,
+                                                          MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  });
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setPixelWise(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -90,12 +129,22 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                       const rcti *area,
+                                                       MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = IMB_colormanagement_get_luminance(in);
+  });
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setPixelWise(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -108,12 +157,22 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    copy_v3_v3(out, in);
+  });
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setPixelWise(true);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -126,12 +185,22 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = out[1] = out[2] = in[0];
+  });
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setPixelWise(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -143,12 +212,23 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    copy_v3_v3(out, in);
+    out[3] = 1.0f;
+  });
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setPixelWise(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
@@ -161,6 +241,15 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  });
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -305,6 +394,7 @@ ConvertRGBToHSVOperation::ConvertRGBToHSVOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setPixelWise(true);
 }
 
 void ConvertRGBToHSVOperation::executePixelSampled(float output[4],
@@ -318,12 +408,23 @@ void ConvertRGBToHSVOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertRGBToHSVOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                      const rcti *area,
+                                                      MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    rgb_to_hsv_v(in, out);
+    out[3] = in[3];
+  });
+}
+
 /* ******** HSV to RGB ******** */
 
 ConvertHSVToRGBOperation::ConvertHSVToRGBOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setPixelWise(true);
 }
 
 void ConvertHSVToRGBOperation::executePixelSampled(float output[4],
@@ -340,6 +441,19 @@ void ConvertHSVToRGBOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertHSVToRGBOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                                      const rcti *area,
+                                                      MemoryBuffer **inputs)
+{
+  convert_area(output, area, inputs[0], [](float *out, const float *in) {
+    hsv_to_rgb_v(in, out);
+    out[0] = max_ff(out[0], 0.0f);
+    out[1] = max_ff(out[1], 0.0f);
+    out[2] = max_ff(out[2], 0.0f);
+    out[3] = in[3];
+  });
+}
+
 /* ******** Premul to Straight ******** */
 
 ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBaseOperation()
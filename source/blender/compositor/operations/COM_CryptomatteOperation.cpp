@@ -21,7 +21,9 @@
 CryptomatteOperation::CryptomatteOperation(size_t num_inputs) : NodeOperation()
 {
   for (size_t i = 0; i < num_inputs; i++) {
+    /* Object IDs are stored as float bits. */
     this->addInputSocket(COM_DT_COLOR);
+    this->getInputSocket(i)->setFullPrecision(true);
   }
   inputs.resize(num_inputs);
   this->addOutputSocket(COM_DT_COLOR);
@@ -0,0 +1,83 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FHTCONVOLUTION_H__
+#define __COM_FHTCONVOLUTION_H__
+
+#include "DNA_vec_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+/**
+ * \brief convolution of a single channel with a kernel using the 2D Fast Hartley Transform
+ *
+ * The kernel is transformed once on construction, the input is convolved block by block and the
+ * results are overlap-added into the output. Blocks of the input that are zero are skipped.
+ * The work buffer is owned by the instance, use one instance per thread.
+ */
+class FHTConvolution {
+ private:
+  unsigned int m_kernelWidth;
+  unsigned int m_kernelHeight;
+  unsigned int m_log2Width;
+  unsigned int m_log2Height;
+  unsigned int m_blockWidth;
+  unsigned int m_blockHeight;
+
+  /**
+   * \brief transformed kernel
+   */
+  float *m_kernel;
+
+  /**
+   * \brief transform of a single block
+   */
+  float *m_data;
+
+ public:
+  /**
+   * \param kernel: kernelWidth * kernelHeight values of the kernel channel
+   * \param stride: distance between two values of the kernel channel
+   */
+  FHTConvolution(const float *kernel,
+                 unsigned int kernelWidth,
+                 unsigned int kernelHeight,
+                 unsigned int stride);
+  ~FHTConvolution();
+
+  /**
+   * \brief add the convolution of an input channel to an output channel
+   *
+   * output(x, y) += sum(kernel(i, j) * input(x + kernelWidth / 2 - i, y + kernelHeight / 2 - j))
+   * for all output pixels, input outside of inputRect is zero.
+   */
+  void convolve(const float *input,
+                const rcti *inputRect,
+                unsigned int inputStride,
+                float *output,
+                const rcti *outputRect,
+                unsigned int outputStride);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FHTConvolution")
+#endif
+};
+
+#endif
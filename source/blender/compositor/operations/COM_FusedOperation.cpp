@@ -0,0 +1,166 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <string.h>
+#include <typeinfo>
+
+#include "BLI_rect.h"
+
+#include "COM_ResultCache.h"
+
+#include "COM_FusedOperation.h" /* own include */
+
+/* Number of pixels evaluated by every fused operation before the next one continues. */
+#define COM_FUSED_STRIP_PIXELS 4096
+
+FusedOperation::FusedOperation(const std::vector<NodeOperation *> &operations) : NodeOperation()
+{
+  this->m_operations = operations;
+
+  NodeOperation *last = operations.back();
+  this->addOutputSocket(last->getOutputSocket()->getDataType());
+  this->setWidth(last->getWidth());
+  this->setHeight(last->getHeight());
+  this->setPixelWise(true);
+}
+
+void FusedOperation::determineInputs()
+{
+  const std::vector<NodeOperation *> &operations = this->m_operations;
+  std::vector<uint64_t> hashes;
+  bool cacheable = true;
+
+  this->m_sources.resize(operations.size());
+  for (unsigned int index = 0; index < operations.size(); index++) {
+    NodeOperation *operation = operations[index];
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      NodeOperationInput *input = operation->getInputSocket(i);
+      NodeOperationOutput *link = input->getLink();
+      BLI_assert(link);
+      int source = -1;
+
+      for (unsigned int j = 0; j < index; j++) {
+        if (&link->getOperation() == operations[j]) {
+          source = j;
+          break;
+        }
+      }
+      if (source == -1) {
+        for (unsigned int j = 0; j < this->m_inputLinks.size(); j++) {
+          if (this->m_inputLinks[j] == link) {
+            source = -1 - (int)j;
+            break;
+          }
+        }
+      }
+      if (source == -1) {
+        this->addInputSocket(input->getDataType());
+        this->m_inputLinks.push_back(link);
+        source = -(int)this->m_inputLinks.size();
+      }
+      this->m_sources[index].push_back(source);
+      hashes.push_back((uint64_t)source);
+    }
+
+    const char *name = typeid(*operation).name();
+    hashes.push_back(ResultCache::hashData(name, strlen(name)));
+    hashes.push_back(operation->getParameterHash());
+    cacheable &= operation->getParameterHash() != COM_HASH_NONE;
+  }
+
+  this->setParameterHash(
+      cacheable ? ResultCache::hashData(hashes.data(), sizeof(uint64_t) * hashes.size()) :
+                  COM_HASH_NONE);
+}
+
+FusedOperation::~FusedOperation()
+{
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    delete this->m_operations[index];
+  }
+}
+
+void FusedOperation::setbNodeTree(const bNodeTree *tree)
+{
+  NodeOperation::setbNodeTree(tree);
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    this->m_operations[index]->setbNodeTree(tree);
+  }
+}
+
+void FusedOperation::initExecution()
+{
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    this->m_operations[index]->initExecution();
+  }
+}
+
+void FusedOperation::deinitExecution()
+{
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    this->m_operations[index]->deinitExecution();
+  }
+}
+
+void FusedOperation::executePixelSampled(float output[4],
+                                         float x,
+                                         float y,
+                                         PixelSampler sampler)
+{
+  this->m_operations.back()->readSampled(output, x, y, sampler);
+}
+
+void FusedOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  const unsigned int num_operations = this->m_operations.size();
+  const int strip_height = max_ii(1, COM_FUSED_STRIP_PIXELS / max_ii(1, BLI_rcti_size_x(area)));
+  std::vector<MemoryBuffer *> results(num_operations, NULL);
+  std::vector<MemoryBuffer *> operation_inputs;
+
+  for (int ymin = area->ymin; ymin < area->ymax; ymin += strip_height) {
+    rcti strip;
+    BLI_rcti_init(&strip, area->xmin, area->xmax, ymin, min_ii(ymin + strip_height, area->ymax));
+
+    for (unsigned int index = 0; index < num_operations; index++) {
+      NodeOperation *operation = this->m_operations[index];
+      const std::vector<int> &sources = this->m_sources[index];
+
+      operation_inputs.resize(sources.size());
+      for (unsigned int i = 0; i < sources.size(); i++) {
+        operation_inputs[i] = (sources[i] >= 0) ? results[sources[i]] : inputs[-1 - sources[i]];
+      }
+
+      if (index == num_operations - 1) {
+        operation->updateMemoryBufferArea(output, &strip, operation_inputs.data());
+      }
+      else {
+        results[index] = MemoryBuffer::createScratch(operation->getOutputSocket()->getDataType(),
+                                                      &strip);
+        operation->updateMemoryBufferArea(results[index], &strip, operation_inputs.data());
+      }
+    }
+
+    /* Scratch buffers are freed in reverse order, the last operation has none. */
+    for (unsigned int index = num_operations - 1; index > 0; index--) {
+      MemoryBuffer::freeScratch(results[index - 1]);
+      results[index - 1] = NULL;
+    }
+  }
+}
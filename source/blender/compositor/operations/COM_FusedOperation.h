@@ -0,0 +1,94 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FUSEDOPERATION_H__
+#define __COM_FUSEDOPERATION_H__
+
+#include <vector>
+
+#include "COM_NodeOperation.h"
+
+/**
+ * \brief a chain of pixel-wise operations evaluated as a single operation
+ *
+ * Created by NodeOperationBuilder in buffered execution. The inputs of the fused operation are the
+ * inputs of the chain, its output is the output of the last operation. Areas are evaluated in
+ * strips of a few thousand pixels, every operation of the chain updates the strip before the next
+ * one reads it, so intermediate results stay in cache instead of being written to a buffer of the
+ * whole area per operation.
+ *
+ * The fused operations keep their own links, sampling a single pixel pulls through the chain
+ * like it does without fusion.
+ */
+class FusedOperation : public NodeOperation {
+ private:
+  /**
+   * \brief the fused operations in evaluation order, owned by this operation.
+   * The last operation writes the output.
+   */
+  std::vector<NodeOperation *> m_operations;
+
+  /**
+   * \brief per operation and input socket, the index of the operation writing it.
+   * Inputs of the fused operation are stored as -1 - input index.
+   */
+  std::vector<std::vector<int>> m_sources;
+
+  /**
+   * \brief the outputs linked to the inputs of the fused operation
+   */
+  std::vector<NodeOperationOutput *> m_inputLinks;
+
+ public:
+  /**
+   * \param operations: pixel-wise operations, inputs come before the operations reading them
+   */
+  FusedOperation(const std::vector<NodeOperation *> &operations);
+  ~FusedOperation();
+
+  /**
+   * \brief add an input socket for every distinct output linked to the fused operations from
+   * outside the chain, must be called once the links of the fused operations are final
+   */
+  void determineInputs();
+
+  /**
+   * \brief the output to link to the input socket at index
+   */
+  NodeOperationOutput *getInputLink(unsigned int index) const
+  {
+    return this->m_inputLinks[index];
+  }
+
+  /**
+   * \brief the output of the last fused operation, readers of it read this operation instead
+   */
+  NodeOperationOutput *getFusedOutputSocket() const
+  {
+    return this->m_operations.back()->getOutputSocket();
+  }
+
+  void setbNodeTree(const bNodeTree *tree);
+  void initExecution();
+  void deinitExecution();
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+};
+
+#endif
@@ -30,6 +30,7 @@ MathBaseOperation::MathBaseOperation() : NodeOperation()
   this->m_inputValue2Operation = NULL;
   this->m_inputValue3Operation = NULL;
   this->m_useClamp = false;
+  this->setPixelWise(true);
 }
 
 void MathBaseOperation::initExecution()
@@ -64,689 +65,387 @@ void MathBaseOperation::determineResolution(unsigned int resolution[2],
   NodeOperation::determineResolution(resolution, preferredResolution);
 }
 
-void MathBaseOperation::clampIfNeeded(float *color)
-{
-  if (this->m_useClamp) {
-    CLAMP(color[0], 0.0f, 1.0f);
-  }
-}
-
-void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathBaseOperation::executePixelSampled(float output[4],
+                                            float x,
+                                            float y,
+                                            PixelSampler sampler)
 {
   float inputValue1[4];
   float inputValue2[4];
+  float inputValue3[4];
 
   this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
   this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
 
-  output[0] = inputValue1[0] + inputValue2[0];
-
-  clampIfNeeded(output);
+  PixelCursor p;
+  p.out = output;
+  p.row_end = output + COM_NUM_CHANNELS_VALUE;
+  p.value1 = inputValue1;
+  p.value2 = inputValue2;
+  p.value3 = inputValue3;
+  p.value1_stride = p.value2_stride = p.value3_stride = 0;
+  updateMemoryBufferRow(p);
+}
+
+void MathBaseOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  int width = BLI_rcti_size_x(area);
+  int height = BLI_rcti_size_y(area);
+  /* Whole frame areas are contiguous in all buffers, walk them as a single row. */
+  if (output->isContiguous(area) && inputs[0]->isContiguous(area) &&
+      inputs[1]->isContiguous(area) && inputs[2]->isContiguous(area)) {
+    width *= height;
+    height = 1;
+  }
+  PixelCursor p;
+  p.value1_stride = inputs[0]->get_num_channels();
+  p.value2_stride = inputs[1]->get_num_channels();
+  p.value3_stride = inputs[2]->get_num_channels();
+  for (int y = area->ymin; y < area->ymin + height; y++) {
+    p.out = output->getElem(area->xmin, y);
+    p.row_end = p.out + width * COM_NUM_CHANNELS_VALUE;
+    p.value1 = inputs[0]->getElem(area->xmin, y);
+    p.value2 = inputs[1]->getElem(area->xmin, y);
+    p.value3 = inputs[2]->getElem(area->xmin, y);
+    updateMemoryBufferRow(p);
+  }
 }
 
-void MathSubtractOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathAddOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = inputValue1[0] - inputValue2[0];
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] + p.value2[0];
+  });
 }
 
-void MathMultiplyOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathSubtractOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = inputValue1[0] * inputValue2[0];
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] - p.value2[0];
+  });
 }
 
-void MathDivideOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MathMultiplyOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue2[0] == 0) { /* We don't want to divide by zero. */
-    output[0] = 0.0;
-  }
-  else {
-    output[0] = inputValue1[0] / inputValue2[0];
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] * p.value2[0];
+  });
 }
 
-void MathSineOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathDivideOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = sin(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value2[0] == 0) { /* We don't want to divide by zero. */
+      p.out[0] = 0.0;
+    }
+    else {
+      p.out[0] = p.value1[0] / p.value2[0];
+    }
+  });
 }
 
-void MathCosineOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MathSineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = cos(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = sin(p.value1[0]);
+  });
 }
 
-void MathTangentOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathCosineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = tan(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = cos(p.value1[0]);
+  });
 }
 
-void MathHyperbolicSineOperation::executePixelSampled(float output[4],
-                                                      float x,
-                                                      float y,
-                                                      PixelSampler sampler)
+void MathTangentOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = sinh(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = tan(p.value1[0]);
+  });
 }
 
-void MathHyperbolicCosineOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void MathHyperbolicSineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = cosh(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = sinh(p.value1[0]);
+  });
 }
 
-void MathHyperbolicTangentOperation::executePixelSampled(float output[4],
-                                                         float x,
-                                                         float y,
-                                                         PixelSampler sampler)
+void MathHyperbolicCosineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = tanh(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = cosh(p.value1[0]);
+  });
 }
 
-void MathArcSineOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathHyperbolicTangentOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue1[0] <= 1 && inputValue1[0] >= -1) {
-    output[0] = asin(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0;
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = tanh(p.value1[0]);
+  });
 }
 
-void MathArcCosineOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MathArcSineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue1[0] <= 1 && inputValue1[0] >= -1) {
-    output[0] = acos(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0;
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] <= 1 && p.value1[0] >= -1) {
+      p.out[0] = asin(p.value1[0]);
+    }
+    else {
+      p.out[0] = 0.0;
+    }
+  });
 }
 
-void MathArcTangentOperation::executePixelSampled(float output[4],
-                                                  float x,
-                                                  float y,
-                                                  PixelSampler sampler)
+void MathArcCosineOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = atan(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] <= 1 && p.value1[0] >= -1) {
+      p.out[0] = acos(p.value1[0]);
+    }
+    else {
+      p.out[0] = 0.0;
+    }
+  });
 }
 
-void MathPowerOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MathArcTangentOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = atan(p.value1[0]);
+  });
+}
 
-  if (inputValue1[0] >= 0) {
-    output[0] = pow(inputValue1[0], inputValue2[0]);
-  }
-  else {
-    float y_mod_1 = fmod(inputValue2[0], 1);
-    /* if input value is not nearly an integer, fall back to zero, nicer than straight rounding */
-    if (y_mod_1 > 0.999f || y_mod_1 < 0.001f) {
-      output[0] = pow(inputValue1[0], floorf(inputValue2[0] + 0.5f));
+void MathPowerOperation::updateMemoryBufferRow(PixelCursor &row)
+{
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] >= 0) {
+      p.out[0] = pow(p.value1[0], p.value2[0]);
     }
     else {
-      output[0] = 0.0;
+      float y_mod_1 = fmod(p.value2[0], 1);
+      /* if input value is not nearly an integer, fall back to zero,
+       * nicer than straight rounding */
+      if (y_mod_1 > 0.999f || y_mod_1 < 0.001f) {
+        p.out[0] = pow(p.value1[0], floorf(p.value2[0] + 0.5f));
+      }
+      else {
+        p.out[0] = 0.0;
+      }
     }
-  }
-
-  clampIfNeeded(output);
+  });
 }
 
-void MathLogarithmOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MathLogarithmOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue1[0] > 0 && inputValue2[0] > 0) {
-    output[0] = log(inputValue1[0]) / log(inputValue2[0]);
-  }
-  else {
-    output[0] = 0.0;
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] > 0 && p.value2[0] > 0) {
+      p.out[0] = log(p.value1[0]) / log(p.value2[0]);
+    }
+    else {
+      p.out[0] = 0.0;
+    }
+  });
 }
 
-void MathMinimumOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathMinimumOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = min(inputValue1[0], inputValue2[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = min(p.value1[0], p.value2[0]);
+  });
 }
 
-void MathMaximumOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathMaximumOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = max(inputValue1[0], inputValue2[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = max(p.value1[0], p.value2[0]);
+  });
 }
 
-void MathRoundOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MathRoundOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = round(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = round(p.value1[0]);
+  });
 }
 
-void MathLessThanOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathLessThanOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = inputValue1[0] < inputValue2[0] ? 1.0f : 0.0f;
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] < p.value2[0] ? 1.0f : 0.0f;
+  });
 }
 
-void MathGreaterThanOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void MathGreaterThanOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = inputValue1[0] > inputValue2[0] ? 1.0f : 0.0f;
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] > p.value2[0] ? 1.0f : 0.0f;
+  });
 }
 
-void MathModuloOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MathModuloOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue2[0] == 0) {
-    output[0] = 0.0;
-  }
-  else {
-    output[0] = fmod(inputValue1[0], inputValue2[0]);
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value2[0] == 0) {
+      p.out[0] = 0.0;
+    }
+    else {
+      p.out[0] = fmod(p.value1[0], p.value2[0]);
+    }
+  });
 }
 
-void MathAbsoluteOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathAbsoluteOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = fabs(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = fabs(p.value1[0]);
+  });
 }
 
-void MathRadiansOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathRadiansOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = DEG2RADF(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = DEG2RADF(p.value1[0]);
+  });
 }
 
-void MathDegreesOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathDegreesOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = RAD2DEGF(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = RAD2DEGF(p.value1[0]);
+  });
 }
 
-void MathArcTan2Operation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathArcTan2Operation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = atan2(inputValue1[0], inputValue2[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = atan2(p.value1[0], p.value2[0]);
+  });
 }
 
-void MathFloorOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MathFloorOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = floor(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = floor(p.value1[0]);
+  });
 }
 
-void MathCeilOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathCeilOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = ceil(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = ceil(p.value1[0]);
+  });
 }
 
-void MathFractOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MathFractOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = inputValue1[0] - floor(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] - floor(p.value1[0]);
+  });
 }
 
-void MathSqrtOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathSqrtOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  if (inputValue1[0] > 0) {
-    output[0] = sqrt(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0f;
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] > 0) {
+      p.out[0] = sqrt(p.value1[0]);
+    }
+    else {
+      p.out[0] = 0.0f;
+    }
+  });
 }
 
-void MathInverseSqrtOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void MathInverseSqrtOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  if (inputValue1[0] > 0) {
-    output[0] = 1.0f / sqrt(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0f;
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] > 0) {
+      p.out[0] = 1.0f / sqrt(p.value1[0]);
+    }
+    else {
+      p.out[0] = 0.0f;
+    }
+  });
 }
 
-void MathSignOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathSignOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = compatible_signf(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = compatible_signf(p.value1[0]);
+  });
 }
 
-void MathExponentOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathExponentOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = expf(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = expf(p.value1[0]);
+  });
 }
 
-void MathTruncOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MathTruncOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
-  output[0] = (inputValue1[0] >= 0.0f) ? floor(inputValue1[0]) : ceil(inputValue1[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = (p.value1[0] >= 0.0f) ? floor(p.value1[0]) : ceil(p.value1[0]);
+  });
 }
 
-void MathSnapOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathSnapOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  if (inputValue1[0] == 0 || inputValue2[0] == 0) { /* We don't want to divide by zero. */
-    output[0] = 0.0f;
-  }
-  else {
-    output[0] = floorf(inputValue1[0] / inputValue2[0]) * inputValue2[0];
-  }
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    if (p.value1[0] == 0 || p.value2[0] == 0) { /* We don't want to divide by zero. */
+      p.out[0] = 0.0f;
+    }
+    else {
+      p.out[0] = floorf(p.value1[0] / p.value2[0]) * p.value2[0];
+    }
+  });
 }
 
-void MathWrapOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MathWrapOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = wrapf(inputValue1[0], inputValue2[0], inputValue3[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = wrapf(p.value1[0], p.value2[0], p.value3[0]);
+  });
 }
 
-void MathPingpongOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MathPingpongOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-
-  output[0] = fabsf(fractf((inputValue1[0] - inputValue2[0]) / (inputValue2[0] * 2.0f)) *
-                        inputValue2[0] * 2.0f -
-                    inputValue2[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = fabsf(fractf((p.value1[0] - p.value2[0]) / (p.value2[0] * 2.0f)) *
+                          p.value2[0] * 2.0f -
+                      p.value2[0]);
+  });
 }
 
-void MathCompareOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MathCompareOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = (fabsf(inputValue1[0] - inputValue2[0]) <= MAX2(inputValue3[0], 1e-5f)) ? 1.0f :
-                                                                                        0.0f;
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = (fabsf(p.value1[0] - p.value2[0]) <= MAX2(p.value3[0], 1e-5f)) ? 1.0f :
+                                                                                          0.0f;
+  });
 }
 
-void MathMultiplyAddOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void MathMultiplyAddOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = inputValue1[0] * inputValue2[0] + inputValue3[0];
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = p.value1[0] * p.value2[0] + p.value3[0];
+  });
 }
 
-void MathSmoothMinOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MathSmoothMinOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = smoothminf(inputValue1[0], inputValue2[0], inputValue3[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = smoothminf(p.value1[0], p.value2[0], p.value3[0]);
+  });
 }
 
-void MathSmoothMaxOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MathSmoothMaxOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = -smoothminf(-inputValue1[0], -inputValue2[0], inputValue3[0]);
-
-  clampIfNeeded(output);
+  mathRow(row, [](const PixelCursor &p) {
+    p.out[0] = -smoothminf(-p.value1[0], -p.value2[0], p.value3[0]);
+  });
 }
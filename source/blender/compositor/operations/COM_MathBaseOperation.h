@@ -26,6 +26,20 @@
  */
 class MathBaseOperation : public NodeOperation {
  protected:
+  /**
+   * Walks one row of the output and input buffers, see #MixBaseOperation::PixelCursor.
+   */
+  struct PixelCursor {
+    float *out;
+    const float *row_end;
+    const float *value1;
+    const float *value2;
+    const float *value3;
+    int value1_stride;
+    int value2_stride;
+    int value3_stride;
+  };
+
   /**
    * Prefetched reference to the inputProgram
    */
@@ -41,13 +55,63 @@ class MathBaseOperation : public NodeOperation {
    */
   MathBaseOperation();
 
-  void clampIfNeeded(float color[4]);
+  /**
+   * Call `math(p)` for every pixel of the row, with the cursor at the pixel. The clamp option is
+   * decided once per row, see #MixBaseOperation::mixRow.
+   */
+  template<typename MathFunc> void mathRow(const PixelCursor &p, MathFunc math)
+  {
+    if (this->m_useClamp) {
+      mathRowStrides<true>(p, math);
+    }
+    else {
+      mathRowStrides<false>(p, math);
+    }
+  }
+
+  template<bool Clamp, typename MathFunc>
+  static void mathRowStrides(const PixelCursor &p, MathFunc math)
+  {
+    if (p.value1_stride == COM_NUM_CHANNELS_VALUE && p.value2_stride == COM_NUM_CHANNELS_VALUE &&
+        p.value3_stride == COM_NUM_CHANNELS_VALUE) {
+      mathRowLoop<Clamp, true>(p, math);
+    }
+    else {
+      mathRowLoop<Clamp, false>(p, math);
+    }
+  }
+
+  template<bool Clamp, bool Contiguous, typename MathFunc>
+  static void mathRowLoop(const PixelCursor &p, MathFunc math)
+  {
+    const int value1_stride = Contiguous ? COM_NUM_CHANNELS_VALUE : p.value1_stride;
+    const int value2_stride = Contiguous ? COM_NUM_CHANNELS_VALUE : p.value2_stride;
+    const int value3_stride = Contiguous ? COM_NUM_CHANNELS_VALUE : p.value3_stride;
+    PixelCursor c = p;
+    while (c.out < c.row_end) {
+      math(c);
+      if (Clamp) {
+        CLAMP(c.out[0], 0.0f, 1.0f);
+      }
+      c.out += COM_NUM_CHANNELS_VALUE;
+      c.value1 += value1_stride;
+      c.value2 += value2_stride;
+      c.value3 += value3_stride;
+    }
+  }
+
+  /**
+   * Evaluate a row of pixels, used by both the per pixel and the buffered execution.
+   */
+  virtual void updateMemoryBufferRow(PixelCursor &p) = 0;
 
  public:
   /**
    * the inner loop of this program
    */
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) = 0;
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   /**
    * Initialize the execution
@@ -75,49 +139,49 @@ class MathAddOperation : public MathBaseOperation {
   MathAddOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
   MathSubtractOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
   MathMultiplyOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
   MathDivideOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
   MathSineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathCosineOperation : public MathBaseOperation {
  public:
   MathCosineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathTangentOperation : public MathBaseOperation {
  public:
   MathTangentOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathHyperbolicSineOperation : public MathBaseOperation {
@@ -125,21 +189,21 @@ class MathHyperbolicSineOperation : public MathBaseOperation {
   MathHyperbolicSineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathHyperbolicCosineOperation : public MathBaseOperation {
  public:
   MathHyperbolicCosineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathHyperbolicTangentOperation : public MathBaseOperation {
  public:
   MathHyperbolicTangentOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathArcSineOperation : public MathBaseOperation {
@@ -147,70 +211,70 @@ class MathArcSineOperation : public MathBaseOperation {
   MathArcSineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathArcCosineOperation : public MathBaseOperation {
  public:
   MathArcCosineOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathArcTangentOperation : public MathBaseOperation {
  public:
   MathArcTangentOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathPowerOperation : public MathBaseOperation {
  public:
   MathPowerOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathLogarithmOperation : public MathBaseOperation {
  public:
   MathLogarithmOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathMinimumOperation : public MathBaseOperation {
  public:
   MathMinimumOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
   MathMaximumOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
   MathRoundOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathLessThanOperation : public MathBaseOperation {
  public:
   MathLessThanOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 class MathGreaterThanOperation : public MathBaseOperation {
  public:
   MathGreaterThanOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathModuloOperation : public MathBaseOperation {
@@ -218,7 +282,7 @@ class MathModuloOperation : public MathBaseOperation {
   MathModuloOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathAbsoluteOperation : public MathBaseOperation {
@@ -226,7 +290,7 @@ class MathAbsoluteOperation : public MathBaseOperation {
   MathAbsoluteOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathRadiansOperation : public MathBaseOperation {
@@ -234,7 +298,7 @@ class MathRadiansOperation : public MathBaseOperation {
   MathRadiansOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathDegreesOperation : public MathBaseOperation {
@@ -242,7 +306,7 @@ class MathDegreesOperation : public MathBaseOperation {
   MathDegreesOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathArcTan2Operation : public MathBaseOperation {
@@ -250,7 +314,7 @@ class MathArcTan2Operation : public MathBaseOperation {
   MathArcTan2Operation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathFloorOperation : public MathBaseOperation {
@@ -258,7 +322,7 @@ class MathFloorOperation : public MathBaseOperation {
   MathFloorOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathCeilOperation : public MathBaseOperation {
@@ -266,7 +330,7 @@ class MathCeilOperation : public MathBaseOperation {
   MathCeilOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathFractOperation : public MathBaseOperation {
@@ -274,7 +338,7 @@ class MathFractOperation : public MathBaseOperation {
   MathFractOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathSqrtOperation : public MathBaseOperation {
@@ -282,7 +346,7 @@ class MathSqrtOperation : public MathBaseOperation {
   MathSqrtOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathInverseSqrtOperation : public MathBaseOperation {
@@ -290,7 +354,7 @@ class MathInverseSqrtOperation : public MathBaseOperation {
   MathInverseSqrtOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathSignOperation : public MathBaseOperation {
@@ -298,7 +362,7 @@ class MathSignOperation : public MathBaseOperation {
   MathSignOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathExponentOperation : public MathBaseOperation {
@@ -306,7 +370,7 @@ class MathExponentOperation : public MathBaseOperation {
   MathExponentOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathTruncOperation : public MathBaseOperation {
@@ -314,7 +378,7 @@ class MathTruncOperation : public MathBaseOperation {
   MathTruncOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathSnapOperation : public MathBaseOperation {
@@ -322,7 +386,7 @@ class MathSnapOperation : public MathBaseOperation {
   MathSnapOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathWrapOperation : public MathBaseOperation {
@@ -330,7 +394,7 @@ class MathWrapOperation : public MathBaseOperation {
   MathWrapOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathPingpongOperation : public MathBaseOperation {
@@ -338,7 +402,7 @@ class MathPingpongOperation : public MathBaseOperation {
   MathPingpongOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathCompareOperation : public MathBaseOperation {
@@ -346,7 +410,7 @@ class MathCompareOperation : public MathBaseOperation {
   MathCompareOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathMultiplyAddOperation : public MathBaseOperation {
@@ -354,7 +418,7 @@ class MathMultiplyAddOperation : public MathBaseOperation {
   MathMultiplyAddOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathSmoothMinOperation : public MathBaseOperation {
@@ -362,7 +426,7 @@ class MathSmoothMinOperation : public MathBaseOperation {
   MathSmoothMinOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MathSmoothMaxOperation : public MathBaseOperation {
@@ -370,6 +434,6 @@ class MathSmoothMaxOperation : public MathBaseOperation {
   MathSmoothMaxOperation() : MathBaseOperation()
   {
   }
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 #endif
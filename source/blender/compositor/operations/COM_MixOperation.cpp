@@ -33,6 +33,7 @@ MixBaseOperation::MixBaseOperation() : NodeOperation()
   this->m_inputColor2Operation = NULL;
   this->setUseValueAlphaMultiply(false);
   this->setUseClamp(false);
+  this->setPixelWise(true);
 }
 
 void MixBaseOperation::initExecution()
@@ -52,15 +53,59 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
   this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = valuem * (inputColor1[0]) + value * (inputColor2[0]);
-  output[1] = valuem * (inputColor1[1]) + value * (inputColor2[1]);
-  output[2] = valuem * (inputColor1[2]) + value * (inputColor2[2]);
-  output[3] = inputColor1[3];
+  PixelCursor p;
+  p.out = output;
+  p.row_end = output + COM_NUM_CHANNELS_COLOR;
+  p.value = inputValue;
+  p.color1 = inputColor1;
+  p.color2 = inputColor2;
+  p.value_stride = p.color1_stride = p.color2_stride = 0;
+  updateMemoryBufferRow(p);
+}
+
+void MixBaseOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  int width = BLI_rcti_size_x(area);
+  int height = BLI_rcti_size_y(area);
+  /* Whole frame areas are contiguous in all buffers, walk them as a single row. */
+  if (output->isContiguous(area) && inputs[0]->isContiguous(area) &&
+      inputs[1]->isContiguous(area) && inputs[2]->isContiguous(area)) {
+    width *= height;
+    height = 1;
+  }
+  PixelCursor p;
+  p.value_stride = inputs[0]->get_num_channels();
+  p.color1_stride = inputs[1]->get_num_channels();
+  p.color2_stride = inputs[2]->get_num_channels();
+  for (int y = area->ymin; y < area->ymin + height; y++) {
+    p.out = output->getElem(area->xmin, y);
+    p.row_end = p.out + width * COM_NUM_CHANNELS_COLOR;
+    p.value = inputs[0]->getElem(area->xmin, y);
+    p.color1 = inputs[1]->getElem(area->xmin, y);
+    p.color2 = inputs[2]->getElem(area->xmin, y);
+    updateMemoryBufferRow(p);
+  }
+}
+
+void MixBaseOperation::updateMemoryBufferRow(PixelCursor &row)
+{
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    p.out[0] = valuem * (p.color1[0]) + value * (p.color2[0]);
+    p.out[1] = valuem * (p.color1[1]) + value * (p.color2[1]);
+    p.out[2] = valuem * (p.color1[2]) + value * (p.color2[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 valuem = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_add_ps(_mm_mul_ps(valuem, color1), _mm_mul_ps(value, color2));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 void MixBaseOperation::determineResolution(unsigned int resolution[2],
@@ -102,26 +147,21 @@ MixAddOperation::MixAddOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixAddOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  output[0] = inputColor1[0] + value * inputColor2[0];
-  output[1] = inputColor1[1] + value * inputColor2[1];
-  output[2] = inputColor1[2] + value * inputColor2[2];
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    p.out[0] = p.color1[0] + value * p.color2[0];
+    p.out[1] = p.color1[1] + value * p.color2[1];
+    p.out[2] = p.color1[2] + value * p.color2[2];
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_add_ps(color1, _mm_mul_ps(value, color2));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Blend Operation ******** */
@@ -131,31 +171,23 @@ MixBlendOperation::MixBlendOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixBlendOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixBlendOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float value;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-  value = inputValue[0];
-
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = valuem * (inputColor1[0]) + value * (inputColor2[0]);
-  output[1] = valuem * (inputColor1[1]) + value * (inputColor2[1]);
-  output[2] = valuem * (inputColor1[2]) + value * (inputColor2[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    p.out[0] = valuem * (p.color1[0]) + value * (p.color2[0]);
+    p.out[1] = valuem * (p.color1[1]) + value * (p.color2[1]);
+    p.out[2] = valuem * (p.color1[2]) + value * (p.color2[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 valuem = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_add_ps(_mm_mul_ps(valuem, color1), _mm_mul_ps(value, color2));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Burn Operation ******** */
@@ -165,80 +197,66 @@ MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorBurnOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixColorBurnOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float tmp;
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
+    float valuem = 1.0f - value;
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  tmp = valuem + value * inputColor2[0];
-  if (tmp <= 0.0f) {
-    output[0] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[0]) / tmp;
-    if (tmp < 0.0f) {
-      output[0] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[0] = 1.0f;
+    tmp = valuem + value * p.color2[0];
+    if (tmp <= 0.0f) {
+      p.out[0] = 0.0f;
     }
     else {
-      output[0] = tmp;
+      tmp = 1.0f - (1.0f - p.color1[0]) / tmp;
+      if (tmp < 0.0f) {
+        p.out[0] = 0.0f;
+      }
+      else if (tmp > 1.0f) {
+        p.out[0] = 1.0f;
+      }
+      else {
+        p.out[0] = tmp;
+      }
     }
-  }
 
-  tmp = valuem + value * inputColor2[1];
-  if (tmp <= 0.0f) {
-    output[1] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[1]) / tmp;
-    if (tmp < 0.0f) {
-      output[1] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[1] = 1.0f;
+    tmp = valuem + value * p.color2[1];
+    if (tmp <= 0.0f) {
+      p.out[1] = 0.0f;
     }
     else {
-      output[1] = tmp;
+      tmp = 1.0f - (1.0f - p.color1[1]) / tmp;
+      if (tmp < 0.0f) {
+        p.out[1] = 0.0f;
+      }
+      else if (tmp > 1.0f) {
+        p.out[1] = 1.0f;
+      }
+      else {
+        p.out[1] = tmp;
+      }
     }
-  }
 
-  tmp = valuem + value * inputColor2[2];
-  if (tmp <= 0.0f) {
-    output[2] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[2]) / tmp;
-    if (tmp < 0.0f) {
-      output[2] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[2] = 1.0f;
+    tmp = valuem + value * p.color2[2];
+    if (tmp <= 0.0f) {
+      p.out[2] = 0.0f;
     }
     else {
-      output[2] = tmp;
+      tmp = 1.0f - (1.0f - p.color1[2]) / tmp;
+      if (tmp < 0.0f) {
+        p.out[2] = 0.0f;
+      }
+      else if (tmp > 1.0f) {
+        p.out[2] = 1.0f;
+      }
+      else {
+        p.out[2] = tmp;
+      }
     }
-  }
-
-  output[3] = inputColor1[3];
 
-  clampIfNeeded(output);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Color Operation ******** */
@@ -248,42 +266,27 @@ MixColorOperation::MixColorOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixColorOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  float colH, colS, colV;
-  rgb_to_hsv(inputColor2[0], inputColor2[1], inputColor2[2], &colH, &colS, &colV);
-  if (colS != 0.0f) {
-    float rH, rS, rV;
-    float tmpr, tmpg, tmpb;
-    rgb_to_hsv(inputColor1[0], inputColor1[1], inputColor1[2], &rH, &rS, &rV);
-    hsv_to_rgb(colH, colS, rV, &tmpr, &tmpg, &tmpb);
-    output[0] = (valuem * inputColor1[0]) + (value * tmpr);
-    output[1] = (valuem * inputColor1[1]) + (value * tmpg);
-    output[2] = (valuem * inputColor1[2]) + (value * tmpb);
-  }
-  else {
-    copy_v3_v3(output, inputColor1);
-  }
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+    float colH, colS, colV;
+    rgb_to_hsv(p.color2[0], p.color2[1], p.color2[2], &colH, &colS, &colV);
+    if (colS != 0.0f) {
+      float rH, rS, rV;
+      float tmpr, tmpg, tmpb;
+      rgb_to_hsv(p.color1[0], p.color1[1], p.color1[2], &rH, &rS, &rV);
+      hsv_to_rgb(colH, colS, rV, &tmpr, &tmpg, &tmpb);
+      p.out[0] = (valuem * p.color1[0]) + (value * tmpr);
+      p.out[1] = (valuem * p.color1[1]) + (value * tmpg);
+      p.out[2] = (valuem * p.color1[2]) + (value * tmpb);
+    }
+    else {
+      copy_v3_v3(p.out, p.color1);
+    }
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Darken Operation ******** */
@@ -293,30 +296,23 @@ MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDarkenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDarkenOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = min_ff(inputColor1[0], inputColor2[0]) * value + inputColor1[0] * valuem;
-  output[1] = min_ff(inputColor1[1], inputColor2[1]) * value + inputColor1[1] * valuem;
-  output[2] = min_ff(inputColor1[2], inputColor2[2]) * value + inputColor1[2] * valuem;
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    p.out[0] = min_ff(p.color1[0], p.color2[0]) * value + p.color1[0] * valuem;
+    p.out[1] = min_ff(p.color1[1], p.color2[1]) * value + p.color1[1] * valuem;
+    p.out[2] = min_ff(p.color1[2], p.color2[2]) * value + p.color1[2] * valuem;
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 valuem = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_add_ps(_mm_mul_ps(_mm_min_ps(color1, color2), value), _mm_mul_ps(color1, valuem));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Difference Operation ******** */
@@ -326,30 +322,24 @@ MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDifferenceOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixDifferenceOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = valuem * inputColor1[0] + value * fabsf(inputColor1[0] - inputColor2[0]);
-  output[1] = valuem * inputColor1[1] + value * fabsf(inputColor1[1] - inputColor2[1]);
-  output[2] = valuem * inputColor1[2] + value * fabsf(inputColor1[2] - inputColor2[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    p.out[0] = valuem * p.color1[0] + value * fabsf(p.color1[0] - p.color2[0]);
+    p.out[1] = valuem * p.color1[1] + value * fabsf(p.color1[1] - p.color2[1]);
+    p.out[2] = valuem * p.color1[2] + value * fabsf(p.color1[2] - p.color2[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 valuem = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(color1, color2));
+    return _mm_add_ps(_mm_mul_ps(valuem, color1), _mm_mul_ps(value, difference));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Difference Operation ******** */
@@ -359,47 +349,32 @@ MixDivideOperation::MixDivideOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDivideOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDivideOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  if (inputColor2[0] != 0.0f) {
-    output[0] = valuem * (inputColor1[0]) + value * (inputColor1[0]) / inputColor2[0];
-  }
-  else {
-    output[0] = 0.0f;
-  }
-  if (inputColor2[1] != 0.0f) {
-    output[1] = valuem * (inputColor1[1]) + value * (inputColor1[1]) / inputColor2[1];
-  }
-  else {
-    output[1] = 0.0f;
-  }
-  if (inputColor2[2] != 0.0f) {
-    output[2] = valuem * (inputColor1[2]) + value * (inputColor1[2]) / inputColor2[2];
-  }
-  else {
-    output[2] = 0.0f;
-  }
-
-  output[3] = inputColor1[3];
+    if (p.color2[0] != 0.0f) {
+      p.out[0] = valuem * (p.color1[0]) + value * (p.color1[0]) / p.color2[0];
+    }
+    else {
+      p.out[0] = 0.0f;
+    }
+    if (p.color2[1] != 0.0f) {
+      p.out[1] = valuem * (p.color1[1]) + value * (p.color1[1]) / p.color2[1];
+    }
+    else {
+      p.out[1] = 0.0f;
+    }
+    if (p.color2[2] != 0.0f) {
+      p.out[2] = valuem * (p.color1[2]) + value * (p.color1[2]) / p.color2[2];
+    }
+    else {
+      p.out[2] = 0.0f;
+    }
 
-  clampIfNeeded(output);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Dodge Operation ******** */
@@ -409,85 +384,70 @@ MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDodgeOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixDodgeOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float tmp;
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-
-  if (inputColor1[0] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[0];
-    if (tmp <= 0.0f) {
-      output[0] = 1.0f;
-    }
-    else {
-      tmp = inputColor1[0] / tmp;
-      if (tmp > 1.0f) {
-        output[0] = 1.0f;
+    if (p.color1[0] != 0.0f) {
+      tmp = 1.0f - value * p.color2[0];
+      if (tmp <= 0.0f) {
+        p.out[0] = 1.0f;
       }
       else {
-        output[0] = tmp;
+        tmp = p.color1[0] / tmp;
+        if (tmp > 1.0f) {
+          p.out[0] = 1.0f;
+        }
+        else {
+          p.out[0] = tmp;
+        }
       }
     }
-  }
-  else {
-    output[0] = 0.0f;
-  }
-
-  if (inputColor1[1] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[1];
-    if (tmp <= 0.0f) {
-      output[1] = 1.0f;
-    }
     else {
-      tmp = inputColor1[1] / tmp;
-      if (tmp > 1.0f) {
-        output[1] = 1.0f;
+      p.out[0] = 0.0f;
+    }
+
+    if (p.color1[1] != 0.0f) {
+      tmp = 1.0f - value * p.color2[1];
+      if (tmp <= 0.0f) {
+        p.out[1] = 1.0f;
       }
       else {
-        output[1] = tmp;
+        tmp = p.color1[1] / tmp;
+        if (tmp > 1.0f) {
+          p.out[1] = 1.0f;
+        }
+        else {
+          p.out[1] = tmp;
+        }
       }
     }
-  }
-  else {
-    output[1] = 0.0f;
-  }
-
-  if (inputColor1[2] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[2];
-    if (tmp <= 0.0f) {
-      output[2] = 1.0f;
-    }
     else {
-      tmp = inputColor1[2] / tmp;
-      if (tmp > 1.0f) {
-        output[2] = 1.0f;
+      p.out[1] = 0.0f;
+    }
+
+    if (p.color1[2] != 0.0f) {
+      tmp = 1.0f - value * p.color2[2];
+      if (tmp <= 0.0f) {
+        p.out[2] = 1.0f;
       }
       else {
-        output[2] = tmp;
+        tmp = p.color1[2] / tmp;
+        if (tmp > 1.0f) {
+          p.out[2] = 1.0f;
+        }
+        else {
+          p.out[2] = tmp;
+        }
       }
     }
-  }
-  else {
-    output[2] = 0.0f;
-  }
-
-  output[3] = inputColor1[3];
+    else {
+      p.out[2] = 0.0f;
+    }
 
-  clampIfNeeded(output);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Glare Operation ******** */
@@ -497,38 +457,22 @@ MixGlareOperation::MixGlareOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixGlareOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixGlareOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float value;
+  mixRow(row, [](const PixelCursor &p, float value) {
+    const float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-  value = inputValue[0];
-  float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
-
-  if (inputColor1[0] < 0.0f) {
-    inputColor1[0] = 0.0f;
-  }
-  if (inputColor1[1] < 0.0f) {
-    inputColor1[1] = 0.0f;
-  }
-  if (inputColor1[2] < 0.0f) {
-    inputColor1[2] = 0.0f;
-  }
-
-  output[0] = mf * max(inputColor1[0] + value * (inputColor2[0] - inputColor1[0]), 0.0f);
-  output[1] = mf * max(inputColor1[1] + value * (inputColor2[1] - inputColor1[1]), 0.0f);
-  output[2] = mf * max(inputColor1[2] + value * (inputColor2[2] - inputColor1[2]), 0.0f);
-  output[3] = inputColor1[3];
+    /* Negative input colors are clamped, without modifying the input buffer. */
+    float inputColor1[3];
+    inputColor1[0] = max(p.color1[0], 0.0f);
+    inputColor1[1] = max(p.color1[1], 0.0f);
+    inputColor1[2] = max(p.color1[2], 0.0f);
 
-  clampIfNeeded(output);
+    p.out[0] = mf * max(inputColor1[0] + value * (p.color2[0] - inputColor1[0]), 0.0f);
+    p.out[1] = mf * max(inputColor1[1] + value * (p.color2[1] - inputColor1[1]), 0.0f);
+    p.out[2] = mf * max(inputColor1[2] + value * (p.color2[2] - inputColor1[2]), 0.0f);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Hue Operation ******** */
@@ -538,39 +482,27 @@ MixHueOperation::MixHueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixHueOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  float colH, colS, colV;
-  rgb_to_hsv(inputColor2[0], inputColor2[1], inputColor2[2], &colH, &colS, &colV);
-  if (colS != 0.0f) {
-    float rH, rS, rV;
-    float tmpr, tmpg, tmpb;
-    rgb_to_hsv(inputColor1[0], inputColor1[1], inputColor1[2], &rH, &rS, &rV);
-    hsv_to_rgb(colH, rS, rV, &tmpr, &tmpg, &tmpb);
-    output[0] = valuem * (inputColor1[0]) + value * tmpr;
-    output[1] = valuem * (inputColor1[1]) + value * tmpg;
-    output[2] = valuem * (inputColor1[2]) + value * tmpb;
-  }
-  else {
-    copy_v3_v3(output, inputColor1);
-  }
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+    float colH, colS, colV;
+    rgb_to_hsv(p.color2[0], p.color2[1], p.color2[2], &colH, &colS, &colV);
+    if (colS != 0.0f) {
+      float rH, rS, rV;
+      float tmpr, tmpg, tmpb;
+      rgb_to_hsv(p.color1[0], p.color1[1], p.color1[2], &rH, &rS, &rV);
+      hsv_to_rgb(colH, rS, rV, &tmpr, &tmpg, &tmpb);
+      p.out[0] = valuem * (p.color1[0]) + value * tmpr;
+      p.out[1] = valuem * (p.color1[1]) + value * tmpg;
+      p.out[2] = valuem * (p.color1[2]) + value * tmpb;
+    }
+    else {
+      copy_v3_v3(p.out, p.color1);
+    }
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Lighten Operation ******** */
@@ -580,48 +512,40 @@ MixLightenOperation::MixLightenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLightenOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixLightenOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float tmp;
-  tmp = value * inputColor2[0];
-  if (tmp > inputColor1[0]) {
-    output[0] = tmp;
-  }
-  else {
-    output[0] = inputColor1[0];
-  }
-  tmp = value * inputColor2[1];
-  if (tmp > inputColor1[1]) {
-    output[1] = tmp;
-  }
-  else {
-    output[1] = inputColor1[1];
-  }
-  tmp = value * inputColor2[2];
-  if (tmp > inputColor1[2]) {
-    output[2] = tmp;
-  }
-  else {
-    output[2] = inputColor1[2];
-  }
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    float tmp;
+    tmp = value * p.color2[0];
+    if (tmp > p.color1[0]) {
+      p.out[0] = tmp;
+    }
+    else {
+      p.out[0] = p.color1[0];
+    }
+    tmp = value * p.color2[1];
+    if (tmp > p.color1[1]) {
+      p.out[1] = tmp;
+    }
+    else {
+      p.out[1] = p.color1[1];
+    }
+    tmp = value * p.color2[2];
+    if (tmp > p.color1[2]) {
+      p.out[2] = tmp;
+    }
+    else {
+      p.out[2] = p.color1[2];
+    }
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_max_ps(_mm_mul_ps(value, color2), color1);
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Linear Light Operation ******** */
@@ -631,45 +555,30 @@ MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLinearLightOperation::executePixelSampled(float output[4],
-                                                  float x,
-                                                  float y,
-                                                  PixelSampler sampler)
+void MixLinearLightOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  if (inputColor2[0] > 0.5f) {
-    output[0] = inputColor1[0] + value * (2.0f * (inputColor2[0] - 0.5f));
-  }
-  else {
-    output[0] = inputColor1[0] + value * (2.0f * (inputColor2[0]) - 1.0f);
-  }
-  if (inputColor2[1] > 0.5f) {
-    output[1] = inputColor1[1] + value * (2.0f * (inputColor2[1] - 0.5f));
-  }
-  else {
-    output[1] = inputColor1[1] + value * (2.0f * (inputColor2[1]) - 1.0f);
-  }
-  if (inputColor2[2] > 0.5f) {
-    output[2] = inputColor1[2] + value * (2.0f * (inputColor2[2] - 0.5f));
-  }
-  else {
-    output[2] = inputColor1[2] + value * (2.0f * (inputColor2[2]) - 1.0f);
-  }
-
-  output[3] = inputColor1[3];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    if (p.color2[0] > 0.5f) {
+      p.out[0] = p.color1[0] + value * (2.0f * (p.color2[0] - 0.5f));
+    }
+    else {
+      p.out[0] = p.color1[0] + value * (2.0f * (p.color2[0]) - 1.0f);
+    }
+    if (p.color2[1] > 0.5f) {
+      p.out[1] = p.color1[1] + value * (2.0f * (p.color2[1] - 0.5f));
+    }
+    else {
+      p.out[1] = p.color1[1] + value * (2.0f * (p.color2[1]) - 1.0f);
+    }
+    if (p.color2[2] > 0.5f) {
+      p.out[2] = p.color1[2] + value * (2.0f * (p.color2[2] - 0.5f));
+    }
+    else {
+      p.out[2] = p.color1[2] + value * (2.0f * (p.color2[2]) - 1.0f);
+    }
 
-  clampIfNeeded(output);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Multiply Operation ******** */
@@ -679,30 +588,23 @@ MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixMultiplyOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixMultiplyOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = inputColor1[0] * (valuem + value * inputColor2[0]);
-  output[1] = inputColor1[1] * (valuem + value * inputColor2[1]);
-  output[2] = inputColor1[2] * (valuem + value * inputColor2[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    p.out[0] = p.color1[0] * (valuem + value * p.color2[0]);
+    p.out[1] = p.color1[1] * (valuem + value * p.color2[1]);
+    p.out[2] = p.color1[2] * (valuem + value * p.color2[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 valuem = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_mul_ps(color1, _mm_add_ps(valuem, _mm_mul_ps(value, color2)));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Ovelray Operation ******** */
@@ -712,47 +614,31 @@ MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixOverlayOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixOverlayOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-
-  float valuem = 1.0f - value;
-
-  if (inputColor1[0] < 0.5f) {
-    output[0] = inputColor1[0] * (valuem + 2.0f * value * inputColor2[0]);
-  }
-  else {
-    output[0] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
-  }
-  if (inputColor1[1] < 0.5f) {
-    output[1] = inputColor1[1] * (valuem + 2.0f * value * inputColor2[1]);
-  }
-  else {
-    output[1] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
-  }
-  if (inputColor1[2] < 0.5f) {
-    output[2] = inputColor1[2] * (valuem + 2.0f * value * inputColor2[2]);
-  }
-  else {
-    output[2] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
-  }
-  output[3] = inputColor1[3];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  clampIfNeeded(output);
+    if (p.color1[0] < 0.5f) {
+      p.out[0] = p.color1[0] * (valuem + 2.0f * value * p.color2[0]);
+    }
+    else {
+      p.out[0] = 1.0f - (valuem + 2.0f * value * (1.0f - p.color2[0])) * (1.0f - p.color1[0]);
+    }
+    if (p.color1[1] < 0.5f) {
+      p.out[1] = p.color1[1] * (valuem + 2.0f * value * p.color2[1]);
+    }
+    else {
+      p.out[1] = 1.0f - (valuem + 2.0f * value * (1.0f - p.color2[1])) * (1.0f - p.color1[1]);
+    }
+    if (p.color1[2] < 0.5f) {
+      p.out[2] = p.color1[2] * (valuem + 2.0f * value * p.color2[2]);
+    }
+    else {
+      p.out[2] = 1.0f - (valuem + 2.0f * value * (1.0f - p.color2[2])) * (1.0f - p.color1[2]);
+    }
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Saturation Operation ******** */
@@ -762,39 +648,24 @@ MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSaturationOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixSaturationOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  float rH, rS, rV;
-  rgb_to_hsv(inputColor1[0], inputColor1[1], inputColor1[2], &rH, &rS, &rV);
-  if (rS != 0.0f) {
-    float colH, colS, colV;
-    rgb_to_hsv(inputColor2[0], inputColor2[1], inputColor2[2], &colH, &colS, &colV);
-    hsv_to_rgb(rH, (valuem * rS + value * colS), rV, &output[0], &output[1], &output[2]);
-  }
-  else {
-    copy_v3_v3(output, inputColor1);
-  }
-
-  output[3] = inputColor1[3];
+    float rH, rS, rV;
+    rgb_to_hsv(p.color1[0], p.color1[1], p.color1[2], &rH, &rS, &rV);
+    if (rS != 0.0f) {
+      float colH, colS, colV;
+      rgb_to_hsv(p.color2[0], p.color2[1], p.color2[2], &colH, &colS, &colV);
+      hsv_to_rgb(rH, (valuem * rS + value * colS), rV, &p.out[0], &p.out[1], &p.out[2]);
+    }
+    else {
+      copy_v3_v3(p.out, p.color1);
+    }
 
-  clampIfNeeded(output);
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Screen Operation ******** */
@@ -804,31 +675,26 @@ MixScreenOperation::MixScreenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixScreenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixScreenOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
+  auto mix = [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  output[0] = 1.0f - (valuem + value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
-  output[1] = 1.0f - (valuem + value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
-  output[2] = 1.0f - (valuem + value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+    p.out[0] = 1.0f - (valuem + value * (1.0f - p.color2[0])) * (1.0f - p.color1[0]);
+    p.out[1] = 1.0f - (valuem + value * (1.0f - p.color2[1])) * (1.0f - p.color1[1]);
+    p.out[2] = 1.0f - (valuem + value * (1.0f - p.color2[2])) * (1.0f - p.color1[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 valuem = _mm_sub_ps(one, value);
+    const __m128 factor = _mm_add_ps(valuem, _mm_mul_ps(value, _mm_sub_ps(one, color2)));
+    return _mm_sub_ps(one, _mm_mul_ps(factor, _mm_sub_ps(one, color1)));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Soft Light Operation ******** */
@@ -838,43 +704,28 @@ MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSoftLightOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixSoftLightOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  float scr, scg, scb;
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
+    float scr, scg, scb;
 
-  /* first calculate non-fac based Screen mix */
-  scr = 1.0f - (1.0f - inputColor2[0]) * (1.0f - inputColor1[0]);
-  scg = 1.0f - (1.0f - inputColor2[1]) * (1.0f - inputColor1[1]);
-  scb = 1.0f - (1.0f - inputColor2[2]) * (1.0f - inputColor1[2]);
+    /* first calculate non-fac based Screen mix */
+    scr = 1.0f - (1.0f - p.color2[0]) * (1.0f - p.color1[0]);
+    scg = 1.0f - (1.0f - p.color2[1]) * (1.0f - p.color1[1]);
+    scb = 1.0f - (1.0f - p.color2[2]) * (1.0f - p.color1[2]);
 
-  output[0] = valuem * (inputColor1[0]) +
-              value * (((1.0f - inputColor1[0]) * inputColor2[0] * (inputColor1[0])) +
-                       (inputColor1[0] * scr));
-  output[1] = valuem * (inputColor1[1]) +
-              value * (((1.0f - inputColor1[1]) * inputColor2[1] * (inputColor1[1])) +
-                       (inputColor1[1] * scg));
-  output[2] = valuem * (inputColor1[2]) +
-              value * (((1.0f - inputColor1[2]) * inputColor2[2] * (inputColor1[2])) +
-                       (inputColor1[2] * scb));
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+    p.out[0] = valuem * (p.color1[0]) +
+                value * (((1.0f - p.color1[0]) * p.color2[0] * (p.color1[0])) +
+                         (p.color1[0] * scr));
+    p.out[1] = valuem * (p.color1[1]) +
+                value * (((1.0f - p.color1[1]) * p.color2[1] * (p.color1[1])) +
+                         (p.color1[1] * scg));
+    p.out[2] = valuem * (p.color1[2]) +
+                value * (((1.0f - p.color1[2]) * p.color2[2] * (p.color1[2])) +
+                         (p.color1[2] * scb));
+    p.out[3] = p.color1[3];
+  });
 }
 
 /* ******** Mix Subtract Operation ******** */
@@ -884,29 +735,21 @@ MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSubtractOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixSubtractOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  output[0] = inputColor1[0] - value * (inputColor2[0]);
-  output[1] = inputColor1[1] - value * (inputColor2[1]);
-  output[2] = inputColor1[2] - value * (inputColor2[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  auto mix = [](const PixelCursor &p, float value) {
+    p.out[0] = p.color1[0] - value * (p.color2[0]);
+    p.out[1] = p.color1[1] - value * (p.color2[1]);
+    p.out[2] = p.color1[2] - value * (p.color2[2]);
+    p.out[3] = p.color1[3];
+  };
+#ifdef __SSE2__
+  mixRow(row, mix, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_sub_ps(color1, _mm_mul_ps(value, color2));
+  });
+#else
+  mixRow(row, mix);
+#endif
 }
 
 /* ******** Mix Value Operation ******** */
@@ -916,31 +759,16 @@ MixValueOperation::MixValueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixValueOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixValueOperation::updateMemoryBufferRow(PixelCursor &row)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
+  mixRow(row, [](const PixelCursor &p, float value) {
+    float valuem = 1.0f - value;
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  float rH, rS, rV;
-  float colH, colS, colV;
-  rgb_to_hsv(inputColor1[0], inputColor1[1], inputColor1[2], &rH, &rS, &rV);
-  rgb_to_hsv(inputColor2[0], inputColor2[1], inputColor2[2], &colH, &colS, &colV);
-  hsv_to_rgb(rH, rS, (valuem * rV + value * colV), &output[0], &output[1], &output[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+    float rH, rS, rV;
+    float colH, colS, colV;
+    rgb_to_hsv(p.color1[0], p.color1[1], p.color1[2], &rH, &rS, &rV);
+    rgb_to_hsv(p.color2[0], p.color2[1], p.color2[2], &colH, &colS, &colV);
+    hsv_to_rgb(rH, rS, (valuem * rV + value * colV), &p.out[0], &p.out[1], &p.out[2]);
+    p.out[3] = p.color1[3];
+  });
 }
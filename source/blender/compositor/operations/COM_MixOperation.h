@@ -20,6 +20,10 @@
 #define __COM_MIXOPERATION_H__
 #include "COM_NodeOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /**
  * All this programs converts an input color to an output value.
  * it assumes we are in sRGB color space.
@@ -27,6 +31,21 @@
 
 class MixBaseOperation : public NodeOperation {
  protected:
+  /**
+   * Walks one row of the output and input buffers. Inputs may have a different number of
+   * channels than the output, so every pointer has its own stride.
+   */
+  struct PixelCursor {
+    float *out;
+    const float *row_end;
+    const float *value;
+    const float *color1;
+    const float *color2;
+    int value_stride;
+    int color1_stride;
+    int color2_stride;
+  };
+
   /**
    * Prefetched reference to the inputProgram
    */
@@ -36,13 +55,132 @@ class MixBaseOperation : public NodeOperation {
   bool m_valueAlphaMultiply;
   bool m_useClamp;
 
-  inline void clampIfNeeded(float color[4])
+  /**
+   * Call `mix(p, value)` for every pixel of the row, with the cursor at the pixel and the value
+   * already multiplied by the alpha of the second color when that option is used. The use alpha
+   * and clamp options are decided once per row instead of per pixel.
+   */
+  template<typename MixFunc> void mixRow(const PixelCursor &p, MixFunc mix)
+  {
+    if (this->m_valueAlphaMultiply) {
+      if (this->m_useClamp) {
+        mixRowStrides<true, true>(p, mix);
+      }
+      else {
+        mixRowStrides<true, false>(p, mix);
+      }
+    }
+    else {
+      if (this->m_useClamp) {
+        mixRowStrides<false, true>(p, mix);
+      }
+      else {
+        mixRowStrides<false, false>(p, mix);
+      }
+    }
+  }
+
+  /**
+   * Buffered execution always passes one value and two colors per pixel, that case gets its own
+   * loop with constant strides so the compiler can unroll and vectorize it.
+   */
+  template<bool UseAlpha, bool Clamp, typename MixFunc>
+  static void mixRowStrides(const PixelCursor &p, MixFunc mix)
+  {
+    if (p.value_stride == COM_NUM_CHANNELS_VALUE && p.color1_stride == COM_NUM_CHANNELS_COLOR &&
+        p.color2_stride == COM_NUM_CHANNELS_COLOR) {
+      mixRowLoop<UseAlpha, Clamp, true>(p, mix);
+    }
+    else {
+      mixRowLoop<UseAlpha, Clamp, false>(p, mix);
+    }
+  }
+
+  template<bool UseAlpha, bool Clamp, bool Contiguous, typename MixFunc>
+  static void mixRowLoop(const PixelCursor &p, MixFunc mix)
+  {
+    const int value_stride = Contiguous ? COM_NUM_CHANNELS_VALUE : p.value_stride;
+    const int color1_stride = Contiguous ? COM_NUM_CHANNELS_COLOR : p.color1_stride;
+    const int color2_stride = Contiguous ? COM_NUM_CHANNELS_COLOR : p.color2_stride;
+    PixelCursor c = p;
+    while (c.out < c.row_end) {
+      float value = c.value[0];
+      if (UseAlpha) {
+        value *= c.color2[3];
+      }
+      mix(c, value);
+      if (Clamp) {
+        clamp_v4(c.out, 0.0f, 1.0f);
+      }
+      c.out += COM_NUM_CHANNELS_COLOR;
+      c.value += value_stride;
+      c.color1 += color1_stride;
+      c.color2 += color2_stride;
+    }
+  }
+#ifdef __SSE2__
+  /**
+   * Same as `mixRow(p, mix)`, with an SSE2 version of the mix function for the constant strides
+   * of buffered execution. `mix_sse(color1, color2, value)` mixes all four channels of a pixel,
+   * the alpha of the first color is kept afterwards. The SSE2 version must do the same float
+   * operations as the scalar one, so both give the same result.
+   */
+  template<typename MixFunc, typename MixFuncSSE>
+  void mixRow(const PixelCursor &p, MixFunc mix, MixFuncSSE mix_sse)
   {
-    if (m_useClamp) {
-      clamp_v4(color, 0.0f, 1.0f);
+    if (p.value_stride != COM_NUM_CHANNELS_VALUE || p.color1_stride != COM_NUM_CHANNELS_COLOR ||
+        p.color2_stride != COM_NUM_CHANNELS_COLOR) {
+      mixRow(p, mix);
+    }
+    else if (this->m_valueAlphaMultiply) {
+      if (this->m_useClamp) {
+        mixRowLoopSSE<true, true>(p, mix_sse);
+      }
+      else {
+        mixRowLoopSSE<true, false>(p, mix_sse);
+      }
+    }
+    else {
+      if (this->m_useClamp) {
+        mixRowLoopSSE<false, true>(p, mix_sse);
+      }
+      else {
+        mixRowLoopSSE<false, false>(p, mix_sse);
+      }
     }
   }
 
+  template<bool UseAlpha, bool Clamp, typename MixFuncSSE>
+  static void mixRowLoopSSE(const PixelCursor &p, MixFuncSSE mix_sse)
+  {
+    const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const float *value = p.value;
+    const float *color1 = p.color1;
+    const float *color2 = p.color2;
+    for (float *out = p.out; out < p.row_end; out += COM_NUM_CHANNELS_COLOR) {
+      const __m128 c1 = _mm_loadu_ps(color1);
+      const __m128 c2 = _mm_loadu_ps(color2);
+      float v = value[0];
+      if (UseAlpha) {
+        v *= color2[3];
+      }
+      __m128 result = mix_sse(c1, c2, _mm_set1_ps(v));
+      result = _mm_or_ps(_mm_and_ps(rgb_mask, result), _mm_andnot_ps(rgb_mask, c1));
+      if (Clamp) {
+        /* Same order of the operands as CLAMP, so NaN is kept. */
+        result = _mm_min_ps(one, _mm_max_ps(zero, result));
+      }
+      _mm_storeu_ps(out, result);
+      value += COM_NUM_CHANNELS_VALUE;
+      color1 += COM_NUM_CHANNELS_COLOR;
+      color2 += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+#endif
+
+
  public:
   /**
    * Default constructor
@@ -54,6 +192,13 @@ class MixBaseOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
+  /**
+   * Mix a row of pixels, used by both the per pixel and the buffered execution.
+   */
+  virtual void updateMemoryBufferRow(PixelCursor &p);
+
   /**
    * Initialize the execution
    */
@@ -83,115 +228,115 @@ class MixBaseOperation : public NodeOperation {
 class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
  public:
   MixColorBurnOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixColorOperation : public MixBaseOperation {
  public:
   MixColorOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixDivideOperation : public MixBaseOperation {
  public:
   MixDivideOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
  public:
   MixDodgeOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixGlareOperation : public MixBaseOperation {
  public:
   MixGlareOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixHueOperation : public MixBaseOperation {
  public:
   MixHueOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
  public:
   MixLinearLightOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
  public:
   MixOverlayOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
  public:
   MixSaturationOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
  public:
   MixSoftLightOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 class MixValueOperation : public MixBaseOperation {
  public:
   MixValueOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferRow(PixelCursor &p);
 };
 
 #endif
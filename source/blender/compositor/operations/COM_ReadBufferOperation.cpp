@@ -17,6 +17,8 @@
  */
 
 #include "COM_ReadBufferOperation.h"
+#include "COM_CPUDevice.h"
+#include "COM_WorkScheduler.h"
 #include "COM_WriteBufferOperation.h"
 #include "COM_defines.h"
 
@@ -26,11 +28,20 @@ ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
   this->m_single_value = false;
   this->m_offset = 0;
   this->m_buffer = NULL;
+  this->m_datatype = datatype;
 }
 
 void *ReadBufferOperation::initializeTileData(rcti * /*rect*/)
 {
-  return m_buffer;
+  /* Readers access the data directly, half float buffers or buffers with fewer channels than
+   * read are converted once for all of them. Only the area the chunk reads is converted, the
+   * rect passed here is the one of the reader, or none at all. */
+  CPUDevice *device = WorkScheduler::current_cpu_device();
+  rcti area;
+  if (device && device->determineInputArea(this, &area)) {
+    return m_memoryProxy->getFloatBuffer(m_datatype, &area);
+  }
+  return m_memoryProxy->getFloatBuffer(m_datatype, NULL);
 }
 
 void ReadBufferOperation::determineResolution(unsigned int resolution[2],
@@ -72,6 +83,7 @@ void ReadBufferOperation::executePixelSampled(float output[4],
         break;
     }
   }
+  m_memoryProxy->convertPixel(output, m_datatype);
 }
 
 void ReadBufferOperation::executePixelExtend(float output[4],
@@ -91,6 +103,7 @@ void ReadBufferOperation::executePixelExtend(float output[4],
   else {
     m_buffer->readBilinear(output, x, y, extend_x, extend_y);
   }
+  m_memoryProxy->convertPixel(output, m_datatype);
 }
 
 void ReadBufferOperation::executePixelFiltered(
@@ -103,8 +116,14 @@ void ReadBufferOperation::executePixelFiltered(
   else {
     const float uv[2] = {x, y};
     const float deriv[2][2] = {{dx[0], dx[1]}, {dy[0], dy[1]}};
+    if (m_memoryProxy->getDataType() != m_datatype) {
+      /* EWA filtering needs all color channels stored. */
+      m_memoryProxy->getFloatBuffer(m_datatype, NULL)->readEWA(output, uv, deriv);
+      return;
+    }
     m_buffer->readEWA(output, uv, deriv);
   }
+  m_memoryProxy->convertPixel(output, m_datatype);
 }
 
 bool ReadBufferOperation::determineDependingAreaOfInterest(rcti *input,
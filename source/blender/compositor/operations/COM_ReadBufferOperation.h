@@ -29,6 +29,7 @@ class ReadBufferOperation : public NodeOperation {
   bool m_single_value; /* single value stored in buffer, copied from associated write operation */
   unsigned int m_offset;
   MemoryBuffer *m_buffer;
+  DataType m_datatype; /* buffer is read as this type, may have more channels than stored */
 
  public:
   ReadBufferOperation(DataType datetype);
@@ -21,6 +21,7 @@
 SetValueOperation::SetValueOperation() : NodeOperation()
 {
   this->addOutputSocket(COM_DT_VALUE);
+  this->setPixelWise(true);
 }
 
 void SetValueOperation::executePixelSampled(float output[4],
@@ -31,6 +32,20 @@ void SetValueOperation::executePixelSampled(float output[4],
   output[0] = this->m_value;
 }
 
+void SetValueOperation::updateMemoryBufferArea(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer ** /*inputs*/)
+{
+  const int num_channels = output->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      out[0] = this->m_value;
+      out += num_channels;
+    }
+  }
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
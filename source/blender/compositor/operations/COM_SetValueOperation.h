@@ -47,6 +47,7 @@ class SetValueOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBufferArea(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
   bool isSetOperation() const
@@ -18,7 +18,10 @@
 
 #include "COM_VariableSizeBokehBlurOperation.h"
 #include "BLI_math.h"
+#include "BLI_rect.h"
+#include "COM_FHTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
 
@@ -56,11 +59,19 @@ void VariableSizeBokehBlurOperation::initExecution()
 #endif
   QualityStepHelper::initExecution(COM_QH_INCREASE);
 }
+/* Blur radius in pixels from which tiles are convolved in layers using the FHT instead of
+ * gathering every pixel. */
+#define COM_BOKEH_FFT_MIN_RADIUS 32
+/* Ratio between the radii of two consecutive layers. */
+#define COM_BOKEH_LAYER_RATIO 1.25f
+
 struct VariableSizeBokehBlurTileData {
   MemoryBuffer *color;
   MemoryBuffer *bokeh;
   MemoryBuffer *size;
   int maxBlurScalar;
+  /* Blurred tile when it is convolved in layers, NULL otherwise. */
+  MemoryBuffer *result;
 };
 
 void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
@@ -79,15 +90,252 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
 
   data->maxBlurScalar = (int)(data->size->getMaximumValue(&rect2) * scalar);
   CLAMP(data->maxBlurScalar, 1.0f, this->m_maxBlur);
+
+  data->result = NULL;
+  if (data->maxBlurScalar >= COM_BOKEH_FFT_MIN_RADIUS) {
+    data->result = convolveLayers(data->color, data->bokeh, data->size, data->maxBlurScalar, rect);
+  }
   return data;
 }
 
 void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void *data)
 {
   VariableSizeBokehBlurTileData *result = (VariableSizeBokehBlurTileData *)data;
+  if (result->result) {
+    delete result->result;
+  }
   delete result;
 }
 
+/* Add the convolution of the pixels in a layer, or in all layers from it on when above is set,
+ * to result. Color goes to the first four channels of result, the weights to the others. */
+static void convolve_layer(MemoryBuffer *colorBuffer,
+                           const int *layers,
+                           const rcti *inputRect,
+                           int layer,
+                           bool above,
+                           FHTConvolution **convolutions,
+                           int numWeights,
+                           float *layerBuffer,
+                           float *result,
+                           const rcti *rect)
+{
+  const rcti *colorRect = colorBuffer->getRect();
+  const int colorWidth = BLI_rcti_size_x(colorRect);
+  const int resultStride = COM_NUM_CHANNELS_COLOR + numWeights;
+  float *layerPixel = layerBuffer;
+  const int *layerIndex = layers;
+
+  for (int y = inputRect->ymin; y < inputRect->ymax; y++) {
+    const float *color = &colorBuffer->getBuffer()[((y - colorRect->ymin) * colorWidth +
+                                                     (inputRect->xmin - colorRect->xmin)) *
+                                                    COM_NUM_CHANNELS_COLOR];
+    for (int x = inputRect->xmin; x < inputRect->xmax; x++) {
+      const float mask = (above ? *layerIndex >= layer : *layerIndex == layer) ? 1.0f : 0.0f;
+      mul_v4_v4fl(layerPixel, color, mask);
+      layerPixel[4] = mask;
+      color += COM_NUM_CHANNELS_COLOR;
+      layerPixel += 5;
+      layerIndex++;
+    }
+  }
+
+  memset(result, 0, sizeof(float) * BLI_rcti_size_x(rect) * BLI_rcti_size_y(rect) * resultStride);
+  for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+    FHTConvolution *convolution = convolutions[(numWeights == 1) ? 0 : ch];
+    convolution->convolve(&layerBuffer[ch], inputRect, 5, &result[ch], rect, resultStride);
+  }
+  for (int ch = 0; ch < numWeights; ch++) {
+    convolutions[ch]->convolve(&layerBuffer[4],
+                               inputRect,
+                               5,
+                               &result[COM_NUM_CHANNELS_COLOR + ch],
+                               rect,
+                               resultStride);
+  }
+}
+
+/**
+ * The gather in executePixel limits the size of every neighbor to the size of the center pixel.
+ * Here pixels are sorted in layers of similar size, a pixel of layer k gets the layers below k
+ * convolved with the bokeh at their own radius and the layers from k on convolved with the bokeh
+ * at the radius of k. Every layer is convolved at the radius between its bounds, the quality
+ * steps are not used.
+ */
+MemoryBuffer *VariableSizeBokehBlurOperation::convolveLayers(MemoryBuffer *colorBuffer,
+                                                             MemoryBuffer *bokehBuffer,
+                                                             MemoryBuffer *sizeBuffer,
+                                                             int maxBlurScalar,
+                                                             rcti *rect)
+{
+  const float max_dim = max(m_width, m_height);
+  const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
+  const float base = max_ff(this->m_threshold, 1.0f);
+  const float log_ratio = logf(COM_BOKEH_LAYER_RATIO);
+  const int numLayers = (int)(logf(max_ff(maxBlurScalar / base, 1.0f)) / log_ratio) + 1;
+  const int width = BLI_rcti_size_x(rect);
+  const int height = BLI_rcti_size_y(rect);
+
+  rcti inputRect;
+  BLI_rcti_init(&inputRect,
+                max(rect->xmin - maxBlurScalar, 0),
+                min(rect->xmax + maxBlurScalar, (int)m_width),
+                max(rect->ymin - maxBlurScalar, 0),
+                min(rect->ymax + maxBlurScalar, (int)m_height));
+  const int inputWidth = BLI_rcti_size_x(&inputRect);
+  const int inputHeight = BLI_rcti_size_y(&inputRect);
+
+  /* layer of every input pixel, -1 when it is not blurred */
+  int *layers = (int *)MEM_mallocN(sizeof(int) * inputWidth * inputHeight, __func__);
+  bool *inputLayers = (bool *)MEM_callocN(sizeof(bool) * numLayers, __func__);
+  bool *outputLayers = (bool *)MEM_callocN(sizeof(bool) * numLayers, __func__);
+  int maxOutputLayer = -1;
+  for (int y = inputRect.ymin; y < inputRect.ymax; y++) {
+    for (int x = inputRect.xmin; x < inputRect.xmax; x++) {
+      const float size = min_ff(sizeBuffer->getBuffer()[y * sizeBuffer->getWidth() + x] * scalar,
+                                (float)maxBlurScalar);
+      int layer = -1;
+      if (size > this->m_threshold) {
+        layer = (int)(logf(max_ff(size / base, 1.0f)) / log_ratio);
+        CLAMP(layer, 0, numLayers - 1);
+        inputLayers[layer] = true;
+        if (BLI_rcti_isect_pt(rect, x, y)) {
+          outputLayers[layer] = true;
+          maxOutputLayer = max(maxOutputLayer, layer);
+        }
+      }
+      layers[(y - inputRect.ymin) * inputWidth + (x - inputRect.xmin)] = layer;
+    }
+  }
+
+  /* color and weights gathered by every output pixel, starting with the center pixel */
+  float *accum = (float *)MEM_mallocN(sizeof(float) * width * height * 8, __func__);
+  float *layerBuffer = (float *)MEM_mallocN(sizeof(float) * inputWidth * inputHeight * 5,
+                                            __func__);
+  float *convolved = (float *)MEM_mallocN(sizeof(float) * width * height * 8, __func__);
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    for (int x = rect->xmin; x < rect->xmax; x++) {
+      float *pixel = &accum[((y - rect->ymin) * width + (x - rect->xmin)) * 8];
+      colorBuffer->read(pixel, x, y);
+      copy_v4_fl(&pixel[4], 1.0f);
+    }
+  }
+
+  for (int k = 0; k <= maxOutputLayer; k++) {
+    const bool gatherLayer = inputLayers[k] && k < maxOutputLayer;
+    if (!gatherLayer && !outputLayers[k]) {
+      continue;
+    }
+
+    const float radius = min_ff(base * powf(COM_BOKEH_LAYER_RATIO, k + 0.5f), maxBlurScalar);
+    const int halfSize = max_ii((int)ceilf(radius) - 1, 0);
+    const int kernelSize = 2 * halfSize + 1;
+    float *kernel = (float *)MEM_mallocN(
+        sizeof(float) * kernelSize * kernelSize * COM_NUM_CHANNELS_COLOR, __func__);
+    bool gray = true;
+    for (int dy = -halfSize; dy <= halfSize; dy++) {
+      for (int dx = -halfSize; dx <= halfSize; dx++) {
+        float uv[2] = {
+            (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                (dx / radius) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1),
+            (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                (dy / radius) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1),
+        };
+        float *bokeh = &kernel[((halfSize - dy) * kernelSize + halfSize - dx) * 4];
+        bokehBuffer->read(bokeh, uv[0], uv[1]);
+        gray &= (bokeh[0] == bokeh[1] && bokeh[0] == bokeh[2] && bokeh[0] == bokeh[3]);
+      }
+    }
+    const float *center = &kernel[(halfSize * kernelSize + halfSize) * 4];
+
+    /* identical channels share a single convolution of the weights */
+    const int numWeights = gray ? 1 : COM_NUM_CHANNELS_COLOR;
+    FHTConvolution *convolutions[COM_NUM_CHANNELS_COLOR];
+    for (int ch = 0; ch < numWeights; ch++) {
+      convolutions[ch] = new FHTConvolution(&kernel[ch], kernelSize, kernelSize, 4);
+    }
+    const int stride = COM_NUM_CHANNELS_COLOR + numWeights;
+
+    if (gatherLayer) {
+      convolve_layer(colorBuffer,
+                     layers,
+                     &inputRect,
+                     k,
+                     false,
+                     convolutions,
+                     numWeights,
+                     layerBuffer,
+                     convolved,
+                     rect);
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          const int layer = layers[(y + rect->ymin - inputRect.ymin) * inputWidth +
+                                   (x + rect->xmin - inputRect.xmin)];
+          if (layer > k) {
+            float *pixel = &accum[(y * width + x) * 8];
+            const float *value = &convolved[(y * width + x) * stride];
+            for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+              pixel[ch] += value[ch];
+              pixel[4 + ch] += value[4 + ((numWeights == 1) ? 0 : ch)];
+            }
+          }
+        }
+      }
+    }
+
+    if (outputLayers[k]) {
+      convolve_layer(colorBuffer,
+                     layers,
+                     &inputRect,
+                     k,
+                     true,
+                     convolutions,
+                     numWeights,
+                     layerBuffer,
+                     convolved,
+                     rect);
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          const int layer = layers[(y + rect->ymin - inputRect.ymin) * inputWidth +
+                                   (x + rect->xmin - inputRect.xmin)];
+          if (layer == k) {
+            /* the center pixel is already in the accumulation */
+            float *pixel = &accum[(y * width + x) * 8];
+            const float *value = &convolved[(y * width + x) * stride];
+            float color[4];
+            colorBuffer->read(color, x + rect->xmin, y + rect->ymin);
+            for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+              pixel[ch] += value[ch] - center[ch] * color[ch];
+              pixel[4 + ch] += value[4 + ((numWeights == 1) ? 0 : ch)] - center[ch];
+            }
+          }
+        }
+      }
+    }
+
+    for (int ch = 0; ch < numWeights; ch++) {
+      delete convolutions[ch];
+    }
+    MEM_freeN(kernel);
+  }
+
+  MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, rect);
+  float *buffer = result->getBuffer();
+  for (int i = 0; i < width * height; i++) {
+    for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+      buffer[i * 4 + ch] = accum[i * 8 + ch] / accum[i * 8 + 4 + ch];
+    }
+  }
+
+  MEM_freeN(convolved);
+  MEM_freeN(layerBuffer);
+  MEM_freeN(accum);
+  MEM_freeN(outputLayers);
+  MEM_freeN(inputLayers);
+  MEM_freeN(layers);
+  return result;
+}
+
 void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
   VariableSizeBokehBlurTileData *tileData = (VariableSizeBokehBlurTileData *)data;
@@ -137,7 +385,15 @@ void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y,
     const int addYStepValue = addXStepValue;
     const int addXStepColor = addXStepValue * COM_NUM_CHANNELS_COLOR;
 
-    if (size_center > this->m_threshold) {
+    if (tileData->result) {
+      /* the tile is already convolved, its buffer starts at the corner of the tile */
+      const rcti *resultRect = tileData->result->getRect();
+      const int offset = ((y - resultRect->ymin) * BLI_rcti_size_x(resultRect) +
+                          (x - resultRect->xmin)) *
+                         COM_NUM_CHANNELS_COLOR;
+      copy_v4_v4(color_accum, &tileData->result->getBuffer()[offset]);
+    }
+    else if (size_center > this->m_threshold) {
       for (int ny = miny; ny < maxy; ny += addYStepValue) {
         float dy = ny - y;
         int offsetValueNy = ny * inputSizeBuffer->getWidth();
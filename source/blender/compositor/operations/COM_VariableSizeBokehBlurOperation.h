@@ -35,6 +35,15 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
   SocketReader *m_inputSearchProgram;
 #endif
 
+  /**
+   * \brief approximate the blur of a tile by convolving layers of similar size
+   */
+  MemoryBuffer *convolveLayers(MemoryBuffer *colorBuffer,
+                               MemoryBuffer *bokehBuffer,
+                               MemoryBuffer *sizeBuffer,
+                               int maxBlurScalar,
+                               rcti *rect);
+
  public:
   VariableSizeBokehBlurOperation();
 
@@ -49,6 +49,7 @@ VectorBlurOperation::VectorBlurOperation() : NodeOperation()
   this->addInputSocket(COM_DT_VALUE);  // ZBUF
   this->addInputSocket(COM_DT_COLOR);  // SPEED
   this->addOutputSocket(COM_DT_COLOR);
+  this->getInputSocket(2)->setFullPrecision(true);
   this->m_settings = NULL;
   this->m_cachedInstance = NULL;
   this->m_inputImageProgram = NULL;
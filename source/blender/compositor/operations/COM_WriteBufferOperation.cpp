@@ -27,6 +27,7 @@ WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
   this->m_memoryProxy = new MemoryProxy(datatype);
   this->m_memoryProxy->setWriteBufferOperation(this);
   this->m_memoryProxy->setExecutor(NULL);
+  this->m_bufferedExecution = false;
 }
 WriteBufferOperation::~WriteBufferOperation()
 {
@@ -59,9 +60,18 @@ void WriteBufferOperation::deinitExecution()
 void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
   MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
-  float *buffer = memoryBuffer->getBuffer();
+  /* Half float buffers are written per chunk through a temporary float buffer. */
+  MemoryBuffer *outputBuffer = memoryBuffer->isHalfFloat() ?
+                                   MemoryBuffer::createScratch(
+                                       this->m_memoryProxy->getDataType(), rect) :
+                                   memoryBuffer;
+  /* The input may write more channels than the buffer holds, go through a temporary pixel. */
   const int num_channels = memoryBuffer->get_num_channels();
-  if (this->m_input->isComplex()) {
+  float color[4];
+  if (this->isAreaEvaluated()) {
+    this->m_input->renderArea(outputBuffer, rect);
+  }
+  else if (this->m_input->isComplex()) {
     void *data = this->m_input->initializeTileData(rect);
     int x1 = rect->xmin;
     int y1 = rect->ymin;
@@ -71,10 +81,9 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     int y;
     bool breaked = false;
     for (y = y1; y < y2 && (!breaked); y++) {
-      int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
       for (x = x1; x < x2; x++) {
-        this->m_input->read(&(buffer[offset4]), x, y, data);
-        offset4 += num_channels;
+        this->m_input->read(color, x, y, data);
+        memcpy(outputBuffer->getElem(x, y), color, sizeof(float) * num_channels);
       }
       if (isBraked()) {
         breaked = true;
@@ -95,16 +104,19 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     int y;
     bool breaked = false;
     for (y = y1; y < y2 && (!breaked); y++) {
-      int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
       for (x = x1; x < x2; x++) {
-        this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-        offset4 += num_channels;
+        this->m_input->readSampled(color, x, y, COM_PS_NEAREST);
+        memcpy(outputBuffer->getElem(x, y), color, sizeof(float) * num_channels);
       }
       if (isBraked()) {
         breaked = true;
       }
     }
   }
+  if (outputBuffer != memoryBuffer) {
+    memoryBuffer->copyContentFrom(outputBuffer);
+    MemoryBuffer::freeScratch(outputBuffer);
+  }
   memoryBuffer->setCreatedState();
 }
 
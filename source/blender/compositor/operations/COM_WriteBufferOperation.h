@@ -30,6 +30,7 @@ class WriteBufferOperation : public NodeOperation {
   MemoryProxy *m_memoryProxy;
   bool m_single_value; /* single value stored in buffer */
   NodeOperation *m_input;
+  bool m_bufferedExecution; /* evaluate pixel-wise inputs per area */
 
  public:
   WriteBufferOperation(DataType datatype);
@@ -48,6 +49,16 @@ class WriteBufferOperation : public NodeOperation {
     return m_single_value;
   }
 
+  void setBufferedExecution(bool bufferedExecution)
+  {
+    this->m_bufferedExecution = bufferedExecution;
+  }
+
+  bool isAreaEvaluated()
+  {
+    return this->m_bufferedExecution && this->m_input && this->m_input->isPixelWise();
+  }
+
   void executeRegion(rcti *rect, unsigned int tileNumber);
   void initExecution();
   void deinitExecution();
@@ -31,6 +31,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -866,6 +867,17 @@ void heat_bone_weighting(Object *ob,
 
 #define MESHDEFORM_MIN_INFLUENCE 0.0005f
 
+/** smallest static bind weight to store, as in #BKE_modifier_mdef_compact_influences */
+#define MESHDEFORM_MIN_BIND_WEIGHT 0.00001f
+
+/** cage vertices solved for at once per thread, with a maximum for memory usage */
+#define MESHDEFORM_SOLVE_BATCH 32
+#define MESHDEFORM_SOLVE_BATCH_MAX 128
+/** minimum number of right hand sides in a single solve, solving many at once is faster */
+#define MESHDEFORM_SOLVE_CHUNK_MIN 16
+/** number of vertices per allocation of static bind weights */
+#define MESHDEFORM_WEIGHT_BLOCK 4096
+
 static const int MESHDEFORM_OFFSET[7][3] = {
     {0, 0, 0},
     {1, 0, 0},
@@ -895,6 +907,13 @@ typedef struct MDefBindInfluence {
   int vertex;
 } MDefBindInfluence;
 
+/* Static bind weights above the threshold for a block of vertices, added batch after batch of
+ * cage vertices. Separate blocks keep the memory use low when sorting the weights per vertex. */
+typedef struct MDefWeightBlock {
+  MDefInfluence *influences;
+  int totinfluence, maxinfluence;
+} MDefWeightBlock;
+
 typedef struct MeshDeformBind {
   /* grid dimensions */
   float min[3], max[3];
@@ -912,12 +931,14 @@ typedef struct MeshDeformBind {
   MDefBoundIsect *(*boundisect)[6];
   int *semibound;
   int *tag;
-  float *phi, *totalphi;
 
   /* mesh stuff */
   int *inside;
-  float *weights;
   MDefBindInfluence **dyngrid;
+  MDefWeightBlock *weight_blocks;
+  /* number of static weights per vertex, for each batch of cage vertices */
+  unsigned char *batch_totinfluence;
+  int totbatch;
   float cagemat[4][4];
 
   /* direct solver */
@@ -1221,82 +1242,6 @@ static void meshdeform_bind_floodfill(MeshDeformBind *mdb)
   MEM_freeN(stack);
 }
 
-static float meshdeform_boundary_phi(const MeshDeformBind *mdb,
-                                     const MDefBoundIsect *isect,
-                                     int cagevert)
-{
-  const MLoop *mloop = mdb->cagemesh_cache.mloop;
-  const MPoly *mp = &mdb->cagemesh_cache.mpoly[isect->poly_index];
-  int i;
-
-  for (i = 0; i < mp->totloop; i++) {
-    if (mloop[mp->loopstart + i].v == cagevert) {
-      return isect->poly_weights[i];
-    }
-  }
-
-  return 0.0f;
-}
-
-static float meshdeform_interp_w(MeshDeformBind *mdb,
-                                 float *gridvec,
-                                 float *UNUSED(vec),
-                                 int UNUSED(cagevert))
-{
-  float dvec[3], ivec[3], wx, wy, wz, result = 0.0f;
-  float weight, totweight = 0.0f;
-  int i, a, x, y, z;
-
-  for (i = 0; i < 3; i++) {
-    ivec[i] = (int)gridvec[i];
-    dvec[i] = gridvec[i] - ivec[i];
-  }
-
-  for (i = 0; i < 8; i++) {
-    if (i & 1) {
-      x = ivec[0] + 1;
-      wx = dvec[0];
-    }
-    else {
-      x = ivec[0];
-      wx = 1.0f - dvec[0];
-    }
-
-    if (i & 2) {
-      y = ivec[1] + 1;
-      wy = dvec[1];
-    }
-    else {
-      y = ivec[1];
-      wy = 1.0f - dvec[1];
-    }
-
-    if (i & 4) {
-      z = ivec[2] + 1;
-      wz = dvec[2];
-    }
-    else {
-      z = ivec[2];
-      wz = 1.0f - dvec[2];
-    }
-
-    CLAMP(x, 0, mdb->size - 1);
-    CLAMP(y, 0, mdb->size - 1);
-    CLAMP(z, 0, mdb->size - 1);
-
-    a = meshdeform_index(mdb, x, y, z, 0);
-    weight = wx * wy * wz;
-    result += weight * mdb->phi[a];
-    totweight += weight;
-  }
-
-  if (totweight > 0.0f) {
-    result /= totweight;
-  }
-
-  return result;
-}
-
 static void meshdeform_check_semibound(MeshDeformBind *mdb, int x, int y, int z)
 {
   int i, a;
@@ -1371,93 +1316,491 @@ static void meshdeform_matrix_add_cell(
   }
 }
 
-static void meshdeform_matrix_add_rhs(
-    MeshDeformBind *mdb, LinearSolver *context, int x, int y, int z, int cagevert)
+/* Boundary condition from a cage intersection, for the cage vertices of its polygon. */
+typedef struct MDefBoundTerm {
+  const MDefBoundIsect *isect;
+  /* solver variable for right hand sides, grid cell for semi-boundary cells */
+  int index;
+  float weight;
+} MDefBoundTerm;
+
+/* Exterior cell taking the average of its semi-boundary neighbors. */
+typedef struct MDefExteriorCell {
+  int index;
+  int totneighbor;
+  int neighbors[6];
+} MDefExteriorCell;
+
+/* Trilinear interpolation of the grid at a vertex inside the cage. */
+typedef struct MDefInterpVert {
+  int cells[8];
+  float weights[8];
+  float totweight;
+} MDefInterpVert;
+
+typedef struct MeshDeformSolveData {
+  MeshDeformBind *mdb;
+  LinearSolver *context;
+  int totvar;
+  /* grid cell of each solver variable */
+  int *varcell;
+
+  /* everything in the grid which depends on the cage vertex, gathered once */
+  MDefBoundTerm *rhs_terms, *semibound_terms;
+  int totrhs_term, totsemibound_term;
+  MDefExteriorCell *exterior;
+  int totexterior;
+  MDefInterpVert *interp;
+
+  /* current batch of cage vertices */
+  int batch_start, batch_len, batch_size;
+  int chunk_len;
+  bool *chunk_success;
+  /* per cage vertex of the batch: right hand side, solution and grid values */
+  double *rhs, *sol;
+  float *phi;
+  /* per vertex: static weights for the cage vertices of the batch */
+  float *vert_weights;
+  unsigned char *vert_totinfluence;
+  int totblock;
+} MeshDeformSolveData;
+
+static void meshdeform_solve_data_add_cell(MeshDeformSolveData *data, int x, int y, int z)
 {
+  MeshDeformBind *mdb = data->mdb;
   MDefBoundIsect *isect;
-  float rhs, weight, totweight;
+  MDefBoundTerm *term;
+  float totweight;
   int i, a, acenter;
 
   acenter = meshdeform_index(mdb, x, y, z, 0);
-  if (mdb->tag[acenter] == MESHDEFORM_TAG_EXTERIOR) {
-    return;
+
+  if (mdb->tag[acenter] != MESHDEFORM_TAG_EXTERIOR) {
+    /* right hand side */
+    totweight = meshdeform_boundary_total_weight(mdb, x, y, z);
+    for (i = 1; i <= 6; i++) {
+      isect = mdb->boundisect[acenter][i - 1];
+
+      if (isect && meshdeform_index(mdb, x, y, z, i) != -1) {
+        term = &data->rhs_terms[data->totrhs_term++];
+        term->isect = isect;
+        term->index = mdb->varidx[acenter];
+        term->weight = (1.0f / isect->len) / totweight;
+      }
+    }
   }
+  else if (mdb->semibound[acenter]) {
+    /* semi-boundary cells get their value from the cage directly */
+    totweight = meshdeform_boundary_total_weight(mdb, x, y, z);
+    for (i = 1; i <= 6; i++) {
+      isect = mdb->boundisect[acenter][i - 1];
 
-  totweight = meshdeform_boundary_total_weight(mdb, x, y, z);
-  for (i = 1; i <= 6; i++) {
-    a = meshdeform_index(mdb, x, y, z, i);
-    if (a == -1) {
-      continue;
+      if (isect) {
+        term = &data->semibound_terms[data->totsemibound_term++];
+        term->isect = isect;
+        term->index = acenter;
+        term->weight = (1.0f / isect->len) / totweight;
+      }
     }
+  }
+  else {
+    MDefExteriorCell cell = {acenter, 0};
 
-    isect = mdb->boundisect[acenter][i - 1];
+    for (i = 1; i <= 6; i++) {
+      a = meshdeform_index(mdb, x, y, z, i);
 
-    if (isect) {
-      weight = (1.0f / isect->len) / totweight;
-      rhs = weight * meshdeform_boundary_phi(mdb, isect, cagevert);
-      EIG_linear_solver_right_hand_side_add(context, 0, mdb->varidx[acenter], rhs);
+      if (a != -1 && mdb->semibound[a]) {
+        cell.neighbors[cell.totneighbor++] = a;
+      }
+    }
+
+    if (cell.totneighbor) {
+      data->exterior[data->totexterior++] = cell;
     }
   }
 }
 
-static void meshdeform_matrix_add_semibound_phi(
-    MeshDeformBind *mdb, int x, int y, int z, int cagevert)
+static void meshdeform_interp_init(MeshDeformBind *mdb, const float co[3], MDefInterpVert *interp)
 {
-  MDefBoundIsect *isect;
-  float rhs, weight, totweight;
-  int i, a;
+  float gridvec[3], dvec[3], ivec[3], wx, wy, wz;
+  int i, x, y, z;
 
-  a = meshdeform_index(mdb, x, y, z, 0);
-  if (!mdb->semibound[a]) {
-    return;
+  for (i = 0; i < 3; i++) {
+    gridvec[i] = (co[i] - mdb->min[i] - mdb->halfwidth[i]) / mdb->width[i];
+    ivec[i] = (int)gridvec[i];
+    dvec[i] = gridvec[i] - ivec[i];
   }
 
-  mdb->phi[a] = 0.0f;
+  interp->totweight = 0.0f;
 
-  totweight = meshdeform_boundary_total_weight(mdb, x, y, z);
-  for (i = 1; i <= 6; i++) {
-    isect = mdb->boundisect[a][i - 1];
+  for (i = 0; i < 8; i++) {
+    if (i & 1) {
+      x = ivec[0] + 1;
+      wx = dvec[0];
+    }
+    else {
+      x = ivec[0];
+      wx = 1.0f - dvec[0];
+    }
 
-    if (isect) {
-      weight = (1.0f / isect->len) / totweight;
-      rhs = weight * meshdeform_boundary_phi(mdb, isect, cagevert);
-      mdb->phi[a] += rhs;
+    if (i & 2) {
+      y = ivec[1] + 1;
+      wy = dvec[1];
+    }
+    else {
+      y = ivec[1];
+      wy = 1.0f - dvec[1];
+    }
+
+    if (i & 4) {
+      z = ivec[2] + 1;
+      wz = dvec[2];
+    }
+    else {
+      z = ivec[2];
+      wz = 1.0f - dvec[2];
     }
+
+    CLAMP(x, 0, mdb->size - 1);
+    CLAMP(y, 0, mdb->size - 1);
+    CLAMP(z, 0, mdb->size - 1);
+
+    interp->cells[i] = meshdeform_index(mdb, x, y, z, 0);
+    interp->weights[i] = wx * wy * wz;
+    interp->totweight += interp->weights[i];
   }
 }
 
-static void meshdeform_matrix_add_exterior_phi(
-    MeshDeformBind *mdb, int x, int y, int z, int UNUSED(cagevert))
+static float meshdeform_interp_w(const MDefInterpVert *interp, const float *phi)
 {
-  float phi, totweight;
-  int i, a, acenter;
+  float result = 0.0f;
+  int i;
 
-  acenter = meshdeform_index(mdb, x, y, z, 0);
-  if (mdb->tag[acenter] != MESHDEFORM_TAG_EXTERIOR || mdb->semibound[acenter]) {
-    return;
+  for (i = 0; i < 8; i++) {
+    result += interp->weights[i] * phi[interp->cells[i]];
   }
 
-  phi = 0.0f;
-  totweight = 0.0f;
-  for (i = 1; i <= 6; i++) {
-    a = meshdeform_index(mdb, x, y, z, i);
+  if (interp->totweight > 0.0f) {
+    result /= interp->totweight;
+  }
+
+  return result;
+}
 
-    if (a != -1 && mdb->semibound[a]) {
-      phi += mdb->phi[a];
-      totweight += 1.0f;
+static void meshdeform_solve_data_init(MeshDeformSolveData *data,
+                                       MeshDeformBind *mdb,
+                                       LinearSolver *context,
+                                       int totvar)
+{
+  const int num_threads = BLI_task_scheduler_num_threads();
+  size_t batch_size;
+  int a, i, x, y, z, totisect = 0, totsemibound = 0;
+
+  memset(data, 0, sizeof(*data));
+  data->mdb = mdb;
+  data->context = context;
+  data->totvar = totvar;
+
+  data->varcell = MEM_malloc_arrayN(totvar, sizeof(int), "MDefVarCell");
+  for (a = 0; a < mdb->size3; a++) {
+    if (mdb->varidx[a] != -1) {
+      data->varcell[mdb->varidx[a]] = a;
+    }
+    for (i = 0; i < 6; i++) {
+      if (mdb->boundisect[a][i]) {
+        totisect++;
+      }
+    }
+    if (mdb->semibound[a]) {
+      totsemibound++;
     }
   }
 
-  if (totweight != 0.0f) {
-    mdb->phi[acenter] = phi / totweight;
+  data->rhs_terms = MEM_malloc_arrayN(totisect, sizeof(MDefBoundTerm), "MDefRhsTerms");
+  data->semibound_terms = MEM_malloc_arrayN(totisect, sizeof(MDefBoundTerm), "MDefSemiTerms");
+  data->exterior = MEM_malloc_arrayN(
+      (size_t)totsemibound * 6, sizeof(MDefExteriorCell), "MDefExteriorCells");
+
+  for (z = 0; z < mdb->size; z++) {
+    for (y = 0; y < mdb->size; y++) {
+      for (x = 0; x < mdb->size; x++) {
+        meshdeform_solve_data_add_cell(data, x, y, z);
+      }
+    }
+  }
+
+  /* many right hand sides per solve, but enough solves to keep threads busy */
+  data->batch_size = min_ii(MESHDEFORM_SOLVE_BATCH * num_threads, MESHDEFORM_SOLVE_BATCH_MAX);
+  data->chunk_len = max_ii(data->batch_size / num_threads, MESHDEFORM_SOLVE_CHUNK_MIN);
+  batch_size = (size_t)data->batch_size;
+
+  data->chunk_success = MEM_malloc_arrayN(batch_size, sizeof(bool), "MDefChunkSuccess");
+  data->rhs = MEM_malloc_arrayN(batch_size * totvar, sizeof(double), "MDefSolveRhs");
+  data->sol = MEM_malloc_arrayN(batch_size * totvar, sizeof(double), "MDefSolveSol");
+  /* cells which are never written stay zero */
+  data->phi = MEM_calloc_arrayN(batch_size * mdb->size3, sizeof(float), "MDefSolvePhi");
+
+  if (!mdb->dyngrid) {
+    data->interp = MEM_malloc_arrayN(mdb->totvert, sizeof(MDefInterpVert), "MDefInterpVert");
+    for (a = 0; a < mdb->totvert; a++) {
+      if (mdb->inside[a]) {
+        meshdeform_interp_init(mdb, mdb->vertexcos[a], &data->interp[a]);
+      }
+    }
+
+    data->vert_weights = MEM_malloc_arrayN(
+        batch_size * mdb->totvert, sizeof(float), "MDefVertWeights");
+
+    mdb->totbatch = (mdb->totcagevert + data->batch_size - 1) / data->batch_size;
+    mdb->batch_totinfluence = MEM_calloc_arrayN(
+        (size_t)mdb->totbatch * mdb->totvert, sizeof(unsigned char), "MDefBatchTotInfluence");
+
+    data->totblock = (mdb->totvert + MESHDEFORM_WEIGHT_BLOCK - 1) / MESHDEFORM_WEIGHT_BLOCK;
+    mdb->weight_blocks = MEM_calloc_arrayN(
+        data->totblock, sizeof(MDefWeightBlock), "MDefWeightBlocks");
+  }
+}
+
+static void meshdeform_solve_data_free(MeshDeformSolveData *data)
+{
+  MEM_freeN(data->varcell);
+  MEM_freeN(data->rhs_terms);
+  MEM_freeN(data->semibound_terms);
+  MEM_freeN(data->exterior);
+  MEM_freeN(data->chunk_success);
+  MEM_freeN(data->rhs);
+  MEM_freeN(data->sol);
+  MEM_freeN(data->phi);
+  MEM_SAFE_FREE(data->interp);
+  MEM_SAFE_FREE(data->vert_weights);
+}
+
+/* Add boundary terms for the cage vertices of the batch, 'stride' values apart. */
+static void meshdeform_solve_batch_terms(const MeshDeformSolveData *data,
+                                         const MDefBoundTerm *terms,
+                                         int totterm,
+                                         size_t stride,
+                                         double *r_rhs,
+                                         float *r_phi)
+{
+  const MLoop *mloop = data->mdb->cagemesh_cache.mloop;
+  const MPoly *mpoly = data->mdb->cagemesh_cache.mpoly;
+  const unsigned int batch_start = (unsigned int)data->batch_start;
+  const unsigned int batch_len = (unsigned int)data->batch_len;
+  unsigned int k;
+  int i, j;
+
+  for (i = 0; i < totterm; i++) {
+    const MDefBoundTerm *term = &terms[i];
+    const MPoly *mp = &mpoly[term->isect->poly_index];
+
+    for (j = 0; j < mp->totloop; j++) {
+      k = mloop[mp->loopstart + j].v - batch_start;
+
+      if (k < batch_len) {
+        const float value = term->weight * term->isect->poly_weights[j];
+
+        if (r_rhs) {
+          r_rhs[k * stride + term->index] += value;
+        }
+        else {
+          r_phi[k * stride + term->index] += value;
+        }
+      }
+    }
+  }
+}
+
+static void meshdeform_solve_batch_cb(void *__restrict userdata,
+                                      const int chunk,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  const int start = chunk * data->chunk_len;
+  const int len = min_ii(data->chunk_len, data->batch_len - start);
+  const size_t offset = (size_t)start * data->totvar;
+
+  data->chunk_success[chunk] = EIG_linear_solver_solve_dense(
+      data->context, len, data->rhs + offset, data->sol + offset);
+}
+
+static void meshdeform_solve_batch_phi_cb(void *__restrict userdata,
+                                          const int k,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  float *phi = data->phi + (size_t)k * data->mdb->size3;
+  const double *sol = data->sol + (size_t)k * data->totvar;
+  float totphi;
+  int i, j;
+
+  /* exterior cells next to semi-boundary cells */
+  for (i = 0; i < data->totexterior; i++) {
+    const MDefExteriorCell *cell = &data->exterior[i];
+
+    totphi = 0.0f;
+    for (j = 0; j < cell->totneighbor; j++) {
+      totphi += phi[cell->neighbors[j]];
+    }
+    phi[cell->index] = totphi / (float)cell->totneighbor;
+  }
+
+  /* interior and boundary cells */
+  for (i = 0; i < data->totvar; i++) {
+    phi[data->varcell[i]] = (float)sol[i];
+  }
+}
+
+static void meshdeform_solve_batch_weights_cb(void *__restrict userdata,
+                                              const int b,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  const MeshDeformBind *mdb = data->mdb;
+  float *weights = data->vert_weights + (size_t)b * data->batch_size;
+  unsigned char totinfluence = 0;
+  int k;
+
+  if (mdb->inside[b]) {
+    for (k = 0; k < data->batch_len; k++) {
+      weights[k] = meshdeform_interp_w(&data->interp[b], data->phi + (size_t)k * mdb->size3);
+
+      if (weights[k] > MESHDEFORM_MIN_BIND_WEIGHT) {
+        totinfluence++;
+      }
+    }
+  }
+
+  data->vert_totinfluence[b] = totinfluence;
+}
+
+static void meshdeform_solve_batch_store_weights_cb(void *__restrict userdata,
+                                                    const int block,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+  MDefWeightBlock *weight_block = &mdb->weight_blocks[block];
+  const int start = block * MESHDEFORM_WEIGHT_BLOCK;
+  const int end = min_ii(start + MESHDEFORM_WEIGHT_BLOCK, mdb->totvert);
+  MDefInfluence *inf;
+  const float *weights;
+  int b, k, totinfluence = 0;
+
+  for (b = start; b < end; b++) {
+    totinfluence += data->vert_totinfluence[b];
+  }
+
+  if (weight_block->totinfluence + totinfluence > weight_block->maxinfluence) {
+    weight_block->maxinfluence = max_ii(weight_block->totinfluence + totinfluence,
+                                        weight_block->maxinfluence * 2);
+    if (weight_block->influences) {
+      weight_block->influences = MEM_reallocN(
+          weight_block->influences, sizeof(MDefInfluence) * weight_block->maxinfluence);
+    }
+    else {
+      weight_block->influences = MEM_malloc_arrayN(
+          weight_block->maxinfluence, sizeof(MDefInfluence), "MDefBlockInfluence");
+    }
+  }
+
+  inf = weight_block->influences + weight_block->totinfluence;
+  weight_block->totinfluence += totinfluence;
+
+  for (b = start; b < end; b++) {
+    if (data->vert_totinfluence[b] == 0) {
+      continue;
+    }
+
+    weights = data->vert_weights + (size_t)b * data->batch_size;
+    for (k = 0; k < data->batch_len; k++) {
+      if (weights[k] > MESHDEFORM_MIN_BIND_WEIGHT) {
+        inf->weight = weights[k];
+        inf->vertex = data->batch_start + k;
+        inf++;
+      }
+    }
+  }
+}
+
+static bool meshdeform_solve_batch(MeshDeformSolveData *data, int batch_start, int batch_len)
+{
+  MeshDeformBind *mdb = data->mdb;
+  TaskParallelSettings settings;
+  MDefBindInfluence *inf;
+  const float *phi;
+  int i, k, b, totchunk;
+
+  data->batch_start = batch_start;
+  data->batch_len = batch_len;
+
+  /* fill in right hand sides */
+  memset(data->rhs, 0, sizeof(*data->rhs) * data->totvar * batch_len);
+  meshdeform_solve_batch_terms(
+      data, data->rhs_terms, data->totrhs_term, (size_t)data->totvar, data->rhs, NULL);
+
+  /* semi-boundary cells don't need the solution */
+  for (i = 0; i < data->totsemibound_term; i++) {
+    for (k = 0; k < batch_len; k++) {
+      data->phi[(size_t)k * mdb->size3 + data->semibound_terms[i].index] = 0.0f;
+    }
+  }
+  meshdeform_solve_batch_terms(
+      data, data->semibound_terms, data->totsemibound_term, (size_t)mdb->size3, NULL, data->phi);
+
+  /* solve with the factorized matrix, in parallel */
+  totchunk = (batch_len + data->chunk_len - 1) / data->chunk_len;
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, totchunk, data, meshdeform_solve_batch_cb, &settings);
+
+  for (i = 0; i < totchunk; i++) {
+    if (!data->chunk_success[i]) {
+      return false;
+    }
+  }
+
+  BLI_task_parallel_range(0, batch_len, data, meshdeform_solve_batch_phi_cb, &settings);
+
+  if (mdb->dyngrid) {
+    /* dynamic bind */
+    for (k = 0; k < batch_len; k++) {
+      phi = data->phi + (size_t)k * mdb->size3;
+
+      for (b = 0; b < mdb->size3; b++) {
+        if (phi[b] >= MESHDEFORM_MIN_INFLUENCE) {
+          inf = BLI_memarena_alloc(mdb->memarena, sizeof(*inf));
+          inf->vertex = batch_start + k;
+          inf->weight = phi[b];
+          inf->next = mdb->dyngrid[b];
+          mdb->dyngrid[b] = inf;
+        }
+      }
+    }
+  }
+  else {
+    /* static bind : compute weights for each vertex */
+    data->vert_totinfluence = mdb->batch_totinfluence +
+                              (size_t)(batch_start / data->batch_size) * mdb->totvert;
+
+    BLI_parallel_range_settings_defaults(&settings);
+    BLI_task_parallel_range(0, mdb->totvert, data, meshdeform_solve_batch_weights_cb, &settings);
+
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(
+        0, data->totblock, data, meshdeform_solve_batch_store_weights_cb, &settings);
   }
+
+  return true;
 }
 
 static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
 {
+  MeshDeformSolveData data;
   LinearSolver *context;
-  float vec[3], gridvec[3];
-  int a, b, x, y, z, totvar;
+  int a, x, y, z, totvar, batch_len;
+  bool success;
   char message[256];
 
   /* setup variable indices */
@@ -1485,99 +1828,118 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
     }
   }
 
-  /* solve for each cage vert */
-  for (a = 0; a < mdb->totcagevert; a++) {
-    /* fill in right hand side and solve */
-    for (z = 0; z < mdb->size; z++) {
-      for (y = 0; y < mdb->size; y++) {
-        for (x = 0; x < mdb->size; x++) {
-          meshdeform_matrix_add_rhs(mdb, context, x, y, z, a);
-        }
+  /* the matrix is the same for all cage verts, factorize it once and solve for batches of
+   * cage verts */
+  success = EIG_linear_solver_factorize(context);
+
+  if (success) {
+    meshdeform_solve_data_init(&data, mdb, context, totvar);
+
+    for (a = 0; a < mdb->totcagevert; a += batch_len) {
+      batch_len = min_ii(data.batch_size, mdb->totcagevert - a);
+
+      if (!meshdeform_solve_batch(&data, a, batch_len)) {
+        success = false;
+        break;
       }
+
+      BLI_snprintf(message,
+                   sizeof(message),
+                   "Mesh deform solve %d / %d       |||",
+                   a + batch_len,
+                   mdb->totcagevert);
+      progress_bar((float)(a + batch_len) / (float)(mdb->totcagevert), message);
     }
 
-    if (EIG_linear_solver_solve(context)) {
-      for (z = 0; z < mdb->size; z++) {
-        for (y = 0; y < mdb->size; y++) {
-          for (x = 0; x < mdb->size; x++) {
-            meshdeform_matrix_add_semibound_phi(mdb, x, y, z, a);
-          }
-        }
-      }
+    meshdeform_solve_data_free(&data);
+  }
 
-      for (z = 0; z < mdb->size; z++) {
-        for (y = 0; y < mdb->size; y++) {
-          for (x = 0; x < mdb->size; x++) {
-            meshdeform_matrix_add_exterior_phi(mdb, x, y, z, a);
-          }
-        }
-      }
+  if (!success) {
+    BKE_modifier_set_error(&mmd->modifier, "Failed to find bind solution (increase precision?)");
+    error("Mesh Deform: failed to find bind solution.");
+  }
 
-      for (b = 0; b < mdb->size3; b++) {
-        if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR) {
-          mdb->phi[b] = EIG_linear_solver_variable_get(context, 0, mdb->varidx[b]);
-        }
-        mdb->totalphi[b] += mdb->phi[b];
-      }
+  /* free */
+  MEM_freeN(mdb->varidx);
 
-      if (mdb->weights) {
-        /* static bind : compute weights for each vertex */
-        for (b = 0; b < mdb->totvert; b++) {
-          if (mdb->inside[b]) {
-            copy_v3_v3(vec, mdb->vertexcos[b]);
-            gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
-            gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
-            gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
+  EIG_linear_solver_delete(context);
+}
 
-            mdb->weights[b * mdb->totcagevert + a] = meshdeform_interp_w(mdb, gridvec, vec, a);
-          }
-        }
-      }
-      else {
-        MDefBindInfluence *inf;
-
-        /* dynamic bind */
-        for (b = 0; b < mdb->size3; b++) {
-          if (mdb->phi[b] >= MESHDEFORM_MIN_INFLUENCE) {
-            inf = BLI_memarena_alloc(mdb->memarena, sizeof(*inf));
-            inf->vertex = a;
-            inf->weight = mdb->phi[b];
-            inf->next = mdb->dyngrid[b];
-            mdb->dyngrid[b] = inf;
-          }
-        }
-      }
-    }
-    else {
-      BKE_modifier_set_error(&mmd->modifier, "Failed to find bind solution (increase precision?)");
-      error("Mesh Deform: failed to find bind solution.");
-      break;
+/* Gather the influences of all batches per vertex, normalized. */
+static void meshdeform_bind_weights_assign(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
+{
+  MDefWeightBlock *weight_block;
+  MDefInfluence *mdinf;
+  const unsigned char *batch_totinfluence;
+  float totweight;
+  int a, b, block, start, end, totinfluence, *offsets;
+  const int totblock = (mdb->totvert + MESHDEFORM_WEIGHT_BLOCK - 1) / MESHDEFORM_WEIGHT_BLOCK;
+
+  mmd->totinfluence = 0;
+  if (mdb->weight_blocks) {
+    for (block = 0; block < totblock; block++) {
+      mmd->totinfluence += mdb->weight_blocks[block].totinfluence;
     }
+  }
 
-    BLI_snprintf(
-        message, sizeof(message), "Mesh deform solve %d / %d       |||", a + 1, mdb->totcagevert);
-    progress_bar((float)(a + 1) / (float)(mdb->totcagevert), message);
+  mmd->bindinfluences = MEM_malloc_arrayN(
+      mmd->totinfluence, sizeof(MDefInfluence), "MDefBindInfluence");
+  mmd->bindoffsets = MEM_calloc_arrayN((mdb->totvert + 1), sizeof(int), "MDefBindOffset");
+
+  if (mdb->weight_blocks == NULL) {
+    return;
   }
 
-#if 0
-  /* sanity check */
-  for (b = 0; b < mdb->size3; b++) {
-    if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR) {
-      if (fabsf(mdb->totalphi[b] - 1.0f) > 1e-4f) {
-        printf("totalphi deficiency [%s|%d] %d: %.10f\n",
-               (mdb->tag[b] == MESHDEFORM_TAG_INTERIOR) ? "interior" : "boundary",
-               mdb->semibound[b],
-               mdb->varidx[b],
-               mdb->totalphi[b]);
+  /* read position of each batch in the current block */
+  offsets = MEM_malloc_arrayN(mdb->totbatch, sizeof(int), "MDefBatchOffsets");
+  totinfluence = 0;
+
+  for (block = 0; block < totblock; block++) {
+    weight_block = &mdb->weight_blocks[block];
+    start = block * MESHDEFORM_WEIGHT_BLOCK;
+    end = min_ii(start + MESHDEFORM_WEIGHT_BLOCK, mdb->totvert);
+
+    /* batches were added one after the other */
+    offsets[0] = 0;
+    for (a = 1; a < mdb->totbatch; a++) {
+      batch_totinfluence = mdb->batch_totinfluence + (size_t)(a - 1) * mdb->totvert;
+      offsets[a] = offsets[a - 1];
+      for (b = start; b < end; b++) {
+        offsets[a] += batch_totinfluence[b];
+      }
+    }
+
+    for (b = start; b < end; b++) {
+      mmd->bindoffsets[b] = totinfluence;
+      mdinf = mmd->bindinfluences + totinfluence;
+
+      /* batches are in cage vertex order */
+      for (a = 0; a < mdb->totbatch; a++) {
+        batch_totinfluence = mdb->batch_totinfluence + (size_t)a * mdb->totvert;
+        memcpy(mmd->bindinfluences + totinfluence,
+               weight_block->influences + offsets[a],
+               sizeof(MDefInfluence) * batch_totinfluence[b]);
+        totinfluence += batch_totinfluence[b];
+        offsets[a] += batch_totinfluence[b];
+      }
+
+      totweight = 0.0f;
+      for (a = 0; a < totinfluence - mmd->bindoffsets[b]; a++) {
+        totweight += mdinf[a].weight;
+      }
+      for (a = 0; a < totinfluence - mmd->bindoffsets[b]; a++) {
+        mdinf[a].weight /= totweight;
       }
     }
+
+    MEM_SAFE_FREE(weight_block->influences);
   }
-#endif
 
-  /* free */
-  MEM_freeN(mdb->varidx);
+  mmd->bindoffsets[mdb->totvert] = totinfluence;
 
-  EIG_linear_solver_delete(context);
+  MEM_freeN(offsets);
+  MEM_freeN(mdb->weight_blocks);
+  MEM_freeN(mdb->batch_totinfluence);
 }
 
 static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
@@ -1599,8 +1961,6 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
   mdb->size = (2 << (mmd->gridsize - 1)) + 2;
   mdb->size3 = mdb->size * mdb->size * mdb->size;
   mdb->tag = MEM_callocN(sizeof(int) * mdb->size3, "MeshDeformBindTag");
-  mdb->phi = MEM_callocN(sizeof(float) * mdb->size3, "MeshDeformBindPhi");
-  mdb->totalphi = MEM_callocN(sizeof(float) * mdb->size3, "MeshDeformBindTotalPhi");
   mdb->boundisect = MEM_callocN(sizeof(*mdb->boundisect) * mdb->size3, "MDefBoundIsect");
   mdb->semibound = MEM_callocN(sizeof(int) * mdb->size3, "MDefSemiBound");
   mdb->bvhtree = BKE_bvhtree_from_mesh_get(&mdb->bvhdata, mdb->cagemesh, BVHTREE_FROM_LOOPTRI, 4);
@@ -1609,9 +1969,6 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
   if (mmd->flag & MOD_MDEF_DYNAMIC_BIND) {
     mdb->dyngrid = MEM_callocN(sizeof(MDefBindInfluence *) * mdb->size3, "MDefDynGrid");
   }
-  else {
-    mdb->weights = MEM_callocN(sizeof(float) * mdb->totvert * mdb->totcagevert, "MDefWeights");
-  }
 
   mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
   BLI_memarena_use_calloc(mdb->memarena);
@@ -1734,13 +2091,11 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
     MEM_freeN(mdb->dyngrid);
   }
   else {
-    mmd->bindweights = mdb->weights;
+    meshdeform_bind_weights_assign(mmd, mdb);
     MEM_freeN(mdb->inside);
   }
 
   MEM_freeN(mdb->tag);
-  MEM_freeN(mdb->phi);
-  MEM_freeN(mdb->totalphi);
   MEM_freeN(mdb->boundisect);
   MEM_freeN(mdb->semibound);
   BLI_memarena_free(mdb->memarena);
@@ -1798,9 +2153,6 @@ void ED_mesh_deform_bind_callback(MeshDeformModifierData *mmd,
   /* free */
   MEM_freeN(mdb.vertexcos);
 
-  /* compact weights */
-  BKE_modifier_mdef_compact_influences((ModifierData *)mmd_orig);
-
   end_progress_bar();
   waitcursor(0);
 }
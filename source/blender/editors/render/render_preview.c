@@ -1077,6 +1077,49 @@ static void set_alpha(char *cp, int sizex, int sizey, char alpha)
   }
 }
 
+/* Read the icon of an image file from its tiled cache, at the smallest mip level that still
+ * covers the icon, instead of loading the full resolution image. */
+static bool icon_preview_image_tiled(Image *ima, ImageUser *iuser, ShaderPreview *sp)
+{
+  ImageTiledTexture *texture = BKE_image_tiled_acquire(ima, iuser);
+  int level, width, height;
+
+  if (texture == NULL) {
+    return false;
+  }
+
+  for (level = BKE_image_tiled_levels(texture) - 1; level > 0; level--) {
+    BKE_image_tiled_size(texture, level, &width, &height);
+    if (width >= sp->sizex || height >= sp->sizey) {
+      break;
+    }
+  }
+  BKE_image_tiled_size(texture, level, &width, &height);
+
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rectfloat);
+  BKE_image_tiled_read_rect(texture, level, 0, 0, width, height, ibuf->rect_float);
+
+  if (BKE_image_tiled_is_float(texture)) {
+    IMB_rect_from_float(ibuf);
+  }
+  else {
+    /* Byte images are stored divided by 255, copy them back as is. */
+    const size_t tot = (size_t)width * height * 4;
+
+    imb_addrectImBuf(ibuf);
+    for (size_t i = 0; i < tot; i++) {
+      ((uchar *)ibuf->rect)[i] = unit_float_to_uchar_clamp(ibuf->rect_float[i]);
+    }
+  }
+
+  BKE_image_tiled_release(texture);
+
+  icon_copy_rect(ibuf, sp->sizex, sp->sizey, sp->pr_rect);
+  IMB_freeImBuf(ibuf);
+
+  return true;
+}
+
 static void icon_preview_startjob(void *customdata, short *stop, short *do_update)
 {
   ShaderPreview *sp = customdata;
@@ -1124,9 +1167,13 @@ static void icon_preview_startjob(void *customdata, short *stop, short *do_updat
       iuser.ok = iuser.framenr = 1;
       iuser.scene = sp->scene;
 
-      /* elubie: this needs to be changed: here image is always loaded if not
-       * already there. Very expensive for large images. Need to find a way to
-       * only get existing ibuf */
+      /* Image files which are not loaded yet are read at icon size from the tiled cache,
+       * loading them is very expensive for large images. */
+      if (!BKE_image_has_loaded_ibuf(ima) && icon_preview_image_tiled(ima, &iuser, sp)) {
+        *do_update = true;
+        return;
+      }
+
       ibuf = BKE_image_acquire_ibuf(ima, &iuser, NULL);
       if (ibuf == NULL || ibuf->rect == NULL) {
         BKE_image_release_ibuf(ima, ibuf, NULL);
@@ -423,6 +423,8 @@ typedef struct ProjPaintState {
   const MLoopTri *mlooptri_eval;
 
   const MLoopUV *mloopuv_stencil_eval;
+  /** Tiled cache of the stencil image file, NULL when the image is sampled from memory. */
+  ImageTiledTexture *stencil_tiled;
 
   /**
    * \note These UV layers are aligned to \a mpoly_eval
@@ -1667,12 +1669,20 @@ static float project_paint_uvpixel_mask(const ProjPaintState *ps,
     /* another UV maps image is masking this one's */
     ImBuf *ibuf_other;
     Image *other_tpage = ps->stencil_ima;
+    const MLoopTri *lt_other = &ps->mlooptri_eval[tri_index];
+    const float *lt_other_tri_uv[3] = {PS_LOOPTRI_AS_UV_3(ps->poly_to_loop_uv, lt_other)};
 
-    if (other_tpage && (ibuf_other = BKE_image_acquire_ibuf(other_tpage, NULL, NULL))) {
-      const MLoopTri *lt_other = &ps->mlooptri_eval[tri_index];
-      const float *lt_other_tri_uv[3] = {PS_LOOPTRI_AS_UV_3(ps->poly_to_loop_uv, lt_other)};
+    if (ps->stencil_tiled) {
+      float uv_other[2], rgba_f[4];
 
-      /* BKE_image_acquire_ibuf - TODO - this may be slow */
+      /* Same bilinear filter and wrapping as project_face_pixel. */
+      interp_v2_v2v2v2(uv_other, UNPACK3(lt_other_tri_uv), w);
+      BKE_image_tiled_sample(ps->stencil_tiled, uv_other[0], uv_other[1], 0.0f, rgba_f);
+
+      mask = ((rgba_f[0] + rgba_f[1] + rgba_f[2]) * (1.0f / 3.0f)) * rgba_f[3];
+    }
+    else if (other_tpage && (ibuf_other = BKE_image_acquire_ibuf(other_tpage, NULL, NULL))) {
+      /* Only for stencils which differ from their file, acquiring for every pixel is slow. */
       uchar rgba_ub[4];
       float rgba_f[4];
 
@@ -1687,19 +1697,19 @@ static float project_paint_uvpixel_mask(const ProjPaintState *ps,
       }
 
       BKE_image_release_ibuf(other_tpage, ibuf_other, NULL);
-
-      if (!ps->do_layer_stencil_inv) {
-        /* matching the gimps layer mask black/white rules, white==full opacity */
-        mask = (1.0f - mask);
-      }
-
-      if (mask == 0.0f) {
-        return 0.0f;
-      }
     }
     else {
       return 0.0f;
     }
+
+    if (!ps->do_layer_stencil_inv) {
+      /* matching the gimps layer mask black/white rules, white==full opacity */
+      mask = (1.0f - mask);
+    }
+
+    if (mask == 0.0f) {
+      return 0.0f;
+    }
   }
   else {
     mask = 1.0f;
@@ -4512,6 +4522,13 @@ static void project_paint_begin(const bContext *C,
   proj_paint_face_lookup_init(ps, &face_lookup);
   proj_paint_layer_clone_init(ps, &layer_clone);
 
+  if (ps->is_shared_user == false && ps->do_layer_stencil) {
+    /* Sample the stencil from the tiled cache of its file, unless it was painted on. */
+    ImageUser iuser;
+    BKE_imageuser_default(&iuser);
+    ps->stencil_tiled = BKE_image_tiled_acquire(ps->stencil_ima, &iuser);
+  }
+
   if (ps->do_layer_stencil || ps->do_stencil_brush) {
     // int layer_num = CustomData_get_stencil_layer(&ps->me_eval->ldata, CD_MLOOPUV);
     int layer_num = CustomData_get_stencil_layer(&((Mesh *)ps->ob->data)->ldata, CD_MLOOPUV);
@@ -4658,6 +4675,11 @@ static void project_paint_end(ProjPaintState *ps)
       MEM_freeN(ps->cavities);
     }
 
+    if (ps->stencil_tiled) {
+      BKE_image_tiled_release(ps->stencil_tiled);
+      ps->stencil_tiled = NULL;
+    }
+
     if (ps->me_eval_free) {
       BKE_id_free(NULL, ps->me_eval);
     }
@@ -147,18 +147,12 @@ static void proxy_freejob(void *pjv)
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
   ProxyJob *pj = pjv;
-  LinkData *link;
-
-  for (link = pj->queue.first; link; link = link->next) {
-    struct SeqIndexBuildContext *context = link->data;
 
-    BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
+  BKE_sequencer_proxy_rebuild_queue(&pj->queue, stop, do_update, progress);
 
-    if (*stop) {
-      pj->stop = 1;
-      fprintf(stderr, "Canceling proxy rebuild on users request...\n");
-      break;
-    }
+  if (*stop) {
+    pj->stop = 1;
+    fprintf(stderr, "Canceling proxy rebuild on users request...\n");
   }
 }
 
@@ -3691,29 +3685,30 @@ static int sequencer_rebuild_proxy_exec(bContext *C, wmOperator *UNUSED(op))
     return OPERATOR_CANCELLED;
   }
 
+  ListBase queue = {NULL, NULL};
+  LinkData *link;
+  short stop = 0, do_update;
+  float progress;
+
   file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "file list");
 
   SEQP_BEGIN (ed, seq) {
     if ((seq->flag & SELECT)) {
-      ListBase queue = {NULL, NULL};
-      LinkData *link;
-      short stop = 0, do_update;
-      float progress;
-
       BKE_sequencer_proxy_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue);
-
-      for (link = queue.first; link; link = link->next) {
-        struct SeqIndexBuildContext *context = link->data;
-        BKE_sequencer_proxy_rebuild(context, &stop, &do_update, &progress);
-        BKE_sequencer_proxy_rebuild_finish(context, 0);
-      }
-      BKE_sequencer_free_imbuf(scene, &ed->seqbase, false);
     }
   }
   SEQ_END;
 
   BLI_gset_free(file_list, MEM_freeN);
 
+  BKE_sequencer_proxy_rebuild_queue(&queue, &stop, &do_update, &progress);
+
+  for (link = queue.first; link; link = link->next) {
+    BKE_sequencer_proxy_rebuild_finish(link->data, false);
+  }
+  BLI_freelistN(&queue);
+  BKE_sequencer_free_imbuf(scene, &ed->seqbase, false);
+
   return OPERATOR_FINISHED;
 }
 
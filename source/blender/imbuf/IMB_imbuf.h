@@ -117,6 +117,26 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Receives one band of rows of an image loaded with #IMB_loadiffname_bands. The band is an
+ * ImBuf as wide as the image, its bottom row is row \a ymin of the image, which is \a height
+ * rows high. Return false to stop loading.
+ */
+typedef bool (*ImBufBandFunc)(void *userdata, struct ImBuf *band, int ymin, int height);
+
+/**
+ * Load an image in bands of rows, from the top of the image down. Bands get the same alpha and
+ * color space handling as images loaded with #IMB_loadiffname. PNG and OpenEXR files and tiled
+ * TIFF textures are read band by band, other formats are loaded at once and then split.
+ *
+ * \attention Defined in readimage.c
+ */
+bool IMB_loadiffname_bands(const char *filepath,
+                           int flags,
+                           char colorspace[IM_MAX_SPACE],
+                           ImBufBandFunc band_func,
+                           void *userdata);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -444,6 +464,30 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/**
+ * Filters of #IMB_resampleImBuf.
+ */
+typedef enum eIMBResampleFilter {
+  /** Average of the covered pixels, linear interpolation when enlarging. */
+  IMB_RESAMPLE_BOX = 0,
+  IMB_RESAMPLE_BILINEAR = 1,
+  /** Catmull-Rom spline. */
+  IMB_RESAMPLE_BICUBIC = 2,
+  /** Three lobed Lanczos, the sharpest filter. */
+  IMB_RESAMPLE_LANCZOS = 3,
+} eIMBResampleFilter;
+
+/**
+ * Resample the byte and float buffers with separable filter passes, multi-threaded.
+ * A size of zero keeps the size of that axis.
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_resampleImBuf(struct ImBuf *ibuf,
+                       unsigned int newx,
+                       unsigned int newy,
+                       eIMBResampleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
@@ -82,9 +82,19 @@
 #define MAXNUMSTREAMS 50
 
 struct IDProperty;
+struct TaskPool;
 struct _AviMovie;
 struct anim_index;
 
+#ifdef WITH_FFMPEG
+/* Decoded frame kept around for reuse, shows from pts up to (excluding) end_pts. */
+typedef struct AnimCachedFrame {
+  struct ImBuf *ibuf;
+  int64_t pts;
+  int64_t end_pts;
+} AnimCachedFrame;
+#endif
+
 struct anim {
   int ib_flags;
   int curtype;
@@ -137,6 +147,22 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Ring buffer of frames decoded while scanning towards a seek target. */
+  AnimCachedFrame *frame_cache;
+  int frame_cache_size;
+  int frame_cache_next;
+
+  /* Keyframe positions, used for seeking when there is no timecode index. The index is built in
+   * the background, until it is done seeking falls back to the demuxer. */
+  struct anim_index *keyframe_index;
+  struct TaskPool *keyframe_index_pool;
+  short keyframe_index_stop;
+  int32_t keyframe_index_done;
+
+  /* Statistics, decoded frames per requested frame tell how well seeking performs. */
+  int frames_requested;
+  int frames_decoded;
 #endif
 
   char index_dir[768];
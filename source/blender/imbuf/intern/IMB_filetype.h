@@ -29,6 +29,9 @@ struct ImBuf;
 
 #define IM_FTYPE_FLOAT 1
 
+/* Number of rows of the bands passed by #IMB_loadiffname_bands, if the file allows choosing. */
+#define IMB_BANDS_HEIGHT 64
+
 typedef struct ImFileType {
   void (*init)(void);
   void (*exit)(void);
@@ -48,6 +51,13 @@ typedef struct ImFileType {
                     int tx,
                     int ty,
                     unsigned int *rect);
+  /* Optional, load the file in bands of rows from the top down, see #IMB_loadiffname_bands.
+   * Returns false on failure, when no band was passed yet the file is loaded at once instead. */
+  bool (*load_filepath_bands)(const char *name,
+                              int flags,
+                              char colorspace[IM_MAX_SPACE],
+                              ImBufBandFunc band_func,
+                              void *userdata);
 
   int flag;
   int filetype;
@@ -74,6 +84,11 @@ struct ImBuf *imb_loadpng(const unsigned char *mem,
                           size_t size,
                           int flags,
                           char colorspace[IM_MAX_SPACE]);
+bool imb_loadpng_bands(const char *name,
+                       int flags,
+                       char colorspace[IM_MAX_SPACE],
+                       ImBufBandFunc band_func,
+                       void *userdata);
 int imb_savepng(struct ImBuf *ibuf, const char *name, int flags);
 
 /* targa */
@@ -106,6 +106,8 @@ int IMB_indexer_can_scan(struct anim_index *idx, int old_frame_index, int new_fr
 
 void IMB_indexer_close(struct anim_index *idx);
 
+struct anim_index *IMB_indexer_build_keyframes(struct anim *anim, const short *stop);
+
 void IMB_free_indices(struct anim *anim);
 
 struct anim *IMB_anim_open_proxy(struct anim *anim, IMB_Proxy_Size preview_size);
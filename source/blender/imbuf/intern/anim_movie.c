@@ -53,12 +53,17 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #ifdef WITH_AVI
 #  include "AVI_avi.h"
 #endif
@@ -730,13 +735,12 @@ static int startffmpeg(struct anim *anim)
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf, usually anim->last_frame
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
   AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
   if (!anim->pFrameComplete) {
@@ -857,6 +861,89 @@ static void ffmpeg_postprocess(struct anim *anim)
   }
 }
 
+/* ----------------------------------------------------------------------
+ * Frames decoded on the way to a seek target, when decoding has to start
+ * from a keyframe far before it. Reverse playback and scrubbing request
+ * these frames next, keeping them avoids decoding the GOP over and over.
+ * ---------------------------------------------------------------------- */
+
+/* Every anim may use this fraction of the cache memory limit from the preferences, which is the
+ * budget of the sequencer cache as well. 64 MB with the default limit of 4 GB. */
+#  define FFMPEG_FRAME_CACHE_MEMORY_FRACTION 64
+#  define FFMPEG_FRAME_CACHE_MAX_FRAMES 32
+
+static int ffmpeg_frame_cache_capacity(struct anim *anim)
+{
+  if (anim->frame_cache) {
+    return anim->frame_cache_size;
+  }
+
+  const size_t memory = MEM_CacheLimiter_get_maximum() / FFMPEG_FRAME_CACHE_MEMORY_FRACTION;
+  const size_t frames = memory / max_zz(anim->framesize, 1);
+  return (int)clamp_z(frames, 2, FFMPEG_FRAME_CACHE_MAX_FRAMES);
+}
+
+static AnimCachedFrame *ffmpeg_frame_cache_find(struct anim *anim, int64_t pts)
+{
+  for (int i = 0; i < anim->frame_cache_size; i++) {
+    AnimCachedFrame *frame = &anim->frame_cache[i];
+    if (frame->ibuf && frame->pts <= pts && frame->end_pts > pts) {
+      return frame;
+    }
+  }
+  return NULL;
+}
+
+/* Takes ownership of ibuf, replacing the oldest frame once the cache is full. */
+static void ffmpeg_frame_cache_add(struct anim *anim, ImBuf *ibuf, int64_t pts, int64_t end_pts)
+{
+  AnimCachedFrame *frame;
+
+  if (anim->frame_cache == NULL) {
+    anim->frame_cache_size = ffmpeg_frame_cache_capacity(anim);
+    anim->frame_cache_next = 0;
+    anim->frame_cache = MEM_callocN(sizeof(AnimCachedFrame) * anim->frame_cache_size,
+                                    "anim frame cache");
+  }
+
+  frame = &anim->frame_cache[anim->frame_cache_next];
+  if (frame->ibuf) {
+    IMB_freeImBuf(frame->ibuf);
+  }
+  frame->ibuf = ibuf;
+  frame->pts = pts;
+  frame->end_pts = end_pts;
+
+  anim->frame_cache_next = (anim->frame_cache_next + 1) % anim->frame_cache_size;
+}
+
+static void ffmpeg_frame_cache_free(struct anim *anim)
+{
+  if (anim->frame_cache == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < anim->frame_cache_size; i++) {
+    if (anim->frame_cache[i].ibuf) {
+      IMB_freeImBuf(anim->frame_cache[i].ibuf);
+    }
+  }
+  MEM_freeN(anim->frame_cache);
+  anim->frame_cache = NULL;
+  anim->frame_cache_size = 0;
+  anim->frame_cache_next = 0;
+}
+
+static void ffmpeg_decode_stats_log(struct anim *anim)
+{
+  av_log(anim->pFormatCtx,
+         AV_LOG_DEBUG,
+         "FETCH STATS: %d frames decoded for %d requested (%.2f per frame)\n",
+         anim->frames_decoded,
+         anim->frames_requested,
+         (double)anim->frames_decoded / max_ii(anim->frames_requested, 1));
+}
+
 /* decode one video frame also considering the packet read into next_packet */
 
 static int ffmpeg_decode_video_frame(struct anim *anim)
@@ -889,6 +976,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
       if (anim->pFrameComplete) {
         anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+        anim->frames_decoded++;
 
         av_log(anim->pFormatCtx,
                AV_LOG_DEBUG,
@@ -924,6 +1012,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
     if (anim->pFrameComplete) {
       anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+      anim->frames_decoded++;
 
       av_log(anim->pFormatCtx,
              AV_LOG_DEBUG,
@@ -949,7 +1038,11 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
   return (rval >= 0);
 }
 
-static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_search)
+/* Decode until the frame with pts_to_search, frames from cache_pts_min on
+ * are kept in the frame cache. */
+static void ffmpeg_decode_video_frame_scan(struct anim *anim,
+                                           int64_t pts_to_search,
+                                           int64_t cache_pts_min)
 {
   /* there seem to exist *very* silly GOP lengths out in the wild... */
   int count = 1000;
@@ -966,9 +1059,26 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
            "  WHILE: pts=%lld in search of %lld\n",
            (long long int)anim->next_pts,
            (long long int)pts_to_search);
+    const int64_t pts = anim->next_pts;
+    ImBuf *ibuf = NULL;
+
+    /* next_pts is -1 right after seeking, pFrame is not valid then. */
+    if (anim->pFrameComplete && pts != -1 && pts >= cache_pts_min &&
+        !ffmpeg_frame_cache_find(anim, pts)) {
+      ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+      ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+      ffmpeg_postprocess(anim, ibuf);
+    }
+
     if (!ffmpeg_decode_video_frame(anim)) {
+      if (ibuf) {
+        IMB_freeImBuf(ibuf);
+      }
       break;
     }
+    if (ibuf) {
+      ffmpeg_frame_cache_add(anim, ibuf, pts, anim->next_pts);
+    }
     count--;
   }
   if (count == 0) {
@@ -1029,13 +1139,77 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
+static void ffmpeg_keyframe_index_build_task(TaskPool *__restrict pool,
+                                             void *UNUSED(taskdata))
+{
+  struct anim *anim = BLI_task_pool_user_data(pool);
+  struct anim_index *keyframe_index = IMB_indexer_build_keyframes(anim,
+                                                                  &anim->keyframe_index_stop);
+
+  av_log(NULL,
+         AV_LOG_DEBUG,
+         "FETCH: keyframe index %s (%d entries)\n",
+         keyframe_index ? "built" : "not available",
+         keyframe_index ? keyframe_index->num_entries : 0);
+
+  anim->keyframe_index = keyframe_index;
+  atomic_add_and_fetch_int32(&anim->keyframe_index_done, 1);
+}
+
+/* Keyframe index, built in the background the first time seeking is needed and there is no
+ * timecode index. Reading the whole file would stall the first seek on long movies, so NULL is
+ * returned until the index is done. */
+static struct anim_index *ffmpeg_keyframe_index_get(struct anim *anim)
+{
+  if (anim->keyframe_index_pool == NULL) {
+    anim->keyframe_index_stop = 0;
+    anim->keyframe_index_pool = BLI_task_pool_create_background(anim, TASK_PRIORITY_LOW);
+    BLI_task_pool_push(
+        anim->keyframe_index_pool, ffmpeg_keyframe_index_build_task, NULL, false, NULL);
+    return NULL;
+  }
+
+  if (atomic_add_and_fetch_int32(&anim->keyframe_index_done, 0) == 0) {
+    return NULL;
+  }
+  return anim->keyframe_index;
+}
+
+static void ffmpeg_keyframe_index_free(struct anim *anim)
+{
+  if (anim->keyframe_index_pool) {
+    anim->keyframe_index_stop = 1;
+    BLI_task_pool_work_and_wait(anim->keyframe_index_pool);
+    BLI_task_pool_free(anim->keyframe_index_pool);
+    anim->keyframe_index_pool = NULL;
+  }
+  if (anim->keyframe_index) {
+    IMB_indexer_close(anim->keyframe_index);
+    anim->keyframe_index = NULL;
+  }
+  anim->keyframe_index_done = 0;
+}
+
+/* Last entry not after frameno, the keyframe index has no entries for missing frames. */
+static int ffmpeg_keyframe_index_find(struct anim_index *idx, int frameno)
+{
+  int frame_index = IMB_indexer_get_frame_index(idx, frameno);
+  if (frame_index > 0 && idx->entries[frame_index].frameno > frameno) {
+    frame_index--;
+  }
+  return frame_index;
+}
+
 static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
   int64_t pts_to_search = 0;
+  int64_t cache_pts_min;
   double frame_rate;
   double pts_time_base;
   long long st_time;
   struct anim_index *tc_index = 0;
+  struct anim_index *seek_index;
+  AnimCachedFrame *cached_frame;
   AVStream *v_st;
   int new_frame_index = 0; /* To quiet gcc barking... */
   int old_frame_index = 0; /* To quiet gcc barking... */
@@ -1046,6 +1220,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: pos=%d\n", position);
 
+  anim->frames_requested++;
+
   if (tc != IMB_TC_NONE) {
     tc_index = IMB_anim_open_index(anim, tc);
   }
@@ -1087,35 +1263,69 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            (long long int)anim->next_pts);
     IMB_refImBuf(anim->last_frame);
     anim->curposition = position;
+    ffmpeg_decode_stats_log(anim);
     return anim->last_frame;
   }
 
-  if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
+  cached_frame = ffmpeg_frame_cache_find(anim, pts_to_search);
+  if (cached_frame) {
+    av_log(anim->pFormatCtx,
+           AV_LOG_DEBUG,
+           "FETCH: frame cache hit: %lld\n",
+           (long long int)cached_frame->pts);
+    ffmpeg_decode_stats_log(anim);
+    /* Callers may convert the buffer in place, the cached frame stays untouched.
+     * The decoder state does not change, so curposition is kept as well. */
+    return IMB_dupImBuf(cached_frame->ibuf);
+  }
+
+  /* Frames right before the target are cached while scanning. */
+  cache_pts_min = pts_to_search - (int64_t)ceil((double)ffmpeg_frame_cache_capacity(anim) /
+                                                pts_time_base / frame_rate);
+
+  seek_index = tc_index;
+  if (seek_index == NULL && position != anim->curposition + 1) {
+    seek_index = ffmpeg_keyframe_index_get(anim);
+    if (seek_index) {
+      new_frame_index = ffmpeg_keyframe_index_find(seek_index, position);
+      old_frame_index = ffmpeg_keyframe_index_find(seek_index, anim->curposition);
+    }
+  }
+
+  if (position > anim->curposition + 1 && anim->preseek && !seek_index &&
       position - (anim->curposition + 1) < anim->preseek) {
     av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, cache_pts_min);
   }
-  else if (tc_index && IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
+  else if (seek_index && IMB_indexer_can_scan(seek_index, old_frame_index, new_frame_index)) {
     av_log(anim->pFormatCtx,
            AV_LOG_DEBUG,
            "FETCH: within preseek interval "
            "(index tells us)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, cache_pts_min);
   }
   else if (position != anim->curposition + 1) {
     long long pos;
     int ret;
 
-    if (tc_index) {
+    if (seek_index) {
       unsigned long long dts;
 
-      pos = IMB_indexer_get_seek_pos(tc_index, new_frame_index);
-      dts = IMB_indexer_get_seek_pos_dts(tc_index, new_frame_index);
+      pos = IMB_indexer_get_seek_pos(seek_index, new_frame_index);
+      dts = IMB_indexer_get_seek_pos_dts(seek_index, new_frame_index);
 
-      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek pos = %lld\n", pos);
-      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek dts = %llu\n", dts);
+      av_log(anim->pFormatCtx,
+             AV_LOG_DEBUG,
+             "%s INDEX seek pos = %lld\n",
+             tc_index ? "TC" : "KEYFRAME",
+             pos);
+      av_log(anim->pFormatCtx,
+             AV_LOG_DEBUG,
+             "%s INDEX seek dts = %llu\n",
+             tc_index ? "TC" : "KEYFRAME",
+             dts);
 
       if (ffmpeg_seek_by_byte(anim->pFormatCtx)) {
         av_log(anim->pFormatCtx, AV_LOG_DEBUG, "... using BYTE pos\n");
@@ -1174,7 +1384,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     /* memset(anim->pFrame, ...) ?? */
 
     if (ret >= 0) {
-      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search, cache_pts_min);
     }
   }
   else if (position == 0 && anim->curposition == -1) {
@@ -1189,7 +1399,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
   anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-  ffmpeg_postprocess(anim);
+  ffmpeg_postprocess(anim, anim->last_frame);
 
   anim->last_pts = anim->next_pts;
 
@@ -1197,6 +1407,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   anim->curposition = position;
 
+  ffmpeg_decode_stats_log(anim);
+
   IMB_refImBuf(anim->last_frame);
 
   return anim->last_frame;
@@ -1236,6 +1448,8 @@ static void free_anim_ffmpeg(struct anim *anim)
       av_free_packet(&anim->next_packet);
     }
   }
+  ffmpeg_frame_cache_free(anim);
+  ffmpeg_keyframe_index_free(anim);
   anim->duration_in_frames = 0;
 }
 
@@ -60,6 +60,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savejpeg,
      NULL,
+     NULL,
      0,
      IMB_FTYPE_JPG,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -72,6 +73,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savepng,
      NULL,
+     imb_loadpng_bands,
      0,
      IMB_FTYPE_PNG,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -84,6 +86,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savebmp,
      NULL,
+     NULL,
      0,
      IMB_FTYPE_BMP,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -96,6 +99,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savetarga,
      NULL,
+     NULL,
      0,
      IMB_FTYPE_TGA,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -108,6 +112,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_saveiris,
      NULL,
+     NULL,
      0,
      IMB_FTYPE_IMAGIC,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -121,6 +126,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_save_dpx,
      NULL,
+     NULL,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_DPX,
      COLOR_ROLE_DEFAULT_FLOAT},
@@ -133,6 +139,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_save_cineon,
      NULL,
+     NULL,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_CINEON,
      COLOR_ROLE_DEFAULT_FLOAT},
@@ -147,6 +154,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savetiff,
      imb_loadtiletiff,
+     NULL,
      0,
      IMB_FTYPE_TIF,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -161,6 +169,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_savehdr,
      NULL,
+     NULL,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_RADHDR,
      COLOR_ROLE_DEFAULT_FLOAT},
@@ -175,6 +184,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_save_openexr,
      NULL,
+     imb_load_openexr_bands,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_OPENEXR,
      COLOR_ROLE_DEFAULT_FLOAT},
@@ -189,6 +199,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      imb_save_jp2,
      NULL,
+     NULL,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_JP2,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -203,6 +214,7 @@ const ImFileType IMB_FILE_TYPES[] = {
      NULL,
      NULL,
      NULL,
+     NULL,
      0,
      IMB_FTYPE_DDS,
      COLOR_ROLE_DEFAULT_BYTE},
@@ -217,11 +229,12 @@ const ImFileType IMB_FILE_TYPES[] = {
      imb_load_photoshop,
      NULL,
      NULL,
+     NULL,
      IM_FTYPE_FLOAT,
      IMB_FTYPE_PSD,
      COLOR_ROLE_DEFAULT_FLOAT},
 #endif
-    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0},
 };
 
 const ImFileType *IMB_FILE_TYPES_LAST =
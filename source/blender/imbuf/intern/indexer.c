@@ -29,6 +29,8 @@
 #include "BLI_ghash.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -779,6 +781,10 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
   }
 
   context->iCodecCtx->workaround_bugs = 1;
+  /* Frame threading would delay decoded frames by several packets, which breaks the
+   * association of frames with the seek position of their key frame in the index. */
+  context->iCodecCtx->thread_count = BLI_system_thread_count();
+  context->iCodecCtx->thread_type = FF_THREAD_SLICE;
 
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
@@ -839,6 +845,19 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
   MEM_freeN(context);
 }
 
+typedef struct ProxyOutputData {
+  FFmpegIndexBuilderContext *context;
+  AVFrame *frame;
+} ProxyOutputData;
+
+static void index_rebuild_ffmpeg_proxy_output_cb(void *__restrict userdata,
+                                                 const int i,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ProxyOutputData *data = userdata;
+  add_to_proxy_output_ffmpeg(data->context->proxy_ctx[i], data->frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *context,
                                                     AVPacket *curr_packet,
                                                     AVFrame *in_frame)
@@ -847,11 +866,22 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   unsigned long long s_pos = context->seek_pos;
   unsigned long long s_dts = context->seek_pos_dts;
   unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
+  int num_proxy_outputs = 0;
 
   for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+    if (context->proxy_ctx[i]) {
+      num_proxy_outputs++;
+    }
   }
 
+  /* Each proxy size is scaled and encoded from the decoded frame independently. */
+  ProxyOutputData data = {context, in_frame};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (num_proxy_outputs > 1);
+  BLI_task_parallel_range(
+      0, context->num_proxy_sizes, &data, index_rebuild_ffmpeg_proxy_output_cb, &settings);
+
   if (!context->start_pts_set) {
     context->start_pts = pts;
     context->start_pts_set = true;
@@ -973,6 +1003,138 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 
 #endif
 
+/* ----------------------------------------------------------------------
+ * - keyframe index (demux only, kept in memory)
+ * ---------------------------------------------------------------------- */
+
+#ifdef WITH_FFMPEG
+
+static int index_entry_pts_cmp(const void *a_, const void *b_)
+{
+  const int64_t a = (int64_t)((const anim_index_entry *)a_)->pts;
+  const int64_t b = (int64_t)((const anim_index_entry *)b_)->pts;
+
+  if (a < b) {
+    return -1;
+  }
+  if (a > b) {
+    return 1;
+  }
+  return 0;
+}
+
+/* Build an index of the video packets of the anim, without decoding anything.
+ * Frame numbers match the ones used for seeking without timecode (IMB_TC_NONE),
+ * seek positions point to the keyframe decoding of a frame has to start from.
+ * Only reads the file name and stream of the anim, so it can run on another thread.
+ *
+ * Returns NULL for streams without presentation timestamps and when stopped. */
+struct anim_index *IMB_indexer_build_keyframes(struct anim *anim, const short *stop)
+{
+  AVFormatContext *format_ctx = NULL;
+  AVStream *stream;
+  AVPacket packet;
+  anim_index_entry *entries = NULL;
+  int num_entries = 0, entries_len = 0;
+  unsigned long long seek_pos = 0, seek_pos_dts = 0;
+  unsigned long long last_seek_pos = 0, last_seek_pos_dts = 0;
+  int64_t seek_pos_pts = 0;
+  double frame_rate, pts_time_base;
+  int64_t start_pts = 0;
+  bool valid = true;
+  struct anim_index *idx;
+  int i;
+
+  if (avformat_open_input(&format_ctx, anim->name, NULL, NULL) != 0) {
+    return NULL;
+  }
+
+  if (avformat_find_stream_info(format_ctx, NULL) < 0 ||
+      anim->videoStream >= format_ctx->nb_streams) {
+    avformat_close_input(&format_ctx);
+    return NULL;
+  }
+
+  stream = format_ctx->streams[anim->videoStream];
+  frame_rate = av_q2d(av_guess_frame_rate(format_ctx, stream, NULL));
+  pts_time_base = av_q2d(stream->time_base);
+
+  if (format_ctx->start_time != AV_NOPTS_VALUE) {
+    start_pts = format_ctx->start_time / pts_time_base / AV_TIME_BASE;
+  }
+
+  memset(&packet, 0, sizeof(AVPacket));
+
+  while (av_read_frame(format_ctx, &packet) >= 0) {
+    if (*stop) {
+      valid = false;
+      av_free_packet(&packet);
+      break;
+    }
+
+    if (packet.stream_index == anim->videoStream) {
+      anim_index_entry *e;
+
+      if (packet.pts == AV_NOPTS_VALUE) {
+        valid = false;
+        av_free_packet(&packet);
+        break;
+      }
+
+      /* Same logic as the timecode builder, see index_rebuild_ffmpeg(). */
+      if (packet.flags & AV_PKT_FLAG_KEY) {
+        last_seek_pos = seek_pos;
+        last_seek_pos_dts = seek_pos_dts;
+        seek_pos = packet.pos;
+        seek_pos_dts = packet.dts;
+        seek_pos_pts = packet.pts;
+      }
+
+      if (num_entries == entries_len) {
+        entries_len = entries_len ? entries_len * 2 : 1024;
+        entries = MEM_reallocN_id(entries, sizeof(*entries) * entries_len, __func__);
+      }
+
+      e = &entries[num_entries++];
+      e->pts = packet.pts;
+      /* Leading frames of an open GOP need the previous keyframe. */
+      if (packet.pts < seek_pos_pts) {
+        e->seek_pos = last_seek_pos;
+        e->seek_pos_dts = last_seek_pos_dts;
+      }
+      else {
+        e->seek_pos = seek_pos;
+        e->seek_pos_dts = seek_pos_dts;
+      }
+    }
+    av_free_packet(&packet);
+  }
+
+  avformat_close_input(&format_ctx);
+
+  if (!valid || num_entries == 0) {
+    MEM_SAFE_FREE(entries);
+    return NULL;
+  }
+
+  /* Packets are stored in decoding order, frames are requested in presentation order. */
+  qsort(entries, num_entries, sizeof(*entries), index_entry_pts_cmp);
+
+  for (i = 0; i < num_entries; i++) {
+    entries[i].frameno = (int)floor(
+        (double)((int64_t)entries[i].pts - start_pts) * pts_time_base * frame_rate + 0.5);
+  }
+
+  idx = MEM_callocN(sizeof(struct anim_index), "anim_index");
+  BLI_strncpy(idx->name, anim->name, sizeof(idx->name));
+  idx->num_entries = num_entries;
+  idx->entries = entries;
+
+  return idx;
+}
+
+#endif
+
 /* ----------------------------------------------------------------------
  * - internal AVI (fallback) rebuilder
  * ---------------------------------------------------------------------- */
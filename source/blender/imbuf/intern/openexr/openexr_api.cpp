@@ -86,6 +86,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include "IMB_allocimbuf.h"
 #include "IMB_colormanagement.h"
 #include "IMB_colormanagement_intern.h"
+#include "IMB_filetype.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_metadata.h"
@@ -98,6 +99,9 @@ using namespace Imath;
 extern "C" {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
+static bool imb_exr_build_layers(struct ExrHandle *data);
+static void imb_exr_pass_alloc(struct ExrPass *pass, int width, int height);
+static bool imb_exr_header_metadata(const Header &header, IDProperty **metadata);
 static bool exr_has_multiview(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
@@ -1203,9 +1207,11 @@ void IMB_exrtile_write_channels(
   }
 }
 
-void IMB_exr_read_channels(void *handle)
+/* Read the channels which have a buffer set, parts without any such channel are not decoded.
+ * When region is given only the scanlines covering it are read, region is in Blender's bottom
+ * to top row order. */
+static void imb_exr_read_channels_region(ExrHandle *data, const rcti *region)
 {
-  ExrHandle *data = (ExrHandle *)handle;
   int numparts = data->ifile->parts();
 
   /* check if exr was saved with previous versions of blender which flipped images */
@@ -1228,10 +1234,12 @@ void IMB_exr_read_channels(void *handle)
     InputPart in(*data->ifile, i);
     Header header = in.header();
     Box2i dw = header.dataWindow();
+    int ymin = dw.min.y, ymax = dw.max.y;
 
     /* Insert all matching channel into framebuffer. */
     FrameBuffer frameBuffer;
     ExrChannel *echan;
+    int totchannel = 0;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       if (echan->m->part_number != i) {
@@ -1263,17 +1271,39 @@ void IMB_exr_read_channels(void *handle)
 
         frameBuffer.insert(echan->m->internal_name,
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        totchannel++;
       }
       else {
-        printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+        exr_printf("channel with no rect set %s\n", echan->m->internal_name.c_str());
+      }
+    }
+
+    if (totchannel == 0) {
+      continue;
+    }
+
+    if (region) {
+      /* Scanlines of the region, rows are flipped unless the file was flipped on save. */
+      if (!flip) {
+        ymin = dw.min.y + data->height - region->ymax;
+        ymax = dw.min.y + data->height - 1 - region->ymin;
+      }
+      else {
+        ymin = dw.min.y + region->ymin;
+        ymax = dw.min.y + region->ymax - 1;
+      }
+      CLAMP_MIN(ymin, dw.min.y);
+      CLAMP_MAX(ymax, dw.max.y);
+      if (ymin > ymax) {
+        continue;
       }
     }
 
     /* Read pixels. */
     try {
       in.setFrameBuffer(frameBuffer);
-      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
-      in.readPixels(dw.min.y, dw.max.y);
+      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, ymin, ymax);
+      in.readPixels(ymin, ymax);
     }
     catch (const std::exception &exc) {
       std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
@@ -1282,6 +1312,54 @@ void IMB_exr_read_channels(void *handle)
   }
 }
 
+void IMB_exr_read_channels(void *handle)
+{
+  imb_exr_read_channels_region((ExrHandle *)handle, NULL);
+}
+
+void IMB_exr_read_passes(void *handle,
+                         const char *const *passnames,
+                         int totpass,
+                         const rcti *region)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+
+  if (BLI_listbase_is_empty(&data->layers) && !imb_exr_build_layers(data)) {
+    return;
+  }
+
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      bool requested = (passnames == NULL);
+      char fullname[EXR_LAY_MAXNAME + EXR_PASS_MAXNAME + EXR_VIEW_MAXNAME + 3];
+
+      /* Same names as the render result passes, pass->name may be cut short by the view. */
+      if (pass->view[0] != '\0') {
+        BLI_snprintf(
+            fullname, sizeof(fullname), "%s.%s.%s", lay->name, pass->internal_name, pass->view);
+      }
+      else {
+        BLI_snprintf(fullname, sizeof(fullname), "%s.%s", lay->name, pass->internal_name);
+      }
+      for (int i = 0; i < totpass && !requested; i++) {
+        requested = STREQ(passnames[i], fullname);
+      }
+
+      if (requested && pass->rect == NULL) {
+        imb_exr_pass_alloc(pass, data->width, data->height);
+      }
+    }
+  }
+
+  imb_exr_read_channels_region(data, region);
+}
+
+void IMB_exr_read_metadata(void *handle, struct IDProperty **metadata)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  imb_exr_header_metadata(data->ifile->header(0), metadata);
+}
+
 void IMB_exr_multilayer_convert(void *handle,
                                 void *base,
                                 void *(*addview)(void *base, const char *str),
@@ -1310,6 +1388,11 @@ void IMB_exr_multilayer_convert(void *handle,
     }
   }
 
+  /* Handles opened from a file only know their channels, passes are allocated on read. */
+  if (BLI_listbase_is_empty(&data->layers)) {
+    imb_exr_build_layers(data);
+  }
+
   if (BLI_listbase_is_empty(&data->layers)) {
     printf("cannot convert multilayer, no layers in handle\n");
     return;
@@ -1523,43 +1606,12 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
-/* creates channels, makes a hierarchy and assigns memory to channels */
-static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
-                                         MultiPartInputFile &file,
-                                         int width,
-                                         int height)
+/* makes a hierarchy of layers and passes of the channels, no memory is assigned yet */
+static bool imb_exr_build_layers(ExrHandle *data)
 {
-  ExrLayer *lay;
-  ExrPass *pass;
   ExrChannel *echan;
-  ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
-  int a;
   char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-  data->ifile_stream = &file_stream;
-  data->ifile = &file;
-
-  data->width = width;
-  data->height = height;
-
-  std::vector<MultiViewChannelName> channels;
-  GetChannelsInMultiPartFile(*data->ifile, channels);
-
-  imb_exr_get_views(*data->ifile, *data->multiView);
-
-  for (size_t i = 0; i < channels.size(); i++) {
-    IMB_exr_add_channel(
-        data, NULL, channels[i].name.c_str(), channels[i].view.c_str(), 0, 0, NULL, false);
-
-    echan = (ExrChannel *)data->channels.last;
-    echan->m->name = channels[i].name;
-    echan->m->view = channels[i].view;
-    echan->m->part_number = channels[i].part_number;
-    echan->m->internal_name = channels[i].internal_name;
-  }
-
-  /* now try to sort out how to assign memory to the channels */
-  /* first build hierarchical layer list */
   for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
     if (imb_exr_split_channel_name(echan, layname, passname)) {
 
@@ -1590,68 +1642,118 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   }
   if (echan) {
     printf("error, too many channels in one pass: %s\n", echan->m->name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+/* with some heuristics, try to merge the channels of a pass in one buffer */
+static void imb_exr_pass_alloc(ExrPass *pass, int width, int height)
+{
+  ExrChannel *echan;
+  int a;
+
+  if (pass->totchan == 0) {
+    return;
+  }
+
+  pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float),
+                                      "pass rect");
+  if (pass->totchan == 1) {
+    echan = pass->chan[0];
+    echan->rect = pass->rect;
+    echan->xstride = 1;
+    echan->ystride = width;
+    pass->chan_id[0] = echan->chan_id;
+  }
+  else {
+    char lookup[256];
+
+    memset(lookup, 0, sizeof(lookup));
+
+    /* we can have RGB(A), XYZ(W), UVA */
+    if (pass->totchan == 3 || pass->totchan == 4) {
+      if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+          pass->chan[2]->chan_id == 'B') {
+        lookup[(unsigned int)'R'] = 0;
+        lookup[(unsigned int)'G'] = 1;
+        lookup[(unsigned int)'B'] = 2;
+        lookup[(unsigned int)'A'] = 3;
+      }
+      else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+               pass->chan[2]->chan_id == 'Y') {
+        lookup[(unsigned int)'X'] = 0;
+        lookup[(unsigned int)'Y'] = 1;
+        lookup[(unsigned int)'Z'] = 2;
+        lookup[(unsigned int)'W'] = 3;
+      }
+      else {
+        lookup[(unsigned int)'U'] = 0;
+        lookup[(unsigned int)'V'] = 1;
+        lookup[(unsigned int)'A'] = 2;
+      }
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
+        echan->xstride = pass->totchan;
+        echan->ystride = width * pass->totchan;
+        pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
+      }
+    }
+    else { /* unknown */
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = pass->rect + a;
+        echan->xstride = pass->totchan;
+        echan->ystride = width * pass->totchan;
+        pass->chan_id[a] = echan->chan_id;
+      }
+    }
+  }
+}
+
+/* creates channels, makes a hierarchy and assigns memory to channels */
+static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
+                                         MultiPartInputFile &file,
+                                         int width,
+                                         int height)
+{
+  ExrChannel *echan;
+  ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
+
+  data->ifile_stream = &file_stream;
+  data->ifile = &file;
+
+  data->width = width;
+  data->height = height;
+
+  std::vector<MultiViewChannelName> channels;
+  GetChannelsInMultiPartFile(*data->ifile, channels);
+
+  imb_exr_get_views(*data->ifile, *data->multiView);
+
+  for (size_t i = 0; i < channels.size(); i++) {
+    IMB_exr_add_channel(
+        data, NULL, channels[i].name.c_str(), channels[i].view.c_str(), 0, 0, NULL, false);
+
+    echan = (ExrChannel *)data->channels.last;
+    echan->m->name = channels[i].name;
+    echan->m->view = channels[i].view;
+    echan->m->part_number = channels[i].part_number;
+    echan->m->internal_name = channels[i].internal_name;
+  }
+
+  /* now try to sort out how to assign memory to the channels */
+  /* first build hierarchical layer list */
+  if (!imb_exr_build_layers(data)) {
     IMB_exr_close(data);
     return NULL;
   }
 
-  /* with some heuristics, try to merge the channels in buffers */
-  for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
-    for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
-      if (pass->totchan) {
-        pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float),
-                                            "pass rect");
-        if (pass->totchan == 1) {
-          echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (pass->totchan == 3 || pass->totchan == 4) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
-        }
-      }
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      imb_exr_pass_alloc(pass, width, height);
     }
   }
 
@@ -1869,6 +1971,26 @@ static bool imb_exr_is_multi(MultiPartInputFile &file)
   return false;
 }
 
+/* copy the string attributes of the header, returns true when any was found */
+static bool imb_exr_header_metadata(const Header &header, IDProperty **metadata)
+{
+  Header::ConstIterator iter;
+  bool found = false;
+
+  IMB_metadata_ensure(metadata);
+  for (iter = header.begin(); iter != header.end(); iter++) {
+    const StringAttribute *attr = header.findTypedAttribute<StringAttribute>(iter.name());
+
+    /* not all attributes are string attributes so we might get some NULLs here */
+    if (attr) {
+      IMB_metadata_set_field(*metadata, iter.name(), attr->value().c_str());
+      found = true;
+    }
+  }
+
+  return found;
+}
+
 bool IMB_exr_has_multilayer(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -1929,19 +2051,8 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
       if (!(flags & IB_test)) {
 
         if (flags & IB_metadata) {
-          const Header &header = file->header(0);
-          Header::ConstIterator iter;
-
-          IMB_metadata_ensure(&ibuf->metadata);
-          for (iter = header.begin(); iter != header.end(); iter++) {
-            const StringAttribute *attr = file->header(0).findTypedAttribute<StringAttribute>(
-                iter.name());
-
-            /* not all attributes are string attributes so we might get some NULLs here */
-            if (attr) {
-              IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
-              ibuf->flags |= IB_metadata;
-            }
+          if (imb_exr_header_metadata(file->header(0), &ibuf->metadata)) {
+            ibuf->flags |= IB_metadata;
           }
         }
 
@@ -2069,6 +2180,130 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+bool imb_load_openexr_bands(const char *name,
+                            int flags,
+                            char colorspace[IM_MAX_SPACE],
+                            ImBufBandFunc band_func,
+                            void *userdata)
+{
+  struct ImBuf *band = NULL;
+  IFileStream *file_stream = NULL;
+  MultiPartInputFile *file = NULL;
+  bool ok = true;
+
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+  try {
+    file_stream = new IFileStream(name);
+    file = new MultiPartInputFile(*file_stream);
+
+    /* Layers and views are only read at once. */
+    if (imb_exr_is_multi(*file)) {
+      delete file;
+      delete file_stream;
+      return false;
+    }
+
+    const Header &header = file->header(0);
+    const Box2i dw = header.dataWindow();
+    const int width = dw.max.x - dw.min.x + 1;
+    const int height = dw.max.y - dw.min.y + 1;
+    const bool has_rgb = exr_has_rgb(*file);
+    const bool has_luma = exr_has_luma(*file);
+    const bool has_chroma = exr_has_chroma(*file);
+    const int planes = exr_has_alpha(*file) ? 32 : 24;
+    /* Read whole tiles of tiled files, scanlines are buffered by the file otherwise. */
+    const int band_height = header.hasTileDescription() ? header.tileDescription().ySize :
+                                                          IMB_BANDS_HEIGHT;
+    InputPart in(*file, 0);
+
+    for (int ytop = height; ok && ytop > 0; ytop -= band_height) {
+      const int rows = std::min(band_height, ytop);
+      const int ymin = ytop - rows;
+      FrameBuffer frameBuffer;
+      float *first;
+      int xstride = sizeof(float) * 4;
+      int ystride = -xstride * width;
+
+      band = IMB_allocImBuf(width, rows, planes, IB_rectfloat);
+      if (band == NULL) {
+        ok = false;
+        break;
+      }
+      band->ftype = IMB_FTYPE_OPENEXR;
+      band->flags |= exr_is_half_float(*file) ? IB_halffloat : 0;
+
+      /* Scanlines are stored top down, move the first scanline of the data-window to the
+       * band row it lands on, reading y-flipped like the whole image. */
+      first = band->rect_float + 4 * ((size_t)(height - 1 + dw.min.y - ymin) * width - dw.min.x);
+
+      if (has_rgb) {
+        frameBuffer.insert(exr_rgba_channelname(*file, "R"),
+                           Slice(Imf::FLOAT, (char *)first, xstride, ystride));
+        frameBuffer.insert(exr_rgba_channelname(*file, "G"),
+                           Slice(Imf::FLOAT, (char *)(first + 1), xstride, ystride));
+        frameBuffer.insert(exr_rgba_channelname(*file, "B"),
+                           Slice(Imf::FLOAT, (char *)(first + 2), xstride, ystride));
+      }
+      else if (has_luma) {
+        frameBuffer.insert(exr_rgba_channelname(*file, "Y"),
+                           Slice(Imf::FLOAT, (char *)first, xstride, ystride));
+        frameBuffer.insert(exr_rgba_channelname(*file, "BY"),
+                           Slice(Imf::FLOAT, (char *)(first + 1), xstride, ystride, 1, 1, 0.5f));
+        frameBuffer.insert(exr_rgba_channelname(*file, "RY"),
+                           Slice(Imf::FLOAT, (char *)(first + 2), xstride, ystride, 1, 1, 0.5f));
+      }
+
+      frameBuffer.insert(exr_rgba_channelname(*file, "A"),
+                         Slice(Imf::FLOAT, (char *)(first + 3), xstride, ystride, 1, 1, 1.0f));
+
+      in.setFrameBuffer(frameBuffer);
+      in.readPixels(dw.min.y + height - ytop, dw.min.y + height - 1 - ymin);
+
+      if (!has_rgb && has_luma) {
+        for (size_t a = 0; a < (size_t)band->x * band->y; a++) {
+          float *color = band->rect_float + a * 4;
+          if (has_chroma) {
+            ycc_to_rgb(color[0] * 255.0f,
+                       color[1] * 255.0f,
+                       color[2] * 255.0f,
+                       &color[0],
+                       &color[1],
+                       &color[2],
+                       BLI_YCC_ITU_BT709);
+          }
+          else {
+            color[1] = color[2] = color[0];
+          }
+        }
+      }
+
+      if (flags & IB_alphamode_detect) {
+        band->flags |= IB_alphamode_premul;
+      }
+
+      ok = band_func(userdata, band, ymin, height);
+      IMB_freeImBuf(band);
+      band = NULL;
+    }
+
+    delete file;
+    delete file_stream;
+
+    return ok;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    if (band) {
+      IMB_freeImBuf(band);
+    }
+    delete file;
+    delete file_stream;
+
+    return false;
+  }
+}
+
 void imb_initopenexr(void)
 {
   int num_threads = BLI_system_thread_count();
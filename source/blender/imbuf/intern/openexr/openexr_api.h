@@ -24,6 +24,7 @@
 #ifndef __OPENEXR_API_H__
 #define __OPENEXR_API_H__
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #ifdef __cplusplus
@@ -38,6 +39,12 @@ int imb_is_a_openexr(const unsigned char *mem);
 int imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags);
 
 struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags, char *colorspace);
+bool imb_load_openexr_bands(
+    const char *name,
+    int flags,
+    char *colorspace,
+    bool (*band_func)(void *userdata, struct ImBuf *band, int ymin, int height),
+    void *userdata);
 
 #ifdef __cplusplus
 }
@@ -38,7 +38,9 @@
 extern "C" {
 #endif
 
+struct IDProperty;
 struct StampData;
+struct rcti;
 
 void *IMB_exr_get_handle(void);
 void *IMB_exr_get_handle_name(const char *name);
@@ -73,6 +75,15 @@ float *IMB_exr_channel_rect(void *handle,
                             const char *view);
 
 void IMB_exr_read_channels(void *handle);
+/* Read a selection of the passes of a multilayer file opened with IMB_exr_begin_read. Passes are
+ * named "layer.pass", with the view appended for multiview files, NULL passnames reads all
+ * passes. Other passes are not allocated, and parts of the file without requested passes are
+ * not decoded. When region is given only the scanlines covering it are decoded. */
+void IMB_exr_read_passes(void *handle,
+                         const char *const *passnames,
+                         int totpass,
+                         const struct rcti *region);
+void IMB_exr_read_metadata(void *handle, struct IDProperty **metadata);
 void IMB_exr_write_channels(void *handle);
 void IMB_exrtile_write_channels(
     void *handle, int partx, int party, int level, const char *viewname, bool empty);
@@ -88,6 +88,15 @@ float *IMB_exr_channel_rect(void * /*handle*/,
 void IMB_exr_read_channels(void * /*handle*/)
 {
 }
+void IMB_exr_read_passes(void * /*handle*/,
+                         const char *const * /*passnames*/,
+                         int /*totpass*/,
+                         const struct rcti * /*region*/)
+{
+}
+void IMB_exr_read_metadata(void * /*handle*/, struct IDProperty ** /*metadata*/)
+{
+}
 void IMB_exr_write_channels(void * /*handle*/)
 {
 }
@@ -531,6 +531,136 @@ static void imb_png_error(png_structp UNUSED(png_ptr), png_const_charp message)
   fprintf(stderr, "libpng error: %s\n", message);
 }
 
+/* Set up reading of palette and low bit depth gray images as 8 bit, returns the number of
+ * channels of the pixels that are read or 0 if the color type is not supported. */
+static unsigned int imb_png_read_channels(png_structp png_ptr,
+                                          png_infop info_ptr,
+                                          int *bit_depth,
+                                          int color_type)
+{
+  unsigned int channels = png_get_channels(png_ptr, info_ptr);
+
+  switch (color_type) {
+    case PNG_COLOR_TYPE_RGB:
+    case PNG_COLOR_TYPE_RGB_ALPHA:
+      break;
+    case PNG_COLOR_TYPE_PALETTE:
+      png_set_palette_to_rgb(png_ptr);
+      if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
+        channels = 4;
+      }
+      else {
+        channels = 3;
+      }
+      break;
+    case PNG_COLOR_TYPE_GRAY:
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+      if (*bit_depth < 8) {
+        png_set_expand(png_ptr);
+        *bit_depth = 8;
+        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
+          /* PNG_COLOR_TYPE_GRAY may also have alpha 'values', like with palette. */
+          channels = 2;
+        }
+      }
+      break;
+    default:
+      return 0;
+  }
+
+  return channels;
+}
+
+static void imb_png_pixels_to_float(float *to_float,
+                                    const unsigned short *from16,
+                                    size_t num_pixels,
+                                    unsigned int channels)
+{
+  switch (channels) {
+    case 4:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to_float[0] = from16[0] / 65535.0;
+        to_float[1] = from16[1] / 65535.0;
+        to_float[2] = from16[2] / 65535.0;
+        to_float[3] = from16[3] / 65535.0;
+        to_float += 4;
+        from16 += 4;
+      }
+      break;
+    case 3:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to_float[0] = from16[0] / 65535.0;
+        to_float[1] = from16[1] / 65535.0;
+        to_float[2] = from16[2] / 65535.0;
+        to_float[3] = 1.0;
+        to_float += 4;
+        from16 += 3;
+      }
+      break;
+    case 2:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
+        to_float[3] = from16[1] / 65535.0;
+        to_float += 4;
+        from16 += 2;
+      }
+      break;
+    case 1:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
+        to_float[3] = 1.0;
+        to_float += 4;
+        from16++;
+      }
+      break;
+  }
+}
+
+static void imb_png_pixels_to_byte(unsigned char *to,
+                                   const unsigned char *from,
+                                   size_t num_pixels,
+                                   unsigned int channels)
+{
+  switch (channels) {
+    case 4:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to[0] = from[0];
+        to[1] = from[1];
+        to[2] = from[2];
+        to[3] = from[3];
+        to += 4;
+        from += 4;
+      }
+      break;
+    case 3:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to[0] = from[0];
+        to[1] = from[1];
+        to[2] = from[2];
+        to[3] = 0xff;
+        to += 4;
+        from += 3;
+      }
+      break;
+    case 2:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to[0] = to[1] = to[2] = from[0];
+        to[3] = from[1];
+        to += 4;
+        from += 2;
+      }
+      break;
+    case 1:
+      for (size_t i = num_pixels; i > 0; i--) {
+        to[0] = to[1] = to[2] = from[0];
+        to[3] = 0xff;
+        to += 4;
+        from++;
+      }
+      break;
+  }
+}
+
 ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE])
 {
   struct ImBuf *ibuf = NULL;
@@ -543,9 +673,6 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
   int bit_depth, color_type;
   PNGReadStruct ps;
 
-  unsigned char *from, *to;
-  unsigned short *from16;
-  float *to_float;
   unsigned int channels;
 
   if (imb_is_a_png(mem) == 0) {
@@ -599,35 +726,10 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
   png_read_info(png_ptr, info_ptr);
   png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, NULL, NULL, NULL);
 
-  channels = png_get_channels(png_ptr, info_ptr);
-
-  switch (color_type) {
-    case PNG_COLOR_TYPE_RGB:
-    case PNG_COLOR_TYPE_RGB_ALPHA:
-      break;
-    case PNG_COLOR_TYPE_PALETTE:
-      png_set_palette_to_rgb(png_ptr);
-      if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
-        channels = 4;
-      }
-      else {
-        channels = 3;
-      }
-      break;
-    case PNG_COLOR_TYPE_GRAY:
-    case PNG_COLOR_TYPE_GRAY_ALPHA:
-      if (bit_depth < 8) {
-        png_set_expand(png_ptr);
-        bit_depth = 8;
-        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
-          /* PNG_COLOR_TYPE_GRAY may also have alpha 'values', like with palette. */
-          channels = 2;
-        }
-      }
-      break;
-    default:
-      printf("PNG format not supported\n");
-      longjmp(png_jmpbuf(png_ptr), 1);
+  channels = imb_png_read_channels(png_ptr, info_ptr, &bit_depth, color_type);
+  if (channels == 0) {
+    printf("PNG format not supported\n");
+    longjmp(png_jmpbuf(png_ptr), 1);
   }
 
   ibuf = IMB_allocImBuf(width, height, 8 * channels, 0);
@@ -683,47 +785,8 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 
       /* copy image data */
 
-      to_float = ibuf->rect_float;
-      from16 = pixels16;
-
-      switch (channels) {
-        case 4:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to_float[0] = from16[0] / 65535.0;
-            to_float[1] = from16[1] / 65535.0;
-            to_float[2] = from16[2] / 65535.0;
-            to_float[3] = from16[3] / 65535.0;
-            to_float += 4;
-            from16 += 4;
-          }
-          break;
-        case 3:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to_float[0] = from16[0] / 65535.0;
-            to_float[1] = from16[1] / 65535.0;
-            to_float[2] = from16[2] / 65535.0;
-            to_float[3] = 1.0;
-            to_float += 4;
-            from16 += 3;
-          }
-          break;
-        case 2:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
-            to_float[3] = from16[1] / 65535.0;
-            to_float += 4;
-            from16 += 2;
-          }
-          break;
-        case 1:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
-            to_float[3] = 1.0;
-            to_float += 4;
-            from16++;
-          }
-          break;
-      }
+      imb_png_pixels_to_float(
+          ibuf->rect_float, pixels16, (size_t)ibuf->x * (size_t)ibuf->y, channels);
     }
     else {
       imb_addrectImBuf(ibuf);
@@ -751,47 +814,8 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 
       /* copy image data */
 
-      to = (unsigned char *)ibuf->rect;
-      from = pixels;
-
-      switch (channels) {
-        case 4:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to[0] = from[0];
-            to[1] = from[1];
-            to[2] = from[2];
-            to[3] = from[3];
-            to += 4;
-            from += 4;
-          }
-          break;
-        case 3:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to[0] = from[0];
-            to[1] = from[1];
-            to[2] = from[2];
-            to[3] = 0xff;
-            to += 4;
-            from += 3;
-          }
-          break;
-        case 2:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to[0] = to[1] = to[2] = from[0];
-            to[3] = from[1];
-            to += 4;
-            from += 2;
-          }
-          break;
-        case 1:
-          for (size_t i = (size_t)ibuf->x * (size_t)ibuf->y; i > 0; i--) {
-            to[0] = to[1] = to[2] = from[0];
-            to[3] = 0xff;
-            to += 4;
-            from++;
-          }
-          break;
-      }
+      imb_png_pixels_to_byte(
+          (unsigned char *)ibuf->rect, pixels, (size_t)ibuf->x * (size_t)ibuf->y, channels);
     }
 
     if (flags & IB_metadata) {
@@ -821,3 +845,127 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 
   return (ibuf);
 }
+
+bool imb_loadpng_bands(const char *name,
+                       int flags,
+                       char colorspace[IM_MAX_SPACE],
+                       ImBufBandFunc band_func,
+                       void *userdata)
+{
+  png_structp png_ptr;
+  png_infop info_ptr;
+  png_bytep row = NULL;
+  ImBuf *band = NULL;
+  png_uint_32 width, height;
+  int bit_depth, color_type, interlace_type;
+  unsigned int channels;
+  unsigned char header[8];
+  bool ok = true;
+  FILE *fp;
+
+  (void)flags;
+
+  fp = BLI_fopen(name, "rb");
+  if (fp == NULL) {
+    return false;
+  }
+  if (fread(header, 1, sizeof(header), fp) != sizeof(header) || imb_is_a_png(header) == 0) {
+    fclose(fp);
+    return false;
+  }
+
+  /* both 8 and 16 bit PNGs are default to standard byte colorspace */
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+  png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (png_ptr == NULL) {
+    fclose(fp);
+    return false;
+  }
+
+  png_set_error_fn(png_ptr, NULL, imb_png_error, imb_png_warning);
+
+  info_ptr = png_create_info_struct(png_ptr);
+  if (info_ptr == NULL) {
+    png_destroy_read_struct(&png_ptr, (png_infopp)NULL, (png_infopp)NULL);
+    fclose(fp);
+    return false;
+  }
+
+  if (setjmp(png_jmpbuf(png_ptr))) {
+    /* On error jump here, and free any resources. */
+    png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp)NULL);
+    if (row) {
+      MEM_freeN(row);
+    }
+    if (band) {
+      IMB_freeImBuf(band);
+    }
+    fclose(fp);
+    return false;
+  }
+
+  png_init_io(png_ptr, fp);
+  png_set_sig_bytes(png_ptr, sizeof(header));
+
+  png_read_info(png_ptr, info_ptr);
+  png_get_IHDR(
+      png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, &interlace_type, NULL, NULL);
+
+  channels = imb_png_read_channels(png_ptr, info_ptr, &bit_depth, color_type);
+  /* Interlaced rows can only be read for the whole image at once. */
+  if (channels == 0 || interlace_type != PNG_INTERLACE_NONE) {
+    longjmp(png_jmpbuf(png_ptr), 1);
+  }
+
+  if (bit_depth == 16) {
+    png_set_swap(png_ptr);
+  }
+
+  row = MEM_mallocN((size_t)width * channels * (bit_depth == 16 ? 2 : 1), "png row");
+
+  for (int ytop = (int)height; ok && ytop > 0;) {
+    const int band_height = min_ii(IMB_BANDS_HEIGHT, ytop);
+
+    band = IMB_allocImBuf(
+        width, band_height, 8 * channels, (bit_depth == 16) ? IB_rectfloat : IB_rect);
+    if (band == NULL) {
+      printf("Couldn't allocate memory for PNG image\n");
+      longjmp(png_jmpbuf(png_ptr), 1);
+    }
+
+    band->ftype = IMB_FTYPE_PNG;
+    if (bit_depth == 16) {
+      band->foptions.flag |= PNG_16BIT;
+    }
+
+    /* Rows are stored from the top down, ImBuf rows from the bottom up. */
+    for (int y = band_height - 1; y >= 0; y--) {
+      png_read_row(png_ptr, row, NULL);
+      if (bit_depth == 16) {
+        imb_png_pixels_to_float(
+            band->rect_float + (size_t)y * width * 4, (unsigned short *)row, width, channels);
+      }
+      else {
+        imb_png_pixels_to_byte(
+            (unsigned char *)(band->rect + (size_t)y * width), row, width, channels);
+      }
+    }
+
+    ytop -= band_height;
+    ok = band_func(userdata, band, ytop, height);
+
+    IMB_freeImBuf(band);
+    band = NULL;
+  }
+
+  if (ok) {
+    png_read_end(png_ptr, info_ptr);
+  }
+
+  png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp)NULL);
+  MEM_freeN(row);
+  fclose(fp);
+
+  return ok;
+}
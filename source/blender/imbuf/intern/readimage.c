@@ -29,7 +29,10 @@
 #  include <sys/types.h>
 #endif
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_fileops.h"
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -252,6 +255,157 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
   return ibuf;
 }
 
+typedef struct ImBufBandData {
+  ImBufBandFunc band_func;
+  void *userdata;
+  int flags;
+  char *colorspace;
+  char effective_colorspace[IM_MAX_SPACE];
+  int tot_bands;
+} ImBufBandData;
+
+static bool imb_band_handle_alpha(void *userdata, ImBuf *band, int ymin, int height)
+{
+  ImBufBandData *data = userdata;
+
+  imb_handle_alpha(band, data->flags, data->colorspace, data->effective_colorspace);
+  data->tot_bands++;
+
+  return data->band_func(data->userdata, band, ymin, height);
+}
+
+/* Pass the rows of a tiled texture loaded with #IB_tilecache a row of tiles at a time. */
+static bool imb_bands_from_tiles(ImBuf *ibuf, ImBufBandFunc band_func, void *userdata)
+{
+  unsigned int *tile_rect = MEM_mallocN(sizeof(*tile_rect) * ibuf->tilex * ibuf->tiley,
+                                        __func__);
+  bool ok = true;
+
+  for (int ty = ibuf->ytiles - 1; ok && ty >= 0; ty--) {
+    const int ymin = ty * ibuf->tiley;
+    const int band_height = min_ii(ibuf->tiley, ibuf->y - ymin);
+    ImBuf *band = IMB_allocImBuf(ibuf->x, band_height, ibuf->planes, IB_rect);
+
+    if (band == NULL) {
+      ok = false;
+      break;
+    }
+
+    band->ftype = ibuf->ftype;
+    band->rect_colorspace = ibuf->rect_colorspace;
+
+    for (int tx = 0; tx < ibuf->xtiles; tx++) {
+      const int width = min_ii(ibuf->tilex, ibuf->x - tx * ibuf->tilex);
+
+      memset(tile_rect, 0, sizeof(*tile_rect) * ibuf->tilex * ibuf->tiley);
+      imb_loadtile(ibuf, tx, ty, tile_rect);
+
+      for (int y = 0; y < band_height; y++) {
+        memcpy(band->rect + (size_t)y * ibuf->x + tx * ibuf->tilex,
+               tile_rect + y * ibuf->tilex,
+               sizeof(*tile_rect) * width);
+      }
+    }
+
+    ok = band_func(userdata, band, ymin, ibuf->y);
+    IMB_freeImBuf(band);
+  }
+
+  MEM_freeN(tile_rect);
+
+  return ok;
+}
+
+/* Pass the rows of an image loaded at once, the bands point into its buffers. */
+static bool imb_bands_from_ibuf(ImBuf *ibuf, ImBufBandFunc band_func, void *userdata)
+{
+  ImBuf *band = IMB_allocImBuf(ibuf->x, min_ii(IMB_BANDS_HEIGHT, ibuf->y), ibuf->planes, 0);
+  bool ok = (band != NULL);
+
+  if (!ok) {
+    return false;
+  }
+
+  band->ftype = ibuf->ftype;
+  band->flags = ibuf->flags;
+  band->channels = ibuf->channels;
+  band->rect_colorspace = ibuf->rect_colorspace;
+  band->float_colorspace = ibuf->float_colorspace;
+
+  for (int ytop = ibuf->y; ok && ytop > 0; ytop -= band->y) {
+    const size_t offset = (size_t)(ytop - min_ii(IMB_BANDS_HEIGHT, ytop)) * ibuf->x;
+
+    band->y = min_ii(IMB_BANDS_HEIGHT, ytop);
+    band->rect = ibuf->rect ? ibuf->rect + offset : NULL;
+    band->rect_float = ibuf->rect_float ? ibuf->rect_float + offset * ibuf->channels : NULL;
+
+    ok = band_func(userdata, band, ytop - band->y, ibuf->y);
+  }
+
+  /* The buffers are owned by the image. */
+  band->rect = NULL;
+  band->rect_float = NULL;
+  IMB_freeImBuf(band);
+
+  return ok;
+}
+
+bool IMB_loadiffname_bands(const char *filepath,
+                           int flags,
+                           char colorspace[IM_MAX_SPACE],
+                           ImBufBandFunc band_func,
+                           void *userdata)
+{
+  const ImFileType *type;
+  const int filetype = IMB_ispic_type(filepath);
+  ImBuf *ibuf;
+  bool ok;
+
+  BLI_assert(!BLI_path_is_rel(filepath));
+
+  for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
+    if (type->load_filepath_bands && type->filetype == filetype) {
+      ImBufBandData data = {band_func, userdata, flags, colorspace, "", 0};
+
+      if (colorspace) {
+        BLI_strncpy(data.effective_colorspace, colorspace, sizeof(data.effective_colorspace));
+      }
+
+      if (type->load_filepath_bands(
+              filepath, flags, data.effective_colorspace, imb_band_handle_alpha, &data)) {
+        return true;
+      }
+      if (data.tot_bands != 0) {
+        return false;
+      }
+      break;
+    }
+  }
+
+#ifdef WITH_TIFF
+  /* Tiled TIFF files are read a row of tiles at a time. */
+  if (filetype == IMB_FTYPE_TIF) {
+    flags |= IB_tilecache;
+  }
+#endif
+
+  ibuf = IMB_loadiffname(filepath, flags, colorspace);
+  if (ibuf == NULL) {
+    return false;
+  }
+
+  if (ibuf->flags & IB_tilecache) {
+    ok = imb_bands_from_tiles(ibuf, band_func, userdata);
+  }
+  else {
+    ok = imb_bands_from_ibuf(ibuf, band_func, userdata);
+  }
+
+  IMB_freeImBuf(ibuf);
+
+  return ok;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
   ImBuf *ibuf;
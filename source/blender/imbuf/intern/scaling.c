@@ -22,8 +22,15 @@
  * \ingroup imbuf
  */
 
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
-#include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -906,711 +913,489 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
+  int *zbuf, *newzbuf, *_newzbuf = NULL;
+  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
   int x, y;
+  int ofsx, ofsy, stepx, stepy;
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-    if (_newrect == NULL) {
-      return (ibuf);
+  if (ibuf->zbuf) {
+    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
+    if (_newzbuf == NULL) {
+      IMB_freezbufImBuf(ibuf);
     }
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
+
+  if (ibuf->zbuf_float) {
+    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
+    if (_newzbuf_float == NULL) {
+      IMB_freezbuffloatImBuf(ibuf);
     }
   }
 
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+  if (!_newzbuf && !_newzbuf_float) {
+    return;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
+  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
+  ofsy = 32768;
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+  newzbuf = _newzbuf;
+  newzbuf_float = _newzbuf_float;
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += 4;
+  for (y = newy; y > 0; y--, ofsy += stepy) {
+    if (newzbuf) {
+      zbuf = ibuf->zbuf;
+      zbuf += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf++ = zbuf[ofsx >> 16];
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+    }
 
-        newrectf += 4;
+    if (newzbuf_float) {
+      zbuf_float = ibuf->zbuf_float;
+      zbuf_float += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf_float++ = zbuf_float[ofsx >> 16];
       }
-
-      sample -= 1.0f;
     }
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+  if (_newzbuf) {
+    IMB_freezbufImBuf(ibuf);
+    ibuf->mall |= IB_zbuf;
+    ibuf->zbuf = _newzbuf;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
-  ibuf->x = newx;
-  return (ibuf);
+  if (_newzbuf_float) {
+    IMB_freezbuffloatImBuf(ibuf);
+    ibuf->mall |= IB_zbuffloat;
+    ibuf->zbuf_float = _newzbuf_float;
+  }
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
+/* ******** resampling ******** */
+
+/* Filter kernels of IMB_resampleImBuf, x is the distance to the source pixel center in
+ * destination pixels. */
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
+static float resample_filter_box(float x)
+{
+  return (x > -0.5f && x <= 0.5f) ? 1.0f : 0.0f;
+}
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+static float resample_filter_triangle(float x)
+{
+  x = fabsf(x);
+  return (x < 1.0f) ? 1.0f - x : 0.0f;
+}
 
-  if (!do_rect && !do_float) {
-    return (ibuf);
+/* Catmull-Rom spline, sharper than the B-spline and without its blur. */
+static float resample_filter_bicubic(float x)
+{
+  const float a = -0.5f;
+  x = fabsf(x);
+  if (x < 1.0f) {
+    return ((a + 2.0f) * x - (a + 3.0f)) * x * x + 1.0f;
+  }
+  if (x < 2.0f) {
+    return (((x - 5.0f) * x + 8.0f) * x - 4.0f) * a;
   }
+  return 0.0f;
+}
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
+static float resample_sinc(float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
+  x *= (float)M_PI;
+  return sinf(x) / x;
+}
+
+static float resample_filter_lanczos(float x)
+{
+  if (x > -3.0f && x < 3.0f) {
+    return resample_sinc(x) * resample_sinc(x / 3.0f);
   }
+  return 0.0f;
+}
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
+typedef struct ResampleFilter {
+  float (*func)(float x);
+  /* Radius of the kernel in destination pixels. */
+  float support;
+} ResampleFilter;
+
+/* Indexed by eIMBResampleFilter. */
+static const ResampleFilter resample_filters[] = {
+    {resample_filter_box, 0.5f},
+    {resample_filter_triangle, 1.0f},
+    {resample_filter_bicubic, 2.0f},
+    {resample_filter_lanczos, 3.0f},
+};
 
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
+/* Weights of the source pixels of every destination pixel along one axis. */
+typedef struct ResampleWeights {
+  /* First source pixel and number of source pixels of every destination pixel. */
+  int *start;
+  int *count;
+  /* max_taps normalized weights per destination pixel. */
+  float *weights;
+  int max_taps;
+} ResampleWeights;
+
+static void resample_weights_init(ResampleWeights *rw,
+                                  int src_size,
+                                  int dst_size,
+                                  eIMBResampleFilter filter)
+{
+  /* The box filter degenerates to nearest neighbor when enlarging. */
+  if (filter == IMB_RESAMPLE_BOX && dst_size > src_size) {
+    filter = IMB_RESAMPLE_BILINEAR;
+  }
+  const ResampleFilter *rf = &resample_filters[filter];
+  const float scale = (float)src_size / (float)dst_size;
+  /* When shrinking the kernel is stretched over all source pixels covered by a destination
+   * pixel, which filters out the frequencies the destination can't represent. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = rf->support * filter_scale;
+  const int max_taps = (int)ceilf(support) * 2 + 1;
+
+  rw->start = MEM_mallocN(sizeof(int) * dst_size, "resample start");
+  rw->count = MEM_mallocN(sizeof(int) * dst_size, "resample count");
+  rw->weights = MEM_callocN(sizeof(float) * dst_size * max_taps, "resample weights");
+  rw->max_taps = max_taps;
+
+  for (int i = 0; i < dst_size; i++) {
+    const float center = (i + 0.5f) * scale;
+    int start = max_ii((int)(center - support + 0.5f), 0);
+    int end = min_ii((int)(center + support + 0.5f), src_size);
+    end = min_ii(end, start + max_taps);
+
+    float *weights = &rw->weights[i * max_taps];
+    float total = 0.0f;
+    for (int x = start; x < end; x++) {
+      weights[x - start] = rf->func((x + 0.5f - center) / filter_scale);
+      total += weights[x - start];
     }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
+
+    if (total != 0.0f) {
+      mul_vn_fl(weights, end - start, 1.0f / total);
+    }
+    else {
+      /* Only happens for degenerate sizes, fall back to the nearest pixel. */
+      start = min_ii((int)center, src_size - 1);
+      end = start + 1;
+      copy_vn_fl(weights, max_taps, 0.0f);
+      weights[0] = 1.0f;
     }
 
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+    rw->start[i] = start;
+    rw->count[i] = end - start;
+  }
+}
 
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+static void resample_weights_free(ResampleWeights *rw)
+{
+  MEM_freeN(rw->start);
+  MEM_freeN(rw->count);
+  MEM_freeN(rw->weights);
+}
 
-      sample += add;
+typedef struct ResampleThreadData {
+  const ResampleWeights *weights;
+  /* Either the byte or the float buffer is set. */
+  const unsigned char *src_byte;
+  const float *src_float;
+  unsigned char *dst_byte;
+  float *dst_float;
+  /* Row length of the source and the destination in pixels. */
+  int src_width;
+  int dst_width;
+  int channels;
+} ResampleThreadData;
+
+BLI_INLINE unsigned char resample_float_to_byte(float value)
+{
+  return (value <= 0.0f) ? 0 : ((value >= 255.0f) ? 255 : (unsigned char)(value + 0.5f));
+}
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+/* Store len values of a row in a byte buffer, rounded and clamped since the negative lobes of
+ * bicubic and Lanczos overshoot. */
+static void resample_store_row(const float *row, int len, unsigned char *dst_byte)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 min = _mm_setzero_ps();
+  const __m128 max = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; i + 4 <= len; i += 4) {
+    __m128 value = _mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&row[i]), min), max), half);
+    __m128i value_int = _mm_cvttps_epi32(value);
+    value_int = _mm_packs_epi32(value_int, value_int);
+    value_int = _mm_packus_epi16(value_int, value_int);
+    const int bytes = _mm_cvtsi128_si32(value_int);
+    memcpy(&dst_byte[i], &bytes, sizeof(bytes));
+  }
+#endif
+  for (; i < len; i++) {
+    dst_byte[i] = resample_float_to_byte(row[i]);
+  }
+}
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
+/* Horizontal pass, resamples every row of the source on its own. */
+static void resample_x_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  const ResampleThreadData *data = (const ResampleThreadData *)data_v;
+  const ResampleWeights *rw = data->weights;
+  const int channels = data->channels;
+  const int dst_len = data->dst_width * channels;
+  float *row = data->dst_float ? NULL : MEM_mallocN(sizeof(float) * dst_len, __func__);
+
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    const size_t src_offset = (size_t)y * data->src_width * channels;
+    const size_t dst_offset = (size_t)y * dst_len;
+    float *dst = data->dst_float ? &data->dst_float[dst_offset] : row;
+
+    for (int x = 0; x < data->dst_width; x++) {
+      const float *weights = &rw->weights[x * rw->max_taps];
+      const int count = rw->count[x];
+      const size_t start = src_offset + (size_t)rw->start[x] * channels;
+      float *pixel = &dst[x * channels];
+
+#ifdef __SSE2__
+      if (channels == 4) {
+        __m128 sum = _mm_setzero_ps();
+        if (data->src_byte) {
+          const __m128i zero = _mm_setzero_si128();
+          const unsigned char *src = &data->src_byte[start];
+          for (int k = 0; k < count; k++, src += 4) {
+            int bytes;
+            memcpy(&bytes, src, sizeof(bytes));
+            __m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+            value = _mm_unpacklo_epi16(value, zero);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(weights[k])));
+          }
         }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+        else {
+          const float *src = &data->src_float[start];
+          for (int k = 0; k < count; k++, src += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(weights[k])));
+          }
         }
+        _mm_storeu_ps(pixel, sum);
+        continue;
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
+#endif
+
+      copy_vn_fl(pixel, channels, 0.0f);
+      for (int k = 0; k < count; k++) {
+        const size_t offset = start + (size_t)k * channels;
+        for (int ch = 0; ch < channels; ch++) {
+          const float value = data->src_byte ? (float)data->src_byte[offset + ch] :
+                                               data->src_float[offset + ch];
+          pixel[ch] += value * weights[k];
+        }
       }
+    }
 
-      sample -= 1.0f;
+    if (row) {
+      resample_store_row(row, dst_len, &data->dst_byte[dst_offset]);
     }
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+  if (row) {
+    MEM_freeN(row);
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return (ibuf);
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/* Vertical pass, every destination row is a weighted sum of whole source rows. */
+static void resample_y_thread_do(void *data_v, int start_scanline, int num_scanlines)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return (NULL);
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
-  }
+  const ResampleThreadData *data = (const ResampleThreadData *)data_v;
+  const ResampleWeights *rw = data->weights;
+  const int len = data->dst_width * data->channels;
+  float *row = data->dst_float ? NULL : MEM_mallocN(sizeof(float) * len, __func__);
+
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    const float *weights = &rw->weights[y * rw->max_taps];
+    const size_t dst_offset = (size_t)y * len;
+    float *dst = data->dst_float ? &data->dst_float[dst_offset] : row;
+
+    memset(dst, 0, sizeof(float) * len);
+    for (int k = 0; k < rw->count[y]; k++) {
+      const size_t src_offset = (size_t)(rw->start[y] + k) * len;
+      const float weight = weights[k];
+      int i = 0;
+
+      if (data->src_byte) {
+        const unsigned char *src = &data->src_byte[src_offset];
+        for (; i < len; i++) {
+          dst[i] += (float)src[i] * weight;
+        }
+        continue;
+      }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+      const float *src = &data->src_float[src_offset];
+#ifdef __SSE2__
+      const __m128 weight_v = _mm_set1_ps(weight);
+      for (; i + 4 <= len; i += 4) {
+        const __m128 value = _mm_mul_ps(_mm_loadu_ps(&src[i]), weight_v);
+        _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_loadu_ps(&dst[i]), value));
+      }
+#endif
+      for (; i < len; i++) {
+        dst[i] += src[i] * weight;
       }
-      return (ibuf);
     }
-  }
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
+    if (row) {
+      resample_store_row(row, len, &data->dst_byte[dst_offset]);
     }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
+  }
 
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
-    }
+  if (row) {
+    MEM_freeN(row);
   }
+}
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+static void resample_apply(ResampleThreadData *data, ScanlineThreadFunc do_thread, int height)
+{
+  if (((size_t)data->dst_width) * height < 64 * 64) {
+    do_thread(data, 0, height);
   }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  else {
+    IMB_processor_apply_threaded_scanlines(height, do_thread, data);
   }
+}
 
-  ibuf->x = newx;
-  return (ibuf);
+/**
+ * Resample a byte or float buffer in a horizontal and a vertical pass.
+ * \return the new buffer, NULL when it couldn't be allocated.
+ */
+static void *resample_buffer(const unsigned char *src_byte,
+                             const float *src_float,
+                             int width,
+                             int height,
+                             int channels,
+                             int newx,
+                             int newy,
+                             eIMBResampleFilter filter)
+{
+  const size_t dst_len = (size_t)newx * newy * channels;
+  void *dst = src_byte ? MEM_mallocN(sizeof(unsigned char) * dst_len, "resample byte buffer") :
+                         MEM_mallocN(sizeof(float) * dst_len, "resample float buffer");
+  float *temp = NULL;
+  if (dst == NULL) {
+    return NULL;
+  }
+
+  /* Resampling the rows first leaves fewer pixels for the vertical pass when shrinking. */
+  if (newx != width && newy != height) {
+    temp = MEM_mallocN(sizeof(float) * newx * height * channels, "resample temp buffer");
+    if (temp == NULL) {
+      MEM_freeN(dst);
+      return NULL;
+    }
+  }
+
+  ResampleThreadData data = {NULL};
+  ResampleWeights weights;
+  data.channels = channels;
+
+  if (newx != width) {
+    resample_weights_init(&weights, width, newx, filter);
+    data.weights = &weights;
+    data.src_byte = src_byte;
+    data.src_float = src_float;
+    data.dst_byte = (temp || src_float) ? NULL : dst;
+    data.dst_float = temp ? temp : (src_float ? dst : NULL);
+    data.src_width = width;
+    data.dst_width = newx;
+    resample_apply(&data, resample_x_thread_do, height);
+    resample_weights_free(&weights);
+  }
+
+  if (newy != height) {
+    resample_weights_init(&weights, height, newy, filter);
+    data.weights = &weights;
+    data.src_byte = temp ? NULL : src_byte;
+    data.src_float = temp ? temp : src_float;
+    data.dst_byte = src_float ? NULL : dst;
+    data.dst_float = src_float ? dst : NULL;
+    data.src_width = newx;
+    data.dst_width = newx;
+    resample_apply(&data, resample_y_thread_do, newy);
+    resample_weights_free(&weights);
+  }
+
+  if (temp) {
+    MEM_freeN(temp);
+  }
+  return dst;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_resampleImBuf(struct ImBuf *ibuf,
+                       unsigned int newx,
+                       unsigned int newy,
+                       eIMBResampleFilter filter)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
   if (ibuf == NULL) {
-    return (NULL);
+    return false;
   }
   if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
+    return false;
+  }
+
+  /* A size of zero keeps the size of that axis. */
+  newx = newx ? newx : ibuf->x;
+  newy = newy ? newy : ibuf->y;
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
   }
 
+  unsigned char *newrect = NULL;
+  float *newrectf = NULL;
   if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return (ibuf);
+    newrect = resample_buffer(
+        (unsigned char *)ibuf->rect, NULL, ibuf->x, ibuf->y, 4, newx, newy, filter);
+    if (newrect == NULL) {
+      return false;
     }
   }
   if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
+    newrectf = resample_buffer(
+        NULL, ibuf->rect_float, ibuf->x, ibuf->y, ibuf->channels, newx, newy, filter);
+    if (newrectf == NULL) {
+      MEM_SAFE_FREE(newrect);
+      return false;
     }
   }
 
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
-
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 2 * skipx;
-    }
-
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
-  }
+  scalefast_Z_ImBuf(ibuf, newx, newy);
 
-  if (do_rect) {
+  if (newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)newrect;
   }
-  if (do_float) {
+  if (newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = newrectf;
   }
-
+  ibuf->x = newx;
   ibuf->y = newy;
-  return (ibuf);
-}
-
-static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
-{
-  int *zbuf, *newzbuf, *_newzbuf = NULL;
-  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
-  int x, y;
-  int ofsx, ofsy, stepx, stepy;
-
-  if (ibuf->zbuf) {
-    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
-    if (_newzbuf == NULL) {
-      IMB_freezbufImBuf(ibuf);
-    }
-  }
-
-  if (ibuf->zbuf_float) {
-    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
-    if (_newzbuf_float == NULL) {
-      IMB_freezbuffloatImBuf(ibuf);
-    }
-  }
 
-  if (!_newzbuf && !_newzbuf_float) {
-    return;
-  }
-
-  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
-  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
-  ofsy = 32768;
-
-  newzbuf = _newzbuf;
-  newzbuf_float = _newzbuf_float;
-
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (newzbuf) {
-      zbuf = ibuf->zbuf;
-      zbuf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf++ = zbuf[ofsx >> 16];
-      }
-    }
-
-    if (newzbuf_float) {
-      zbuf_float = ibuf->zbuf_float;
-      zbuf_float += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf_float++ = zbuf_float[ofsx >> 16];
-      }
-    }
-  }
-
-  if (_newzbuf) {
-    IMB_freezbufImBuf(ibuf);
-    ibuf->mall |= IB_zbuf;
-    ibuf->zbuf = _newzbuf;
-  }
-
-  if (_newzbuf_float) {
-    IMB_freezbuffloatImBuf(ibuf);
-    ibuf->mall |= IB_zbuffloat;
-    ibuf->zbuf_float = _newzbuf_float;
-  }
+  return true;
 }
 
 /**
@@ -1618,41 +1403,14 @@ static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  if (ibuf == NULL) {
-    return false;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return false;
-  }
-
-  if (newx == ibuf->x && newy == ibuf->y) {
-    return false;
-  }
-
-  /* Scale-up / scale-down functions below change ibuf->x and ibuf->y
-   * so we first scale the Z-buffer (if any). */
-  scalefast_Z_ImBuf(ibuf, newx, newy);
-
   /* try to scale common cases in a fast way */
   /* disabled, quality loss is unacceptable, see report #18609  (ton) */
   if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
     return true;
   }
 
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
-  }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
-  }
-
-  return true;
+  /* Averages the covered pixels when shrinking, interpolates linearly when enlarging. */
+  return IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_BOX);
 }
 
 struct imbufRGBA {
@@ -1760,117 +1518,7 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
 
 /* ******** threaded scaling ******** */
 
-typedef struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleTreadInitData;
-
-typedef struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  int start_line;
-  int tot_line;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleThreadData;
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = (float)ibuf->x / data->newx;
-  float factor_y = (float)ibuf->y / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = (float)x * factor_x;
-      float v = (float)y * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        unsigned char *pixel = data->byte_buffer + 4 * offset;
-        BLI_bilinear_interpolation_char(
-            (unsigned char *)ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        BLI_bilinear_interpolation_fl(
-            ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return NULL;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  ScaleTreadInitData init_data = {NULL};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->rect) {
-    init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char),
-                                        "threaded scale byte buffer");
-  }
-
-  if (ibuf->rect_float) {
-    init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float),
-                                         "threaded scale float buffer");
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)init_data.byte_buffer;
-  }
-
-  if (ibuf->rect_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = init_data.float_buffer;
-  }
+  IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_BILINEAR);
 }
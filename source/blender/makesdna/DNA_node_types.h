@@ -449,7 +449,8 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Memory limit in megabytes for compositor results kept between executions. */
+  int cache_limit;
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -519,6 +520,8 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_BUFFERED (1 << 6) /* evaluate pixel-wise operations per area */
+#define NTREE_COM_HALF_BUFFERS (1 << 7) /* store intermediate color buffers as half floats */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
@@ -873,7 +873,8 @@ typedef struct UserDef {
   int sequencer_disk_cache_compression; /* eUserpref_DiskCacheCompression */
   int sequencer_disk_cache_size_limit;
   short sequencer_disk_cache_flag;
-  char _pad5[2];
+  /** Number of strips to build proxies for at the same time, 0 for one per thread. */
+  short sequencer_proxy_build_threads;
 
   float collection_instance_empty_size;
   char _pad10[4];
@@ -9839,6 +9839,30 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
                            "Use two pass execution during editing: first calculate fast nodes, "
                            "second pass calculate all nodes");
 
+  prop = RNA_def_property(srna, "use_buffered_execution", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_BUFFERED);
+  RNA_def_property_ui_text(prop,
+                           "Buffered Execution",
+                           "Evaluate pixel-wise nodes a whole tile at a time instead of pulling "
+                           "every pixel through the node tree");
+
+  prop = RNA_def_property(srna, "use_half_buffers", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_HALF_BUFFERS);
+  RNA_def_property_ui_text(prop,
+                           "Half Float Buffers",
+                           "Store intermediate color results as half floats and value results "
+                           "without converting them to color, uses less memory at a lower "
+                           "precision");
+
+  prop = RNA_def_property(srna, "cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "cache_limit");
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 0, 16384, 256, -1);
+  RNA_def_property_ui_text(prop,
+                           "Cache Limit",
+                           "Memory in megabytes used to keep node results between executions, "
+                           "so only nodes affected by a change are recalculated (0 disables)");
+
   prop = RNA_def_property(srna, "use_viewer_border", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_VIEWER_BORDER);
   RNA_def_property_ui_text(
@@ -30,6 +30,7 @@
 
 #include "BLI_math_base.h"
 #include "BLI_math_rotation.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -5288,6 +5289,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "Disk Cache Compression Level",
       "Smaller compression will result in larger files, but less decoding overhead");
 
+  prop = RNA_def_property(srna, "sequencer_proxy_build_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "sequencer_proxy_build_threads");
+  RNA_def_property_range(prop, 0, BLENDER_MAX_THREADS);
+  RNA_def_property_ui_text(prop,
+                           "Proxy Build Threads",
+                           "Number of strips to build proxies for at the same time "
+                           "(0 to use one per available thread)");
+
   prop = RNA_def_property(srna, "scrollback", PROP_INT, PROP_UNSIGNED);
   RNA_def_property_int_sdna(prop, NULL, "scrollback");
   RNA_def_property_range(prop, 32, 32768);
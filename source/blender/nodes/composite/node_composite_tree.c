@@ -310,6 +310,10 @@ void ntreeCompositTagRender(Scene *curscene)
    * This is still rather weak though,
    * ideally render struct would store own main AND original G_MAIN. */
 
+  /* The render result of the scene changed, results cached by the compositor can't be used
+   * anymore. */
+  BKE_node_id_update_generation_bump(&curscene->id);
+
   for (sce = G_MAIN->scenes.first; sce; sce = sce->id.next) {
     if (sce->nodetree) {
       bNode *node;
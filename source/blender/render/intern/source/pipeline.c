@@ -1277,6 +1277,9 @@ static void render_scene(Render *re, Scene *sce, int cfra)
   resc->suh = re->suh;
 
   do_render(resc);
+
+  /* Results the compositor cached for the render layers of this scene are outdated. */
+  BKE_node_id_update_generation_bump(&sce->id);
 }
 
 /* helper call to detect if this scene needs a render,
@@ -770,7 +770,8 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
+      /* Passes of lazily read files have no buffer yet. */
+      if (rpass->channels >= 3 && rpass->rect != NULL) {
         IMB_colormanagement_transform(rpass->rect,
                                       rpass->rectx,
                                       rpass->recty,
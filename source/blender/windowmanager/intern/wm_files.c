@@ -92,6 +92,8 @@
 #include "BLO_undofile.h" /* to save from an undo memfile */
 #include "BLO_writefile.h"
 
+#include "COM_compositor.h"
+
 #include "RNA_access.h"
 #include "RNA_define.h"
 
@@ -556,6 +558,11 @@ static void wm_file_read_post(bContext *C,
   if (use_data) {
     WM_operatortype_last_properties_clear_all();
 
+#ifdef WITH_COMPOSITOR
+    /* Cached compositor results refer to data of the previous file. */
+    COM_clearCaches();
+#endif
+
     /* After load post, so for example the driver namespace can be filled
      * before evaluating the depsgraph. */
     wm_event_do_depsgraph(C, true);
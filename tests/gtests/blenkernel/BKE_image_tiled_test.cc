@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_threads.h"
+
+#include "BKE_appdir.h"
+#include "BKE_image.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Not a multiple of the tile size, to cover partial tiles. */
+#define WIDTH 150
+#define HEIGHT 100
+
+class ImageTiledTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    IMB_init();
+    BKE_tempdir_init(NULL);
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_image_tiled_cache_free();
+    IMB_exit();
+    BLI_threadapi_exit();
+  }
+
+ protected:
+  /* Write a test image, returns the image as it loads from the file. */
+  ImBuf *write_image(const char *filename,
+                     bool is_float,
+                     char r_filepath[FILE_MAX],
+                     eImbTypes ftype = IMB_FTYPE_PNG)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(WIDTH, HEIGHT, 32, is_float ? IB_rectfloat : IB_rect);
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+        const size_t offset = ((size_t)y * WIDTH + x) * 4;
+        if (is_float) {
+          float *pixel = ibuf->rect_float + offset;
+          pixel[0] = x * 0.005f;
+          pixel[1] = y * 0.01f;
+          pixel[2] = ((x ^ y) & 15) / 16.0f;
+          pixel[3] = 1.0f;
+        }
+        else {
+          unsigned char *pixel = (unsigned char *)ibuf->rect + offset;
+          pixel[0] = x;
+          pixel[1] = y * 2;
+          pixel[2] = (x ^ y) & 255;
+          pixel[3] = 255 - y;
+        }
+      }
+    }
+
+    /* 16 bit PNG files load as float images. */
+    ibuf->ftype = ftype;
+    ibuf->foptions.flag = (is_float && ftype == IMB_FTYPE_PNG) ? PNG_16BIT : 0;
+    BLI_join_dirfile(r_filepath, FILE_MAX, BKE_tempdir_base(), filename);
+    EXPECT_TRUE(IMB_saveiff(ibuf, r_filepath, is_float ? IB_rectfloat : IB_rect));
+    IMB_freeImBuf(ibuf);
+
+    char colorspace[IM_MAX_SPACE] = "";
+    return IMB_loadiffname(r_filepath, IB_rect, colorspace);
+  }
+
+  void test_read(const char *filename, bool is_float, eImbTypes ftype = IMB_FTYPE_PNG)
+  {
+    char filepath[FILE_MAX];
+    ImBuf *ibuf = write_image(filename, is_float, filepath, ftype);
+    ASSERT_NE(ibuf, (ImBuf *)NULL);
+
+    ImageTiledTexture *texture = BKE_image_tiled_acquire_file(filepath, "");
+    ASSERT_NE(texture, (ImageTiledTexture *)NULL);
+
+    EXPECT_EQ(BKE_image_tiled_levels(texture), 8);
+    int width, height;
+    BKE_image_tiled_size(texture, 0, &width, &height);
+    EXPECT_EQ(width, WIDTH);
+    EXPECT_EQ(height, HEIGHT);
+    BKE_image_tiled_size(texture, 1, &width, &height);
+    EXPECT_EQ(width, WIDTH / 2);
+    EXPECT_EQ(height, HEIGHT / 2);
+    BKE_image_tiled_size(texture, 7, &width, &height);
+    EXPECT_EQ(width, 1);
+    EXPECT_EQ(height, 1);
+
+    float *rect = (float *)MEM_mallocN(sizeof(float[4]) * WIDTH * HEIGHT, __func__);
+    BKE_image_tiled_read_rect(texture, 0, 0, 0, WIDTH, HEIGHT, rect);
+    for (size_t i = 0; i < (size_t)WIDTH * HEIGHT * 4; i++) {
+      const float expected = is_float ? ibuf->rect_float[i] :
+                                        ((unsigned char *)ibuf->rect)[i] / 255.0f;
+      EXPECT_NEAR(rect[i], expected, 1e-6f);
+    }
+
+    /* Pixel centers are not interpolated. */
+    const int x = 97, y = 65;
+    float color[4];
+    BKE_image_tiled_sample(texture, (x + 0.5f) / WIDTH, (y + 0.5f) / HEIGHT, 0.0f, color);
+    for (int i = 0; i < 4; i++) {
+      EXPECT_NEAR(color[i], rect[((size_t)y * WIDTH + x) * 4 + i], 1e-5f);
+    }
+
+    /* Levels match halving the whole image, though the file is converted in bands. */
+    ImBuf *ibuf_level = IMB_dupImBuf(ibuf);
+    for (int level = 1; level < BKE_image_tiled_levels(texture); level++) {
+      ImBuf *ibuf_half = IMB_onehalf(ibuf_level);
+      IMB_freeImBuf(ibuf_level);
+      ibuf_level = ibuf_half;
+
+      BKE_image_tiled_size(texture, level, &width, &height);
+      ASSERT_EQ(width, ibuf_level->x);
+      ASSERT_EQ(height, ibuf_level->y);
+
+      BKE_image_tiled_read_rect(texture, level, 0, 0, width, height, rect);
+      for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+        const float expected = is_float ? ibuf_level->rect_float[i] :
+                                          ((unsigned char *)ibuf_level->rect)[i] / 255.0f;
+        EXPECT_NEAR(rect[i], expected, 1e-6f) << "level " << level;
+      }
+    }
+    IMB_freeImBuf(ibuf_level);
+
+    MEM_freeN(rect);
+    BKE_image_tiled_release(texture);
+    IMB_freeImBuf(ibuf);
+    BLI_delete(filepath, false, false);
+  }
+};
+
+TEST_F(ImageTiledTest, ReadByte)
+{
+  test_read("tiled_test_byte.png", false);
+}
+
+TEST_F(ImageTiledTest, ReadFloat)
+{
+  test_read("tiled_test_float.png", true);
+}
+
+/* Formats which can't be read in bands are loaded at once and split. */
+TEST_F(ImageTiledTest, ReadByteWhole)
+{
+  test_read("tiled_test_byte.tga", false, IMB_FTYPE_TGA);
+}
+
+TEST_F(ImageTiledTest, MemoryLimit)
+{
+  char filepath[FILE_MAX];
+  ImBuf *ibuf = write_image("tiled_test_limit.png", false, filepath);
+  IMB_freeImBuf(ibuf);
+
+  /* Room for three byte tiles. */
+  const size_t limit = 3 * 64 * 64 * 4;
+  BKE_image_tiled_cache_limit_set(limit);
+
+  ImageTiledTexture *texture = BKE_image_tiled_acquire_file(filepath, "");
+  ASSERT_NE(texture, (ImageTiledTexture *)NULL);
+
+  float *rect = (float *)MEM_mallocN(sizeof(float[4]) * WIDTH * HEIGHT, __func__);
+  for (int level = 0; level < BKE_image_tiled_levels(texture); level++) {
+    int width, height;
+    BKE_image_tiled_size(texture, level, &width, &height);
+    BKE_image_tiled_read_rect(texture, level, 0, 0, width, height, rect);
+    EXPECT_LE(BKE_image_tiled_cache_memory_in_use(), limit);
+  }
+  MEM_freeN(rect);
+
+  BKE_image_tiled_release(texture);
+  BKE_image_tiled_cache_limit_set((size_t)1024 * 1024 * 1024);
+  BLI_delete(filepath, false, false);
+}
@@ -0,0 +1,149 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+#include "bmesh.h"
+
+extern "C" {
+#include "tools/bmesh_intersect.h"
+
+#include "PIL_time.h"
+}
+
+#define BM_FACE_TAG BM_ELEM_DRAW
+
+class BMeshIntersectTest : public testing::Test {
+ public:
+  /* Overlapping triangle pairs are found with a threaded BVH traversal. */
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+  }
+};
+
+static BMesh *bm_new()
+{
+  BMeshCreateParams bm_params = {0};
+  bm_params.use_toolflags = true;
+  return BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+}
+
+static void bm_add_sphere(BMesh *bm, int segments, int rings, float diameter, const float co[3])
+{
+  float mat[4][4];
+  unit_m4(mat);
+  copy_v3_v3(mat[3], co);
+  BMO_op_callf(bm,
+               BMO_FLAG_DEFAULTS,
+               "create_uvsphere u_segments=%i v_segments=%i diameter=%f matrix=%m4 calc_uvs=%b",
+               segments,
+               rings,
+               diameter,
+               mat,
+               false);
+}
+
+/* Faces added after this are the second operand, like the boolean modifier. */
+static void bm_tag_operand(BMesh *bm)
+{
+  BMIter iter;
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    BM_elem_flag_set(f, BM_FACE_TAG, !BM_elem_flag_test(f, BM_FACE_TAG));
+  }
+}
+
+/* Booleans of closed meshes should give closed meshes. */
+static bool bm_is_manifold(BMesh *bm)
+{
+  BMIter iter;
+  BMEdge *e;
+  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+    if (!BM_edge_is_manifold(e)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int bm_face_isect_pair(BMFace *f, void *UNUSED(user_data))
+{
+  return BM_elem_flag_test(f, BM_FACE_TAG) ? 0 : 1;
+}
+
+static bool bm_boolean(BMesh *bm, int boolean_mode)
+{
+  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+  BMLoop *(*looptris)[3] = (BMLoop * (*)[3])
+      MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
+  int tottri;
+  BM_mesh_calc_tessellation_beauty(bm, looptris, &tottri);
+
+  const bool changed = BM_mesh_intersect(bm,
+                                         looptris,
+                                         tottri,
+                                         bm_face_isect_pair,
+                                         NULL,
+                                         false,
+                                         false,
+                                         true,
+                                         true,
+                                         false,
+                                         false,
+                                         boolean_mode,
+                                         1e-6f);
+  MEM_freeN(looptris);
+  return changed;
+}
+
+TEST_F(BMeshIntersectTest, SphereDifference)
+{
+  BMesh *bm = bm_new();
+  const float co_a[3] = {0.0f, 0.0f, 0.0f};
+  const float co_b[3] = {0.5f, 0.3f, 0.2f};
+  bm_add_sphere(bm, 32, 16, 2.0f, co_a);
+  bm_tag_operand(bm);
+  bm_add_sphere(bm, 24, 12, 1.5f, co_b);
+
+  EXPECT_TRUE(bm_boolean(bm, BMESH_ISECT_BOOLEAN_DIFFERENCE));
+  EXPECT_TRUE(bm_is_manifold(bm));
+  EXPECT_EQ(bm->totvert, 749);
+  EXPECT_EQ(bm->totedge, 1519);
+  EXPECT_EQ(bm->totface, 772);
+
+  BM_mesh_free(bm);
+}
+
+TEST_F(BMeshIntersectTest, DenseCutterPerformance)
+{
+  BMesh *bm = bm_new();
+  const float co_a[3] = {0.0f, 0.0f, 0.0f};
+  const float co_b[3] = {0.6f, 0.1f, 0.0f};
+  bm_add_sphere(bm, 64, 32, 2.0f, co_a);
+  bm_tag_operand(bm);
+  bm_add_sphere(bm, 256, 128, 1.6f, co_b);
+  const int totface_orig = bm->totface;
+
+  const double start_time = PIL_check_seconds_timer();
+  EXPECT_TRUE(bm_boolean(bm, BMESH_ISECT_BOOLEAN_DIFFERENCE));
+  const double seconds = PIL_check_seconds_timer() - start_time;
+
+  EXPECT_TRUE(bm_is_manifold(bm));
+  EXPECT_EQ(bm->totface, 29386);
+  printf("\t%d faces: %fs\n", totface_orig, seconds);
+
+  BM_mesh_free(bm);
+}
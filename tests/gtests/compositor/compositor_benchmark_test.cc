@@ -0,0 +1,688 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+/* Headless compositor benchmark.
+ *
+ * Builds representative node trees on a generated input image, executes them the way a final
+ * render does and reports the time and peak memory of every execution as one JSON object per
+ * line, for tracking performance over time. Every tree is executed in all execution modes, the
+ * results of the modes are compared against the default tiled execution. Trees that have a
+ * reference implementation also have their tiled result compared against it.
+ *
+ * Resolutions, trees, threads and repetitions are set with command line flags, for example:
+ *   compositor_test --resolutions=1080p,4k --threads=8 --repeat=3 --output=benchmark.json
+ *   compositor_test --resolutions=4k --cases=grading,mix_math
+ */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_appdir.h"
+#include "BKE_blender.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_genfile.h" /* for DNA_sdna_current_init() */
+#include "DNA_image_types.h"
+#include "DNA_material_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#include "NOD_composite.h"
+
+#include "PIL_time.h"
+
+#include "RE_pipeline.h"
+
+#include "RNA_define.h"
+}
+
+#include "COM_compositor.h"
+
+DEFINE_string(resolutions, "1080p", "Comma separated input resolutions: 1080p, 4k or WxH.");
+DEFINE_int32(threads, 0, "Number of compositor threads, 0 uses all system threads.");
+DEFINE_int32(repeat, 1, "Number of executions per tree and mode, the fastest one is reported.");
+DEFINE_string(output, "", "Append the results as JSON lines to this file.");
+DEFINE_string(cases, "", "Comma separated names of the trees to execute, all trees when empty.");
+DEFINE_bool(operation_times, false, "Print the execution time per operation of the fastest run.");
+
+typedef void (*BuildTreeFn)(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite);
+/* Computes the expected composite pixel of a tree from its input image pixel. */
+typedef void (*ReferencePixelFn)(const float input[4], float r_output[4]);
+
+typedef struct ExecutionMode {
+  const char *name;
+  int flag;
+  /* Largest allowed difference with the tiled result, relative to the value. */
+  float max_error;
+  /* Largest allowed average difference with the tiled result. */
+  float mean_error;
+} ExecutionMode;
+
+static const ExecutionMode execution_modes[] = {
+    {"tiled", 0, 0.0f, 0.0f},
+    /* Chains of pixel-wise operations are fused in buffered execution. */
+    {"buffered", NTREE_COM_BUFFERED, 1e-4f, 1e-5f},
+    /* Half floats have 11 bits of precision, a relative error of 2^-11 per rounding. */
+    {"half_buffers", NTREE_COM_HALF_BUFFERS, 1e-3f, 2e-4f},
+};
+
+/* Tolerance of the tiled result against a reference computed in the test, only the order of the
+ * float operations may differ. */
+static const ExecutionMode reference_mode = {"reference", 0, 1e-5f, 1e-6f};
+
+static int dummy_test_break(void * /*handle*/)
+{
+  return 0;
+}
+
+static void dummy_progress(void * /*handle*/, float /*progress*/)
+{
+}
+
+static void dummy_stats_draw(void * /*handle*/, const char * /*str*/)
+{
+}
+
+static bNode *add_node(bNodeTree *ntree, int type)
+{
+  return nodeAddStaticNode(NULL, ntree, type);
+}
+
+static bNodeSocket *input(bNode *node, const char *identifier)
+{
+  bNodeSocket *socket = nodeFindSocket(node, SOCK_IN, identifier);
+  BLI_assert(socket);
+  return socket;
+}
+
+static bNodeSocket *output(bNode *node, const char *identifier)
+{
+  bNodeSocket *socket = nodeFindSocket(node, SOCK_OUT, identifier);
+  BLI_assert(socket);
+  return socket;
+}
+
+static bNode *socket_node(bNodeTree *ntree, bNodeSocket *socket)
+{
+  bNode *node;
+  nodeFindNode(ntree, socket, &node, NULL);
+  return node;
+}
+
+static void link(bNodeTree *ntree, bNodeSocket *from, bNodeSocket *to)
+{
+  nodeAddLink(ntree, socket_node(ntree, from), from, socket_node(ntree, to), to);
+}
+
+static void set_input_color(bNode *node, const char *identifier, const float color[4])
+{
+  copy_v4_v4(((bNodeSocketValueRGBA *)input(node, identifier)->default_value)->value, color);
+}
+
+static void set_input_value(bNode *node, const char *identifier, float value)
+{
+  ((bNodeSocketValueFloat *)input(node, identifier)->default_value)->value = value;
+}
+
+/* The input image as is, to get the input pixels of the reference implementations. */
+static void build_passthrough(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  link(ntree, image, composite);
+}
+
+/* Gaussian, fast gaussian and bokeh blurs after each other. */
+static void build_blur_stack(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  bNode *gauss = add_node(ntree, CMP_NODE_BLUR);
+  NodeBlurData *gauss_data = (NodeBlurData *)gauss->storage;
+  gauss_data->filtertype = R_FILTER_GAUSS;
+  gauss_data->sizex = gauss_data->sizey = 16;
+
+  bNode *fast_gauss = add_node(ntree, CMP_NODE_BLUR);
+  NodeBlurData *fast_gauss_data = (NodeBlurData *)fast_gauss->storage;
+  fast_gauss_data->filtertype = R_FILTER_FAST_GAUSS;
+  fast_gauss_data->sizex = fast_gauss_data->sizey = 48;
+
+  bNode *bokeh = add_node(ntree, CMP_NODE_BLUR);
+  NodeBlurData *bokeh_data = (NodeBlurData *)bokeh->storage;
+  bokeh_data->bokeh = 1;
+  bokeh_data->sizex = bokeh_data->sizey = 24;
+
+  link(ntree, image, input(gauss, "Image"));
+  link(ntree, output(gauss, "Image"), input(fast_gauss, "Image"));
+  link(ntree, output(fast_gauss, "Image"), input(bokeh, "Image"));
+  link(ntree, output(bokeh, "Image"), composite);
+}
+
+/* Fog glow followed by streaks. */
+static void build_glare(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  bNode *fog_glow = add_node(ntree, CMP_NODE_GLARE);
+  NodeGlare *fog_glow_data = (NodeGlare *)fog_glow->storage;
+  fog_glow_data->type = 3;
+  fog_glow_data->size = 9;
+  fog_glow_data->threshold = 0.5f;
+
+  bNode *streaks = add_node(ntree, CMP_NODE_GLARE);
+  NodeGlare *streaks_data = (NodeGlare *)streaks->storage;
+  streaks_data->type = 2;
+  streaks_data->threshold = 0.5f;
+
+  link(ntree, image, input(fog_glow, "Image"));
+  link(ntree, output(fog_glow, "Image"), input(streaks, "Image"));
+  link(ntree, output(streaks, "Image"), composite);
+}
+
+/* Variable size bokeh blur, the red channel is used as blur radius. */
+static void build_defocus(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  bNode *separate = add_node(ntree, CMP_NODE_SEPRGBA);
+  bNode *defocus = add_node(ntree, CMP_NODE_DEFOCUS);
+  NodeDefocus *defocus_data = (NodeDefocus *)defocus->storage;
+  defocus_data->bktype = 6;
+  defocus_data->maxblur = 32.0f;
+  defocus_data->scale = 32.0f;
+  defocus_data->no_zbuf = 1;
+
+  link(ntree, image, input(separate, "Image"));
+  link(ntree, image, input(defocus, "Image"));
+  link(ntree, output(separate, "R"), input(defocus, "Z"));
+  link(ntree, output(defocus, "Image"), composite);
+}
+
+static void build_keying(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  const float key_color[4] = {0.2f, 0.8f, 0.2f, 1.0f};
+  bNode *keying = add_node(ntree, CMP_NODE_KEYING);
+  set_input_color(keying, "Key Color", key_color);
+
+  link(ntree, image, input(keying, "Image"));
+  link(ntree, output(keying, "Image"), composite);
+}
+
+/* Vector blur with the image as speed and the green channel as depth. */
+static void build_vector_blur(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  const float speed_scale[4] = {8.0f, 8.0f, 8.0f, 8.0f};
+  bNode *separate = add_node(ntree, CMP_NODE_SEPRGBA);
+  bNode *speed = add_node(ntree, CMP_NODE_MIX_RGB);
+  speed->custom1 = MA_RAMP_MULT;
+  set_input_color(speed, "Image_001", speed_scale);
+  bNode *vector_blur = add_node(ntree, CMP_NODE_VECBLUR);
+
+  link(ntree, image, input(separate, "Image"));
+  link(ntree, image, input(speed, "Image"));
+  link(ntree, image, input(vector_blur, "Image"));
+  link(ntree, output(separate, "G"), input(vector_blur, "Z"));
+  link(ntree, output(speed, "Image"), input(vector_blur, "Speed"));
+  link(ntree, output(vector_blur, "Image"), composite);
+}
+
+/* A chain of pixel-wise color corrections. */
+static void build_grading(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  bNode *color_balance = add_node(ntree, CMP_NODE_COLORBALANCE);
+  bNode *curves = add_node(ntree, CMP_NODE_CURVE_RGB);
+  bNode *hue_saturation = add_node(ntree, CMP_NODE_HUE_SAT);
+  set_input_value(hue_saturation, "Saturation", 1.2f);
+  bNode *gamma = add_node(ntree, CMP_NODE_GAMMA);
+  set_input_value(gamma, "Gamma", 0.8f);
+  bNode *bright_contrast = add_node(ntree, CMP_NODE_BRIGHTCONTRAST);
+  set_input_value(bright_contrast, "Contrast", 10.0f);
+
+  link(ntree, image, input(color_balance, "Image"));
+  link(ntree, output(color_balance, "Image"), input(curves, "Image"));
+  link(ntree, output(curves, "Image"), input(hue_saturation, "Image"));
+  link(ntree, output(hue_saturation, "Image"), input(gamma, "Image"));
+  link(ntree, output(gamma, "Image"), input(bright_contrast, "Image"));
+  link(ntree, output(bright_contrast, "Image"), composite);
+}
+
+/* Mix and math nodes on the image, the blend factor depends on the red channel. */
+static void build_mix_math(bNodeTree *ntree, bNodeSocket *image, bNodeSocket *composite)
+{
+  const float tint[4] = {0.9f, 0.6f, 0.3f, 1.0f};
+  const float offset[4] = {0.05f, 0.1f, 0.15f, 1.0f};
+
+  bNode *separate = add_node(ntree, CMP_NODE_SEPRGBA);
+  bNode *math = add_node(ntree, CMP_NODE_MATH);
+  math->custom1 = NODE_MATH_MULTIPLY;
+  set_input_value(math, "Value_001", 0.5f);
+  bNode *multiply = add_node(ntree, CMP_NODE_MIX_RGB);
+  multiply->custom1 = MA_RAMP_MULT;
+  set_input_color(multiply, "Image_001", tint);
+  bNode *add = add_node(ntree, CMP_NODE_MIX_RGB);
+  add->custom1 = MA_RAMP_ADD;
+  set_input_value(add, "Fac", 0.25f);
+  bNode *subtract = add_node(ntree, CMP_NODE_MIX_RGB);
+  subtract->custom1 = MA_RAMP_SUB;
+  subtract->custom2 = SHD_MIXRGB_CLAMP;
+  set_input_value(subtract, "Fac", 1.0f);
+  set_input_color(subtract, "Image_001", offset);
+
+  link(ntree, image, input(separate, "Image"));
+  link(ntree, output(separate, "R"), input(math, "Value"));
+  link(ntree, output(math, "Value"), input(multiply, "Fac"));
+  link(ntree, image, input(multiply, "Image"));
+  link(ntree, output(multiply, "Image"), input(add, "Image"));
+  link(ntree, image, input(add, "Image_001"));
+  link(ntree, output(add, "Image"), input(subtract, "Image"));
+  link(ntree, output(subtract, "Image"), composite);
+}
+
+static void reference_mix_math(const float input[4], float r_output[4])
+{
+  const float tint[4] = {0.9f, 0.6f, 0.3f, 1.0f};
+  const float offset[4] = {0.05f, 0.1f, 0.15f, 1.0f};
+
+  const float fac = input[0] * 0.5f;
+  float multiply[4], add[4];
+  for (int i = 0; i < 3; i++) {
+    multiply[i] = input[i] * ((1.0f - fac) + fac * tint[i]);
+    add[i] = multiply[i] + 0.25f * input[i];
+    r_output[i] = add[i] - 1.0f * offset[i];
+  }
+  /* Mix nodes keep the alpha of the first color. */
+  r_output[3] = input[3];
+  clamp_v4(r_output, 0.0f, 1.0f);
+}
+
+typedef struct BenchmarkCase {
+  const char *name;
+  BuildTreeFn build;
+  /* Optional, NULL when the tree has no reference implementation. */
+  ReferencePixelFn reference;
+} BenchmarkCase;
+
+static const BenchmarkCase passthrough_case = {"passthrough", build_passthrough, NULL};
+
+static const BenchmarkCase benchmark_cases[] = {
+    {"blur_stack", build_blur_stack, NULL},
+    {"glare", build_glare, NULL},
+    {"defocus", build_defocus, NULL},
+    {"keying", build_keying, NULL},
+    {"vector_blur", build_vector_blur, NULL},
+    {"grading", build_grading, NULL},
+    {"mix_math", build_mix_math, reference_mix_math},
+};
+
+/* Resident set size peak of the process in bytes since the last reset, 0 when unknown. */
+static void reset_peak_rss()
+{
+#ifdef __linux__
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+  if (file) {
+    fputs("5", file);
+    fclose(file);
+  }
+#endif
+}
+
+static size_t peak_rss()
+{
+  size_t result = 0;
+#ifdef __linux__
+  FILE *file = fopen("/proc/self/status", "r");
+  if (file) {
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+      unsigned long kilobytes;
+      if (sscanf(line, "VmHWM: %lu kB", &kilobytes) == 1) {
+        result = (size_t)kilobytes * 1024;
+        break;
+      }
+    }
+    fclose(file);
+  }
+#endif
+  return result;
+}
+
+static bool parse_resolution(const std::string &name, int *r_width, int *r_height)
+{
+  if (name == "1080p") {
+    *r_width = 1920;
+    *r_height = 1080;
+    return true;
+  }
+  if (name == "4k") {
+    *r_width = 3840;
+    *r_height = 2160;
+    return true;
+  }
+  return sscanf(name.c_str(), "%dx%d", r_width, r_height) == 2 && *r_width > 0 && *r_height > 0;
+}
+
+static std::vector<std::string> split(const std::string &str, char separator)
+{
+  std::vector<std::string> result;
+  size_t start = 0;
+  while (start <= str.size()) {
+    size_t end = str.find(separator, start);
+    if (end == std::string::npos) {
+      end = str.size();
+    }
+    if (end > start) {
+      result.push_back(str.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return result;
+}
+
+class CompositorBenchmarkTest : public testing::Test {
+ protected:
+  Scene *scene = nullptr;
+  Image *image = nullptr;
+  Render *render = nullptr;
+
+ public:
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+
+    /* Minimal code to run the compositor, copied from main() in creator.c. */
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+
+    DNA_sdna_current_init();
+    BKE_blender_globals_init();
+
+    BKE_idtype_init();
+    IMB_init();
+    BKE_images_init();
+    RNA_init();
+    init_nodesystem();
+
+    G.background = true;
+    G.factory_startup = true;
+  }
+
+  static void TearDownTestCase()
+  {
+    COM_deinitialize();
+    RE_FreeAllRender();
+
+    BKE_blender_free();
+    RNA_exit();
+
+    DNA_sdna_current_free();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+
+    BKE_blender_atexit();
+    BKE_tempdir_session_purge();
+
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+  void setup_scene(int width, int height)
+  {
+    scene = BKE_scene_add(G.main, "Benchmark");
+    scene->r.xsch = width;
+    scene->r.ysch = height;
+    scene->r.size = 100;
+    if (FLAGS_threads > 0) {
+      scene->r.mode |= R_FIXED_THREADS;
+      scene->r.threads = FLAGS_threads;
+    }
+
+    const float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    image = BKE_image_add_generated(G.main,
+                                    width,
+                                    height,
+                                    "Input",
+                                    24,
+                                    true,
+                                    IMA_GENTYPE_GRID_COLOR,
+                                    color,
+                                    false,
+                                    false,
+                                    false);
+
+    render = RE_NewSceneRender(scene);
+    RE_InitState(render, NULL, &scene->r, &scene->view_layers, NULL, width, height, NULL);
+  }
+
+  virtual void TearDown()
+  {
+    if (scene) {
+      BKE_id_delete(G.main, &scene->id);
+      scene = nullptr;
+    }
+    if (image) {
+      BKE_id_delete(G.main, &image->id);
+      image = nullptr;
+    }
+    render = nullptr;
+
+    testing::Test::TearDown();
+  }
+
+  bNodeTree *build_tree(const BenchmarkCase &benchmark_case, int flag)
+  {
+    bNodeTree *ntree = ntreeAddTree(NULL, "Benchmark", ntreeType_Composite->idname);
+    ntree->flag |= flag;
+    ntree->chunksize = 256;
+    ntree->render_quality = NTREE_QUALITY_HIGH;
+    ntree->edit_quality = NTREE_QUALITY_HIGH;
+    ntree->test_break = dummy_test_break;
+    ntree->progress = dummy_progress;
+    ntree->stats_draw = dummy_stats_draw;
+
+    bNode *image_node = add_node(ntree, CMP_NODE_IMAGE);
+    image_node->id = &image->id;
+    id_us_plus(&image->id);
+    bNode *composite_node = add_node(ntree, CMP_NODE_COMPOSITE);
+    /* Creates the outputs of the image node. */
+    ntreeUpdateTree(G.main, ntree);
+
+    benchmark_case.build(ntree, output(image_node, "Image"), input(composite_node, "Image"));
+    ntreeUpdateTree(G.main, ntree);
+
+    scene->nodetree = ntree;
+    scene->use_nodes = true;
+    return ntree;
+  }
+
+  void free_tree()
+  {
+    ntreeFreeEmbeddedTree(scene->nodetree);
+    MEM_freeN(scene->nodetree);
+    scene->nodetree = NULL;
+  }
+
+  /* Execute the tree of the scene, returns the time in seconds. The peak memory is the one
+   * allocated by the execution, the peak RSS the one of the whole process. */
+  double execute(size_t *r_peak_memory, size_t *r_peak_rss)
+  {
+    const size_t memory_before = MEM_get_memory_in_use();
+    MEM_reset_peak_memory();
+    reset_peak_rss();
+    const double start_time = PIL_check_seconds_timer();
+
+    COM_execute(&scene->r,
+                scene,
+                scene->nodetree,
+                true,
+                &scene->view_settings,
+                &scene->display_settings,
+                "");
+
+    const double time = PIL_check_seconds_timer() - start_time;
+    *r_peak_memory = MEM_get_peak_memory() - std::min(memory_before, MEM_get_peak_memory());
+    *r_peak_rss = peak_rss();
+    return time;
+  }
+
+  std::vector<float> result()
+  {
+    RenderResult rres;
+    RE_AcquireResultImage(render, &rres, 0);
+    std::vector<float> pixels;
+    if (rres.rectf) {
+      pixels.assign(rres.rectf, rres.rectf + rres.rectx * rres.recty * 4);
+    }
+    RE_ReleaseResultImage(render);
+    return pixels;
+  }
+};
+
+static void compare_results(const std::vector<float> &expected,
+                            const std::vector<float> &actual,
+                            const ExecutionMode &mode,
+                            const char *case_name)
+{
+  ASSERT_EQ(expected.size(), actual.size()) << case_name << " " << mode.name;
+
+  double sum_error = 0.0;
+  float max_error = 0.0f;
+  for (size_t index = 0; index < expected.size(); index++) {
+    const float error = fabsf(expected[index] - actual[index]) /
+                        std::max(1.0f, fabsf(expected[index]));
+    sum_error += error;
+    max_error = std::max(max_error, error);
+  }
+  const double mean_error = expected.empty() ? 0.0 : sum_error / expected.size();
+
+  EXPECT_LE(max_error, mode.max_error) << case_name << " " << mode.name;
+  EXPECT_LE(mean_error, mode.mean_error) << case_name << " " << mode.name;
+}
+
+TEST_F(CompositorBenchmarkTest, ExecuteTrees)
+{
+  const std::vector<std::string> resolutions = split(FLAGS_resolutions, ',');
+  ASSERT_FALSE(resolutions.empty());
+  const std::vector<std::string> cases = split(FLAGS_cases, ',');
+
+  for (const std::string &resolution : resolutions) {
+    int width, height;
+    ASSERT_TRUE(parse_resolution(resolution, &width, &height)) << resolution;
+    setup_scene(width, height);
+
+    size_t peak_memory_unused, peak_rss_unused;
+    build_tree(passthrough_case, 0);
+    execute(&peak_memory_unused, &peak_rss_unused);
+    free_tree();
+    const std::vector<float> input_pixels = result();
+    ASSERT_EQ(input_pixels.size(), (size_t)width * height * 4);
+
+    for (const BenchmarkCase &benchmark_case : benchmark_cases) {
+      if (!cases.empty() &&
+          std::find(cases.begin(), cases.end(), benchmark_case.name) == cases.end()) {
+        continue;
+      }
+      std::vector<float> expected;
+
+      for (const ExecutionMode &mode : execution_modes) {
+        build_tree(benchmark_case, mode.flag);
+
+        double best_time = 0.0;
+        size_t peak_memory = 0, peak_rss = 0;
+        COM_ExecutionStats stats;
+        const int max_operations = 64;
+        COM_OperationStats operation_stats[max_operations];
+        int num_operations = 0;
+        for (int run = 0; run < std::max(1, FLAGS_repeat); run++) {
+          size_t run_peak_memory, run_peak_rss;
+          const double time = execute(&run_peak_memory, &run_peak_rss);
+          if (run == 0 || time < best_time) {
+            best_time = time;
+            COM_executionStats(&stats);
+            num_operations = COM_executionOperationStats(operation_stats, max_operations);
+          }
+          peak_memory = std::max(peak_memory, run_peak_memory);
+          peak_rss = std::max(peak_rss, run_peak_rss);
+        }
+        free_tree();
+
+        testing_write_benchmark_result(FLAGS_output,
+                                       "compositor",
+                                       mode.name,
+                                       width,
+                                       height,
+                                       (FLAGS_threads > 0) ? FLAGS_threads :
+                                                             BLI_system_thread_count(),
+                                       best_time,
+                                       "\"case\": \"%s\", \"resolution\": \"%s\", "
+                                       "\"peak_memory\": %zu, \"peak_rss\": %zu, "
+                                       "\"chunks\": %d, "
+                                       "\"stolen_chunks\": %d, \"latency_average\": %f, "
+                                       "\"latency_max\": %f, \"utilization\": %f",
+                                       benchmark_case.name,
+                                       resolution.c_str(),
+                                       peak_memory,
+                                       peak_rss,
+                                       stats.chunks,
+                                       stats.stolen_chunks,
+                                       stats.latency_average,
+                                       stats.latency_max,
+                                       stats.utilization);
+        if (FLAGS_operation_times) {
+          for (int index = 0; index < std::min(num_operations, max_operations); index++) {
+            printf("  %-40s %4d chunks %9.3f ms\n",
+                   operation_stats[index].name,
+                   operation_stats[index].chunks,
+                   1000.0 * operation_stats[index].time);
+          }
+        }
+
+        std::vector<float> pixels = result();
+        EXPECT_EQ(pixels.size(), (size_t)width * height * 4) << benchmark_case.name;
+        if (mode.flag == 0) {
+          expected = pixels;
+          if (benchmark_case.reference) {
+            std::vector<float> reference(input_pixels.size());
+            for (size_t index = 0; index < input_pixels.size(); index += 4) {
+              benchmark_case.reference(&input_pixels[index], &reference[index]);
+            }
+            compare_results(reference, pixels, reference_mode, benchmark_case.name);
+          }
+        }
+        else {
+          compare_results(expected, pixels, mode, benchmark_case.name);
+        }
+      }
+    }
+
+    TearDown();
+  }
+}
@@ -0,0 +1,217 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "ED_armature.h"
+}
+
+#define CAGE_VERTS 8
+#define MESH_VERTS 8
+
+/* A unit cube scaled by two, with one corner pulled out so that the weights are not
+ * symmetric. */
+static const float cage_cos[CAGE_VERTS][3] = {
+    {-1.0f, -1.0f, -1.0f},
+    {1.0f, -1.0f, -1.0f},
+    {1.0f, 1.0f, -1.0f},
+    {-1.0f, 1.0f, -1.0f},
+    {-1.0f, -1.0f, 1.0f},
+    {1.0f, -1.0f, 1.0f},
+    {1.4f, 1.2f, 1.3f},
+    {-1.0f, 1.0f, 1.0f},
+};
+
+static const int cage_faces[6][4] = {
+    {0, 3, 2, 1},
+    {4, 5, 6, 7},
+    {0, 1, 5, 4},
+    {1, 2, 6, 5},
+    {2, 3, 7, 6},
+    {3, 0, 4, 7},
+};
+
+static const float mesh_cos[MESH_VERTS][3] = {
+    {0.0f, 0.0f, 0.0f},
+    {-0.5f, -0.5f, -0.5f},
+    {0.6f, -0.4f, -0.2f},
+    {0.3f, 0.7f, -0.6f},
+    {-0.7f, 0.2f, 0.5f},
+    {0.5f, -0.6f, 0.7f},
+    {0.9f, 0.8f, 0.9f},
+    {-0.2f, 0.9f, 0.3f},
+};
+
+/* Static bind weights of each mesh vertex for each cage vertex, computed with the solver
+ * that bound one cage vertex at a time. */
+static const float static_weights_reference[MESH_VERTS][CAGE_VERTS] = {
+    {0.1283860f, 0.1267616f, 0.1302326f, 0.1315803f,
+     0.1281141f, 0.1240338f, 0.0964913f, 0.1344003f},
+    {0.4263247f, 0.1382265f, 0.0487537f, 0.1388975f,
+     0.1384526f, 0.0478745f, 0.0122165f, 0.0492540f},
+    {0.0901155f, 0.3348430f, 0.1447796f, 0.0419611f,
+     0.0623391f, 0.2188585f, 0.0765520f, 0.0305513f},
+    {0.0444608f, 0.0769807f, 0.4484861f, 0.2431296f,
+     0.0115133f, 0.0204684f, 0.0853050f, 0.0696561f},
+    {0.0886551f, 0.0163187f, 0.0257732f, 0.1300772f,
+     0.2535617f, 0.0454547f, 0.0518939f, 0.3882656f},
+    {0.0361302f, 0.0943888f, 0.0288148f, 0.0103416f,
+     0.1725035f, 0.5057890f, 0.0986348f, 0.0533973f},
+    {0.0019343f, 0.0171351f, 0.1053120f, 0.0186249f,
+     0.0207675f, 0.1169581f, 0.5881714f, 0.1310968f},
+    {0.0123985f, 0.0085595f, 0.1476186f, 0.2111348f,
+     0.0227084f, 0.0157402f, 0.1894082f, 0.3924318f},
+};
+
+/* Dynamic bind weights summed over all grid cells, per cage vertex, computed with the solver
+ * that bound one cage vertex at a time. */
+static const double dynamic_weights_reference[CAGE_VERTS] = {
+    418.63538, 442.68063, 494.68234, 439.19870, 412.56818, 453.64825, 475.90195, 472.68515};
+static const int dynamic_totinfluence_reference = 21430;
+
+class MeshDeformBindTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+  Mesh *cage;
+  Object object;
+  MeshDeformModifierData mmd;
+
+  void SetUp() override
+  {
+    cage = BKE_mesh_new_nomain(CAGE_VERTS, 0, 0, 24, 6);
+    for (int a = 0; a < CAGE_VERTS; a++) {
+      copy_v3_v3(cage->mvert[a].co, cage_cos[a]);
+    }
+    for (int a = 0; a < 6; a++) {
+      cage->mpoly[a].loopstart = a * 4;
+      cage->mpoly[a].totloop = 4;
+      for (int b = 0; b < 4; b++) {
+        cage->mloop[a * 4 + b].v = cage_faces[a][b];
+      }
+    }
+    BKE_mesh_calc_edges(cage, false, false);
+
+    memset(&object, 0, sizeof(object));
+    unit_m4(object.obmat);
+
+    memset(&mmd, 0, sizeof(mmd));
+    mmd.object = &object;
+    mmd.gridsize = 4;
+  }
+
+  void TearDown() override
+  {
+    MEM_SAFE_FREE(mmd.bindinfluences);
+    MEM_SAFE_FREE(mmd.bindoffsets);
+    MEM_SAFE_FREE(mmd.bindcagecos);
+    MEM_SAFE_FREE(mmd.dyngrid);
+    MEM_SAFE_FREE(mmd.dyninfluences);
+    MEM_SAFE_FREE(mmd.dynverts);
+    BKE_id_free(NULL, cage);
+  }
+
+  void bind()
+  {
+    float vertexcos[MESH_VERTS][3];
+    float cagemat[4][4];
+
+    memcpy(vertexcos, mesh_cos, sizeof(vertexcos));
+    unit_m4(cagemat);
+    ED_mesh_deform_bind_callback(&mmd, cage, &vertexcos[0][0], MESH_VERTS, cagemat);
+
+    ASSERT_EQ(mmd.totvert, MESH_VERTS);
+    ASSERT_EQ(mmd.totcagevert, CAGE_VERTS);
+  }
+};
+
+TEST_F(MeshDeformBindTest, StaticInfluences)
+{
+  bind();
+  ASSERT_NE(mmd.bindinfluences, nullptr);
+  ASSERT_NE(mmd.bindoffsets, nullptr);
+  EXPECT_EQ(mmd.bindoffsets[MESH_VERTS], mmd.totinfluence);
+
+  for (int a = 0; a < MESH_VERTS; a++) {
+    float weights[CAGE_VERTS] = {0.0f};
+    for (int b = mmd.bindoffsets[a]; b < mmd.bindoffsets[a + 1]; b++) {
+      const MDefInfluence *inf = &mmd.bindinfluences[b];
+      ASSERT_GE(inf->vertex, 0);
+      ASSERT_LT(inf->vertex, CAGE_VERTS);
+      weights[inf->vertex] += inf->weight;
+    }
+    for (int b = 0; b < CAGE_VERTS; b++) {
+      EXPECT_NEAR(weights[b], static_weights_reference[a][b], 1e-5f) << "vertex " << a;
+    }
+  }
+}
+
+TEST_F(MeshDeformBindTest, DynamicInfluences)
+{
+  mmd.flag |= MOD_MDEF_DYNAMIC_BIND;
+  bind();
+  ASSERT_NE(mmd.dyngrid, nullptr);
+  ASSERT_NE(mmd.dyninfluences, nullptr);
+  EXPECT_EQ(mmd.totinfluence, dynamic_totinfluence_reference);
+
+  const int size3 = mmd.dyngridsize * mmd.dyngridsize * mmd.dyngridsize;
+  double weights[CAGE_VERTS] = {0.0};
+  for (int a = 0; a < size3; a++) {
+    const MDefCell *cell = &mmd.dyngrid[a];
+    for (int b = 0; b < cell->totinfluence; b++) {
+      const MDefInfluence *inf = &mmd.dyninfluences[cell->offset + b];
+      ASSERT_GE(inf->vertex, 0);
+      ASSERT_LT(inf->vertex, CAGE_VERTS);
+      weights[inf->vertex] += inf->weight;
+    }
+  }
+  for (int b = 0; b < CAGE_VERTS; b++) {
+    EXPECT_NEAR(weights[b], dynamic_weights_reference[b], 1e-3) << "cage vertex " << b;
+  }
+}
@@ -0,0 +1,124 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 3
+
+/* 8K UHD down to 1080p, the resolutions of proxies and previews of 8K footage. */
+#define SRC_WIDTH 7680
+#define SRC_HEIGHT 4320
+#define DST_WIDTH 1920
+#define DST_HEIGHT 1080
+
+static ImBuf *gradient_imbuf(int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(SRC_WIDTH, SRC_HEIGHT, 32, flags);
+  for (size_t y = 0; y < SRC_HEIGHT; y++) {
+    for (size_t x = 0; x < SRC_WIDTH; x++) {
+      const size_t offset = (y * SRC_WIDTH + x) * 4;
+      const float color[4] = {
+          (float)x / SRC_WIDTH, (float)y / SRC_HEIGHT, (float)((x ^ y) & 1), 1.0f};
+      for (int ch = 0; ch < 4; ch++) {
+        if (ibuf->rect) {
+          ((unsigned char *)ibuf->rect)[offset + ch] = (unsigned char)(color[ch] * 255.0f);
+        }
+        if (ibuf->rect_float) {
+          ibuf->rect_float[offset + ch] = color[ch];
+        }
+      }
+    }
+  }
+  return ibuf;
+}
+
+/* Filter -1 is IMB_scalefastImBuf, the nearest neighbor reference. */
+static void scale_test(const char *id, int flags, int filter)
+{
+  ImBuf *src = gradient_imbuf(flags);
+  double averaged_timing = 0.0;
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    ImBuf *ibuf = IMB_dupImBuf(src);
+    const double init_time = PIL_check_seconds_timer();
+    if (filter == -1) {
+      IMB_scalefastImBuf(ibuf, DST_WIDTH, DST_HEIGHT);
+    }
+    else {
+      IMB_resampleImBuf(ibuf, DST_WIDTH, DST_HEIGHT, (eIMBResampleFilter)filter);
+    }
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(ibuf->x, DST_WIDTH);
+    EXPECT_EQ(ibuf->y, DST_HEIGHT);
+    IMB_freeImBuf(ibuf);
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  IMB_freeImBuf(src);
+}
+
+class ImBufScalingPerformanceTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(ImBufScalingPerformanceTest, ByteNearest)
+{
+  scale_test("byte nearest", IB_rect, -1);
+}
+
+TEST_F(ImBufScalingPerformanceTest, ByteBox)
+{
+  scale_test("byte box", IB_rect, IMB_RESAMPLE_BOX);
+}
+
+TEST_F(ImBufScalingPerformanceTest, ByteBilinear)
+{
+  scale_test("byte bilinear", IB_rect, IMB_RESAMPLE_BILINEAR);
+}
+
+TEST_F(ImBufScalingPerformanceTest, ByteBicubic)
+{
+  scale_test("byte bicubic", IB_rect, IMB_RESAMPLE_BICUBIC);
+}
+
+TEST_F(ImBufScalingPerformanceTest, ByteLanczos)
+{
+  scale_test("byte lanczos", IB_rect, IMB_RESAMPLE_LANCZOS);
+}
+
+TEST_F(ImBufScalingPerformanceTest, FloatBox)
+{
+  scale_test("float box", IB_rectfloat, IMB_RESAMPLE_BOX);
+}
+
+TEST_F(ImBufScalingPerformanceTest, FloatLanczos)
+{
+  scale_test("float lanczos", IB_rectfloat, IMB_RESAMPLE_LANCZOS);
+}
@@ -0,0 +1,158 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+static const eIMBResampleFilter all_filters[] = {
+    IMB_RESAMPLE_BOX,
+    IMB_RESAMPLE_BILINEAR,
+    IMB_RESAMPLE_BICUBIC,
+    IMB_RESAMPLE_LANCZOS,
+};
+
+class ImBufScalingTest : public testing::Test {
+ public:
+  /* Large images are resampled in the task scheduler, freeing needs the reference count lock. */
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+  }
+};
+
+static ImBuf *constant_imbuf(int width, int height, const unsigned char color[4])
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect | IB_rectfloat);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (size_t i = 0; i < (size_t)width * height; i++) {
+    for (int ch = 0; ch < 4; ch++) {
+      rect[i * 4 + ch] = color[ch];
+      ibuf->rect_float[i * 4 + ch] = color[ch] / 255.0f;
+    }
+  }
+  return ibuf;
+}
+
+TEST_F(ImBufScalingTest, ConstantImage)
+{
+  const unsigned char color[4] = {10, 100, 200, 255};
+  const int sizes[][2] = {{37, 23}, {640, 360}, {200, 50}, {50, 200}};
+
+  for (const eIMBResampleFilter filter : all_filters) {
+    for (const int *size : sizes) {
+      ImBuf *ibuf = constant_imbuf(160, 90, color);
+      EXPECT_TRUE(IMB_resampleImBuf(ibuf, size[0], size[1], filter));
+      EXPECT_EQ(ibuf->x, size[0]);
+      EXPECT_EQ(ibuf->y, size[1]);
+
+      const unsigned char *rect = (unsigned char *)ibuf->rect;
+      for (size_t i = 0; i < (size_t)size[0] * size[1] * 4; i++) {
+        EXPECT_EQ(rect[i], color[i % 4]);
+        EXPECT_NEAR(ibuf->rect_float[i], color[i % 4] / 255.0f, 1e-5f);
+      }
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
+
+TEST_F(ImBufScalingTest, BoxAverage)
+{
+  /* Columns alternate between black and white, halving the width averages them. */
+  ImBuf *ibuf = IMB_allocImBuf(8, 2, 32, IB_rect | IB_rectfloat);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int i = 0; i < 8 * 2; i++) {
+    const int value = (i % 2) ? 255 : 0;
+    for (int ch = 0; ch < 4; ch++) {
+      rect[i * 4 + ch] = value;
+      ibuf->rect_float[i * 4 + ch] = value / 255.0f;
+    }
+  }
+
+  EXPECT_TRUE(IMB_scaleImBuf(ibuf, 4, 2));
+  rect = (unsigned char *)ibuf->rect;
+  for (int i = 0; i < 4 * 2 * 4; i++) {
+    EXPECT_EQ(rect[i], 128);
+    EXPECT_FLOAT_EQ(ibuf->rect_float[i], 0.5f);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, BilinearEnlarge)
+{
+  ImBuf *ibuf = IMB_allocImBuf(2, 1, 32, IB_rectfloat);
+  const float values[2] = {0.0f, 1.0f};
+  for (int i = 0; i < 2; i++) {
+    for (int ch = 0; ch < 4; ch++) {
+      ibuf->rect_float[i * 4 + ch] = values[i];
+    }
+  }
+
+  EXPECT_TRUE(IMB_resampleImBuf(ibuf, 4, 0, IMB_RESAMPLE_BILINEAR));
+  EXPECT_EQ(ibuf->x, 4);
+  EXPECT_EQ(ibuf->y, 1);
+  const float expected[4] = {0.0f, 0.25f, 0.75f, 1.0f};
+  for (int i = 0; i < 4; i++) {
+    EXPECT_FLOAT_EQ(ibuf->rect_float[i * 4], expected[i]);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, FloatChannels)
+{
+  ImBuf *ibuf = IMB_allocImBuf(300, 200, 24, 0);
+  ibuf->channels = 3;
+  ibuf->rect_float = (float *)MEM_mallocN(sizeof(float) * 300 * 200 * 3, __func__);
+  ibuf->mall |= IB_rectfloat;
+  ibuf->flags |= IB_rectfloat;
+  for (int i = 0; i < 300 * 200; i++) {
+    ibuf->rect_float[i * 3 + 0] = 0.25f;
+    ibuf->rect_float[i * 3 + 1] = 0.5f;
+    ibuf->rect_float[i * 3 + 2] = 0.75f;
+  }
+
+  EXPECT_TRUE(IMB_resampleImBuf(ibuf, 123, 77, IMB_RESAMPLE_LANCZOS));
+  for (int i = 0; i < 123 * 77; i++) {
+    EXPECT_NEAR(ibuf->rect_float[i * 3 + 0], 0.25f, 1e-5f);
+    EXPECT_NEAR(ibuf->rect_float[i * 3 + 1], 0.5f, 1e-5f);
+    EXPECT_NEAR(ibuf->rect_float[i * 3 + 2], 0.75f, 1e-5f);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, ByteOvershootClamped)
+{
+  /* A hard edge makes the negative lobes of Lanczos ring past the byte range. */
+  ImBuf *ibuf = IMB_allocImBuf(64, 1, 32, IB_rect);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int i = 0; i < 64 * 4; i++) {
+    rect[i] = (i / 4 < 32) ? 0 : 255;
+  }
+
+  EXPECT_TRUE(IMB_resampleImBuf(ibuf, 256, 1, IMB_RESAMPLE_LANCZOS));
+  rect = (unsigned char *)ibuf->rect;
+  EXPECT_EQ(rect[0], 0);
+  EXPECT_EQ(rect[255 * 4], 255);
+  for (int x = 1; x < 256; x++) {
+    /* The ringing is clamped instead of wrapping around. */
+    EXPECT_GE(rect[x * 4] + 64, rect[(x - 1) * 4]) << x;
+  }
+  IMB_freeImBuf(ibuf);
+}
@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+/* Sequencer disk cache round trip and hit latency.
+ *
+ * Final frames are written to the disk cache with each compression setting, then read back
+ * once with a freshly scanned cache (cold) and once more with file headers in memory (warm).
+ * Lookups of frames that were never written are timed as well.
+ *
+ * Latency is reported per frame, so at most DISK_CACHE_FRAMES of the --frames are written.
+ */
+
+#include "sequencer_testing.h"
+
+#include <string.h>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_sequencer.h"
+
+#include "BLI_hash.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+/* Zlib level 9 of the "high" compression takes seconds for a large frame. */
+#define DISK_CACHE_FRAMES 8
+
+class SequencerDiskCacheTest : public SequencerTest {
+ protected:
+  SeqRenderData context;
+  int num_frames;
+
+ public:
+  static void SetUpTestCase()
+  {
+    SequencerTest::SetUpTestCase();
+
+    U.memcachelimit = 4096;
+
+    /* Disk cache is only used for saved files. */
+    BLI_join_dirfile(
+        G.main->name, sizeof(G.main->name), BKE_tempdir_session(), "disk_cache_test.blend");
+    BLI_join_dirfile(U.sequencer_disk_cache_dir,
+                     sizeof(U.sequencer_disk_cache_dir),
+                     BKE_tempdir_session(),
+                     "disk_cache");
+    U.sequencer_disk_cache_size_limit = 1;
+    U.sequencer_disk_cache_flag = SEQ_CACHE_DISK_CACHE_ENABLE;
+  }
+
+  static void TearDownTestCase()
+  {
+    U.sequencer_disk_cache_flag = 0;
+
+    SequencerTest::TearDownTestCase();
+  }
+
+ protected:
+  virtual void SetUp()
+  {
+    SequencerTest::SetUp();
+    if (HasFatalFailure()) {
+      return;
+    }
+
+    num_frames = min_ii(FLAGS_frames, DISK_CACHE_FRAMES);
+
+    scene->ed->cache_flag = SEQ_CACHE_STORE_FINAL_OUT;
+    BKE_sequencer_new_render_data(
+        G.main, NULL, scene, width, height, SEQ_PROXY_RENDER_SIZE_FULL, false, &context);
+  }
+
+  /* Every strip has its own directory in the disk cache. */
+  Sequence *add_strip(const char *name, int channel)
+  {
+    Sequence *seq = BKE_sequence_alloc(scene->ed->seqbasep, 1, channel, SEQ_TYPE_IMAGE);
+    BLI_strncpy(seq->name + 2, name, sizeof(seq->name) - 2);
+    seq->len = num_frames * 2;
+    BKE_sequence_calc(scene, seq);
+    return seq;
+  }
+
+  /* Even frames are byte images, odd ones float images. Some grain is added like in footage,
+   * smooth gradients are a slow case for zlib. */
+  ImBuf *frame_ibuf(int frame)
+  {
+    if (frame % 2 == 0) {
+      ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect);
+      unsigned char *pixel = (unsigned char *)ibuf->rect;
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, pixel += 4) {
+          const int grain = BLI_hash_int_2d(x + frame * width, y) & 7;
+          pixel[0] = (x + frame * 8 + grain) & 255;
+          pixel[1] = (y + grain) & 255;
+          pixel[2] = (x ^ y) & 255;
+          pixel[3] = 255;
+        }
+      }
+      return ibuf;
+    }
+
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rectfloat);
+    float *pixel = ibuf->rect_float;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++, pixel += 4) {
+        const float grain = BLI_hash_int_2d(x + frame * width, y) * (0.02f / 0xFFFFFFFFu);
+        pixel[0] = (float)x / width + frame * 0.01f + grain;
+        pixel[1] = (float)y / height + grain;
+        pixel[2] = (float)((x ^ y) & 255) / 255.0f;
+        pixel[3] = 1.0f;
+      }
+    }
+    return ibuf;
+  }
+
+  static bool ibuf_equals(ImBuf *a, ImBuf *b)
+  {
+    if (a == NULL || b == NULL || a->x != b->x || a->y != b->y) {
+      return false;
+    }
+    const size_t pixels = (size_t)a->x * a->y;
+    if (a->rect && b->rect) {
+      return memcmp(a->rect, b->rect, pixels * 4) == 0;
+    }
+    if (a->rect_float && b->rect_float) {
+      return memcmp(a->rect_float, b->rect_float, pixels * sizeof(float[4])) == 0;
+    }
+    return false;
+  }
+
+  /* Read all frames from the disk cache, RAM cache is cleared so it can't be hit. */
+  double read_frames(Sequence *seq, const std::vector<ImBuf *> &frames)
+  {
+    BKE_sequencer_cache_cleanup(scene);
+
+    double seconds = 0.0;
+    for (int frame = 0; frame < (int)frames.size(); frame++) {
+      const double start_time = PIL_check_seconds_timer();
+      ImBuf *ibuf = BKE_sequencer_cache_get(
+          &context, seq, seq->start + frame, SEQ_CACHE_STORE_FINAL_OUT, false);
+      seconds += PIL_check_seconds_timer() - start_time;
+
+      EXPECT_TRUE(ibuf_equals(ibuf, frames[frame])) << seq->name + 2 << " frame " << frame;
+      if (ibuf) {
+        IMB_freeImBuf(ibuf);
+      }
+    }
+    return seconds;
+  }
+
+  void report(const char *compression, const char *mode, double seconds)
+  {
+    testing_write_benchmark_result(FLAGS_output,
+                                   "disk_cache",
+                                   mode,
+                                   width,
+                                   height,
+                                   1,
+                                   seconds,
+                                   "\"compression\": \"%s\", \"frames\": %d, "
+                                   "\"ms_per_frame\": %.3f",
+                                   compression,
+                                   num_frames,
+                                   seconds * 1000.0 / num_frames);
+  }
+
+  /* Frames after the written ones are in a file which exists and in one which doesn't. */
+  double read_missing_frames(Sequence *seq)
+  {
+    double seconds = 0.0;
+    for (int frame = num_frames; frame < num_frames * 2; frame++) {
+      const int cfra = (frame % 2 == 0) ? seq->start + frame : seq->start + frame + 100;
+      const double start_time = PIL_check_seconds_timer();
+      ImBuf *ibuf = BKE_sequencer_cache_get(
+          &context, seq, cfra, SEQ_CACHE_STORE_FINAL_OUT, false);
+      seconds += PIL_check_seconds_timer() - start_time;
+
+      EXPECT_EQ(ibuf, (ImBuf *)NULL) << seq->name + 2 << " frame " << frame;
+    }
+    return seconds;
+  }
+};
+
+TEST_F(SequencerDiskCacheTest, HitLatency)
+{
+  const struct {
+    const char *name;
+    int compression;
+  } modes[] = {
+      {"none", USER_SEQ_DISK_CACHE_COMPRESSION_NONE},
+      {"low", USER_SEQ_DISK_CACHE_COMPRESSION_LOW},
+      {"high", USER_SEQ_DISK_CACHE_COMPRESSION_HIGH},
+  };
+
+  std::vector<ImBuf *> frames;
+  for (int frame = 0; frame < num_frames; frame++) {
+    frames.push_back(frame_ibuf(frame));
+  }
+
+  for (int i = 0; i < ARRAY_SIZE(modes); i++) {
+    U.sequencer_disk_cache_compression = modes[i].compression;
+    Sequence *seq = add_strip(modes[i].name, i + 1);
+
+    double seconds = 0.0;
+    for (int frame = 0; frame < num_frames; frame++) {
+      const double start_time = PIL_check_seconds_timer();
+      BKE_sequencer_cache_put(&context,
+                              seq,
+                              seq->start + frame,
+                              SEQ_CACHE_STORE_FINAL_OUT,
+                              frames[frame],
+                              0.0f,
+                              false);
+      seconds += PIL_check_seconds_timer() - start_time;
+    }
+    report(modes[i].name, "write", seconds);
+
+    /* Start over with nothing but the files on disk. */
+    BKE_sequencer_cache_destruct(scene);
+    report(modes[i].name, "read_cold", read_frames(seq, frames));
+    report(modes[i].name, "read_warm", read_frames(seq, frames));
+    report(modes[i].name, "miss", read_missing_frames(seq));
+  }
+
+  for (ImBuf *ibuf : frames) {
+    IMB_freeImBuf(ibuf);
+  }
+}
@@ -0,0 +1,291 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+/* Blend effects with SSE2 and AVX2 kernels compared to the scalar code. AVX2 is only tested on
+ * CPUs which support it.
+ *
+ * Byte results must match bit for bit. The stack benchmark composites eight partially
+ * transparent layers with alpha over, for example:
+ *   sequencer_test --gtest_filter=*Effects* --resolution=4k
+ */
+
+#include "sequencer_testing.h"
+
+#include <string.h>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+#define STACK_LAYERS 8
+
+class SequencerEffectsTest : public SequencerTest {
+ public:
+  static void TearDownTestCase()
+  {
+    BKE_sequencer_effect_simd_set(SEQ_EFFECT_SIMD_AVX2);
+
+    SequencerTest::TearDownTestCase();
+  }
+
+ protected:
+  /* Mostly partially transparent pixels, with fully transparent and opaque ones mixed in. */
+  static ImBuf *random_ibuf(RNG *rng, int width, int height, bool use_float)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 32, use_float ? IB_rectfloat : IB_rect);
+    const size_t tot_pixels = (size_t)width * height;
+
+    for (size_t i = 0; i < tot_pixels; i++) {
+      const int kind = BLI_rng_get_int(rng) % 8;
+      const float alpha = (kind == 0) ? 0.0f : (kind == 1) ? 1.0f : BLI_rng_get_float(rng);
+
+      if (use_float) {
+        float *pixel = &ibuf->rect_float[i * 4];
+        for (int ch = 0; ch < 3; ch++) {
+          pixel[ch] = BLI_rng_get_float(rng) * alpha;
+        }
+        pixel[3] = alpha;
+      }
+      else {
+        unsigned char *pixel = (unsigned char *)&ibuf->rect[i];
+        for (int ch = 0; ch < 3; ch++) {
+          pixel[ch] = BLI_rng_get_int(rng) & 255;
+        }
+        pixel[3] = unit_float_to_uchar_clamp(alpha);
+      }
+    }
+
+    return ibuf;
+  }
+
+  ImBuf *blend(int blend_mode, float facf0, float facf1, ImBuf *ibuf1, ImBuf *ibuf2)
+  {
+    SeqRenderData context;
+    BKE_sequencer_new_render_data(
+        G.main, NULL, scene, ibuf1->x, ibuf1->y, SEQ_PROXY_RENDER_SIZE_FULL, false, &context);
+
+    Sequence seq = {NULL};
+    seq.blend_mode = blend_mode;
+    struct SeqEffectHandle sh = BKE_sequence_get_blend(&seq);
+
+    return BKE_sequencer_effect_execute_threaded(
+        &sh, &context, &seq, 1.0f, facf0, facf1, ibuf1, ibuf2, NULL);
+  }
+
+  /* Composite the layers bottom to top, layer zero is the background. */
+  ImBuf *composite_stack(const std::vector<ImBuf *> &layers, double *r_seconds)
+  {
+    ImBuf *result = IMB_dupImBuf(layers[0]);
+    const double start_time = PIL_check_seconds_timer();
+
+    for (int i = 1; i < (int)layers.size(); i++) {
+      ImBuf *over = blend(SEQ_TYPE_ALPHAOVER, 0.8f, 0.8f, layers[i], result);
+      IMB_freeImBuf(result);
+      result = over;
+    }
+
+    *r_seconds = PIL_check_seconds_timer() - start_time;
+    return result;
+  }
+};
+
+static const int blend_modes[] = {
+    SEQ_TYPE_ALPHAOVER,
+    SEQ_TYPE_ALPHAUNDER,
+    SEQ_TYPE_CROSS,
+    SEQ_TYPE_GAMCROSS,
+    SEQ_TYPE_ADD,
+    SEQ_TYPE_SUB,
+    SEQ_TYPE_MUL,
+};
+
+static const int simd_levels[] = {
+    SEQ_EFFECT_SIMD_SSE2,
+    SEQ_EFFECT_SIMD_AVX2,
+};
+
+static const char *simd_level_name(int simd)
+{
+  switch (simd) {
+    case SEQ_EFFECT_SIMD_SSE2:
+      return "sse2";
+    case SEQ_EFFECT_SIMD_AVX2:
+      return "avx2";
+  }
+  return "scalar";
+}
+
+/* Factors of both fields, out of range ones are possible with animation. */
+static const float blend_factors[][2] = {
+    {0.3f, 0.7f},
+    {0.0f, 1.0f},
+    {1.0f, 1.0f},
+    {0.5f, 0.5f},
+    {1.5f, -0.25f},
+};
+
+TEST_F(SequencerEffectsTest, BlendByteMatchesScalar)
+{
+  /* Odd width for the remainder of the kernels, more than one slice of rows. */
+  const int width = 67, height = 130;
+  RNG *rng = BLI_rng_new(1);
+  ImBuf *ibuf1 = random_ibuf(rng, width, height, false);
+  ImBuf *ibuf2 = random_ibuf(rng, width, height, false);
+  BLI_rng_free(rng);
+
+  for (const int blend_mode : blend_modes) {
+    for (const auto &fac : blend_factors) {
+      BKE_sequencer_effect_simd_set(SEQ_EFFECT_SIMD_NONE);
+      ImBuf *scalar = blend(blend_mode, fac[0], fac[1], ibuf1, ibuf2);
+      ASSERT_NE(scalar->rect, (unsigned int *)NULL);
+
+      for (const int simd_level : simd_levels) {
+        if (BKE_sequencer_effect_simd_set(simd_level) != simd_level) {
+          continue;
+        }
+        ImBuf *simd = blend(blend_mode, fac[0], fac[1], ibuf1, ibuf2);
+
+        ASSERT_NE(simd->rect, (unsigned int *)NULL);
+        EXPECT_EQ(memcmp(scalar->rect, simd->rect, sizeof(int) * width * height), 0)
+            << simd_level_name(simd_level) << ", blend mode " << blend_mode << ", factors "
+            << fac[0] << " " << fac[1];
+
+        IMB_freeImBuf(simd);
+      }
+
+      IMB_freeImBuf(scalar);
+    }
+  }
+
+  IMB_freeImBuf(ibuf1);
+  IMB_freeImBuf(ibuf2);
+}
+
+TEST_F(SequencerEffectsTest, BlendFloatMatchesScalar)
+{
+  const int width = 67, height = 130;
+  RNG *rng = BLI_rng_new(2);
+  ImBuf *ibuf1 = random_ibuf(rng, width, height, true);
+  ImBuf *ibuf2 = random_ibuf(rng, width, height, true);
+  BLI_rng_free(rng);
+
+  for (const int blend_mode : blend_modes) {
+    for (const auto &fac : blend_factors) {
+      BKE_sequencer_effect_simd_set(SEQ_EFFECT_SIMD_NONE);
+      ImBuf *scalar = blend(blend_mode, fac[0], fac[1], ibuf1, ibuf2);
+
+      for (const int simd_level : simd_levels) {
+        if (BKE_sequencer_effect_simd_set(simd_level) != simd_level) {
+          continue;
+        }
+        ImBuf *simd = blend(blend_mode, fac[0], fac[1], ibuf1, ibuf2);
+
+        float max_error = 0.0f;
+        for (int i = 0; i < width * height * 4; i++) {
+          max_error = max_ff(max_error, fabsf(scalar->rect_float[i] - simd->rect_float[i]));
+        }
+        EXPECT_LT(max_error, 1e-6f) << simd_level_name(simd_level) << ", blend mode "
+                                    << blend_mode << ", factors " << fac[0] << " " << fac[1];
+
+        IMB_freeImBuf(simd);
+      }
+
+      IMB_freeImBuf(scalar);
+    }
+  }
+
+  IMB_freeImBuf(ibuf1);
+  IMB_freeImBuf(ibuf2);
+}
+
+TEST_F(SequencerEffectsTest, AlphaOverStack)
+{
+  const int threads = BLI_system_thread_count();
+
+  for (const bool use_float : {false, true}) {
+    const char *type = use_float ? "float" : "byte";
+    RNG *rng = BLI_rng_new(3);
+    std::vector<ImBuf *> layers;
+    for (int i = 0; i < STACK_LAYERS; i++) {
+      layers.push_back(random_ibuf(rng, width, height, use_float));
+    }
+    BLI_rng_free(rng);
+
+    ImBuf *scalar = NULL;
+
+    for (const int simd_level :
+         {(int)SEQ_EFFECT_SIMD_NONE, (int)SEQ_EFFECT_SIMD_SSE2, (int)SEQ_EFFECT_SIMD_AVX2}) {
+      if (BKE_sequencer_effect_simd_set(simd_level) != simd_level) {
+        continue;
+      }
+
+      double seconds;
+      ImBuf *result = composite_stack(layers, &seconds);
+      testing_write_benchmark_result(FLAGS_output,
+                                     "blend_stack",
+                                     simd_level_name(simd_level),
+                                     width,
+                                     height,
+                                     threads,
+                                     seconds,
+                                     "\"type\": \"%s\", \"layers\": %d",
+                                     type,
+                                     STACK_LAYERS);
+
+      if (scalar == NULL) {
+        scalar = result;
+        continue;
+      }
+
+      if (use_float) {
+        float max_error = 0.0f;
+        for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+          max_error = max_ff(max_error, fabsf(scalar->rect_float[i] - result->rect_float[i]));
+        }
+        EXPECT_LT(max_error, 1e-5f) << simd_level_name(simd_level);
+      }
+      else {
+        EXPECT_EQ(memcmp(scalar->rect, result->rect, sizeof(int) * (size_t)width * height), 0)
+            << simd_level_name(simd_level);
+      }
+      IMB_freeImBuf(result);
+    }
+
+    IMB_freeImBuf(scalar);
+    for (ImBuf *ibuf : layers) {
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
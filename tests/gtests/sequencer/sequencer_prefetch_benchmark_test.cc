@@ -0,0 +1,222 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+/* Headless sequencer playback benchmark.
+ *
+ * Builds a timeline of stacked, cross blended image sequence tracks and reports the frames per
+ * second of rendering it frame by frame on the calling thread, and of prefetching it in the
+ * background the way playback does. Prefetched frames are compared against the serial ones.
+ *
+ * For example:
+ *   sequencer_test --resolution=4k --tracks=6 --frames=48 --output=benchmark.json
+ */
+
+#include "sequencer_testing.h"
+
+#include <string.h>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+DEFINE_int32(tracks, 6, "Number of stacked image sequence tracks.");
+
+class SequencerPrefetchBenchmarkTest : public SequencerTest {
+ protected:
+  SeqRenderData context;
+
+ public:
+  static void SetUpTestCase()
+  {
+    SequencerTest::SetUpTestCase();
+
+    /* Room for all frames of the timeline, prefetching pauses when the cache is full. */
+    U.memcachelimit = 4096;
+  }
+
+ protected:
+  /* Write the frames of a track, each track has its own pattern. */
+  void write_track(const char *dir, int track)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 24, IB_rect);
+    ibuf->ftype = IMB_FTYPE_PNG;
+    /* Low compression, writing the frames is not what is measured. */
+    ibuf->foptions.quality = 10;
+
+    for (int frame = 0; frame < FLAGS_frames; frame++) {
+      unsigned char *pixel = (unsigned char *)ibuf->rect;
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, pixel += 4) {
+          pixel[0] = (x + frame * 8) & 255;
+          pixel[1] = (y * (track + 1)) & 255;
+          pixel[2] = ((x ^ y) + track * 40) & 255;
+          pixel[3] = 255;
+        }
+      }
+
+      char filepath[FILE_MAX], filename[64];
+      BLI_snprintf(filename, sizeof(filename), "frame_%04d.png", frame);
+      BLI_join_dirfile(filepath, sizeof(filepath), dir, filename);
+      ASSERT_TRUE(IMB_saveiff(ibuf, filepath, IB_rect));
+    }
+
+    IMB_freeImBuf(ibuf);
+  }
+
+  void setup_tracks()
+  {
+    Editing *ed = scene->ed;
+    ed->cache_flag = SEQ_CACHE_STORE_FINAL_OUT;
+
+    for (int track = 0; track < FLAGS_tracks; track++) {
+      char dir[FILE_MAX], dirname[64];
+      BLI_snprintf(dirname, sizeof(dirname), "sequencer_benchmark_%d%s", track, SEP_STR);
+      BLI_join_dirfile(dir, sizeof(dir), BKE_tempdir_session(), dirname);
+      BLI_dir_create_recursive(dir);
+      write_track(dir, track);
+
+      Sequence *seq = BKE_sequence_alloc(ed->seqbasep, 1, track + 1, SEQ_TYPE_IMAGE);
+      BLI_snprintf(seq->name + 2, sizeof(seq->name) - 2, "Track %d", track);
+      BKE_sequence_base_unique_name_recursive(&ed->seqbase, seq);
+      /* Blend with the tracks below, so all of them are rendered. */
+      seq->blend_mode = SEQ_TYPE_CROSS;
+      seq->blend_opacity = 50.0f;
+      seq->len = FLAGS_frames;
+
+      Strip *strip = seq->strip;
+      STRNCPY(strip->dir, dir);
+      strip->stripdata = (StripElem *)MEM_callocN(sizeof(StripElem) * seq->len, "stripelem");
+      for (int frame = 0; frame < seq->len; frame++) {
+        BLI_snprintf(strip->stripdata[frame].name,
+                     sizeof(strip->stripdata[frame].name),
+                     "frame_%04d.png",
+                     frame);
+      }
+
+      BKE_sequence_init_colorspace(seq);
+      BKE_sequence_calc(scene, seq);
+    }
+
+    BKE_sequencer_new_render_data(
+        G.main, NULL, scene, width, height, SEQ_PROXY_RENDER_SIZE_FULL, false, &context);
+  }
+
+  /* Render the frames prefetching renders, the first frame is expected to be on screen. */
+  double render_serial(std::vector<std::vector<unsigned char>> &r_frames)
+  {
+    const double start_time = PIL_check_seconds_timer();
+    for (int cfra = scene->r.sfra + 1; cfra <= scene->r.efra; cfra++) {
+      ImBuf *ibuf = BKE_sequencer_give_ibuf(&context, cfra, 0);
+      r_frames.push_back(frame_pixels(ibuf));
+      IMB_freeImBuf(ibuf);
+    }
+    return PIL_check_seconds_timer() - start_time;
+  }
+
+  double render_prefetch()
+  {
+    const double start_time = PIL_check_seconds_timer();
+    scene->ed->cache_flag |= SEQ_CACHE_PREFETCH_ENABLE;
+    BKE_sequencer_prefetch_start(&context, scene->r.sfra, 0.0f);
+    while (BKE_sequencer_prefetch_job_is_running(scene)) {
+      PIL_sleep_ms(1);
+    }
+    scene->ed->cache_flag &= ~SEQ_CACHE_PREFETCH_ENABLE;
+    return PIL_check_seconds_timer() - start_time;
+  }
+
+  static std::vector<unsigned char> frame_pixels(ImBuf *ibuf)
+  {
+    std::vector<unsigned char> pixels;
+    if (ibuf && ibuf->rect) {
+      const unsigned char *rect = (unsigned char *)ibuf->rect;
+      pixels.assign(rect, rect + (size_t)ibuf->x * ibuf->y * 4);
+    }
+    return pixels;
+  }
+};
+
+TEST_F(SequencerPrefetchBenchmarkTest, Playback)
+{
+  ASSERT_GT(FLAGS_tracks, 0);
+
+  setup_tracks();
+  const int frames = scene->r.efra - scene->r.sfra;
+  const int threads = BLI_system_thread_count();
+
+  std::vector<std::vector<unsigned char>> serial_frames;
+  const double serial_time = render_serial(serial_frames);
+  testing_write_benchmark_result(FLAGS_output,
+                                 "prefetch",
+                                 "serial",
+                                 width,
+                                 height,
+                                 threads,
+                                 serial_time,
+                                 "\"tracks\": %d, \"frames\": %d, \"fps\": %.3f",
+                                 FLAGS_tracks,
+                                 frames,
+                                 frames / serial_time);
+
+  BKE_sequencer_cache_cleanup(scene);
+  const double prefetch_time = render_prefetch();
+  testing_write_benchmark_result(FLAGS_output,
+                                 "prefetch",
+                                 "prefetch",
+                                 width,
+                                 height,
+                                 threads,
+                                 prefetch_time,
+                                 "\"tracks\": %d, \"frames\": %d, \"fps\": %.3f",
+                                 FLAGS_tracks,
+                                 frames,
+                                 frames / prefetch_time);
+
+  /* Prefetched frames are in the cache now. */
+  for (int cfra = scene->r.sfra + 1; cfra <= scene->r.efra; cfra++) {
+    Sequence *seq_arr[MAXSEQ + 1];
+    const int count = BKE_sequencer_get_shown_sequences(scene->ed->seqbasep, cfra, 0, seq_arr);
+    ASSERT_GT(count, 0);
+    ImBuf *ibuf = BKE_sequencer_cache_get(
+        &context, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, false);
+    ASSERT_NE(ibuf, (ImBuf *)NULL) << "frame " << cfra;
+    EXPECT_TRUE(frame_pixels(ibuf) == serial_frames[cfra - scene->r.sfra - 1])
+        << "frame " << cfra;
+    IMB_freeImBuf(ibuf);
+  }
+}
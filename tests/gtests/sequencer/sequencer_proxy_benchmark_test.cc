@@ -0,0 +1,268 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+/* Batch proxy building benchmark.
+ *
+ * Builds 25% and 50% proxies of a number of image sequence clips, once one clip at a time and
+ * once with several clips at the same time, and reports clips per hour.
+ * Proxies built both ways are compared with each other and with the scaled down frames.
+ *
+ * For example:
+ *   sequencer_test --gtest_filter=*Proxy* --resolution=1080p --clips=32 --frames=48 \
+ *     --proxy_threads=0
+ */
+
+#include "sequencer_testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+/* Average difference in 8 bit levels between a proxy and the scaled frame, per channel. Red and
+ * green are gradients that identify the frame and the clip, blue is a fine pattern that loses
+ * more in the JPEG compression. */
+static const double proxy_max_mean_error[3] = {5.0, 5.0, 12.0};
+
+DEFINE_int32(clips, 8, "Number of clips to build proxies for.");
+DEFINE_int32(proxy_threads, 4, "Number of clips to build at the same time, 0 for one per thread.");
+
+class SequencerProxyBenchmarkTest : public SequencerTest {
+ public:
+  static void TearDownTestCase()
+  {
+    U.sequencer_proxy_build_threads = 0;
+
+    SequencerTest::TearDownTestCase();
+  }
+
+ protected:
+  static void clip_dir(char *dir, size_t dir_len, const char *subdir, int clip)
+  {
+    char dirname[64];
+    BLI_snprintf(dirname, sizeof(dirname), "%s_%d%s", subdir, clip, SEP_STR);
+    BLI_join_dirfile(dir, dir_len, BKE_tempdir_session(), dirname);
+  }
+
+  void write_clip(const char *dir, int clip)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 24, IB_rect);
+    ibuf->ftype = IMB_FTYPE_PNG;
+    /* Low compression, writing the frames is not what is measured. */
+    ibuf->foptions.quality = 10;
+
+    for (int frame = 0; frame < FLAGS_frames; frame++) {
+      unsigned char *pixel = (unsigned char *)ibuf->rect;
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, pixel += 4) {
+          pixel[0] = (x + frame * 8) & 255;
+          pixel[1] = (y + clip * 16) & 255;
+          pixel[2] = (x ^ y) & 255;
+          pixel[3] = 255;
+        }
+      }
+
+      char filepath[FILE_MAX], filename[64];
+      BLI_snprintf(filename, sizeof(filename), "frame_%04d.png", frame);
+      BLI_join_dirfile(filepath, sizeof(filepath), dir, filename);
+      ASSERT_TRUE(IMB_saveiff(ibuf, filepath, IB_rect));
+    }
+
+    IMB_freeImBuf(ibuf);
+  }
+
+  void setup_clips()
+  {
+    Editing *ed = scene->ed;
+
+    for (int clip = 0; clip < FLAGS_clips; clip++) {
+      char dir[FILE_MAX];
+      clip_dir(dir, sizeof(dir), "proxy_benchmark_clip", clip);
+      BLI_dir_create_recursive(dir);
+      write_clip(dir, clip);
+
+      Sequence *seq = BKE_sequence_alloc(ed->seqbasep, 1, clip + 1, SEQ_TYPE_IMAGE);
+      BLI_snprintf(seq->name + 2, sizeof(seq->name) - 2, "Clip %d", clip);
+      seq->len = FLAGS_frames;
+
+      Strip *strip = seq->strip;
+      STRNCPY(strip->dir, dir);
+      strip->stripdata = (StripElem *)MEM_callocN(sizeof(StripElem) * seq->len, "stripelem");
+      for (int frame = 0; frame < seq->len; frame++) {
+        BLI_snprintf(strip->stripdata[frame].name,
+                     sizeof(strip->stripdata[frame].name),
+                     "frame_%04d.png",
+                     frame);
+      }
+
+      BKE_sequencer_proxy_set(seq, true);
+      strip->proxy->build_size_flags = SEQ_PROXY_IMAGE_SIZE_25 | SEQ_PROXY_IMAGE_SIZE_50;
+      strip->proxy->storage = SEQ_STORAGE_PROXY_CUSTOM_DIR;
+
+      BKE_sequence_init_colorspace(seq);
+      BKE_sequence_calc(scene, seq);
+    }
+  }
+
+  /* Build proxies of all clips into a directory per clip, named after subdir. */
+  double build_proxies(const char *subdir, int threads)
+  {
+    ListBase queue = {NULL, NULL};
+    GSet *file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "file list");
+    int clip = 0;
+
+    LISTBASE_FOREACH (Sequence *, seq, &scene->ed->seqbase) {
+      clip_dir(seq->strip->proxy->dir, sizeof(seq->strip->proxy->dir), subdir, clip++);
+      EXPECT_TRUE(BKE_sequencer_proxy_rebuild_context(
+          G.main, NULL, scene, seq, file_list, &queue));
+    }
+    BLI_gset_free(file_list, MEM_freeN);
+
+    short stop = 0, do_update = 0;
+    float progress = 0.0f;
+
+    U.sequencer_proxy_build_threads = threads;
+    const double start_time = PIL_check_seconds_timer();
+    BKE_sequencer_proxy_rebuild_queue(&queue, &stop, &do_update, &progress);
+    const double seconds = PIL_check_seconds_timer() - start_time;
+
+    EXPECT_EQ(progress, 1.0f);
+
+    LISTBASE_FOREACH (LinkData *, link, &queue) {
+      BKE_sequencer_proxy_rebuild_finish((struct SeqIndexBuildContext *)link->data, false);
+    }
+    BLI_freelistN(&queue);
+
+    return seconds;
+  }
+
+  void report(const char *mode, int threads, double seconds)
+  {
+    testing_write_benchmark_result(FLAGS_output,
+                                   "proxy",
+                                   mode,
+                                   width,
+                                   height,
+                                   threads,
+                                   seconds,
+                                   "\"clips\": %d, \"frames\": %d, \"clips_per_hour\": %.1f",
+                                   FLAGS_clips,
+                                   FLAGS_frames,
+                                   FLAGS_clips * 3600.0 / seconds);
+  }
+
+  /* Proxies are JPEG files of the scaled down frame, the difference with the frame scaled the
+   * same way is compression loss only. */
+  void expect_proxy_matches_clip(const char *proxy_path, int clip, int size, int frame)
+  {
+    char dir[FILE_MAX], filepath[FILE_MAX], filename[64];
+    clip_dir(dir, sizeof(dir), "proxy_benchmark_clip", clip);
+    BLI_snprintf(filename, sizeof(filename), "frame_%04d.png", frame);
+    BLI_join_dirfile(filepath, sizeof(filepath), dir, filename);
+
+    ImBuf *proxy = IMB_loadiffname(proxy_path, IB_rect, NULL);
+    ImBuf *expected = IMB_loadiffname(filepath, IB_rect, NULL);
+    ASSERT_NE(proxy, (ImBuf *)NULL) << proxy_path;
+    ASSERT_NE(expected, (ImBuf *)NULL) << filepath;
+    IMB_scaleImBuf_threaded(expected, (width * size) / 100, (height * size) / 100);
+
+    EXPECT_EQ(proxy->x, expected->x) << proxy_path;
+    EXPECT_EQ(proxy->y, expected->y) << proxy_path;
+    if (proxy->x == expected->x && proxy->y == expected->y) {
+      const unsigned char *a = (unsigned char *)proxy->rect;
+      const unsigned char *b = (unsigned char *)expected->rect;
+      const size_t num_pixels = (size_t)proxy->x * proxy->y;
+      for (int channel = 0; channel < 3; channel++) {
+        double error = 0.0;
+        for (size_t i = channel; i < num_pixels * 4; i += 4) {
+          error += abs(a[i] - b[i]);
+        }
+        EXPECT_LT(error / num_pixels, proxy_max_mean_error[channel])
+            << proxy_path << " channel " << channel;
+      }
+    }
+
+    IMB_freeImBuf(proxy);
+    IMB_freeImBuf(expected);
+  }
+
+  static void proxy_filepath(char *filepath, const char *subdir, int clip, int size, int frame)
+  {
+    char dir[FILE_MAX], filename[64];
+    clip_dir(dir, sizeof(dir), subdir, clip);
+    BLI_snprintf(filename, sizeof(filename), "images/%d/frame_%04d.png_proxy.jpg", size, frame);
+    BLI_join_dirfile(filepath, FILE_MAX, dir, filename);
+  }
+};
+
+TEST_F(SequencerProxyBenchmarkTest, Batch)
+{
+  ASSERT_GT(FLAGS_clips, 0);
+
+  setup_clips();
+
+  report("serial", 1, build_proxies("proxy_serial", 1));
+  const int threads = FLAGS_proxy_threads > 0 ? FLAGS_proxy_threads : BLI_system_thread_count();
+  report("parallel", threads, build_proxies("proxy_parallel", threads));
+
+  for (int clip = 0; clip < FLAGS_clips; clip++) {
+    for (const int size : {25, 50}) {
+      for (int frame = 0; frame < FLAGS_frames; frame++) {
+        char serial_path[FILE_MAX], parallel_path[FILE_MAX];
+        proxy_filepath(serial_path, "proxy_serial", clip, size, frame);
+        proxy_filepath(parallel_path, "proxy_parallel", clip, size, frame);
+
+        size_t serial_size, parallel_size;
+        void *serial = BLI_file_read_binary_as_mem(serial_path, 0, &serial_size);
+        void *parallel = BLI_file_read_binary_as_mem(parallel_path, 0, &parallel_size);
+        ASSERT_NE(serial, (void *)NULL) << serial_path;
+        ASSERT_NE(parallel, (void *)NULL) << parallel_path;
+        EXPECT_TRUE(serial_size == parallel_size && memcmp(serial, parallel, serial_size) == 0)
+            << parallel_path;
+
+        MEM_freeN(serial);
+        MEM_freeN(parallel);
+
+        expect_proxy_matches_clip(parallel_path, clip, size, frame);
+      }
+    }
+  }
+}
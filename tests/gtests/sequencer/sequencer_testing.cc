@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#include "sequencer_testing.h"
+
+extern "C" {
+#include "BKE_appdir.h"
+#include "BKE_blender.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+#include "BKE_sequencer.h"
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DEG_depsgraph.h"
+
+#include "DNA_genfile.h" /* for DNA_sdna_current_init() */
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+}
+
+DEFINE_string(resolution, "1080p", "Resolution of the timeline: 1080p, 4k or WxH.");
+DEFINE_int32(frames, 24, "Number of frames of the timeline.");
+DEFINE_string(output, "", "Append the results as JSON lines to this file.");
+DEFINE_int32(threads, 0, "Number of threads the sequencer may use, 0 for all of them.");
+
+bool sequencer_test_parse_resolution(const std::string &name, int *r_width, int *r_height)
+{
+  if (name == "1080p") {
+    *r_width = 1920;
+    *r_height = 1080;
+    return true;
+  }
+  if (name == "4k") {
+    *r_width = 3840;
+    *r_height = 2160;
+    return true;
+  }
+  return sscanf(name.c_str(), "%dx%d", r_width, r_height) == 2 && *r_width > 0 && *r_height > 0;
+}
+
+void SequencerTest::SetUpTestCase()
+{
+  testing::Test::SetUpTestCase();
+
+  /* Minimal code to run the sequencer, copied from main() in creator.c. */
+  BLI_threadapi_init();
+  if (FLAGS_threads > 0) {
+    BLI_system_num_threads_override_set(FLAGS_threads);
+  }
+  BLI_task_scheduler_init();
+
+  DNA_sdna_current_init();
+  BKE_blender_globals_init();
+
+  BKE_idtype_init();
+  DEG_register_node_types();
+  IMB_init();
+  BKE_images_init();
+  BKE_tempdir_init(NULL);
+
+  G.background = true;
+  G.factory_startup = true;
+}
+
+void SequencerTest::TearDownTestCase()
+{
+  BKE_blender_free();
+  DEG_free_node_types();
+
+  DNA_sdna_current_free();
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  BKE_blender_atexit();
+  BKE_tempdir_session_purge();
+
+  testing::Test::TearDownTestCase();
+}
+
+void SequencerTest::SetUp()
+{
+  testing::Test::SetUp();
+
+  ASSERT_TRUE(sequencer_test_parse_resolution(FLAGS_resolution, &width, &height))
+      << FLAGS_resolution;
+  ASSERT_GT(FLAGS_frames, 1);
+
+  scene = BKE_scene_add(G.main, "Sequencer");
+  scene->r.xsch = width;
+  scene->r.ysch = height;
+  scene->r.size = 100;
+  scene->r.sfra = scene->r.cfra = 1;
+  scene->r.efra = FLAGS_frames;
+  BKE_sequencer_editing_ensure(scene);
+}
+
+void SequencerTest::TearDown()
+{
+  if (scene) {
+    BKE_id_delete(G.main, &scene->id);
+    scene = nullptr;
+  }
+
+  testing::Test::TearDown();
+}
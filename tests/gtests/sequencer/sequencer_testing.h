@@ -0,0 +1,54 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#ifndef __SEQUENCER_TESTING_H__
+#define __SEQUENCER_TESTING_H__
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+#include <string>
+
+struct Scene;
+
+DECLARE_string(resolution);
+DECLARE_int32(frames);
+DECLARE_string(output);
+DECLARE_int32(threads);
+
+/* Runs the sequencer without a window. Blender globals are set up once for all tests of a
+ * fixture, fixtures which need more global state extend SetUpTestCase() and
+ * TearDownTestCase(). Every test gets a scene with the resolution and the number of frames
+ * given on the command line. */
+class SequencerTest : public testing::Test {
+ public:
+  static void SetUpTestCase();
+  static void TearDownTestCase();
+
+ protected:
+  Scene *scene = nullptr;
+  int width = 0, height = 0;
+
+  virtual void SetUp();
+  virtual void TearDown();
+};
+
+/* Parse a resolution: 1080p, 4k or WxH. */
+bool sequencer_test_parse_resolution(const std::string &name, int *r_width, int *r_height);
+
+#endif /* __SEQUENCER_TESTING_H__ */
@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#ifndef __BLENDER_TESTING_BENCHMARK_H__
+#define __BLENDER_TESTING_BENCHMARK_H__
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+/* Benchmark results are JSON lines, one object per measurement. Every object has the same
+ * leading fields, followed by fields specific to the benchmark formatted like printf(), if any.
+ * The line is printed and appended to the output file, if one is given. */
+inline void testing_write_benchmark_result(const std::string &output,
+                                           const char *benchmark,
+                                           const char *mode,
+                                           int width,
+                                           int height,
+                                           int threads,
+                                           double seconds,
+                                           const char *extra_format = NULL,
+                                           ...)
+{
+  char extra[512] = "";
+  if (extra_format) {
+    va_list args;
+    va_start(args, extra_format);
+    extra[0] = ',';
+    extra[1] = ' ';
+    vsnprintf(extra + 2, sizeof(extra) - 2, extra_format, args);
+    va_end(args);
+  }
+
+  char line[1024];
+  snprintf(line,
+           sizeof(line),
+           "{\"benchmark\": \"%s\", \"mode\": \"%s\", \"width\": %d, \"height\": %d, "
+           "\"threads\": %d, \"seconds\": %.6f%s}\n",
+           benchmark,
+           mode,
+           width,
+           height,
+           threads,
+           seconds,
+           extra);
+  fputs(line, stdout);
+
+  if (!output.empty()) {
+    FILE *file = fopen(output.c_str(), "a");
+    if (file) {
+      fputs(line, file);
+      fclose(file);
+    }
+  }
+}
+
+#endif /* __BLENDER_TESTING_BENCHMARK_H__ */